@@ -110,16 +110,6 @@ vec3 SampleShadowArray(vec4 shadowTC, vec2 filterOffset) {
 #endif
 }
 
-vec3 SampleSpotShadowMap() {
-    vec4 shadowTC = v2f_shadowVec.xyzz / v2f_shadowVec.w;
-    shadowTC.z = 0.0;
-#if SHADOW_MAP_QUALITY >= 1
-    return SampleShadowArrayPCF_Q1(shadowTC, shadowMapTexelSize);
-#else
-    return tex2Darray(shadowArrayMap, shadowTC).rgb;
-#endif
-}
-
 vec3 SampleSingleCascadedShadowMap() {
     vec4 shadowCascadedTC;
     shadowCascadedTC = shadowCascadeProjMatrix[0] * v2f_shadowVec;
@@ -263,12 +253,24 @@ vec3 SampleShadowPCF_Q1(vec3 shadowTC, vec2 filterOffset) {
     return shadow;
 }
 
+// Spot light shadow map is in the tile of the shadow atlas.
+// Tile scale and bias is already multiplied in the shadow projection matrix.
+vec3 SampleSpotShadowMap() {
+    vec3 shadowTC = v2f_shadowVec.xyz / v2f_shadowVec.w;
+#if SHADOW_MAP_QUALITY >= 1
+    return SampleShadowPCF_Q1(shadowTC, shadowMapTexelSize);
+#else
+    return tex2D(shadowMap, shadowTC).rgb;
+#endif
+}
+
 //-------------------------------------------------------------------------------------------------
 
 uniform samplerCube cubicNormalCubeMap;
 uniform HIGHP samplerCube indirectionCubeMap;
 uniform vec2 shadowProjectionDepth;
 uniform float vscmBiasedScale;
+uniform HIGHP vec4 shadowAtlasTileScaleBias; // VSCM tile of the point light in the shadow atlas
 
 /*vec3 ShadowCubePCF(vec4 shadowTC) {
 #if SHADOW_MAP_QUALITY > 0
@@ -320,7 +322,7 @@ vec3 GetShadowIndirectCoord(const vec3 worldLightVec) {
     vec3 biasedDir = a * dir + b * dir;
     
     vec3 shadowIndirectCoord;
-    shadowIndirectCoord.xy = texCUBE(indirectionCubeMap, biasedDir).xy;
+    shadowIndirectCoord.xy = texCUBE(indirectionCubeMap, biasedDir).xy * shadowAtlasTileScaleBias.xy + shadowAtlasTileScaleBias.zw;
     shadowIndirectCoord.z = (1.0 / Zeye) * shadowProjectionDepth.x + shadowProjectionDepth.y;
     
     return shadowIndirectCoord;
@@ -176,6 +176,16 @@ uniform LOWP float wrappedDiffuse;
     uniform MEDIUMP float probeLerp;
 #endif
 
+//
+// Clustered lighting parameters
+//
+#if defined(CLUSTERED_LIGHTING) && defined(INDIRECT_LIGHTING)
+    uniform HIGHP samplerBuffer clusterLightMap;
+    uniform HIGHP mat4 clusterViewProjectionMatrix;
+    uniform HIGHP vec2 clusterSliceScaleBias;
+    uniform ivec4 clusterDataBase;                  // texel offsets of the lights, clusters and light indexes, .w holds the number of lights
+#endif
+
 #if defined(DIRECT_LIGHTING) || defined(INDIRECT_LIGHTING)
     uniform MEDIUMP sampler2D prefilteredDfgMap;
 
@@ -320,6 +330,58 @@ void main() {
     shadingColor += Cl * lightingColor * shadowLighting;
 #endif
 
+#if defined(CLUSTERED_LIGHTING) && defined(INDIRECT_LIGHTING)
+    if (clusterDataBase.w > 0) {
+        #if _NORMAL != 0 || _ANISO != 0 || (_CLEARCOAT != 0 && _CC_NORMAL == 1)
+            HIGHP vec4 clusterPositionWS = vec4(v2f_tangentToWorldAndPackedWorldPosS.w, v2f_tangentToWorldAndPackedWorldPosT.w, v2f_tangentToWorldAndPackedWorldPosR.w, 1.0);
+        #else
+            HIGHP vec4 clusterPositionWS = vec4(v2f_positionWS.xyz, 1.0);
+        #endif
+
+        // Find the cluster with the screen position and the exponential depth slice of the view depth.
+        HIGHP vec4 clusterPositionCS = clusterViewProjectionMatrix * clusterPositionWS;
+        ivec2 clusterXY = ivec2((clusterPositionCS.xy / clusterPositionCS.w * 0.5 + 0.5) * vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y));
+        clusterXY = clamp(clusterXY, ivec2(0, 0), ivec2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1));
+        int clusterZ = clamp(int(log(max(clusterPositionCS.w, 0.0001)) * clusterSliceScaleBias.x + clusterSliceScaleBias.y), 0, CLUSTER_GRID_Z - 1);
+        int clusterIndex = (clusterZ * CLUSTER_GRID_Y + clusterXY.y) * CLUSTER_GRID_X + clusterXY.x;
+
+        // .x = offset of the light indexes, .y = number of the lights
+        vec2 clusterLights = texelFetch(clusterLightMap, clusterDataBase.y + clusterIndex).xy;
+        int firstLightIndex = int(clusterLights.x);
+        int numClusterLights = int(clusterLights.y);
+
+        for (int i = 0; i < numClusterLights; i++) {
+            int lightIndexIndex = firstLightIndex + i;
+            int lightIndex = int(texelFetch(clusterLightMap, clusterDataBase.z + lightIndexIndex / 4)[lightIndexIndex % 4]);
+            int lightTexel = clusterDataBase.x + lightIndex * 5;
+
+            // .xyz = light position, .w = fall off exponent
+            HIGHP vec4 clusterLightPosition = texelFetch(clusterLightMap, lightTexel);
+
+            HIGHP vec3 clusterLightFallOff;
+            clusterLightFallOff.x = dot(texelFetch(clusterLightMap, lightTexel + 2), clusterPositionWS);
+            clusterLightFallOff.y = dot(texelFetch(clusterLightMap, lightTexel + 3), clusterPositionWS);
+            clusterLightFallOff.z = dot(texelFetch(clusterLightMap, lightTexel + 4), clusterPositionWS);
+
+            float clusterAttenuation = 1.0 - min(dot(clusterLightFallOff, clusterLightFallOff), 1.0);
+            if (clusterAttenuation <= 0.0) {
+                continue;
+            }
+            clusterAttenuation = pow(clusterAttenuation, clusterLightPosition.w);
+
+            vec3 clusterCl = texelFetch(clusterLightMap, lightTexel + 1).rgb * clusterAttenuation;
+
+            shading.l = normalize(clusterLightPosition.xyz - clusterPositionWS.xyz);
+
+            #if defined(STANDARD_METALLIC_LIGHTING) || defined(STANDARD_SPECULAR_LIGHTING)
+                shadingColor += clusterCl * DirectLit_Standard();
+            #elif defined(LEGACY_PHONG_LIGHTING)
+                shadingColor += clusterCl * DirectLit_PhongFresnel();
+            #endif
+        }
+    }
+#endif
+
     vec4 finalColor = v2f_color * vec4(shadingColor, albedo.a);
 
 #ifdef LOGLUV_HDR
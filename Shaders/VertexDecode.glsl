@@ -0,0 +1,49 @@
+#ifndef VERTEX_DECODE_INCLUDED
+#define VERTEX_DECODE_INCLUDED
+
+// Decodes VertexGenericLitCompact.
+// Position is normalized in the sub mesh AABB, and w holds the bitangent sign.
+// Normal and tangent are octahedral encoded in two components.
+// vertexDecodeScale.w is 1.0 for the compact vertices, 0.0 otherwise.
+uniform HIGHP vec4 vertexDecodeScale;
+uniform HIGHP vec3 vertexDecodeBias;
+
+vec3 octahedralDecode(vec2 e) {
+    vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.x += v.x >= 0.0 ? -t : t;
+    v.y += v.y >= 0.0 ? -t : t;
+    return normalize(v);
+}
+
+HIGHP vec4 decodePosition(HIGHP vec4 position) {
+    if (vertexDecodeScale.w > 0.0) {
+        return vec4(position.xyz * vertexDecodeScale.xyz + vertexDecodeBias, 1.0);
+    }
+    return position;
+}
+
+vec3 decodeNormal(vec3 normal) {
+    if (vertexDecodeScale.w > 0.0) {
+        return octahedralDecode(normal.xy);
+    }
+#ifdef COMPRESSED_VERTEX_NORMAL_TANGENTS
+    return normal * 2.0 - 1.0;
+#else
+    return normal;
+#endif
+}
+
+// The bitangent sign of the compact vertex is stored in the position w.
+vec4 decodeTangent(vec4 tangent, HIGHP vec4 position) {
+    if (vertexDecodeScale.w > 0.0) {
+        return vec4(octahedralDecode(tangent.xy), position.w);
+    }
+#ifdef COMPRESSED_VERTEX_NORMAL_TANGENTS
+    return tangent * 2.0 - 1.0;
+#else
+    return tangent;
+#endif
+}
+
+#endif
@@ -12,6 +12,8 @@ shader "constantColor" {
             uniform HIGHP mat4x3 localToWorldMatrix;
         #endif
 
+        $include "VertexDecode.glsl"
+
         #ifdef GPU_SKINNING
             #if defined(GPU_SKINNING_1_WEIGHTS)
                 $include "SkinningMatrix1.glsl"
@@ -29,9 +31,9 @@ shader "constantColor" {
 			vec4 localPos;
 
 		#ifdef GPU_SKINNING
-			skinningMatrix(in_position, localPos);
+			skinningMatrix(decodePosition(in_position), localPos);
 		#else
-			localPos = in_position;
+			localPos = decodePosition(in_position);
 		#endif
 
         #ifdef INSTANCING
@@ -9,18 +9,15 @@ shader "showTangentSpace" {
 		uniform int tangentIndex;
 		uniform HIGHP mat4 modelViewProjectionMatrix;
 
+		$include "VertexDecode.glsl"
+
 		void main() {
 			vec3 tangents[3];
 
-		#ifdef COMPRESSED_VERTEX_NORMAL_TANGENTS
-			vec3 vNormal = in_normal.xyz * 2.0 - 1.0;
-            vec4 vTangent = in_tangent * 2.0 - 1.0;
-		#else
-			vec3 vNormal = in_normal.xyz;
-            vec4 vTangent = in_tangent;
-		#endif
+			vec3 vNormal = decodeNormal(in_normal.xyz);
+			vec4 vTangent = decodeTangent(in_tangent, in_position);
 
-			tangents[0] = in_tangent.xyz;
+			tangents[0] = vTangent.xyz;
 			tangents[1] = cross(vNormal, vTangent.xyz) * vTangent.w;
 			tangents[2] = vNormal;
 
@@ -31,7 +28,7 @@ shader "showTangentSpace" {
 			v2f_color.xyz = tangents[tangentIndex];
 			v2f_color.w = 1.0;
 
-			gl_Position = modelViewProjectionMatrix * in_position;
+			gl_Position = modelViewProjectionMatrix * decodePosition(in_position);
 		}
 	}
 
@@ -7,8 +7,10 @@ shader "vertexColor" {
 
 		uniform HIGHP mat4 modelViewProjectionMatrix;
 
+		$include "VertexDecode.glsl"
+
 		void main() {
-			gl_Position = modelViewProjectionMatrix * in_position;
+			gl_Position = modelViewProjectionMatrix * decodePosition(in_position);
 			v2f_color = in_color;
 		}
 	}
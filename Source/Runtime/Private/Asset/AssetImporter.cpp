@@ -15,6 +15,7 @@
 #include "Precompiled.h"
 #include "Asset/Asset.h"
 #include "Asset/AssetImporter.h"
+#include "Asset/DerivedDataCache.h"
 #include "IO/FileSystem.h"
 
 BE_NAMESPACE_BEGIN
@@ -56,9 +57,76 @@ void AssetImporter::RevertChanged() {
     }
 }
 
-void AssetImporter::ApplyChanged() {
+Str AssetImporter::GetCookedDirectory() const {
+    Str cookedDir = Asset::NormalizeAssetPath(GetResourceFilename());
+    cookedDir.StripFileName();
+
+    Str assetDir = asset->GetAssetFilename();
+    assetDir.StripFileName();
+
+    // Cooked files next to the source can't be told apart from the other assets in the directory.
+    if (!cookedDir.IcmpPath(assetDir)) {
+        return "";
+    }
+    return cookedDir;
+}
+
+void AssetImporter::ClearCookedDirectory(const char *cookedDir) {
+    if (fileSystem.DirectoryExists(cookedDir)) {
+        fileSystem.RemoveDirectory(cookedDir, true);
+    }
+    fileSystem.CreateDirectory(cookedDir, true);
+}
+
+Str AssetImporter::GetDerivedDataKey() const {
+    DerivedDataKeyBuilder keyBuilder;
+
+    keyBuilder.AppendString(ClassName());
+    keyBuilder.AppendInt(GetConverterVersion());
+
+    // Importer GUID differs between the projects, so hash the settings only.
+    Json::Value importerValue;
+    Serialize(importerValue);
+    importerValue.removeMember("guid");
+
+    Json::FastWriter jsonWriter;
+    keyBuilder.AppendString(jsonWriter.write(importerValue).c_str());
+
+    if (!keyBuilder.AppendFile(asset->GetAssetFilename())) {
+        return "";
+    }
+
+    return keyBuilder.Finalize();
+}
+
+bool AssetImporter::ImportCached() {
+    Str cookedDir = GetCookedDirectory();
+    Str key = cookedDir.IsEmpty() ? "" : GetDerivedDataKey();
+
+    if (key.IsEmpty()) {
+        Import();
+        return false;
+    }
+
+    // Stale outputs of the previous import must not be overlaid on the restored files or bundled into the new key.
+    ClearCookedDirectory(cookedDir);
+
+    if (derivedDataCache.GetDirectory(key, cookedDir)) {
+        return true;
+    }
+
+    // Corrupted entry might leave the partial files.
+    ClearCookedDirectory(cookedDir);
+
     Import();
 
+    derivedDataCache.PutDirectory(key, cookedDir);
+    return false;
+}
+
+void AssetImporter::ApplyChanged() {
+    ImportCached();
+
     asset->Reload();
 
     asset->WriteMetaDataFile();
@@ -0,0 +1,392 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/ByteOrder.h"
+#include "Core/CVars.h"
+#include "Core/Cmds.h"
+#include "Core/Guid.h"
+#include "Platform/PlatformSystem.h"
+#include "IO/FileSystem.h"
+#include "Asset/DerivedDataCache.h"
+
+BE_NAMESPACE_BEGIN
+
+static CVar                 ddc_path("ddc_path", "", 0, "derived data cache directory, user application data directory if empty");
+static CVar                 ddc_enable("ddc_enable", "1", CVar::Flag::Bool, "");
+
+DerivedDataCache            derivedDataCache;
+
+// Header of the cached directory bundle.
+// Followed by numFiles x { nameLength (uint32), name, size (uint32), data }.
+struct DirectoryBundleHeader {
+    static const uint32_t   Magic = ('C' << 24) | ('D' << 16) | ('D' << 8) | 'B';
+
+    uint32_t                magic;
+    uint32_t                numFiles;
+};
+
+DerivedDataKeyBuilder::DerivedDataKeyBuilder() {
+    MD5_Init(&ctx);
+}
+
+void DerivedDataKeyBuilder::Append(const void *data, size_t size) {
+    MD5_Update(&ctx, (const unsigned char *)data, size);
+}
+
+void DerivedDataKeyBuilder::AppendString(const char *string) {
+    Append(string, strlen(string) + 1);
+}
+
+void DerivedDataKeyBuilder::AppendInt(int value) {
+    int32_t littleEndianValue = value;
+    ByteOrder::SystemToLittleEndian(littleEndianValue);
+    Append(&littleEndianValue, sizeof(littleEndianValue));
+}
+
+bool DerivedDataKeyBuilder::AppendFile(const char *filename) {
+    File *file = fileSystem.OpenFileRead(filename, false);
+    if (!file) {
+        return false;
+    }
+
+    byte buffer[16384];
+    size_t remaining = file->Size();
+
+    while (remaining > 0) {
+        size_t bytesRead = file->Read(buffer, Min(remaining, sizeof(buffer)));
+        if (bytesRead == 0) {
+            break;
+        }
+        Append(buffer, bytesRead);
+        remaining -= bytesRead;
+    }
+
+    fileSystem.CloseFile(file);
+    return remaining == 0;
+}
+
+Str DerivedDataKeyBuilder::Finalize() {
+    unsigned char digest[16];
+    MD5_Final(&ctx, digest);
+
+    char key[33];
+    for (int i = 0; i < 16; i++) {
+        sprintf(&key[i * 2], "%02x", digest[i]);
+    }
+    return Str(key);
+}
+
+void DerivedDataCache::Init() {
+    cacheDir = ddc_path.GetString();
+
+    if (cacheDir.IsEmpty()) {
+        cacheDir = PlatformSystem::UserAppDataDir();
+        cacheDir.AppendPath("Blueshift");
+        cacheDir.AppendPath("DerivedDataCache");
+    }
+
+    ResetStats();
+
+    cmdSystem.AddCommand("ddcStats", Cmd_DDCStats);
+}
+
+void DerivedDataCache::Shutdown() {
+    cmdSystem.RemoveCommand("ddcStats");
+}
+
+// Entries are spread to 256 sub-directories by the first two hex digits of the key.
+Str DerivedDataCache::GetCachedFilename(const char *key) const {
+    Str filename = cacheDir;
+    filename.AppendPath(Str(key).Left(2));
+    filename.AppendPath(key);
+    return filename;
+}
+
+bool DerivedDataCache::Exists(const char *key) const {
+    if (!ddc_enable.GetBool()) {
+        return false;
+    }
+    return fileSystem.FileExists(GetCachedFilename(key));
+}
+
+bool DerivedDataCache::Get(const char *key, void **data, size_t *size) {
+    *data = nullptr;
+    *size = 0;
+
+    if (!ddc_enable.GetBool()) {
+        return false;
+    }
+
+    Str filename = GetCachedFilename(key);
+    if (!fileSystem.FileExists(filename)) {
+        numMisses++;
+        return false;
+    }
+
+    *size = fileSystem.LoadFile(filename, false, data);
+    if (!*data) {
+        numMisses++;
+        return false;
+    }
+
+    numHits++;
+    bytesRead += *size;
+    return true;
+}
+
+bool DerivedDataCache::WriteCachedFile(const char *key, const Array<const void *> &chunks, const Array<size_t> &chunkSizes) {
+    Str filename = GetCachedFilename(key);
+
+    // Same key always has the same data, so the entry written by the other process is as good as ours.
+    if (fileSystem.FileExists(filename)) {
+        return true;
+    }
+
+    // Temporary file name unique across the machines sharing the cache directory.
+    Str tempFilename = filename + va(".%s.tmp", Guid::CreateGuid().ToString());
+
+    File *file = fileSystem.OpenFileWrite(tempFilename);
+    if (!file) {
+        BE_WARNLOG("DerivedDataCache: failed to write %s\n", tempFilename.c_str());
+        return false;
+    }
+
+    bool success = true;
+    size_t size = 0;
+    for (int i = 0; i < chunks.Count() && success; i++) {
+        success = file->Write(chunks[i], chunkSizes[i]);
+        size += chunkSizes[i];
+    }
+
+    fileSystem.CloseFile(file);
+
+    if (success && !PlatformFile::MoveFile(tempFilename, filename)) {
+        // Rename fails on some platforms if the other writer has just finished the same entry.
+        success = fileSystem.FileExists(filename);
+    }
+
+    if (PlatformFile::FileExists(tempFilename)) {
+        PlatformFile::RemoveFile(tempFilename);
+    }
+
+    if (success) {
+        numPuts++;
+        bytesWritten += size;
+    }
+    return success;
+}
+
+bool DerivedDataCache::Put(const char *key, const void *data, size_t size) {
+    if (!ddc_enable.GetBool()) {
+        return false;
+    }
+
+    Array<const void *> chunks;
+    Array<size_t> chunkSizes;
+    chunks.Append(data);
+    chunkSizes.Append(size);
+
+    return WriteCachedFile(key, chunks, chunkSizes);
+}
+
+// Returns false if the bundle entry name is absolute or contains "..".
+static bool IsRelativeEntryName(const Str &name) {
+    if (name.IsEmpty() || name[0] == '/' || name[0] == '\\' || name.Find(':') >= 0) {
+        return false;
+    }
+
+    int start = 0;
+    for (int i = 0; i <= name.Length(); i++) {
+        if (i == name.Length() || name[i] == '/' || name[i] == '\\') {
+            if (i - start == 2 && name[start] == '.' && name[start + 1] == '.') {
+                return false;
+            }
+            start = i + 1;
+        }
+    }
+    return true;
+}
+
+bool DerivedDataCache::GetDirectory(const char *key, const char *dstDir) {
+    void *data;
+    size_t size;
+    if (!Get(key, &data, &size)) {
+        return false;
+    }
+
+    const byte *ptr = (const byte *)data;
+    const byte *end = ptr + size;
+
+    DirectoryBundleHeader header;
+    bool valid = size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, ptr, sizeof(header));
+        ptr += sizeof(header);
+        ByteOrder::LittleEndianToSystem(header.magic);
+        ByteOrder::LittleEndianToSystem(header.numFiles);
+        valid = header.magic == DirectoryBundleHeader::Magic;
+    }
+
+    uint32_t numFiles = valid ? header.numFiles : 0;
+
+    for (uint32_t i = 0; i < numFiles && valid; i++) {
+        uint32_t nameLength;
+        uint32_t fileSize;
+
+        if (end - ptr < (ptrdiff_t)sizeof(nameLength)) {
+            valid = false;
+            break;
+        }
+        memcpy(&nameLength, ptr, sizeof(nameLength));
+        ByteOrder::LittleEndianToSystem(nameLength);
+        ptr += sizeof(nameLength);
+
+        if (end - ptr < (ptrdiff_t)(nameLength + sizeof(fileSize))) {
+            valid = false;
+            break;
+        }
+        Str name;
+        name.Append((const char *)ptr, nameLength);
+        ptr += nameLength;
+
+        memcpy(&fileSize, ptr, sizeof(fileSize));
+        ByteOrder::LittleEndianToSystem(fileSize);
+        ptr += sizeof(fileSize);
+
+        if ((size_t)(end - ptr) < fileSize) {
+            valid = false;
+            break;
+        }
+
+        // Entry names must stay in the destination directory.
+        if (!IsRelativeEntryName(name)) {
+            valid = false;
+            break;
+        }
+
+        Str::ConvertPathSeperator(name, PATHSEPERATOR_CHAR);
+
+        Str filename = dstDir;
+        filename.AppendPath(name);
+        fileSystem.WriteFile(filename, ptr, fileSize);
+        ptr += fileSize;
+    }
+
+    fileSystem.FreeFile(data);
+
+    if (!valid) {
+        BE_WARNLOG("DerivedDataCache: corrupted entry %s\n", key);
+        // Count as a miss instead of a hit so that the caller cooks again.
+        numHits--;
+        numMisses++;
+        PlatformFile::RemoveFile(GetCachedFilename(key));
+    }
+    return valid;
+}
+
+bool DerivedDataCache::PutDirectory(const char *key, const char *srcDir) {
+    if (!ddc_enable.GetBool()) {
+        return false;
+    }
+
+    FileArray fileArray;
+    fileSystem.ListFiles(srcDir, "*", fileArray, false, false, true, true);
+
+    DirectoryBundleHeader header;
+    header.magic = DirectoryBundleHeader::Magic;
+    header.numFiles = fileArray.NumFiles();
+    ByteOrder::SystemToLittleEndian(header.magic);
+    ByteOrder::SystemToLittleEndian(header.numFiles);
+
+    Array<const void *> chunks;
+    Array<size_t> chunkSizes;
+    Array<void *> fileData;
+    Array<uint32_t> lengths;
+    Array<Str> names;
+
+    // Reserve to keep the pointers of the lengths and names valid.
+    lengths.Resize(fileArray.NumFiles() * 2);
+    names.Resize(fileArray.NumFiles());
+
+    chunks.Append(&header);
+    chunkSizes.Append(sizeof(header));
+
+    bool success = true;
+
+    for (int i = 0; i < fileArray.NumFiles() && success; i++) {
+        void *data;
+        size_t size = fileSystem.LoadFile(fileArray.GetFullFileName(i), false, &data);
+        if (!data) {
+            success = false;
+            break;
+        }
+        fileData.Append(data);
+
+        // Names are stored with '/' to share the cache between platforms.
+        Str &name = names.Alloc();
+        name = fileArray.GetFileName(i);
+        Str::ConvertPathSeperator(name, '/');
+
+        uint32_t &nameLength = lengths.Alloc();
+        nameLength = name.Length();
+        ByteOrder::SystemToLittleEndian(nameLength);
+        chunks.Append(&nameLength);
+        chunkSizes.Append(sizeof(nameLength));
+        chunks.Append(name.c_str());
+        chunkSizes.Append(name.Length());
+
+        uint32_t &fileSize = lengths.Alloc();
+        fileSize = (uint32_t)size;
+        ByteOrder::SystemToLittleEndian(fileSize);
+        chunks.Append(&fileSize);
+        chunkSizes.Append(sizeof(fileSize));
+        chunks.Append(data);
+        chunkSizes.Append(size);
+    }
+
+    if (success) {
+        success = WriteCachedFile(key, chunks, chunkSizes);
+    }
+
+    for (int i = 0; i < fileData.Count(); i++) {
+        fileSystem.FreeFile(fileData[i]);
+    }
+    return success;
+}
+
+float DerivedDataCache::HitRate() const {
+    int numRequests = numHits + numMisses;
+    return numRequests > 0 ? (float)numHits / numRequests : 0.0f;
+}
+
+void DerivedDataCache::ResetStats() {
+    numHits = 0;
+    numMisses = 0;
+    numPuts = 0;
+    bytesRead = 0;
+    bytesWritten = 0;
+}
+
+void DerivedDataCache::PrintStats() const {
+    BE_LOG("Derived data cache: %s\n", cacheDir.c_str());
+    BE_LOG("%i hits, %i misses (%.1f%% hit rate), %i puts\n", (int)numHits, (int)numMisses, HitRate() * 100.0f, (int)numPuts);
+    BE_LOG("%.2f MB read, %.2f MB written\n", bytesRead / (1024.0 * 1024.0), bytesWritten / (1024.0 * 1024.0));
+}
+
+void DerivedDataCache::Cmd_DDCStats(const CmdArgs &args) {
+    derivedDataCache.PrintStats();
+}
+
+BE_NAMESPACE_END
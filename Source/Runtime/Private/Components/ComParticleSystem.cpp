@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/CVars.h"
 #include "Render/Render.h"
 #include "Asset/Asset.h"
 #include "Asset/Resource.h"
@@ -21,9 +22,12 @@
 #include "Components/ComParticleSystem.h"
 #include "Game/GameWorld.h"
 #include "Game/TagLayerSettings.h"
+#include "Profiler/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
+static CVar                 particleSystem_simd("particleSystem_simd", "1", CVar::Flag::Bool, "simulate particles with the structure-of-arrays SIMD path, 0 to use the scalar path");
+
 OBJECT_DECLARATION("Particle System", ComParticleSystem, ComRenderable)
 BEGIN_EVENTS(ComParticleSystem)
 END_EVENTS
@@ -37,6 +41,7 @@ void ComParticleSystem::RegisterProperties() {
 
 ComParticleSystem::ComParticleSystem() {
     particleSystemAsset = nullptr;
+    simulatingWorld = nullptr;
 
 #if WITH_EDITOR
     spriteHandle = -1;
@@ -49,6 +54,8 @@ ComParticleSystem::~ComParticleSystem() {
 }
 
 void ComParticleSystem::Purge(bool chainPurge) {
+    CancelSimulation();
+
 #if WITH_EDITOR
     if (spriteDef.mesh) {
         meshManager.ReleaseMesh(spriteDef.mesh);
@@ -157,6 +164,9 @@ void ComParticleSystem::ChangeParticleSystem(const Guid &particleSystemGuid) {
 }
 
 void ComParticleSystem::ResetParticles() {
+    // Stage jobs point to the particles to be freed.
+    CancelSimulation();
+
     renderObjectDef.stageStartDelay.SetCount(renderObjectDef.particleSystem->NumStages());
 
     // Free memory used for particles.
@@ -197,6 +207,8 @@ void ComParticleSystem::OnActive() {
 }
 
 void ComParticleSystem::OnInactive() {
+    CancelSimulation();
+
 #if WITH_EDITOR
     if (spriteHandle != -1) {
         renderWorld->RemoveRenderObject(spriteHandle);
@@ -263,9 +275,24 @@ void ComParticleSystem::UpdateSimulation(int currentTime) {
     renderObjectDef.aabb.SetZero();
 
     const Mat3x4 worldMatrix = GetEntity()->GetTransform()->GetMatrix();
+    const Mat3x4 invWorldMatrix = worldMatrix.Inverse();
 
     bool simulationEnded = true;
-    
+
+    // Alive particles of each stages are gathered into the contiguous ranges, so reserve for all the particles.
+    int maxParticles = 0;
+    for (int stageIndex = 0; stageIndex < renderObjectDef.particleSystem->NumStages(); stageIndex++) {
+        maxParticles += renderObjectDef.particleSystem->GetStage(stageIndex)->standardModule.count;
+    }
+
+    aliveParticles.SetCount(maxParticles, false);
+    particleAges.SetCount(maxParticles, false);
+
+    // Stage jobs recorded already in this frame are replaced.
+    CancelSimulation();
+
+    int numAliveParticles = 0;
+
     for (int stageIndex = 0; stageIndex < renderObjectDef.particleSystem->NumStages(); stageIndex++) {
         const ParticleSystem::Stage *stage = renderObjectDef.particleSystem->GetStage(stageIndex);
 
@@ -301,6 +328,8 @@ void ComParticleSystem::UpdateSimulation(int currentTime) {
 
         int trailCount = (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) ? stage->trailsModule.count : 0;
 
+        int firstAliveParticle = numAliveParticles;
+
         for (int particleIndex = 0; particleIndex < standardModule.count; particleIndex++) {
             int particleGenTime = standardModule.lifeTime * standardModule.spawnBunching * particleIndex / standardModule.count;
             int particleAge = inCycleTime - particleGenTime;
@@ -359,13 +388,27 @@ void ComParticleSystem::UpdateSimulation(int currentTime) {
                     InitializeParticle(particle, stage, (float)inCycleTime / cycleDuration);
                 }
 
-                ProcessTrail(particle, stage, particleAge);
+                // Trails are evaluated by the particle simulator.
+                aliveParticles[numAliveParticles] = particleIndex;
+                particleAges[numAliveParticles] = particleAge;
+                numAliveParticles++;
             } else {
                 particle->alive = false;
                 particle->generated = false;
                 particle->cycle = 0;
             }
         }
+
+        if (numAliveParticles > firstAliveParticle) {
+            ParticleSimulator::StageJob &job = stageJobs.Alloc();
+            job.stage = stage;
+            job.particles = renderObjectDef.stageParticles[stageIndex];
+            job.particleSize = sizeof(Particle) + sizeof(Particle::Trail) * trailCount;
+            job.aliveParticles = &aliveParticles[firstAliveParticle];
+            job.particleAges = &particleAges[firstAliveParticle];
+            job.numAliveParticles = numAliveParticles - firstAliveParticle;
+            job.invWorldMatrix = invWorldMatrix;
+        }
     }
 
     if (simulationEnded) {
@@ -374,9 +417,52 @@ void ComParticleSystem::UpdateSimulation(int currentTime) {
         return;
     }
 
+    if (stageJobs.Count() > 0) {
+        // Render object is updated after the stage jobs of all the particle systems are simulated at once.
+        simulatingWorld = GetGameWorld();
+        simulatingWorld->AddUpdatedParticleSystem(this);
+        return;
+    }
+
     ComRenderable::UpdateVisuals();
 }
 
+void ComParticleSystem::CancelSimulation() {
+    if (simulatingWorld) {
+        simulatingWorld->RemoveUpdatedParticleSystem(this);
+        simulatingWorld = nullptr;
+    }
+
+    stageJobs.SetCount(0, false);
+}
+
+void ComParticleSystem::SimulateParticleSystems(const Array<ComParticleSystem *> &particleSystems) {
+    BE_PROFILE_CPU_SCOPE_STATIC("ComParticleSystem::SimulateParticleSystems");
+
+    Array<ParticleSimulator::StageJob> jobs;
+
+    for (int systemIndex = 0; systemIndex < particleSystems.Count(); systemIndex++) {
+        jobs.AppendArray(particleSystems[systemIndex]->stageJobs);
+    }
+
+    ParticleSimulator::Simulate(jobs.Ptr(), jobs.Count(), particleSystem_simd.GetBool());
+
+    int jobIndex = 0;
+
+    for (int systemIndex = 0; systemIndex < particleSystems.Count(); systemIndex++) {
+        ComParticleSystem *system = particleSystems[systemIndex];
+
+        system->simulatingWorld = nullptr;
+
+        // Add trail bounds of all stages to the entity bounds.
+        for (int i = 0; i < system->stageJobs.Count(); i++) {
+            system->renderObjectDef.aabb.AddAABB(jobs[jobIndex++].bounds);
+        }
+
+        system->ComRenderable::UpdateVisuals();
+    }
+}
+
 void ComParticleSystem::InitializeParticle(Particle *particle, const ParticleSystem::Stage *stage, float inCycleFrac) const {
     particle->generated = true;
 
@@ -497,184 +583,6 @@ void ComParticleSystem::InitializeParticle(Particle *particle, const ParticleSys
     }    
 }
 
-void ComParticleSystem::ProcessTrail(Particle *particle, const ParticleSystem::Stage *stage, int particleAge) {
-    ALIGN_AS32 Mat3x4 offsetMatrix;
-
-    if (stage->standardModule.simulationSpace == ParticleSystem::StandardModule::SimulationSpace::Global) {
-        offsetMatrix = GetEntity()->GetTransform()->GetMatrix().Inverse() * particle->worldMatrix;
-    }
-    
-    int trailCount = (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) ? stage->trailsModule.count : 0;
-    int pivotCount = 1 + trailCount;
-
-    for (int pivotIndex = 0; pivotIndex < pivotCount; pivotIndex++) {
-        Particle::Trail *trail = &particle->trails[pivotIndex];
-        
-        float trailAge = particleAge;
-
-        if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) {
-            trailAge -= (stage->standardModule.lifeTime * stage->trailsModule.length) * pivotIndex / trailCount;
-            
-            if (stage->trailsModule.trailCut) {
-                if (trailAge < 0) {
-                    trailAge = 0;
-                }
-            }
-        }
-
-        float trailFrac = trailAge / stage->standardModule.lifeTime;
-
-        float trailSpeed;
-        
-        if (stage->moduleFlags & (BIT(ParticleSystem::ModuleBit::SizeBySpeed) | BIT(ParticleSystem::ModuleBit::RotationBySpeed))) {
-            if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::CustomPath)) {
-                trailSpeed = 0;
-            } else if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTSpeed)) {
-                trailSpeed = particle->initialSpeed + MeterToUnit(stage->speedOverLifetimeModule.speed.Evaluate(particle->randomSpeed, trailFrac));
-            } else {
-                trailSpeed = particle->initialSpeed;
-            }
-        }
-
-        // Compute size.
-        if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTSize)) {
-            trail->size = particle->initialSize * stage->sizeOverLifetimeModule.size.Evaluate(particle->randomSize, trailFrac);
-        } else if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::SizeBySpeed)) {
-            float l = Math::Fabs(stage->sizeBySpeedModule.speedRange[1] - stage->sizeBySpeedModule.speedRange[0]);
-            float speedFrac = (UnitToMeter(trailSpeed) - stage->sizeBySpeedModule.speedRange[0]) / l;
-            trail->size = particle->initialSize * stage->sizeBySpeedModule.size.Evaluate(particle->randomSize, speedFrac);
-        } else {
-            trail->size = particle->initialSize;
-        }
-
-        if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) {
-            trail->size *= Math::Lerp(1.0f, stage->trailsModule.trailScale, (float)pivotIndex / trailCount);
-        }
-
-        // Compute aspect ratio.
-        if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTAspectRatio)) {
-            trail->aspectRatio = particle->initialAspectRatio * stage->aspectRatioOverLifetimeModule.aspectRatio.Evaluate(particle->randomAspectRatio, trailFrac);
-        } else {
-            trail->aspectRatio = particle->initialAspectRatio;
-        }
-
-        // Compute rotation angle.
-        if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTRotation)) {
-            float angularVelocity = stage->rotationOverLifetimeModule.rotation.Evaluate(particle->randomAngularVelocity, trailFrac);
-            trail->angle = particle->initialAngle + MILLI2SEC(trailAge) * angularVelocity;
-        } else if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::RotationBySpeed)) {
-            float l = Math::Fabs(stage->rotationBySpeedModule.speedRange[1] - stage->rotationBySpeedModule.speedRange[0]);
-            float speedFrac = (UnitToMeter(trailSpeed) - stage->rotationBySpeedModule.speedRange[0]) / l;
-            float angularVelocity = stage->rotationBySpeedModule.rotation.Evaluate(particle->randomSize, speedFrac);
-            trail->angle = particle->initialAngle + MILLI2SEC(trailAge) * angularVelocity; 
-        } else {
-            trail->angle = particle->initialAngle;
-        }
-        
-        // Compute color.
-        if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTColor)) {
-            if (trailFrac < stage->colorOverLifetimeModule.fadeLocation) {
-                // fade in.
-                float f = trailFrac / stage->colorOverLifetimeModule.fadeLocation;
-                trail->color = Math::Lerp(stage->colorOverLifetimeModule.targetColor, particle->initialColor, f);
-            } else { 
-                // fade out.
-                float f = (trailFrac - stage->colorOverLifetimeModule.fadeLocation) / (1.f - stage->colorOverLifetimeModule.fadeLocation);
-                trail->color = Math::Lerp(particle->initialColor, stage->colorOverLifetimeModule.targetColor, f);
-            }
-        } else {
-            trail->color = particle->initialColor;
-        }
-
-        // Compute position.
-        if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::CustomPath)) {
-            ComputeTrailPositionFromCustomPath(stage->customPathModule, particle, trailFrac, trail);
-        } else if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTSpeed)) {
-            float dist = particle->initialSpeed * trailFrac + MeterToUnit(stage->speedOverLifetimeModule.speed.Integrate(particle->randomSpeed, trailFrac));
-
-            trail->position = particle->initialPosition + particle->direction * dist;
-        } else {
-            float dist = particle->initialSpeed * trailFrac;
-
-            trail->position = particle->initialPosition + particle->direction * dist;
-        }
-
-        // Apply force.
-        if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTForce)) {
-            Vec3 force(
-                MeterToUnit(stage->forceOverLifetimeModule.force[0].Evaluate(particle->randomForce.x, trailFrac)),
-                MeterToUnit(stage->forceOverLifetimeModule.force[1].Evaluate(particle->randomForce.y, trailFrac)),
-                MeterToUnit(stage->forceOverLifetimeModule.force[2].Evaluate(particle->randomForce.z, trailFrac)));
-        
-            trail->position += force * 0.5f * trailFrac * trailFrac;
-        }
-
-        // Apply gravity.
-        trail->position.z -= MeterToUnit(stage->standardModule.gravity) * 0.5f * trailFrac * trailFrac;
-
-        if (stage->standardModule.simulationSpace == ParticleSystem::StandardModule::SimulationSpace::Global) {
-            trail->position = offsetMatrix * trail->position;
-        }
-
-        // Add trail bounds to the entity bounds.
-        float radius;
-        if (stage->standardModule.orientation == ParticleSystem::StandardModule::Orientation::Aimed || 
-            stage->standardModule.orientation == ParticleSystem::StandardModule::Orientation::AimedZ) {
-            radius = trail->size * 0.5f * 2.0f;
-        } else {
-            radius = trail->size * 0.5f;
-        }
-
-        renderObjectDef.aabb.AddAABB(Sphere(trail->position, radius).ToAABB());
-    }
-}
-
-void ComParticleSystem::ComputeTrailPositionFromCustomPath(const ParticleSystem::CustomPathModule &customPathModule, const Particle *particle, float t, Particle::Trail *trail) const {
-    if (customPathModule.customPath == ParticleSystem::CustomPathModule::CustomPath::Cone) {
-        float radialTheta = t * DEG2RAD(customPathModule.radialSpeed);
-        float s, c;
-        Math::SinCos(radialTheta, s, c);
-        c = c * (1.0f - t);
-        s = s * (1.0f - t);
-
-        trail->position.x = particle->initialPosition.x * c + particle->initialPosition.y * s;
-        trail->position.y = particle->initialPosition.y * c - particle->initialPosition.x * s;
-        trail->position.z = 0;
-        return;
-    }
-    
-    if (customPathModule.customPath == ParticleSystem::CustomPathModule::CustomPath::Helix) {
-        float radialTheta = t * DEG2RAD(customPathModule.radialSpeed);
-        float s, c;
-        Math::SinCos(radialTheta, s, c);
-
-        trail->position.x = particle->initialPosition.x * c + particle->initialPosition.y * s;
-        trail->position.y = particle->initialPosition.y * c - particle->initialPosition.x * s;
-        trail->position.z = particle->initialPosition.z + t * particle->direction.z;
-        return;
-    }
-
-    if (customPathModule.customPath == ParticleSystem::CustomPathModule::CustomPath::Spherical) {
-        float radialTheta = t * DEG2RAD(customPathModule.radialSpeed);
-        float axialTheta = t * customPathModule.axialSpeed;
-        float s, c;
-        Math::SinCos(radialTheta, s, c);
-
-        Vec3 tmp = particle->initialPosition;
-        tmp.Normalize();
-        Vec3 rotDir = Vec3::unitZ.Cross(tmp);
-        Rotation rotation(Vec3::origin, rotDir, axialTheta);
-        Vec3 vec = rotation.RotatePoint(particle->initialPosition);
-
-        trail->position.x = vec.x * c + vec.y * s;
-        trail->position.y = vec.y * c - vec.x * s;
-        trail->position.z = vec.z;
-        return;
-    }
-
-    assert(0);
-}
-
 #if WITH_EDITOR
 void ComParticleSystem::DrawGizmos(const RenderCamera *camera, bool selected, bool selectedByParent) {
     // Fade icon alpha in near distance
@@ -116,11 +116,9 @@ void ComRenderable::UpdateVisuals() {
         return;
     }
 
+    // Combined mesh is rendered by the static batch.
     if (staticBatchIndex >= 0) {
-        const StaticBatch *staticBatch = StaticBatch::GetStaticBatchByIndex(staticBatchIndex);
-        if (staticBatch->GetRootEntity() != GetEntity()) {
-            return;
-        }
+        return;
     }
 
     if (renderObjectHandle == -1) {
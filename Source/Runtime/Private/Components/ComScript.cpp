@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/BinaryArchive.h"
 #include "IO/FileSystem.h"
 #include "Asset/Asset.h"
 #include "Asset/Resource.h"
@@ -129,6 +130,79 @@ void ComScript::Deserialize(const Json::Value &in) {
     deserializing = false;
 }
 
+void ComScript::Deserialize(const BinaryObject &in) {
+    // Get the script GUID in binary object.
+    Guid scriptGuid = Guid::zero;
+    Variant scriptGuidValue;
+    int valueIndex = in.FindValue("script");
+    if (valueIndex >= 0 && in.GetValue(valueIndex, 0, Variant::Type::Guid, scriptGuidValue)) {
+        scriptGuid = scriptGuidValue.As<Guid>();
+    }
+
+    state = &GetGameWorld()->GetLuaVM().State();
+
+    ChangeScript(scriptGuid);
+
+    deserializing = true;
+
+    // Script properties are known after the script is loaded.
+    Array<PropertyInfo> propertyInfoList;
+    GetPropertyInfoList(propertyInfoList);
+
+    DeserializeProperties(in, propertyInfoList);
+
+    deserializing = false;
+}
+
+void ComScript::CopyProperties(const Serializable *other, const Array<PropertyInfo> &propertyInfoList, const HashTable<Guid, Guid> &guidMap) {
+    const ComScript *otherScript = static_cast<const ComScript *>(other);
+
+    state = &GetGameWorld()->GetLuaVM().State();
+
+    // Script is kept when the properties are reset to the same script.
+    if (otherScript->scriptGuid != scriptGuid || !sandbox.IsValid()) {
+        ChangeScript(otherScript->scriptGuid);
+    }
+
+    deserializing = true;
+
+    // Script property accessors are bound to each component, so the values are set
+    // through the property info list of this component.
+    Array<PropertyInfo> dstPropertyInfoList;
+    GetPropertyInfoList(dstPropertyInfoList);
+
+    for (int propertyIndex = 0; propertyIndex < dstPropertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &dstPropertyInfo = dstPropertyInfoList[propertyIndex];
+
+        if (dstPropertyInfo.GetFlags() & (PropertyInfo::Flag::SkipSerialization | PropertyInfo::Flag::ReadOnly)) {
+            continue;
+        }
+
+        // Both lists are built from the same script, so the property is usually found at the same index.
+        int srcPropertyIndex = propertyIndex;
+        if (srcPropertyIndex >= propertyInfoList.Count() || Str::Cmp(propertyInfoList[srcPropertyIndex].GetName(), dstPropertyInfo.GetName())) {
+            for (srcPropertyIndex = 0; srcPropertyIndex < propertyInfoList.Count(); srcPropertyIndex++) {
+                if (!Str::Cmp(propertyInfoList[srcPropertyIndex].GetName(), dstPropertyInfo.GetName())) {
+                    break;
+                }
+            }
+            if (srcPropertyIndex == propertyInfoList.Count()) {
+                continue;
+            }
+        }
+
+        const PropertyInfo &srcPropertyInfo = propertyInfoList[srcPropertyIndex];
+        if (srcPropertyInfo.GetType() != dstPropertyInfo.GetType() ||
+            (srcPropertyInfo.GetFlags() & PropertyInfo::Flag::Array) != (dstPropertyInfo.GetFlags() & PropertyInfo::Flag::Array)) {
+            continue;
+        }
+
+        CopyProperty(other, srcPropertyInfo, dstPropertyInfo, guidMap);
+    }
+
+    deserializing = false;
+}
+
 void ComScript::ChangeScript(const Guid &scriptGuid) {
 #if WITH_EDITOR
     // Disconnect with previously connected script asset.
@@ -28,6 +28,8 @@ END_EVENTS
 void ComStaticMeshRenderer::RegisterProperties() {
     REGISTER_ACCESSOR_PROPERTY("occluder", "Occluder", bool, IsOccluder, SetOccluder, false, 
         "", PropertyInfo::Flag::Editor);
+    REGISTER_ACCESSOR_ARRAY_PROPERTY("lodScreenSizes", "LOD Screen Sizes", float, GetLODScreenSize, SetLODScreenSize, GetLODScreenSizeCount, SetLODScreenSizeCount, 0.25f, 
+        "Projected screen heights in ratio below which each LOD switches to the next coarser LOD", PropertyInfo::Flag::Editor).SetRange(0, 1, 0.01);
 }
 
 ComStaticMeshRenderer::ComStaticMeshRenderer() {
@@ -53,6 +55,8 @@ void ComStaticMeshRenderer::Purge(bool chainPurge) {
 void ComStaticMeshRenderer::Init() {
     ComMeshRenderer::Init();
 
+    GenerateMeshLODs();
+
     renderObjectDef.mesh = referenceMesh->InstantiateMesh(Mesh::Type::Static);
 
     // Mark as initialized
@@ -69,6 +73,8 @@ void ComStaticMeshRenderer::MeshUpdated() {
     renderWorld->RemoveRenderObject(renderObjectHandle);
     renderObjectHandle = -1;
 
+    GenerateMeshLODs();
+
     renderObjectDef.mesh = referenceMesh->InstantiateMesh(Mesh::Type::Static);
     renderObjectDef.aabb = referenceMesh->GetAABB();
 
@@ -88,4 +94,49 @@ void ComStaticMeshRenderer::SetOccluder(bool occluder) {
     UpdateVisuals();
 }
 
+void ComStaticMeshRenderer::GenerateMeshLODs() {
+    // LODs of the imported mesh are used as they are.
+    // Otherwise LODs are generated once in the shared reference mesh.
+    int numLODs = Min(renderObjectDef.lodScreenSizes.Count() + 1, (int)MeshSurf::MaxLODs);
+    if (numLODs > 1 && referenceMesh->NumLODs() == 1) {
+        referenceMesh->GenerateLODs(numLODs);
+    }
+}
+
+int ComStaticMeshRenderer::GetLODScreenSizeCount() const {
+    return renderObjectDef.lodScreenSizes.Count();
+}
+
+void ComStaticMeshRenderer::SetLODScreenSizeCount(int count) {
+    int oldCount = renderObjectDef.lodScreenSizes.Count();
+
+    renderObjectDef.lodScreenSizes.SetCount(Min(count, MeshSurf::MaxLODs - 1));
+
+    // Appended LOD switches at the half size of the previous one.
+    for (int index = oldCount; index < renderObjectDef.lodScreenSizes.Count(); index++) {
+        renderObjectDef.lodScreenSizes[index] = index > 0 ? renderObjectDef.lodScreenSizes[index - 1] * 0.5f : 0.25f;
+    }
+
+    if (IsInitialized()) {
+        GenerateMeshLODs();
+
+        UpdateVisuals();
+    }
+}
+
+float ComStaticMeshRenderer::GetLODScreenSize(int index) const {
+    if (index >= 0 && index < renderObjectDef.lodScreenSizes.Count()) {
+        return renderObjectDef.lodScreenSizes[index];
+    }
+    return 0.0f;
+}
+
+void ComStaticMeshRenderer::SetLODScreenSize(int index, float screenSize) {
+    if (index >= 0 && index < renderObjectDef.lodScreenSizes.Count()) {
+        renderObjectDef.lodScreenSizes[index] = screenSize;
+
+        UpdateVisuals();
+    }
+}
+
 BE_NAMESPACE_END
@@ -0,0 +1,860 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "jsoncpp/include/json/json.h"
+#include "Core/BinaryArchive.h"
+#include "Core/Object.h"
+#include "IO/FileSystem.h"
+#include "Platform/PlatformFile.h"
+
+BE_NAMESPACE_BEGIN
+
+static const int PropertyDescSize = 8;      // nameIndex (uint32), type (uint8), flags (uint8), reserved (uint16)
+
+struct CookedFlag {
+    enum Enum {
+        Array               = BIT(0),
+        Dynamic             = BIT(1),
+    };
+};
+
+template <typename T>
+static BE_INLINE T ReadRaw(const byte *ptr) {
+    T value;
+    memcpy(&value, ptr, sizeof(T));
+    return value;
+}
+
+// Reads the components of the math type into the variant.
+// Components are copied through the component pointer because the math types are not trivially copyable.
+template <typename T>
+static BE_INLINE void ReadComponents(const byte *ptr, Variant &out) {
+    T value;
+    memcpy(value.Ptr(), ptr, sizeof(T));
+    out = value;
+}
+
+// Returns payload size of one element of the cooked type. Returns 0 if the type can't be cooked.
+static int PayloadSize(int type) {
+    switch (type) {
+    case Variant::Type::Int:    return sizeof(int32_t);
+    case Variant::Type::Int64:  return sizeof(int64_t);
+    case Variant::Type::Bool:   return 1;
+    case Variant::Type::Float:  return sizeof(float);
+    case Variant::Type::Double: return sizeof(double);
+    case Variant::Type::Vec2:   return sizeof(Vec2);
+    case Variant::Type::Vec3:   return sizeof(Vec3);
+    case Variant::Type::Vec4:   return sizeof(Vec4);
+    case Variant::Type::Color3: return sizeof(Color3);
+    case Variant::Type::Color4: return sizeof(Color4);
+    case Variant::Type::Mat2:   return sizeof(Mat2);
+    case Variant::Type::Mat3:   return sizeof(Mat3);
+    case Variant::Type::Mat3x4: return sizeof(Mat3x4);
+    case Variant::Type::Mat4:   return sizeof(Mat4);
+    case Variant::Type::Angles: return sizeof(Angles);
+    case Variant::Type::Quat:   return sizeof(Quat);
+    case Variant::Type::Point:  return sizeof(Point);
+    case Variant::Type::PointF: return sizeof(PointF);
+    case Variant::Type::Size:   return sizeof(Size);
+    case Variant::Type::SizeF:  return sizeof(SizeF);
+    case Variant::Type::Rect:   return sizeof(Rect);
+    case Variant::Type::RectF:  return sizeof(RectF);
+    case Variant::Type::Guid:   return sizeof(int32_t);
+    case Variant::Type::Str:    return sizeof(int32_t);
+    default:                    return 0;
+    }
+}
+
+static bool IsNumericType(int type) {
+    return type == Variant::Type::Int || type == Variant::Type::Int64 || type == Variant::Type::Float || type == Variant::Type::Double || type == Variant::Type::Bool;
+}
+
+static double NumericValue(const Variant &value) {
+    switch (value.GetType()) {
+    case Variant::Type::Int:    return value.As<int>();
+    case Variant::Type::Int64:  return (double)value.As<int64_t>();
+    case Variant::Type::Float:  return value.As<float>();
+    case Variant::Type::Double: return value.As<double>();
+    case Variant::Type::Bool:   return value.As<bool>() ? 1.0 : 0.0;
+    default:                    return 0.0;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+//
+// BinaryObject
+//
+//--------------------------------------------------------------------------------------------------
+
+const char *BinaryObject::GetClassName() const {
+    return archive->classes[classIndex].name;
+}
+
+const MetaObject *BinaryObject::GetMetaObject() const {
+    return archive->classes[classIndex].metaObject;
+}
+
+Guid BinaryObject::GetGuid() const {
+    return guidIndex >= 0 ? archive->GetGuid(guidIndex) : Guid::zero;
+}
+
+const Array<PropertyInfo> &BinaryObject::GetPropertyInfoList() const {
+    return archive->ResolveClass(classIndex).propertyInfos;
+}
+
+int BinaryObject::FindValue(const PropertyInfo &propertyInfo, int propertyIndex) const {
+    const BinaryArchive::ClassEntry &classEntry = archive->ResolveClass(classIndex);
+
+    if (propertyIndex < classEntry.propertyToValue.Count()) {
+        int valueIndex = classEntry.propertyToValue[propertyIndex];
+        return valueIndex >= 0 && values[valueIndex] ? valueIndex : -1;
+    }
+
+    // Dynamic properties which are not in the class property list.
+    return FindValue(propertyInfo.GetName());
+}
+
+int BinaryObject::FindValue(const char *name) const {
+    const BinaryArchive::ClassEntry &classEntry = archive->classes[classIndex];
+
+    for (int valueIndex = 0; valueIndex < classEntry.numProperties; valueIndex++) {
+        if (!values[valueIndex]) {
+            continue;
+        }
+        int nameIndex, type, flags;
+        archive->GetPropertyDesc(classEntry, valueIndex, nameIndex, type, flags);
+
+        if (!Str::Cmp(archive->GetString(nameIndex), name)) {
+            return valueIndex;
+        }
+    }
+    return -1;
+}
+
+int BinaryObject::GetValueArrayCount(int valueIndex) const {
+    int nameIndex, type, flags;
+    archive->GetPropertyDesc(archive->classes[classIndex], valueIndex, nameIndex, type, flags);
+
+    if (!(flags & CookedFlag::Array)) {
+        return 1;
+    }
+    return (int)ReadRaw<uint32_t>(values[valueIndex]);
+}
+
+bool BinaryObject::GetValue(int valueIndex, int elementIndex, Variant::Type::Enum type, Variant &out) const {
+    int nameIndex, cookedType, flags;
+    archive->GetPropertyDesc(archive->classes[classIndex], valueIndex, nameIndex, cookedType, flags);
+
+    const byte *ptr = values[valueIndex];
+    if (flags & CookedFlag::Array) {
+        ptr += sizeof(uint32_t);
+    }
+    ptr += elementIndex * PayloadSize(cookedType);
+
+    switch (cookedType) {
+    case Variant::Type::Int:    out = (int)ReadRaw<int32_t>(ptr); break;
+    case Variant::Type::Int64:  out = ReadRaw<int64_t>(ptr); break;
+    case Variant::Type::Bool:   out = *ptr != 0; break;
+    case Variant::Type::Float:  out = ReadRaw<float>(ptr); break;
+    case Variant::Type::Double: out = ReadRaw<double>(ptr); break;
+    case Variant::Type::Vec2:   ReadComponents<Vec2>(ptr, out); break;
+    case Variant::Type::Vec3:   ReadComponents<Vec3>(ptr, out); break;
+    case Variant::Type::Vec4:   ReadComponents<Vec4>(ptr, out); break;
+    case Variant::Type::Color3: ReadComponents<Color3>(ptr, out); break;
+    case Variant::Type::Color4: ReadComponents<Color4>(ptr, out); break;
+    case Variant::Type::Mat2:   ReadComponents<Mat2>(ptr, out); break;
+    case Variant::Type::Mat3:   ReadComponents<Mat3>(ptr, out); break;
+    case Variant::Type::Mat3x4: ReadComponents<Mat3x4>(ptr, out); break;
+    case Variant::Type::Mat4:   ReadComponents<Mat4>(ptr, out); break;
+    case Variant::Type::Angles: ReadComponents<Angles>(ptr, out); break;
+    case Variant::Type::Quat:   ReadComponents<Quat>(ptr, out); break;
+    case Variant::Type::Point:  ReadComponents<Point>(ptr, out); break;
+    case Variant::Type::PointF: ReadComponents<PointF>(ptr, out); break;
+    case Variant::Type::Size:   ReadComponents<Size>(ptr, out); break;
+    case Variant::Type::SizeF:  ReadComponents<SizeF>(ptr, out); break;
+    case Variant::Type::Rect:   ReadComponents<Rect>(ptr, out); break;
+    case Variant::Type::RectF:  ReadComponents<RectF>(ptr, out); break;
+    case Variant::Type::Guid:   out = archive->GetGuid(ReadRaw<int32_t>(ptr)); break;
+    case Variant::Type::Str:    out = Str(archive->GetString(ReadRaw<int32_t>(ptr))); break;
+    default:
+        return false;
+    }
+
+    if (cookedType == type) {
+        return true;
+    }
+
+    // Dynamic properties are cooked with the JSON value type, so convert it to the runtime type.
+    if (cookedType == Variant::Type::Str) {
+        out = Variant::FromString(type, out.As<Str>().c_str());
+        return out.GetType() == type;
+    }
+
+    if (IsNumericType(cookedType) && IsNumericType(type)) {
+        double number = NumericValue(out);
+
+        switch (type) {
+        case Variant::Type::Int:    out = (int)number; break;
+        case Variant::Type::Int64:  out = (int64_t)number; break;
+        case Variant::Type::Float:  out = (float)number; break;
+        case Variant::Type::Double: out = number; break;
+        case Variant::Type::Bool:   out = number != 0.0; break;
+        default: break;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+//
+// BinaryArchive
+//
+//--------------------------------------------------------------------------------------------------
+
+BinaryArchive::~BinaryArchive() {
+    Close();
+}
+
+bool BinaryArchive::IsBinaryArchive(const char *filename) {
+    File *fp = fileSystem.OpenFileRead(filename, true);
+    if (!fp) {
+        return false;
+    }
+
+    uint32_t magic = 0;
+    size_t readSize = fp->Read(&magic, sizeof(magic));
+
+    fileSystem.CloseFile(fp);
+
+    return readSize == sizeof(magic) && magic == BinaryArchiveHeader::Magic;
+}
+
+bool BinaryArchive::Open(const char *filename) {
+    Close();
+
+    // Map the file directly if it exists in the file system, otherwise load it through the search paths (e.g. zip archives).
+    Str path = FileSystem::IsAbsolutePath(filename) ? Str(filename) : fileSystem.ToAbsolutePath(filename);
+    PlatformFileMapping *mapping = PlatformFileMapping::OpenFileRead(path.c_str());
+    if (mapping) {
+        fileMapping = mapping;
+        data = (const byte *)mapping->GetData();
+        size = mapping->GetSize();
+    } else {
+        File *file = fileSystem.OpenFileRead(filename, true);
+        if (!file) {
+            return false;
+        }
+
+        if (file->GetMappedData()) {
+            // Stored entry in the mapped zip archive is used without copy.
+            mappedFile = file;
+            data = (const byte *)file->GetMappedData();
+            size = file->Size();
+        } else {
+            size = file->Size();
+            fileData = (byte *)Mem_Alloc(size);
+            if (file->Read(fileData, size) != size) {
+                fileSystem.CloseFile(file);
+                Close();
+                return false;
+            }
+            fileSystem.CloseFile(file);
+            data = fileData;
+        }
+    }
+
+    if (!Parse()) {
+        BE_WARNLOG("BinaryArchive::Open: '%s' is not a valid binary archive\n", filename);
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void BinaryArchive::Close() {
+    if (fileMapping) {
+        delete (PlatformFileMapping *)fileMapping;
+        fileMapping = nullptr;
+    }
+    if (mappedFile) {
+        fileSystem.CloseFile(mappedFile);
+        mappedFile = nullptr;
+    }
+    if (fileData) {
+        fileSystem.FreeFile(fileData);
+        fileData = nullptr;
+    }
+    data = nullptr;
+    size = 0;
+    readPtr = nullptr;
+    recordsEnd = nullptr;
+    classes.Clear();
+}
+
+bool BinaryArchive::Parse() {
+    if (size < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != BinaryArchiveHeader::Magic || header.version != BinaryArchiveHeader::Version) {
+        return false;
+    }
+
+    size_t expectedSize = sizeof(header) + (size_t)header.numStrings * sizeof(uint32_t) + header.stringDataSize +
+        (size_t)header.numGuids * sizeof(Guid) + header.classTableSize + header.recordsSize;
+    if (size < expectedSize) {
+        return false;
+    }
+
+    const byte *ptr = data + sizeof(header);
+
+    stringOffsets = ptr;
+    ptr += header.numStrings * sizeof(uint32_t);
+
+    stringData = (const char *)ptr;
+    ptr += header.stringDataSize;
+
+    // String offsets should point in the string data, and the last string should be terminated in it.
+    if (header.numStrings > 0 && (header.stringDataSize == 0 || stringData[header.stringDataSize - 1] != '\0')) {
+        return false;
+    }
+    for (int stringIndex = 0; stringIndex < (int)header.numStrings; stringIndex++) {
+        if (ReadRaw<uint32_t>(stringOffsets + stringIndex * sizeof(uint32_t)) >= header.stringDataSize) {
+            return false;
+        }
+    }
+
+    guidTable = ptr;
+    ptr += header.numGuids * sizeof(Guid);
+
+    const byte *classTableEnd = ptr + header.classTableSize;
+
+    classes.SetCount(header.numClasses);
+
+    for (int classIndex = 0; classIndex < (int)header.numClasses; classIndex++) {
+        if (ptr + 2 * sizeof(uint32_t) > classTableEnd) {
+            return false;
+        }
+        ClassEntry &classEntry = classes[classIndex];
+        classEntry.name = GetString(ReadRaw<uint32_t>(ptr));
+        classEntry.metaObject = Object::FindMetaObject(classEntry.name);
+        classEntry.numProperties = ReadRaw<uint32_t>(ptr + sizeof(uint32_t));
+        classEntry.properties = ptr + 2 * sizeof(uint32_t);
+        classEntry.resolved = false;
+        classEntry.propertyInfos.Clear();
+        classEntry.propertyToValue.Clear();
+
+        ptr = classEntry.properties + classEntry.numProperties * PropertyDescSize;
+        if (ptr > classTableEnd) {
+            return false;
+        }
+    }
+
+    readPtr = classTableEnd;
+    recordsEnd = readPtr + header.recordsSize;
+
+    return true;
+}
+
+const char *BinaryArchive::GetString(int index) const {
+    if (index < 0 || index >= (int)header.numStrings) {
+        return "";
+    }
+    return stringData + ReadRaw<uint32_t>(stringOffsets + index * sizeof(uint32_t));
+}
+
+Guid BinaryArchive::GetGuid(int index) const {
+    if (index < 0 || index >= (int)header.numGuids) {
+        return Guid::zero;
+    }
+    return ReadRaw<Guid>(guidTable + index * sizeof(Guid));
+}
+
+void BinaryArchive::GetPropertyDesc(const ClassEntry &classEntry, int propertyIndex, int &nameIndex, int &type, int &flags) const {
+    const byte *ptr = classEntry.properties + propertyIndex * PropertyDescSize;
+
+    nameIndex = ReadRaw<uint32_t>(ptr);
+    type = (int8_t)ptr[4];
+    flags = ptr[5];
+}
+
+const BinaryArchive::ClassEntry &BinaryArchive::ResolveClass(int classIndex) const {
+    ClassEntry &classEntry = classes[classIndex];
+
+    if (classEntry.resolved) {
+        return classEntry;
+    }
+    classEntry.resolved = true;
+
+    if (!classEntry.metaObject) {
+        return classEntry;
+    }
+
+    // Map runtime properties to the cooked properties by name once per class,
+    // so that the archive is still readable after the class properties are changed.
+    classEntry.metaObject->GetPropertyInfoList(classEntry.propertyInfos);
+    classEntry.propertyToValue.SetCount(classEntry.propertyInfos.Count());
+
+    HashIndex nameHash(256, Max(classEntry.numProperties, 1));
+
+    for (int cookedIndex = 0; cookedIndex < classEntry.numProperties; cookedIndex++) {
+        int nameIndex, type, flags;
+        GetPropertyDesc(classEntry, cookedIndex, nameIndex, type, flags);
+
+        nameHash.Add(nameHash.GenerateHash(GetString(nameIndex)), cookedIndex);
+    }
+
+    for (int propertyIndex = 0; propertyIndex < classEntry.propertyInfos.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = classEntry.propertyInfos[propertyIndex];
+        int &valueIndex = classEntry.propertyToValue[propertyIndex];
+
+        valueIndex = -1;
+
+        for (int cookedIndex = nameHash.First(nameHash.GenerateHash(propertyInfo.GetName())); cookedIndex != -1; cookedIndex = nameHash.Next(cookedIndex)) {
+            int nameIndex, type, flags;
+            GetPropertyDesc(classEntry, cookedIndex, nameIndex, type, flags);
+
+            if (!Str::Cmp(GetString(nameIndex), propertyInfo.GetName()) && !!(flags & CookedFlag::Array) == propertyInfo.IsArray()) {
+                valueIndex = cookedIndex;
+                break;
+            }
+        }
+    }
+
+    return classEntry;
+}
+
+int32_t BinaryArchive::ReadInt32() {
+    if (readPtr + sizeof(int32_t) > recordsEnd) {
+        readPtr = recordsEnd;
+        return 0;
+    }
+    int32_t value = ReadRaw<int32_t>(readPtr);
+    readPtr += sizeof(int32_t);
+    return value;
+}
+
+bool BinaryArchive::ReadObject(BinaryObject &object) {
+    static const size_t RecordHeaderSize = 2 * sizeof(uint16_t) + sizeof(int32_t) + sizeof(uint32_t);
+
+    if (readPtr + RecordHeaderSize > recordsEnd) {
+        return false;
+    }
+
+    int classIndex = ReadRaw<uint16_t>(readPtr);
+    int numValues = ReadRaw<uint16_t>(readPtr + 2);
+    int guidIndex = ReadRaw<int32_t>(readPtr + 4);
+    uint32_t valuesSize = ReadRaw<uint32_t>(readPtr + 8);
+
+    const byte *ptr = readPtr + RecordHeaderSize;
+    const byte *end = ptr + valuesSize;
+
+    if (classIndex >= classes.Count() || end > recordsEnd) {
+        return false;
+    }
+
+    readPtr = end;
+
+    const ClassEntry &classEntry = classes[classIndex];
+
+    object.archive = this;
+    object.classIndex = classIndex;
+    object.guidIndex = guidIndex;
+    object.values.SetCount(classEntry.numProperties, false);
+    object.values.Fill(nullptr);
+
+    for (int i = 0; i < numValues; i++) {
+        if (ptr + sizeof(uint16_t) > end) {
+            return false;
+        }
+        int propertyIndex = ReadRaw<uint16_t>(ptr);
+        ptr += sizeof(uint16_t);
+
+        if (propertyIndex >= classEntry.numProperties) {
+            return false;
+        }
+
+        int nameIndex, type, flags;
+        GetPropertyDesc(classEntry, propertyIndex, nameIndex, type, flags);
+
+        object.values[propertyIndex] = ptr;
+
+        size_t payloadSize = PayloadSize(type);
+        if (flags & CookedFlag::Array) {
+            if (ptr + sizeof(uint32_t) > end) {
+                return false;
+            }
+            payloadSize = sizeof(uint32_t) + payloadSize * ReadRaw<uint32_t>(ptr);
+        }
+
+        ptr += payloadSize;
+        if (ptr > end) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+//
+// BinaryArchiveWriter
+//
+//--------------------------------------------------------------------------------------------------
+
+// Converts JSON value to the property type in the same way as Serializable::Deserialize().
+static Variant JsonToVariant(const Json::Value &value, Variant::Type::Enum type, const Variant &defaultValue) {
+    switch (type) {
+    case Variant::Type::Int:
+        return value.isNumeric() || value.isBool() ? Variant(value.asInt()) : defaultValue;
+    case Variant::Type::Int64:
+        return value.isNumeric() || value.isBool() ? Variant((int64_t)value.asInt64()) : defaultValue;
+    case Variant::Type::Bool:
+        return value.isNumeric() || value.isBool() ? Variant(value.asBool()) : defaultValue;
+    case Variant::Type::Float:
+        return value.isNumeric() || value.isBool() ? Variant(value.asFloat()) : defaultValue;
+    case Variant::Type::Double:
+        return value.isNumeric() || value.isBool() ? Variant(value.asDouble()) : defaultValue;
+    default:
+        return value.type() == Json::stringValue ? Variant::FromString(type, value.asCString()) : defaultValue;
+    }
+}
+
+// Returns the type to cook the JSON value of dynamic property.
+static Variant::Type::Enum JsonValueType(const Json::Value &value) {
+    switch (value.type()) {
+    case Json::intValue:
+    case Json::uintValue:
+        return value.isInt() ? Variant::Type::Int : Variant::Type::Int64;
+    case Json::realValue:
+        return Variant::Type::Float;
+    case Json::booleanValue:
+        return Variant::Type::Bool;
+    case Json::stringValue:
+        return Variant::Type::Str;
+    default:
+        return Variant::Type::None;
+    }
+}
+
+void BinaryArchiveWriter::WriteBytes(const void *data, size_t size) {
+    int offset = records.Count();
+    int newCount = offset + (int)size;
+
+    if (newCount > records.Capacity()) {
+        records.Reserve(Max(newCount, records.Capacity() * 2));
+    }
+    records.SetCount(newCount, false);
+
+    memcpy(records.Ptr() + offset, data, size);
+}
+
+void BinaryArchiveWriter::WriteInt32(int32_t value) {
+    WriteBytes(&value, sizeof(value));
+}
+
+void BinaryArchiveWriter::WriteVariant(const Variant &value) {
+    switch (value.GetType()) {
+    case Variant::Type::Int:    WriteInt32(value.As<int>()); break;
+    case Variant::Type::Int64:  WriteBytes(&value.As<int64_t>(), sizeof(int64_t)); break;
+    case Variant::Type::Bool:   { byte b = value.As<bool>() ? 1 : 0; WriteBytes(&b, 1); break; }
+    case Variant::Type::Float:  WriteBytes(&value.As<float>(), sizeof(float)); break;
+    case Variant::Type::Double: WriteBytes(&value.As<double>(), sizeof(double)); break;
+    case Variant::Type::Vec2:   WriteBytes(&value.As<Vec2>(), sizeof(Vec2)); break;
+    case Variant::Type::Vec3:   WriteBytes(&value.As<Vec3>(), sizeof(Vec3)); break;
+    case Variant::Type::Vec4:   WriteBytes(&value.As<Vec4>(), sizeof(Vec4)); break;
+    case Variant::Type::Color3: WriteBytes(&value.As<Color3>(), sizeof(Color3)); break;
+    case Variant::Type::Color4: WriteBytes(&value.As<Color4>(), sizeof(Color4)); break;
+    case Variant::Type::Mat2:   WriteBytes(&value.As<Mat2>(), sizeof(Mat2)); break;
+    case Variant::Type::Mat3:   WriteBytes(&value.As<Mat3>(), sizeof(Mat3)); break;
+    case Variant::Type::Mat3x4: WriteBytes(&value.As<Mat3x4>(), sizeof(Mat3x4)); break;
+    case Variant::Type::Mat4:   WriteBytes(&value.As<Mat4>(), sizeof(Mat4)); break;
+    case Variant::Type::Angles: WriteBytes(&value.As<Angles>(), sizeof(Angles)); break;
+    case Variant::Type::Quat:   WriteBytes(&value.As<Quat>(), sizeof(Quat)); break;
+    case Variant::Type::Point:  WriteBytes(&value.As<Point>(), sizeof(Point)); break;
+    case Variant::Type::PointF: WriteBytes(&value.As<PointF>(), sizeof(PointF)); break;
+    case Variant::Type::Size:   WriteBytes(&value.As<Size>(), sizeof(Size)); break;
+    case Variant::Type::SizeF:  WriteBytes(&value.As<SizeF>(), sizeof(SizeF)); break;
+    case Variant::Type::Rect:   WriteBytes(&value.As<Rect>(), sizeof(Rect)); break;
+    case Variant::Type::RectF:  WriteBytes(&value.As<RectF>(), sizeof(RectF)); break;
+    case Variant::Type::Guid:   WriteInt32(InternGuid(value.As<Guid>())); break;
+    case Variant::Type::Str:    WriteInt32(InternString(value.As<Str>().c_str())); break;
+    default:
+        assert(0);
+        break;
+    }
+}
+
+int BinaryArchiveWriter::InternString(const char *string) {
+    int hash = stringHash.GenerateHash(string);
+
+    for (int index = stringHash.First(hash); index != -1; index = stringHash.Next(index)) {
+        if (!strings[index].Cmp(string)) {
+            return index;
+        }
+    }
+
+    int index = strings.Append(string);
+    stringHash.Add(hash, index);
+    return index;
+}
+
+int BinaryArchiveWriter::InternGuid(const Guid &guid) {
+    int index;
+    if (guidToIndex.Get(guid, &index)) {
+        return index;
+    }
+
+    index = guids.Append(guid);
+    guidToIndex.Set(guid, index);
+    return index;
+}
+
+int BinaryArchiveWriter::FindClass(const char *classname) {
+    int nameIndex = InternString(classname);
+
+    for (int classIndex = 0; classIndex < classes.Count(); classIndex++) {
+        if (classes[classIndex].nameIndex == nameIndex) {
+            return classIndex;
+        }
+    }
+
+    const MetaObject *metaObject = Object::FindMetaObject(classname);
+    if (!metaObject) {
+        return -1;
+    }
+
+    ClassDesc &classDesc = classes.Alloc();
+    classDesc.nameIndex = nameIndex;
+
+    Array<PropertyInfo> propertyInfos;
+    metaObject->GetPropertyInfoList(propertyInfos);
+
+    for (int propertyIndex = 0; propertyIndex < propertyInfos.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = propertyInfos[propertyIndex];
+
+        // Same properties as Serializable::Deserialize() reads.
+        if (propertyInfo.GetFlags() & (PropertyInfo::Flag::SkipSerialization | PropertyInfo::Flag::ReadOnly)) {
+            continue;
+        }
+        if (!PayloadSize(propertyInfo.GetType())) {
+            continue;
+        }
+
+        PropertyDesc &propertyDesc = classDesc.properties.Alloc();
+        propertyDesc.nameIndex = InternString(propertyInfo.GetName());
+        propertyDesc.type = propertyInfo.GetType();
+        propertyDesc.flags = propertyInfo.IsArray() ? CookedFlag::Array : 0;
+
+        classDesc.propertyInfos.Append(propertyInfo);
+    }
+
+    return classes.Count() - 1;
+}
+
+int BinaryArchiveWriter::FindDynamicProperty(ClassDesc &classDesc, const char *name, Variant::Type::Enum type, bool isArray) {
+    int nameIndex = InternString(name);
+    int flags = CookedFlag::Dynamic | (isArray ? CookedFlag::Array : 0);
+
+    for (int propertyIndex = classDesc.propertyInfos.Count(); propertyIndex < classDesc.properties.Count(); propertyIndex++) {
+        const PropertyDesc &propertyDesc = classDesc.properties[propertyIndex];
+
+        if (propertyDesc.nameIndex == nameIndex && propertyDesc.type == type && propertyDesc.flags == flags) {
+            return propertyIndex;
+        }
+    }
+
+    PropertyDesc &propertyDesc = classDesc.properties.Alloc();
+    propertyDesc.nameIndex = nameIndex;
+    propertyDesc.type = type;
+    propertyDesc.flags = flags;
+
+    return classDesc.properties.Count() - 1;
+}
+
+bool BinaryArchiveWriter::WriteObject(const Json::Value &objectValue) {
+    const Str classname = objectValue.get("classname", "").asCString();
+
+    int classIndex = FindClass(classname);
+    if (classIndex < 0) {
+        BE_WARNLOG("BinaryArchiveWriter::WriteObject: Unknown class '%s'\n", classname.c_str());
+        return false;
+    }
+
+    const Guid guid = Guid::FromString(objectValue.get("guid", Guid::zero.ToString()).asCString());
+
+    // Record header is filled after writing values.
+    int recordOffset = records.Count();
+    uint16_t header[2] = { (uint16_t)classIndex, 0 };
+    WriteBytes(header, sizeof(header));
+    WriteInt32(guid.IsZero() ? -1 : InternGuid(guid));
+    WriteInt32(0);
+
+    int valuesOffset = records.Count();
+    int numValues = 0;
+
+    ClassDesc &classDesc = classes[classIndex];
+
+    for (int propertyIndex = 0; propertyIndex < classDesc.propertyInfos.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = classDesc.propertyInfos[propertyIndex];
+        const Json::Value &value = objectValue[propertyInfo.GetName()];
+
+        // Missing properties get default values at load time.
+        if (value.isNull()) {
+            continue;
+        }
+
+        uint16_t index = (uint16_t)propertyIndex;
+        WriteBytes(&index, sizeof(index));
+
+        if (propertyInfo.IsArray()) {
+            uint32_t numElements = value.isArray() ? value.size() : 0;
+            WriteInt32(numElements);
+
+            for (int elementIndex = 0; elementIndex < (int)numElements; elementIndex++) {
+                WriteVariant(JsonToVariant(value[elementIndex], propertyInfo.GetType(), propertyInfo.GetDefaultValue()));
+            }
+        } else {
+            WriteVariant(JsonToVariant(value, propertyInfo.GetType(), propertyInfo.GetDefaultValue()));
+        }
+
+        numValues++;
+    }
+
+    // Members which are not in the class properties (e.g. script fields).
+    const Json::Value::Members members = objectValue.getMemberNames();
+
+    for (const std::string &name : members) {
+        if (name == "classname" || name == "guid") {
+            continue;
+        }
+
+        bool isStatic = false;
+        for (int propertyIndex = 0; propertyIndex < classDesc.propertyInfos.Count(); propertyIndex++) {
+            if (name == classDesc.propertyInfos[propertyIndex].GetName()) {
+                isStatic = true;
+                break;
+            }
+        }
+        if (isStatic) {
+            continue;
+        }
+
+        // Nested objects (e.g. components) are written as separate records by the caller.
+        const Json::Value &value = objectValue[name];
+        const bool isArray = value.isArray();
+        const Variant::Type::Enum type = JsonValueType(isArray ? value.get(0u, Json::Value()) : value);
+        if (type == Variant::Type::None) {
+            continue;
+        }
+
+        int propertyIndex = FindDynamicProperty(classDesc, name.c_str(), type, isArray);
+
+        uint16_t index = (uint16_t)propertyIndex;
+        WriteBytes(&index, sizeof(index));
+
+        if (isArray) {
+            WriteInt32(value.size());
+
+            for (int elementIndex = 0; elementIndex < (int)value.size(); elementIndex++) {
+                WriteVariant(JsonToVariant(value[elementIndex], type, Variant::FromString(type, "")));
+            }
+        } else {
+            WriteVariant(JsonToVariant(value, type, Variant::FromString(type, "")));
+        }
+
+        numValues++;
+    }
+
+    header[1] = (uint16_t)numValues;
+    uint32_t valuesSize = records.Count() - valuesOffset;
+
+    memcpy(records.Ptr() + recordOffset, header, sizeof(header));
+    memcpy(records.Ptr() + recordOffset + sizeof(header) + sizeof(int32_t), &valuesSize, sizeof(valuesSize));
+
+    return true;
+}
+
+bool BinaryArchiveWriter::Save(const char *filename, int userVersion) const {
+    File *fp = fileSystem.OpenFileWrite(filename);
+    if (!fp) {
+        BE_WARNLOG("BinaryArchiveWriter::Save: Failed to open file '%s'\n", filename);
+        return false;
+    }
+
+    Array<uint32_t> stringOffsets;
+    stringOffsets.SetCount(strings.Count());
+
+    uint32_t stringDataSize = 0;
+    for (int i = 0; i < strings.Count(); i++) {
+        stringOffsets[i] = stringDataSize;
+        stringDataSize += strings[i].Length() + 1;
+    }
+
+    uint32_t classTableSize = 0;
+    for (int i = 0; i < classes.Count(); i++) {
+        classTableSize += 2 * sizeof(uint32_t) + classes[i].properties.Count() * PropertyDescSize;
+    }
+
+    BinaryArchiveHeader header;
+    header.magic = BinaryArchiveHeader::Magic;
+    header.version = BinaryArchiveHeader::Version;
+    header.userVersion = userVersion;
+    header.numStrings = strings.Count();
+    header.stringDataSize = stringDataSize;
+    header.numGuids = guids.Count();
+    header.numClasses = classes.Count();
+    header.classTableSize = classTableSize;
+    header.recordsSize = records.Count();
+
+    fp->Write(&header, sizeof(header));
+    fp->Write(stringOffsets.Ptr(), stringOffsets.Count() * sizeof(uint32_t));
+
+    for (int i = 0; i < strings.Count(); i++) {
+        fp->Write(strings[i].c_str(), strings[i].Length() + 1);
+    }
+
+    fp->Write(guids.Ptr(), guids.Count() * sizeof(Guid));
+
+    for (int i = 0; i < classes.Count(); i++) {
+        const ClassDesc &classDesc = classes[i];
+
+        uint32_t classHeader[2] = { (uint32_t)classDesc.nameIndex, (uint32_t)classDesc.properties.Count() };
+        fp->Write(classHeader, sizeof(classHeader));
+
+        for (int j = 0; j < classDesc.properties.Count(); j++) {
+            const PropertyDesc &propertyDesc = classDesc.properties[j];
+
+            byte desc[PropertyDescSize] = { 0 };
+            uint32_t nameIndex = propertyDesc.nameIndex;
+            memcpy(desc, &nameIndex, sizeof(nameIndex));
+            desc[4] = (byte)propertyDesc.type;
+            desc[5] = (byte)propertyDesc.flags;
+            fp->Write(desc, sizeof(desc));
+        }
+    }
+
+    fp->Write(records.Ptr(), records.Count());
+
+    fileSystem.CloseFile(fp);
+
+    return true;
+}
+
+BE_NAMESPACE_END
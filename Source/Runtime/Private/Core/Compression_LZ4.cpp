@@ -0,0 +1,228 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/Compression_LZ4.h"
+
+BE_NAMESPACE_BEGIN
+
+static const int    MinMatch = 4;
+static const int    LastLiterals = 5;       // last 5 bytes are always literals
+static const int    MatchFindLimit = 12;    // last match must start at least 12 bytes before the end
+static const int    MaxDistance = 65535;
+static const int    HashLog = 12;
+static const int    SkipTrigger = 6;
+
+static BE_INLINE uint32_t Read32(const byte *ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static BE_INLINE uint32_t HashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HashLog);
+}
+
+static BE_INLINE byte *WriteLength(byte *op, int length) {
+    for (; length >= 255; length -= 255) {
+        *op++ = 255;
+    }
+    *op++ = (byte)length;
+    return op;
+}
+
+static byte *WriteSequence(byte *op, const byte *opEnd, const byte *literals, int literalLength, int offset, int matchLength) {
+    // token + literal length bytes + literals + offset + match length bytes
+    if (op + 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1 > opEnd) {
+        return nullptr;
+    }
+
+    byte *token = op++;
+
+    if (literalLength >= 15) {
+        *token = 15 << 4;
+        op = WriteLength(op, literalLength - 15);
+    } else {
+        *token = (byte)(literalLength << 4);
+    }
+
+    memcpy(op, literals, literalLength);
+    op += literalLength;
+
+    if (offset == 0) {
+        // Last sequence has only literals.
+        return op;
+    }
+
+    *op++ = (byte)offset;
+    *op++ = (byte)(offset >> 8);
+
+    matchLength -= MinMatch;
+    if (matchLength >= 15) {
+        *token |= 15;
+        op = WriteLength(op, matchLength - 15);
+    } else {
+        *token |= (byte)matchLength;
+    }
+    return op;
+}
+
+int LZ4_CompressBound(int srcSize) {
+    return srcSize + srcSize / 255 + 16;
+}
+
+int LZ4_CompressBlock(const void *src, int srcSize, void *dst, int dstCapacity) {
+    const byte *in = (const byte *)src;
+    byte *op = (byte *)dst;
+    const byte *opEnd = op + dstCapacity;
+
+    int anchor = 0;
+
+    if (srcSize > MatchFindLimit) {
+        int hashTable[1 << HashLog];
+        memset(hashTable, 0, sizeof(hashTable));
+
+        const int matchFindLimit = srcSize - MatchFindLimit;
+        const int matchLimit = srcSize - LastLiterals;
+
+        int ip = 1;
+        int searchCount = 1 << SkipTrigger;
+
+        while (ip <= matchFindLimit) {
+            uint32_t sequence = Read32(&in[ip]);
+            uint32_t h = HashSequence(sequence);
+            int ref = hashTable[h];
+            hashTable[h] = ip;
+
+            if (ip - ref > MaxDistance || Read32(&in[ref]) != sequence) {
+                // Skip faster in incompressible data.
+                ip += searchCount++ >> SkipTrigger;
+                continue;
+            }
+            searchCount = 1 << SkipTrigger;
+
+            while (ip > anchor && ref > 0 && in[ip - 1] == in[ref - 1]) {
+                ip--;
+                ref--;
+            }
+
+            int matchLength = MinMatch;
+            while (ip + matchLength < matchLimit && in[ip + matchLength] == in[ref + matchLength]) {
+                matchLength++;
+            }
+
+            op = WriteSequence(op, opEnd, &in[anchor], ip - anchor, ip - ref, matchLength);
+            if (!op) {
+                return 0;
+            }
+
+            ip += matchLength;
+            anchor = ip;
+
+            if (ip <= matchFindLimit) {
+                hashTable[HashSequence(Read32(&in[ip - 2]))] = ip - 2;
+            }
+        }
+    }
+
+    op = WriteSequence(op, opEnd, &in[anchor], srcSize - anchor, 0, 0);
+    if (!op) {
+        return 0;
+    }
+    return (int)(op - (byte *)dst);
+}
+
+int LZ4_DecompressBlock(const void *src, int srcSize, void *dst, int dstCapacity) {
+    const byte *ip = (const byte *)src;
+    const byte *ipEnd = ip + srcSize;
+    byte *op = (byte *)dst;
+    byte *opEnd = op + dstCapacity;
+
+    while (ip < ipEnd) {
+        int token = *ip++;
+
+        int literalLength = token >> 4;
+        if (literalLength == 15) {
+            int b;
+            do {
+                if (ip >= ipEnd) {
+                    return -1;
+                }
+                b = *ip++;
+                literalLength += b;
+            } while (b == 255);
+        }
+
+        if (literalLength > ipEnd - ip || literalLength > opEnd - op) {
+            return -1;
+        }
+        memcpy(op, ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        if (ip >= ipEnd) {
+            break;
+        }
+
+        if (ipEnd - ip < 2) {
+            return -1;
+        }
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > op - (byte *)dst) {
+            return -1;
+        }
+
+        int matchLength = token & 15;
+        if (matchLength == 15) {
+            int b;
+            do {
+                if (ip >= ipEnd) {
+                    return -1;
+                }
+                b = *ip++;
+                matchLength += b;
+            } while (b == 255);
+        }
+        matchLength += MinMatch;
+
+        if (matchLength > opEnd - op) {
+            return -1;
+        }
+
+        const byte *match = op - offset;
+        if (offset >= 8) {
+            // Each 8 bytes chunk doesn't overlap with its source.
+            byte *copyEnd = op + matchLength;
+            while (copyEnd - op >= 8) {
+                memcpy(op, match, 8);
+                op += 8;
+                match += 8;
+            }
+            while (op < copyEnd) {
+                *op++ = *match++;
+            }
+        } else {
+            for (int i = 0; i < matchLength; i++) {
+                op[i] = match[i];
+            }
+            op += matchLength;
+        }
+    }
+
+    return (int)(op - (byte *)dst);
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,83 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/CVars.h"
+#include "Core/JobPool.h"
+
+BE_NAMESPACE_BEGIN
+
+static CVar                 jobPool_threads("jobPool_threads", "2", CVar::Flag::Integer, "number of the job threads shared by the engine subsystems, 0 to run the jobs in the calling thread");
+
+JobPool                     jobPool;
+
+void JobPool::Shutdown() {
+    if (taskManager) {
+        delete taskManager;
+        taskManager = nullptr;
+    }
+
+    numThreads = 0;
+}
+
+void JobPool::UpdateThreads() {
+    int newNumThreads = Max(jobPool_threads.GetInteger(), 0);
+
+    if (newNumThreads == numThreads) {
+        return;
+    }
+
+    Shutdown();
+
+    numThreads = newNumThreads;
+
+    if (numThreads > 0) {
+        taskManager = new TaskManager(MaxJobs + 1, numThreads);
+    }
+}
+
+static void RunInCallingThread(TaskFunc function, void *jobs, int jobSize, int numJobs) {
+    for (int i = 0; i < numJobs; i++) {
+        function((byte *)jobs + i * jobSize);
+    }
+}
+
+void JobPool::Run(TaskFunc function, void *jobs, int jobSize, int numJobs) {
+    // Pool is busy with the jobs of another thread, or this is called from the job itself.
+    if (numJobs == 1 || busy.exchange(true)) {
+        RunInCallingThread(function, jobs, jobSize, numJobs);
+        return;
+    }
+
+    UpdateThreads();
+
+    if (!taskManager) {
+        RunInCallingThread(function, jobs, jobSize, numJobs);
+    } else {
+        for (int firstJob = 0; firstJob < numJobs; firstJob += MaxJobs) {
+            int lastJob = Min(firstJob + MaxJobs, numJobs);
+
+            for (int i = firstJob; i < lastJob; i++) {
+                taskManager->AddTask(function, (byte *)jobs + i * jobSize);
+            }
+
+            taskManager->Start();
+            taskManager->WaitFinish();
+        }
+    }
+
+    busy = false;
+}
+
+BE_NAMESPACE_END
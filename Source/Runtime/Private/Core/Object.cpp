@@ -231,7 +231,8 @@ END_EVENTS
 bool                Object::initialized = false;
 Array<MetaObject *> Object::types;  // alphabetical order
 
-static HashTable<Guid, Object *> instanceHash;
+// Every spawned entity and component is looked up here, so the table is sized for large worlds.
+static HashTable<Guid, Object *> instanceHash(16384);
 static std::atomic<int> instanceCounter(0);
 
 void Object::RegisterProperties() {
@@ -16,6 +16,7 @@
 #include "jsoncpp/include/json/json.h"
 #include "Core/Serializable.h"
 #include "Core/Object.h"
+#include "Core/BinaryArchive.h"
 #include "Math/Math.h"
 
 BE_NAMESPACE_BEGIN
@@ -338,6 +339,190 @@ void Serializable::Deserialize(const Json::Value &node) {
     }
 }
 
+void Serializable::Deserialize(const BinaryObject &in) {
+    DeserializeProperties(in, in.GetPropertyInfoList());
+}
+
+void Serializable::DeserializeProperties(const BinaryObject &in, const Array<PropertyInfo> &propertyInfoList) {
+    Variant value;
+
+    for (int propertyIndex = 0; propertyIndex < propertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = propertyInfoList[propertyIndex];
+
+        if (propertyInfo.GetFlags() & (PropertyInfo::Flag::SkipSerialization | PropertyInfo::Flag::ReadOnly)) {
+            continue;
+        }
+
+        const Variant::Type::Enum type = propertyInfo.GetType();
+        const int valueIndex = in.FindValue(propertyInfo, propertyIndex);
+
+        if (propertyInfo.GetFlags() & PropertyInfo::Flag::Array) {
+            const int numElements = valueIndex >= 0 ? in.GetValueArrayCount(valueIndex) : 0;
+
+            SetPropertyArrayCount(propertyInfo, numElements);
+
+            for (int elementIndex = 0; elementIndex < numElements; elementIndex++) {
+                if (!in.GetValue(valueIndex, elementIndex, type, value)) {
+                    value = propertyInfo.GetDefaultValue();
+                }
+                SetArrayProperty(propertyInfo, elementIndex, value);
+            }
+        } else {
+            // Same as JSON, missing properties are set to the default value.
+            if (valueIndex < 0 || !in.GetValue(valueIndex, 0, type, value)) {
+                value = propertyInfo.GetDefaultValue();
+            }
+            SetProperty(propertyInfo, value);
+        }
+    }
+}
+
+void Serializable::CopyProperties(const Serializable *other, const Array<PropertyInfo> &propertyInfoList, const HashTable<Guid, Guid> &guidMap) {
+    for (int propertyIndex = 0; propertyIndex < propertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = propertyInfoList[propertyIndex];
+
+        if (propertyInfo.GetFlags() & (PropertyInfo::Flag::SkipSerialization | PropertyInfo::Flag::ReadOnly)) {
+            continue;
+        }
+
+        CopyProperty(other, propertyInfo, propertyInfo, guidMap);
+    }
+}
+
+template <typename T>
+static BE_INLINE void CopyMember(void *dest, const void *src) {
+    *reinterpret_cast<T *>(dest) = *reinterpret_cast<const T *>(src);
+}
+
+static BE_INLINE void RemapGuidValue(Variant &value, const HashTable<Guid, Guid> &guidMap) {
+    Guid toGuid;
+    if (guidMap.Get(value.As<Guid>(), &toGuid)) {
+        value = toGuid;
+    }
+}
+
+void Serializable::CopyProperty(const Serializable *other, const PropertyInfo &srcPropertyInfo, const PropertyInfo &dstPropertyInfo, const HashTable<Guid, Guid> &guidMap) {
+    const Variant::Type::Enum type = dstPropertyInfo.GetType();
+    Variant value;
+
+    if (dstPropertyInfo.GetFlags() & PropertyInfo::Flag::Array) {
+        const int numElements = other->GetPropertyArrayCount(srcPropertyInfo);
+
+        SetPropertyArrayCount(dstPropertyInfo, numElements);
+
+        for (int elementIndex = 0; elementIndex < numElements; elementIndex++) {
+            other->GetArrayProperty(srcPropertyInfo, elementIndex, value);
+            if (type == Variant::Type::Guid) {
+                RemapGuidValue(value, guidMap);
+            }
+            SetArrayProperty(dstPropertyInfo, elementIndex, value);
+        }
+        return;
+    }
+
+    if (srcPropertyInfo.accessor || dstPropertyInfo.accessor) {
+        // Accessors may have side effects, so values go through the variant.
+        other->GetProperty(srcPropertyInfo, value);
+        if (type == Variant::Type::Guid) {
+            RemapGuidValue(value, guidMap);
+        }
+        SetProperty(dstPropertyInfo, value);
+        return;
+    }
+
+    // Member values are copied directly. Source values are already clamped in range.
+    const void *src = reinterpret_cast<const byte *>(other) + srcPropertyInfo.offset;
+    void *dest = reinterpret_cast<byte *>(this) + dstPropertyInfo.offset;
+
+    switch (type) {
+    case Variant::Type::Int:
+        CopyMember<int>(dest, src);
+        break;
+    case Variant::Type::Int64:
+        CopyMember<int64_t>(dest, src);
+        break;
+    case Variant::Type::Bool:
+        CopyMember<bool>(dest, src);
+        break;
+    case Variant::Type::Float:
+        CopyMember<float>(dest, src);
+        break;
+    case Variant::Type::Double:
+        CopyMember<double>(dest, src);
+        break;
+    case Variant::Type::Vec2:
+        CopyMember<Vec2>(dest, src);
+        break;
+    case Variant::Type::Vec3:
+        CopyMember<Vec3>(dest, src);
+        break;
+    case Variant::Type::Vec4:
+        CopyMember<Vec4>(dest, src);
+        break;
+    case Variant::Type::Color3:
+        CopyMember<Color3>(dest, src);
+        break;
+    case Variant::Type::Color4:
+        CopyMember<Color4>(dest, src);
+        break;
+    case Variant::Type::Angles:
+        CopyMember<Angles>(dest, src);
+        break;
+    case Variant::Type::Quat:
+        CopyMember<Quat>(dest, src);
+        break;
+    case Variant::Type::Mat2:
+        CopyMember<Mat2>(dest, src);
+        break;
+    case Variant::Type::Mat3:
+        CopyMember<Mat3>(dest, src);
+        break;
+    case Variant::Type::Mat3x4:
+        CopyMember<Mat3x4>(dest, src);
+        break;
+    case Variant::Type::Mat4:
+        CopyMember<Mat4>(dest, src);
+        break;
+    case Variant::Type::Point:
+        CopyMember<Point>(dest, src);
+        break;
+    case Variant::Type::PointF:
+        CopyMember<PointF>(dest, src);
+        break;
+    case Variant::Type::Size:
+        CopyMember<Size>(dest, src);
+        break;
+    case Variant::Type::SizeF:
+        CopyMember<SizeF>(dest, src);
+        break;
+    case Variant::Type::Rect:
+        CopyMember<Rect>(dest, src);
+        break;
+    case Variant::Type::RectF:
+        CopyMember<RectF>(dest, src);
+        break;
+    case Variant::Type::Guid: {
+        Guid guid = *reinterpret_cast<const Guid *>(src);
+        guidMap.Get(guid, &guid);
+        *reinterpret_cast<Guid *>(dest) = guid;
+        break;
+    }
+    case Variant::Type::Str:
+        CopyMember<Str>(dest, src);
+        break;
+    case Variant::Type::MinMaxCurve:
+        CopyMember<MinMaxCurve>(dest, src);
+        break;
+    default:
+        // Other types go through the variant.
+        other->GetProperty(srcPropertyInfo, value);
+        SetProperty(dstPropertyInfo, value);
+        return;
+    }
+
+    EmitSignal(&Serializable::SIG_PropertyChanged, dstPropertyInfo.name.c_str(), -1);
+}
+
 Variant Serializable::GetPropertyDefault(const char *name) const {
     PropertyInfo propertyInfo;
     Variant out;
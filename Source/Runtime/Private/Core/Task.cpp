@@ -60,12 +60,6 @@ TaskManager::~TaskManager() {
     PlatformCondition::Destroy(finishCondition);
     PlatformMutex::Destroy(finishMutex);
 
-    // Destroy all the task threads.
-    for (int i = 0; i < taskThreads.Count(); i++) {
-        PlatformThread::Destroy(taskThreads[i]);
-    }
-    taskThreads.Clear();
-
     delete [] taskBuffer;
 }
 
@@ -110,7 +104,9 @@ void TaskManager::Stop() {
     PlatformMutex::Unlock(taskMutex);
 
     // Wait until finishing all the task threads.
+    // JoinAll() also frees the thread objects.
     PlatformThread::JoinAll(taskThreads.Count(), (PlatformBaseThread **)taskThreads.Ptr());
+    taskThreads.Clear();
 }
 
 void TaskManager::WaitFinish() {
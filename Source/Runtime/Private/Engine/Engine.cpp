@@ -48,6 +48,8 @@ void Engine::InitBase(const char *baseDir, bool forceGenericSIMD, const streamOu
 
     fileSystem.Init(baseDir);
 
+    derivedDataCache.Init();
+
     DetectCpu();
 
     SIMD::Init(forceGenericSIMD);
@@ -58,10 +60,14 @@ void Engine::InitBase(const char *baseDir, bool forceGenericSIMD, const streamOu
 }
 
 void Engine::ShutdownBase() {
+    jobPool.Shutdown();
+
     PlatformTime::Shutdown();
     
     SIMD::Shutdown();
 
+    derivedDataCache.Shutdown();
+
     fileSystem.Shutdown();
 
     cvarSystem.Shutdown();
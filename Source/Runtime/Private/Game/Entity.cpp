@@ -13,12 +13,14 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/BinaryArchive.h"
 #include "Components/Component.h"
 #include "Components/ComTransform.h"
 #include "Components/ComRectTransform.h"
 #include "Components/ComRenderable.h"
 #include "Components/ComScript.h"
 #include "Game/Entity.h"
+#include "Game/EntityCloneTemplate.h"
 #include "Game/GameWorld.h"
 
 BE_NAMESPACE_BEGIN
@@ -91,6 +93,8 @@ Entity::Entity() {
 
 Entity::~Entity() {
     Purge();
+
+    SAFE_DELETE(cloneTemplate);
 }
 
 void Entity::Purge() {
@@ -492,6 +496,42 @@ void Entity::Deserialize(const Json::Value &entityValue) {
     }
 }
 
+void Entity::Deserialize(const BinaryObject &entityObject, BinaryArchive &archive) {
+    Serializable::Deserialize(entityObject);
+
+    int numComponents = archive.ReadInt32();
+
+    BinaryObject componentObject;
+
+    for (int i = 0; i < numComponents; i++) {
+        if (!archive.ReadObject(componentObject)) {
+            BE_WARNLOG("Entity::Deserialize: Bad component record\n");
+            break;
+        }
+
+        const MetaObject *metaComponent = componentObject.GetMetaObject();
+
+        if (metaComponent) {
+            if (metaComponent->IsTypeOf(Component::metaObject)) {
+                Guid componentGuid = componentObject.GetGuid();
+                if (componentGuid.IsZero()) {
+                    componentGuid = Guid::CreateGuid();
+                }
+
+                Component *component = static_cast<Component *>(metaComponent->CreateInstance(componentGuid));
+                component->SetEntity(this);
+                component->Deserialize(componentObject);
+
+                AddComponent(component);
+            } else {
+                BE_WARNLOG("'%s' is not a component class\n", componentObject.GetClassName());
+            }
+        } else {
+            BE_WARNLOG("Unknown component class '%s'\n", componentObject.GetClassName());
+        }
+    }
+}
+
 void Entity::SerializeHierarchy(const Entity *entity, Json::Value &entitiesValue, bool forCopying) {
     Json::Value entityValue;
 
@@ -841,6 +881,21 @@ Entity *Entity::CreateEntity(Json::Value &entityValue, GameWorld *gameWorld, int
     return entity;
 }
 
+Entity *Entity::CreateEntity(const BinaryObject &entityObject, BinaryArchive &archive, GameWorld *gameWorld, int sceneNum) {
+    Guid entityGuid = entityObject.GetGuid();
+    if (entityGuid.IsZero()) {
+        entityGuid = Guid::CreateGuid();
+    }
+
+    Entity *entity = static_cast<Entity *>(Entity::metaObject.CreateInstance(entityGuid));
+
+    entity->gameWorld = gameWorld;
+    entity->sceneNum = sceneNum;
+    entity->Deserialize(entityObject, archive);
+
+    return entity;
+}
+
 Json::Value Entity::CloneEntityValue(const Json::Value &entityValue, HashTable<Guid, Guid> &oldToNewGuidMap) {
     // Copy entity JSON value
     Json::Value newEntityValue = entityValue;
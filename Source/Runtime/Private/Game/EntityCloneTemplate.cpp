@@ -0,0 +1,264 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Components/Component.h"
+#include "Components/ComScript.h"
+#include "Game/Entity.h"
+#include "Game/EntityCloneTemplate.h"
+
+BE_NAMESPACE_BEGIN
+
+void EntityCloneTemplate::Clear() {
+    entities.Clear();
+    components.Clear();
+}
+
+void EntityCloneTemplate::Init(const Entity *rootEntity) {
+    Clear();
+
+    AddEntity(rootEntity);
+}
+
+void EntityCloneTemplate::AddEntity(const Entity *entity) {
+    EntityEntry &entityEntry = entities.Alloc();
+    entityEntry.entity.source = entity;
+    entityEntry.entity.metaObject = entity->GetMetaObject();
+    entityEntry.entity.scriptProperties = false;
+    entity->GetPropertyInfoList(entityEntry.entity.propertyInfos);
+    entityEntry.firstComponent = components.Count();
+    entityEntry.numComponents = 0;
+
+    for (int componentIndex = 0; componentIndex < entity->NumComponents(); componentIndex++) {
+        const Component *component = entity->GetComponent(componentIndex);
+        if (!component) {
+            continue;
+        }
+
+        // Script components have their own properties which are changed by the script reloading,
+        // so the property info list is taken at clone time.
+        ObjectEntry &componentEntry = components.Alloc();
+        componentEntry.source = component;
+        componentEntry.metaObject = component->GetMetaObject();
+        componentEntry.scriptProperties = component->IsTypeOf<ComScript>();
+        if (!componentEntry.scriptProperties) {
+            component->GetPropertyInfoList(componentEntry.propertyInfos);
+        }
+
+        entities[entities.Count() - 1].numComponents++;
+    }
+
+    for (Entity *child = entity->GetNode().GetFirstChild(); child; child = child->GetNode().GetNextSibling()) {
+        AddEntity(child);
+    }
+}
+
+bool EntityCloneTemplate::IsValid(const Entity *rootEntity) const {
+    int entityIndex = 0;
+
+    if (!MatchEntity(rootEntity, entityIndex)) {
+        return false;
+    }
+    return entityIndex == entities.Count();
+}
+
+bool EntityCloneTemplate::MatchEntity(const Entity *entity, int &entityIndex) const {
+    if (entityIndex >= entities.Count()) {
+        return false;
+    }
+
+    const EntityEntry &entityEntry = entities[entityIndex++];
+    if (entityEntry.entity.source != entity) {
+        return false;
+    }
+
+    int numComponents = 0;
+    for (int componentIndex = 0; componentIndex < entity->NumComponents(); componentIndex++) {
+        const Component *component = entity->GetComponent(componentIndex);
+        if (!component) {
+            continue;
+        }
+        if (numComponents >= entityEntry.numComponents) {
+            return false;
+        }
+        // Removed component might be reallocated at the same address by the other class.
+        const ObjectEntry &componentEntry = components[entityEntry.firstComponent + numComponents];
+        if (componentEntry.source != component || componentEntry.metaObject != component->GetMetaObject()) {
+            return false;
+        }
+        numComponents++;
+    }
+
+    if (numComponents != entityEntry.numComponents) {
+        return false;
+    }
+
+    for (Entity *child = entity->GetNode().GetFirstChild(); child; child = child->GetNode().GetNextSibling()) {
+        if (!MatchEntity(child, entityIndex)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Entity *EntityCloneTemplate::Clone(GameWorld *gameWorld, int sceneNum) const {
+    if (entities.Count() == 0) {
+        return nullptr;
+    }
+
+    // Create all the new GUIDs first, so that references to the objects cloned later are remapped in one pass.
+    HashTable<Guid, Guid> guidMap;
+
+    Array<Guid> entityGuids;
+    entityGuids.SetCount(entities.Count());
+
+    for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
+        entityGuids[entityIndex] = Guid::CreateGuid();
+        guidMap.Set(entities[entityIndex].entity.source->GetGuid(), entityGuids[entityIndex]);
+    }
+
+    Array<Guid> componentGuids;
+    componentGuids.SetCount(components.Count());
+
+    for (int componentIndex = 0; componentIndex < components.Count(); componentIndex++) {
+        componentGuids[componentIndex] = Guid::CreateGuid();
+        guidMap.Set(components[componentIndex].source->GetGuid(), componentGuids[componentIndex]);
+    }
+
+    Entity *rootEntity = nullptr;
+
+    for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
+        const EntityEntry &entityEntry = entities[entityIndex];
+        const Entity *sourceEntity = static_cast<const Entity *>(entityEntry.entity.source);
+
+        Entity *entity = static_cast<Entity *>(Entity::metaObject.CreateInstance(entityGuids[entityIndex]));
+        entity->gameWorld = gameWorld;
+        entity->sceneNum = sceneNum;
+        entity->CopyProperties(sourceEntity, entityEntry.entity.propertyInfos, guidMap);
+
+        for (int i = 0; i < entityEntry.numComponents; i++) {
+            const int componentIndex = entityEntry.firstComponent + i;
+            const ObjectEntry &componentEntry = components[componentIndex];
+            const Component *sourceComponent = static_cast<const Component *>(componentEntry.source);
+
+            Component *component = static_cast<Component *>(sourceComponent->GetMetaObject()->CreateInstance(componentGuids[componentIndex]));
+            component->SetEntity(entity);
+            if (componentEntry.scriptProperties) {
+                Array<PropertyInfo> propertyInfos;
+                sourceComponent->GetPropertyInfoList(propertyInfos);
+
+                component->CopyProperties(sourceComponent, propertyInfos, guidMap);
+            } else {
+                component->CopyProperties(sourceComponent, componentEntry.propertyInfos, guidMap);
+            }
+
+            entity->AddComponent(component);
+        }
+
+        // If source entity is prefab source, mark cloned entity originated from prefab entity.
+        if (sourceEntity->IsPrefabSource()) {
+            entity->SetPrefabSourceGuid(sourceEntity->GetGuid());
+            entity->prefab = false;
+        }
+
+        entity->Init();
+        entity->InitComponents();
+
+        if (!rootEntity) {
+            rootEntity = entity;
+        }
+    }
+
+    return rootEntity;
+}
+
+bool EntityCloneTemplate::MatchClonedEntity(Entity *entity, int &entityIndex, Array<Entity *> &clonedEntities, HashTable<Guid, Guid> &guidMap) const {
+    if (entityIndex >= entities.Count()) {
+        return false;
+    }
+
+    const EntityEntry &entityEntry = entities[entityIndex++];
+    Guid entityGuid = entity->GetGuid();
+    guidMap.Set(entityEntry.entity.source->GetGuid(), entityGuid);
+    clonedEntities.Append(entity);
+
+    int numComponents = 0;
+    for (int componentIndex = 0; componentIndex < entity->NumComponents(); componentIndex++) {
+        const Component *component = entity->GetComponent(componentIndex);
+        if (!component) {
+            continue;
+        }
+        if (numComponents >= entityEntry.numComponents) {
+            return false;
+        }
+        const ObjectEntry &componentEntry = components[entityEntry.firstComponent + numComponents];
+        if (componentEntry.metaObject != component->GetMetaObject()) {
+            return false;
+        }
+        Guid componentGuid = component->GetGuid();
+        guidMap.Set(componentEntry.source->GetGuid(), componentGuid);
+        numComponents++;
+    }
+
+    if (numComponents != entityEntry.numComponents) {
+        return false;
+    }
+
+    for (Entity *child = entity->GetNode().GetFirstChild(); child; child = child->GetNode().GetNextSibling()) {
+        if (!MatchClonedEntity(child, entityIndex, clonedEntities, guidMap)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EntityCloneTemplate::ResetProperties(Entity *rootEntity) const {
+    // Match all the cloned objects first, so that references to the objects reset later are remapped in one pass.
+    HashTable<Guid, Guid> guidMap;
+    Array<Entity *> clonedEntities;
+    int numMatchedEntities = 0;
+
+    if (!MatchClonedEntity(rootEntity, numMatchedEntities, clonedEntities, guidMap) || numMatchedEntities != entities.Count()) {
+        return false;
+    }
+
+    for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
+        const EntityEntry &entityEntry = entities[entityIndex];
+        Entity *entity = clonedEntities[entityIndex];
+
+        int numComponents = 0;
+        for (int componentIndex = 0; componentIndex < entity->NumComponents(); componentIndex++) {
+            Component *component = entity->GetComponent(componentIndex);
+            if (!component) {
+                continue;
+            }
+
+            const ObjectEntry &componentEntry = components[entityEntry.firstComponent + numComponents++];
+            const Component *sourceComponent = static_cast<const Component *>(componentEntry.source);
+
+            if (componentEntry.scriptProperties) {
+                Array<PropertyInfo> propertyInfos;
+                sourceComponent->GetPropertyInfoList(propertyInfos);
+
+                component->CopyProperties(sourceComponent, propertyInfos, guidMap);
+            } else {
+                component->CopyProperties(sourceComponent, componentEntry.propertyInfos, guidMap);
+            }
+        }
+    }
+
+    return true;
+}
+
+BE_NAMESPACE_END
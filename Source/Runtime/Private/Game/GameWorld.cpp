@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/BinaryArchive.h"
 #include "IO/FileSystem.h"
 #include "Engine/GameClient.h"
 #include "Render/Render.h"
@@ -27,14 +28,15 @@
 #include "Components/ComCanvas.h"
 #include "Components/ComScript.h"
 #include "Components/ComRigidBody.h"
+#include "Components/ComParticleSystem.h"
 #include "Game/Entity.h"
+#include "Game/EntityCloneTemplate.h"
 #include "Game/MapRenderSettings.h"
 #include "Game/GameWorld.h"
 #include "Game/GameSettings.h"
 #include "Game/CastResult.h"
 #include "Scripting/LuaVM.h"
 #include "StaticBatching/StaticBatch.h"
-#include "../StaticBatching/MeshCombiner.h"
 #include "Profiler/Profiler.h"
 
 BE_NAMESPACE_BEGIN
@@ -136,6 +138,8 @@ void GameWorld::ClearEntities(bool clearAll) {
 
         entities[entityNum] = nullptr;
     }
+
+    ClearEntityPools();
 }
 
 Entity *GameWorld::FindEntityByName(const char *name) const {
@@ -293,6 +297,38 @@ bool GameWorld::IsRegisteredEntity(const Entity *ent) const {
 }
 
 void GameWorld::RegisterEntity(Entity *ent, int entityIndex) {
+    LinkEntity(ent, entityIndex);
+
+    if (!isMapLoading) {
+        if (gameAwaking) {
+            ent->Awake();
+        } else if (gameStarted) {
+            ent->Awake();
+            ent->Start();
+
+            StaticBatch::AddEntity(ent);
+        }
+    }
+
+    EmitSignal(&SIG_EntityRegistered, ent);
+}
+
+void GameWorld::UnregisterEntity(Entity *ent) {
+    if (!IsRegisteredEntity(ent)) {
+        BE_WARNLOG("GameWorld::UnregisterEntity: Entity '%s' is already unregistered\n", ent->GetName().c_str());
+        return;
+    }
+
+    StaticBatch::RemoveEntity(ent);
+
+    ent->node.RemoveFromHierarchy();
+
+    UnlinkEntity(ent);
+
+    EmitSignal(&SIG_EntityUnregistered, ent);
+}
+
+void GameWorld::LinkEntity(Entity *ent, int entityIndex) {
     int nameHash = entityHash.GenerateHash(ent->GetName());
     int tagHash = entityTagHash.GenerateHash(ent->GetTag());
 
@@ -317,71 +353,42 @@ void GameWorld::RegisterEntity(Entity *ent, int entityIndex) {
 
     entityHash.Add(nameHash, entityIndex);
     entityTagHash.Add(tagHash, entityIndex);
-
-    if (!isMapLoading) {
-        if (gameAwaking) {
-            ent->Awake();
-        } else if (gameStarted) {
-            ent->Awake();
-            ent->Start();
-        }
-    }
-
-    EmitSignal(&SIG_EntityRegistered, ent);
 }
 
-void GameWorld::UnregisterEntity(Entity *ent) {
-    if (!IsRegisteredEntity(ent)) {
-        BE_WARNLOG("GameWorld::UnregisterEntity: Entity '%s' is already unregistered\n", ent->GetName().c_str());
-        return;
-    }
-
+void GameWorld::UnlinkEntity(Entity *ent) {
     if (ent->entityNum < firstFreeIndex) {
         firstFreeIndex = ent->entityNum;
     }
 
-    ent->node.RemoveFromHierarchy();
-    
     entityHash.Remove(ent->nameHash, ent->entityNum);
     entityTagHash.Remove(ent->tagHash, ent->entityNum);
 
     int index = ent->entityNum;
     ent->entityNum = BadEntityNum;
     entities[index] = nullptr;
+}
 
-    EmitSignal(&SIG_EntityUnregistered, ent);
+// Prefab entities keep the clone template to be instantiated repeatedly.
+// The template is rebuilt when the hierarchy or the components of the prefab are changed.
+const EntityCloneTemplate *GameWorld::GetPrefabCloneTemplate(const Entity *prefabEntity) {
+    if (!prefabEntity->cloneTemplate) {
+        prefabEntity->cloneTemplate = new EntityCloneTemplate;
+        prefabEntity->cloneTemplate->Init(prefabEntity);
+    } else if (!prefabEntity->cloneTemplate->IsValid(prefabEntity)) {
+        prefabEntity->cloneTemplate->Init(prefabEntity);
+    }
+    return prefabEntity->cloneTemplate;
 }
 
 Entity *GameWorld::CloneEntity(const Entity *originalEntity) {
-    // Serialize source entity and it's children.
-    Json::Value originalEntitiesValue;
-    Entity::SerializeHierarchy(originalEntity, originalEntitiesValue);
-
-    // Clone entities value which is replaced by new GUIDs.
-    HashTable<Guid, Guid> guidMap;
-    Json::Value clonedEntitiesValue = Entity::CloneEntitiesValue(originalEntitiesValue, guidMap);
-
-    EntityPtrArray clonedEntities;
-
-    for (int i = 0; i < clonedEntitiesValue.size(); i++) {
-        // Create cloned entity.
-        Entity *clonedEntity = Entity::CreateEntity(clonedEntitiesValue[i], this, originalEntity->sceneNum);
-        clonedEntities.Append(clonedEntity);
-
-        // Remap all GUID references to newly created.
-        clonedEntity->RemapGuids(guidMap);
-
-        // If source entity is prefab source, mark cloned entity originated from prefab entity.
-        if (originalEntitiesValue[i]["prefab"].asBool()) {
-            clonedEntity->SetProperty("prefabSource", Guid::FromString(originalEntitiesValue[i]["guid"].asCString()));
-            clonedEntity->SetProperty("prefab", false);
-        }
-
-        clonedEntity->Init();
-        clonedEntity->InitComponents();
+    if (originalEntity->IsPrefabSource()) {
+        return GetPrefabCloneTemplate(originalEntity)->Clone(this, originalEntity->sceneNum);
     }
 
-    return clonedEntities[0];
+    EntityCloneTemplate cloneTemplate;
+    cloneTemplate.Init(originalEntity);
+
+    return cloneTemplate.Clone(this, originalEntity->sceneNum);
 }
 
 Entity *GameWorld::CreateEmptyEntity(const char *name) {
@@ -434,6 +441,194 @@ Entity *GameWorld::InstantiateEntityWithTransform(const Entity *originalEntity,
     return clonedEntity;
 }
 
+void GameWorld::SetEntityPoolSize(const Entity *prefabEntity, int poolSize) {
+    EntityPool *pool = FindEntityPool(prefabEntity->GetGuid());
+    if (!pool) {
+        pool = &entityPools.Alloc();
+        pool->prefabGuid = prefabEntity->GetGuid();
+    }
+
+    pool->poolSize = Max(poolSize, 0);
+
+    while (pool->parkedEntities.Count() > pool->poolSize) {
+        Entity *entity = pool->parkedEntities[pool->parkedEntities.Count() - 1];
+        pool->parkedEntities.RemoveIndex(pool->parkedEntities.Count() - 1);
+
+        DestroyParkedEntity(entity);
+    }
+}
+
+const EntityPool *GameWorld::GetEntityPool(const Entity *prefabEntity) const {
+    for (int poolIndex = 0; poolIndex < entityPools.Count(); poolIndex++) {
+        if (entityPools[poolIndex].prefabGuid == prefabEntity->GetGuid()) {
+            return &entityPools[poolIndex];
+        }
+    }
+    return nullptr;
+}
+
+EntityPool *GameWorld::FindEntityPool(const Guid &prefabGuid) {
+    for (int poolIndex = 0; poolIndex < entityPools.Count(); poolIndex++) {
+        if (entityPools[poolIndex].prefabGuid == prefabGuid) {
+            return &entityPools[poolIndex];
+        }
+    }
+    return nullptr;
+}
+
+// Resets rigid body velocities and active states of the parked entity and it's children to the prefab entity.
+static void ResetParkedEntityStates(Entity *entity, const Entity *prefabEntity, bool isRoot) {
+    ComRigidBody *rigidBody = entity->GetComponent<ComRigidBody>();
+    if (rigidBody) {
+        rigidBody->SetLinearVelocity(Vec3::zero);
+        rigidBody->SetAngularVelocity(Vec3::zero);
+    }
+
+    // Root entity is activated after it is linked to the scene again.
+    if (!isRoot) {
+        entity->SetActive(prefabEntity->IsActiveSelf());
+    }
+
+    Entity *child = entity->GetNode().GetFirstChild();
+    const Entity *prefabChild = prefabEntity->GetNode().GetFirstChild();
+
+    for (; child && prefabChild; child = child->GetNode().GetNextSibling(), prefabChild = prefabChild->GetNode().GetNextSibling()) {
+        ResetParkedEntityStates(child, prefabChild, false);
+    }
+}
+
+// Resets the parked entity and it's children to the prefab entity.
+// Returns false if the parked entity doesn't match with the prefab entity anymore.
+static bool ResetParkedEntity(Entity *entity, const Entity *prefabEntity, const EntityCloneTemplate *cloneTemplate) {
+    // Component and script properties changed while the entity was spawned are copied back from the prefab,
+    // including the local transforms.
+    if (!cloneTemplate->ResetProperties(entity)) {
+        return false;
+    }
+
+    ResetParkedEntityStates(entity, prefabEntity, true);
+    return true;
+}
+
+Entity *GameWorld::SpawnPooledEntity(const Entity *prefabEntity, const Vec3 &origin, const Quat &rotation) {
+    EntityPool *pool = FindEntityPool(prefabEntity->GetGuid());
+    if (!pool) {
+        return InstantiateEntityWithTransform(prefabEntity, origin, rotation);
+    }
+
+    const EntityCloneTemplate *cloneTemplate = pool->parkedEntities.Count() > 0 ? GetPrefabCloneTemplate(prefabEntity) : nullptr;
+
+    while (pool->parkedEntities.Count() > 0) {
+        Entity *entity = pool->parkedEntities[pool->parkedEntities.Count() - 1];
+        pool->parkedEntities.RemoveIndex(pool->parkedEntities.Count() - 1);
+
+        if (!ResetParkedEntity(entity, prefabEntity, cloneTemplate)) {
+            // Hierarchy or components of the entity were changed while it was spawned.
+            DestroyParkedEntity(entity);
+            continue;
+        }
+
+        pool->numHits++;
+
+        entity->GetTransform()->SetOriginRotation(origin, rotation);
+
+        entity->node.SetParent(scenes[entity->sceneNum].root);
+
+        EntityPtrArray children;
+        entity->GetChildrenRecursive(children);
+
+        LinkEntity(entity, -1);
+        EmitSignal(&SIG_EntityRegistered, entity);
+
+        for (int i = 0; i < children.Count(); i++) {
+            LinkEntity(children[i], -1);
+            EmitSignal(&SIG_EntityRegistered, children[i]);
+        }
+
+        // Components add their render objects and physics bodies to the worlds again.
+        entity->SetActive(prefabEntity->IsActiveSelf());
+        return entity;
+    }
+
+    pool->numMisses++;
+
+    return InstantiateEntityWithTransform(prefabEntity, origin, rotation);
+}
+
+void GameWorld::DespawnPooledEntity(Entity *entity) {
+    if (!IsRegisteredEntity(entity)) {
+        BE_WARNLOG("GameWorld::DespawnPooledEntity: Entity '%s' is not registered\n", entity->GetName().c_str());
+        return;
+    }
+
+    EntityPool *pool = FindEntityPool(entity->GetPrefabSourceGuid());
+    if (!pool || pool->parkedEntities.Count() >= pool->poolSize) {
+        if (pool) {
+            pool->numOverflows++;
+        }
+        Entity::DestroyInstance(entity);
+        return;
+    }
+
+    // Deactivating removes render objects and physics bodies from the worlds,
+    // but the components keep them to be added again.
+    entity->SetActive(false);
+
+    EntityPtrArray children;
+    entity->GetChildrenRecursive(children);
+
+    // Children stay attached to the parked entity.
+    entity->node.RemoveFromParent();
+
+    for (int i = children.Count() - 1; i >= 0; i--) {
+        UnlinkEntity(children[i]);
+        EmitSignal(&SIG_EntityUnregistered, children[i]);
+    }
+
+    UnlinkEntity(entity);
+    EmitSignal(&SIG_EntityUnregistered, entity);
+
+    pool->parkedEntities.Append(entity);
+}
+
+void GameWorld::DestroyParkedEntity(Entity *entity) {
+    EntityPtrArray children;
+    entity->GetChildrenRecursive(children);
+
+    // Destroy entities in reverse depth first order.
+    for (int i = children.Count() - 1; i >= 0; i--) {
+        Entity::DestroyInstanceImmediate(children[i]);
+    }
+    Entity::DestroyInstanceImmediate(entity);
+}
+
+void GameWorld::ClearEntityPools() {
+    for (int poolIndex = 0; poolIndex < entityPools.Count(); poolIndex++) {
+        EntityPool &pool = entityPools[poolIndex];
+
+        for (int i = 0; i < pool.parkedEntities.Count(); i++) {
+            DestroyParkedEntity(pool.parkedEntities[i]);
+        }
+        pool.parkedEntities.Clear();
+    }
+}
+
+void GameWorld::ListEntityPools() const {
+    for (int poolIndex = 0; poolIndex < entityPools.Count(); poolIndex++) {
+        const EntityPool &pool = entityPools[poolIndex];
+
+        const Object *prefabObject = Entity::FindInstance(pool.prefabGuid);
+        const Entity *prefabEntity = prefabObject ? prefabObject->Cast<Entity>() : nullptr;
+
+        int numSpawns = pool.numHits + pool.numMisses;
+        float hitRatio = numSpawns > 0 ? (float)pool.numHits / numSpawns : 0.0f;
+
+        BE_LOG("%s: %i/%i parked, %i hits, %i misses (%.1f%% hit), %i overflows\n",
+            prefabEntity ? prefabEntity->GetName().c_str() : pool.prefabGuid.ToString(),
+            pool.parkedEntities.Count(), pool.poolSize, pool.numHits, pool.numMisses, hitRatio * 100.0f, pool.numOverflows);
+    }
+}
+
 Entity *GameWorld::SpawnEntityFromJson(Json::Value &entityValue, int sceneIndex) {
     const char *classname = entityValue["classname"].asCString();
     if (Str::Cmp(classname, Entity::metaObject.ClassName()) != 0) {
@@ -461,6 +656,45 @@ void GameWorld::SpawnEntitiesFromJson(Json::Value &entitiesValue, int sceneIndex
     }
 }
 
+Entity *GameWorld::SpawnEntityFromBinary(BinaryArchive &archive, int sceneIndex) {
+    BinaryObject entityObject;
+    if (!archive.ReadObject(entityObject)) {
+        BE_WARNLOG("GameWorld::SpawnEntityFromBinary: Bad entity record\n");
+        return nullptr;
+    }
+
+    const char *classname = entityObject.GetClassName();
+    if (Str::Cmp(classname, Entity::metaObject.ClassName()) != 0) {
+        BE_WARNLOG("GameWorld::SpawnEntityFromBinary: Bad classname '%s' for entity\n", classname);
+        return nullptr;
+    }
+
+    int spawn_entnum = -1;
+    Variant spawnEntnumValue;
+    int valueIndex = entityObject.FindValue("spawn_entnum");
+    if (valueIndex >= 0 && entityObject.GetValue(valueIndex, 0, Variant::Type::Int, spawnEntnumValue)) {
+        spawn_entnum = spawnEntnumValue.As<int>();
+    }
+
+    Entity *entity = Entity::CreateEntity(entityObject, archive, this, sceneIndex);
+
+    entity->Init();
+    entity->InitComponents();
+
+    RegisterEntity(entity, spawn_entnum);
+
+    return entity;
+}
+
+void GameWorld::SpawnEntitiesFromBinary(BinaryArchive &archive, int sceneIndex) {
+    while (!archive.IsEOF()) {
+        // Records are sequential, so stop reading at the first bad record.
+        if (!SpawnEntityFromBinary(archive, sceneIndex)) {
+            break;
+        }
+    }
+}
+
 void GameWorld::BeginMapLoading() {
     isMapLoading = true;
 
@@ -627,30 +861,52 @@ bool GameWorld::LoadMap(const char *filename, LoadSceneMode::Enum mode) {
 
     BeginMapLoading();
 
-    char *text = nullptr;
-    fileSystem.LoadFile(filename, true, (void **)&text);
-    if (!text) {
-        BE_WARNLOG("Couldn't load '%s'\n", filename);
-        FinishMapLoading();
-        return false;
-    }
-
-    mapFilename = filename;
+    // Binary map is cooked from JSON map by CookMap().
+    const bool isBinaryMap = BinaryArchive::IsBinaryArchive(filename);
 
+    BinaryArchive archive;
     Json::Value map;
-    Json::Reader jsonReader;
-    if (!jsonReader.parse(text, map)) {
-        BE_WARNLOG("Failed to parse JSON text\n");
-        return false;
-    }
 
-    fileSystem.FreeFile(text);
+    if (isBinaryMap) {
+        if (!archive.Open(filename)) {
+            BE_WARNLOG("Couldn't load '%s'\n", filename);
+            FinishMapLoading();
+            return false;
+        }
+
+        mapFilename = filename;
+    } else {
+        char *text = nullptr;
+        fileSystem.LoadFile(filename, true, (void **)&text);
+        if (!text) {
+            BE_WARNLOG("Couldn't load '%s'\n", filename);
+            FinishMapLoading();
+            return false;
+        }
+
+        mapFilename = filename;
+
+        Json::Reader jsonReader;
+        if (!jsonReader.parse(text, map)) {
+            BE_WARNLOG("Failed to parse JSON text\n");
+            return false;
+        }
+
+        fileSystem.FreeFile(text);
+    }
 
     // Read map version.
-    int mapVersion = map["version"].asInt();
+    int mapVersion = isBinaryMap ? archive.GetUserVersion() : map["version"].asInt();
 
     // Read map render settings.
-    mapRenderSettings->Deserialize(map["renderSettings"]);
+    if (isBinaryMap) {
+        BinaryObject renderSettingsObject;
+        if (archive.ReadObject(renderSettingsObject)) {
+            mapRenderSettings->Deserialize(renderSettingsObject);
+        }
+    } else {
+        mapRenderSettings->Deserialize(map["renderSettings"]);
+    }
     mapRenderSettings->Init();
 
     // Find empty scene index.
@@ -664,7 +920,11 @@ bool GameWorld::LoadMap(const char *filename, LoadSceneMode::Enum mode) {
     assert(sceneIndex < COUNT_OF(scenes));
 
     // Read and spawn all entities.
-    SpawnEntitiesFromJson(map["entities"], sceneIndex);
+    if (isBinaryMap) {
+        SpawnEntitiesFromBinary(archive, sceneIndex);
+    } else {
+        SpawnEntitiesFromJson(map["entities"], sceneIndex);
+    }
 
     FinishMapLoading();
 
@@ -693,6 +953,71 @@ void GameWorld::SaveMap(const char *filename) {
     fileSystem.WriteFile(filename, jsonText.c_str(), jsonText.Length());
 }
 
+bool GameWorld::CookMap(const char *filename, const char *binaryFilename) {
+    BE_LOG("Cooking map '%s' to '%s'...\n", filename, binaryFilename);
+
+    char *text = nullptr;
+    fileSystem.LoadFile(filename, true, (void **)&text);
+    if (!text) {
+        BE_WARNLOG("Couldn't load '%s'\n", filename);
+        return false;
+    }
+
+    Json::Value map;
+    Json::Reader jsonReader;
+    if (!jsonReader.parse(text, map)) {
+        BE_WARNLOG("Failed to parse JSON text\n");
+        fileSystem.FreeFile(text);
+        return false;
+    }
+
+    fileSystem.FreeFile(text);
+
+    BinaryArchiveWriter writer;
+
+    // Cook map render settings.
+    Json::Value renderSettingsValue = map["renderSettings"];
+    renderSettingsValue["classname"] = MapRenderSettings::metaObject.ClassName();
+    writer.WriteObject(renderSettingsValue);
+
+    // Cook all entities. Each entity record is followed by the number of components and the component records.
+    const Json::Value &entitiesValue = map["entities"];
+
+    for (int i = 0; i < entitiesValue.size(); i++) {
+        const Json::Value &entityValue = entitiesValue[i];
+
+        const Str classname = entityValue.get("classname", "").asCString();
+        if (Str::Cmp(classname, Entity::metaObject.ClassName()) != 0) {
+            BE_WARNLOG("GameWorld::CookMap: Bad classname '%s' for entity\n", classname.c_str());
+            continue;
+        }
+
+        writer.WriteObject(entityValue);
+
+        const Json::Value &componentsValue = entityValue["components"];
+
+        // Unknown component classes can't be cooked.
+        Array<int> componentIndexes;
+        for (int componentIndex = 0; componentIndex < componentsValue.size(); componentIndex++) {
+            const Str componentClassname = componentsValue[componentIndex].get("classname", "").asCString();
+
+            if (Object::FindMetaObject(componentClassname)) {
+                componentIndexes.Append(componentIndex);
+            } else {
+                BE_WARNLOG("Unknown component class '%s'\n", componentClassname.c_str());
+            }
+        }
+
+        writer.WriteInt32(componentIndexes.Count());
+
+        for (int j = 0; j < componentIndexes.Count(); j++) {
+            writer.WriteObject(componentsValue[componentIndexes[j]]);
+        }
+    }
+
+    return writer.Save(binaryFilename, map["version"].asInt());
+}
+
 int GameWorld::GetDeltaTime() const {
     return deltaTime;
 }
@@ -722,9 +1047,14 @@ void GameWorld::Update(int elapsedMsec) {
 
         UpdateEntities();
 
+        SimulateParticleSystems();
+
         LateUpdateEntities();
 
         UpdateLuaVM();
+
+        // Combine static entities added or removed in this frame.
+        StaticBatch::UpdateDirtyCells();
     }
 }
 
@@ -772,6 +1102,17 @@ void GameWorld::LateUpdateEntities() {
     }
 }
 
+void GameWorld::SimulateParticleSystems() {
+    if (updatedParticleSystems.Count() == 0) {
+        return;
+    }
+
+    // Simulate particle systems updated in UpdateEntities() at once.
+    ComParticleSystem::SimulateParticleSystems(updatedParticleSystems);
+
+    updatedParticleSystems.SetCount(0, false);
+}
+
 void GameWorld::UpdateLuaVM() {
     BE_PROFILE_CPU_SCOPE_STATIC("GameWorld::UpdateLuaVM");
 
@@ -0,0 +1,438 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/Heap.h"
+#include "IO/FileSystem.h"
+#include "IO/AsyncIO.h"
+
+BE_NAMESPACE_BEGIN
+
+bool AsyncReadRequest::Cancel() {
+    return queue->CancelRequest(this);
+}
+
+void AsyncReadRequest::Wait() {
+    queue->WaitRequest(this);
+}
+
+void AsyncReadRequest::Release() {
+    queue->ReleaseRequest(this);
+}
+
+AsyncIOQueue::~AsyncIOQueue() {
+    Shutdown();
+}
+
+void AsyncIOQueue::Init(int maxReadsInFlight) {
+    if (running) {
+        return;
+    }
+
+    mutex = (PlatformMutex *)PlatformMutex::Create();
+    requestCondition = (PlatformCondition *)PlatformCondition::Create();
+    doneCondition = (PlatformCondition *)PlatformCondition::Create();
+
+    numActiveRequests = 0;
+    numReads = 0;
+    running = true;
+
+    for (int i = 0; i < Max(maxReadsInFlight, 1); i++) {
+        Worker *worker = new Worker;
+        worker->queue = this;
+        worker->openedFile = nullptr;
+        worker->thread = (PlatformThread *)PlatformThread::Create(IOThreadProc, (void *)worker, 0);
+        workers.Append(worker);
+    }
+}
+
+void AsyncIOQueue::Shutdown() {
+    if (!running) {
+        return;
+    }
+
+    Array<AsyncReadRequest *> canceledRequests;
+
+    PlatformMutex::Lock(mutex);
+
+    running = false;
+
+    for (int priority = 0; priority < AsyncIOPriority::Count; priority++) {
+        for (int i = 0; i < pendingRequests[priority].Count(); i++) {
+            AsyncReadRequest *request = pendingRequests[priority][i];
+            request->status = AsyncReadRequest::Status::Canceled;
+            canceledRequests.Append(request);
+        }
+        pendingRequests[priority].Clear();
+    }
+
+    PlatformCondition::Broadcast(requestCondition);
+    PlatformMutex::Unlock(mutex);
+
+    for (int i = 0; i < canceledRequests.Count(); i++) {
+        FinishRequest(canceledRequests[i], AsyncReadRequest::Status::Canceled);
+    }
+
+    // Reading requests are finished by the I/O threads before they exit.
+    for (int i = 0; i < workers.Count(); i++) {
+        PlatformThread::Join(workers[i]->thread);
+
+        if (workers[i]->openedFile) {
+            fileSystem.CloseFile(workers[i]->openedFile);
+        }
+        delete workers[i];
+    }
+    workers.Clear();
+
+    PlatformCondition::Destroy(doneCondition);
+    PlatformCondition::Destroy(requestCondition);
+    PlatformMutex::Destroy(mutex);
+
+    doneCondition = nullptr;
+    requestCondition = nullptr;
+    mutex = nullptr;
+}
+
+AsyncReadRequest *AsyncIOQueue::ReadAsync(const char *filename, size_t offset, size_t size, void *buffer, AsyncIOPriority::Enum priority, AsyncReadCallback callback, void *userData) {
+    if (!running) {
+        return nullptr;
+    }
+
+    AsyncReadRequest *request = new AsyncReadRequest;
+    request->queue = this;
+    request->filename = filename;
+    request->offset = offset;
+    request->size = size;
+    request->buffer = (byte *)buffer;
+    request->ownsBuffer = false;
+    request->priority = priority;
+    request->callback = callback;
+    request->userData = userData;
+
+    PlatformMutex::Lock(mutex);
+
+    pendingRequests[priority].Append(request);
+    numActiveRequests++;
+
+    PlatformCondition::Signal(requestCondition);
+    PlatformMutex::Unlock(mutex);
+
+    return request;
+}
+
+bool AsyncIOQueue::CancelRequest(AsyncReadRequest *request) {
+    if (request->done) {
+        return false;
+    }
+
+    PlatformMutex::Lock(mutex);
+
+    if (request->status != AsyncReadRequest::Status::Pending) {
+        PlatformMutex::Unlock(mutex);
+        return false;
+    }
+
+    pendingRequests[request->priority].Remove(request);
+    request->status = AsyncReadRequest::Status::Canceled;
+
+    PlatformMutex::Unlock(mutex);
+
+    FinishRequest(request, AsyncReadRequest::Status::Canceled);
+    return true;
+}
+
+void AsyncIOQueue::WaitRequest(AsyncReadRequest *request) {
+    if (request->done) {
+        return;
+    }
+
+    // Request is already finished in it's own callback, and done is set after the callback returns.
+    if (request->callbackThreadId == PlatformThread::GetCurrentThreadId()) {
+        return;
+    }
+
+    PlatformMutex::Lock(mutex);
+
+    while (!request->done) {
+        PlatformCondition::Wait(doneCondition, mutex);
+    }
+
+    PlatformMutex::Unlock(mutex);
+}
+
+void AsyncIOQueue::ReleaseRequest(AsyncReadRequest *request) {
+    // Released in it's own callback. FinishRequest() frees the request after the callback returns,
+    // unless the callback is called by canceling in the outer Release().
+    if (request->callbackThreadId == PlatformThread::GetCurrentThreadId()) {
+        request->releasedInCallback = true;
+        return;
+    }
+
+    request->releasing = true;
+
+    if (!request->done && !CancelRequest(request)) {
+        WaitRequest(request);
+    }
+
+    FreeRequest(request);
+}
+
+void AsyncIOQueue::FreeRequest(AsyncReadRequest *request) {
+    if (request->ownsBuffer) {
+        Mem_Free(request->buffer);
+    }
+    delete request;
+}
+
+void AsyncIOQueue::WaitIdle() {
+    if (!running) {
+        return;
+    }
+
+    PlatformMutex::Lock(mutex);
+
+    while (numActiveRequests > 0) {
+        PlatformCondition::Wait(doneCondition, mutex);
+    }
+
+    PlatformMutex::Unlock(mutex);
+}
+
+int AsyncIOQueue::NumPendingRequests() const {
+    if (!running) {
+        return 0;
+    }
+
+    PlatformMutex::Lock(mutex);
+
+    int count = 0;
+    for (int priority = 0; priority < AsyncIOPriority::Count; priority++) {
+        count += pendingRequests[priority].Count();
+    }
+
+    PlatformMutex::Unlock(mutex);
+    return count;
+}
+
+// Pops the oldest request of the highest priority, and the pending requests which can be read together with it.
+// Called with the mutex locked.
+bool AsyncIOQueue::PopBatch(Batch &batch) {
+    batch.requests.Clear();
+
+    for (int priority = AsyncIOPriority::Count - 1; priority >= 0; priority--) {
+        if (pendingRequests[priority].Count() > 0) {
+            batch.requests.Append(pendingRequests[priority][0]);
+            pendingRequests[priority].RemoveIndex(0);
+            break;
+        }
+    }
+
+    if (batch.requests.Count() == 0) {
+        return false;
+    }
+
+    AsyncReadRequest *first = batch.requests[0];
+    first->status = AsyncReadRequest::Status::Reading;
+
+    if (first->size == 0) {
+        // Size is unknown until the file is opened.
+        return true;
+    }
+
+    batch.start = first->offset;
+    batch.end = first->offset + first->size;
+
+    // Grow the range until no more pending requests are adjacent to it.
+    bool grown = true;
+    while (grown) {
+        grown = false;
+
+        for (int priority = AsyncIOPriority::Count - 1; priority >= 0; priority--) {
+            Array<AsyncReadRequest *> &requests = pendingRequests[priority];
+
+            for (int i = 0; i < requests.Count(); i++) {
+                AsyncReadRequest *request = requests[i];
+                if (request->size == 0 || request->filename.Cmp(first->filename)) {
+                    continue;
+                }
+
+                size_t requestEnd = request->offset + request->size;
+                if (request->offset > batch.end + MaxCoalescedGap || requestEnd + MaxCoalescedGap < batch.start) {
+                    continue;
+                }
+
+                size_t start = Min(batch.start, request->offset);
+                size_t end = Max(batch.end, requestEnd);
+                if (end - start > MaxCoalescedSize) {
+                    continue;
+                }
+
+                batch.start = start;
+                batch.end = end;
+
+                request->status = AsyncReadRequest::Status::Reading;
+                batch.requests.Append(request);
+                requests.RemoveIndex(i);
+                i--;
+                grown = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+File *AsyncIOQueue::OpenFile(Worker *worker, const char *filename) {
+    if (worker->openedFile) {
+        if (!worker->openedFileName.Cmp(filename)) {
+            return worker->openedFile;
+        }
+        fileSystem.CloseFile(worker->openedFile);
+        worker->openedFile = nullptr;
+    }
+
+    worker->openedFile = fileSystem.OpenFileRead(filename, true);
+    if (worker->openedFile) {
+        worker->openedFileName = filename;
+    }
+    return worker->openedFile;
+}
+
+void AsyncIOQueue::ProcessBatch(Worker *worker, Batch &batch) {
+    File *file = OpenFile(worker, batch.requests[0]->filename);
+    if (!file) {
+        for (int i = 0; i < batch.requests.Count(); i++) {
+            FinishRequest(batch.requests[i], AsyncReadRequest::Status::Failed);
+        }
+        return;
+    }
+
+    size_t fileSize = file->Size();
+
+    if (batch.requests.Count() == 1) {
+        AsyncReadRequest *request = batch.requests[0];
+
+        size_t size = request->size;
+        if (size == 0) {
+            size = request->offset < fileSize ? fileSize - request->offset : 0;
+        }
+
+        if (request->offset + size > fileSize) {
+            FinishRequest(request, AsyncReadRequest::Status::Failed);
+            return;
+        }
+
+        if (!request->buffer) {
+            request->buffer = (byte *)Mem_Alloc(Max(size, (size_t)1));
+            request->ownsBuffer = true;
+        }
+
+        if (file->Seek(request->offset) == 0) {
+            request->bytesRead = file->Read(request->buffer, size);
+        }
+        numReads++;
+
+        FinishRequest(request, request->bytesRead == size ? AsyncReadRequest::Status::Completed : AsyncReadRequest::Status::Failed);
+        return;
+    }
+
+    // Read the coalesced range at once and copy the parts to each request.
+    size_t end = Min(batch.end, fileSize);
+    size_t bytesRead = 0;
+
+    if (batch.start < end) {
+        worker->coalesceBuffer.SetCount((int)(end - batch.start), false);
+
+        if (file->Seek(batch.start) == 0) {
+            bytesRead = file->Read(worker->coalesceBuffer.Ptr(), end - batch.start);
+        }
+    }
+    numReads++;
+
+    for (int i = 0; i < batch.requests.Count(); i++) {
+        AsyncReadRequest *request = batch.requests[i];
+
+        if (request->offset + request->size > batch.start + bytesRead) {
+            FinishRequest(request, AsyncReadRequest::Status::Failed);
+            continue;
+        }
+
+        if (!request->buffer) {
+            request->buffer = (byte *)Mem_Alloc(request->size);
+            request->ownsBuffer = true;
+        }
+
+        memcpy(request->buffer, worker->coalesceBuffer.Ptr() + (request->offset - batch.start), request->size);
+        request->bytesRead = request->size;
+
+        FinishRequest(request, AsyncReadRequest::Status::Completed);
+    }
+}
+
+void AsyncIOQueue::FinishRequest(AsyncReadRequest *request, AsyncReadRequest::Status::Enum status) {
+    request->status = status;
+
+    if (request->callback) {
+        request->callbackThreadId = PlatformThread::GetCurrentThreadId();
+        request->callback(request, request->userData);
+        request->callbackThreadId = 0;
+    }
+
+    const bool freeRequest = request->releasedInCallback && !request->releasing;
+
+    PlatformMutex::Lock(mutex);
+
+    request->done = true;
+    numActiveRequests--;
+
+    PlatformCondition::Broadcast(doneCondition);
+    PlatformMutex::Unlock(mutex);
+
+    if (freeRequest) {
+        FreeRequest(request);
+    }
+}
+
+void AsyncIOQueue::IOThreadProc(void *param) {
+    Worker *worker = (Worker *)param;
+    AsyncIOQueue *queue = worker->queue;
+    Batch batch;
+
+    while (1) {
+        PlatformMutex::Lock(queue->mutex);
+
+        while (queue->running && !queue->PopBatch(batch)) {
+            if (worker->openedFile) {
+                // Don't keep the file open while idle.
+                PlatformMutex::Unlock(queue->mutex);
+                fileSystem.CloseFile(worker->openedFile);
+                worker->openedFile = nullptr;
+                PlatformMutex::Lock(queue->mutex);
+                continue;
+            }
+            PlatformCondition::Wait(queue->requestCondition, queue->mutex);
+        }
+
+        if (!queue->running) {
+            PlatformMutex::Unlock(queue->mutex);
+            break;
+        }
+
+        PlatformMutex::Unlock(queue->mutex);
+
+        queue->ProcessBatch(worker, batch);
+    }
+}
+
+BE_NAMESPACE_END
@@ -17,7 +17,8 @@
 #include "Core/Guid.h"
 #include "Core/Object.h"
 #include "IO/File.h"
-#include "minizip/unzip.h"
+#include "IO/FileSystem.h"
+#include "zlib.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -152,6 +153,38 @@ size_t File::ReadObject(Object &object) {
     return size;
 }
 
+template <typename T>
+static size_t ReadArray(const File *file, T *values, int count) {
+    size_t result = file->Read(values, sizeof(T) * count);
+
+    if (ByteOrder::GetEndianness() == ByteOrder::Endianness::BigEndian) {
+        for (int i = 0; i < count; i++) {
+            ByteOrder::LittleEndianToSystem(values[i]);
+        }
+    }
+    return result;
+}
+
+size_t File::ReadInt16Array(int16_t *values, int count) {
+    return ReadArray(this, values, count);
+}
+
+size_t File::ReadUInt16Array(uint16_t *values, int count) {
+    return ReadArray(this, values, count);
+}
+
+size_t File::ReadInt32Array(int32_t *values, int count) {
+    return ReadArray(this, values, count);
+}
+
+size_t File::ReadUInt32Array(uint32_t *values, int count) {
+    return ReadArray(this, values, count);
+}
+
+size_t File::ReadFloatArray(float *values, int count) {
+    return ReadArray(this, values, count);
+}
+
 size_t File::WriteBool(const bool value) {
     return WriteUChar((unsigned char)(value ? 1 : 0));
 }
@@ -296,13 +329,58 @@ bool FileReal::Write(const void *buffer, size_t bytesToWrite) {
 // FileInZip
 //---------------------------------------------------------------
 
-FileInZip::FileInZip(const char *filename, void *pointer) {
+FileInZip::FileInZip(const char *filename, PlatformFile *pf, size_t dataOffset, size_t compressedSize, size_t uncompressedSize, int compressionMethod) {
     Str::Copynz(this->filename, filename, COUNT_OF(this->filename));
-    this->pointer = pointer;
+    this->pf = pf;
+    this->dataOffset = dataOffset;
+    this->compressedSize = compressedSize;
+    this->size = uncompressedSize;
+    this->compressionMethod = compressionMethod;
+
+    if (compressionMethod == Z_DEFLATED) {
+        InitInflate();
+
+        inBuffer = (byte *)Mem_Alloc(InputBufferSize);
+    }
+
+    pf->Seek((long)dataOffset, PlatformFile::Origin::Start);
+}
+
+FileInZip::FileInZip(const char *filename, const byte *mappedData, size_t compressedSize, size_t uncompressedSize, int compressionMethod) {
+    Str::Copynz(this->filename, filename, COUNT_OF(this->filename));
+    this->mappedData = mappedData;
+    this->compressedSize = compressedSize;
+    this->size = uncompressedSize;
+    this->compressionMethod = compressionMethod;
+
+    if (compressionMethod == Z_DEFLATED) {
+        InitInflate();
+    }
+}
+
+void FileInZip::InitInflate() {
+    z_stream *zs = (z_stream *)Mem_ClearedAlloc(sizeof(z_stream));
+    // Raw deflate data without zlib header.
+    inflateInit2(zs, -MAX_WBITS);
+    stream = zs;
 }
 
 FileInZip::~FileInZip() {
-    unzCloseCurrentFile(pointer);
+    for (int i = 0; i < checkpoints.Count(); i++) {
+        inflateEnd((z_stream *)checkpoints[i].stream);
+        Mem_Free(checkpoints[i].stream);
+    }
+
+    if (stream) {
+        inflateEnd((z_stream *)stream);
+        Mem_Free(stream);
+    }
+
+    if (inBuffer) {
+        Mem_Free(inBuffer);
+    }
+
+    SAFE_DELETE(pf);
 }
 
 size_t FileInZip::Size() const {
@@ -310,21 +388,160 @@ size_t FileInZip::Size() const {
 }
 
 int FileInZip::Tell() const {
-    return (int)unztell(pointer);
+    return (int)pos;
+}
+
+void FileInZip::ResetInflate() const {
+    z_stream *zs = (z_stream *)stream;
+    inflateReset(zs);
+    zs->next_in = nullptr;
+    zs->avail_in = 0;
+
+    pos = 0;
+    inPos = 0;
 }
 
 int FileInZip::Seek(int64_t offset) {
-    BE_FATALERROR("ZIP FILE FSEEK NOT YET IMPLEMENTED");
+    if (offset < 0 || offset > (int64_t)size) {
+        return -1;
+    }
+
+    if (compressionMethod != Z_DEFLATED) {
+        // Stored entry is seekable directly.
+        pos = (size_t)offset;
+        if (mappedData) {
+            return 0;
+        }
+        return pf->Seek((long)(dataOffset + pos), PlatformFile::Origin::Start);
+    }
+
+    // Find the last checkpoint before the offset.
+    int checkpointIndex = -1;
+    for (int i = 0; i < checkpoints.Count() && checkpoints[i].outPos <= (size_t)offset; i++) {
+        checkpointIndex = i;
+    }
+
+    if (checkpointIndex >= 0 && ((size_t)offset < pos || checkpoints[checkpointIndex].outPos > pos)) {
+        // Restore the inflate state at the checkpoint.
+        const Checkpoint &checkpoint = checkpoints[checkpointIndex];
+        z_stream *zs = (z_stream *)stream;
+
+        inflateEnd(zs);
+        inflateCopy(zs, (z_stream *)checkpoint.stream);
+        zs->next_in = nullptr;
+        zs->avail_in = 0;
+
+        pos = checkpoint.outPos;
+        inPos = checkpoint.inPos;
+    } else if ((size_t)offset < pos) {
+        ResetInflate();
+    }
+
+    // Inflate the rest up to the offset.
+    byte skipBuffer[4096];
+    while (pos < (size_t)offset) {
+        size_t skipSize = Min((size_t)offset - pos, sizeof(skipBuffer));
+        if (Inflate(skipBuffer, skipSize) == 0) {
+            return -1;
+        }
+    }
     return 0;
 }
 
 int FileInZip::SeekFromEnd(int64_t offset) {
-    BE_FATALERROR("ZIP FILE FSEEK NOT YET IMPLEMENTED");
-    return 0;
+    return Seek((int64_t)size + offset);
+}
+
+size_t FileInZip::Inflate(void *buffer, size_t bytesToRead) const {
+    z_stream *zs = (z_stream *)stream;
+
+    zs->next_out = (Bytef *)buffer;
+    zs->avail_out = (uInt)bytesToRead;
+
+    while (zs->avail_out > 0) {
+        if (zs->avail_in == 0) {
+            if (mappedData) {
+                // Feed the rest of the mapped data at once.
+                size_t inSize = Min(compressedSize - inPos, (size_t)UINT_MAX);
+                if (inSize == 0) {
+                    break;
+                }
+
+                zs->next_in = (Bytef *)(mappedData + inPos);
+                zs->avail_in = (uInt)inSize;
+
+                inPos += inSize;
+            } else {
+                size_t inSize = Min(compressedSize - inPos, InputBufferSize);
+                if (inSize == 0) {
+                    break;
+                }
+
+                pf->Seek((long)(dataOffset + inPos), PlatformFile::Origin::Start);
+                inSize = pf->Read(inBuffer, inSize);
+                if (inSize == 0) {
+                    break;
+                }
+
+                zs->next_in = inBuffer;
+                zs->avail_in = (uInt)inSize;
+
+                inPos += inSize;
+            }
+        }
+
+        uInt availOut = zs->avail_out;
+        int ret = inflate(zs, Z_NO_FLUSH);
+        pos += availOut - zs->avail_out;
+
+        if (ret == Z_STREAM_END) {
+            break;
+        }
+        if (ret != Z_OK && (ret != Z_BUF_ERROR || zs->avail_in > 0)) {
+            BE_WARNLOG("FileInZip::Inflate: inflate error %i in '%s'\n", ret, filename);
+            break;
+        }
+
+        // Keep the inflate state periodically to seek backward without inflating from the start.
+        size_t lastCheckpointPos = checkpoints.Count() > 0 ? checkpoints[checkpoints.Count() - 1].outPos : 0;
+        if (pos >= lastCheckpointPos + CheckpointInterval) {
+            Checkpoint &checkpoint = checkpoints.Alloc();
+            checkpoint.outPos = pos;
+            checkpoint.inPos = inPos - zs->avail_in;
+            checkpoint.stream = Mem_ClearedAlloc(sizeof(z_stream));
+            inflateCopy((z_stream *)checkpoint.stream, zs);
+        }
+    }
+
+    return bytesToRead - zs->avail_out;
 }
 
 size_t FileInZip::Read(void *buffer, size_t bytesToRead) const {
-    return unzReadCurrentFile(pointer, buffer, (unsigned int)bytesToRead);
+    bytesToRead = Min(bytesToRead, size - pos);
+    if (bytesToRead == 0) {
+        return 0;
+    }
+
+    if (compressionMethod == Z_DEFLATED) {
+        return Inflate(buffer, bytesToRead);
+    }
+
+    if (mappedData) {
+        memcpy(buffer, mappedData + pos, bytesToRead);
+        pos += bytesToRead;
+        return bytesToRead;
+    }
+
+    size_t readBytes = pf->Read(buffer, bytesToRead);
+    pos += readBytes;
+    return readBytes;
+}
+
+const void *FileInZip::GetMappedData() const {
+    if (mappedData && compressionMethod != Z_DEFLATED) {
+        return mappedData;
+    }
+    return nullptr;
 }
 
 bool FileInZip::Write(const void *buffer, size_t len) {
@@ -332,4 +549,165 @@ bool FileInZip::Write(const void *buffer, size_t len) {
     return false;
 }
 
+//---------------------------------------------------------------
+// FileBuffered
+//---------------------------------------------------------------
+
+FileBuffered::FileBuffered(File *file, size_t bufferSize, bool readAhead) {
+    this->file = file;
+    this->bufferSize = bufferSize;
+    this->filePos = file->Tell();
+    this->bufferStart = filePos;
+    this->readAhead = readAhead;
+
+    buffers[0] = (byte *)Mem_Alloc(bufferSize);
+    buffers[1] = readAhead ? (byte *)Mem_Alloc(bufferSize) : nullptr;
+}
+
+FileBuffered::~FileBuffered() {
+    if (readAheadRequest) {
+        // Cancels the pending read, or waits the read into the back buffer to be done.
+        readAheadRequest->Release();
+    }
+
+    Mem_Free(buffers[0]);
+    if (buffers[1]) {
+        Mem_Free(buffers[1]);
+    }
+
+    delete file;
+}
+
+void FileBuffered::RequestReadAhead() const {
+    size_t nextStart = bufferStart + bufferLength;
+    size_t fileSize = file->Size();
+
+    if (nextStart >= fileSize) {
+        return;
+    }
+
+    // Source file is reopened by the I/O thread, so it can be read by this file meanwhile.
+    // Returns nullptr if the queue is not running, then the next block is read on demand.
+    readAheadStart = nextStart;
+    readAheadRequest = fileSystem.ReadAsync(file->GetFilePath(), nextStart, Min(bufferSize, fileSize - nextStart), buffers[currentBuffer ^ 1]);
+}
+
+bool FileBuffered::FillBuffer() const {
+    size_t nextStart = bufferStart + bufferLength;
+
+    if (readAheadRequest) {
+        bool readAheadDone = false;
+        size_t readAheadLength = 0;
+
+        if (readAheadStart == nextStart) {
+            readAheadRequest->Wait();
+
+            if (readAheadRequest->GetStatus() == AsyncReadRequest::Status::Completed) {
+                readAheadDone = true;
+                readAheadLength = readAheadRequest->GetSize();
+            }
+        }
+
+        // Cancels the request if the reader has been seeked elsewhere.
+        readAheadRequest->Release();
+        readAheadRequest = nullptr;
+
+        if (readAheadDone) {
+            // Swap to the buffer read ahead.
+            currentBuffer ^= 1;
+            bufferStart = nextStart;
+            bufferLength = readAheadLength;
+            bufferPos = 0;
+
+            RequestReadAhead();
+            return bufferLength > 0;
+        }
+    }
+
+    if (filePos != nextStart) {
+        file->Seek(nextStart);
+        filePos = nextStart;
+    }
+
+    bufferStart = nextStart;
+    bufferLength = file->Read(buffers[currentBuffer], bufferSize);
+    bufferPos = 0;
+
+    filePos += bufferLength;
+
+    if (readAhead) {
+        RequestReadAhead();
+    }
+    return bufferLength > 0;
+}
+
+int FileBuffered::Seek(int64_t offset) {
+    if (offset < 0 || offset > (int64_t)file->Size()) {
+        return -1;
+    }
+
+    if ((size_t)offset >= bufferStart && (size_t)offset <= bufferStart + bufferLength) {
+        bufferPos = (size_t)offset - bufferStart;
+        return 0;
+    }
+
+    // Source file is repositioned on the next read.
+    bufferStart = (size_t)offset;
+    bufferLength = 0;
+    bufferPos = 0;
+    return 0;
+}
+
+int FileBuffered::SeekFromEnd(int64_t offset) {
+    return Seek((int64_t)file->Size() + offset);
+}
+
+size_t FileBuffered::Read(void *buffer, size_t bytesToRead) const {
+    byte *dst = (byte *)buffer;
+    size_t readBytes = 0;
+
+    while (readBytes < bytesToRead) {
+        size_t available = bufferLength - bufferPos;
+
+        if (available == 0) {
+            size_t remaining = bytesToRead - readBytes;
+
+            // Large reads go to the destination directly.
+            if (!readAhead && remaining >= bufferSize) {
+                size_t nextStart = bufferStart + bufferLength;
+                if (filePos != nextStart) {
+                    file->Seek(nextStart);
+                    filePos = nextStart;
+                }
+
+                size_t directBytes = file->Read(dst + readBytes, remaining);
+                filePos += directBytes;
+                readBytes += directBytes;
+
+                bufferStart = filePos;
+                bufferLength = 0;
+                bufferPos = 0;
+                break;
+            }
+
+            if (!FillBuffer()) {
+                break;
+            }
+            continue;
+        }
+
+        size_t copyBytes = Min(available, bytesToRead - readBytes);
+        memcpy(dst + readBytes, buffers[currentBuffer] + bufferPos, copyBytes);
+        bufferPos += copyBytes;
+        readBytes += copyBytes;
+    }
+
+    return readBytes;
+}
+
+bool FileBuffered::Write(const void *buffer, size_t bytesToWrite) {
+    BE_FATALERROR("BUFFERED FILE WRITE IS NOT ALLOWED");
+    return false;
+}
+
 BE_NAMESPACE_END
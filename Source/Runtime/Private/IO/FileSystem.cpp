@@ -19,8 +19,8 @@
 #include "Platform/PlatformSystem.h"
 #include "Platform/PlatformProcess.h"
 #include "IO/FileSystem.h"
-#include "minizip/zip.h"
-#include "minizip/unzip.h"
+#include "IO/ZipReader.h"
+#include "IO/PakReader.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -28,29 +28,22 @@ BE_NAMESPACE_BEGIN
 
 static CVar             fs_baseDir("fs_baseDir", ".", 0, "");
 static CVar             fs_debug("fs_debug", "0", CVar::Flag::Bool, "");
+static CVar             fs_maxAsyncReads("fs_maxAsyncReads", "4", CVar::Flag::Integer, "maximum number of asynchronous reads in flight");
 
 FileSystem              fileSystem;
 
 //--------------------------------------------------------------------------------------------------
 //
-// ZIP archive
+// Package archive (zip or pak)
 //
 //--------------------------------------------------------------------------------------------------
 
-struct ZipEntry {
-    char                name[MaxRelativePath];
-    size_t              compressedSize;
-    size_t              uncompressedSize;
-    uLong               unzOffset;
-};
+struct PackageArchive {
+    ~PackageArchive() { delete reader; }
 
-struct ZipArchive {
     char                name[MaxRelativePath];
     char                fullPath[MaxAbsolutePath];
-    unzFile             unzArchive;
-    int                 numEntries;
-    Array<ZipEntry *>   entryList;
-    HashIndex           entryHash;
+    PackageReader *     reader;
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -86,9 +79,6 @@ void FileSystem::ClearSearchPath() {
         next = s->next;
         
         if (s->archive) {
-            s->archive->entryList.DeleteContents(true);
-            s->archive->entryHash.Free();
-            unzClose(s->archive->unzArchive);
             delete s->archive;
         } else if (s->pathname) {
             delete[] s->pathname;
@@ -134,147 +124,47 @@ void FileSystem::AddSearchPath(const char *path) {
     search->next = searchPath;
     searchPath = search;
 
-    // Add zip files from path to searchpath.
+    // Add zip and pak files from path to searchpath.
     Array<FileInfo> files;
     int num = PlatformFile::ListFiles(ToRelativePath(path), "*.zip", false, false, files);
 
     for (int i = 0; i < num; i++) {
-        AddSearchPath_ZIP(path, files[i].filename);
+        AddSearchPath_Package(path, files[i].filename);
     }
-}
 
-#if defined(__ANDROID__) 
-
-static voidpf ZCALLBACK _fopen_file_func(voidpf opaque, const char* filename, int mode) {
-    PlatformFile *file = nullptr;
-    PlatformBaseFile *(*mode_fopen)(const char *filename) = nullptr;
-    if ((mode & ZLIB_FILEFUNC_MODE_READWRITEFILTER) == ZLIB_FILEFUNC_MODE_READ) {
-        mode_fopen = PlatformFile::OpenFileRead;
-    } else {
-        if (mode & ZLIB_FILEFUNC_MODE_EXISTING) {
-            mode_fopen = PlatformFile::OpenFileAppend;
-        } else {
-            if (mode & ZLIB_FILEFUNC_MODE_CREATE) {
-                mode_fopen = PlatformFile::OpenFileWrite;
-            }
-        }
-    }
+    files.Clear();
+    num = PlatformFile::ListFiles(ToRelativePath(path), "*.pak", false, false, files);
 
-    if ((filename != nullptr) && (mode_fopen != nullptr)) {
-        file = (PlatformFile *)(*mode_fopen)(filename);
+    for (int i = 0; i < num; i++) {
+        AddSearchPath_Package(path, files[i].filename);
     }
-    return (FILE *) file;
 }
 
-static uLong ZCALLBACK _fread_file_func(voidpf opaque, voidpf stream, void* buf, uLong size) {
-    if (((PlatformFile *)stream)->Read(buf, size)) {
-        return size;
-    }
-    return -1;
-}
+void FileSystem::AddSearchPath_Package(const char *path, const char *filename) {
+    char fullpath[MaxAbsolutePath];
+    fileSystem.MakeFullPath(fullpath, sizeof(fullpath), path, "", filename);
 
-static uLong ZCALLBACK _fwrite_file_func(voidpf opaque, voidpf stream, const void* buf, uLong size) {
-    if (((PlatformFile *)stream)->Write(buf, size)) {
-        return size;
-    }
-    return -1;
-}
+    PackageArchive *archive = new PackageArchive;
 
-static long ZCALLBACK _ftell_file_func(voidpf opaque, voidpf stream) {
-    return ((PlatformFile *)stream)->Tell();
-}
+    strcpy(archive->fullPath, fullpath);
+    strcpy(archive->name, filename);
 
-static long ZCALLBACK _fseek_file_func(voidpf  opaque, voidpf stream, uLong offset, int origin) {
-    enum PlatformFile::Origin::Enum fseek_origin;
-    switch (origin) {
-    case ZLIB_FILEFUNC_SEEK_CUR:
-        fseek_origin = PlatformFile::Origin::Current;
-        break;
-    case ZLIB_FILEFUNC_SEEK_END:
-        fseek_origin = PlatformFile::Origin::End;
-        break;
-    case ZLIB_FILEFUNC_SEEK_SET:
-        fseek_origin = PlatformFile::Origin::Start;
-        break;
-    default:
-        return -1;
+    if (Str::CheckExtension(filename, ".pak")) {
+        archive->reader = new PakReader;
+    } else {
+        archive->reader = new ZipReader;
     }
-    return ((PlatformFile *)stream)->Seek(offset, fseek_origin);
-}
-
-static int ZCALLBACK _fclose_file_func(voidpf opaque, voidpf stream) {
-    delete ((PlatformFile *)stream);
-    return 0;
-}
 
-static int ZCALLBACK _ferror_file_func(voidpf opaque, voidpf stream) {
-    return 0;
-}
-
-static void _fill_fopen_filefunc(zlib_filefunc_def* pzlib_filefunc_def) {
-    pzlib_filefunc_def->zopen_file = _fopen_file_func;
-    pzlib_filefunc_def->zread_file = _fread_file_func;
-    pzlib_filefunc_def->zwrite_file = _fwrite_file_func;
-    pzlib_filefunc_def->ztell_file = _ftell_file_func;
-    pzlib_filefunc_def->zseek_file = _fseek_file_func;
-    pzlib_filefunc_def->zclose_file = _fclose_file_func;
-    pzlib_filefunc_def->zerror_file = _ferror_file_func;
-    pzlib_filefunc_def->opaque = nullptr;
-}
-
-#endif
-
-void FileSystem::AddSearchPath_ZIP(const char *path, const char *filename) {
-    char fullpath[MaxAbsolutePath];
-    fileSystem.MakeFullPath(fullpath, sizeof(fullpath), path, "", filename);
-    
-    unz_global_info z_global_info;
-#if defined(__ANDROID__) 
-    zlib_filefunc_def zlib_filefunc32_def;
-    _fill_fopen_filefunc(&zlib_filefunc32_def);
-    unzFile z_file = unzOpen2(ToRelativePath(fullpath), &zlib_filefunc32_def);
+#if defined(__ANDROID__)
+    bool opened = archive->reader->Open(ToRelativePath(fullpath));
 #else
-    unzFile z_file = unzOpen(fullpath);
+    bool opened = archive->reader->Open(fullpath);
 #endif
-    if (unzGetGlobalInfo(z_file, &z_global_info) != UNZ_OK) {
+    if (!opened) {
+        delete archive;
         return;
     }
 
-    ZipArchive *archive = new ZipArchive;
-        
-    strcpy(archive->fullPath, fullpath);
-    strcpy(archive->name, filename);
-
-    archive->unzArchive = z_file;
-    archive->numEntries = (int)z_global_info.number_entry;
-    
-    archive->entryList.Resize((int)z_global_info.number_entry);
-    
-    // Set the current file of the zipfile to the first file.
-    unzGoToFirstFile(z_file);
-    
-    for (int i = 0; i < z_global_info.number_entry; i++) {
-        unz_file_info z_entry_info;
-        char entryFilename[MaxRelativePath];
-
-        if (unzGetCurrentFileInfo(z_file, &z_entry_info, entryFilename, COUNT_OF(entryFilename), nullptr, 0, nullptr, 0) != UNZ_OK) {
-            break;
-        }
-
-        Str::ConvertPathSeperator(entryFilename, PATHSEPERATOR_CHAR);
-
-        ZipEntry *entry = new ZipEntry;
-        strcpy(entry->name, entryFilename);
-        entry->unzOffset = unzGetOffset(z_file);
-        entry->compressedSize = z_entry_info.compressed_size;
-        entry->uncompressedSize = z_entry_info.uncompressed_size;
-
-        archive->entryList.Append(entry);
-        archive->entryHash.Add(archive->entryHash.GenerateHash(entryFilename, false), i);
-    
-        unzGoToNextFile(z_file);
-    }
-
     SearchPath *search = new SearchPath;
     search->archive = archive;
     search->next = searchPath;
@@ -290,14 +180,19 @@ void FileSystem::Init(const char *baseDir) {
     BE_LOG("Current search path:\n");
     for (SearchPath *s = searchPath; s; s = s->next) {
         if (s->archive) {
-            BE_LOG("%s (%i files)\n", s->archive->fullPath, s->archive->numEntries);
+            BE_LOG("%s (%i files)\n", s->archive->fullPath, s->archive->reader->NumEntries());
         } else {
             BE_LOG("%s\n", s->pathname);
         }
     }
+
+    asyncIO.Init(fs_maxAsyncReads.GetInteger());
 }
 
 void FileSystem::Shutdown() {
+    // Stop reading before unmounting the packages.
+    asyncIO.Shutdown();
+
     ClearSearchPath();
     
     cmdSystem.RemoveCommand("dir");
@@ -577,8 +472,9 @@ File *FileSystem::OpenFileRead(const char *filename, bool useSearchPath, size_t
         }
         
         FileReal *file = new FileReal(filename, pf);
+        file->size = pf->Size();
         if (fileSize) {
-            file->size = *fileSize = pf->Size(); //PlatformFile::FileSize(filename);
+            *fileSize = file->size;
         }
 
         return file;
@@ -592,32 +488,21 @@ File *FileSystem::OpenFileRead(const char *filename, bool useSearchPath, size_t
     
     for (SearchPath *s = searchPath; s; s = s->next) {
         if (s->archive) {
-            ZipArchive *archive = s->archive;
-            ZipEntry *entry;
+            PackageArchive *archive = s->archive;
 
-            Str entryFilename = filename;
-            Str::ConvertPathSeperator(entryFilename, PATHSEPERATOR_CHAR);
-
-            int hash = archive->entryHash.GenerateHash(entryFilename, false);
-            int	i;
-            for (i = archive->entryHash.First(hash); i != -1; i = archive->entryHash.Next(i)) {
-                if (!Str::Icmp(archive->entryList[i]->name, entryFilename)) {
-                    entry = archive->entryList[i];
-                    break;
-                }
-            }
-                        
-            if (i != -1) {
+            int entryIndex = archive->reader->FindEntry(filename);
+            if (entryIndex != -1) {
                 if (fs_debug.GetBool()) {
                     BE_LOG("FileSystem::OpenFileRead: %s (found in '%s')\n", filename, archive->name);
                 }
 
-                unzSetOffset(archive->unzArchive, entry->unzOffset);
-                unzOpenCurrentFile(archive->unzArchive);
-                FileInZip *file = new FileInZip(filename, (void *)archive->unzArchive);
+                File *file = archive->reader->OpenEntry(entryIndex, filename);
+                if (!file) {
+                    break;
+                }
 
                 if (fileSize) {
-                    file->size = *fileSize = entry->uncompressedSize;
+                    *fileSize = file->Size();
                 }
 
                 resultFile = file;
@@ -635,9 +520,10 @@ File *FileSystem::OpenFileRead(const char *filename, bool useSearchPath, size_t
                 }
 
                 FileReal *file = new FileReal(relativePath, pf);
-                
+                file->size = pf->Size();
+
                 if (fileSize) {
-                    file->size = *fileSize = pf->Size(); // PlatformFile::FileSize(filename);
+                    *fileSize = file->size;
                 }
 
                 resultFile = file;
@@ -649,6 +535,15 @@ File *FileSystem::OpenFileRead(const char *filename, bool useSearchPath, size_t
     return resultFile;
 }
 
+File *FileSystem::OpenFileReadBuffered(const char *filename, bool useSearchPath, size_t bufferSize, bool readAhead) {
+    File *file = OpenFileRead(filename, useSearchPath);
+    if (!file) {
+        return nullptr;
+    }
+
+    return new FileBuffered(file, bufferSize, readAhead);
+}
+
 File *FileSystem::OpenFileWrite(const char *filename) {
     if (fs_debug.GetBool()) {
         BE_LOG("FileSystem::OpenFileWrite: %s\n", filename);
@@ -894,23 +789,23 @@ int FileSystem::ListFiles(const char *findPath, const char *nameFilter, FileArra
 
         for (SearchPath *s = searchPath; s; s = s->next) {
             if (s->archive) {
-                ZipArchive *archive = s->archive;
-                int numEntries = archive->numEntries;
+                const PackageReader *reader = s->archive->reader;
+                int numEntries = reader->NumEntries();
             
                 for (int i = 0; i < numEntries; i++) {
-                    ZipEntry *entry = archive->entryList[i];
+                    const char *entryName = reader->GetEntryName(i);
 
                     // check directory
-                    if (Str::Icmpn(entry->name, findPath, findPathLen)) {
+                    if (Str::Icmpn(entryName, findPath, findPathLen)) {
                         continue;
                     }
                 
                     // check extension
-                    if (Str::Filter(nameFilter, entry->name + findPathLen + 1)) {
+                    if (Str::Filter(nameFilter, entryName + findPathLen + 1)) {
                         continue;
                     }
 
-                    char *name = entry->name + findPathLen + 1;
+                    const char *name = entryName + findPathLen + 1;
 
                     fileInfo.isSubDir = false;
                     //fileInfo.size = entry->size;
@@ -987,7 +882,7 @@ void FileSystem::Cmd_Path(const CmdArgs &args) {
     BE_LOG("Current search path:\n");
     for (s = fileSystem.searchPath; s; s = s->next) {
         if (s->archive) {
-            BE_LOG("%s (%i files)\n", s->archive->fullPath, s->archive->numEntries);
+            BE_LOG("%s (%i files)\n", s->archive->fullPath, s->archive->reader->NumEntries());
         } else {
             BE_LOG("%s\n", s->pathname);
         }
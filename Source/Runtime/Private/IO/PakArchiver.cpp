@@ -0,0 +1,289 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/Checksum_MD5.h"
+#include "Core/Compression_LZ4.h"
+#include "IO/FileSystem.h"
+#include "IO/PakArchiver.h"
+#include "zlib.h"
+
+BE_NAMESPACE_BEGIN
+
+void PakArchiver::ComputeContentHash(const void *data, size_t size, uint8_t digest[16]) {
+    MD5_CTX ctx;
+    MD5_Init(&ctx);
+    MD5_Update(&ctx, (const unsigned char *)data, size);
+    MD5_Final(&ctx, digest);
+}
+
+bool PakArchiver::Open(const char *filename) {
+    Close();
+
+    Str pakFilename = fileSystem.ToAbsolutePath(filename);
+    file = fileSystem.OpenFileWrite(pakFilename);
+    if (!file) {
+        BE_WARNLOG("Unabled to open pak file to create '%s'\n", pakFilename.c_str());
+        return false;
+    }
+
+    // Header is written again on close.
+    PakHeader header;
+    memset(&header, 0, sizeof(header));
+    writeOffset = 0;
+
+    return WriteBytes(&header, sizeof(header));
+}
+
+bool PakArchiver::Close() {
+    if (!file) {
+        return false;
+    }
+
+    PakHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PakHeader::Magic;
+    header.version = PakHeader::Version;
+    header.numEntries = entries.Count();
+    header.numBlocks = blockSizes.Count();
+
+    // Entry table is sorted by path hash for binary search.
+    entries.Sort([](const PakEntry &a, const PakEntry &b) { return a.pathHash < b.pathHash; });
+
+    bool result = WritePadding(8);
+
+    header.blockTableOffset = writeOffset;
+    result = result && WriteBytes(blockSizes.Ptr(), sizeof(uint32_t) * blockSizes.Count());
+
+    result = result && WritePadding(8);
+    header.entryTableOffset = writeOffset;
+    result = result && WriteBytes(entries.Ptr(), sizeof(PakEntry) * entries.Count());
+
+    header.nameTableOffset = writeOffset;
+    header.nameTableSize = names.Count();
+    result = result && WriteBytes(names.Ptr(), names.Count());
+
+    result = result && file->Seek(0) == 0 && file->Write(&header, sizeof(header));
+
+    fileSystem.CloseFile(file);
+    file = nullptr;
+
+    entries.Clear();
+    blockSizes.Clear();
+    names.Clear();
+    compressBuffer.Clear();
+
+    return result;
+}
+
+bool PakArchiver::WriteBytes(const void *data, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    if (!file->Write(data, size)) {
+        return false;
+    }
+    writeOffset += size;
+    return true;
+}
+
+bool PakArchiver::WritePadding(uint32_t alignment) {
+    static const byte zeros[PakHeader::DataAlignment] = { 0 };
+
+    size_t padding = (size_t)((alignment - writeOffset % alignment) % alignment);
+    return WriteBytes(zeros, padding);
+}
+
+bool PakArchiver::AddData(const char *name, const void *data, size_t size, PakCodec::Enum codec, const uint8_t *contentHash) {
+    if (!file) {
+        return false;
+    }
+
+    Str entryName = name;
+    Str::ConvertPathSeperator(entryName, '/');
+
+    uint32_t pathHash = PakReader::HashPath(entryName);
+    for (int i = 0; i < entries.Count(); i++) {
+        if (entries[i].pathHash == pathHash && !Str::Icmp(&names[entries[i].nameOffset], entryName)) {
+            BE_WARNLOG("Duplicated entry '%s' in pak file\n", name);
+            return false;
+        }
+    }
+
+    // Entry data is page aligned to be mapped.
+    if (!WritePadding(PakHeader::DataAlignment)) {
+        return false;
+    }
+
+    PakEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.pathHash = pathHash;
+    entry.nameOffset = names.Count();
+    entry.dataOffset = writeOffset;
+    entry.size = size;
+    entry.firstBlock = blockSizes.Count();
+    entry.codec = (uint8_t)codec;
+
+    if (contentHash) {
+        memcpy(entry.contentHash, contentHash, sizeof(entry.contentHash));
+    } else {
+        ComputeContentHash(data, size, entry.contentHash);
+    }
+
+    if (codec != PakCodec::None) {
+        int bound = codec == PakCodec::LZ4 ? LZ4_CompressBound(PakHeader::BlockSize) : (int)compressBound(PakHeader::BlockSize);
+        compressBuffer.SetCount(bound, false);
+
+        const byte *src = (const byte *)data;
+        uint64_t compressedSize = 0;
+
+        for (size_t offset = 0; offset < size; offset += PakHeader::BlockSize) {
+            size_t rawSize = Min((size_t)PakHeader::BlockSize, size - offset);
+            size_t blockSize = 0;
+
+            if (codec == PakCodec::LZ4) {
+                blockSize = LZ4_CompressBlock(src + offset, (int)rawSize, compressBuffer.Ptr(), bound);
+            } else {
+                uLongf destLen = (uLongf)bound;
+                if (compress2(compressBuffer.Ptr(), &destLen, src + offset, (uLong)rawSize, Z_BEST_COMPRESSION) == Z_OK) {
+                    blockSize = destLen;
+                }
+            }
+
+            // Incompressible block is stored as is.
+            const void *blockData = compressBuffer.Ptr();
+            if (blockSize == 0 || blockSize >= rawSize) {
+                blockData = src + offset;
+                blockSize = rawSize;
+            }
+
+            if (!WriteBytes(blockData, blockSize)) {
+                return false;
+            }
+
+            blockSizes.Append((uint32_t)blockSize);
+            compressedSize += blockSize;
+        }
+
+        entry.compressedSize = compressedSize;
+
+        if (compressedSize == size) {
+            // No block is compressed, so store the entry to read it without decoding.
+            entry.codec = PakCodec::None;
+            entry.firstBlock = 0;
+            blockSizes.SetCount(blockSizes.Count() - (int)((size + PakHeader::BlockSize - 1) / PakHeader::BlockSize), false);
+        }
+    } else {
+        if (!WriteBytes(data, size)) {
+            return false;
+        }
+        entry.compressedSize = size;
+    }
+
+    int nameLength = entryName.Length();
+    names.SetCount(entry.nameOffset + nameLength + 1, false);
+    memcpy(&names[entry.nameOffset], entryName.c_str(), nameLength + 1);
+
+    entries.Append(entry);
+    return true;
+}
+
+bool PakArchiver::AddFile(const char *filename, PakCodec::Enum codec) {
+    void *data;
+    size_t size = fileSystem.LoadFile(filename, false, &data);
+    if (!data) {
+        BE_WARNLOG("Failed to open '%s'\n", filename);
+        return false;
+    }
+
+    bool result = AddData(filename, data, size, codec);
+
+    fileSystem.FreeFile(data);
+
+    return result;
+}
+
+bool PakArchiver::Archive(const char *pakFilename, const char *archiveDirectory, const char *filter, PakCodec::Enum codec, const char *baseDir, const char *basePakFilename, ProgressCallback *progress) {
+    if (progress && !progress->Poll(0.0f)) {
+        return false;
+    }
+
+    Str oldBaseDir = fileSystem.GetBaseDir();
+
+    PakReader basePak;
+    if (basePakFilename && basePakFilename[0]) {
+        if (!basePak.Open(fileSystem.ToAbsolutePath(basePakFilename))) {
+            return false;
+        }
+    }
+
+    Str pakFilename2 = pakFilename;
+    Str::ConvertPathSeperator(pakFilename2, PATHSEPERATOR_CHAR);
+    PakArchiver pakFile;
+    if (!pakFile.Open(pakFilename2)) {
+        return false;
+    }
+
+    if (baseDir && baseDir[0]) {
+        fileSystem.SetBaseDir(baseDir);
+    }
+
+    FileArray fileArray;
+    fileSystem.ListFiles(archiveDirectory, filter, fileArray, false, true);
+
+    for (int i = 0; i < fileArray.NumFiles(); i++) {
+        const auto &fileInfo = fileArray.GetArray()[i];
+        if (fileInfo.isSubDir) {
+            continue;
+        }
+
+        Str filename = archiveDirectory;
+        filename.AppendPath(fileInfo.filename);
+
+        void *data;
+        size_t size = fileSystem.LoadFile(filename, false, &data);
+        if (!data) {
+            BE_WARNLOG("Failed to open '%s'\n", filename.c_str());
+            continue;
+        }
+
+        uint8_t contentHash[16];
+        ComputeContentHash(data, size, contentHash);
+
+        // Skip unchanged files for the patch.
+        int baseIndex = basePak.FindEntry(filename);
+        if (baseIndex < 0 || memcmp(basePak.GetEntryContentHash(baseIndex), contentHash, sizeof(contentHash))) {
+            pakFile.AddData(filename, data, size, codec, contentHash);
+        }
+
+        fileSystem.FreeFile(data);
+
+        if (progress) {
+            float fraction = float(i + 1) / fileArray.NumFiles();
+            if (!progress->Poll(fraction)) {
+                break;
+            }
+        }
+    }
+
+    bool result = pakFile.Close();
+
+    if (baseDir && baseDir[0]) {
+        fileSystem.SetBaseDir(oldBaseDir);
+    }
+
+    return result;
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,378 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/Heap.h"
+#include "Platform/PlatformFile.h"
+#include "Core/Compression_LZ4.h"
+#include "IO/PakReader.h"
+#include "zlib.h"
+
+BE_NAMESPACE_BEGIN
+
+uint32_t PakReader::HashPath(const char *path) {
+    // FNV-1a of the lower case path with '/' separators.
+    uint32_t hash = 2166136261u;
+    for (const char *p = path; *p; p++) {
+        char c = *p;
+        if (c == '\\') {
+            c = '/';
+        } else if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    }
+    return hash;
+}
+
+bool PakReader::Open(const char *filename) {
+    Close();
+
+    Str::Copynz(this->filename, filename, COUNT_OF(this->filename));
+
+    mapping = PlatformFileMapping::OpenFileRead(filename);
+
+    PlatformBaseFile *pf = nullptr;
+    if (mapping) {
+        fileSize = mapping->GetSize();
+    } else {
+        pf = PlatformFile::OpenFileRead(filename);
+        if (!pf) {
+            return false;
+        }
+        fileSize = pf->Size();
+    }
+
+    PakHeader header;
+    bool valid = ReadBytes(pf, 0, sizeof(header), &header) && header.magic == PakHeader::Magic && header.version == PakHeader::Version;
+
+    if (valid) {
+        entries.SetCount(header.numEntries);
+        blockSizes.SetCount(header.numBlocks);
+        names.SetCount(header.nameTableSize + 1);
+
+        valid = ReadBytes(pf, header.entryTableOffset, sizeof(PakEntry) * header.numEntries, entries.Ptr()) &&
+            ReadBytes(pf, header.blockTableOffset, sizeof(uint32_t) * header.numBlocks, blockSizes.Ptr()) &&
+            ReadBytes(pf, header.nameTableOffset, header.nameTableSize, names.Ptr());
+
+        names[header.nameTableSize] = '\0';
+    }
+
+    if (pf) {
+        delete pf;
+    }
+
+    if (valid) {
+        // Validate the tables and compute the file offsets of the blocks.
+        blockOffsets.SetCount(header.numBlocks);
+
+        for (int i = 0; i < entries.Count() && valid; i++) {
+            const PakEntry &entry = entries[i];
+
+            if (entry.nameOffset >= header.nameTableSize || entry.codec > PakCodec::Deflate ||
+                entry.dataOffset + entry.compressedSize > fileSize) {
+                valid = false;
+                break;
+            }
+
+            if (entry.codec == PakCodec::None) {
+                valid = entry.compressedSize == entry.size;
+                continue;
+            }
+
+            uint64_t numBlocks = (entry.size + PakHeader::BlockSize - 1) / PakHeader::BlockSize;
+            if (entry.firstBlock + numBlocks > header.numBlocks) {
+                valid = false;
+                break;
+            }
+
+            uint64_t offset = entry.dataOffset;
+            for (uint32_t b = entry.firstBlock; b < entry.firstBlock + numBlocks; b++) {
+                if (blockSizes[b] > PakHeader::BlockSize) {
+                    valid = false;
+                    break;
+                }
+                blockOffsets[b] = offset;
+                offset += blockSizes[b];
+            }
+
+            if (offset > entry.dataOffset + entry.compressedSize) {
+                valid = false;
+            }
+        }
+    }
+
+    if (!valid) {
+        BE_WARNLOG("PakReader::Open: invalid pak file '%s'\n", filename);
+        Close();
+        return false;
+    }
+
+    // Entry names are stored with '/' separators.
+    for (int i = 0; i < names.Count(); i++) {
+        if (names[i] == '/') {
+            names[i] = PATHSEPERATOR_CHAR;
+        }
+    }
+
+    return true;
+}
+
+void PakReader::Close() {
+    if (mapping) {
+        delete mapping;
+        mapping = nullptr;
+    }
+
+    fileSize = 0;
+    entries.Clear();
+    blockSizes.Clear();
+    blockOffsets.Clear();
+    names.Clear();
+}
+
+bool PakReader::ReadBytes(PlatformBaseFile *pf, uint64_t offset, size_t size, void *buffer) const {
+    if (offset + size > fileSize) {
+        return false;
+    }
+
+    if (mapping) {
+        memcpy(buffer, (const byte *)mapping->GetData() + offset, size);
+        return true;
+    }
+
+    if (pf->Seek((long)offset, PlatformBaseFile::Origin::Start) != 0) {
+        return false;
+    }
+    return pf->Read(buffer, size) == size;
+}
+
+const byte *PakReader::GetMappedData(size_t offset) const {
+    if (!mapping) {
+        return nullptr;
+    }
+    return (const byte *)mapping->GetData() + offset;
+}
+
+int PakReader::FindEntry(const char *name) const {
+    uint32_t hash = HashPath(name);
+
+    // Find the first entry of the hash in the entry table sorted by path hash.
+    int lo = 0;
+    int hi = entries.Count();
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (entries[mid].pathHash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == entries.Count() || entries[lo].pathHash != hash) {
+        return -1;
+    }
+
+    Str entryName = name;
+    Str::ConvertPathSeperator(entryName, PATHSEPERATOR_CHAR);
+
+    for (int i = lo; i < entries.Count() && entries[i].pathHash == hash; i++) {
+        if (!Str::Icmp(GetEntryName(i), entryName)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+File *PakReader::OpenEntry(int index, const char *filename) const {
+    PlatformFile *pf = nullptr;
+
+    if (!mapping) {
+        // Each opened entry reads the pak with its own file handle.
+        pf = (PlatformFile *)PlatformFile::OpenFileRead(this->filename);
+        if (!pf) {
+            return nullptr;
+        }
+    }
+
+    return new FileInPak(filename, this, index, pf);
+}
+
+size_t PakReader::ReadStored(PlatformBaseFile *pf, int entryIndex, size_t offset, size_t size, void *buffer) const {
+    const PakEntry &entry = entries[entryIndex];
+
+    if (!ReadBytes(pf, entry.dataOffset + offset, size, buffer)) {
+        return 0;
+    }
+    return size;
+}
+
+size_t PakReader::ReadBlock(PlatformBaseFile *pf, int entryIndex, int blockIndex, byte *scratch, byte *out) const {
+    const PakEntry &entry = entries[entryIndex];
+
+    uint64_t blockStart = (uint64_t)blockIndex * PakHeader::BlockSize;
+    if (blockStart >= entry.size) {
+        return 0;
+    }
+
+    size_t rawSize = (size_t)Min((uint64_t)PakHeader::BlockSize, entry.size - blockStart);
+    int block = entry.firstBlock + blockIndex;
+    size_t compressedSize = blockSizes[block];
+
+    const byte *src;
+    if (mapping) {
+        src = (const byte *)mapping->GetData() + blockOffsets[block];
+    } else {
+        if (!ReadBytes(pf, blockOffsets[block], compressedSize, scratch)) {
+            return 0;
+        }
+        src = scratch;
+    }
+
+    if (compressedSize == rawSize) {
+        // Incompressible block is stored as is.
+        memcpy(out, src, rawSize);
+        return rawSize;
+    }
+
+    if (entry.codec == PakCodec::LZ4) {
+        if (LZ4_DecompressBlock(src, (int)compressedSize, out, (int)rawSize) != (int)rawSize) {
+            BE_WARNLOG("PakReader::ReadBlock: corrupted block %i of '%s'\n", blockIndex, GetEntryName(entryIndex));
+            return 0;
+        }
+    } else {
+        uLongf destLen = (uLongf)rawSize;
+        if (uncompress(out, &destLen, src, (uLong)compressedSize) != Z_OK || destLen != rawSize) {
+            BE_WARNLOG("PakReader::ReadBlock: corrupted block %i of '%s'\n", blockIndex, GetEntryName(entryIndex));
+            return 0;
+        }
+    }
+    return rawSize;
+}
+
+//---------------------------------------------------------------
+// FileInPak
+//---------------------------------------------------------------
+
+FileInPak::FileInPak(const char *filename, const PakReader *pak, int entryIndex, PlatformFile *pf) {
+    Str::Copynz(this->filename, filename, COUNT_OF(this->filename));
+    this->pak = pak;
+    this->entryIndex = entryIndex;
+    this->pf = pf;
+
+    const PakEntry &entry = pak->GetEntry(entryIndex);
+    size = (size_t)entry.size;
+    compressed = entry.codec != PakCodec::None;
+
+    if (compressed) {
+        blockBuffer = (byte *)Mem_Alloc(PakHeader::BlockSize);
+        if (pf) {
+            scratchBuffer = (byte *)Mem_Alloc(PakHeader::BlockSize);
+        }
+    }
+}
+
+FileInPak::~FileInPak() {
+    if (blockBuffer) {
+        Mem_Free(blockBuffer);
+    }
+    if (scratchBuffer) {
+        Mem_Free(scratchBuffer);
+    }
+
+    SAFE_DELETE(pf);
+}
+
+int FileInPak::Seek(int64_t offset) {
+    if (offset < 0 || offset > (int64_t)size) {
+        return -1;
+    }
+    pos = (size_t)offset;
+    return 0;
+}
+
+int FileInPak::SeekFromEnd(int64_t offset) {
+    return Seek((int64_t)size + offset);
+}
+
+size_t FileInPak::Read(void *buffer, size_t bytesToRead) const {
+    bytesToRead = Min(bytesToRead, size - pos);
+    if (bytesToRead == 0) {
+        return 0;
+    }
+
+    if (!compressed) {
+        const byte *mappedData = (const byte *)GetMappedData();
+        size_t readBytes;
+        if (mappedData) {
+            memcpy(buffer, mappedData + pos, bytesToRead);
+            readBytes = bytesToRead;
+        } else {
+            readBytes = pak->ReadStored(pf, entryIndex, pos, bytesToRead, buffer);
+        }
+        pos += readBytes;
+        return readBytes;
+    }
+
+    byte *dst = (byte *)buffer;
+    size_t readBytes = 0;
+
+    while (readBytes < bytesToRead) {
+        int blockIndex = (int)(pos / PakHeader::BlockSize);
+        size_t offsetInBlock = pos - (size_t)blockIndex * PakHeader::BlockSize;
+        size_t remaining = bytesToRead - readBytes;
+
+        if (blockIndex != cachedBlock) {
+            size_t blockSize = Min((size_t)PakHeader::BlockSize, size - (size_t)blockIndex * PakHeader::BlockSize);
+
+            if (offsetInBlock == 0 && remaining >= blockSize) {
+                // Whole block is decoded to the destination directly.
+                if (pak->ReadBlock(pf, entryIndex, blockIndex, scratchBuffer, dst + readBytes) != blockSize) {
+                    break;
+                }
+                pos += blockSize;
+                readBytes += blockSize;
+                continue;
+            }
+
+            cachedBlockSize = pak->ReadBlock(pf, entryIndex, blockIndex, scratchBuffer, blockBuffer);
+            if (cachedBlockSize == 0) {
+                cachedBlock = -1;
+                break;
+            }
+            cachedBlock = blockIndex;
+        }
+
+        size_t copyBytes = Min(remaining, cachedBlockSize - offsetInBlock);
+        memcpy(dst + readBytes, blockBuffer + offsetInBlock, copyBytes);
+        pos += copyBytes;
+        readBytes += copyBytes;
+    }
+
+    return readBytes;
+}
+
+bool FileInPak::Write(const void *buffer, size_t bytesToWrite) {
+    BE_FATALERROR("PAK FILE WRITE IS NOT ALLOWED");
+    return false;
+}
+
+const void *FileInPak::GetMappedData() const {
+    if (compressed) {
+        return nullptr;
+    }
+    return pak->GetMappedData((size_t)pak->GetEntry(entryIndex).dataOffset);
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,229 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Platform/PlatformFile.h"
+#include "IO/File.h"
+#include "IO/ZipReader.h"
+#include "zlib.h"
+
+BE_NAMESPACE_BEGIN
+
+static const uint32_t   EndOfCentralDirSignature = 0x06054b50;
+static const uint32_t   CentralDirEntrySignature = 0x02014b50;
+static const uint32_t   LocalHeaderSignature = 0x04034b50;
+
+static const int        EndOfCentralDirSize = 22;
+static const int        CentralDirEntrySize = 46;
+static const int        LocalHeaderSize = 30;
+static const int        MaxCommentSize = 0xFFFF;
+
+static BE_INLINE uint16_t ReadUInt16LE(const byte *ptr) {
+    return (uint16_t)(ptr[0] | (ptr[1] << 8));
+}
+
+static BE_INLINE uint32_t ReadUInt32LE(const byte *ptr) {
+    return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) | ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+bool ZipReader::Open(const char *filename) {
+    Close();
+
+    Str::Copynz(this->filename, filename, COUNT_OF(this->filename));
+
+    mapping = PlatformFileMapping::OpenFileRead(filename);
+
+    PlatformBaseFile *pf = nullptr;
+    if (mapping) {
+        fileSize = mapping->GetSize();
+    } else {
+        pf = PlatformFile::OpenFileRead(filename);
+        if (!pf) {
+            return false;
+        }
+        fileSize = pf->Size();
+    }
+
+    bool result = ReadCentralDirectory(pf);
+
+    if (pf) {
+        delete pf;
+    }
+
+    if (!result) {
+        BE_WARNLOG("ZipReader::Open: invalid zip file '%s'\n", filename);
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ZipReader::Close() {
+    if (mapping) {
+        delete mapping;
+        mapping = nullptr;
+    }
+
+    fileSize = 0;
+    entries.Clear();
+    names.Clear();
+    entryHash.Free();
+}
+
+bool ZipReader::ReadBytes(PlatformBaseFile *pf, size_t offset, size_t size, void *buffer) const {
+    if (offset + size > fileSize) {
+        return false;
+    }
+
+    if (mapping) {
+        memcpy(buffer, (const byte *)mapping->GetData() + offset, size);
+        return true;
+    }
+
+    if (pf->Seek((long)offset, PlatformBaseFile::Origin::Start) != 0) {
+        return false;
+    }
+    return pf->Read(buffer, size) == size;
+}
+
+bool ZipReader::ReadCentralDirectory(PlatformBaseFile *pf) {
+    // Find the end of central directory record backward from the end of file.
+    size_t tailSize = Min(fileSize, (size_t)(EndOfCentralDirSize + MaxCommentSize));
+    size_t tailOffset = fileSize - tailSize;
+
+    Array<byte> tail;
+    tail.SetCount((int)tailSize);
+    if (!ReadBytes(pf, tailOffset, tailSize, tail.Ptr())) {
+        return false;
+    }
+
+    const byte *eocd = nullptr;
+    for (int i = (int)tailSize - EndOfCentralDirSize; i >= 0; i--) {
+        if (ReadUInt32LE(&tail[i]) == EndOfCentralDirSignature) {
+            eocd = &tail[i];
+            break;
+        }
+    }
+    if (!eocd) {
+        return false;
+    }
+
+    int numEntries = ReadUInt16LE(eocd + 10);
+    size_t centralDirSize = ReadUInt32LE(eocd + 12);
+    size_t centralDirOffset = ReadUInt32LE(eocd + 16);
+
+    if (numEntries == 0xFFFF || centralDirOffset == 0xFFFFFFFF) {
+        BE_WARNLOG("ZipReader::ReadCentralDirectory: ZIP64 is not supported\n");
+        return false;
+    }
+
+    Array<byte> centralDir;
+    centralDir.SetCount((int)centralDirSize);
+    if (!ReadBytes(pf, centralDirOffset, centralDirSize, centralDir.Ptr())) {
+        return false;
+    }
+
+    entries.Resize(numEntries);
+    // Entry names are shorter than the central directory in total.
+    names.Resize((int)centralDirSize);
+    entryHash.ResizeIndex(numEntries);
+
+    const byte *ptr = centralDir.Ptr();
+    const byte *end = ptr + centralDirSize;
+
+    for (int i = 0; i < numEntries; i++) {
+        if (ptr + CentralDirEntrySize > end || ReadUInt32LE(ptr) != CentralDirEntrySignature) {
+            return false;
+        }
+
+        int flags = ReadUInt16LE(ptr + 8);
+        int compressionMethod = ReadUInt16LE(ptr + 10);
+        size_t compressedSize = ReadUInt32LE(ptr + 20);
+        size_t uncompressedSize = ReadUInt32LE(ptr + 24);
+        int nameLength = ReadUInt16LE(ptr + 28);
+        int extraLength = ReadUInt16LE(ptr + 30);
+        int commentLength = ReadUInt16LE(ptr + 32);
+        size_t localHeaderOffset = ReadUInt32LE(ptr + 42);
+
+        const char *name = (const char *)ptr + CentralDirEntrySize;
+        ptr += CentralDirEntrySize + nameLength + extraLength + commentLength;
+        if (ptr > end) {
+            return false;
+        }
+
+        // Local header has its own variable length fields, so the entry data offset is resolved here once.
+        byte localHeader[LocalHeaderSize];
+        if (!ReadBytes(pf, localHeaderOffset, LocalHeaderSize, localHeader) || ReadUInt32LE(localHeader) != LocalHeaderSignature) {
+            return false;
+        }
+
+        Entry &entry = entries.Alloc();
+        entry.nameOffset = names.Count();
+        entry.compressionMethod = compressionMethod;
+        entry.encrypted = (flags & 1) != 0;
+        entry.dataOffset = localHeaderOffset + LocalHeaderSize + ReadUInt16LE(localHeader + 26) + ReadUInt16LE(localHeader + 28);
+        entry.compressedSize = compressedSize;
+        entry.uncompressedSize = uncompressedSize;
+
+        if (entry.dataOffset + compressedSize > fileSize) {
+            return false;
+        }
+
+        names.SetCount(entry.nameOffset + nameLength + 1, false);
+        char *entryName = &names[entry.nameOffset];
+        memcpy(entryName, name, nameLength);
+        entryName[nameLength] = '\0';
+        Str::ConvertPathSeperator(entryName, PATHSEPERATOR_CHAR);
+
+        entryHash.Add(entryHash.GenerateHash(entryName, false), i);
+    }
+
+    return true;
+}
+
+int ZipReader::FindEntry(const char *name) const {
+    Str entryName = name;
+    Str::ConvertPathSeperator(entryName, PATHSEPERATOR_CHAR);
+
+    int hash = entryHash.GenerateHash(entryName, false);
+    for (int i = entryHash.First(hash); i != -1; i = entryHash.Next(i)) {
+        if (!Str::Icmp(GetEntryName(i), entryName)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+File *ZipReader::OpenEntry(int index, const char *filename) const {
+    const Entry &entry = entries[index];
+
+    if (entry.encrypted || (entry.compressionMethod != 0 && entry.compressionMethod != Z_DEFLATED)) {
+        BE_WARNLOG("ZipReader::OpenEntry: unsupported compression method %i in '%s'\n", entry.compressionMethod, filename);
+        return nullptr;
+    }
+
+    if (mapping) {
+        const byte *data = (const byte *)mapping->GetData() + entry.dataOffset;
+        return new FileInZip(filename, data, entry.compressedSize, entry.uncompressedSize, entry.compressionMethod);
+    }
+
+    // Each opened entry reads the package with its own file handle.
+    PlatformFile *pf = (PlatformFile *)PlatformFile::OpenFileRead(this->filename);
+    if (!pf) {
+        return nullptr;
+    }
+    return new FileInZip(filename, pf, entry.dataOffset, entry.compressedSize, entry.uncompressedSize, entry.compressionMethod);
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,565 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Math/Math.h"
+#include "Image/AstcCodec.h"
+
+BE_NAMESPACE_BEGIN
+
+const ASTCCodec::QuantInfo ASTCCodec::quantInfo[NumQuants] = {
+    // levels, trits, quints, bits
+    { 2, 0, 0, 1 },
+    { 3, 1, 0, 0 },
+    { 4, 0, 0, 2 },
+    { 5, 0, 1, 0 },
+    { 6, 1, 0, 1 },
+    { 8, 0, 0, 3 },
+    { 10, 0, 1, 1 },
+    { 12, 1, 0, 2 },
+    { 16, 0, 0, 4 },
+    { 20, 0, 1, 2 },
+    { 24, 1, 0, 3 },
+    { 32, 0, 0, 5 },
+    { 40, 0, 1, 3 },
+    { 48, 1, 0, 4 },
+    { 64, 0, 0, 6 },
+    { 80, 0, 1, 4 },
+    { 96, 1, 0, 5 },
+    { 128, 0, 0, 7 },
+    { 160, 0, 1, 5 },
+    { 192, 1, 0, 6 },
+    { 256, 0, 0, 8 }
+};
+
+// 8 bits packed value of 5 trits, indexed by t0 + 3 * t1 + 9 * t2 + 27 * t3 + 81 * t4.
+// Trailing zero trits are packed in zero bits so that the truncated last group decodes correctly.
+const byte ASTCCodec::tritEncodeTable[243] = {
+    0, 1, 2, 4, 5, 6, 8, 9, 10, 16, 17, 18, 20, 21, 22, 24,
+    25, 26, 3, 7, 11, 19, 23, 27, 12, 13, 14, 32, 33, 34, 36, 37,
+    38, 40, 41, 42, 48, 49, 50, 52, 53, 54, 56, 57, 58, 35, 39, 43,
+    51, 55, 59, 44, 45, 46, 64, 65, 66, 68, 69, 70, 72, 73, 74, 80,
+    81, 82, 84, 85, 86, 88, 89, 90, 67, 71, 75, 83, 87, 91, 76, 77,
+    78, 128, 129, 130, 132, 133, 134, 136, 137, 138, 144, 145, 146, 148, 149, 150,
+    152, 153, 154, 131, 135, 139, 147, 151, 155, 140, 141, 142, 160, 161, 162, 164,
+    165, 166, 168, 169, 170, 176, 177, 178, 180, 181, 182, 184, 185, 186, 163, 167,
+    171, 179, 183, 187, 172, 173, 174, 192, 193, 194, 196, 197, 198, 200, 201, 202,
+    208, 209, 210, 212, 213, 214, 216, 217, 218, 195, 199, 203, 211, 215, 219, 204,
+    205, 206, 96, 97, 98, 100, 101, 102, 104, 105, 106, 112, 113, 114, 116, 117,
+    118, 120, 121, 122, 99, 103, 107, 115, 119, 123, 108, 109, 110, 224, 225, 226,
+    228, 229, 230, 232, 233, 234, 240, 241, 242, 244, 245, 246, 248, 249, 250, 227,
+    231, 235, 243, 247, 251, 236, 237, 238, 28, 29, 30, 60, 61, 62, 92, 93,
+    94, 156, 157, 158, 188, 189, 190, 220, 221, 222, 31, 63, 95, 159, 191, 223,
+    124, 125, 126
+};
+
+// 7 bits packed value of 3 quints, indexed by q0 + 5 * q1 + 25 * q2.
+const byte ASTCCodec::quintEncodeTable[125] = {
+    0, 1, 2, 3, 4, 8, 9, 10, 11, 12, 16, 17, 18, 19, 20, 24,
+    25, 26, 27, 28, 5, 13, 21, 29, 6, 32, 33, 34, 35, 36, 40, 41,
+    42, 43, 44, 48, 49, 50, 51, 52, 56, 57, 58, 59, 60, 37, 45, 53,
+    61, 14, 64, 65, 66, 67, 68, 72, 73, 74, 75, 76, 80, 81, 82, 83,
+    84, 88, 89, 90, 91, 92, 69, 77, 85, 93, 22, 96, 97, 98, 99, 100,
+    104, 105, 106, 107, 108, 112, 113, 114, 115, 116, 120, 121, 122, 123, 124, 101,
+    109, 117, 125, 30, 102, 103, 70, 71, 38, 110, 111, 78, 79, 46, 118, 119,
+    86, 87, 54, 126, 127, 94, 95, 62, 39, 47, 55, 63, 7
+};
+
+static void DecodeTrits(int T, int *t) {
+    int C;
+    if (((T >> 2) & 7) == 7) {
+        C = (((T >> 5) & 7) << 2) | (T & 3);
+        t[4] = 2;
+        t[3] = 2;
+    } else {
+        C = T & 0x1F;
+        if (((T >> 5) & 3) == 3) {
+            t[4] = 2;
+            t[3] = (T >> 7) & 1;
+        } else {
+            t[4] = (T >> 7) & 1;
+            t[3] = (T >> 5) & 3;
+        }
+    }
+
+    if ((C & 3) == 3) {
+        t[2] = 2;
+        t[1] = (C >> 4) & 1;
+        t[0] = (((C >> 3) & 1) << 1) | (((C >> 2) & 1) & ~((C >> 3) & 1));
+    } else if (((C >> 2) & 3) == 3) {
+        t[2] = 2;
+        t[1] = 2;
+        t[0] = C & 3;
+    } else {
+        t[2] = (C >> 4) & 1;
+        t[1] = (C >> 2) & 3;
+        t[0] = (((C >> 1) & 1) << 1) | ((C & 1) & ~((C >> 1) & 1));
+    }
+}
+
+static void DecodeQuints(int Q, int *q) {
+    if (((Q >> 1) & 3) == 3 && ((Q >> 5) & 3) == 0) {
+        int q0 = Q & 1;
+        q[2] = (q0 << 2) | ((((Q >> 4) & 1) & ~q0) << 1) | (((Q >> 3) & 1) & ~q0);
+        q[1] = 4;
+        q[0] = 4;
+        return;
+    }
+
+    int C;
+    if (((Q >> 1) & 3) == 3) {
+        q[2] = 4;
+        C = (((Q >> 3) & 3) << 3) | ((~(Q >> 5) & 3) << 1) | (Q & 1);
+    } else {
+        q[2] = (Q >> 5) & 3;
+        C = Q & 0x1F;
+    }
+
+    if ((C & 7) == 5) {
+        q[1] = 4;
+        q[0] = (C >> 3) & 3;
+    } else {
+        q[1] = (C >> 3) & 3;
+        q[0] = C & 7;
+    }
+}
+
+// Reads bits but returns zeros beyond the end of the sequence.
+static BE_INLINE int ReadSequenceBits(const byte *block, int &pos, int numBits, int end) {
+    int value = 0;
+    for (int i = 0; i < numBits; i++, pos++) {
+        if (pos < end) {
+            value |= ((block[pos >> 3] >> (pos & 7)) & 1) << i;
+        }
+    }
+    return value;
+}
+
+// Writes bits but discards bits beyond the end of the sequence.
+static BE_INLINE void WriteSequenceBits(byte *block, int &pos, int numBits, int value, int end) {
+    for (int i = 0; i < numBits; i++, pos++) {
+        if (pos < end) {
+            block[pos >> 3] = (block[pos >> 3] & ~(1 << (pos & 7))) | (((value >> i) & 1) << (pos & 7));
+        }
+    }
+}
+
+int ASTCCodec::ISEBitCount(int count, int quant) {
+    const QuantInfo &info = quantInfo[quant];
+    if (info.trits) {
+        return count * info.bits + (8 * count + 4) / 5;
+    }
+    if (info.quints) {
+        return count * info.bits + (7 * count + 2) / 3;
+    }
+    return count * info.bits;
+}
+
+int ASTCCodec::ColorQuantForBits(int count, int bits) {
+    for (int quant = Quant256; quant >= Quant6; quant--) {
+        if (ISEBitCount(count, quant) <= bits) {
+            return quant;
+        }
+    }
+    return -1;
+}
+
+void ASTCCodec::DecodeISE(const byte *block, int bitOffset, int count, int quant, byte *values) {
+    static const int tritBits[5] = { 2, 2, 1, 2, 1 };
+    static const int quintBits[3] = { 3, 2, 2 };
+
+    const QuantInfo &info = quantInfo[quant];
+    const int end = bitOffset + ISEBitCount(count, quant);
+    int pos = bitOffset;
+
+    if (info.trits) {
+        for (int i = 0; i < count; i += 5) {
+            int m[5], t[5];
+            int T = 0;
+
+            for (int j = 0, shift = 0; j < 5; j++) {
+                m[j] = ReadSequenceBits(block, pos, info.bits, end);
+                T |= ReadSequenceBits(block, pos, tritBits[j], end) << shift;
+                shift += tritBits[j];
+            }
+
+            DecodeTrits(T, t);
+
+            for (int j = 0; j < 5 && i + j < count; j++) {
+                values[i + j] = (t[j] << info.bits) | m[j];
+            }
+        }
+    } else if (info.quints) {
+        for (int i = 0; i < count; i += 3) {
+            int m[3], q[3];
+            int Q = 0;
+
+            for (int j = 0, shift = 0; j < 3; j++) {
+                m[j] = ReadSequenceBits(block, pos, info.bits, end);
+                Q |= ReadSequenceBits(block, pos, quintBits[j], end) << shift;
+                shift += quintBits[j];
+            }
+
+            DecodeQuints(Q, q);
+
+            for (int j = 0; j < 3 && i + j < count; j++) {
+                values[i + j] = (q[j] << info.bits) | m[j];
+            }
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            values[i] = ReadSequenceBits(block, pos, info.bits, end);
+        }
+    }
+}
+
+void ASTCCodec::EncodeISE(const byte *values, int count, int quant, byte *block, int bitOffset) {
+    static const int tritBits[5] = { 2, 2, 1, 2, 1 };
+    static const int quintBits[3] = { 3, 2, 2 };
+
+    const QuantInfo &info = quantInfo[quant];
+    const int end = bitOffset + ISEBitCount(count, quant);
+    const int mask = (1 << info.bits) - 1;
+    int pos = bitOffset;
+
+    if (info.trits) {
+        for (int i = 0; i < count; i += 5) {
+            int m[5] = { 0, 0, 0, 0, 0 };
+            int index = 0;
+
+            for (int j = 4; j >= 0; j--) {
+                int value = i + j < count ? values[i + j] : 0;
+                m[j] = value & mask;
+                index = index * 3 + (value >> info.bits);
+            }
+
+            int T = tritEncodeTable[index];
+
+            for (int j = 0, shift = 0; j < 5; j++) {
+                WriteSequenceBits(block, pos, info.bits, m[j], end);
+                WriteSequenceBits(block, pos, tritBits[j], T >> shift, end);
+                shift += tritBits[j];
+            }
+        }
+    } else if (info.quints) {
+        for (int i = 0; i < count; i += 3) {
+            int m[3] = { 0, 0, 0 };
+            int index = 0;
+
+            for (int j = 2; j >= 0; j--) {
+                int value = i + j < count ? values[i + j] : 0;
+                m[j] = value & mask;
+                index = index * 5 + (value >> info.bits);
+            }
+
+            int Q = quintEncodeTable[index];
+
+            for (int j = 0, shift = 0; j < 3; j++) {
+                WriteSequenceBits(block, pos, info.bits, m[j], end);
+                WriteSequenceBits(block, pos, quintBits[j], Q >> shift, end);
+                shift += quintBits[j];
+            }
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            WriteSequenceBits(block, pos, info.bits, values[i], end);
+        }
+    }
+}
+
+bool ASTCCodec::DecodeBlockMode(int blockModeValue, BlockMode &mode) {
+    int baseQuant = (blockModeValue >> 4) & 1;
+    int H = (blockModeValue >> 9) & 1;
+    int D = (blockModeValue >> 10) & 1;
+    int A = (blockModeValue >> 5) & 3;
+
+    if (blockModeValue & 3) {
+        baseQuant |= (blockModeValue & 3) << 1;
+        int B = (blockModeValue >> 7) & 3;
+
+        switch ((blockModeValue >> 2) & 3) {
+        case 0:
+            mode.gridWidth = B + 4;
+            mode.gridHeight = A + 2;
+            break;
+        case 1:
+            mode.gridWidth = B + 8;
+            mode.gridHeight = A + 2;
+            break;
+        case 2:
+            mode.gridWidth = A + 2;
+            mode.gridHeight = B + 8;
+            break;
+        default:
+            B &= 1;
+            if (blockModeValue & 0x100) {
+                mode.gridWidth = B + 2;
+                mode.gridHeight = A + 2;
+            } else {
+                mode.gridWidth = A + 2;
+                mode.gridHeight = B + 6;
+            }
+            break;
+        }
+    } else {
+        baseQuant |= ((blockModeValue >> 2) & 3) << 1;
+        if (((blockModeValue >> 2) & 3) == 0) {
+            return false;
+        }
+
+        int B = (blockModeValue >> 9) & 3;
+
+        switch ((blockModeValue >> 7) & 3) {
+        case 0:
+            mode.gridWidth = 12;
+            mode.gridHeight = A + 2;
+            break;
+        case 1:
+            mode.gridWidth = A + 2;
+            mode.gridHeight = 12;
+            break;
+        case 2:
+            mode.gridWidth = A + 6;
+            mode.gridHeight = B + 6;
+            D = 0;
+            H = 0;
+            break;
+        default:
+            if (A == 0) {
+                mode.gridWidth = 6;
+                mode.gridHeight = 10;
+            } else if (A == 1) {
+                mode.gridWidth = 10;
+                mode.gridHeight = 6;
+            } else {
+                return false;
+            }
+            break;
+        }
+    }
+
+    int weightCount = mode.gridWidth * mode.gridHeight * (D + 1);
+
+    mode.dualPlane = D != 0;
+    mode.weightQuant = (baseQuant - 2) + 6 * H;
+    mode.weightBits = ISEBitCount(weightCount, mode.weightQuant);
+
+    return weightCount <= MaxWeights && mode.weightBits >= 24 && mode.weightBits <= 96;
+}
+
+int ASTCCodec::UnquantizeColor(int value, int quant) {
+    const QuantInfo &info = quantInfo[quant];
+
+    if (!info.trits && !info.quints) {
+        // Replicates bits to 8 bits.
+        int result = 0;
+        for (int shift = 8 - info.bits; shift > -info.bits; shift -= info.bits) {
+            result |= shift >= 0 ? value << shift : value >> -shift;
+        }
+        return result;
+    }
+
+    int D = value >> info.bits;
+    int m = value & ((1 << info.bits) - 1);
+    int A = (m & 1) ? 0x1FF : 0;
+    int x = m >> 1;
+    int B, C;
+
+    if (info.trits) {
+        switch (info.bits) {
+        case 1: B = 0; C = 204; break;
+        case 2: B = x * 0x116; C = 93; break;
+        case 3: B = (x << 7) | (x << 2) | x; C = 44; break;
+        case 4: B = (x << 6) | x; C = 22; break;
+        case 5: B = (x << 5) | (x >> 2); C = 11; break;
+        default: B = (x << 4) | (x >> 4); C = 5; break;
+        }
+    } else {
+        switch (info.bits) {
+        case 1: B = 0; C = 113; break;
+        case 2: B = x * 0x10C; C = 54; break;
+        case 3: B = (x << 7) | (x << 1) | (x >> 1); C = 26; break;
+        case 4: B = (x << 6) | (x >> 1); C = 13; break;
+        default: B = (x << 5) | (x >> 3); C = 6; break;
+        }
+    }
+
+    int T = D * C + B;
+    T ^= A;
+    return (A & 0x80) | (T >> 2);
+}
+
+int ASTCCodec::UnquantizeWeight(int value, int quant) {
+    const QuantInfo &info = quantInfo[quant];
+    int result;
+
+    if (!info.trits && !info.quints) {
+        // Replicates bits to 6 bits.
+        result = 0;
+        for (int shift = 6 - info.bits; shift > -info.bits; shift -= info.bits) {
+            result |= shift >= 0 ? value << shift : value >> -shift;
+        }
+    } else if (info.bits == 0) {
+        return info.trits ? value * 32 : value * 16;
+    } else {
+        int D = value >> info.bits;
+        int m = value & ((1 << info.bits) - 1);
+        int A = (m & 1) ? 0x7F : 0;
+        int x = m >> 1;
+        int B, C;
+
+        if (info.trits) {
+            switch (info.bits) {
+            case 1: B = 0; C = 50; break;
+            case 2: B = x * 0x45; C = 23; break;
+            default: B = (x << 5) | x; C = 11; break;
+            }
+        } else {
+            switch (info.bits) {
+            case 1: B = 0; C = 28; break;
+            default: B = x * 0x42; C = 13; break;
+            }
+        }
+
+        int T = D * C + B;
+        T ^= A;
+        result = (A & 0x20) | (T >> 2);
+    }
+
+    if (result > 32) {
+        result++;
+    }
+    return result;
+}
+
+static BE_INLINE uint32_t Hash52(uint32_t p) {
+    p ^= p >> 15;
+    p *= 0xEEDE0891;
+    p ^= p >> 5;
+    p += p << 16;
+    p ^= p >> 7;
+    p ^= p >> 3;
+    p ^= p << 6;
+    p ^= p >> 17;
+    return p;
+}
+
+int ASTCCodec::SelectPartition(int seed, int x, int y, int z, int partitionCount, bool smallBlock) {
+    if (smallBlock) {
+        x <<= 1;
+        y <<= 1;
+        z <<= 1;
+    }
+
+    seed += (partitionCount - 1) * 1024;
+
+    uint32_t rnum = Hash52(seed);
+
+    int seeds[12];
+    seeds[0] = rnum & 0xF;
+    seeds[1] = (rnum >> 4) & 0xF;
+    seeds[2] = (rnum >> 8) & 0xF;
+    seeds[3] = (rnum >> 12) & 0xF;
+    seeds[4] = (rnum >> 16) & 0xF;
+    seeds[5] = (rnum >> 20) & 0xF;
+    seeds[6] = (rnum >> 24) & 0xF;
+    seeds[7] = (rnum >> 28) & 0xF;
+    seeds[8] = (rnum >> 18) & 0xF;
+    seeds[9] = (rnum >> 22) & 0xF;
+    seeds[10] = (rnum >> 26) & 0xF;
+    seeds[11] = ((rnum >> 30) | (rnum << 2)) & 0xF;
+
+    for (int i = 0; i < 12; i++) {
+        seeds[i] *= seeds[i];
+    }
+
+    int sh1, sh2;
+    if (seed & 1) {
+        sh1 = (seed & 2) ? 4 : 5;
+        sh2 = partitionCount == 3 ? 6 : 5;
+    } else {
+        sh1 = partitionCount == 3 ? 6 : 5;
+        sh2 = (seed & 2) ? 4 : 5;
+    }
+    int sh3 = (seed & 0x10) ? sh1 : sh2;
+
+    for (int i = 0; i < 8; i++) {
+        seeds[i] >>= (i & 1) ? sh2 : sh1;
+    }
+    for (int i = 8; i < 12; i++) {
+        seeds[i] >>= sh3;
+    }
+
+    int a = (seeds[0] * x + seeds[1] * y + seeds[10] * z + (rnum >> 14)) & 0x3F;
+    int b = (seeds[2] * x + seeds[3] * y + seeds[11] * z + (rnum >> 10)) & 0x3F;
+    int c = (seeds[4] * x + seeds[5] * y + seeds[8] * z + (rnum >> 6)) & 0x3F;
+    int d = (seeds[6] * x + seeds[7] * y + seeds[9] * z + (rnum >> 2)) & 0x3F;
+
+    if (partitionCount < 4) {
+        d = 0;
+    }
+    if (partitionCount < 3) {
+        c = 0;
+    }
+
+    if (a >= b && a >= c && a >= d) {
+        return 0;
+    }
+    if (b >= c && b >= d) {
+        return 1;
+    }
+    if (c >= d) {
+        return 2;
+    }
+    return 3;
+}
+
+void ASTCCodec::ComputeInfillTaps(int blockWidth, int blockHeight, int gridWidth, int gridHeight, int s, int t, int *indices, int *weights) {
+    int ds = (1024 + blockWidth / 2) / (blockWidth - 1);
+    int dt = (1024 + blockHeight / 2) / (blockHeight - 1);
+
+    int gs = (ds * s * (gridWidth - 1) + 32) >> 6;
+    int gt = (dt * t * (gridHeight - 1) + 32) >> 6;
+
+    int js = gs >> 4;
+    int fs = gs & 15;
+    int jt = gt >> 4;
+    int ft = gt & 15;
+
+    // Taps out of the grid have zero weights. Clamp them to stay in the grid.
+    int js1 = Min(js + 1, gridWidth - 1);
+    int jt1 = Min(jt + 1, gridHeight - 1);
+
+    indices[0] = jt * gridWidth + js;
+    indices[1] = jt * gridWidth + js1;
+    indices[2] = jt1 * gridWidth + js;
+    indices[3] = jt1 * gridWidth + js1;
+
+    weights[3] = (fs * ft + 8) >> 4;
+    weights[2] = ft - weights[3];
+    weights[1] = fs - weights[3];
+    weights[0] = 16 - fs - ft + weights[3];
+}
+
+void ASTCCodec::ReverseBlockBits(const byte *src, byte *dst) {
+    for (int i = 0; i < BlockSize; i++) {
+        byte b = src[BlockSize - 1 - i];
+        b = (byte)(((b & 0xF0) >> 4) | ((b & 0x0F) << 4));
+        b = (byte)(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+        b = (byte)(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+        dst[i] = b;
+    }
+}
+
+BE_NAMESPACE_END
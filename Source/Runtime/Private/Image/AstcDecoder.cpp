@@ -0,0 +1,323 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Math/Math.h"
+#include "Image/AstcDecoder.h"
+
+BE_NAMESPACE_BEGIN
+
+static BE_INLINE void BitTransferSigned(int &a, int &b) {
+    b >>= 1;
+    b |= a & 0x80;
+    a >>= 1;
+    a &= 0x3F;
+    if (a & 0x20) {
+        a -= 0x40;
+    }
+}
+
+static BE_INLINE void BlueContract(int *c) {
+    c[0] = (c[0] + c[2]) >> 1;
+    c[1] = (c[1] + c[2]) >> 1;
+}
+
+static BE_INLINE void SetColor(int *c, int r, int g, int b, int a) {
+    c[0] = r;
+    c[1] = g;
+    c[2] = b;
+    c[3] = a;
+}
+
+static BE_INLINE int Clamp255(int value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+bool ASTCDecoder::DecodeColorEndpoints(int colorEndpointMode, const int *values, int *e0, int *e1) {
+    int v[8];
+    for (int i = 0; i < ((colorEndpointMode >> 2) + 1) * 2; i++) {
+        v[i] = values[i];
+    }
+
+    switch (colorEndpointMode) {
+    case 0: // LDR luminance, direct
+        SetColor(e0, v[0], v[0], v[0], 255);
+        SetColor(e1, v[1], v[1], v[1], 255);
+        break;
+    case 1: { // LDR luminance, base + offset
+        int l0 = (v[0] >> 2) | (v[1] & 0xC0);
+        int l1 = Min(l0 + (v[1] & 0x3F), 255);
+        SetColor(e0, l0, l0, l0, 255);
+        SetColor(e1, l1, l1, l1, 255);
+        break;
+    }
+    case 4: // LDR luminance + alpha, direct
+        SetColor(e0, v[0], v[0], v[0], v[2]);
+        SetColor(e1, v[1], v[1], v[1], v[3]);
+        break;
+    case 5: // LDR luminance + alpha, base + offset
+        BitTransferSigned(v[1], v[0]);
+        BitTransferSigned(v[3], v[2]);
+        SetColor(e0, v[0], v[0], v[0], v[2]);
+        SetColor(e1, Clamp255(v[0] + v[1]), Clamp255(v[0] + v[1]), Clamp255(v[0] + v[1]), Clamp255(v[2] + v[3]));
+        break;
+    case 6: // LDR RGB, base + scale
+        SetColor(e0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, 255);
+        SetColor(e1, v[0], v[1], v[2], 255);
+        break;
+    case 8: // LDR RGB, direct
+    case 12: { // LDR RGBA, direct
+        int a0 = colorEndpointMode == 12 ? v[6] : 255;
+        int a1 = colorEndpointMode == 12 ? v[7] : 255;
+        if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+            SetColor(e0, v[0], v[2], v[4], a0);
+            SetColor(e1, v[1], v[3], v[5], a1);
+        } else {
+            SetColor(e0, v[1], v[3], v[5], a1);
+            SetColor(e1, v[0], v[2], v[4], a0);
+            BlueContract(e0);
+            BlueContract(e1);
+        }
+        break;
+    }
+    case 9: // LDR RGB, base + offset
+    case 13: { // LDR RGBA, base + offset
+        BitTransferSigned(v[1], v[0]);
+        BitTransferSigned(v[3], v[2]);
+        BitTransferSigned(v[5], v[4]);
+        int a0 = 255;
+        int a1 = 255;
+        if (colorEndpointMode == 13) {
+            BitTransferSigned(v[7], v[6]);
+            a0 = v[6];
+            a1 = v[6] + v[7];
+        }
+        if (v[1] + v[3] + v[5] >= 0) {
+            SetColor(e0, v[0], v[2], v[4], a0);
+            SetColor(e1, v[0] + v[1], v[2] + v[3], v[4] + v[5], a1);
+        } else {
+            SetColor(e0, v[0] + v[1], v[2] + v[3], v[4] + v[5], a1);
+            SetColor(e1, v[0], v[2], v[4], a0);
+            BlueContract(e0);
+            BlueContract(e1);
+        }
+        for (int c = 0; c < 4; c++) {
+            e0[c] = Clamp255(e0[c]);
+            e1[c] = Clamp255(e1[c]);
+        }
+        break;
+    }
+    case 10: // LDR RGB, base + scale plus two alphas
+        SetColor(e0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8, (v[2] * v[3]) >> 8, v[4]);
+        SetColor(e1, v[0], v[1], v[2], v[5]);
+        break;
+    default: // HDR modes
+        return false;
+    }
+    return true;
+}
+
+void ASTCDecoder::FillErrorColor(int numTexels, byte *out) {
+    for (int i = 0; i < numTexels; i++) {
+        out[i * 4 + 0] = 0xFF;
+        out[i * 4 + 1] = 0x00;
+        out[i * 4 + 2] = 0xFF;
+        out[i * 4 + 3] = 0xFF;
+    }
+}
+
+void ASTCDecoder::DecodeBlock(const byte *block, const int blockWidth, const int blockHeight, byte *out) {
+    const int numTexels = blockWidth * blockHeight;
+    const int blockModeValue = ReadBits(block, 0, 11);
+
+    if ((blockModeValue & 0x1FF) == 0x1FC) {
+        // Void extent block
+        if (blockModeValue & 0x200) {
+            FillErrorColor(numTexels, out);
+            return;
+        }
+        byte color[4];
+        for (int c = 0; c < 4; c++) {
+            color[c] = (byte)(ReadBits(block, 64 + c * 16, 16) >> 8);
+        }
+        for (int i = 0; i < numTexels; i++) {
+            memcpy(&out[i * 4], color, 4);
+        }
+        return;
+    }
+
+    BlockMode mode;
+    if (!DecodeBlockMode(blockModeValue, mode) || mode.gridWidth > blockWidth || mode.gridHeight > blockHeight) {
+        FillErrorColor(numTexels, out);
+        return;
+    }
+
+    const int partitionCount = ReadBits(block, 11, 2) + 1;
+    if (mode.dualPlane && partitionCount == 4) {
+        FillErrorColor(numTexels, out);
+        return;
+    }
+
+    int partitionIndex = 0;
+    int colorEndpointModes[4];
+    int colorStart;
+    int extraCEMBits = 0;
+
+    if (partitionCount == 1) {
+        colorEndpointModes[0] = ReadBits(block, 13, 4);
+        colorStart = 17;
+    } else {
+        partitionIndex = ReadBits(block, 13, 10);
+        colorStart = 29;
+
+        int cemField = ReadBits(block, 23, 6);
+        if ((cemField & 3) == 0) {
+            for (int i = 0; i < partitionCount; i++) {
+                colorEndpointModes[i] = cemField >> 2;
+            }
+        } else {
+            // Extra bits are located just below the weights.
+            extraCEMBits = 3 * partitionCount - 4;
+            int encoded = cemField | (ReadBits(block, 128 - mode.weightBits - extraCEMBits, extraCEMBits) << 6);
+            int baseClass = (encoded & 3) - 1;
+
+            for (int i = 0; i < partitionCount; i++) {
+                int c = (encoded >> (2 + i)) & 1;
+                int m = (encoded >> (2 + partitionCount + i * 2)) & 3;
+                colorEndpointModes[i] = ((baseClass + c) << 2) | m;
+            }
+        }
+    }
+
+    int colorComponentSelector = -1;
+    int belowWeightsBits = extraCEMBits;
+
+    if (mode.dualPlane) {
+        belowWeightsBits += 2;
+        colorComponentSelector = ReadBits(block, 128 - mode.weightBits - belowWeightsBits, 2);
+    }
+
+    int numColorValues = 0;
+    for (int i = 0; i < partitionCount; i++) {
+        numColorValues += ((colorEndpointModes[i] >> 2) + 1) * 2;
+    }
+
+    if (numColorValues > MaxColorValues) {
+        FillErrorColor(numTexels, out);
+        return;
+    }
+
+    int colorQuant = ColorQuantForBits(numColorValues, 128 - mode.weightBits - belowWeightsBits - colorStart);
+    if (colorQuant < 0) {
+        FillErrorColor(numTexels, out);
+        return;
+    }
+
+    byte colorValues[MaxColorValues];
+    DecodeISE(block, colorStart, numColorValues, colorQuant, colorValues);
+
+    int endpoints[4][2][4];
+    for (int i = 0, offset = 0; i < partitionCount; i++) {
+        int values[8];
+        int count = ((colorEndpointModes[i] >> 2) + 1) * 2;
+
+        for (int j = 0; j < count; j++) {
+            values[j] = UnquantizeColor(colorValues[offset + j], colorQuant);
+        }
+        offset += count;
+
+        if (!DecodeColorEndpoints(colorEndpointModes[i], values, endpoints[i][0], endpoints[i][1])) {
+            FillErrorColor(numTexels, out);
+            return;
+        }
+    }
+
+    // Weights are stored in reverse bit order from the top of the block.
+    byte reversedBlock[BlockSize];
+    ReverseBlockBits(block, reversedBlock);
+
+    const int numPlanes = mode.dualPlane ? 2 : 1;
+    const int numGridWeights = mode.gridWidth * mode.gridHeight;
+
+    byte weightValues[MaxWeights];
+    DecodeISE(reversedBlock, 0, numGridWeights * numPlanes, mode.weightQuant, weightValues);
+
+    int gridWeights[2][MaxWeights];
+    for (int i = 0; i < numGridWeights; i++) {
+        for (int p = 0; p < numPlanes; p++) {
+            gridWeights[p][i] = UnquantizeWeight(weightValues[i * numPlanes + p], mode.weightQuant);
+        }
+    }
+
+    const bool smallBlock = numTexels < 31;
+
+    for (int t = 0; t < blockHeight; t++) {
+        for (int s = 0; s < blockWidth; s++) {
+            int tapIndices[4], tapWeights[4];
+            ComputeInfillTaps(blockWidth, blockHeight, mode.gridWidth, mode.gridHeight, s, t, tapIndices, tapWeights);
+
+            int weights[2] = { 0, 0 };
+            for (int p = 0; p < numPlanes; p++) {
+                int sum = 8;
+                for (int k = 0; k < 4; k++) {
+                    sum += gridWeights[p][tapIndices[k]] * tapWeights[k];
+                }
+                weights[p] = sum >> 4;
+            }
+
+            int partition = partitionCount > 1 ? SelectPartition(partitionIndex, s, t, 0, partitionCount, smallBlock) : 0;
+            const int *e0 = endpoints[partition][0];
+            const int *e1 = endpoints[partition][1];
+
+            byte *dst = &out[(t * blockWidth + s) * 4];
+
+            for (int c = 0; c < 4; c++) {
+                int w = c == colorComponentSelector ? weights[1] : weights[0];
+                // Endpoints are expanded to 16 bits for interpolation.
+                int c0 = (e0[c] << 8) | e0[c];
+                int c1 = (e1[c] << 8) | e1[c];
+                dst[c] = (byte)(((c0 * (64 - w) + c1 * w + 32) >> 6) >> 8);
+            }
+        }
+    }
+}
+
+void ASTCDecoder::DecompressImageASTC(const byte *src, const int blockWidth, const int blockHeight, const int width, const int height, const int depth, byte *out) {
+    byte unpackedBlock[MaxTexels * 4];
+
+    for (int z = 0; z < depth; z++) {
+        byte *dst_z = out + 4 * (width * height * z);
+
+        for (int y = 0; y < height; y += blockHeight) {
+            byte *dstPtr = dst_z + 4 * width * y;
+
+            int dstBlockHeight = Min(blockHeight, height - y);
+
+            for (int x = 0; x < width; x += blockWidth, dstPtr += 4 * blockWidth) {
+                DecodeBlock(src, blockWidth, blockHeight, unpackedBlock);
+                src += BlockSize;
+
+                byte *srcPtr = unpackedBlock;
+
+                int dstBlockWidth = Min(blockWidth, width - x);
+
+                for (int i = 0; i < dstBlockHeight; i++, srcPtr += 4 * blockWidth) {
+                    memcpy(dstPtr + i * 4 * width, srcPtr, dstBlockWidth * 4);
+                }
+            }
+        }
+    }
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,545 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Math/Math.h"
+#include "Containers/Array.h"
+#include "Image/AstcEncoder.h"
+
+BE_NAMESPACE_BEGIN
+
+struct ASTCBlockConfig {
+    int                     blockModeValue;
+    int                     gridWidth;
+    int                     gridHeight;
+    int                     weightQuant;
+    int                     colorQuant;
+    float                   expectedError;
+};
+
+struct ASTCFootprintConfigs {
+    int                     blockWidth;
+    int                     blockHeight;
+    Array<ASTCBlockConfig>  configs[2];             // for RGB and RGBA direct endpoint modes
+};
+
+// Quantization tables and block mode candidates shared by all encoding threads.
+// Built once at the first use.
+struct ASTCEncoderTables {
+    ASTCEncoderTables();
+
+    const ASTCFootprintConfigs *FindFootprint(int blockWidth, int blockHeight) const;
+
+    int                     colorValues[ASTCCodec::NumQuants][256];
+    byte                    nearestColorCodes[ASTCCodec::NumQuants][256];
+    int                     weightValues[ASTCCodec::Quant32 + 1][32];
+    byte                    nearestWeightCodes[ASTCCodec::Quant32 + 1][65];
+    ASTCFootprintConfigs    footprints[14];
+};
+
+static const int footprintSizes[14][2] = {
+    { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 }, { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+};
+
+ASTCEncoderTables::ASTCEncoderTables() {
+    for (int quant = 0; quant < ASTCCodec::NumQuants; quant++) {
+        int levels = ASTCCodec::QuantLevels(quant);
+        for (int code = 0; code < levels; code++) {
+            colorValues[quant][code] = ASTCCodec::UnquantizeColor(code, quant);
+        }
+        for (int value = 0; value < 256; value++) {
+            int bestCode = 0;
+            for (int code = 1; code < levels; code++) {
+                if (Math::Abs(colorValues[quant][code] - value) < Math::Abs(colorValues[quant][bestCode] - value)) {
+                    bestCode = code;
+                }
+            }
+            nearestColorCodes[quant][value] = bestCode;
+        }
+    }
+
+    for (int quant = 0; quant <= ASTCCodec::Quant32; quant++) {
+        int levels = ASTCCodec::QuantLevels(quant);
+        for (int code = 0; code < levels; code++) {
+            weightValues[quant][code] = ASTCCodec::UnquantizeWeight(code, quant);
+        }
+        for (int value = 0; value <= 64; value++) {
+            int bestCode = 0;
+            for (int code = 1; code < levels; code++) {
+                if (Math::Abs(weightValues[quant][code] - value) < Math::Abs(weightValues[quant][bestCode] - value)) {
+                    bestCode = code;
+                }
+            }
+            nearestWeightCodes[quant][value] = bestCode;
+        }
+    }
+
+    for (int i = 0; i < COUNT_OF(footprintSizes); i++) {
+        ASTCFootprintConfigs &footprint = footprints[i];
+        footprint.blockWidth = footprintSizes[i][0];
+        footprint.blockHeight = footprintSizes[i][1];
+
+        const int numTexels = footprint.blockWidth * footprint.blockHeight;
+
+        for (int modeValue = 0; modeValue < 2048; modeValue++) {
+            ASTCCodec::BlockMode mode;
+            if (!ASTCCodec::DecodeBlockMode(modeValue, mode) || mode.dualPlane ||
+                mode.gridWidth > footprint.blockWidth || mode.gridHeight > footprint.blockHeight) {
+                continue;
+            }
+
+            for (int k = 0; k < 2; k++) {
+                // Single partition blocks store colors after 17 bits of block mode, partition count and endpoint mode.
+                int colorQuant = ASTCCodec::ColorQuantForBits(k == 0 ? 6 : 8, 128 - 17 - mode.weightBits);
+                if (colorQuant < 0) {
+                    continue;
+                }
+
+                Array<ASTCBlockConfig> &configs = footprint.configs[k];
+
+                bool skip = false;
+                for (int j = 0; j < configs.Count(); j++) {
+                    const ASTCBlockConfig &c = configs[j];
+                    if (c.gridWidth == mode.gridWidth && c.gridHeight == mode.gridHeight && c.weightQuant == mode.weightQuant) {
+                        skip = true;
+                        break;
+                    }
+                }
+                if (skip) {
+                    continue;
+                }
+
+                // Rough per texel squared error model of the weight grid downsampling,
+                // the weight quantization over the typical endpoint range and the color quantization.
+                float weightStep = 64.0f / (ASTCCodec::QuantLevels(mode.weightQuant) - 1);
+                float colorStep = 256.0f / (ASTCCodec::QuantLevels(colorQuant) - 1);
+
+                ASTCBlockConfig config;
+                config.blockModeValue = modeValue;
+                config.gridWidth = mode.gridWidth;
+                config.gridHeight = mode.gridHeight;
+                config.weightQuant = mode.weightQuant;
+                config.colorQuant = colorQuant;
+                config.expectedError = (1.0f - (float)(mode.gridWidth * mode.gridHeight) / numTexels) * 32.0f +
+                    weightStep * weightStep / 12.0f + colorStep * colorStep / 12.0f;
+                configs.Append(config);
+            }
+        }
+
+        for (int k = 0; k < 2; k++) {
+            Array<ASTCBlockConfig> &configs = footprint.configs[k];
+
+            // Remove configurations dominated by another one in all of the grid size and the quantization levels.
+            for (int j = configs.Count() - 1; j >= 0; j--) {
+                const ASTCBlockConfig &a = configs[j];
+
+                for (int l = 0; l < configs.Count(); l++) {
+                    const ASTCBlockConfig &b = configs[l];
+                    if (l != j && b.gridWidth >= a.gridWidth && b.gridHeight >= a.gridHeight && b.weightQuant >= a.weightQuant && b.colorQuant >= a.colorQuant) {
+                        configs.RemoveIndex(j);
+                        break;
+                    }
+                }
+            }
+
+            configs.Sort([](const ASTCBlockConfig &a, const ASTCBlockConfig &b) {
+                return a.expectedError < b.expectedError;
+            });
+        }
+    }
+}
+
+const ASTCFootprintConfigs *ASTCEncoderTables::FindFootprint(int blockWidth, int blockHeight) const {
+    for (int i = 0; i < COUNT_OF(footprints); i++) {
+        if (footprints[i].blockWidth == blockWidth && footprints[i].blockHeight == blockHeight) {
+            return &footprints[i];
+        }
+    }
+    return nullptr;
+}
+
+static const ASTCEncoderTables &GetEncoderTables() {
+    static const ASTCEncoderTables tables;
+    return tables;
+}
+
+struct ASTCBlockEncoding {
+    const ASTCBlockConfig * config;
+    byte                    colorCodes[8];
+    byte                    weightCodes[ASTCCodec::MaxWeights];
+    int                     error;
+};
+
+// Computes principal axis endpoints of the texels. Returns false if all texels are same.
+static bool ComputeEndpoints(const float (*texels)[4], int numTexels, int numChannels, float *e0, float *e1) {
+    float mean[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < numTexels; i++) {
+        for (int c = 0; c < numChannels; c++) {
+            mean[c] += texels[i][c];
+        }
+    }
+    for (int c = 0; c < numChannels; c++) {
+        mean[c] /= numTexels;
+    }
+
+    float cov[4][4];
+    memset(cov, 0, sizeof(cov));
+
+    for (int i = 0; i < numTexels; i++) {
+        for (int a = 0; a < numChannels; a++) {
+            for (int b = 0; b < numChannels; b++) {
+                cov[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+            }
+        }
+    }
+
+    int maxIndex = 0;
+    for (int c = 1; c < numChannels; c++) {
+        if (cov[c][c] > cov[maxIndex][maxIndex]) {
+            maxIndex = c;
+        }
+    }
+
+    if (cov[maxIndex][maxIndex] < 1e-6f) {
+        for (int c = 0; c < numChannels; c++) {
+            e0[c] = e1[c] = mean[c];
+        }
+        return false;
+    }
+
+    float axis[4];
+    for (int c = 0; c < numChannels; c++) {
+        axis[c] = cov[c][maxIndex];
+    }
+
+    for (int iter = 0; iter < 8; iter++) {
+        float v[4];
+        float maxAbs = 0.0f;
+        for (int a = 0; a < numChannels; a++) {
+            v[a] = 0.0f;
+            for (int b = 0; b < numChannels; b++) {
+                v[a] += cov[a][b] * axis[b];
+            }
+            maxAbs = Max(maxAbs, Math::Fabs(v[a]));
+        }
+        if (maxAbs < 1e-12f) {
+            break;
+        }
+        for (int c = 0; c < numChannels; c++) {
+            axis[c] = v[c] / maxAbs;
+        }
+    }
+
+    float minT = FLT_MAX;
+    float maxT = -FLT_MAX;
+    float lengthSqr = 0.0f;
+
+    for (int c = 0; c < numChannels; c++) {
+        lengthSqr += axis[c] * axis[c];
+    }
+
+    for (int i = 0; i < numTexels; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < numChannels; c++) {
+            t += (texels[i][c] - mean[c]) * axis[c];
+        }
+        t /= lengthSqr;
+        minT = Min(minT, t);
+        maxT = Max(maxT, t);
+    }
+
+    for (int c = 0; c < numChannels; c++) {
+        e0[c] = mean[c] + minT * axis[c];
+        e1[c] = mean[c] + maxT * axis[c];
+    }
+    return true;
+}
+
+// Projects texels onto the endpoint segment and returns the ideal weights in [0, 1].
+static void ComputeIdealWeights(const float (*texels)[4], int numTexels, int numChannels, const float *e0, const float *e1, float *weights) {
+    float dir[4];
+    float lengthSqr = 0.0f;
+
+    for (int c = 0; c < numChannels; c++) {
+        dir[c] = e1[c] - e0[c];
+        lengthSqr += dir[c] * dir[c];
+    }
+
+    for (int i = 0; i < numTexels; i++) {
+        if (lengthSqr < 1e-6f) {
+            weights[i] = 0.0f;
+            continue;
+        }
+        float t = 0.0f;
+        for (int c = 0; c < numChannels; c++) {
+            t += (texels[i][c] - e0[c]) * dir[c];
+        }
+        weights[i] = Min(Max(t / lengthSqr, 0.0f), 1.0f);
+    }
+}
+
+static int QuantizeColor(const ASTCEncoderTables &tables, int quant, float value) {
+    int v = (int)(value + 0.5f);
+    return tables.nearestColorCodes[quant][v < 0 ? 0 : (v > 255 ? 255 : v)];
+}
+
+// Encodes the block with the block mode configuration from the endpoints and the ideal texel weights.
+static void EncodeWithConfig(const ASTCEncoderTables &tables, const ASTCBlockConfig &config, const byte *texels, const float (*texelsF)[4],
+    int blockWidth, int blockHeight, int numChannels, const float *endpoint0, const float *endpoint1, int numIterations, ASTCBlockEncoding &best) {
+    const int numTexels = blockWidth * blockHeight;
+    const int numGridWeights = config.gridWidth * config.gridHeight;
+    const int *weightValues = tables.weightValues[config.weightQuant];
+
+    int tapIndices[ASTCCodec::MaxTexels][4];
+    int tapWeights[ASTCCodec::MaxTexels][4];
+
+    for (int t = 0, i = 0; t < blockHeight; t++) {
+        for (int s = 0; s < blockWidth; s++, i++) {
+            ASTCCodec::ComputeInfillTaps(blockWidth, blockHeight, config.gridWidth, config.gridHeight, s, t, tapIndices[i], tapWeights[i]);
+        }
+    }
+
+    float e0[4], e1[4];
+    memcpy(e0, endpoint0, sizeof(e0));
+    memcpy(e1, endpoint1, sizeof(e1));
+
+    for (int iter = 0; ; iter++) {
+        float idealWeights[ASTCCodec::MaxTexels];
+        ComputeIdealWeights(texelsF, numTexels, numChannels, e0, e1, idealWeights);
+
+        // Downsample the ideal weights to the grid using the transposed infill weights.
+        float gridSum[ASTCCodec::MaxWeights];
+        float gridWeightSum[ASTCCodec::MaxWeights];
+        for (int j = 0; j < numGridWeights; j++) {
+            gridSum[j] = 0.0f;
+            gridWeightSum[j] = 0.0f;
+        }
+        for (int i = 0; i < numTexels; i++) {
+            for (int k = 0; k < 4; k++) {
+                gridSum[tapIndices[i][k]] += tapWeights[i][k] * idealWeights[i];
+                gridWeightSum[tapIndices[i][k]] += tapWeights[i][k];
+            }
+        }
+
+        ASTCBlockEncoding encoding;
+        encoding.config = &config;
+
+        for (int j = 0; j < numGridWeights; j++) {
+            float w = gridWeightSum[j] > 0.0f ? gridSum[j] / gridWeightSum[j] : 0.5f;
+            encoding.weightCodes[j] = tables.nearestWeightCodes[config.weightQuant][(int)(w * 64.0f + 0.5f)];
+        }
+
+        // RGB values are stored as R0 R1 G0 G1 B0 B1 and followed by A0 A1 for RGBA.
+        int numColorValues = numChannels * 2;
+        for (int c = 0; c < numChannels; c++) {
+            encoding.colorCodes[c * 2 + 0] = QuantizeColor(tables, config.colorQuant, e0[c]);
+            encoding.colorCodes[c * 2 + 1] = QuantizeColor(tables, config.colorQuant, e1[c]);
+        }
+
+        int v[8];
+        for (int j = 0; j < numColorValues; j++) {
+            v[j] = tables.colorValues[config.colorQuant][encoding.colorCodes[j]];
+        }
+
+        // Decoder swaps endpoints with blue contraction if the sum of the second endpoint is smaller.
+        // Swap endpoints and invert weights to keep them in direct mode.
+        if (v[1] + v[3] + v[5] < v[0] + v[2] + v[4]) {
+            for (int j = 0; j < numColorValues; j += 2) {
+                Swap(encoding.colorCodes[j], encoding.colorCodes[j + 1]);
+                Swap(v[j], v[j + 1]);
+            }
+            for (int j = 0; j < numGridWeights; j++) {
+                encoding.weightCodes[j] = tables.nearestWeightCodes[config.weightQuant][64 - weightValues[encoding.weightCodes[j]]];
+            }
+        }
+
+        int texelWeights[ASTCCodec::MaxTexels];
+        encoding.error = 0;
+
+        for (int i = 0; i < numTexels; i++) {
+            int sum = 8;
+            for (int k = 0; k < 4; k++) {
+                sum += weightValues[encoding.weightCodes[tapIndices[i][k]]] * tapWeights[i][k];
+            }
+            int w = sum >> 4;
+            texelWeights[i] = w;
+
+            for (int c = 0; c < 4; c++) {
+                int c0 = c < numChannels ? v[c * 2 + 0] : 255;
+                int c1 = c < numChannels ? v[c * 2 + 1] : 255;
+                c0 = (c0 << 8) | c0;
+                c1 = (c1 << 8) | c1;
+                int d = (((c0 * (64 - w) + c1 * w + 32) >> 6) >> 8) - texels[i * 4 + c];
+                encoding.error += d * d;
+            }
+        }
+
+        if (encoding.error < best.error) {
+            best = encoding;
+        }
+
+        if (iter >= numIterations || encoding.error == 0) {
+            break;
+        }
+
+        // Refine the endpoints with the least squares fit to the decoded weights.
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[4] = { 0, 0, 0, 0 };
+        float bx[4] = { 0, 0, 0, 0 };
+
+        for (int i = 0; i < numTexels; i++) {
+            float b = texelWeights[i] / 64.0f;
+            float a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < numChannels; c++) {
+                ax[c] += a * texelsF[i][c];
+                bx[c] += b * texelsF[i][c];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if (Math::Fabs(det) < 1e-6f) {
+            break;
+        }
+
+        // Solved endpoints are in the order of the stored endpoints which may have been swapped.
+        float invDet = 1.0f / det;
+        for (int c = 0; c < numChannels; c++) {
+            e0[c] = Min(Max((ax[c] * bb - bx[c] * ab) * invDet, 0.0f), 255.0f);
+            e1[c] = Min(Max((bx[c] * aa - ax[c] * ab) * invDet, 0.0f), 255.0f);
+        }
+    }
+}
+
+// Writes a void extent block which has constant color.
+static void EncodeVoidExtent(const byte *color, byte *dst) {
+    memset(dst, 0xFF, 8);
+    ASTCCodec::WriteBits(dst, 0, 12, 0xDFC);
+
+    for (int c = 0; c < 4; c++) {
+        ASTCCodec::WriteBits(dst, 64 + c * 16, 16, color[c] * 257);
+    }
+}
+
+void ASTCEncoder::EncodeBlock(const byte *texels, const int blockWidth, const int blockHeight, Image::CompressionQuality::Enum quality, byte *dst) {
+    const ASTCEncoderTables &tables = GetEncoderTables();
+    const ASTCFootprintConfigs *footprint = tables.FindFootprint(blockWidth, blockHeight);
+    assert(footprint);
+
+    const int numTexels = blockWidth * blockHeight;
+
+    float texelsF[MaxTexels][4];
+    bool opaque = true;
+
+    for (int i = 0; i < numTexels; i++) {
+        for (int c = 0; c < 4; c++) {
+            texelsF[i][c] = texels[i * 4 + c];
+        }
+        if (texels[i * 4 + 3] != 255) {
+            opaque = false;
+        }
+    }
+
+    const int numChannels = opaque ? 3 : 4;
+
+    float e0[4], e1[4];
+    if (!ComputeEndpoints(texelsF, numTexels, numChannels, e0, e1)) {
+        EncodeVoidExtent(texels, dst);
+        return;
+    }
+
+    if (e1[0] + e1[1] + e1[2] < e0[0] + e0[1] + e0[2]) {
+        for (int c = 0; c < numChannels; c++) {
+            Swap(e0[c], e1[c]);
+        }
+    }
+
+    const Array<ASTCBlockConfig> &configs = footprint->configs[opaque ? 0 : 1];
+
+    int numCandidates;
+    int numIterations;
+
+    switch (quality) {
+    case Image::CompressionQuality::Fast:
+        numCandidates = 2;
+        numIterations = 0;
+        break;
+    case Image::CompressionQuality::Normal:
+        numCandidates = 6;
+        numIterations = 1;
+        break;
+    default:
+        numCandidates = configs.Count();
+        numIterations = 2;
+        break;
+    }
+    numCandidates = Min(numCandidates, configs.Count());
+
+    ASTCBlockEncoding best;
+    best.error = INT_MAX;
+
+    for (int i = 0; i < numCandidates && best.error > 0; i++) {
+        EncodeWithConfig(tables, configs[i], texels, texelsF, blockWidth, blockHeight, numChannels, e0, e1, numIterations, best);
+    }
+
+    const ASTCBlockConfig &config = *best.config;
+
+    memset(dst, 0, BlockSize);
+    WriteBits(dst, 0, 11, config.blockModeValue);
+    WriteBits(dst, 11, 2, 0);
+    WriteBits(dst, 13, 4, opaque ? 8 : 12);
+    EncodeISE(best.colorCodes, numChannels * 2, config.colorQuant, dst, 17);
+
+    byte weightBlock[BlockSize];
+    byte reversedWeightBlock[BlockSize];
+    memset(weightBlock, 0, BlockSize);
+    EncodeISE(best.weightCodes, config.gridWidth * config.gridHeight, config.weightQuant, weightBlock, 0);
+    ReverseBlockBits(weightBlock, reversedWeightBlock);
+
+    for (int i = 0; i < BlockSize; i++) {
+        dst[i] |= reversedWeightBlock[i];
+    }
+}
+
+void ASTCEncoder::CompressImageASTC(const byte *src, const int blockWidth, const int blockHeight, const int width, const int height, const int depth, byte *dst, Image::CompressionQuality::Enum quality) {
+    byte texels[MaxTexels * 4];
+    byte *dstPtr = dst;
+
+    for (int z = 0; z < depth; z++) {
+        const byte *src_z = src + 4 * width * height * z;
+
+        for (int y = 0; y < height; y += blockHeight) {
+            for (int x = 0; x < width; x += blockWidth, dstPtr += BlockSize) {
+                int bw = Min(blockWidth, width - x);
+                int bh = Min(blockHeight, height - y);
+
+                // Extract the block replicating the edge texels.
+                byte *texelPtr = texels;
+                for (int by = 0; by < blockHeight; by++) {
+                    const byte *srcPtrY = src_z + 4 * (width * (y + Min(by, bh - 1)) + x);
+
+                    for (int bx = 0; bx < blockWidth; bx++, texelPtr += 4) {
+                        memcpy(texelPtr, srcPtrY + 4 * Min(bx, bw - 1), 4);
+                    }
+                }
+
+                EncodeBlock(texels, blockWidth, blockHeight, quality, dstPtr);
+            }
+        }
+    }
+}
+
+BE_NAMESPACE_END
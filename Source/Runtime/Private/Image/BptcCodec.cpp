@@ -0,0 +1,235 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Image/BptcCodec.h"
+
+BE_NAMESPACE_BEGIN
+
+// { numSubsets, partitionBits, rotationBits, indexSelectionBits, colorBits, alphaBits, endpointPBits, sharedPBits, indexBits, index2Bits }
+const BPTCCodec::BC7ModeInfo BPTCCodec::bc7Modes[8] = {
+    { 3,  4,  0,  0,  4,  0,  1,  0,  3,  0 },
+    { 2,  6,  0,  0,  6,  0,  0,  1,  3,  0 },
+    { 3,  6,  0,  0,  5,  0,  0,  0,  2,  0 },
+    { 2,  6,  0,  0,  7,  0,  1,  0,  2,  0 },
+    { 1,  0,  2,  1,  5,  6,  0,  0,  2,  3 },
+    { 1,  0,  2,  0,  7,  8,  0,  0,  2,  2 },
+    { 1,  0,  0,  0,  7,  7,  1,  0,  4,  0 },
+    { 2,  6,  0,  0,  5,  5,  1,  0,  2,  0 }
+};
+
+static const byte bc6hLayout1[] = {
+    0x74, 0x84, 0xB4, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    0x09, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20,
+    0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x30, 0x31, 0x32,
+    0x33, 0x34, 0xA4, 0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x44,
+    0xB0, 0xA0, 0xA1, 0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x54, 0xB1, 0x80,
+    0x81, 0x82, 0x83, 0x60, 0x61, 0x62, 0x63, 0x64, 0xB2, 0x90, 0x91, 0x92,
+    0x93, 0x94, 0xB3
+};
+
+static const byte bc6hLayout2[] = {
+    0x75, 0xA4, 0xA5, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0xB0, 0xB1,
+    0x84, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x85, 0xB2, 0x74, 0x20,
+    0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0xB3, 0xB5, 0xB4, 0x30, 0x31, 0x32,
+    0x33, 0x34, 0x35, 0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x44,
+    0x45, 0xA0, 0xA1, 0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x80,
+    0x81, 0x82, 0x83, 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x90, 0x91, 0x92,
+    0x93, 0x94, 0x95
+};
+
+static const byte bc6hLayout3[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x30, 0x31, 0x32, 0x33, 0x34, 0x0A,
+    0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x1A, 0xB0, 0xA0, 0xA1,
+    0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x2A, 0xB1, 0x80, 0x81, 0x82, 0x83,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0xB2, 0x90, 0x91, 0x92, 0x93, 0x94, 0xB3
+};
+
+static const byte bc6hLayout4[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x30, 0x31, 0x32, 0x33, 0x0A, 0xA4,
+    0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x44, 0x1A, 0xA0, 0xA1,
+    0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x2A, 0xB1, 0x80, 0x81, 0x82, 0x83,
+    0x60, 0x61, 0x62, 0x63, 0xB0, 0xB2, 0x90, 0x91, 0x92, 0x93, 0x74, 0xB3
+};
+
+static const byte bc6hLayout5[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x30, 0x31, 0x32, 0x33, 0x0A, 0x84,
+    0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x1A, 0xB0, 0xA0, 0xA1,
+    0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x54, 0x2A, 0x80, 0x81, 0x82, 0x83,
+    0x60, 0x61, 0x62, 0x63, 0xB1, 0xB2, 0x90, 0x91, 0x92, 0x93, 0xB4, 0xB3
+};
+
+static const byte bc6hLayout6[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x84, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x74, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0xB4, 0x30, 0x31, 0x32, 0x33, 0x34, 0xA4,
+    0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x44, 0xB0, 0xA0, 0xA1,
+    0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x54, 0xB1, 0x80, 0x81, 0x82, 0x83,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0xB2, 0x90, 0x91, 0x92, 0x93, 0x94, 0xB3
+};
+
+static const byte bc6hLayout7[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xA4, 0x84, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0xB2, 0x74, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0xB3, 0xB4, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35,
+    0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x44, 0xB0, 0xA0, 0xA1,
+    0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x54, 0xB1, 0x80, 0x81, 0x82, 0x83,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x90, 0x91, 0x92, 0x93, 0x94, 0x95
+};
+
+static const byte bc6hLayout8[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xB0, 0x84, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x75, 0x74, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0xA5, 0xB4, 0x30, 0x31, 0x32, 0x33, 0x34, 0xA4,
+    0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0xA0, 0xA1,
+    0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x54, 0xB1, 0x80, 0x81, 0x82, 0x83,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0xB2, 0x90, 0x91, 0x92, 0x93, 0x94, 0xB3
+};
+
+static const byte bc6hLayout9[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xB1, 0x84, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x85, 0x74, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0xB5, 0xB4, 0x30, 0x31, 0x32, 0x33, 0x34, 0xA4,
+    0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x44, 0xB0, 0xA0, 0xA1,
+    0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x80, 0x81, 0x82, 0x83,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0xB2, 0x90, 0x91, 0x92, 0x93, 0x94, 0xB3
+};
+
+static const byte bc6hLayout10[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0xA4, 0xB0, 0xB1, 0x84, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x75, 0x85, 0xB2, 0x74, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0xA5, 0xB3, 0xB5, 0xB4, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35,
+    0x70, 0x71, 0x72, 0x73, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0xA0, 0xA1,
+    0xA2, 0xA3, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x80, 0x81, 0x82, 0x83,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x90, 0x91, 0x92, 0x93, 0x94, 0x95
+};
+
+static const byte bc6hLayout11[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35,
+    0x36, 0x37, 0x38, 0x39, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59
+};
+
+static const byte bc6hLayout12[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35,
+    0x36, 0x37, 0x38, 0x0A, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x1A, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x2A
+};
+
+static const byte bc6hLayout13[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35,
+    0x36, 0x37, 0x0B, 0x0A, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x1B, 0x1A, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x2B, 0x2A
+};
+
+static const byte bc6hLayout14[] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x11,
+    0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x20, 0x21, 0x22, 0x23,
+    0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x30, 0x31, 0x32, 0x33, 0x0F, 0x0E,
+    0x0D, 0x0C, 0x0B, 0x0A, 0x40, 0x41, 0x42, 0x43, 0x1F, 0x1E, 0x1D, 0x1C,
+    0x1B, 0x1A, 0x50, 0x51, 0x52, 0x53, 0x2F, 0x2E, 0x2D, 0x2C, 0x2B, 0x2A
+};
+
+// { modeValue, modeBits, transformed, numRegions, endpointBits, deltaBits, numLayoutBits, layout }
+const BPTCCodec::BC6HModeInfo BPTCCodec::bc6hModes[BPTCCodec::NumBC6HModes] = {
+    {  0, 2, true,  2, 10, {  5,  5,  5 }, 75, bc6hLayout1 },
+    {  1, 2, true,  2,  7, {  6,  6,  6 }, 75, bc6hLayout2 },
+    {  2, 5, true,  2, 11, {  5,  4,  4 }, 72, bc6hLayout3 },
+    {  6, 5, true,  2, 11, {  4,  5,  4 }, 72, bc6hLayout4 },
+    { 10, 5, true,  2, 11, {  4,  4,  5 }, 72, bc6hLayout5 },
+    { 14, 5, true,  2,  9, {  5,  5,  5 }, 72, bc6hLayout6 },
+    { 18, 5, true,  2,  8, {  6,  5,  5 }, 72, bc6hLayout7 },
+    { 22, 5, true,  2,  8, {  5,  6,  5 }, 72, bc6hLayout8 },
+    { 26, 5, true,  2,  8, {  5,  5,  6 }, 72, bc6hLayout9 },
+    { 30, 5, false, 2,  6, {  6,  6,  6 }, 72, bc6hLayout10 },
+    {  3, 5, false, 1, 10, { 10, 10, 10 }, 60, bc6hLayout11 },
+    {  7, 5, true,  1, 11, {  9,  9,  9 }, 60, bc6hLayout12 },
+    { 11, 5, true,  1, 12, {  8,  8,  8 }, 60, bc6hLayout13 },
+    { 15, 5, true,  1, 16, {  4,  4,  4 }, 60, bc6hLayout14 }
+};
+
+// Bit i is set if the pixel i belongs to the second subset.
+const uint16_t BPTCCodec::partitionTable2[64] = {
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+    0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+    0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+    0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+    0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+    0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+    0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+    0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22
+};
+
+// 2 bits subset index per pixel, pixel 0 is in the lowest bits.
+const uint32_t BPTCCodec::partitionTable3[64] = {
+    0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+    0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+    0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+    0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+    0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+    0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+    0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+    0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254
+};
+
+// Anchor pixel index of the second subset for the 2 subsets partitions.
+const byte BPTCCodec::anchorTable2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+};
+
+// Anchor pixel index of the second subset for the 3 subsets partitions.
+const byte BPTCCodec::anchorTable3a[64] = {
+     3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+     3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+     8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+     3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3
+};
+
+// Anchor pixel index of the third subset for the 3 subsets partitions.
+const byte BPTCCodec::anchorTable3b[64] = {
+    15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+    15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+    15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+    15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8
+};
+
+const byte BPTCCodec::weights2[4] = { 0, 21, 43, 64 };
+const byte BPTCCodec::weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+const byte BPTCCodec::weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+const BPTCCodec::BC6HModeInfo *BPTCCodec::FindBC6HMode(int modeValue) {
+    for (int i = 0; i < NumBC6HModes; i++) {
+        if (bc6hModes[i].modeValue == modeValue) {
+            return &bc6hModes[i];
+        }
+    }
+    return nullptr;
+}
+
+BE_NAMESPACE_END
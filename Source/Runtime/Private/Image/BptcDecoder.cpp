@@ -0,0 +1,311 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Math/Math.h"
+#include "Image/BptcDecoder.h"
+
+BE_NAMESPACE_BEGIN
+
+// Expands n bits value to 8 bits by replicating the most significant bits.
+static BE_INLINE int ExpandBits(int value, int bits) {
+    return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+static BE_INLINE int SignExtend(int value, int bits) {
+    int shift = 32 - bits;
+    return (int)((uint32_t)value << shift) >> shift;
+}
+
+void BPTCDecoder::DecodeBC7Block(const byte *block, byte *out) {
+    int mode = 0;
+    while (mode < 8 && !(block[0] & (1 << mode))) {
+        mode++;
+    }
+
+    if (mode == 8) {
+        // Reserved mode decodes to transparent black.
+        memset(out, 0, 16 * 4);
+        return;
+    }
+
+    const BC7ModeInfo &info = bc7Modes[mode];
+
+    BitReader reader(block);
+    reader.ReadBits(mode + 1);
+
+    int partition = reader.ReadBits(info.partitionBits);
+    int rotation = reader.ReadBits(info.rotationBits);
+    int indexSelection = reader.ReadBits(info.indexSelectionBits);
+
+    int endpoints[3][2][4];
+
+    for (int c = 0; c < 3; c++) {
+        for (int s = 0; s < info.numSubsets; s++) {
+            endpoints[s][0][c] = reader.ReadBits(info.colorBits);
+            endpoints[s][1][c] = reader.ReadBits(info.colorBits);
+        }
+    }
+
+    for (int s = 0; s < info.numSubsets; s++) {
+        endpoints[s][0][3] = reader.ReadBits(info.alphaBits);
+        endpoints[s][1][3] = reader.ReadBits(info.alphaBits);
+    }
+
+    int colorBits = info.colorBits;
+    int alphaBits = info.alphaBits;
+
+    if (info.endpointPBits || info.sharedPBits) {
+        for (int s = 0; s < info.numSubsets; s++) {
+            int p0 = reader.ReadBits(1);
+            int p1 = info.endpointPBits ? reader.ReadBits(1) : p0;
+
+            for (int c = 0; c < 4; c++) {
+                endpoints[s][0][c] = (endpoints[s][0][c] << 1) | p0;
+                endpoints[s][1][c] = (endpoints[s][1][c] << 1) | p1;
+            }
+        }
+        colorBits++;
+        if (alphaBits) {
+            alphaBits++;
+        }
+    }
+
+    for (int s = 0; s < info.numSubsets; s++) {
+        for (int e = 0; e < 2; e++) {
+            for (int c = 0; c < 3; c++) {
+                endpoints[s][e][c] = ExpandBits(endpoints[s][e][c], colorBits);
+            }
+            endpoints[s][e][3] = alphaBits ? ExpandBits(endpoints[s][e][3], alphaBits) : 255;
+        }
+    }
+
+    int indices[16];
+    int indices2[16];
+
+    for (int i = 0; i < 16; i++) {
+        int bits = info.indexBits - (IsAnchorIndex(info.numSubsets, partition, i) ? 1 : 0);
+        indices[i] = reader.ReadBits(bits);
+    }
+
+    if (info.index2Bits) {
+        for (int i = 0; i < 16; i++) {
+            indices2[i] = reader.ReadBits(info.index2Bits - (i == 0 ? 1 : 0));
+        }
+    }
+
+    for (int i = 0; i < 16; i++) {
+        const int (*ep)[4] = endpoints[GetSubsetIndex(info.numSubsets, partition, i)];
+
+        int colorWeight;
+        int alphaWeight;
+
+        if (!info.index2Bits) {
+            colorWeight = alphaWeight = GetWeight(info.indexBits, indices[i]);
+        } else if (!indexSelection) {
+            colorWeight = GetWeight(info.indexBits, indices[i]);
+            alphaWeight = GetWeight(info.index2Bits, indices2[i]);
+        } else {
+            colorWeight = GetWeight(info.index2Bits, indices2[i]);
+            alphaWeight = GetWeight(info.indexBits, indices[i]);
+        }
+
+        byte *dst = &out[i * 4];
+
+        for (int c = 0; c < 3; c++) {
+            dst[c] = (byte)((ep[0][c] * (64 - colorWeight) + ep[1][c] * colorWeight + 32) >> 6);
+        }
+        dst[3] = (byte)((ep[0][3] * (64 - alphaWeight) + ep[1][3] * alphaWeight + 32) >> 6);
+
+        if (rotation) {
+            byte t = dst[3];
+            dst[3] = dst[rotation - 1];
+            dst[rotation - 1] = t;
+        }
+    }
+}
+
+int BPTCDecoder::UnquantizeBC6H(int value, int bits, bool signedFormat) {
+    if (!signedFormat) {
+        if (bits >= 15) {
+            return value;
+        }
+        if (value == 0) {
+            return 0;
+        }
+        if (value == (1 << bits) - 1) {
+            return 0xFFFF;
+        }
+        return ((value << 16) + 0x8000) >> bits;
+    }
+
+    if (bits >= 16) {
+        return value;
+    }
+
+    bool negative = value < 0;
+    if (negative) {
+        value = -value;
+    }
+
+    int unq;
+    if (value == 0) {
+        unq = 0;
+    } else if (value >= (1 << (bits - 1)) - 1) {
+        unq = 0x7FFF;
+    } else {
+        unq = ((value << 15) + 0x4000) >> (bits - 1);
+    }
+    return negative ? -unq : unq;
+}
+
+uint16_t BPTCDecoder::FinishUnquantizeBC6H(int value, bool signedFormat) {
+    if (!signedFormat) {
+        return (uint16_t)((value * 31) >> 6);
+    }
+
+    if (value < 0) {
+        return (uint16_t)(0x8000 | (((-value) * 31) >> 5));
+    }
+    return (uint16_t)((value * 31) >> 5);
+}
+
+void BPTCDecoder::DecodeBC6HBlock(const byte *block, bool signedFormat, uint16_t *out) {
+    BitReader reader(block);
+
+    int modeValue = reader.ReadBits(2);
+    if (modeValue > 1) {
+        modeValue |= reader.ReadBits(3) << 2;
+    }
+
+    const BC6HModeInfo *info = FindBC6HMode(modeValue);
+    if (!info) {
+        // Reserved mode decodes to black.
+        memset(out, 0, 16 * 3 * sizeof(uint16_t));
+        return;
+    }
+
+    int endpoints[4][3];
+    memset(endpoints, 0, sizeof(endpoints));
+
+    for (int i = 0; i < info->numLayoutBits; i++) {
+        int field = info->layout[i] >> 4;
+        int bit = info->layout[i] & 15;
+        endpoints[field / 3][field % 3] |= reader.ReadBits(1) << bit;
+    }
+
+    int partition = info->numRegions == 2 ? reader.ReadBits(5) : 0;
+    int numEndpoints = info->numRegions * 2;
+    int endpointMask = (1 << info->endpointBits) - 1;
+
+    for (int c = 0; c < 3; c++) {
+        if (signedFormat) {
+            endpoints[0][c] = SignExtend(endpoints[0][c], info->endpointBits);
+        }
+
+        for (int e = 1; e < numEndpoints; e++) {
+            if (info->transformed) {
+                int delta = SignExtend(endpoints[e][c], info->deltaBits[c]);
+                endpoints[e][c] = (endpoints[0][c] + delta) & endpointMask;
+            }
+            if (signedFormat) {
+                endpoints[e][c] = SignExtend(endpoints[e][c], info->endpointBits);
+            }
+        }
+    }
+
+    for (int e = 0; e < numEndpoints; e++) {
+        for (int c = 0; c < 3; c++) {
+            endpoints[e][c] = UnquantizeBC6H(endpoints[e][c], info->endpointBits, signedFormat);
+        }
+    }
+
+    int indexBits = info->numRegions == 2 ? 3 : 4;
+
+    for (int i = 0; i < 16; i++) {
+        int bits = indexBits - (IsAnchorIndex(info->numRegions, partition, i) ? 1 : 0);
+        int weight = GetWeight(indexBits, reader.ReadBits(bits));
+
+        const int *e0 = endpoints[GetSubsetIndex(info->numRegions, partition, i) * 2];
+        const int *e1 = e0 + 3;
+
+        for (int c = 0; c < 3; c++) {
+            int value = (e0[c] * (64 - weight) + e1[c] * weight + 32) >> 6;
+            out[i * 3 + c] = FinishUnquantizeBC6H(value, signedFormat);
+        }
+    }
+}
+
+void BPTCDecoder::DecompressImageBC7(const byte *src, const int width, const int height, const int depth, byte *out) {
+    ALIGN_AS32 byte unpackedBlock[64];
+
+    for (int z = 0; z < depth; z++) {
+        byte *dst_z = out + 4 * (width * height * z);
+
+        for (int y = 0; y < height; y += 4) {
+            byte *dstPtr = dst_z + 4 * width * y;
+
+            int dstBlockHeight = Min(4, height - y);
+
+            for (int x = 0; x < width; x += 4, dstPtr += 4 * 4) {
+                DecodeBC7Block(src, unpackedBlock);
+                src += BlockSize;
+
+                byte *srcPtr = unpackedBlock;
+
+                int dstBlockWidth = Min(4, width - x);
+
+                for (int i = 0; i < dstBlockHeight; i++, srcPtr += 4 * 4) {
+                    memcpy(dstPtr + i * 4 * width, srcPtr, dstBlockWidth * 4);
+                }
+            }
+        }
+    }
+}
+
+void BPTCDecoder::DecompressImageBC6H(const byte *src, const int width, const int height, const int depth, bool signedFormat, float *out) {
+    uint16_t unpackedBlock[16 * 3];
+
+    for (int z = 0; z < depth; z++) {
+        float *dst_z = out + 4 * (width * height * z);
+
+        for (int y = 0; y < height; y += 4) {
+            float *dstPtr = dst_z + 4 * width * y;
+
+            int dstBlockHeight = Min(4, height - y);
+
+            for (int x = 0; x < width; x += 4, dstPtr += 4 * 4) {
+                DecodeBC6HBlock(src, signedFormat, unpackedBlock);
+                src += BlockSize;
+
+                int dstBlockWidth = Min(4, width - x);
+
+                for (int by = 0; by < dstBlockHeight; by++) {
+                    float *dstRow = dstPtr + by * 4 * width;
+
+                    for (int bx = 0; bx < dstBlockWidth; bx++) {
+                        const uint16_t *h = &unpackedBlock[(by * 4 + bx) * 3];
+
+                        dstRow[bx * 4 + 0] = F16Converter::ToF32(h[0]);
+                        dstRow[bx * 4 + 1] = F16Converter::ToF32(h[1]);
+                        dstRow[bx * 4 + 2] = F16Converter::ToF32(h[2]);
+                        dstRow[bx * 4 + 3] = 1.0f;
+                    }
+                }
+            }
+        }
+    }
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,1010 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Math/Math.h"
+#include "Image/BptcEncoder.h"
+#include "Image/BptcDecoder.h"
+
+BE_NAMESPACE_BEGIN
+
+struct BC7BlockFit {
+    int                     mode;
+    int                     partition;
+    int                     indexSelection;
+    int                     endpoints[3][2][4];     // quantized endpoints without p-bits
+    int                     pbits[3][2];
+    byte                    indices[16];
+    byte                    indices2[16];
+    int                     error;
+};
+
+struct BC6HBlockFit {
+    const BPTCCodec::BC6HModeInfo *info;
+    int                     partition;
+    int                     endpoints[4][3];        // quantized endpoints before delta transform
+    byte                    indices[16];
+    float                   error;
+};
+
+static BE_INLINE int ExpandBits(int value, int bits) {
+    return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+// Computes mean and unit length principal axis of the points. Returns the variance along the axis.
+static float ComputePrincipalAxis(const float (*points)[4], int count, int numChannels, float *mean, float *axis) {
+    for (int c = 0; c < numChannels; c++) {
+        mean[c] = 0.0f;
+        for (int i = 0; i < count; i++) {
+            mean[c] += points[i][c];
+        }
+        mean[c] /= count;
+    }
+
+    float cov[4][4];
+    memset(cov, 0, sizeof(cov));
+
+    for (int i = 0; i < count; i++) {
+        float d[4];
+        for (int c = 0; c < numChannels; c++) {
+            d[c] = points[i][c] - mean[c];
+        }
+        for (int a = 0; a < numChannels; a++) {
+            for (int b = a; b < numChannels; b++) {
+                cov[a][b] += d[a] * d[b];
+            }
+        }
+    }
+
+    for (int a = 0; a < numChannels; a++) {
+        for (int b = 0; b < a; b++) {
+            cov[a][b] = cov[b][a];
+        }
+    }
+
+    // Start the power iteration from the column of the largest variance.
+    int maxIndex = 0;
+    for (int c = 1; c < numChannels; c++) {
+        if (cov[c][c] > cov[maxIndex][maxIndex]) {
+            maxIndex = c;
+        }
+    }
+
+    for (int c = 0; c < numChannels; c++) {
+        axis[c] = cov[c][maxIndex];
+    }
+
+    for (int iter = 0; iter < 8; iter++) {
+        float v[4];
+        float maxAbs = 0.0f;
+        for (int a = 0; a < numChannels; a++) {
+            v[a] = 0.0f;
+            for (int b = 0; b < numChannels; b++) {
+                v[a] += cov[a][b] * axis[b];
+            }
+            maxAbs = Max(maxAbs, Math::Fabs(v[a]));
+        }
+        if (maxAbs < 1e-12f) {
+            break;
+        }
+        for (int c = 0; c < numChannels; c++) {
+            axis[c] = v[c] / maxAbs;
+        }
+    }
+
+    float lengthSqr = 0.0f;
+    for (int c = 0; c < numChannels; c++) {
+        lengthSqr += axis[c] * axis[c];
+    }
+
+    if (lengthSqr < 1e-12f) {
+        for (int c = 0; c < numChannels; c++) {
+            axis[c] = 0.0f;
+        }
+        return 0.0f;
+    }
+
+    float invLength = 1.0f / Math::Sqrt(lengthSqr);
+    float variance = 0.0f;
+    for (int a = 0; a < numChannels; a++) {
+        axis[a] *= invLength;
+    }
+    for (int a = 0; a < numChannels; a++) {
+        for (int b = 0; b < numChannels; b++) {
+            variance += axis[a] * cov[a][b] * axis[b];
+        }
+    }
+    return variance;
+}
+
+// Computes the extreme points of the points projected onto the principal axis.
+static void ComputeLineEndpoints(const float (*points)[4], int count, int numChannels, float *e0, float *e1) {
+    float mean[4], axis[4];
+    ComputePrincipalAxis(points, count, numChannels, mean, axis);
+
+    float minT = FLT_MAX;
+    float maxT = -FLT_MAX;
+
+    for (int i = 0; i < count; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < numChannels; c++) {
+            t += (points[i][c] - mean[c]) * axis[c];
+        }
+        minT = Min(minT, t);
+        maxT = Max(maxT, t);
+    }
+
+    for (int c = 0; c < numChannels; c++) {
+        e0[c] = mean[c] + minT * axis[c];
+        e1[c] = mean[c] + maxT * axis[c];
+    }
+}
+
+// Returns squared error of the best line fit of the points.
+static float EstimateLineFitError(const float (*points)[4], int count, int numChannels) {
+    if (count <= 1) {
+        return 0.0f;
+    }
+
+    float mean[4], axis[4];
+    float variance = ComputePrincipalAxis(points, count, numChannels, mean, axis);
+
+    float total = 0.0f;
+    for (int i = 0; i < count; i++) {
+        for (int c = 0; c < numChannels; c++) {
+            float d = points[i][c] - mean[c];
+            total += d * d;
+        }
+    }
+    return Max(total - variance, 0.0f);
+}
+
+// Solves endpoints which minimize squared error for the given interpolation weights [0, 1].
+static bool SolveEndpointsLeastSquares(const float (*points)[4], const float *weights, int count, int numChannels, float *e0, float *e1) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = { 0, 0, 0, 0 };
+    float bx[4] = { 0, 0, 0, 0 };
+
+    for (int i = 0; i < count; i++) {
+        float b = weights[i];
+        float a = 1.0f - b;
+
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+
+        for (int c = 0; c < numChannels; c++) {
+            ax[c] += a * points[i][c];
+            bx[c] += b * points[i][c];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (Math::Fabs(det) < 1e-6f) {
+        return false;
+    }
+
+    float invDet = 1.0f / det;
+    for (int c = 0; c < numChannels; c++) {
+        e0[c] = (ax[c] * bb - bx[c] * ab) * invDet;
+        e1[c] = (bx[c] * aa - ax[c] * ab) * invDet;
+    }
+    return true;
+}
+
+// Sorts partitions by the estimated error and returns the best ones.
+static int RankPartitions(const float (*pixels)[4], int numSubsets, int numPartitions, int numChannels, int maxCount, int *bestPartitions) {
+    float errors[64];
+
+    for (int p = 0; p < numPartitions; p++) {
+        errors[p] = 0.0f;
+
+        for (int s = 0; s < numSubsets; s++) {
+            float points[16][4];
+            int count = 0;
+
+            for (int i = 0; i < 16; i++) {
+                if (BPTCCodec::GetSubsetIndex(numSubsets, p, i) == s) {
+                    memcpy(points[count++], pixels[i], sizeof(points[0]));
+                }
+            }
+            errors[p] += EstimateLineFitError(points, count, numChannels);
+        }
+    }
+
+    int numBest = Min(maxCount, numPartitions);
+    for (int k = 0; k < numBest; k++) {
+        int best = -1;
+        for (int p = 0; p < numPartitions; p++) {
+            if (errors[p] >= 0.0f && (best < 0 || errors[p] < errors[best])) {
+                best = p;
+            }
+        }
+        bestPartitions[k] = best;
+        errors[best] = -1.0f;
+    }
+    return numBest;
+}
+
+//--------------------------------------------------------------------------------
+// BC7
+//--------------------------------------------------------------------------------
+
+// Finds the quantized value which reconstructs closest to the given value.
+static int QuantizeBC7(float value, int bits, int pbit) {
+    int totalBits = bits + (pbit >= 0 ? 1 : 0);
+    int maxValue = (1 << bits) - 1;
+
+    int q = (int)(value * ((1 << totalBits) - 1) / 255.0f + 0.5f);
+    if (pbit >= 0) {
+        q >>= 1;
+    }
+
+    int best = 0;
+    int bestError = INT_MAX;
+
+    for (int i = q - 1; i <= q + 1; i++) {
+        if (i < 0 || i > maxValue) {
+            continue;
+        }
+        int recon = ExpandBits(pbit >= 0 ? ((i << 1) | pbit) : i, totalBits);
+        int error = (int)Math::Fabs(recon - value);
+        if (error < bestError) {
+            bestError = error;
+            best = i;
+        }
+    }
+    return best;
+}
+
+static BE_INLINE int DequantizeBC7(int value, int bits, int pbit) {
+    if (pbit >= 0) {
+        return ExpandBits((value << 1) | pbit, bits + 1);
+    }
+    return ExpandBits(value, bits);
+}
+
+// Assigns the closest palette indices to the pixels of the subset and returns the squared error.
+static int AssignBC7Indices(const int (*pixels)[4], const int *pixelList, int count, int firstChannel, int numChannels, const int *e0, const int *e1, int indexBits, byte *indices) {
+    int numIndices = 1 << indexBits;
+    int palette[16][4];
+
+    for (int k = 0; k < numIndices; k++) {
+        int w = BPTCCodec::GetWeight(indexBits, k);
+        for (int c = 0; c < numChannels; c++) {
+            palette[k][c] = (e0[c] * (64 - w) + e1[c] * w + 32) >> 6;
+        }
+    }
+
+    int totalError = 0;
+
+    for (int i = 0; i < count; i++) {
+        const int *p = &pixels[pixelList[i]][firstChannel];
+        int bestError = INT_MAX;
+        int bestIndex = 0;
+
+        for (int k = 0; k < numIndices; k++) {
+            int error = 0;
+            for (int c = 0; c < numChannels; c++) {
+                int d = p[c] - palette[k][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                bestIndex = k;
+            }
+        }
+
+        indices[pixelList[i]] = bestIndex;
+        totalError += bestError;
+    }
+    return totalError;
+}
+
+// Quantizes the float endpoints trying p-bit combinations and returns the smallest squared error.
+static int QuantizeBC7Endpoints(const int (*pixels)[4], const int *pixelList, int count, int firstChannel, int numChannels, const int *channelBits,
+    int pbitType, bool exhaustivePBits, int indexBits, const float *e0f, const float *e1f, int q[2][4], int p[2], byte *indices) {
+    int pbitCombos[4][2] = { { -1, -1 } };
+    int numCombos = 1;
+
+    if (pbitType == 2) {
+        // Shared p-bit
+        pbitCombos[0][0] = pbitCombos[0][1] = 0;
+        pbitCombos[1][0] = pbitCombos[1][1] = 1;
+        numCombos = 2;
+    } else if (pbitType == 1) {
+        if (exhaustivePBits) {
+            for (int i = 0; i < 4; i++) {
+                pbitCombos[i][0] = i & 1;
+                pbitCombos[i][1] = i >> 1;
+            }
+            numCombos = 4;
+        } else {
+            // Choose p-bit of each endpoint independently by quantization error.
+            const float *ef[2] = { e0f, e1f };
+            for (int e = 0; e < 2; e++) {
+                float bestError = FLT_MAX;
+                for (int pbit = 0; pbit < 2; pbit++) {
+                    float error = 0.0f;
+                    for (int c = 0; c < numChannels; c++) {
+                        int bits = channelBits[firstChannel + c];
+                        float d = DequantizeBC7(QuantizeBC7(ef[e][c], bits, pbit), bits, pbit) - ef[e][c];
+                        error += d * d;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        pbitCombos[0][e] = pbit;
+                    }
+                }
+            }
+        }
+    }
+
+    int bestError = INT_MAX;
+    byte tempIndices[16];
+
+    for (int combo = 0; combo < numCombos; combo++) {
+        int tq[2][4], e0[4], e1[4];
+        int p0 = pbitCombos[combo][0];
+        int p1 = pbitCombos[combo][1];
+
+        for (int c = 0; c < numChannels; c++) {
+            int bits = channelBits[firstChannel + c];
+            tq[0][c] = QuantizeBC7(e0f[c], bits, p0);
+            tq[1][c] = QuantizeBC7(e1f[c], bits, p1);
+            e0[c] = DequantizeBC7(tq[0][c], bits, p0);
+            e1[c] = DequantizeBC7(tq[1][c], bits, p1);
+        }
+
+        int error = AssignBC7Indices(pixels, pixelList, count, firstChannel, numChannels, e0, e1, indexBits, tempIndices);
+        if (error < bestError) {
+            bestError = error;
+            for (int c = 0; c < numChannels; c++) {
+                q[0][firstChannel + c] = tq[0][c];
+                q[1][firstChannel + c] = tq[1][c];
+            }
+            p[0] = p0;
+            p[1] = p1;
+            for (int i = 0; i < count; i++) {
+                indices[pixelList[i]] = tempIndices[pixelList[i]];
+            }
+        }
+    }
+    return bestError;
+}
+
+// Fits endpoints of the channels [firstChannel, firstChannel + numChannels) for the pixels of one subset.
+static int FitBC7Subset(const int (*pixels)[4], const int *pixelList, int count, int firstChannel, int numChannels, const int *channelBits,
+    int pbitType, bool exhaustivePBits, int indexBits, int numIterations, int q[2][4], int p[2], byte *indices) {
+    float points[16][4];
+    for (int i = 0; i < count; i++) {
+        for (int c = 0; c < numChannels; c++) {
+            points[i][c] = (float)pixels[pixelList[i]][firstChannel + c];
+        }
+    }
+
+    float e0f[4], e1f[4];
+    ComputeLineEndpoints(points, count, numChannels, e0f, e1f);
+
+    int bestError = INT_MAX;
+
+    for (int iter = 0; ; iter++) {
+        for (int c = 0; c < numChannels; c++) {
+            Clamp(e0f[c], 0.0f, 255.0f);
+            Clamp(e1f[c], 0.0f, 255.0f);
+        }
+
+        int tq[2][4], tp[2];
+        byte tempIndices[16];
+
+        int error = QuantizeBC7Endpoints(pixels, pixelList, count, firstChannel, numChannels, channelBits, pbitType, exhaustivePBits, indexBits, e0f, e1f, tq, tp, tempIndices);
+        if (error < bestError) {
+            bestError = error;
+            for (int c = firstChannel; c < firstChannel + numChannels; c++) {
+                q[0][c] = tq[0][c];
+                q[1][c] = tq[1][c];
+            }
+            p[0] = tp[0];
+            p[1] = tp[1];
+            for (int i = 0; i < count; i++) {
+                indices[pixelList[i]] = tempIndices[pixelList[i]];
+            }
+        }
+
+        if (bestError == 0 || iter >= numIterations) {
+            break;
+        }
+
+        // Refine the unquantized endpoints with the current index assignment.
+        float weights[16];
+        for (int i = 0; i < count; i++) {
+            weights[i] = BPTCCodec::GetWeight(indexBits, tempIndices[pixelList[i]]) / 64.0f;
+        }
+        if (!SolveEndpointsLeastSquares(points, weights, count, numChannels, e0f, e1f)) {
+            break;
+        }
+    }
+    return bestError;
+}
+
+static void SwapBC7Endpoints(BC7BlockFit &fit, int subset, int firstChannel, int numChannels, bool swapPBits) {
+    for (int c = firstChannel; c < firstChannel + numChannels; c++) {
+        int t = fit.endpoints[subset][0][c];
+        fit.endpoints[subset][0][c] = fit.endpoints[subset][1][c];
+        fit.endpoints[subset][1][c] = t;
+    }
+    if (swapPBits) {
+        int t = fit.pbits[subset][0];
+        fit.pbits[subset][0] = fit.pbits[subset][1];
+        fit.pbits[subset][1] = t;
+    }
+}
+
+static void FitBC7Mode(const int (*pixels)[4], int mode, int partition, int indexSelection, bool exhaustivePBits, int numIterations, BC7BlockFit &fit) {
+    const BPTCCodec::BC7ModeInfo &info = BPTCCodec::bc7Modes[mode];
+    const int channelBits[4] = { info.colorBits, info.colorBits, info.colorBits, info.alphaBits };
+    const int pbitType = info.endpointPBits ? 1 : (info.sharedPBits ? 2 : 0);
+
+    fit.mode = mode;
+    fit.partition = partition;
+    fit.indexSelection = indexSelection;
+    fit.error = 0;
+    memset(fit.endpoints, 0, sizeof(fit.endpoints));
+    memset(fit.pbits, 0, sizeof(fit.pbits));
+    memset(fit.indices2, 0, sizeof(fit.indices2));
+
+    for (int s = 0; s < info.numSubsets; s++) {
+        int pixelList[16];
+        int count = 0;
+
+        for (int i = 0; i < 16; i++) {
+            if (BPTCCodec::GetSubsetIndex(info.numSubsets, partition, i) == s) {
+                pixelList[count++] = i;
+            }
+        }
+
+        if (!info.index2Bits) {
+            int numChannels = info.alphaBits ? 4 : 3;
+            fit.error += FitBC7Subset(pixels, pixelList, count, 0, numChannels, channelBits, pbitType, exhaustivePBits, info.indexBits, numIterations,
+                fit.endpoints[s], fit.pbits[s], fit.indices);
+
+            if (!info.alphaBits) {
+                // Alpha always decodes to 255.
+                for (int i = 0; i < count; i++) {
+                    int d = 255 - pixels[pixelList[i]][3];
+                    fit.error += d * d;
+                }
+            }
+        } else {
+            int colorIndexBits = indexSelection ? info.index2Bits : info.indexBits;
+            int alphaIndexBits = indexSelection ? info.indexBits : info.index2Bits;
+            byte *colorIndices = indexSelection ? fit.indices2 : fit.indices;
+            byte *alphaIndices = indexSelection ? fit.indices : fit.indices2;
+
+            fit.error += FitBC7Subset(pixels, pixelList, count, 0, 3, channelBits, 0, false, colorIndexBits, numIterations,
+                fit.endpoints[s], fit.pbits[s], colorIndices);
+            fit.error += FitBC7Subset(pixels, pixelList, count, 3, 1, channelBits, 0, false, alphaIndexBits, numIterations,
+                fit.endpoints[s], fit.pbits[s], alphaIndices);
+        }
+    }
+
+    // The most significant index bit of the anchor pixels is implicitly zero.
+    // Swapping endpoints and inverting indices gives the same result since the weights are symmetric.
+    if (!info.index2Bits) {
+        int maxIndex = (1 << info.indexBits) - 1;
+
+        for (int s = 0; s < info.numSubsets; s++) {
+            int anchor = BPTCCodec::GetAnchorIndex(info.numSubsets, partition, s);
+            if (!(fit.indices[anchor] >> (info.indexBits - 1))) {
+                continue;
+            }
+
+            SwapBC7Endpoints(fit, s, 0, 4, true);
+
+            for (int i = 0; i < 16; i++) {
+                if (BPTCCodec::GetSubsetIndex(info.numSubsets, partition, i) == s) {
+                    fit.indices[i] = maxIndex - fit.indices[i];
+                }
+            }
+        }
+    } else {
+        if (fit.indices[0] >> (info.indexBits - 1)) {
+            if (indexSelection) {
+                SwapBC7Endpoints(fit, 0, 3, 1, false);
+            } else {
+                SwapBC7Endpoints(fit, 0, 0, 3, false);
+            }
+            for (int i = 0; i < 16; i++) {
+                fit.indices[i] = (1 << info.indexBits) - 1 - fit.indices[i];
+            }
+        }
+        if (fit.indices2[0] >> (info.index2Bits - 1)) {
+            if (indexSelection) {
+                SwapBC7Endpoints(fit, 0, 0, 3, false);
+            } else {
+                SwapBC7Endpoints(fit, 0, 3, 1, false);
+            }
+            for (int i = 0; i < 16; i++) {
+                fit.indices2[i] = (1 << info.index2Bits) - 1 - fit.indices2[i];
+            }
+        }
+    }
+}
+
+static void TryBC7Mode(const int (*pixels)[4], int mode, int partition, int indexSelection, bool exhaustivePBits, int numIterations, BC7BlockFit &best) {
+    BC7BlockFit fit;
+    FitBC7Mode(pixels, mode, partition, indexSelection, exhaustivePBits, numIterations, fit);
+    if (fit.error < best.error) {
+        best = fit;
+    }
+}
+
+static void PackBC7Block(const BC7BlockFit &fit, byte *dst) {
+    const BPTCCodec::BC7ModeInfo &info = BPTCCodec::bc7Modes[fit.mode];
+
+    BPTCCodec::BitWriter writer(dst);
+    writer.WriteBits(1 << fit.mode, fit.mode + 1);
+    writer.WriteBits(fit.partition, info.partitionBits);
+    writer.WriteBits(0, info.rotationBits);
+    writer.WriteBits(fit.indexSelection, info.indexSelectionBits);
+
+    for (int c = 0; c < 3; c++) {
+        for (int s = 0; s < info.numSubsets; s++) {
+            writer.WriteBits(fit.endpoints[s][0][c], info.colorBits);
+            writer.WriteBits(fit.endpoints[s][1][c], info.colorBits);
+        }
+    }
+
+    for (int s = 0; s < info.numSubsets; s++) {
+        writer.WriteBits(fit.endpoints[s][0][3], info.alphaBits);
+        writer.WriteBits(fit.endpoints[s][1][3], info.alphaBits);
+    }
+
+    for (int s = 0; s < info.numSubsets; s++) {
+        if (info.endpointPBits) {
+            writer.WriteBits(fit.pbits[s][0], 1);
+            writer.WriteBits(fit.pbits[s][1], 1);
+        } else if (info.sharedPBits) {
+            writer.WriteBits(fit.pbits[s][0], 1);
+        }
+    }
+
+    for (int i = 0; i < 16; i++) {
+        writer.WriteBits(fit.indices[i], info.indexBits - (BPTCCodec::IsAnchorIndex(info.numSubsets, fit.partition, i) ? 1 : 0));
+    }
+
+    if (info.index2Bits) {
+        for (int i = 0; i < 16; i++) {
+            writer.WriteBits(fit.indices2[i], info.index2Bits - (i == 0 ? 1 : 0));
+        }
+    }
+
+    assert(writer.Position() == 128);
+}
+
+void BPTCEncoder::EncodeBC7Block(const byte *colorBlock, Image::CompressionQuality::Enum quality, byte *dst) {
+    int pixels[16][4];
+    float pixelsF[16][4];
+    bool opaque = true;
+
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            pixels[i][c] = colorBlock[i * 4 + c];
+            pixelsF[i][c] = (float)colorBlock[i * 4 + c];
+        }
+        if (pixels[i][3] != 255) {
+            opaque = false;
+        }
+    }
+
+    const bool exhaustivePBits = quality != Image::CompressionQuality::Fast;
+    const int numIterations = quality == Image::CompressionQuality::Fast ? 1 : (quality == Image::CompressionQuality::Normal ? 2 : 3);
+
+    BC7BlockFit best;
+    best.error = INT_MAX;
+
+    TryBC7Mode(pixels, 6, 0, 0, exhaustivePBits, numIterations, best);
+
+    int partitions[64];
+    int numPartitions;
+
+    if (opaque) {
+        if (best.error > 0) {
+            numPartitions = RankPartitions(pixelsF, 2, 64, 3, quality == Image::CompressionQuality::Fast ? 1 : (quality == Image::CompressionQuality::Normal ? 4 : 16), partitions);
+            for (int k = 0; k < numPartitions && best.error > 0; k++) {
+                TryBC7Mode(pixels, 1, partitions[k], 0, exhaustivePBits, numIterations, best);
+                TryBC7Mode(pixels, 3, partitions[k], 0, exhaustivePBits, numIterations, best);
+            }
+        }
+
+        if (best.error > 0 && quality != Image::CompressionQuality::Fast) {
+            int numBest = quality == Image::CompressionQuality::Normal ? 2 : 8;
+
+            numPartitions = RankPartitions(pixelsF, 3, 64, 3, numBest, partitions);
+            for (int k = 0; k < numPartitions && best.error > 0; k++) {
+                TryBC7Mode(pixels, 2, partitions[k], 0, exhaustivePBits, numIterations, best);
+            }
+
+            // Mode 0 can use only the first 16 partitions.
+            numPartitions = RankPartitions(pixelsF, 3, 16, 3, numBest, partitions);
+            for (int k = 0; k < numPartitions && best.error > 0; k++) {
+                TryBC7Mode(pixels, 0, partitions[k], 0, exhaustivePBits, numIterations, best);
+            }
+        }
+    } else {
+        if (best.error > 0) {
+            TryBC7Mode(pixels, 5, 0, 0, exhaustivePBits, numIterations, best);
+        }
+
+        if (best.error > 0 && quality != Image::CompressionQuality::Fast) {
+            TryBC7Mode(pixels, 4, 0, 0, exhaustivePBits, numIterations, best);
+            TryBC7Mode(pixels, 4, 0, 1, exhaustivePBits, numIterations, best);
+
+            numPartitions = RankPartitions(pixelsF, 2, 64, 4, quality == Image::CompressionQuality::Normal ? 4 : 16, partitions);
+            for (int k = 0; k < numPartitions && best.error > 0; k++) {
+                TryBC7Mode(pixels, 7, partitions[k], 0, exhaustivePBits, numIterations, best);
+            }
+        }
+    }
+
+    PackBC7Block(best, dst);
+}
+
+//--------------------------------------------------------------------------------
+// BC6H
+//
+// Pixels are converted to the 16 bits integer space where the interpolation of
+// the decoder happens, so that the half float conversion of the decoder maps
+// them back to the original half floats.
+//--------------------------------------------------------------------------------
+
+static float HalfToBC6HSpace(float value, bool signedFormat) {
+    if (!signedFormat) {
+        int h = F16Converter::FromF32(Max(value, 0.0f));
+        h = Min(h, 0x7BFF);
+        return h * 64.0f / 31.0f;
+    }
+
+    int h = F16Converter::FromF32(value);
+    int magnitude = Min(h & 0x7FFF, 0x7BFF);
+    return ((h & 0x8000) ? -magnitude : magnitude) * 32.0f / 31.0f;
+}
+
+static int QuantizeBC6H(float value, int bits, bool signedFormat) {
+    if (!signedFormat) {
+        int maxValue = (1 << bits) - 1;
+        int q = (int)(value * (1 << bits) / 65536.0f);
+
+        int best = 0;
+        float bestError = FLT_MAX;
+
+        for (int i = q - 1; i <= q + 1; i++) {
+            if (i < 0 || i > maxValue) {
+                continue;
+            }
+            float error = Math::Fabs(BPTCDecoder::UnquantizeBC6H(i, bits, false) - value);
+            if (error < bestError) {
+                bestError = error;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    float magnitude = Math::Fabs(value);
+    int maxValue = (1 << (bits - 1)) - 1;
+    int q = (int)(magnitude * (1 << (bits - 1)) / 32768.0f);
+
+    int best = 0;
+    float bestError = FLT_MAX;
+
+    for (int i = q - 1; i <= q + 1; i++) {
+        if (i < 0 || i > maxValue) {
+            continue;
+        }
+        float error = Math::Fabs(BPTCDecoder::UnquantizeBC6H(i, bits, true) - magnitude);
+        if (error < bestError) {
+            bestError = error;
+            best = i;
+        }
+    }
+    return value < 0 ? -best : best;
+}
+
+// Quantizes the float endpoints with the mode, clamping deltas to the representable range, and assigns indices.
+static void FitBC6HMode(const float (*pixels)[4], const BPTCCodec::BC6HModeInfo *info, int partition, const float (*endpointsF)[4], bool signedFormat, BC6HBlockFit &fit) {
+    int numEndpoints = info->numRegions * 2;
+    int unq[4][3];
+
+    fit.info = info;
+    fit.partition = partition;
+
+    for (int e = 0; e < numEndpoints; e++) {
+        for (int c = 0; c < 3; c++) {
+            fit.endpoints[e][c] = QuantizeBC6H(endpointsF[e][c], info->endpointBits, signedFormat);
+        }
+    }
+
+    if (info->transformed) {
+        for (int e = 1; e < numEndpoints; e++) {
+            for (int c = 0; c < 3; c++) {
+                int range = 1 << (info->deltaBits[c] - 1);
+                int delta = fit.endpoints[e][c] - fit.endpoints[0][c];
+                Clamp(delta, -range, range - 1);
+                fit.endpoints[e][c] = fit.endpoints[0][c] + delta;
+            }
+        }
+    }
+
+    for (int e = 0; e < numEndpoints; e++) {
+        for (int c = 0; c < 3; c++) {
+            unq[e][c] = BPTCDecoder::UnquantizeBC6H(fit.endpoints[e][c], info->endpointBits, signedFormat);
+        }
+    }
+
+    int indexBits = info->numRegions == 2 ? 3 : 4;
+    int numIndices = 1 << indexBits;
+
+    fit.error = 0.0f;
+
+    for (int i = 0; i < 16; i++) {
+        int region = BPTCCodec::GetSubsetIndex(info->numRegions, partition, i);
+        int maxIndex = BPTCCodec::IsAnchorIndex(info->numRegions, partition, i) ? numIndices / 2 : numIndices;
+        const int *e0 = unq[region * 2];
+        const int *e1 = unq[region * 2 + 1];
+
+        float bestError = FLT_MAX;
+        int bestIndex = 0;
+
+        for (int k = 0; k < maxIndex; k++) {
+            int w = BPTCCodec::GetWeight(indexBits, k);
+            float error = 0.0f;
+
+            for (int c = 0; c < 3; c++) {
+                float d = ((e0[c] * (64 - w) + e1[c] * w + 32) >> 6) - pixels[i][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                bestIndex = k;
+            }
+        }
+
+        fit.indices[i] = bestIndex;
+        fit.error += bestError;
+    }
+}
+
+// Fits float endpoints of each region. The anchor pixel is placed at the first endpoint side
+// so that the anchor index is likely to fit in the reduced index bits.
+static void ComputeBC6HEndpoints(const float (*pixels)[4], int numRegions, int partition, bool signedFormat, float (*endpointsF)[4]) {
+    for (int r = 0; r < numRegions; r++) {
+        float points[16][4];
+        int count = 0;
+
+        for (int i = 0; i < 16; i++) {
+            if (BPTCCodec::GetSubsetIndex(numRegions, partition, i) == r) {
+                memcpy(points[count++], pixels[i], sizeof(points[0]));
+            }
+        }
+
+        float *e0 = endpointsF[r * 2];
+        float *e1 = endpointsF[r * 2 + 1];
+        ComputeLineEndpoints(points, count, 3, e0, e1);
+
+        const float *anchor = pixels[BPTCCodec::GetAnchorIndex(numRegions, partition, r)];
+        float d0 = 0.0f, d1 = 0.0f;
+        for (int c = 0; c < 3; c++) {
+            d0 += (anchor[c] - e0[c]) * (anchor[c] - e0[c]);
+            d1 += (anchor[c] - e1[c]) * (anchor[c] - e1[c]);
+        }
+        if (d1 < d0) {
+            for (int c = 0; c < 3; c++) {
+                float t = e0[c];
+                e0[c] = e1[c];
+                e1[c] = t;
+            }
+        }
+
+        float minValue = signedFormat ? -32767.0f : 0.0f;
+        float maxValue = signedFormat ? 32767.0f : 65535.0f;
+        for (int c = 0; c < 3; c++) {
+            Clamp(e0[c], minValue, maxValue);
+            Clamp(e1[c], minValue, maxValue);
+        }
+    }
+}
+
+static void PackBC6HBlock(const BC6HBlockFit &fit, byte *dst) {
+    const BPTCCodec::BC6HModeInfo *info = fit.info;
+    int numEndpoints = info->numRegions * 2;
+    int endpointMask = (1 << info->endpointBits) - 1;
+    int stored[4][3];
+
+    for (int c = 0; c < 3; c++) {
+        stored[0][c] = fit.endpoints[0][c] & endpointMask;
+
+        for (int e = 1; e < numEndpoints; e++) {
+            if (info->transformed) {
+                stored[e][c] = (fit.endpoints[e][c] - fit.endpoints[0][c]) & ((1 << info->deltaBits[c]) - 1);
+            } else {
+                stored[e][c] = fit.endpoints[e][c] & endpointMask;
+            }
+        }
+    }
+
+    BPTCCodec::BitWriter writer(dst);
+    writer.WriteBits(info->modeValue, info->modeBits);
+
+    for (int i = 0; i < info->numLayoutBits; i++) {
+        int field = info->layout[i] >> 4;
+        int bit = info->layout[i] & 15;
+        writer.WriteBits((stored[field / 3][field % 3] >> bit) & 1, 1);
+    }
+
+    if (info->numRegions == 2) {
+        writer.WriteBits(fit.partition, 5);
+    }
+
+    int indexBits = info->numRegions == 2 ? 3 : 4;
+
+    for (int i = 0; i < 16; i++) {
+        writer.WriteBits(fit.indices[i], indexBits - (BPTCCodec::IsAnchorIndex(info->numRegions, fit.partition, i) ? 1 : 0));
+    }
+
+    assert(writer.Position() == 128);
+}
+
+static void TryBC6HModes(const float (*pixels)[4], int numRegions, int partition, const float (*endpointsF)[4], bool signedFormat, BC6HBlockFit &best) {
+    for (int m = 0; m < BPTCCodec::NumBC6HModes; m++) {
+        const BPTCCodec::BC6HModeInfo *info = &BPTCCodec::bc6hModes[m];
+        if (info->numRegions != numRegions) {
+            continue;
+        }
+
+        BC6HBlockFit fit;
+        FitBC6HMode(pixels, info, partition, endpointsF, signedFormat, fit);
+        if (fit.error < best.error) {
+            best = fit;
+        }
+    }
+}
+
+void BPTCEncoder::EncodeBC6HBlock(const float *colorBlock, bool signedFormat, Image::CompressionQuality::Enum quality, byte *dst) {
+    float pixels[16][4];
+
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            pixels[i][c] = HalfToBC6HSpace(colorBlock[i * 4 + c], signedFormat);
+        }
+        pixels[i][3] = 0.0f;
+    }
+
+    BC6HBlockFit best;
+    best.error = FLT_MAX;
+
+    float endpointsF[4][4];
+    ComputeBC6HEndpoints(pixels, 1, 0, signedFormat, endpointsF);
+    TryBC6HModes(pixels, 1, 0, endpointsF, signedFormat, best);
+
+    if (best.error > 0.0f && quality != Image::CompressionQuality::Fast) {
+        int partitions[32];
+        int numPartitions = RankPartitions(pixels, 2, 32, 3, quality == Image::CompressionQuality::Normal ? 2 : 8, partitions);
+
+        for (int k = 0; k < numPartitions; k++) {
+            ComputeBC6HEndpoints(pixels, 2, partitions[k], signedFormat, endpointsF);
+            TryBC6HModes(pixels, 2, partitions[k], endpointsF, signedFormat, best);
+        }
+    }
+
+    // Refine endpoints of the best mode with the index assignment.
+    int numIterations = quality == Image::CompressionQuality::Fast ? 1 : (quality == Image::CompressionQuality::Normal ? 2 : 3);
+    int indexBits = best.info->numRegions == 2 ? 3 : 4;
+
+    for (int iter = 0; iter < numIterations && best.error > 0.0f; iter++) {
+        bool solved = true;
+
+        for (int r = 0; r < best.info->numRegions && solved; r++) {
+            float points[16][4];
+            float weights[16];
+            int count = 0;
+
+            for (int i = 0; i < 16; i++) {
+                if (GetSubsetIndex(best.info->numRegions, best.partition, i) == r) {
+                    memcpy(points[count], pixels[i], sizeof(points[0]));
+                    weights[count++] = GetWeight(indexBits, best.indices[i]) / 64.0f;
+                }
+            }
+
+            solved = SolveEndpointsLeastSquares(points, weights, count, 3, endpointsF[r * 2], endpointsF[r * 2 + 1]);
+
+            float minValue = signedFormat ? -32767.0f : 0.0f;
+            float maxValue = signedFormat ? 32767.0f : 65535.0f;
+            for (int c = 0; c < 3; c++) {
+                Clamp(endpointsF[r * 2][c], minValue, maxValue);
+                Clamp(endpointsF[r * 2 + 1][c], minValue, maxValue);
+            }
+        }
+
+        if (!solved) {
+            break;
+        }
+
+        BC6HBlockFit fit;
+        FitBC6HMode(pixels, best.info, best.partition, endpointsF, signedFormat, fit);
+        if (fit.error >= best.error) {
+            break;
+        }
+        best = fit;
+    }
+
+    PackBC6HBlock(best, dst);
+}
+
+//--------------------------------------------------------------------------------
+// Image
+//--------------------------------------------------------------------------------
+
+template <typename T>
+static BE_INLINE void ExtractBlock(const T *src, int srcPitch, int blockWidth, int blockHeight, T *colorBlock) {
+    for (int by = 0; by < 4; by++) {
+        const T *srcPtrY = src + srcPitch * (by % blockHeight);
+
+        for (int bx = 0; bx < 4; bx++) {
+            const T *srcPtrX = srcPtrY + 4 * (bx % blockWidth);
+
+            for (int i = 0; i < 4; i++) {
+                *colorBlock++ = srcPtrX[i];
+            }
+        }
+    }
+}
+
+void BPTCEncoder::CompressImageBC7(const byte *src, const int width, const int height, const int depth, byte *dst, Image::CompressionQuality::Enum quality) {
+    ALIGN_AS32 byte colorBlock[4 * 16];
+    byte *dstPtr = dst;
+
+    for (int z = 0; z < depth; z++) {
+        for (int y = 0; y < height; y += 4, src += width * 4 * 4) {
+            for (int x = 0; x < width; x += 4, dstPtr += BlockSize) {
+                int bw = Min(4, width - x);
+                int bh = Min(4, height - y);
+
+                ExtractBlock(src + 4 * x, 4 * width, bw, bh, colorBlock);
+
+                EncodeBC7Block(colorBlock, quality, dstPtr);
+            }
+        }
+    }
+}
+
+void BPTCEncoder::CompressImageBC6H(const float *src, const int width, const int height, const int depth, bool signedFormat, byte *dst, Image::CompressionQuality::Enum quality) {
+    ALIGN_AS32 float colorBlock[4 * 16];
+    byte *dstPtr = dst;
+
+    for (int z = 0; z < depth; z++) {
+        for (int y = 0; y < height; y += 4, src += width * 4 * 4) {
+            for (int x = 0; x < width; x += 4, dstPtr += BlockSize) {
+                int bw = Min(4, width - x);
+                int bh = Min(4, height - y);
+
+                ExtractBlock(src + 4 * x, 4 * width, bw, bh, colorBlock);
+
+                EncodeBC6HBlock(colorBlock, signedFormat, quality, dstPtr);
+            }
+        }
+    }
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,568 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/Heap.h"
+#include "Core/JobPool.h"
+#include "Core/ScopeLock.h"
+#include "Containers/Array.h"
+#include "Math/Math.h"
+#include "SIMD/SIMD.h"
+#include "Image/EnvCubePrefilter.h"
+
+BE_NAMESPACE_BEGIN
+
+static constexpr float shConsts[] = { 0.282095f, 0.488603f, 1.092548f, 0.315392f, 0.546274f };
+
+// Returns source image as linear RGBA_32F_32F_32F_32F format.
+// If withMipmaps is true, returned image has full mip chain.
+static const Image *GetLinearFloatImage(const Image &srcImage, bool withMipmaps, Image &tempImage) {
+    bool hasFullMipmaps = srcImage.NumMipmaps() == Image::MaxMipMapLevels(srcImage.GetWidth(), srcImage.GetHeight(), 1);
+
+    if (srcImage.GetFormat() == Image::Format::RGBA_32F_32F_32F_32F &&
+        srcImage.GetGammaSpace() == Image::GammaSpace::Linear && (!withMipmaps || hasFullMipmaps)) {
+        return &srcImage;
+    }
+
+    srcImage.ConvertFormat(Image::Format::RGBA_32F_32F_32F_32F, tempImage, Image::GammaSpace::Linear, withMipmaps && !hasFullMipmaps);
+    return &tempImage;
+}
+
+// Returns trilinear filtered sample with the given cubemap coordinates.
+static Color3 SampleCubeLod(const Image &cubeImage, const Vec3 &dir, float lod) {
+    Clamp(lod, 0.0f, (float)(cubeImage.NumMipmaps() - 1));
+
+    int level0 = (int)lod;
+    float frac = lod - level0;
+
+    Color4 color = cubeImage.SampleCube(dir, Image::SampleFilter::Bilinear, level0);
+    if (frac > 0.0f && level0 + 1 < cubeImage.NumMipmaps()) {
+        color = Math::Lerp(color, cubeImage.SampleCube(dir, Image::SampleFilter::Bilinear, level0 + 1), frac);
+    }
+    return color.ToColor3();
+}
+
+// Builds local frame matrix to transform tangent space direction vector to local space direction vector.
+static void GetLocalFrame(const Vec3 &tangentZ, Vec3 &tangentX, Vec3 &tangentY) {
+    tangentY = Math::Fabs(tangentZ.z) < 0.999f ? Vec3::unitZ : Vec3::unitX;
+    tangentX = tangentY.Cross(tangentZ);
+    tangentX.Normalize();
+    tangentY = tangentZ.Cross(tangentX);
+}
+
+// Returns importance sampled halfway direction for GGX specular NDF with respect to N.
+static Vec3 ImportanceSampleGGX(float xi0, float xi1, float linearRoughness) {
+    float cosTheta2 = xi0 / (linearRoughness * linearRoughness * (1.0f - xi0) + xi0);
+    float cosTheta = Math::Sqrt(cosTheta2);
+    float sinTheta = Math::Sqrt(1.0f - cosTheta2);
+    float s, c;
+    Math::SinCos(Math::TwoPi * xi1, s, c);
+
+    return Vec3(sinTheta * c, sinTheta * s, cosTheta);
+}
+
+static float D_GGX(float NdotH, float linearRoughness) {
+    float a2 = linearRoughness * linearRoughness;
+    float denom = NdotH * NdotH * (a2 - 1.0f) + 1.0f;
+    return a2 * Math::InvPi / (denom * denom + 1e-7f);
+}
+
+static float G_SchlickGGX(float NdotV, float NdotL, float k) {
+    float oneMinusK = 1.0f - k;
+    return 0.25f / ((NdotV * oneMinusK + k) * (NdotL * oneMinusK + k));
+}
+
+//-------------------------------------------------------------------------------
+// SH projection
+//-------------------------------------------------------------------------------
+
+struct SHProjectTask {
+    const Image *           radianceImage;
+    const float *           solidAngles;
+    int                     faceIndex;
+    Color3                  shCoeffs[EnvCubePrefilter::NumSHCoeffs];
+};
+
+static void SHProjectFaceTask(void *data) {
+    SHProjectTask *task = (SHProjectTask *)data;
+
+    const int size = task->radianceImage->GetWidth();
+    const float invSize = 1.0f / size;
+    const Color4 *src = (const Color4 *)task->radianceImage->GetPixels(0, task->faceIndex);
+
+#if defined(ENABLE_SIMD4_INTRIN)
+    simd4f acc[EnvCubePrefilter::NumSHCoeffs][3];
+    for (int i = 0; i < EnvCubePrefilter::NumSHCoeffs; i++) {
+        acc[i][0] = acc[i][1] = acc[i][2] = setzero_ps();
+    }
+
+    ALIGN_AS16 float dx[4], dy[4], dz[4], wr[4], wg[4], wb[4];
+
+    for (int y = 0; y < size; y++) {
+        float t = (y + 0.5f) * invSize;
+
+        for (int x = 0; x < size; x += 4) {
+            // Gathers 4 texels. Out of range lanes have zero weight.
+            for (int i = 0; i < 4; i++) {
+                if (x + i < size) {
+                    Vec3 dir = Image::FaceToCubeMapCoords((Image::CubeMapFace::Enum)task->faceIndex, (x + i + 0.5f) * invSize, t);
+                    dir.Normalize();
+
+                    const Color4 &radiance = src[y * size + x + i];
+                    float dw = task->solidAngles[y * size + x + i];
+
+                    // SH basis functions are evaluated with mirrored x and y axis. (ref. SphericalHarmonics::EvalBasis)
+                    dx[i] = -dir.x;
+                    dy[i] = -dir.y;
+                    dz[i] = dir.z;
+                    wr[i] = radiance.r * dw;
+                    wg[i] = radiance.g * dw;
+                    wb[i] = radiance.b * dw;
+                } else {
+                    dx[i] = dy[i] = dz[i] = 0.0f;
+                    wr[i] = wg[i] = wb[i] = 0.0f;
+                }
+            }
+
+            simd4f vx = load_ps(dx);
+            simd4f vy = load_ps(dy);
+            simd4f vz = load_ps(dz);
+
+            simd4f basis[EnvCubePrefilter::NumSHCoeffs];
+            basis[0] = set1_ps(shConsts[0]);
+            basis[1] = vy * shConsts[1];
+            basis[2] = vz * shConsts[1];
+            basis[3] = vx * shConsts[1];
+            basis[4] = vx * vy * shConsts[2];
+            basis[5] = vy * vz * shConsts[2];
+            basis[6] = msub_ps(vz * vz, set1_ps(3.0f), set1_ps(1.0f)) * shConsts[3];
+            basis[7] = vx * vz * shConsts[2];
+            basis[8] = msub_ps(vx, vx, vy * vy) * shConsts[4];
+
+            simd4f vr = load_ps(wr);
+            simd4f vg = load_ps(wg);
+            simd4f vb = load_ps(wb);
+
+            for (int i = 0; i < EnvCubePrefilter::NumSHCoeffs; i++) {
+                acc[i][0] = madd_ps(basis[i], vr, acc[i][0]);
+                acc[i][1] = madd_ps(basis[i], vg, acc[i][1]);
+                acc[i][2] = madd_ps(basis[i], vb, acc[i][2]);
+            }
+        }
+    }
+
+    for (int i = 0; i < EnvCubePrefilter::NumSHCoeffs; i++) {
+        task->shCoeffs[i].Set(x_ps(sum_ps(acc[i][0])), x_ps(sum_ps(acc[i][1])), x_ps(sum_ps(acc[i][2])));
+    }
+#else
+    for (int i = 0; i < EnvCubePrefilter::NumSHCoeffs; i++) {
+        task->shCoeffs[i] = Color3::zero;
+    }
+
+    float basisEval[16];
+
+    for (int y = 0; y < size; y++) {
+        float t = (y + 0.5f) * invSize;
+
+        for (int x = 0; x < size; x++) {
+            Vec3 dir = Image::FaceToCubeMapCoords((Image::CubeMapFace::Enum)task->faceIndex, (x + 0.5f) * invSize, t);
+            dir.Normalize();
+
+            SphericalHarmonics::EvalBasis(3, dir, basisEval);
+
+            Color3 radiance = src[y * size + x].ToColor3() * task->solidAngles[y * size + x];
+
+            for (int i = 0; i < EnvCubePrefilter::NumSHCoeffs; i++) {
+                task->shCoeffs[i] += radiance * basisEval[i];
+            }
+        }
+    }
+#endif
+}
+
+void EnvCubePrefilter::ProjectSH(const Image &envCubeImage, Color3 shCoeffs[NumSHCoeffs]) {
+    assert(envCubeImage.IsCubeMap());
+
+    Image tempImage;
+    const Image *radianceImage = GetLinearFloatImage(envCubeImage, false, tempImage);
+
+    int size = radianceImage->GetWidth();
+
+    // Solid angles of the texels are same for all faces.
+    float *solidAngles = (float *)Mem_Alloc16(size * size * sizeof(float));
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            solidAngles[y * size + x] = Image::CubeMapTexelSolidAngle(x, y, size);
+        }
+    }
+
+    Array<SHProjectTask> tasks;
+    tasks.SetCount(6);
+
+    for (int faceIndex = 0; faceIndex < 6; faceIndex++) {
+        tasks[faceIndex].radianceImage = radianceImage;
+        tasks[faceIndex].solidAngles = solidAngles;
+        tasks[faceIndex].faceIndex = faceIndex;
+    }
+
+    jobPool.Run(SHProjectFaceTask, tasks);
+
+    Mem_AlignedFree(solidAngles);
+
+    // Sums up in fixed order to get deterministic results.
+    for (int i = 0; i < NumSHCoeffs; i++) {
+        shCoeffs[i] = Color3::zero;
+        for (int faceIndex = 0; faceIndex < 6; faceIndex++) {
+            shCoeffs[i] += tasks[faceIndex].shCoeffs[i];
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------
+// SH convolution
+//-------------------------------------------------------------------------------
+
+struct SHConvolveTask {
+    const Color3 *          shCoeffs;
+    const float *           lambertCoeffs;
+    Image *                 targetImage;
+    int                     faceIndex;
+};
+
+static void SHConvolveFaceTask(void *data) {
+    const SHConvolveTask *task = (const SHConvolveTask *)data;
+
+    const int size = task->targetImage->GetWidth();
+    const float invSize = 1.0f / size;
+    Color3 *dst = (Color3 *)task->targetImage->GetPixels(0, task->faceIndex);
+
+    float basisEval[16];
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            Vec3 dir = Image::FaceToCubeMapCoords((Image::CubeMapFace::Enum)task->faceIndex, (x + 0.5f) * invSize, (y + 0.5f) * invSize);
+            dir.Normalize();
+
+            SphericalHarmonics::EvalBasis(3, dir, basisEval);
+
+            Color3 color = task->shCoeffs[0] * (task->lambertCoeffs[0] * basisEval[0]);
+            for (int i = 1; i < 4; i++) {
+                color += task->shCoeffs[i] * (task->lambertCoeffs[1] * basisEval[i]);
+            }
+            for (int i = 4; i < 9; i++) {
+                color += task->shCoeffs[i] * (task->lambertCoeffs[2] * basisEval[i]);
+            }
+
+            dst[y * size + x] = color;
+        }
+    }
+}
+
+void EnvCubePrefilter::GenerateSHConvolvIrradianceEnvCube(const Image &envCubeImage, int size, Image &irradianceEnvCubeImage) {
+    Color3 shCoeffs[NumSHCoeffs];
+    ProjectSH(envCubeImage, shCoeffs);
+
+    // Precompute ZH coefficients * sqrt(4PI/(2l + 1)) of Lambert diffuse spherical function cos(theta) / PI
+    // which function is rotationally symmetric so only 3 terms are needed.
+    float al[3];
+    al[0] = SphericalHarmonics::Lambert_Al_Evaluator(0); // 1
+    al[1] = SphericalHarmonics::Lambert_Al_Evaluator(1); // 2/3
+    al[2] = SphericalHarmonics::Lambert_Al_Evaluator(2); // 1/4
+
+    irradianceEnvCubeImage.CreateCube(size, 1, Image::Format::RGB_32F_32F_32F, Image::GammaSpace::Linear, nullptr, 0);
+
+    Array<SHConvolveTask> tasks;
+    tasks.SetCount(6);
+
+    for (int faceIndex = 0; faceIndex < 6; faceIndex++) {
+        tasks[faceIndex].shCoeffs = shCoeffs;
+        tasks[faceIndex].lambertCoeffs = al;
+        tasks[faceIndex].targetImage = &irradianceEnvCubeImage;
+        tasks[faceIndex].faceIndex = faceIndex;
+    }
+
+    jobPool.Run(SHConvolveFaceTask, tasks);
+}
+
+//-------------------------------------------------------------------------------
+// GGX LD sum
+//-------------------------------------------------------------------------------
+
+// Importance sample which is independent of the normal direction since we assume V = N.
+struct GGXLDSample {
+    Vec3                    localL;         ///< Light direction in tangent space
+    float                   NdotL;
+    float                   mipLevel;       ///< Source mip level to reduce the variance
+};
+
+struct GGXLDSumTask {
+    const Image *           radianceImage;
+    const Array<GGXLDSample> *samples;      ///< nullptr for the mirror reflection
+    Image *                 targetImage;
+    int                     mipLevel;
+    int                     faceIndex;
+    int                     firstRow;
+    int                     numRows;
+};
+
+static void GGXLDSumRowsTask(void *data) {
+    const GGXLDSumTask *task = (const GGXLDSumTask *)data;
+
+    const int size = task->targetImage->GetWidth(task->mipLevel);
+    const float invSize = 1.0f / size;
+    Color3 *dst = (Color3 *)task->targetImage->GetPixels(task->mipLevel, task->faceIndex);
+
+    // Source mip level which has same resolution with the target mip level for the mirror reflection.
+    float mirrorMipLevel = Max(Math::Log(2.0f, (float)task->radianceImage->GetWidth() / size), 0.0f);
+
+    for (int y = task->firstRow; y < task->firstRow + task->numRows; y++) {
+        for (int x = 0; x < size; x++) {
+            Vec3 N = Image::FaceToCubeMapCoords((Image::CubeMapFace::Enum)task->faceIndex, (x + 0.5f) * invSize, (y + 0.5f) * invSize);
+            N.Normalize();
+
+            if (!task->samples) {
+                // We can skip complex calculation for perfect specular mirror.
+                dst[y * size + x] = SampleCubeLod(*task->radianceImage, N, mirrorMipLevel);
+                continue;
+            }
+
+            Vec3 tangentX, tangentY;
+            GetLocalFrame(N, tangentX, tangentY);
+
+            Color3 color = Color3::zero;
+            float totalWeights = 0.0f;
+
+            for (int i = 0; i < task->samples->Count(); i++) {
+                const GGXLDSample &sample = (*task->samples)[i];
+
+                Vec3 L = tangentX * sample.localL.x + tangentY * sample.localL.y + N * sample.localL.z;
+
+                color += SampleCubeLod(*task->radianceImage, L, sample.mipLevel) * sample.NdotL;
+
+                // We have found weighting by cos(theta) achieves better results.
+                totalWeights += sample.NdotL;
+            }
+
+            dst[y * size + x] = color / totalWeights;
+        }
+    }
+}
+
+// Same sample distribution with IntegrateLD() in IBL.glsl.
+static void BuildGGXLDSamples(float linearRoughness, int radianceSize, Array<GGXLDSample> &samples) {
+    const float inc = 1.0f / 32.0f;
+    const float sampleCount = 32.0f * 32.0f;
+
+    // Solid angle associated to a pixel of the cubemap.
+    const float invOmegaP = (6.0f * radianceSize * radianceSize) / (4.0f * Math::Pi);
+
+    samples.Clear();
+
+    for (float y = 0.0f; y < 1.0f; y += inc) {
+        for (float x = 0.0f; x < 1.0f; x += inc) {
+            Vec3 H = ImportanceSampleGGX(x, y, linearRoughness);
+
+            // V = N = (0, 0, 1) in tangent space.
+            Vec3 L = 2.0f * H.z * H - Vec3::unitZ;
+
+            if (L.z <= 0.0f) {
+                continue;
+            }
+
+            // N == V and then NdotH == VdotH.
+            // PDF(L) = D * NdotH / (4 * VdotH) = D / 4
+            float pdf = D_GGX(Max(H.z, 0.0f), linearRoughness) / 4.0f;
+
+            // Solid angle associated to a sample.
+            float omegaS = 1.0f / (sampleCount * pdf);
+
+            GGXLDSample &sample = samples.Alloc();
+            sample.localL = L;
+            sample.NdotL = L.z;
+            sample.mipLevel = 0.5f * Math::Log(2.0f, omegaS * invOmegaP) + 1.0f;
+        }
+    }
+}
+
+void EnvCubePrefilter::GenerateGGXLDSumCube(const Image &envCubeImage, int size, Image &ldSumCubeImage) {
+    assert(envCubeImage.IsCubeMap());
+
+    // Mipmaps of the source are used for the filtered importance sampling.
+    Image tempImage;
+    const Image *radianceImage = GetLinearFloatImage(envCubeImage, true, tempImage);
+
+    int numMipLevels = Math::ILog2(size) + 1;
+
+    ldSumCubeImage.CreateCube(size, numMipLevels, Image::Format::RGB_32F_32F_32F, Image::GammaSpace::Linear, nullptr, 0);
+
+    Array<Array<GGXLDSample>> samplesPerLevel;
+    samplesPerLevel.SetCount(numMipLevels);
+
+    Array<GGXLDSumTask> tasks;
+
+    for (int mipLevel = 0; mipLevel < numMipLevels; mipLevel++) {
+        if (mipLevel > 0) {
+            float roughness = (float)mipLevel / (numMipLevels - 1);
+            BuildGGXLDSamples(roughness * roughness, radianceImage->GetWidth(), samplesPerLevel[mipLevel]);
+        }
+
+        int mipSize = ldSumCubeImage.GetWidth(mipLevel);
+        // Splits each faces into row blocks to distribute the work evenly among the task threads.
+        int rowsPerTask = Max(mipSize / 8, 1);
+
+        for (int faceIndex = 0; faceIndex < 6; faceIndex++) {
+            for (int y = 0; y < mipSize; y += rowsPerTask) {
+                GGXLDSumTask &task = tasks.Alloc();
+                task.radianceImage = radianceImage;
+                task.samples = mipLevel > 0 ? &samplesPerLevel[mipLevel] : nullptr;
+                task.targetImage = &ldSumCubeImage;
+                task.mipLevel = mipLevel;
+                task.faceIndex = faceIndex;
+                task.firstRow = y;
+                task.numRows = Min(rowsPerTask, mipSize - y);
+            }
+        }
+    }
+
+    jobPool.Run(GGXLDSumRowsTask, tasks);
+}
+
+//-------------------------------------------------------------------------------
+// GGX DFG sum
+//-------------------------------------------------------------------------------
+
+// Same with IntegrateDFG() in IBL.glsl.
+static void IntegrateDFG(float NdotV, float roughness, float &A, float &B) {
+    // theta = cos^-1(NdotV), phi = 0
+    Vec3 V;
+    V.x = Math::Sqrt(1.0f - NdotV * NdotV); // sin(theta) cos(phi)
+    V.y = 0.0f; // sin(theta) sin(phi)
+    V.z = NdotV; // cos(theta)
+
+    A = 0.0f;
+    B = 0.0f;
+
+    float numSamples = 0.0f;
+
+    float linearRoughness = roughness * roughness;
+
+    float k = linearRoughness * 0.5f; // k for IBL
+
+    for (float y = 0.0f; y < 1.0f; y += 0.01f) {
+        for (float x = 0.0f; x < 1.0f; x += 0.01f) {
+            // N = (0, 0, 1) so tangent space is same as local space.
+            Vec3 H = ImportanceSampleGGX(x, y, linearRoughness);
+            Vec3 L = 2.0f * V.Dot(H) * H - V;
+            L.Normalize();
+
+            float NdotL = Max(L.z, 0.0f);
+
+            if (NdotL > 0.0f) {
+                float NdotH = Max(H.z, 0.0f);
+                float VdotH = Max(V.Dot(H), 0.0f);
+
+                float G = G_SchlickGGX(NdotV, NdotL, k);
+                float G_Vis = 4.0f * G * NdotL * VdotH / NdotH;
+
+                float Fc = Math::Pow(1.0f - VdotH, 5.0f);
+
+                A += (1.0f - Fc) * G_Vis;
+                B += Fc * G_Vis;
+            }
+
+            numSamples += 1.0f;
+        }
+    }
+
+    A /= numSamples;
+    B /= numSamples;
+}
+
+struct DFGSumTask {
+    Image *                 targetImage;
+    int                     row;
+};
+
+static void DFGSumRowTask(void *data) {
+    const DFGSumTask *task = (const DFGSumTask *)data;
+
+    const int size = task->targetImage->GetWidth();
+    float *dst = (float *)task->targetImage->GetPixels() + task->row * size * 2;
+
+    float roughness = (task->row + 0.5f) / size;
+
+    for (int x = 0; x < size; x++) {
+        float NdotV = (x + 0.5f) / size;
+
+        IntegrateDFG(NdotV, roughness, dst[x * 2], dst[x * 2 + 1]);
+    }
+}
+
+void EnvCubePrefilter::GenerateGGXDFGSumImage(int size, Image &integrationImage) {
+    Image floatImage;
+    floatImage.Create2D(size, size, 1, Image::Format::RG_32F_32F, Image::GammaSpace::Linear, nullptr, 0);
+
+    Array<DFGSumTask> tasks;
+    tasks.SetCount(size);
+
+    for (int y = 0; y < size; y++) {
+        tasks[y].targetImage = &floatImage;
+        tasks[y].row = y;
+    }
+
+    jobPool.Run(DFGSumRowTask, tasks);
+
+    floatImage.ConvertFormat(Image::Format::RG_16F_16F, integrationImage);
+}
+
+struct CachedDFGSumImage {
+    int                     size;
+    Image *                 image;
+};
+
+static Array<CachedDFGSumImage> cachedDFGSumImages;
+
+static PlatformMutex *GetDFGSumCacheMutex() {
+    static PlatformMutex *mutex = (PlatformMutex *)PlatformMutex::Create();
+    return mutex;
+}
+
+const Image &EnvCubePrefilter::GetGGXDFGSumImage(int size) {
+    ScopeLock lock(GetDFGSumCacheMutex());
+
+    for (int i = 0; i < cachedDFGSumImages.Count(); i++) {
+        if (cachedDFGSumImages[i].size == size) {
+            return *cachedDFGSumImages[i].image;
+        }
+    }
+
+    CachedDFGSumImage &cached = cachedDFGSumImages.Alloc();
+    cached.size = size;
+    cached.image = new Image;
+
+    GenerateGGXDFGSumImage(size, *cached.image);
+
+    return *cached.image;
+}
+
+void EnvCubePrefilter::FreeCachedGGXDFGSumImages() {
+    ScopeLock lock(GetDFGSumCacheMutex());
+
+    for (int i = 0; i < cachedDFGSumImages.Count(); i++) {
+        delete cachedDFGSumImages[i].image;
+    }
+    cachedDFGSumImages.Clear();
+}
+
+BE_NAMESPACE_END
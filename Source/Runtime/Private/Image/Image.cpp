@@ -331,9 +331,11 @@ void Image::Clear() {
     }
 }
 
-Color4 Image::Sample2DNearest(const byte *src, const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWrapMode::Enum wrapModeT) const {
+Color4 Image::Sample2DNearest(const byte *src, int level, const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWrapMode::Enum wrapModeT) const {
     const ImageFormatInfo *formatInfo = GetImageFormatInfo(format);
 
+    int width = GetWidth(level);
+    int height = GetHeight(level);
     int bpp = BytesPerPixel();
     int pitch = width * bpp;
 
@@ -350,9 +352,11 @@ Color4 Image::Sample2DNearest(const byte *src, const Vec2 &st, SampleWrapMode::E
     return outputColor;
 }
 
-Color4 Image::Sample2DBilinear(const byte *src, const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWrapMode::Enum wrapModeT) const {
+Color4 Image::Sample2DBilinear(const byte *src, int level, const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWrapMode::Enum wrapModeT) const {
     const ImageFormatInfo *formatInfo = GetImageFormatInfo(format);
 
+    int width = GetWidth(level);
+    int height = GetHeight(level);
     int bpp = BytesPerPixel();
     int pitch = width * bpp;
 
@@ -418,9 +422,9 @@ Color4 Image::Sample2D(const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWra
     const byte *src = GetPixels(level);
 
     if (filter == SampleFilter::Nearest) {
-        outputColor = Sample2DNearest(src, st, wrapModeS, wrapModeT);
+        outputColor = Sample2DNearest(src, level, st, wrapModeS, wrapModeT);
     } else if (filter == SampleFilter::Bilinear) {
-        outputColor = Sample2DBilinear(src, st, wrapModeS, wrapModeT);
+        outputColor = Sample2DBilinear(src, level, st, wrapModeS, wrapModeT);
     }
 
     return outputColor;
@@ -436,15 +440,13 @@ Color4 Image::SampleCube(const Vec3 &str, SampleFilter::Enum filter, int level)
 
     Vec2 st;
     CubeMapFace::Enum cubeMapFace = CubeMapToFaceCoords(str, st[0], st[1]);
-    st[0] *= width;
-    st[1] *= height;
 
     const byte *src = GetPixels(level, cubeMapFace);
 
     if (filter == SampleFilter::Nearest) {
-        outputColor = Sample2DNearest(src, st, SampleWrapMode::Clamp, SampleWrapMode::Clamp);
+        outputColor = Sample2DNearest(src, level, st, SampleWrapMode::Clamp, SampleWrapMode::Clamp);
     } else if (filter == SampleFilter::Bilinear) {
-        outputColor = Sample2DBilinear(src, st, SampleWrapMode::Clamp, SampleWrapMode::Clamp);
+        outputColor = Sample2DBilinear(src, level, st, SampleWrapMode::Clamp, SampleWrapMode::Clamp);
     }
 
     return outputColor;
@@ -610,6 +612,21 @@ bool Image::HasAlpha(Image::Format::Enum imageFormat) {
         case Format::RGBA_8_8_ETC2:
         case Format::RGBA_EA_ATC:
         case Format::RGBA_IA_ATC:
+        case Format::RGBA_BC7:
+        case Format::RGBA_ASTC_4x4:
+        case Format::RGBA_ASTC_5x4:
+        case Format::RGBA_ASTC_5x5:
+        case Format::RGBA_ASTC_6x5:
+        case Format::RGBA_ASTC_6x6:
+        case Format::RGBA_ASTC_8x5:
+        case Format::RGBA_ASTC_8x6:
+        case Format::RGBA_ASTC_8x8:
+        case Format::RGBA_ASTC_10x5:
+        case Format::RGBA_ASTC_10x6:
+        case Format::RGBA_ASTC_10x8:
+        case Format::RGBA_ASTC_10x10:
+        case Format::RGBA_ASTC_12x10:
+        case Format::RGBA_ASTC_12x12:
             return true;
         default:
             return false;
@@ -686,8 +703,9 @@ int Image::MemRequired(int width, int height, int depth, int numMipmaps, Image::
             int minWidth, minHeight;
             CompressedFormatBlockDimensions(imageFormat, blockWidth, blockHeight);
             CompressedFormatMinDimensions(imageFormat, minWidth, minHeight);
-            int w2 = w + ((unsigned int)(-w) % minWidth);
-            int h2 = h + ((unsigned int)(-h) % minHeight);
+            // Rounds up to the multiple of the minimum dimensions which are not always power of two (ASTC).
+            int w2 = ((w + minWidth - 1) / minWidth) * minWidth;
+            int h2 = ((h + minHeight - 1) / minHeight) * minHeight;
             size += (w2 * h2 * d) / (blockWidth * blockHeight);
         } else {
             size += w * h * d;
@@ -0,0 +1,52 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Image/Image.h"
+#include "Image/AstcEncoder.h"
+#include "ImageInternal.h"
+
+BE_NAMESPACE_BEGIN
+
+struct ASTCCompressParams {
+    Image::CompressionQuality::Enum compressionQuality;
+    int                     blockWidth;
+    int                     blockHeight;
+};
+
+static void CompressBlocksASTC(const byte *src, int width, int height, int depth, byte *dst, const void *param) {
+    const ASTCCompressParams *params = (const ASTCCompressParams *)param;
+
+    ASTCEncoder::CompressImageASTC(src, params->blockWidth, params->blockHeight, width, height, depth, dst, params->compressionQuality);
+}
+
+void CompressASTC(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality) {
+    assert(srcImage.GetFormat() == Image::Format::RGBA_8_8_8_8 || srcImage.GetFormat() == Image::Format::RGBA_32F_32F_32F_32F);
+
+    Image tempImage;
+    const Image *src = &srcImage;
+
+    if (srcImage.GetFormat() != Image::Format::RGBA_8_8_8_8) {
+        srcImage.ConvertFormat(Image::Format::RGBA_8_8_8_8, tempImage);
+        src = &tempImage;
+    }
+
+    ASTCCompressParams params;
+    params.compressionQuality = compressionQuality;
+    CompressedFormatBlockDimensions(dstImage.GetFormat(), params.blockWidth, params.blockHeight);
+
+    ParallelCompressImage(*src, dstImage, CompressBlocksASTC, &params);
+}
+
+BE_NAMESPACE_END
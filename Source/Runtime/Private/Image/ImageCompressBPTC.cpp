@@ -0,0 +1,61 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Image/Image.h"
+#include "Image/BptcEncoder.h"
+#include "ImageInternal.h"
+
+BE_NAMESPACE_BEGIN
+
+struct BC6HCompressParams {
+    Image::CompressionQuality::Enum compressionQuality;
+    bool                    signedFormat;
+};
+
+static void CompressBlocksBC6H(const byte *src, int width, int height, int depth, byte *dst, const void *param) {
+    const BC6HCompressParams *params = (const BC6HCompressParams *)param;
+
+    BPTCEncoder::CompressImageBC6H((const float *)src, width, height, depth, params->signedFormat, dst, params->compressionQuality);
+}
+
+static void CompressBlocksBC7(const byte *src, int width, int height, int depth, byte *dst, const void *param) {
+    BPTCEncoder::CompressImageBC7(src, width, height, depth, dst, *(const Image::CompressionQuality::Enum *)param);
+}
+
+void CompressBC6H(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality, bool signedFormat) {
+    assert(srcImage.GetFormat() == Image::Format::RGBA_32F_32F_32F_32F);
+
+    BC6HCompressParams params;
+    params.compressionQuality = compressionQuality;
+    params.signedFormat = signedFormat;
+
+    ParallelCompressImage(srcImage, dstImage, CompressBlocksBC6H, &params);
+}
+
+void CompressBC7(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality) {
+    assert(srcImage.GetFormat() == Image::Format::RGBA_8_8_8_8 || srcImage.GetFormat() == Image::Format::RGBA_32F_32F_32F_32F);
+
+    Image tempImage;
+    const Image *src = &srcImage;
+
+    if (srcImage.GetFormat() != Image::Format::RGBA_8_8_8_8) {
+        srcImage.ConvertFormat(Image::Format::RGBA_8_8_8_8, tempImage);
+        src = &tempImage;
+    }
+
+    ParallelCompressImage(*src, dstImage, CompressBlocksBC7, &compressionQuality);
+}
+
+BE_NAMESPACE_END
@@ -15,6 +15,8 @@
 #include "Precompiled.h"
 #include "Core/Str.h"
 #include "Core/Heap.h"
+#include "Core/JobPool.h"
+#include "Containers/Array.h"
 #include "Math/Math.h"
 #include "Image/Image.h"
 #include "ImageInternal.h"
@@ -77,6 +79,31 @@ static bool DecompressImage(const Image &srcImage, Image &dstImage) {
         // Consider SignedRG_11_11_EAC format image as normal values.
         DecompressEAC_RG11(srcImage, dstImage, true, true);
         break;
+    case Image::Format::RGB_BC6H_UF16:
+        DecompressBC6H(srcImage, dstImage, false);
+        break;
+    case Image::Format::RGB_BC6H_SF16:
+        DecompressBC6H(srcImage, dstImage, true);
+        break;
+    case Image::Format::RGBA_BC7:
+        DecompressBC7(srcImage, dstImage);
+        break;
+    case Image::Format::RGBA_ASTC_4x4:
+    case Image::Format::RGBA_ASTC_5x4:
+    case Image::Format::RGBA_ASTC_5x5:
+    case Image::Format::RGBA_ASTC_6x5:
+    case Image::Format::RGBA_ASTC_6x6:
+    case Image::Format::RGBA_ASTC_8x5:
+    case Image::Format::RGBA_ASTC_8x6:
+    case Image::Format::RGBA_ASTC_8x8:
+    case Image::Format::RGBA_ASTC_10x5:
+    case Image::Format::RGBA_ASTC_10x6:
+    case Image::Format::RGBA_ASTC_10x8:
+    case Image::Format::RGBA_ASTC_10x10:
+    case Image::Format::RGBA_ASTC_12x10:
+    case Image::Format::RGBA_ASTC_12x12:
+        DecompressASTC(srcImage, dstImage);
+        break;
     default:
         BE_WARNLOG("DecompressImage: unsupported format %s\n", srcImage.FormatName());
         return false;
@@ -127,6 +154,31 @@ static bool CompressImage(const Image &srcImage, Image &dstImage, Image::Compres
     case Image::Format::SignedRG_11_11_EAC:
         CompressEAC_Signed_RG11(srcImage, dstImage, compressionQuality);
         break;
+    case Image::Format::RGB_BC6H_UF16:
+        CompressBC6H(srcImage, dstImage, compressionQuality, false);
+        break;
+    case Image::Format::RGB_BC6H_SF16:
+        CompressBC6H(srcImage, dstImage, compressionQuality, true);
+        break;
+    case Image::Format::RGBA_BC7:
+        CompressBC7(srcImage, dstImage, compressionQuality);
+        break;
+    case Image::Format::RGBA_ASTC_4x4:
+    case Image::Format::RGBA_ASTC_5x4:
+    case Image::Format::RGBA_ASTC_5x5:
+    case Image::Format::RGBA_ASTC_6x5:
+    case Image::Format::RGBA_ASTC_6x6:
+    case Image::Format::RGBA_ASTC_8x5:
+    case Image::Format::RGBA_ASTC_8x6:
+    case Image::Format::RGBA_ASTC_8x8:
+    case Image::Format::RGBA_ASTC_10x5:
+    case Image::Format::RGBA_ASTC_10x6:
+    case Image::Format::RGBA_ASTC_10x8:
+    case Image::Format::RGBA_ASTC_10x10:
+    case Image::Format::RGBA_ASTC_12x10:
+    case Image::Format::RGBA_ASTC_12x12:
+        CompressASTC(srcImage, dstImage, compressionQuality);
+        break;
     default:
         BE_WARNLOG("CompressImage: unsupported format %s\n", dstImage.FormatName());
         return false;
@@ -138,6 +190,67 @@ static bool CompressImage(const Image &srcImage, Image &dstImage, Image::Compres
     return true;
 }
 
+struct CompressBandTask {
+    CompressBlocksFunc      compressFunc;
+    const void *            param;
+    const byte *            src;
+    int                     width;
+    int                     height;
+    byte *                  dst;
+};
+
+static void CompressBand(void *data) {
+    const CompressBandTask *task = (const CompressBandTask *)data;
+
+    task->compressFunc(task->src, task->width, task->height, 1, task->dst, task->param);
+}
+
+void ParallelCompressImage(const Image &srcImage, Image &dstImage, CompressBlocksFunc compressFunc, const void *param) {
+    // Number of block rows per task.
+    static const int blockRowsPerBand = 8;
+
+    int blockWidth, blockHeight;
+    CompressedFormatBlockDimensions(dstImage.GetFormat(), blockWidth, blockHeight);
+
+    const int bytesPerPixel = srcImage.BytesPerPixel();
+    const int bytesPerBlock = dstImage.BytesPerBlock();
+
+    Array<CompressBandTask> tasks;
+
+    for (int mipLevel = 0; mipLevel < srcImage.NumMipmaps(); mipLevel++) {
+        int w = srcImage.GetWidth(mipLevel);
+        int h = srcImage.GetHeight(mipLevel);
+        int d = srcImage.GetDepth(mipLevel);
+
+        int numBlocksX = (w + blockWidth - 1) / blockWidth;
+        int numBlocksY = (h + blockHeight - 1) / blockHeight;
+
+        for (int sliceIndex = 0; sliceIndex < srcImage.NumSlices(); sliceIndex++) {
+            const byte *src = srcImage.GetPixels(mipLevel, sliceIndex);
+            byte *dst = dstImage.GetPixels(mipLevel, sliceIndex);
+
+            for (int z = 0; z < d; z++) {
+                const byte *src_z = src + w * h * z * bytesPerPixel;
+                byte *dst_z = dst + numBlocksX * numBlocksY * z * bytesPerBlock;
+
+                for (int blockY = 0; blockY < numBlocksY; blockY += blockRowsPerBand) {
+                    int y = blockY * blockHeight;
+
+                    CompressBandTask &task = tasks.Alloc();
+                    task.compressFunc = compressFunc;
+                    task.param = param;
+                    task.src = src_z + w * y * bytesPerPixel;
+                    task.width = w;
+                    task.height = Min(blockRowsPerBand * blockHeight, h - y);
+                    task.dst = dst_z + numBlocksX * blockY * bytesPerBlock;
+                }
+            }
+        }
+    }
+
+    jobPool.Run(CompressBand, tasks);
+}
+
 static void SRGBToLinear(float *data, int count) {
     float *dataPtr = data;
     float *dataEnd = data + count;
@@ -28,12 +28,16 @@ bool Image::Load(const char *filename) {
 
     Str name = filename;
 
+    if (name.CheckExtension(".png") || name.CheckExtension(".jpg")) {
+        return LoadFromFileStream(name, 0);
+    }
+
     byte *data;
     size_t size = fileSystem.LoadFile(name, true, (void **)&data);
     if (data) {
         // Call image loading function by cheking file extension.
         if (name.CheckExtension(".btex")) {
-            //LoadBTexFromMemory(name, data, size);
+            LoadBTexFromMemory(name, data, size);
         } else if (name.CheckExtension(".dds")) {
             LoadDDSFromMemory(name, data, size);
         } else if (name.CheckExtension(".pvr")) {
@@ -98,6 +102,57 @@ bool Image::Load(const char *filename) {
     return false;
 }
 
+bool Image::LoadFromFileStream(const char *filename, int maxSize) {
+    Str name = filename;
+
+    File *fp = fileSystem.OpenFileRead(name, true);
+    if (!fp) {
+        return false;
+    }
+
+    bool ret = false;
+    if (name.CheckExtension(".png")) {
+        ret = LoadPNGFromFile(name, fp, maxSize);
+    } else if (name.CheckExtension(".jpg")) {
+        ret = LoadJPGFromFile(name, fp, maxSize);
+    }
+
+    fileSystem.CloseFile(fp);
+
+    return ret;
+}
+
+bool Image::LoadThumbnail(const char *filename, int maxSize) {
+    if (!filename || filename[0] == 0) {
+        return false;
+    }
+
+    Str name = filename;
+
+    if (name.CheckExtension(".png") || name.CheckExtension(".jpg")) {
+        return LoadFromFileStream(name, maxSize);
+    }
+
+    // Other formats are loaded in full size and then resized.
+    if (!Load(filename)) {
+        return false;
+    }
+
+    int size = Max(width, height);
+    if (maxSize <= 0 || size <= maxSize) {
+        return true;
+    }
+
+    if (IsCompressed() && !ConvertFormatSelf(NeedFloatConversion() ? Format::RGBA_32F_32F_32F_32F : Format::RGBA_8_8_8_8)) {
+        return false;
+    }
+
+    int dstWidth = Max(width * maxSize / size, 1);
+    int dstHeight = Max(height * maxSize / size, 1);
+
+    return ResizeSelf(dstWidth, dstHeight, ResampleFilter::Bilinear);
+}
+
 bool Image::Write(const char *filename) const {
     if (!filename || filename[0] == 0) {
         return false;
@@ -110,7 +165,9 @@ bool Image::Write(const char *filename) const {
     Str extension;
     name.ExtractFileExtension(extension);
 
-    if (!extension.Icmp("dds")) {
+    if (!extension.Icmp("btex")) {
+        ret = WriteBTex(filename);
+    } else if (!extension.Icmp("dds")) {
         ret = WriteDDS(filename);
     } else if (!extension.Icmp("pvr")) {
         ret = WritePVR(filename);
@@ -0,0 +1,132 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "Precompiled.h"
+#include "Core/Heap.h"
+#include "SIMD/SIMD.h"
+#include "Math/Math.h"
+#include "IO/FileSystem.h"
+#include "Image/Image.h"
+#include "ImageInternal.h"
+
+BE_NAMESPACE_BEGIN
+
+// Engine native texture container.
+// Header is followed by the raw pixel data of all mip levels in the same layout as Image::pic.
+// Format is stored as Image::Format::Enum value, so bump the version whenever the enum is reordered.
+
+#define BTEX_MAGIC                  (('X'<<24) + ('E'<<16) + ('T'<<8) + ('B'))
+#define BTEX_VERSION                1
+
+struct BTexFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t numSlices;
+    uint32_t numMipmaps;
+    uint32_t format;
+    uint32_t gammaSpace;
+    uint32_t flags;
+    uint32_t dataSize;
+};
+
+bool Image::LoadBTexFromMemory(const char *name, const byte *data, size_t size) {
+    if (size < sizeof(BTexFileHeader)) {
+        BE_WARNLOG("Image::LoadBTexFromMemory: file is too small %s\n", name);
+        return false;
+    }
+
+    const BTexFileHeader *header = (const BTexFileHeader *)data;
+
+    if (header->magic != BTEX_MAGIC) {
+        BE_WARNLOG("Image::LoadBTexFromMemory: bad BTex format %s\n", name);
+        return false;
+    }
+
+    if (header->version != BTEX_VERSION) {
+        BE_WARNLOG("Image::LoadBTexFromMemory: unsupported version %i %s\n", header->version, name);
+        return false;
+    }
+
+    if (header->format <= Format::Unknown || header->format >= Format::Count) {
+        BE_WARNLOG("Image::LoadBTexFromMemory: Unsupported pixel format %s\n", name);
+        return false;
+    }
+
+    if (header->width == 0 || header->height == 0) {
+        BE_WARNLOG("Image::LoadBTexFromMemory: invalid image size %s\n", name);
+        return false;
+    }
+
+    const Format::Enum imageFormat = (Format::Enum)header->format;
+    const int imageDepth = Max((int)header->depth, 1);
+    const int imageNumSlices = Max((int)header->numSlices, 1);
+    const int imageNumMipmaps = Max((int)header->numMipmaps, 1);
+
+    // Validates the data size before any member is changed.
+    int64_t bufSize = (int64_t)MemRequired(header->width, header->height, imageDepth, imageNumMipmaps, imageFormat) * imageNumSlices;
+    if (bufSize <= 0 || bufSize > INT_MAX || header->dataSize != bufSize || size - sizeof(BTexFileHeader) < (size_t)bufSize) {
+        BE_WARNLOG("Image::LoadBTexFromMemory: data size mismatch %s\n", name);
+        return false;
+    }
+
+    this->width = header->width;
+    this->height = header->height;
+    this->depth = imageDepth;
+    this->numSlices = imageNumSlices;
+    this->numMipmaps = imageNumMipmaps;
+    this->format = imageFormat;
+    this->gammaSpace = (GammaSpace::Enum)header->gammaSpace;
+    this->flags = header->flags;
+
+    this->pic = (byte *)Mem_Alloc16((int)bufSize);
+    this->alloced = true;
+
+    simdProcessor->Memcpy(this->pic, data + sizeof(BTexFileHeader), (int)bufSize);
+
+    return true;
+}
+
+bool Image::WriteBTex(const char *filename) const {
+    File *fp = fileSystem.OpenFile(filename, File::Mode::Write);
+    if (!fp) {
+        BE_WARNLOG("Image::WriteBTex: file open error\n");
+        return false;
+    }
+
+    BTexFileHeader header;
+    header.magic = BTEX_MAGIC;
+    header.version = BTEX_VERSION;
+    header.width = width;
+    header.height = height;
+    header.depth = depth;
+    header.numSlices = numSlices;
+    header.numMipmaps = numMipmaps;
+    header.format = format;
+    header.gammaSpace = gammaSpace;
+    header.flags = flags;
+    header.dataSize = GetSize(0, numMipmaps);
+
+    fp->Write(&header, sizeof(header));
+    fp->Write(pic, header.dataSize);
+
+    fileSystem.CloseFile(fp);
+
+    return true;
+}
+
+BE_NAMESPACE_END
@@ -285,7 +285,49 @@ enum DX10_FORMAT {
     DX10_FORMAT_IA44 = 112,
     DX10_FORMAT_P8 = 113,
     DX10_FORMAT_A8P8 = 114,
-    DX10_FORMAT_B4G4R4A4_UNORM = 115
+    DX10_FORMAT_B4G4R4A4_UNORM = 115,
+    DX10_FORMAT_ASTC_4X4_TYPELESS = 133,
+    DX10_FORMAT_ASTC_4X4_UNORM = 134,
+    DX10_FORMAT_ASTC_4X4_UNORM_SRGB = 135,
+    DX10_FORMAT_ASTC_5X4_TYPELESS = 137,
+    DX10_FORMAT_ASTC_5X4_UNORM = 138,
+    DX10_FORMAT_ASTC_5X4_UNORM_SRGB = 139,
+    DX10_FORMAT_ASTC_5X5_TYPELESS = 141,
+    DX10_FORMAT_ASTC_5X5_UNORM = 142,
+    DX10_FORMAT_ASTC_5X5_UNORM_SRGB = 143,
+    DX10_FORMAT_ASTC_6X5_TYPELESS = 145,
+    DX10_FORMAT_ASTC_6X5_UNORM = 146,
+    DX10_FORMAT_ASTC_6X5_UNORM_SRGB = 147,
+    DX10_FORMAT_ASTC_6X6_TYPELESS = 149,
+    DX10_FORMAT_ASTC_6X6_UNORM = 150,
+    DX10_FORMAT_ASTC_6X6_UNORM_SRGB = 151,
+    DX10_FORMAT_ASTC_8X5_TYPELESS = 153,
+    DX10_FORMAT_ASTC_8X5_UNORM = 154,
+    DX10_FORMAT_ASTC_8X5_UNORM_SRGB = 155,
+    DX10_FORMAT_ASTC_8X6_TYPELESS = 157,
+    DX10_FORMAT_ASTC_8X6_UNORM = 158,
+    DX10_FORMAT_ASTC_8X6_UNORM_SRGB = 159,
+    DX10_FORMAT_ASTC_8X8_TYPELESS = 161,
+    DX10_FORMAT_ASTC_8X8_UNORM = 162,
+    DX10_FORMAT_ASTC_8X8_UNORM_SRGB = 163,
+    DX10_FORMAT_ASTC_10X5_TYPELESS = 165,
+    DX10_FORMAT_ASTC_10X5_UNORM = 166,
+    DX10_FORMAT_ASTC_10X5_UNORM_SRGB = 167,
+    DX10_FORMAT_ASTC_10X6_TYPELESS = 169,
+    DX10_FORMAT_ASTC_10X6_UNORM = 170,
+    DX10_FORMAT_ASTC_10X6_UNORM_SRGB = 171,
+    DX10_FORMAT_ASTC_10X8_TYPELESS = 173,
+    DX10_FORMAT_ASTC_10X8_UNORM = 174,
+    DX10_FORMAT_ASTC_10X8_UNORM_SRGB = 175,
+    DX10_FORMAT_ASTC_10X10_TYPELESS = 177,
+    DX10_FORMAT_ASTC_10X10_UNORM = 178,
+    DX10_FORMAT_ASTC_10X10_UNORM_SRGB = 179,
+    DX10_FORMAT_ASTC_12X10_TYPELESS = 181,
+    DX10_FORMAT_ASTC_12X10_UNORM = 182,
+    DX10_FORMAT_ASTC_12X10_UNORM_SRGB = 183,
+    DX10_FORMAT_ASTC_12X12_TYPELESS = 185,
+    DX10_FORMAT_ASTC_12X12_UNORM = 186,
+    DX10_FORMAT_ASTC_12X12_UNORM_SRGB = 187
 };
 
 struct DdsFileHeader {
@@ -373,6 +415,23 @@ bool Image::LoadDDSFromMemory(const char *name, const byte *data, size_t size) {
         case DX10_FORMAT_BC3_UNORM: format = Format::DXT5; break;
         case DX10_FORMAT_BC4_UNORM: format = Format::DXN1; break;
         case DX10_FORMAT_BC5_UNORM: format = Format::DXN2; break;
+        case DX10_FORMAT_BC6H_UF16: format = Format::RGB_BC6H_UF16; break;
+        case DX10_FORMAT_BC6H_SF16: format = Format::RGB_BC6H_SF16; break;
+        case DX10_FORMAT_BC7_UNORM: case DX10_FORMAT_BC7_UNORM_SRGB: format = Format::RGBA_BC7; break;
+        case DX10_FORMAT_ASTC_4X4_UNORM: case DX10_FORMAT_ASTC_4X4_UNORM_SRGB: format = Format::RGBA_ASTC_4x4; break;
+        case DX10_FORMAT_ASTC_5X4_UNORM: case DX10_FORMAT_ASTC_5X4_UNORM_SRGB: format = Format::RGBA_ASTC_5x4; break;
+        case DX10_FORMAT_ASTC_5X5_UNORM: case DX10_FORMAT_ASTC_5X5_UNORM_SRGB: format = Format::RGBA_ASTC_5x5; break;
+        case DX10_FORMAT_ASTC_6X5_UNORM: case DX10_FORMAT_ASTC_6X5_UNORM_SRGB: format = Format::RGBA_ASTC_6x5; break;
+        case DX10_FORMAT_ASTC_6X6_UNORM: case DX10_FORMAT_ASTC_6X6_UNORM_SRGB: format = Format::RGBA_ASTC_6x6; break;
+        case DX10_FORMAT_ASTC_8X5_UNORM: case DX10_FORMAT_ASTC_8X5_UNORM_SRGB: format = Format::RGBA_ASTC_8x5; break;
+        case DX10_FORMAT_ASTC_8X6_UNORM: case DX10_FORMAT_ASTC_8X6_UNORM_SRGB: format = Format::RGBA_ASTC_8x6; break;
+        case DX10_FORMAT_ASTC_8X8_UNORM: case DX10_FORMAT_ASTC_8X8_UNORM_SRGB: format = Format::RGBA_ASTC_8x8; break;
+        case DX10_FORMAT_ASTC_10X5_UNORM: case DX10_FORMAT_ASTC_10X5_UNORM_SRGB: format = Format::RGBA_ASTC_10x5; break;
+        case DX10_FORMAT_ASTC_10X6_UNORM: case DX10_FORMAT_ASTC_10X6_UNORM_SRGB: format = Format::RGBA_ASTC_10x6; break;
+        case DX10_FORMAT_ASTC_10X8_UNORM: case DX10_FORMAT_ASTC_10X8_UNORM_SRGB: format = Format::RGBA_ASTC_10x8; break;
+        case DX10_FORMAT_ASTC_10X10_UNORM: case DX10_FORMAT_ASTC_10X10_UNORM_SRGB: format = Format::RGBA_ASTC_10x10; break;
+        case DX10_FORMAT_ASTC_12X10_UNORM: case DX10_FORMAT_ASTC_12X10_UNORM_SRGB: format = Format::RGBA_ASTC_12x10; break;
+        case DX10_FORMAT_ASTC_12X12_UNORM: case DX10_FORMAT_ASTC_12X12_UNORM_SRGB: format = Format::RGBA_ASTC_12x12; break;
         default:
             BE_WARNLOG("Image::LoadDDSFromMemory: Unsupported pixel format %s\n", name);
             return false;
@@ -955,6 +1014,91 @@ bool Image::WriteDDS(const char *filename) const {
         header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
         dx10Header.dxgiFormat = DX10_FORMAT_R11G11B10_FLOAT;
         break;
+    case Format::RGB_BC6H_UF16:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = DX10_FORMAT_BC6H_UF16;
+        break;
+    case Format::RGB_BC6H_SF16:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = DX10_FORMAT_BC6H_SF16;
+        break;
+    case Format::RGBA_BC7:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_BC7_UNORM_SRGB : DX10_FORMAT_BC7_UNORM;
+        break;
+    case Format::RGBA_ASTC_4x4:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_4X4_UNORM_SRGB : DX10_FORMAT_ASTC_4X4_UNORM;
+        break;
+    case Format::RGBA_ASTC_5x4:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_5X4_UNORM_SRGB : DX10_FORMAT_ASTC_5X4_UNORM;
+        break;
+    case Format::RGBA_ASTC_5x5:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_5X5_UNORM_SRGB : DX10_FORMAT_ASTC_5X5_UNORM;
+        break;
+    case Format::RGBA_ASTC_6x5:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_6X5_UNORM_SRGB : DX10_FORMAT_ASTC_6X5_UNORM;
+        break;
+    case Format::RGBA_ASTC_6x6:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_6X6_UNORM_SRGB : DX10_FORMAT_ASTC_6X6_UNORM;
+        break;
+    case Format::RGBA_ASTC_8x5:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_8X5_UNORM_SRGB : DX10_FORMAT_ASTC_8X5_UNORM;
+        break;
+    case Format::RGBA_ASTC_8x6:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_8X6_UNORM_SRGB : DX10_FORMAT_ASTC_8X6_UNORM;
+        break;
+    case Format::RGBA_ASTC_8x8:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_8X8_UNORM_SRGB : DX10_FORMAT_ASTC_8X8_UNORM;
+        break;
+    case Format::RGBA_ASTC_10x5:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_10X5_UNORM_SRGB : DX10_FORMAT_ASTC_10X5_UNORM;
+        break;
+    case Format::RGBA_ASTC_10x6:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_10X6_UNORM_SRGB : DX10_FORMAT_ASTC_10X6_UNORM;
+        break;
+    case Format::RGBA_ASTC_10x8:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_10X8_UNORM_SRGB : DX10_FORMAT_ASTC_10X8_UNORM;
+        break;
+    case Format::RGBA_ASTC_10x10:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_10X10_UNORM_SRGB : DX10_FORMAT_ASTC_10X10_UNORM;
+        break;
+    case Format::RGBA_ASTC_12x10:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_12X10_UNORM_SRGB : DX10_FORMAT_ASTC_12X10_UNORM;
+        break;
+    case Format::RGBA_ASTC_12x12:
+        header.ddsPixelFormat.flags = DDSPF_FOURCC;
+        header.ddsPixelFormat.fourCC = MAKE_FOURCC('D', 'X', '1', '0');
+        dx10Header.dxgiFormat = gammaSpace == GammaSpace::sRGB ? DX10_FORMAT_ASTC_12X12_UNORM_SRGB : DX10_FORMAT_ASTC_12X12_UNORM;
+        break;
     default:
         fileSystem.CloseFile(fp);
         BE_WARNLOG("Image::WriteDDS: invalid format '%s' for DDS\n", Image::FormatName(format));
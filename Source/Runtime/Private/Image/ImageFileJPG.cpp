@@ -18,6 +18,7 @@
 #include "Image/Image.h"
 #include "ImageInternal.h"
 #include "libjpeg/jpeglib.h"
+#include "libjpeg/jerror.h"
 #include <setjmp.h>
 
 BE_NAMESPACE_BEGIN
@@ -216,6 +217,170 @@ bool Image::LoadJPGFromMemory(const char *name, const byte *data, size_t size) {
 }
 
 
+/*
+ * Data source manager which pulls the compressed data from the File in chunks.
+ */
+
+struct FileSourceMgr {
+  struct jpeg_source_mgr pub;
+  ImageFileReader *reader;
+  JOCTET eoiBuffer[2];
+};
+
+METHODDEF(void)
+file_init_source (j_decompress_ptr cinfo)
+{
+}
+
+METHODDEF(boolean)
+file_fill_input_buffer (j_decompress_ptr cinfo)
+{
+  FileSourceMgr *src = (FileSourceMgr *) cinfo->src;
+  size_t size;
+  const byte *data = src->reader->Fill(&size);
+
+  if (!data) {
+    /* Insert a fake EOI marker like the stdio source manager does */
+    WARNMS(cinfo, JWRN_JPEG_EOF);
+    src->eoiBuffer[0] = (JOCTET) 0xFF;
+    src->eoiBuffer[1] = (JOCTET) JPEG_EOI;
+    data = src->eoiBuffer;
+    size = 2;
+  }
+
+  src->pub.next_input_byte = data;
+  src->pub.bytes_in_buffer = size;
+  return TRUE;
+}
+
+METHODDEF(void)
+file_skip_input_data (j_decompress_ptr cinfo, long num_bytes)
+{
+  struct jpeg_source_mgr *src = cinfo->src;
+
+  if (num_bytes > 0) {
+    while (num_bytes > (long) src->bytes_in_buffer) {
+      num_bytes -= (long) src->bytes_in_buffer;
+      (void) (*src->fill_input_buffer) (cinfo);
+    }
+    src->next_input_byte += (size_t) num_bytes;
+    src->bytes_in_buffer -= (size_t) num_bytes;
+  }
+}
+
+METHODDEF(void)
+file_term_source (j_decompress_ptr cinfo)
+{
+}
+
+static void jpeg_file_src (j_decompress_ptr cinfo, FileSourceMgr *src, ImageFileReader *reader)
+{
+  src->pub.init_source = file_init_source;
+  src->pub.fill_input_buffer = file_fill_input_buffer;
+  src->pub.skip_input_data = file_skip_input_data;
+  src->pub.resync_to_restart = jpeg_resync_to_restart; /* use default method */
+  src->pub.term_source = file_term_source;
+  src->pub.bytes_in_buffer = 0;
+  src->pub.next_input_byte = nullptr;
+  src->reader = reader;
+  cinfo->src = &src->pub;
+}
+
+/*
+ * Streaming decompression which reads the file in chunks and writes the scanlines straight into the image.
+ * If maxSize is given, the image is scaled down by the DCT scaling of libjpeg first,
+ * and then box filtered to fit in maxSize x maxSize.
+ */
+
+bool Image::LoadJPGFromFile(const char *name, File *fp, int maxSize) {
+  struct jpeg_decompress_struct cinfo;
+  struct my_error_mgr jerr;
+  FileSourceMgr fileSrc;
+  ImageFileReader reader(fp);
+  ImageRowDownsampler downsampler;
+  JSAMPARRAY buffer;
+  int row_stride;
+
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = my_error_exit;
+  if (setjmp(jerr.setjmp_buffer)) {
+    jpeg_destroy_decompress(&cinfo);
+    Clear();
+    return false;
+  }
+  jpeg_create_decompress(&cinfo);
+
+  jpeg_file_src(&cinfo, &fileSrc, &reader);
+
+  (void) jpeg_read_header(&cinfo, TRUE);
+
+  int factor = ImageRowDownsampler::ComputeFactor(cinfo.image_width, cinfo.image_height, maxSize);
+  if (factor > 1) {
+    /* libjpeg scales by 1/2, 1/4 and 1/8 while doing IDCT, which is far cheaper than filtering the full size rows */
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = factor >= 8 ? 8 : (factor >= 4 ? 4 : (factor >= 2 ? 2 : 1));
+  }
+
+  (void) jpeg_start_decompress(&cinfo);
+
+  if (cinfo.output_components != 1 && cinfo.output_components != 2 && cinfo.output_components != 3 && cinfo.output_components != 4) {
+      BE_WARNLOG("Image::LoadJPGFromFile: bad JPG format %s (channels %i)\n", name, cinfo.out_color_components);
+      jpeg_destroy_decompress(&cinfo);
+      return false;
+  }
+
+  row_stride = cinfo.output_width * cinfo.output_components;
+
+  Image::Format::Enum imageFormat;
+  switch (cinfo.output_components) {
+  case 1:
+    imageFormat = Format::L_8;
+    break;
+  case 2:
+    imageFormat = Format::RG_8_8;
+    break;
+  case 3:
+    imageFormat = Format::RGB_8_8_8;
+    break;
+  case 4:
+    imageFormat = Format::RGBX_8_8_8_8;
+    break;
+  }
+
+  /* remaining factor after the DCT scaling */
+  factor = ImageRowDownsampler::ComputeFactor(cinfo.output_width, cinfo.output_height, maxSize);
+
+  if (factor == 1) {
+    Create2D(cinfo.output_width, cinfo.output_height, 1, imageFormat, GammaSpace::sRGB, nullptr, 0);
+
+    byte *ptr = this->pic;
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+      JSAMPROW row = ptr;
+      (void) jpeg_read_scanlines(&cinfo, &row, 1);
+      ptr += row_stride;
+    }
+  } else {
+    Create2D((cinfo.output_width + factor - 1) / factor, (cinfo.output_height + factor - 1) / factor, 1, imageFormat, GammaSpace::sRGB, nullptr, 0);
+    downsampler.Init(cinfo.output_width, cinfo.output_height, cinfo.output_components, factor, this->pic);
+
+    /* Make a one-row-high sample array that will go away when done with image */
+    buffer = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE, row_stride, 1);
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+      (void) jpeg_read_scanlines(&cinfo, buffer, 1);
+      downsampler.AddRow(buffer[0]);
+    }
+  }
+
+  (void) jpeg_finish_decompress(&cinfo);
+
+  jpeg_destroy_decompress(&cinfo);
+
+  return true;
+}
+
+
 /*
  * IMAGE DATA FORMATS:
  *
@@ -117,6 +117,120 @@ bool Image::LoadPNGFromMemory(const char *name, const byte *data, size_t size) {
     return true;
 }
 
+static void png_read_file(png_structp png, png_bytep data, png_size_t length) {
+    ImageFileReader *reader = (ImageFileReader *)png->io_ptr;
+    if (reader->Read(data, length) != length) {
+        png_error(png, "unexpected end of file");
+    }
+}
+
+bool Image::LoadPNGFromFile(const char *name, File *fp, int maxSize) {
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if (!png) {
+        return false;
+    }
+
+    png_infop info = png_create_info_struct(png);
+    if (!info) {
+        png_destroy_read_struct(&png, (png_infopp)nullptr, (png_infopp)nullptr);
+        return false;
+    }
+
+    // Objects which are used after the longjmp should be declared before the setjmp.
+    ImageFileReader reader(fp);
+    ImageRowDownsampler downsampler;
+    byte *volatile rowBuffer = nullptr;
+
+    if (setjmp(png_jmpbuf(png))) {
+        ImageScratchPool::Free(rowBuffer);
+        png_destroy_read_struct(&png, &info, (png_infopp)nullptr);
+        Clear();
+        BE_WARNLOG("Image::LoadPNGFromFile: failed to decode %s\n", name);
+        return false;
+    }
+
+    png_set_read_fn(png, &reader, png_read_file);
+
+    png_read_info(png, info);
+
+    int bit_depth;
+    int color_type;
+    int interlace_type;
+    png_uint_32 w;
+    png_uint_32 h;
+    png_get_IHDR(png, info, &w, &h, &bit_depth, &color_type, &interlace_type, nullptr, nullptr);
+
+    // same transforms with LoadPNGFromMemory
+    png_set_strip_16(png);
+
+    if (color_type & PNG_COLOR_MASK_PALETTE) {
+        png_set_expand(png);
+    }
+
+    if (!(color_type & PNG_COLOR_MASK_COLOR)) {
+        png_set_gray_to_rgb(png);
+    }
+
+    if (bit_depth < 8) {
+        png_set_packing(png);
+    }
+
+    int numPasses = png_set_interlace_handling(png);
+
+    png_read_update_info(png, info);
+
+    Format::Enum imageFormat = color_type & PNG_COLOR_MASK_ALPHA ? Format::RGBA_8_8_8_8 : Format::RGB_8_8_8;
+    int numComponents = imageFormat == Format::RGBA_8_8_8_8 ? 4 : 3;
+    size_t rowbytes = png_get_rowbytes(png, info);
+
+    int factor = ImageRowDownsampler::ComputeFactor(w, h, maxSize);
+
+    if (factor == 1 || numPasses > 1) {
+        // Rows are decoded straight into the image. Interlaced image needs the full size rows for the all passes.
+        if (factor == 1) {
+            Create2D(w, h, 1, imageFormat, GammaSpace::sRGB, nullptr, 0);
+        } else {
+            rowBuffer = (byte *)ImageScratchPool::Alloc(rowbytes * h);
+        }
+
+        byte *dst = factor == 1 ? this->pic : rowBuffer;
+
+        for (int pass = 0; pass < numPasses; pass++) {
+            for (png_uint_32 y = 0; y < h; y++) {
+                png_read_row(png, dst + y * rowbytes, nullptr);
+            }
+        }
+
+        if (factor > 1) {
+            Create2D((w + factor - 1) / factor, (h + factor - 1) / factor, 1, imageFormat, GammaSpace::sRGB, nullptr, 0);
+            downsampler.Init(w, h, numComponents, factor, this->pic);
+
+            for (png_uint_32 y = 0; y < h; y++) {
+                downsampler.AddRow(rowBuffer + y * rowbytes);
+            }
+        }
+    } else {
+        // Only one row is alive at a time while decoding into the downscaled image.
+        Create2D((w + factor - 1) / factor, (h + factor - 1) / factor, 1, imageFormat, GammaSpace::sRGB, nullptr, 0);
+        downsampler.Init(w, h, numComponents, factor, this->pic);
+
+        rowBuffer = (byte *)ImageScratchPool::Alloc(rowbytes);
+
+        for (png_uint_32 y = 0; y < h; y++) {
+            png_read_row(png, rowBuffer, nullptr);
+            downsampler.AddRow(rowBuffer);
+        }
+    }
+
+    png_read_end(png, info);
+
+    png_destroy_read_struct(&png, &info, (png_infopp)nullptr);
+
+    ImageScratchPool::Free(rowBuffer);
+
+    return true;
+}
+
 static void png_write_data(png_structp png, png_bytep data, png_size_t length) {
     //simdProcessor->Memcpy(png->io_ptr, data, length);
     memcpy(png->io_ptr, data, length);
@@ -90,6 +90,24 @@ bool Image::LoadPVR2FromMemory(const char *name, const byte *data, size_t fileSi
     return true;
 }
 
+// ASTC pixel formats of PVR v3 which are missing in libpvrt.
+enum {
+    PVRTPF_ASTC_4x4 = 27,
+    PVRTPF_ASTC_5x4 = 28,
+    PVRTPF_ASTC_5x5 = 29,
+    PVRTPF_ASTC_6x5 = 30,
+    PVRTPF_ASTC_6x6 = 31,
+    PVRTPF_ASTC_8x5 = 32,
+    PVRTPF_ASTC_8x6 = 33,
+    PVRTPF_ASTC_8x8 = 34,
+    PVRTPF_ASTC_10x5 = 35,
+    PVRTPF_ASTC_10x6 = 36,
+    PVRTPF_ASTC_10x8 = 37,
+    PVRTPF_ASTC_10x10 = 38,
+    PVRTPF_ASTC_12x10 = 39,
+    PVRTPF_ASTC_12x12 = 40
+};
+
 static bool IsSignedChannelType(uint32_t channelType) {
     if (channelType == ePVRTVarTypeSignedInteger || channelType == ePVRTVarTypeSignedIntegerNorm ||
         channelType == ePVRTVarTypeSignedShort || channelType == ePVRTVarTypeSignedShortNorm ||
@@ -153,9 +171,57 @@ bool Image::LoadPVR3FromMemory(const char *name, const byte *data, size_t fileSi
         case ePVRTPF_SharedExponentR9G9B9E5:
             this->format = Format::RGBE_9_9_9_5;
             break;
+        case ePVRTPF_BC6:
+            this->format = IsSignedChannelType(header->u32ChannelType) ? Format::RGB_BC6H_SF16 : Format::RGB_BC6H_UF16;
+            break;
+        case ePVRTPF_BC7:
+            this->format = Format::RGBA_BC7;
+            break;
+        case PVRTPF_ASTC_4x4:
+            this->format = Format::RGBA_ASTC_4x4;
+            break;
+        case PVRTPF_ASTC_5x4:
+            this->format = Format::RGBA_ASTC_5x4;
+            break;
+        case PVRTPF_ASTC_5x5:
+            this->format = Format::RGBA_ASTC_5x5;
+            break;
+        case PVRTPF_ASTC_6x5:
+            this->format = Format::RGBA_ASTC_6x5;
+            break;
+        case PVRTPF_ASTC_6x6:
+            this->format = Format::RGBA_ASTC_6x6;
+            break;
+        case PVRTPF_ASTC_8x5:
+            this->format = Format::RGBA_ASTC_8x5;
+            break;
+        case PVRTPF_ASTC_8x6:
+            this->format = Format::RGBA_ASTC_8x6;
+            break;
+        case PVRTPF_ASTC_8x8:
+            this->format = Format::RGBA_ASTC_8x8;
+            break;
+        case PVRTPF_ASTC_10x5:
+            this->format = Format::RGBA_ASTC_10x5;
+            break;
+        case PVRTPF_ASTC_10x6:
+            this->format = Format::RGBA_ASTC_10x6;
+            break;
+        case PVRTPF_ASTC_10x8:
+            this->format = Format::RGBA_ASTC_10x8;
+            break;
+        case PVRTPF_ASTC_10x10:
+            this->format = Format::RGBA_ASTC_10x10;
+            break;
+        case PVRTPF_ASTC_12x10:
+            this->format = Format::RGBA_ASTC_12x10;
+            break;
+        case PVRTPF_ASTC_12x12:
+            this->format = Format::RGBA_ASTC_12x12;
+            break;
         default:
             BE_WARNLOG("Image::LoadPVR3FromMemory: Unsupported pixel format %s\n", name);
-            break;
+            return false;
         }
     } else {
         switch (header->u64PixelFormat) {
@@ -281,7 +347,7 @@ bool Image::LoadPVR3FromMemory(const char *name, const byte *data, size_t fileSi
             break;
         default:
             BE_WARNLOG("Image::LoadPVR3FromMemory: Unsupported pixel format %s\n", name);
-            break;
+            return false;
         }
     }
         
@@ -303,7 +369,7 @@ bool Image::LoadPVR3FromMemory(const char *name, const byte *data, size_t fileSi
     simdProcessor->Memcpy(this->pic, ptr, (int)dataSize);
     this->alloced = true;
     
-    return false;
+    return true;
 }
 
 bool Image::LoadPVRFromMemory(const char *name, const byte *data, size_t size) {
@@ -397,6 +463,91 @@ bool Image::WritePVR(const char *filename) const {
         header.u32ColourSpace = ePVRTCSpacelRGB;
         header.u32ChannelType = ePVRTVarTypeSignedShortNorm;
         break;
+    case Format::RGB_BC6H_UF16:
+        header.u64PixelFormat = ePVRTPF_BC6;
+        header.u32ColourSpace = ePVRTCSpacelRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedFloat;
+        break;
+    case Format::RGB_BC6H_SF16:
+        header.u64PixelFormat = ePVRTPF_BC6;
+        header.u32ColourSpace = ePVRTCSpacelRGB;
+        header.u32ChannelType = ePVRTVarTypeSignedFloat;
+        break;
+    case Format::RGBA_BC7:
+        header.u64PixelFormat = ePVRTPF_BC7;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_4x4:
+        header.u64PixelFormat = PVRTPF_ASTC_4x4;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_5x4:
+        header.u64PixelFormat = PVRTPF_ASTC_5x4;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_5x5:
+        header.u64PixelFormat = PVRTPF_ASTC_5x5;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_6x5:
+        header.u64PixelFormat = PVRTPF_ASTC_6x5;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_6x6:
+        header.u64PixelFormat = PVRTPF_ASTC_6x6;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_8x5:
+        header.u64PixelFormat = PVRTPF_ASTC_8x5;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_8x6:
+        header.u64PixelFormat = PVRTPF_ASTC_8x6;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_8x8:
+        header.u64PixelFormat = PVRTPF_ASTC_8x8;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_10x5:
+        header.u64PixelFormat = PVRTPF_ASTC_10x5;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_10x6:
+        header.u64PixelFormat = PVRTPF_ASTC_10x6;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_10x8:
+        header.u64PixelFormat = PVRTPF_ASTC_10x8;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_10x10:
+        header.u64PixelFormat = PVRTPF_ASTC_10x10;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_12x10:
+        header.u64PixelFormat = PVRTPF_ASTC_12x10;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
+    case Format::RGBA_ASTC_12x12:
+        header.u64PixelFormat = PVRTPF_ASTC_12x12;
+        header.u32ColourSpace = gammaSpace == GammaSpace::Linear ? ePVRTCSpacelRGB : ePVRTCSpacesRGB;
+        header.u32ChannelType = ePVRTVarTypeUnsignedByteNorm;
+        break;
     case Format::RGBA_8_8_8_8:
         header.u64PixelFormat = PVRTGENPIXELID4('r', 'g', 'b', 'a', 8, 8, 8, 8);
         header.u32ColourSpace = ePVRTCSpacesRGB;
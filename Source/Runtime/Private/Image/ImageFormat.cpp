@@ -2375,6 +2375,27 @@ static const ImageFormatInfo imageFormatInfo[] = {
     { "Depth_32F",              4,  1,  0,  0,  0,  0,  Image::FormatType::Depth | Image::FormatType::Float, nullptr, nullptr, L32FToRGBA32F, RGBA32FToL32F },
     { "DepthStencil_24_8",      4,  2,  0,  0,  0,  0,  Image::FormatType::DepthStencil, nullptr, nullptr, nullptr, nullptr },
     { "DepthStencil_32F_8",     5,  2,  0,  0,  0,  0,  Image::FormatType::DepthStencil, nullptr, nullptr, nullptr, nullptr },
+
+    // BPTC ---------------------------------------------------------------------------------------
+    { "RGB_BC6H_UF16",          16, 3,  0,  0,  0,  0,  Image::FormatType::Compressed | Image::FormatType::Half, nullptr, nullptr, nullptr, nullptr },
+    { "RGB_BC6H_SF16",          16, 3,  0,  0,  0,  0,  Image::FormatType::Compressed | Image::FormatType::Half, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_BC7",               16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+
+    // ASTC ---------------------------------------------------------------------------------------
+    { "RGBA_ASTC_4x4",          16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_5x4",          16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_5x5",          16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_6x5",          16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_6x6",          16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_8x5",          16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_8x6",          16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_8x8",          16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_10x5",         16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_10x6",         16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_10x8",         16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_10x10",        16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_12x10",        16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
+    { "RGBA_ASTC_12x12",        16, 4,  0,  0,  0,  0,  Image::FormatType::Compressed, nullptr, nullptr, nullptr, nullptr },
 };
 
 const ImageFormatInfo *GetImageFormatInfo(Image::Format::Enum imageFormat) {
@@ -2428,6 +2449,68 @@ bool CompressedFormatMinDimensions(Image::Format::Enum imageFormat, int &minWidt
         minWidth = 4;
         minHeight = 4;
         return false;
+    case Image::Format::RGB_BC6H_UF16:
+    case Image::Format::RGB_BC6H_SF16:
+    case Image::Format::RGBA_BC7:
+        minWidth = 4;
+        minHeight = 4;
+        return true;
+    case Image::Format::RGBA_ASTC_4x4:
+        minWidth = 4;
+        minHeight = 4;
+        return true;
+    case Image::Format::RGBA_ASTC_5x4:
+        minWidth = 5;
+        minHeight = 4;
+        return true;
+    case Image::Format::RGBA_ASTC_5x5:
+        minWidth = 5;
+        minHeight = 5;
+        return true;
+    case Image::Format::RGBA_ASTC_6x5:
+        minWidth = 6;
+        minHeight = 5;
+        return true;
+    case Image::Format::RGBA_ASTC_6x6:
+        minWidth = 6;
+        minHeight = 6;
+        return true;
+    case Image::Format::RGBA_ASTC_8x5:
+        minWidth = 8;
+        minHeight = 5;
+        return true;
+    case Image::Format::RGBA_ASTC_8x6:
+        minWidth = 8;
+        minHeight = 6;
+        return true;
+    case Image::Format::RGBA_ASTC_8x8:
+        minWidth = 8;
+        minHeight = 8;
+        return true;
+    case Image::Format::RGBA_ASTC_10x5:
+        minWidth = 10;
+        minHeight = 5;
+        return true;
+    case Image::Format::RGBA_ASTC_10x6:
+        minWidth = 10;
+        minHeight = 6;
+        return true;
+    case Image::Format::RGBA_ASTC_10x8:
+        minWidth = 10;
+        minHeight = 8;
+        return true;
+    case Image::Format::RGBA_ASTC_10x10:
+        minWidth = 10;
+        minHeight = 10;
+        return true;
+    case Image::Format::RGBA_ASTC_12x10:
+        minWidth = 12;
+        minHeight = 10;
+        return true;
+    case Image::Format::RGBA_ASTC_12x12:
+        minWidth = 12;
+        minHeight = 12;
+        return true;
     default:
         return false;
     }
@@ -2481,6 +2564,68 @@ bool CompressedFormatBlockDimensions(Image::Format::Enum imageFormat, int &block
         blockWidth = 4;
         blockHeight = 4;
         return false;
+    case Image::Format::RGB_BC6H_UF16:
+    case Image::Format::RGB_BC6H_SF16:
+    case Image::Format::RGBA_BC7:
+        blockWidth = 4;
+        blockHeight = 4;
+        return true;
+    case Image::Format::RGBA_ASTC_4x4:
+        blockWidth = 4;
+        blockHeight = 4;
+        return true;
+    case Image::Format::RGBA_ASTC_5x4:
+        blockWidth = 5;
+        blockHeight = 4;
+        return true;
+    case Image::Format::RGBA_ASTC_5x5:
+        blockWidth = 5;
+        blockHeight = 5;
+        return true;
+    case Image::Format::RGBA_ASTC_6x5:
+        blockWidth = 6;
+        blockHeight = 5;
+        return true;
+    case Image::Format::RGBA_ASTC_6x6:
+        blockWidth = 6;
+        blockHeight = 6;
+        return true;
+    case Image::Format::RGBA_ASTC_8x5:
+        blockWidth = 8;
+        blockHeight = 5;
+        return true;
+    case Image::Format::RGBA_ASTC_8x6:
+        blockWidth = 8;
+        blockHeight = 6;
+        return true;
+    case Image::Format::RGBA_ASTC_8x8:
+        blockWidth = 8;
+        blockHeight = 8;
+        return true;
+    case Image::Format::RGBA_ASTC_10x5:
+        blockWidth = 10;
+        blockHeight = 5;
+        return true;
+    case Image::Format::RGBA_ASTC_10x6:
+        blockWidth = 10;
+        blockHeight = 6;
+        return true;
+    case Image::Format::RGBA_ASTC_10x8:
+        blockWidth = 10;
+        blockHeight = 8;
+        return true;
+    case Image::Format::RGBA_ASTC_10x10:
+        blockWidth = 10;
+        blockHeight = 10;
+        return true;
+    case Image::Format::RGBA_ASTC_12x10:
+        blockWidth = 12;
+        blockHeight = 10;
+        return true;
+    case Image::Format::RGBA_ASTC_12x12:
+        blockWidth = 12;
+        blockHeight = 12;
+        return true;
     default:
         return false;
     }
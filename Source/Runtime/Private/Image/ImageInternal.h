@@ -48,6 +48,11 @@ void DecompressETC2_RGB8A1(const Image &srcImage, Image &dstImage);
 void DecompressEAC_R11(const Image &srcImage, Image &dstImage, bool signedFormat);
 void DecompressEAC_RG11(const Image &srcImage, Image &dstImage, bool signedFormat, bool normal);
 
+void DecompressBC6H(const Image &srcImage, Image &dstImage, bool signedFormat);
+void DecompressBC7(const Image &srcImage, Image &dstImage);
+
+void DecompressASTC(const Image &srcImage, Image &dstImage);
+
 void CompressDXT1(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality);
 void CompressDXT3(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality);
 void CompressDXT5(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality);
@@ -62,6 +67,85 @@ void CompressEAC_RG11(const Image &srcImage, Image &dstImage, Image::Compression
 void CompressEAC_Signed_R11(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality);
 void CompressEAC_Signed_RG11(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality);
 
+void CompressBC6H(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality, bool signedFormat);
+void CompressBC7(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality);
+
+void CompressASTC(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressionQuality);
+
+using CompressBlocksFunc = void(*)(const byte *src, int width, int height, int depth, byte *dst, const void *param);
+
+// Compresses all the mipmaps and slices of the source image by splitting them into bands of block rows
+// and running the bands in the job pool. Source image should be RGBA_8_8_8_8 or RGBA_32F_32F_32F_32F.
+void ParallelCompressImage(const Image &srcImage, Image &dstImage, CompressBlocksFunc compressFunc, const void *param);
+
+// Pool of the scratch buffers used by the streaming image decoders.
+// Read chunks and row buffers are recycled between loads instead of going to the heap for every image.
+class ImageScratchPool {
+public:
+                            /// Returns a 16 bytes aligned buffer at least size bytes.
+    static void *           Alloc(size_t size);
+                            /// Returns the buffer to the pool.
+    static void             Free(void *ptr);
+                            /// Frees all the pooled buffers.
+    static void             Purge();
+};
+
+// Reads the file in fixed size chunks into a pooled buffer,
+// so the decoders never need the whole compressed file in memory.
+class ImageFileReader {
+public:
+    static const size_t     DefaultChunkSize = 64 * 1024;
+
+    explicit ImageFileReader(File *fp, size_t chunkSize = DefaultChunkSize);
+    ~ImageFileReader();
+
+                            /// Reads size bytes. Returns the number of bytes actually read.
+    size_t                  Read(void *dst, size_t size);
+                            /// Returns remaining bytes of the current chunk, reading the next chunk if it is empty.
+                            /// Returned bytes are regarded as consumed.
+    const byte *            Fill(size_t *size);
+
+private:
+    bool                    ReadChunk();
+
+    File *                  fp;
+    byte *                  buffer;
+    size_t                  chunkSize;
+    size_t                  readPos;
+    size_t                  bufferedSize;
+};
+
+// Box filters decoded 8 bits rows by integer factor while they are streamed in.
+class ImageRowDownsampler {
+public:
+    ImageRowDownsampler();
+    ~ImageRowDownsampler();
+
+                            /// Returns downscale factor to fit the image in maxSize x maxSize. 1 if maxSize <= 0.
+    static int              ComputeFactor(int width, int height, int maxSize);
+
+                            /// Destination has ((srcWidth + factor - 1) / factor) x ((srcHeight + factor - 1) / factor) pixels.
+    void                    Init(int srcWidth, int srcHeight, int numComponents, int factor, byte *dst);
+    void                    Free();
+
+                            /// Adds the next source row.
+    void                    AddRow(const byte *row);
+
+private:
+    void                    FlushRow();
+
+    uint32_t *              accum;
+    byte *                  dst;
+    int                     srcWidth;
+    int                     srcHeight;
+    int                     dstWidth;
+    int                     dstHeight;
+    int                     numComponents;
+    int                     factor;
+    int                     srcY;
+    int                     accumRows;
+};
+
 bool CompressedFormatBlockDimensions(Image::Format::Enum imageFormat, int &blockWidth, int &blockHeight);
 bool CompressedFormatMinDimensions(Image::Format::Enum imageFormat, int &minWidth, int &minHeight);
 
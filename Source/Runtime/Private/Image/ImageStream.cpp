@@ -0,0 +1,239 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "Precompiled.h"
+#include "Core/Heap.h"
+#include "Containers/Array.h"
+#include "Platform/PlatformThread.h"
+#include "Core/ScopeLock.h"
+#include "IO/File.h"
+#include "Image/Image.h"
+#include "ImageInternal.h"
+
+BE_NAMESPACE_BEGIN
+
+// Allocation header placed in front of the pooled buffer to keep the 16 bytes alignment.
+static const size_t ScratchHeaderSize = 16;
+static const int MaxPooledScratchBuffers = 8;
+
+static Array<void *> freeScratchBuffers;
+
+static PlatformMutex *GetScratchPoolMutex() {
+    static PlatformMutex *mutex = (PlatformMutex *)PlatformMutex::Create();
+    return mutex;
+}
+
+static BE_INLINE size_t ScratchBufferSize(const void *ptr) {
+    return *(const size_t *)((const byte *)ptr - ScratchHeaderSize);
+}
+
+void *ImageScratchPool::Alloc(size_t size) {
+    {
+        ScopeLock lock(GetScratchPoolMutex());
+
+        // Take the smallest buffer which fits the request.
+        int bestIndex = -1;
+        for (int i = 0; i < freeScratchBuffers.Count(); i++) {
+            size_t bufferSize = ScratchBufferSize(freeScratchBuffers[i]);
+            if (bufferSize >= size && (bestIndex < 0 || bufferSize < ScratchBufferSize(freeScratchBuffers[bestIndex]))) {
+                bestIndex = i;
+            }
+        }
+
+        if (bestIndex >= 0) {
+            void *ptr = freeScratchBuffers[bestIndex];
+            freeScratchBuffers.RemoveIndexFast(bestIndex);
+            return ptr;
+        }
+    }
+
+    byte *mem = (byte *)Mem_Alloc16(size + ScratchHeaderSize);
+    *(size_t *)mem = size;
+    return mem + ScratchHeaderSize;
+}
+
+void ImageScratchPool::Free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    {
+        ScopeLock lock(GetScratchPoolMutex());
+
+        if (freeScratchBuffers.Count() < MaxPooledScratchBuffers) {
+            freeScratchBuffers.Append(ptr);
+            return;
+        }
+    }
+
+    Mem_AlignedFree((byte *)ptr - ScratchHeaderSize);
+}
+
+void ImageScratchPool::Purge() {
+    ScopeLock lock(GetScratchPoolMutex());
+
+    for (int i = 0; i < freeScratchBuffers.Count(); i++) {
+        Mem_AlignedFree((byte *)freeScratchBuffers[i] - ScratchHeaderSize);
+    }
+    freeScratchBuffers.Clear();
+}
+
+ImageFileReader::ImageFileReader(File *fp, size_t chunkSize) {
+    this->fp = fp;
+    this->chunkSize = chunkSize;
+    this->buffer = (byte *)ImageScratchPool::Alloc(chunkSize);
+    this->readPos = 0;
+    this->bufferedSize = 0;
+}
+
+ImageFileReader::~ImageFileReader() {
+    ImageScratchPool::Free(buffer);
+}
+
+bool ImageFileReader::ReadChunk() {
+    size_t readSize = fp->Read(buffer, chunkSize);
+    // FileInZip returns negative value on error.
+    if (readSize > chunkSize) {
+        readSize = 0;
+    }
+    readPos = 0;
+    bufferedSize = readSize;
+    return readSize > 0;
+}
+
+size_t ImageFileReader::Read(void *dst, size_t size) {
+    byte *dstPtr = (byte *)dst;
+    size_t remaining = size;
+
+    while (remaining > 0) {
+        if (readPos == bufferedSize) {
+            // Bypass the chunk buffer for the large reads.
+            if (remaining >= chunkSize) {
+                size_t readSize = fp->Read(dstPtr, remaining);
+                if (readSize > remaining) {
+                    readSize = 0;
+                }
+                remaining -= readSize;
+                break;
+            }
+            if (!ReadChunk()) {
+                break;
+            }
+        }
+
+        size_t copySize = Min(remaining, bufferedSize - readPos);
+        memcpy(dstPtr, buffer + readPos, copySize);
+        readPos += copySize;
+        dstPtr += copySize;
+        remaining -= copySize;
+    }
+
+    return size - remaining;
+}
+
+const byte *ImageFileReader::Fill(size_t *size) {
+    if (readPos == bufferedSize && !ReadChunk()) {
+        *size = 0;
+        return nullptr;
+    }
+
+    const byte *ptr = buffer + readPos;
+    *size = bufferedSize - readPos;
+    readPos = bufferedSize;
+    return ptr;
+}
+
+ImageRowDownsampler::ImageRowDownsampler() {
+    accum = nullptr;
+    dst = nullptr;
+    srcWidth = srcHeight = 0;
+    dstWidth = dstHeight = 0;
+    numComponents = 0;
+    factor = 1;
+    srcY = 0;
+    accumRows = 0;
+}
+
+ImageRowDownsampler::~ImageRowDownsampler() {
+    Free();
+}
+
+int ImageRowDownsampler::ComputeFactor(int width, int height, int maxSize) {
+    if (maxSize <= 0) {
+        return 1;
+    }
+    int size = Max(width, height);
+    return Max((size + maxSize - 1) / maxSize, 1);
+}
+
+void ImageRowDownsampler::Init(int srcWidth, int srcHeight, int numComponents, int factor, byte *dst) {
+    Free();
+
+    this->srcWidth = srcWidth;
+    this->srcHeight = srcHeight;
+    this->numComponents = numComponents;
+    this->factor = factor;
+    this->dstWidth = (srcWidth + factor - 1) / factor;
+    this->dstHeight = (srcHeight + factor - 1) / factor;
+    this->dst = dst;
+    this->srcY = 0;
+    this->accumRows = 0;
+
+    size_t accumSize = dstWidth * numComponents * sizeof(uint32_t);
+    accum = (uint32_t *)ImageScratchPool::Alloc(accumSize);
+    memset(accum, 0, accumSize);
+}
+
+void ImageRowDownsampler::Free() {
+    ImageScratchPool::Free(accum);
+    accum = nullptr;
+}
+
+void ImageRowDownsampler::AddRow(const byte *row) {
+    for (int x = 0; x < srcWidth; x++) {
+        uint32_t *sum = &accum[(x / factor) * numComponents];
+        const byte *src = &row[x * numComponents];
+
+        for (int c = 0; c < numComponents; c++) {
+            sum[c] += src[c];
+        }
+    }
+
+    srcY++;
+    accumRows++;
+
+    if (accumRows == factor || srcY == srcHeight) {
+        FlushRow();
+    }
+}
+
+void ImageRowDownsampler::FlushRow() {
+    for (int x = 0; x < dstWidth; x++) {
+        // Last column may cover less source pixels.
+        int boxWidth = Min(factor, srcWidth - x * factor);
+        uint32_t count = boxWidth * accumRows;
+
+        uint32_t *sum = &accum[x * numComponents];
+        for (int c = 0; c < numComponents; c++) {
+            dst[x * numComponents + c] = (byte)((sum[c] + count / 2) / count);
+            sum[c] = 0;
+        }
+    }
+
+    dst += dstWidth * numComponents;
+    accumRows = 0;
+}
+
+BE_NAMESPACE_END
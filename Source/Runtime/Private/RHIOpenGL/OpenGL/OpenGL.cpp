@@ -148,6 +148,21 @@ Image::Format::Enum OpenGLBase::ToUncompressedImageFormat(Image::Format::Enum in
     case Image::Format::RGBA_8_8_ETC2:
     case Image::Format::RGBA_EA_ATC:
     case Image::Format::RGBA_IA_ATC:
+    case Image::Format::RGBA_BC7:
+    case Image::Format::RGBA_ASTC_4x4:
+    case Image::Format::RGBA_ASTC_5x4:
+    case Image::Format::RGBA_ASTC_5x5:
+    case Image::Format::RGBA_ASTC_6x5:
+    case Image::Format::RGBA_ASTC_6x6:
+    case Image::Format::RGBA_ASTC_8x5:
+    case Image::Format::RGBA_ASTC_8x6:
+    case Image::Format::RGBA_ASTC_8x8:
+    case Image::Format::RGBA_ASTC_10x5:
+    case Image::Format::RGBA_ASTC_10x6:
+    case Image::Format::RGBA_ASTC_10x8:
+    case Image::Format::RGBA_ASTC_10x10:
+    case Image::Format::RGBA_ASTC_12x10:
+    case Image::Format::RGBA_ASTC_12x12:
         outFormat = Image::Format::RGBA_8_8_8_8;
         break;
     case Image::Format::R_11_EAC:
@@ -158,6 +173,10 @@ Image::Format::Enum OpenGLBase::ToUncompressedImageFormat(Image::Format::Enum in
     case Image::Format::SignedRG_11_11_EAC:
         outFormat = Image::Format::RGB_8_8_8;
         break;
+    case Image::Format::RGB_BC6H_UF16:
+    case Image::Format::RGB_BC6H_SF16:
+        outFormat = Image::Format::RGB_16F_16F_16F;
+        break;
     default:
         assert(0);
         outFormat = inFormat;
@@ -422,6 +422,176 @@ bool OpenGL3::ImageFormatToGLFormat(Image::Format::Enum imageFormat, bool isSRGB
         if (glType)     *glType = 0;
         if (glInternal) *glInternal = GL_COMPRESSED_RG_RGTC2;//GL_COMPRESSED_SIGNED_RG_RGTC2 GL_COMPRESSED_LUMINANCE_ALPHA_LATC2_EXT;
         return true;
+    case Image::Format::RGB_BC6H_UF16:
+#ifdef GL_ARB_texture_compression_bptc
+        if (!gglext._GL_ARB_texture_compression_bptc) return false;
+        if (glFormat)   *glFormat = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGB_BC6H_SF16:
+#ifdef GL_ARB_texture_compression_bptc
+        if (!gglext._GL_ARB_texture_compression_bptc) return false;
+        if (glFormat)   *glFormat = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_BC7:
+#ifdef GL_ARB_texture_compression_bptc
+        if (!gglext._GL_ARB_texture_compression_bptc) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB : GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB : GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_4x4:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR : GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR : GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_5x4:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR : GL_COMPRESSED_RGBA_ASTC_5x4_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR : GL_COMPRESSED_RGBA_ASTC_5x4_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_5x5:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR : GL_COMPRESSED_RGBA_ASTC_5x5_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR : GL_COMPRESSED_RGBA_ASTC_5x5_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_6x5:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR : GL_COMPRESSED_RGBA_ASTC_6x5_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR : GL_COMPRESSED_RGBA_ASTC_6x5_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_6x6:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR : GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR : GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_8x5:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR : GL_COMPRESSED_RGBA_ASTC_8x5_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR : GL_COMPRESSED_RGBA_ASTC_8x5_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_8x6:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR : GL_COMPRESSED_RGBA_ASTC_8x6_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR : GL_COMPRESSED_RGBA_ASTC_8x6_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_8x8:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR : GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR : GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_10x5:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR : GL_COMPRESSED_RGBA_ASTC_10x5_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR : GL_COMPRESSED_RGBA_ASTC_10x5_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_10x6:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR : GL_COMPRESSED_RGBA_ASTC_10x6_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR : GL_COMPRESSED_RGBA_ASTC_10x6_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_10x8:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR : GL_COMPRESSED_RGBA_ASTC_10x8_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR : GL_COMPRESSED_RGBA_ASTC_10x8_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_10x10:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR : GL_COMPRESSED_RGBA_ASTC_10x10_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR : GL_COMPRESSED_RGBA_ASTC_10x10_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_12x10:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR : GL_COMPRESSED_RGBA_ASTC_12x10_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR : GL_COMPRESSED_RGBA_ASTC_12x10_KHR;
+        return true;
+#else
+        return false;
+#endif
+    case Image::Format::RGBA_ASTC_12x12:
+#ifdef GL_KHR_texture_compression_astc_ldr
+        if (!gglext._GL_KHR_texture_compression_astc_ldr) return false;
+        if (glFormat)   *glFormat = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR : GL_COMPRESSED_RGBA_ASTC_12x12_KHR;
+        if (glType)     *glType = 0;
+        if (glInternal) *glInternal = isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR : GL_COMPRESSED_RGBA_ASTC_12x12_KHR;
+        return true;
+#else
+        return false;
+#endif
     case Image::Format::Depth_16:
         if (glFormat)   *glFormat = GL_DEPTH_COMPONENT;
         if (glType)     *glType = GL_UNSIGNED_SHORT;
@@ -327,6 +327,14 @@ int OpenGLRHI::BufferWrite(Handle bufferHandle, int alignSize, int size, const v
     return base;
 }
 
+void OpenGLRHI::BufferUpdate(Handle bufferHandle, int offset, int size, const void *data) {
+    GLBuffer *writeBuffer = bufferList[bufferHandle];
+
+    assert(offset + size <= writeBuffer->size);
+
+    gglBufferSubData(writeBuffer->target, offset, size, data);
+}
+
 int	OpenGLRHI::BufferCopy(Handle readBufferHandle, Handle writeBufferHandle, int alignSize, int size) {
     GLBuffer *writeBuffer = bufferList[writeBufferHandle];
     const GLBuffer *readBuffer = bufferList[readBufferHandle];
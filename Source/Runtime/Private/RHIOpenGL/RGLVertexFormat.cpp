@@ -25,6 +25,8 @@ static const GLenum toGLType[] = {
     GL_UNSIGNED_INT,
     GL_FLOAT,
     GL_HALF_FLOAT,
+    GL_SHORT,
+    GL_UNSIGNED_SHORT,
 };
 
 static const int GLTypeSize[] = { 
@@ -33,7 +35,9 @@ static const int GLTypeSize[] = {
     sizeof(GLint),
     sizeof(GLuint),
     sizeof(GLfloat),
-    sizeof(GLhalf)
+    sizeof(GLhalf),
+    sizeof(GLshort),
+    sizeof(GLushort)
 };
 
 RHI::Handle OpenGLRHI::CreateVertexFormat(int numElements, const VertexElement *elements) {
@@ -20,7 +20,7 @@ BE_NAMESPACE_BEGIN
 #define BSKEL_VERSION   1
 
 #define BMESH_IDENT     MAKE_FOURCC('B', 'E', 'M', '1')
-#define BMESH_VERSION   1
+#define BMESH_VERSION   2
 
 #define BANIM_IDENT     MAKE_FOURCC('B', 'E', 'A', '1')
 #define BANIM_VERSION   2
@@ -31,6 +31,8 @@ enum BAnimFlag {
     RootRotation        = BIT(2),
 };
 
+#define BMESH_STREAM_ALIGNMENT  16
+
 #pragma pack(1)
 
 struct BSkelHeader {
@@ -54,6 +56,23 @@ struct BMeshHeader {
     Vec3            aabbMax;
 };
 
+// Version 2 stores the vertex and index streams in the runtime vertex formats,
+// so that they can be used directly from the memory mapped file.
+enum BMeshLayoutFlag {
+    CompressedNormals   = BIT(0),
+    CompactVertices     = BIT(1),       // use VertexGenericLitCompact for the static vertex buffers
+    LODs                = BIT(2),       // BMeshLODs follows the surfaces
+    Clusters            = BIT(3)        // BMeshClusters follows the LODs
+};
+
+// Follows BMeshHeader in version 2.
+struct BMeshLayout {
+    uint32_t        vertexSize;         // sizeof(VertexGenericLit)
+    uint32_t        weightSize4;        // sizeof(VertexWeight4)
+    uint32_t        weightSize8;        // sizeof(VertexWeight8)
+    uint32_t        flags;
+};
+
 struct BMeshSurf {
     int32_t         materialIndex;
     uint32_t        numVerts;
@@ -64,6 +83,31 @@ struct BMeshSurf {
     Vec3            aabbMax;
 };
 
+// Follows the surfaces in version 2 if BMeshLayoutFlag::LODs is set.
+// numSurfs x (BMeshSurf + streams) are stored for each LOD from 1 to numLODs - 1.
+struct BMeshLODs {
+    uint32_t        numLODs;            // including LOD 0
+    uint32_t        padding;
+};
+
+// Follows the LODs in version 2 if BMeshLayoutFlag::Clusters is set.
+// numSurfs x (BMeshClusters + numClusters x BMeshCluster) are stored for the LOD 0 surfaces.
+struct BMeshClusters {
+    uint32_t        numClusters;
+    uint32_t        padding;
+};
+
+struct BMeshCluster {
+    int32_t         firstIndex;
+    int32_t         numIndexes;
+    Vec3            center;
+    float           radius;
+    Vec3            coneAxis;
+    float           coneCutoff;
+    Vec3            aabbMin;
+    Vec3            aabbMax;
+};
+
 struct BMeshVert {
     Vec3            position;
     Vec2            texCoord;
@@ -34,7 +34,8 @@ public:
     const VisObject *       space;              ///< Parent of this surface
     const Material *        material;           ///< Material of this surface
     const float *           materialRegisters;
-    int                     instanceIndex;
+    int                     instanceIndex;      ///< Slot index in the instance buffer of the render world if UseInstancing flag is set
+    int                     cascadeMask;        ///< Shadow cascades of the light to cast shadows on, -1 for all
 };
 
 BE_NAMESPACE_END
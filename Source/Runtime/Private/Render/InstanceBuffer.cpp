@@ -0,0 +1,204 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "Core/Heap.h"
+
+BE_NAMESPACE_BEGIN
+
+void InstanceBuffer::Init(RHI::BufferType::Enum bufferType, int stride, int initialCapacity) {
+    Shutdown();
+
+    this->bufferType = bufferType;
+    this->stride = stride;
+
+    Grow(initialCapacity);
+}
+
+void InstanceBuffer::Shutdown() {
+    if (bufferCache.buffer != RHI::NullBuffer) {
+        rhi.DestroyBuffer(bufferCache.buffer);
+    }
+    bufferCache = {};
+
+    if (data) {
+        Mem_AlignedFree(data);
+        data = nullptr;
+    }
+
+    capacity = 0;
+    numAllocatedSlots = 0;
+    bufferResized = false;
+
+    freeRanges.Clear();
+    dirtyRanges.Clear();
+}
+
+void InstanceBuffer::Grow(int minCapacity) {
+    int newCapacity = Max(capacity * 2, minCapacity);
+
+    byte *newData = (byte *)Mem_Alloc16(newCapacity * stride);
+    memset(newData, 0, newCapacity * stride);
+    if (data) {
+        memcpy(newData, data, capacity * stride);
+        Mem_AlignedFree(data);
+    }
+    data = newData;
+
+    // Append new slots to the free ranges.
+    if (freeRanges.Count() > 0 && freeRanges.Last().firstSlot + freeRanges.Last().count == capacity) {
+        freeRanges.Last().count += newCapacity - capacity;
+    } else {
+        SlotRange &range = freeRanges.Alloc();
+        range.firstSlot = capacity;
+        range.count = newCapacity - capacity;
+    }
+
+    capacity = newCapacity;
+
+    // Whole buffer will be uploaded again with the new size.
+    bufferResized = true;
+}
+
+int InstanceBuffer::AllocSlots(int count) {
+    assert(count > 0);
+
+    // First fit
+    for (int i = 0; i < freeRanges.Count(); i++) {
+        SlotRange &range = freeRanges[i];
+
+        if (range.count >= count) {
+            int firstSlot = range.firstSlot;
+
+            range.firstSlot += count;
+            range.count -= count;
+            if (range.count == 0) {
+                freeRanges.RemoveIndex(i);
+            }
+
+            numAllocatedSlots += count;
+            return firstSlot;
+        }
+    }
+
+    int lastFreeCount = (freeRanges.Count() > 0 && freeRanges.Last().firstSlot + freeRanges.Last().count == capacity) ? freeRanges.Last().count : 0;
+
+    Grow(capacity + count - lastFreeCount);
+
+    return AllocSlots(count);
+}
+
+void InstanceBuffer::FreeSlots(int firstSlot, int count) {
+    assert(firstSlot >= 0 && firstSlot + count <= capacity);
+
+    // Find the insertion point to keep the ranges sorted.
+    int index = 0;
+    while (index < freeRanges.Count() && freeRanges[index].firstSlot < firstSlot) {
+        index++;
+    }
+
+    SlotRange range;
+    range.firstSlot = firstSlot;
+    range.count = count;
+    freeRanges.Insert(range, index);
+
+    // Merge with the next range.
+    if (index + 1 < freeRanges.Count() && firstSlot + count == freeRanges[index + 1].firstSlot) {
+        freeRanges[index].count += freeRanges[index + 1].count;
+        freeRanges.RemoveIndex(index + 1);
+    }
+
+    // Merge with the previous range.
+    if (index > 0 && freeRanges[index - 1].firstSlot + freeRanges[index - 1].count == firstSlot) {
+        freeRanges[index - 1].count += freeRanges[index].count;
+        freeRanges.RemoveIndex(index);
+    }
+
+    numAllocatedSlots -= count;
+}
+
+void InstanceBuffer::MarkDirty(int firstSlot, int count) {
+    if (bufferResized) {
+        return;
+    }
+
+    // Extend the last range for the consecutive writes.
+    if (dirtyRanges.Count() > 0) {
+        SlotRange &lastRange = dirtyRanges.Last();
+
+        if (firstSlot >= lastRange.firstSlot && firstSlot <= lastRange.firstSlot + lastRange.count) {
+            lastRange.count = Max(lastRange.count, firstSlot + count - lastRange.firstSlot);
+            return;
+        }
+    }
+
+    SlotRange &range = dirtyRanges.Alloc();
+    range.firstSlot = firstSlot;
+    range.count = count;
+}
+
+void InstanceBuffer::Upload() {
+    if (!data) {
+        return;
+    }
+
+    if (bufferResized) {
+        if (bufferCache.buffer != RHI::NullBuffer) {
+            rhi.DestroyBuffer(bufferCache.buffer);
+        }
+
+        bufferCache.buffer = rhi.CreateBuffer(bufferType, RHI::BufferUsage::Dynamic, capacity * stride, 0, data);
+        bufferCache.offset = 0;
+        bufferCache.bytes = capacity * stride;
+        bufferCache.frameCount = 0xFFFFFFFF;
+
+        bufferResized = false;
+        dirtyRanges.SetCount(0, false);
+        return;
+    }
+
+    if (dirtyRanges.Count() == 0) {
+        return;
+    }
+
+    dirtyRanges.Sort([](const SlotRange &a, const SlotRange &b) -> bool {
+        return a.firstSlot < b.firstSlot;
+    });
+
+    rhi.BindBuffer(bufferType, bufferCache.buffer);
+
+    // Upload the overlapped or adjacent ranges at once.
+    int firstSlot = dirtyRanges[0].firstSlot;
+    int endSlot = firstSlot + dirtyRanges[0].count;
+
+    for (int i = 1; i <= dirtyRanges.Count(); i++) {
+        if (i < dirtyRanges.Count() && dirtyRanges[i].firstSlot <= endSlot) {
+            endSlot = Max(endSlot, dirtyRanges[i].firstSlot + dirtyRanges[i].count);
+            continue;
+        }
+
+        rhi.BufferUpdate(bufferCache.buffer, firstSlot * stride, (endSlot - firstSlot) * stride, GetSlotData(firstSlot));
+
+        if (i < dirtyRanges.Count()) {
+            firstSlot = dirtyRanges[i].firstSlot;
+            endSlot = firstSlot + dirtyRanges[i].count;
+        }
+    }
+
+    dirtyRanges.SetCount(0, false);
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,227 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/JobPool.h"
+#include "Math/Math.h"
+#include "SIMD/SIMD.h"
+#include "Render/LightGrid.h"
+
+BE_NAMESPACE_BEGIN
+
+void LightGrid::Init() {
+    Shutdown();
+
+    clusterBounds.SetCount(NumClusters);
+    sliceDepths.SetCount(GridSizeZ + 1);
+    sliceClusterCounts.SetCount(NumClusters);
+    clusterOffsets.SetCount(NumClusters + 1);
+    sliceLights.SetCount(GridSizeZ);
+    sliceLightIndexes.SetCount(GridSizeZ);
+    sliceTasks.SetCount(GridSizeZ);
+
+    for (int i = 0; i < GridSizeZ; i++) {
+        sliceTasks[i].grid = this;
+        sliceTasks[i].slice = i;
+    }
+
+    for (int i = 0; i < clusterOffsets.Count(); i++) {
+        clusterOffsets[i] = 0;
+    }
+}
+
+void LightGrid::Shutdown() {
+    clusterBounds.Clear();
+    sliceDepths.Clear();
+    sliceLights.Clear();
+    sliceLightIndexes.Clear();
+    sliceClusterCounts.Clear();
+    clusterOffsets.Clear();
+    lightIndexes.Clear();
+    sliceTasks.Clear();
+
+    spheres = nullptr;
+    numSpheres = 0;
+}
+
+void LightGrid::Setup(const Mat4 &projMatrix, float zNear, float zFar) {
+    assert(IsInitialized());
+    assert(zNear > 0.0f && zFar > zNear);
+
+    // Exponential depth slices: d(z) = zNear * (zFar / zNear)^(z / GridSizeZ)
+    float logDepthRatio = Math::Ln(zFar / zNear);
+
+    sliceScale = GridSizeZ / logDepthRatio;
+    sliceBias = -GridSizeZ * Math::Ln(zNear) / logDepthRatio;
+
+    for (int z = 0; z <= GridSizeZ; z++) {
+        sliceDepths[z] = zNear * Math::Pow(zFar / zNear, (float)z / GridSizeZ);
+    }
+
+    // View space position of the NDC (x, y) at the view depth d in the GL style view space (looking at -z):
+    // x = d * (ndc.x + P[0][2]) / P[0][0], y = d * (ndc.y + P[1][2]) / P[1][1]
+    const float invP00 = 1.0f / projMatrix[0][0];
+    const float invP11 = 1.0f / projMatrix[1][1];
+    const float p02 = projMatrix[0][2];
+    const float p12 = projMatrix[1][2];
+
+    for (int z = 0; z < GridSizeZ; z++) {
+        float nearDepth = sliceDepths[z];
+        float farDepth = sliceDepths[z + 1];
+
+        for (int y = 0; y < GridSizeY; y++) {
+            float ndcY0 = -1.0f + 2.0f * y / GridSizeY;
+            float ndcY1 = -1.0f + 2.0f * (y + 1) / GridSizeY;
+
+            float y00 = nearDepth * (ndcY0 + p12) * invP11;
+            float y01 = farDepth * (ndcY0 + p12) * invP11;
+            float y10 = nearDepth * (ndcY1 + p12) * invP11;
+            float y11 = farDepth * (ndcY1 + p12) * invP11;
+
+            for (int x = 0; x < GridSizeX; x++) {
+                float ndcX0 = -1.0f + 2.0f * x / GridSizeX;
+                float ndcX1 = -1.0f + 2.0f * (x + 1) / GridSizeX;
+
+                float x00 = nearDepth * (ndcX0 + p02) * invP00;
+                float x01 = farDepth * (ndcX0 + p02) * invP00;
+                float x10 = nearDepth * (ndcX1 + p02) * invP00;
+                float x11 = farDepth * (ndcX1 + p02) * invP00;
+
+                AABB &bounds = clusterBounds[ClusterIndex(x, y, z)];
+                bounds[0].x = Min(Min(x00, x01), Min(x10, x11));
+                bounds[1].x = Max(Max(x00, x01), Max(x10, x11));
+                bounds[0].y = Min(Min(y00, y01), Min(y10, y11));
+                bounds[1].y = Max(Max(y00, y01), Max(y10, y11));
+                bounds[0].z = -farDepth;
+                bounds[1].z = -nearDepth;
+            }
+        }
+    }
+}
+
+void LightGrid::AssignLights(const Sphere *viewSpaceSpheres, int numLights) {
+    assert(IsInitialized());
+
+    spheres = viewSpaceSpheres;
+    numSpheres = numLights;
+
+    jobPool.Run(AssignSliceLightsTask, sliceTasks);
+
+    // Merge light indexes of all slices. Clusters of the slice are contiguous in the cluster order.
+    clusterOffsets[0] = 0;
+    for (int i = 0; i < NumClusters; i++) {
+        clusterOffsets[i + 1] = clusterOffsets[i] + sliceClusterCounts[i];
+    }
+
+    lightIndexes.SetCount(clusterOffsets[NumClusters], false);
+
+    for (int z = 0; z < GridSizeZ; z++) {
+        const Array<int32_t> &indexes = sliceLightIndexes[z];
+        if (indexes.Count() > 0) {
+            simdProcessor->Memcpy(lightIndexes.Ptr() + clusterOffsets[ClusterIndex(0, 0, z)], indexes.Ptr(), indexes.MemoryUsed());
+        }
+    }
+
+    spheres = nullptr;
+    numSpheres = 0;
+}
+
+void LightGrid::AssignSliceLightsTask(void *data) {
+    SliceTask *task = (SliceTask *)data;
+    task->grid->AssignSliceLights(task->slice);
+}
+
+void LightGrid::AssignSliceLights(int slice) {
+    const float nearDepth = sliceDepths[slice];
+    const float farDepth = sliceDepths[slice + 1];
+
+    // Find lights overlapping the depth range of this slice and their tile ranges.
+    // X extents of the clusters depend only on the column, and Y extents only on the row.
+    Array<SliceLight> &lights = sliceLights[slice];
+    lights.SetCount(0, false);
+
+    for (int i = 0; i < numSpheres; i++) {
+        const Sphere &sphere = spheres[i];
+
+        float depth = -sphere.center.z;
+        if (depth + sphere.radius < nearDepth || depth - sphere.radius > farDepth) {
+            continue;
+        }
+
+        SliceLight sliceLight;
+        sliceLight.minX = GridSizeX;
+        sliceLight.maxX = -1;
+        sliceLight.minY = GridSizeY;
+        sliceLight.maxY = -1;
+
+        for (int x = 0; x < GridSizeX; x++) {
+            const AABB &bounds = clusterBounds[ClusterIndex(x, 0, slice)];
+            if (sphere.center.x + sphere.radius >= bounds[0].x && sphere.center.x - sphere.radius <= bounds[1].x) {
+                sliceLight.minX = Min(sliceLight.minX, x);
+                sliceLight.maxX = x;
+            }
+        }
+
+        if (sliceLight.maxX < 0) {
+            continue;
+        }
+
+        for (int y = 0; y < GridSizeY; y++) {
+            const AABB &bounds = clusterBounds[ClusterIndex(0, y, slice)];
+            if (sphere.center.y + sphere.radius >= bounds[0].y && sphere.center.y - sphere.radius <= bounds[1].y) {
+                sliceLight.minY = Min(sliceLight.minY, y);
+                sliceLight.maxY = y;
+            }
+        }
+
+        if (sliceLight.maxY < 0) {
+            continue;
+        }
+
+        sliceLight.lightIndex = i;
+        lights.Append(sliceLight);
+    }
+
+    // Test each clusters of this slice with the candidate lights in the cluster order,
+    // so the light indexes are already sorted by the cluster.
+    Array<int32_t> &indexes = sliceLightIndexes[slice];
+    indexes.SetCount(0, false);
+
+    for (int y = 0; y < GridSizeY; y++) {
+        for (int x = 0; x < GridSizeX; x++) {
+            int clusterIndex = ClusterIndex(x, y, slice);
+            const AABB &bounds = clusterBounds[clusterIndex];
+            int count = 0;
+
+            for (int i = 0; i < lights.Count(); i++) {
+                const SliceLight &sliceLight = lights[i];
+
+                if (x < sliceLight.minX || x > sliceLight.maxX || y < sliceLight.minY || y > sliceLight.maxY) {
+                    continue;
+                }
+
+                if (!spheres[sliceLight.lightIndex].IsIntersectAABB(bounds)) {
+                    continue;
+                }
+
+                indexes.Append(sliceLight.lightIndex);
+                count++;
+            }
+
+            sliceClusterCounts[clusterIndex] = count;
+        }
+    }
+}
+
+BE_NAMESPACE_END
@@ -31,6 +31,8 @@ void Mesh::Purge() {
     }
     surfaces.Clear();
 
+    numLODs = 1;
+
     if (isInstantiated) {
         SAFE_DELETE(skinningJointCache);
 
@@ -41,6 +43,11 @@ void Mesh::Purge() {
     } else {
         SAFE_DELETE_ARRAY(joints);
     }
+
+    useCompactVertices = false;
+
+    // Sub meshes which point to the file data are freed above.
+    CloseMeshData();
 }
 
 MeshSurf *Mesh::AllocSurface(int numVerts, int numIndexes) const {
@@ -55,9 +62,25 @@ MeshSurf *Mesh::AllocSurface(int numVerts, int numIndexes) const {
     return surf;
 }
 
+MeshSurf *Mesh::AllocExternalSurface(int numVerts, VertexGenericLit *verts, int numIndexes, TriIndex *indexes) const {
+    MeshSurf *surf = new MeshSurf;
+    surf->materialIndex = 0;
+    surf->subMesh       = new SubMesh;
+    surf->drawSurf      = nullptr;
+    surf->viewCount     = 0;
+
+    surf->subMesh->AllocExternalSubMesh(numVerts, verts, numIndexes, indexes);
+
+    return surf;
+}
+
 void Mesh::FreeSurface(MeshSurf *surf) const {
     delete surf->subMesh;
 
+    for (int lodIndex = 0; lodIndex < COUNT_OF(surf->lodSubMeshes); lodIndex++) {
+        SAFE_DELETE(surf->lodSubMeshes[lodIndex]);
+    }
+
     SAFE_DELETE(surf);
 }
 
@@ -70,6 +93,16 @@ MeshSurf *Mesh::AllocInstantiatedSurface(const MeshSurf *refSurf, int meshType)
 
     surf->subMesh->AllocInstantiatedSubMesh(refSurf->subMesh, meshType);
 
+    // LODs are used only for static meshes.
+    if (meshType == Type::Static) {
+        for (int lodIndex = 0; lodIndex < COUNT_OF(refSurf->lodSubMeshes); lodIndex++) {
+            if (refSurf->lodSubMeshes[lodIndex]) {
+                surf->lodSubMeshes[lodIndex] = new SubMesh;
+                surf->lodSubMeshes[lodIndex]->AllocInstantiatedSubMesh(refSurf->lodSubMeshes[lodIndex], meshType);
+            }
+        }
+    }
+
     return surf;
 }
 
@@ -91,6 +124,10 @@ void Mesh::Instantiate(int meshType) {
         meshType = Type::Static; // override to static mesh
     }
 
+    useCompactVertices = originalMesh->useCompactVertices;
+
+    numLODs = isStaticMesh ? originalMesh->numLODs : 1;
+
     // Free previously allocated skinning joint cache
     SAFE_DELETE(skinningJointCache);
 
@@ -127,8 +164,25 @@ void Mesh::Reinstantiate() {
     Instantiate(meshType);
 }
 
+void Mesh::SetCompactVertices(bool compact) {
+    useCompactVertices = compact;
+
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        MeshSurf *surf = surfaces[surfaceIndex];
+        surf->subMesh->useCompactVertex = compact;
+
+        for (int lodIndex = 0; lodIndex < COUNT_OF(surf->lodSubMeshes); lodIndex++) {
+            if (surf->lodSubMeshes[lodIndex]) {
+                surf->lodSubMeshes[lodIndex]->useCompactVertex = compact;
+            }
+        }
+    }
+}
+
 void Mesh::FinishSurfaces(int flags) {
     if (flags & FinishFlag::SortAndMerge) {
+        // LOD surfaces don't match with the merged surfaces.
+        ClearLODs();
         SortAndMerge();
         ComputeAABB();
     }
@@ -143,6 +197,11 @@ void Mesh::FinishSurfaces(int flags) {
         OptimizeIndexedTriangles();
     }
 
+    // Clusters are used only for static meshes.
+    if ((flags & FinishFlag::BuildClusters) && numJoints == 0) {
+        BuildClusters();
+    }
+
     if ((flags & FinishFlag::ComputeNormals) && !(flags & FinishFlag::ComputeTangents)) {
         ComputeNormals();
     }
@@ -163,6 +222,7 @@ void Mesh::FinishSurfaces(int flags) {
 void Mesh::TransformVerts(const Mat3 &rotation, const Vec3 &scale, const Vec3 &translation) {
     for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
         SubMesh *subMesh = surfaces[surfaceIndex]->subMesh;
+        subMesh->DetachExternalData();
 
         for (int vertexIndex = 0; vertexIndex < subMesh->numVerts; vertexIndex++) {
             subMesh->verts[vertexIndex].Transform(rotation, scale, translation);
@@ -172,13 +232,84 @@ void Mesh::TransformVerts(const Mat3 &rotation, const Vec3 &scale, const Vec3 &t
     ComputeAABB();
 }
 
+void Mesh::CombineSubMeshes(const Array<BatchSubMesh> &batchSubMeshes, int finishFlags) {
+    assert(surfaces.Count() == 0);
+
+    // Counts total verts/indices for combined mesh.
+    int numTotalVerts = 0;
+    int numTotalIndexes = 0;
+
+    for (int subMeshIndex = 0; subMeshIndex < batchSubMeshes.Count(); subMeshIndex++) {
+        const SubMesh *subMesh = batchSubMeshes[subMeshIndex].subMesh;
+
+        numTotalVerts += subMesh->NumVerts();
+        numTotalIndexes += subMesh->NumIndexes();
+    }
+
+    MeshSurf *surf = AllocSurface(numTotalVerts, numTotalIndexes);
+    surfaces.Append(surf);
+
+    VertexGenericLit *dstVertPtr = surf->subMesh->verts;
+    TriIndex *dstIndexPtr = surf->subMesh->indexes;
+    int baseVertex = 0;
+
+    for (int subMeshIndex = 0; subMeshIndex < batchSubMeshes.Count(); subMeshIndex++) {
+        const SubMesh *srcSubMesh = batchSubMeshes[subMeshIndex].subMesh;
+
+        for (int i = 0; i < srcSubMesh->numVerts; i++) {
+            *dstVertPtr = srcSubMesh->verts[i];
+
+            dstVertPtr->Transform(batchSubMeshes[subMeshIndex].localTransform);
+            dstVertPtr++;
+        }
+
+        for (int i = 0; i < srcSubMesh->numIndexes; i++) {
+            *dstIndexPtr = srcSubMesh->indexes[i] + baseVertex;
+            dstIndexPtr++;
+        }
+
+        baseVertex += srcSubMesh->numVerts;
+    }
+
+    FinishSurfaces(finishFlags | FinishFlag::ComputeAABB);
+}
+
 void Mesh::OptimizeIndexedTriangles() {
     for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
-        SubMesh *subMesh = surfaces[surfaceIndex]->subMesh;
-        subMesh->OptimizeIndexedTriangles();
+        MeshSurf *surf = surfaces[surfaceIndex];
+        surf->subMesh->OptimizeIndexedTriangles();
+
+        for (int lod = 1; lod < numLODs; lod++) {
+            if (surf->lodSubMeshes[lod - 1]) {
+                surf->lodSubMeshes[lod - 1]->OptimizeIndexedTriangles();
+            }
+        }
     }
 }
 
+bool Mesh::BuildClusters() {
+    if (isInstantiated) {
+        BE_WARNLOG("Mesh::BuildClusters: clusters should be built for the reference mesh '%s'\n", hashName.c_str());
+        return false;
+    }
+
+    if (numJoints > 0) {
+        BE_WARNLOG("Mesh::BuildClusters: skinned mesh '%s' is not supported\n", hashName.c_str());
+        return false;
+    }
+
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        surfaces[surfaceIndex]->subMesh->BuildClusters();
+    }
+
+    // Instantiated meshes share the index buffer of the reference mesh.
+    for (int i = 0; i < instantiatedMeshes.Count(); i++) {
+        instantiatedMeshes[i]->Reinstantiate();
+    }
+
+    return true;
+}
+
 void Mesh::Voxelize() {
 }
 
@@ -381,6 +512,16 @@ bool Mesh::Load(const char *filename) {
     return true;
 }
 
+bool Mesh::LoadFromMemory(const void *data, size_t size) {
+    Purge();
+
+    // Sub meshes point to the bmesh data, so it is kept in the mesh.
+    fileData = (byte *)Mem_Alloc16(size);
+    memcpy(fileData, data, size);
+
+    return LoadBinaryMeshData(fileData, size, hashName);
+}
+
 void Mesh::Write(const char *filename) {
     WriteBinaryMesh(filename);
 }
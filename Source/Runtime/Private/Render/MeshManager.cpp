@@ -243,45 +243,9 @@ Mesh *MeshManager::GetMesh(const char *hashName) {
 }
 
 Mesh *MeshManager::CreateCombinedMesh(const char *hashName, const Array<BatchSubMesh> &batchSubMeshes) {
-    // Counts total verts/indices for combined mesh.
-    int numTotalVerts = 0;
-    int numTotalIndexes = 0;
-
-    for (int subMeshIndex = 0; subMeshIndex < batchSubMeshes.Count(); subMeshIndex++) {
-        const SubMesh *subMesh = batchSubMeshes[subMeshIndex].subMesh;
-
-        numTotalVerts += subMesh->NumVerts();
-        numTotalIndexes += subMesh->NumIndexes();
-    }
-
     // Allocates a combiend mesh.
     Mesh *mesh = AllocMesh(hashName);
-    MeshSurf *surf = mesh->AllocSurface(numTotalVerts, numTotalIndexes);
-    mesh->surfaces.Append(surf);
-
-    VertexGenericLit *dstVertPtr = surf->subMesh->verts;
-    TriIndex *dstIndexPtr = surf->subMesh->indexes;
-    int baseVertex = 0;
-
-    for (int subMeshIndex = 0; subMeshIndex < batchSubMeshes.Count(); subMeshIndex++) {
-        const SubMesh *srcSubMesh = batchSubMeshes[subMeshIndex].subMesh;
-
-        for (int i = 0; i < srcSubMesh->numVerts; i++) {
-            *dstVertPtr = srcSubMesh->verts[i];
-
-            dstVertPtr->Transform(batchSubMeshes[subMeshIndex].localTransform);
-            dstVertPtr++;
-        }
-
-        for (int i = 0; i < srcSubMesh->numIndexes; i++) {
-            *dstIndexPtr = srcSubMesh->indexes[i] + baseVertex;
-            dstIndexPtr++;
-        }
-
-        baseVertex += srcSubMesh->numVerts;
-    }
-
-    mesh->FinishSurfaces(Mesh::FinishFlag::ComputeAABB);
+    mesh->CombineSubMeshes(batchSubMeshes, Mesh::FinishFlag::ComputeAABB);
 
     return mesh;
 }
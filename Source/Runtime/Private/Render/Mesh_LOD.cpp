@@ -0,0 +1,420 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "SIMD/SIMD.h"
+#include "Core/Heap.h"
+
+BE_NAMESPACE_BEGIN
+
+// Symmetric 4x4 matrix of the plane distance error (Garland-Heckbert).
+struct Quadric {
+    double                  a2, ab, ac, ad;
+    double                  b2, bc, bd;
+    double                  c2, cd;
+    double                  d2;
+};
+
+static void QuadricFromTriangle(const Vec3 &p0, const Vec3 &p1, const Vec3 &p2, Quadric &q) {
+    Vec3 n = (p1 - p0).Cross(p2 - p0);
+    float area = n.Normalize() * 0.5f;
+
+    double a = n.x;
+    double b = n.y;
+    double c = n.z;
+    double d = -n.Dot(p0);
+    // Weighted by area to be independent of the tessellation.
+    double w = area;
+
+    q.a2 = w * a * a; q.ab = w * a * b; q.ac = w * a * c; q.ad = w * a * d;
+    q.b2 = w * b * b; q.bc = w * b * c; q.bd = w * b * d;
+    q.c2 = w * c * c; q.cd = w * c * d;
+    q.d2 = w * d * d;
+}
+
+static void QuadricAdd(Quadric &q, const Quadric &other) {
+    q.a2 += other.a2; q.ab += other.ab; q.ac += other.ac; q.ad += other.ad;
+    q.b2 += other.b2; q.bc += other.bc; q.bd += other.bd;
+    q.c2 += other.c2; q.cd += other.cd;
+    q.d2 += other.d2;
+}
+
+static double QuadricError(const Quadric &q, const Vec3 &p) {
+    double x = p.x;
+    double y = p.y;
+    double z = p.z;
+
+    return q.a2 * x * x + 2 * q.ab * x * y + 2 * q.ac * x * z + 2 * q.ad * x +
+        q.b2 * y * y + 2 * q.bc * y * z + 2 * q.bd * y +
+        q.c2 * z * z + 2 * q.cd * z +
+        q.d2;
+}
+
+struct EdgeCollapse {
+    TriIndex                v0;                 ///< vertex to be removed
+    TriIndex                v1;                 ///< vertex to be kept
+    double                  error;
+};
+
+static void BuildVertexTriangles(int numVerts, const TriIndex *indexes, int numIndexes, Array<int32_t> &offsets, Array<int32_t> &triangles) {
+    offsets.SetCount(numVerts + 1, false);
+    memset(offsets.Ptr(), 0, offsets.MemoryUsed());
+
+    for (int i = 0; i < numIndexes; i++) {
+        offsets[indexes[i] + 1]++;
+    }
+    for (int i = 0; i < numVerts; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    triangles.SetCount(numIndexes, false);
+
+    Array<int32_t> fill;
+    fill.SetCount(numVerts);
+    memcpy(fill.Ptr(), offsets.Ptr(), sizeof(int32_t) * numVerts);
+
+    for (int i = 0; i < numIndexes; i++) {
+        triangles[fill[indexes[i]]++] = i / 3;
+    }
+}
+
+// Tests if moving v0 to the position of v1 flips or folds any remaining triangle around v0.
+static bool IsFlippedCollapse(const VertexGenericLit *verts, const TriIndex *indexes, const int32_t *vertTris, int numVertTris, TriIndex v0, TriIndex v1) {
+    const Vec3 &p1 = verts[v1].xyz;
+
+    for (int i = 0; i < numVertTris; i++) {
+        const TriIndex *tri = &indexes[vertTris[i] * 3];
+
+        // Skip degenerated or collapsing triangles.
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]) {
+            continue;
+        }
+        if (tri[0] == v1 || tri[1] == v1 || tri[2] == v1) {
+            continue;
+        }
+
+        int k = tri[0] == v0 ? 0 : (tri[1] == v0 ? 1 : 2);
+        const Vec3 &a = verts[tri[(k + 1) % 3]].xyz;
+        const Vec3 &b = verts[tri[(k + 2) % 3]].xyz;
+        const Vec3 &p0 = verts[v0].xyz;
+
+        Vec3 oldNormal = (a - p0).Cross(b - p0);
+        Vec3 newNormal = (a - p1).Cross(b - p1);
+
+        // Reject large rotation as well to avoid folding over the several collapses.
+        if (oldNormal.Dot(newNormal) <= 0.25f * oldNormal.Length() * newNormal.Length()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Simplifies indexed triangles by the half edge collapses ordered by the quadric error.
+// Vertices are not moved, so the attributes of the kept vertices are preserved.
+// Vertices on the open borders and the attribute seams are locked to avoid cracks.
+// Returns number of the written indexes to dstIndexes, which should be large as numIndexes.
+static int SimplifyIndexedTriangles(const VertexGenericLit *verts, int numVerts, const TriIndex *indexes, int numIndexes, int targetNumIndexes, TriIndex *dstIndexes) {
+    memcpy(dstIndexes, indexes, sizeof(TriIndex) * numIndexes);
+
+    if (numIndexes <= targetNumIndexes) {
+        return numIndexes;
+    }
+
+    // Find border edges which are used by only one triangle.
+    // Attribute seams are borders in this topology since split vertices are not shared.
+    Array<uint64_t> edgeKeys;
+    edgeKeys.SetCount(numIndexes);
+    for (int i = 0; i < numIndexes; i += 3) {
+        for (int k = 0; k < 3; k++) {
+            uint32_t a = indexes[i + k];
+            uint32_t b = indexes[i + (k + 1) % 3];
+            edgeKeys[i + k] = a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+        }
+    }
+    edgeKeys.Sort([](const uint64_t &a, const uint64_t &b) { return a < b; });
+
+    Array<bool> locked;
+    locked.SetCount(numVerts);
+    memset(locked.Ptr(), 0, locked.MemoryUsed());
+
+    for (int i = 0; i < edgeKeys.Count(); ) {
+        int j = i + 1;
+        while (j < edgeKeys.Count() && edgeKeys[j] == edgeKeys[i]) {
+            j++;
+        }
+        if (j - i == 1) {
+            locked[(int32_t)(edgeKeys[i] >> 32)] = true;
+            locked[(int32_t)(edgeKeys[i] & 0xFFFFFFFF)] = true;
+        }
+        i = j;
+    }
+
+    // Vertex quadrics are the sum of the adjacent triangle quadrics.
+    Array<Quadric> quadrics;
+    quadrics.SetCount(numVerts);
+    memset(quadrics.Ptr(), 0, quadrics.MemoryUsed());
+
+    for (int i = 0; i < numIndexes; i += 3) {
+        Quadric q;
+        QuadricFromTriangle(verts[indexes[i]].xyz, verts[indexes[i + 1]].xyz, verts[indexes[i + 2]].xyz, q);
+
+        QuadricAdd(quadrics[indexes[i + 0]], q);
+        QuadricAdd(quadrics[indexes[i + 1]], q);
+        QuadricAdd(quadrics[indexes[i + 2]], q);
+    }
+
+    Array<int32_t> vertTriOffsets;
+    Array<int32_t> vertTris;
+    Array<EdgeCollapse> collapses;
+    collapses.Reserve(numIndexes * 2);
+    Array<bool> touched;
+    touched.SetCount(numVerts);
+
+    int currentNumIndexes = numIndexes;
+
+    while (currentNumIndexes > targetNumIndexes) {
+        BuildVertexTriangles(numVerts, dstIndexes, currentNumIndexes, vertTriOffsets, vertTris);
+
+        // Collect collapse candidates of all the half edges.
+        collapses.SetCount(0, false);
+        for (int i = 0; i < currentNumIndexes; i += 3) {
+            for (int k = 0; k < 3; k++) {
+                TriIndex v0 = dstIndexes[i + k];
+                TriIndex v1 = dstIndexes[i + (k + 1) % 3];
+
+                for (int n = 0; n < 2; n++) {
+                    if (!locked[v0]) {
+                        Quadric q = quadrics[v0];
+                        QuadricAdd(q, quadrics[v1]);
+
+                        EdgeCollapse &collapse = collapses.Alloc();
+                        collapse.v0 = v0;
+                        collapse.v1 = v1;
+                        collapse.error = QuadricError(q, verts[v1].xyz);
+                    }
+                    Swap(v0, v1);
+                }
+            }
+        }
+
+        if (collapses.Count() == 0) {
+            break;
+        }
+
+        collapses.Sort([](const EdgeCollapse &a, const EdgeCollapse &b) {
+            return a.error < b.error;
+        });
+
+        memset(touched.Ptr(), 0, touched.MemoryUsed());
+
+        // Each collapse removes two triangles in general.
+        int maxCollapses = Max((currentNumIndexes - targetNumIndexes) / 6, 1);
+        int numCollapses = 0;
+
+        for (int i = 0; i < collapses.Count() && numCollapses < maxCollapses; i++) {
+            const EdgeCollapse &collapse = collapses[i];
+
+            // Don't collapse vertices which adjacent triangles are modified in this pass.
+            if (touched[collapse.v0] || touched[collapse.v1]) {
+                continue;
+            }
+
+            const int32_t *v0Tris = &vertTris[vertTriOffsets[collapse.v0]];
+            int numV0Tris = vertTriOffsets[collapse.v0 + 1] - vertTriOffsets[collapse.v0];
+
+            if (IsFlippedCollapse(verts, dstIndexes, v0Tris, numV0Tris, collapse.v0, collapse.v1)) {
+                continue;
+            }
+
+            for (int j = 0; j < numV0Tris; j++) {
+                TriIndex *tri = &dstIndexes[v0Tris[j] * 3];
+                for (int k = 0; k < 3; k++) {
+                    if (tri[k] == collapse.v0) {
+                        tri[k] = collapse.v1;
+                    }
+                    touched[tri[k]] = true;
+                }
+            }
+
+            QuadricAdd(quadrics[collapse.v1], quadrics[collapse.v0]);
+
+            touched[collapse.v0] = true;
+            touched[collapse.v1] = true;
+            numCollapses++;
+        }
+
+        if (numCollapses == 0) {
+            break;
+        }
+
+        // Remove degenerated triangles.
+        int writeIndex = 0;
+        for (int i = 0; i < currentNumIndexes; i += 3) {
+            TriIndex a = dstIndexes[i];
+            TriIndex b = dstIndexes[i + 1];
+            TriIndex c = dstIndexes[i + 2];
+
+            if (a != b && b != c && c != a) {
+                dstIndexes[writeIndex++] = a;
+                dstIndexes[writeIndex++] = b;
+                dstIndexes[writeIndex++] = c;
+            }
+        }
+        currentNumIndexes = writeIndex;
+    }
+
+    return currentNumIndexes;
+}
+
+SubMesh *Mesh::AllocLODSubMesh(const SubMesh *srcSubMesh, int numIndexes, const TriIndex *indexes) const {
+    // Remap to the vertices used by the given indexes.
+    Array<int32_t> vertexRemap;
+    vertexRemap.SetCount(srcSubMesh->numVerts);
+    memset(vertexRemap.Ptr(), -1, vertexRemap.MemoryUsed());
+
+    int numVerts = 0;
+    for (int i = 0; i < numIndexes; i++) {
+        if (vertexRemap[indexes[i]] < 0) {
+            vertexRemap[indexes[i]] = numVerts++;
+        }
+    }
+
+    SubMesh *subMesh = new SubMesh;
+    subMesh->AllocSubMesh(numVerts, numIndexes);
+
+    for (int i = 0; i < srcSubMesh->numVerts; i++) {
+        if (vertexRemap[i] >= 0) {
+            subMesh->verts[vertexRemap[i]] = srcSubMesh->verts[i];
+        }
+    }
+
+    for (int i = 0; i < numIndexes; i++) {
+        subMesh->indexes[i] = vertexRemap[indexes[i]];
+    }
+
+    subMesh->normalsCalculated = srcSubMesh->normalsCalculated;
+    subMesh->tangentsCalculated = srcSubMesh->tangentsCalculated;
+    subMesh->useCompactVertex = srcSubMesh->useCompactVertex;
+
+    // Simplified triangles are in the source order.
+    subMesh->OptimizeIndexedTriangles();
+    subMesh->ComputeAABB();
+
+    return subMesh;
+}
+
+bool Mesh::GenerateLODs(int numLODs, float triangleRatio) {
+    if (isInstantiated) {
+        BE_WARNLOG("Mesh::GenerateLODs: LODs should be generated for the reference mesh '%s'\n", hashName.c_str());
+        return false;
+    }
+
+    // LODs are used only for static meshes.
+    if (numJoints > 0) {
+        BE_WARNLOG("Mesh::GenerateLODs: skinned mesh '%s' is not supported\n", hashName.c_str());
+        return false;
+    }
+
+    ClearLODs();
+
+    Clamp(numLODs, 1, (int)MeshSurf::MaxLODs);
+    Clamp(triangleRatio, 0.01f, 1.0f);
+
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        MeshSurf *surf = surfaces[surfaceIndex];
+
+        for (int lodIndex = 1; lodIndex < numLODs; lodIndex++) {
+            // Simplify from the previous LOD.
+            const SubMesh *srcSubMesh = surf->GetLODSubMesh(lodIndex - 1);
+
+            int targetNumIndexes = Max((int)(srcSubMesh->numIndexes / 3 * triangleRatio), 1) * 3;
+
+            TriIndex *lodIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * srcSubMesh->numIndexes);
+            int numLODIndexes = SimplifyIndexedTriangles(srcSubMesh->verts, srcSubMesh->numVerts, srcSubMesh->indexes, srcSubMesh->numIndexes, targetNumIndexes, lodIndexes);
+
+            surf->lodSubMeshes[lodIndex - 1] = AllocLODSubMesh(srcSubMesh, numLODIndexes, lodIndexes);
+
+            Mem_AlignedFree(lodIndexes);
+        }
+    }
+
+    this->numLODs = numLODs;
+
+    for (int i = 0; i < instantiatedMeshes.Count(); i++) {
+        instantiatedMeshes[i]->Reinstantiate();
+    }
+
+    return true;
+}
+
+bool Mesh::SetLODMesh(int lod, const Mesh *lodMesh) {
+    if (isInstantiated) {
+        BE_WARNLOG("Mesh::SetLODMesh: LODs should be set for the reference mesh '%s'\n", hashName.c_str());
+        return false;
+    }
+
+    if (lod < 1 || lod >= MeshSurf::MaxLODs || lod > numLODs) {
+        BE_WARNLOG("Mesh::SetLODMesh: invalid LOD %i for '%s'\n", lod, hashName.c_str());
+        return false;
+    }
+
+    if (lodMesh->NumSurfaces() != surfaces.Count()) {
+        BE_WARNLOG("Mesh::SetLODMesh: '%s' has different number of surfaces with '%s'\n", lodMesh->hashName.c_str(), hashName.c_str());
+        return false;
+    }
+
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        MeshSurf *surf = surfaces[surfaceIndex];
+        const SubMesh *srcSubMesh = lodMesh->surfaces[surfaceIndex]->subMesh;
+
+        SAFE_DELETE(surf->lodSubMeshes[lod - 1]);
+
+        surf->lodSubMeshes[lod - 1] = AllocLODSubMesh(srcSubMesh, srcSubMesh->numIndexes, srcSubMesh->indexes);
+        surf->lodSubMeshes[lod - 1]->useCompactVertex = useCompactVertices;
+    }
+
+    numLODs = Max(numLODs, lod + 1);
+
+    for (int i = 0; i < instantiatedMeshes.Count(); i++) {
+        instantiatedMeshes[i]->Reinstantiate();
+    }
+
+    return true;
+}
+
+void Mesh::ClearLODs() {
+    if (numLODs <= 1) {
+        return;
+    }
+
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        MeshSurf *surf = surfaces[surfaceIndex];
+
+        for (int lodIndex = 0; lodIndex < COUNT_OF(surf->lodSubMeshes); lodIndex++) {
+            SAFE_DELETE(surf->lodSubMeshes[lodIndex]);
+        }
+    }
+
+    numLODs = 1;
+
+    if (!isInstantiated) {
+        for (int i = 0; i < instantiatedMeshes.Count(); i++) {
+            instantiatedMeshes[i]->Reinstantiate();
+        }
+    }
+}
+
+BE_NAMESPACE_END
@@ -15,27 +15,111 @@
 #include "Precompiled.h"
 #include "Render/Render.h"
 #include "BModel.h"
+#include "SIMD/SIMD.h"
 #include "Core/Heap.h"
 #include "IO/FileSystem.h"
+#include "Platform/PlatformFile.h"
 
 BE_NAMESPACE_BEGIN
 
+const byte *Mesh::OpenMeshData(const char *filename, size_t &size) {
+    // Map the file directly if it exists in the file system, otherwise load it through the search paths (e.g. pak archives).
+    Str path = FileSystem::IsAbsolutePath(filename) ? Str(filename) : fileSystem.ToAbsolutePath(filename);
+    if (fileSystem.FileExists(path)) {
+        PlatformFileMapping *mapping = (PlatformFileMapping *)PlatformFileMapping::OpenFileRead(path.c_str());
+        if (mapping) {
+            fileMapping = mapping;
+            size = mapping->GetSize();
+            return (const byte *)mapping->GetData();
+        }
+    }
+
+    File *file = fileSystem.OpenFileRead(filename, true);
+    if (!file) {
+        return nullptr;
+    }
+
+    size = file->Size();
+
+    // Stored entry in the mapped package is used without copy if the streams stay aligned.
+    const byte *data = (const byte *)file->GetMappedData();
+    if (data && IsAligned((uintptr_t)data, BMESH_STREAM_ALIGNMENT)) {
+        mappedFile = file;
+        return data;
+    }
+
+    fileData = (byte *)Mem_Alloc16(size);
+    if (file->Read(fileData, size) != size) {
+        fileSystem.CloseFile(file);
+        CloseMeshData();
+        return nullptr;
+    }
+    fileSystem.CloseFile(file);
+
+    return fileData;
+}
+
+void Mesh::CloseMeshData() {
+    if (fileMapping) {
+        delete (PlatformFileMapping *)fileMapping;
+        fileMapping = nullptr;
+    }
+    if (mappedFile) {
+        fileSystem.CloseFile(mappedFile);
+        mappedFile = nullptr;
+    }
+    if (fileData) {
+        Mem_AlignedFree(fileData);
+        fileData = nullptr;
+    }
+}
+
 bool Mesh::LoadBinaryMesh(const char *filename) {
-    byte *data;
-    fileSystem.LoadFile(filename, true, (void **)&data);
+    size_t size;
+    const byte *data = OpenMeshData(filename, size);
     if (!data) {
         return false;
     }
- 
+
+    return LoadBinaryMeshData(data, size, filename);
+}
+
+bool Mesh::LoadBinaryMeshData(const byte *data, size_t size, const char *filename) {
     const BMeshHeader *bMeshHeader = (const BMeshHeader *)data;
-    byte *ptr = data + sizeof(BMeshHeader);
     
-    if (bMeshHeader->ident != BMESH_IDENT) {
+    if (size < sizeof(BMeshHeader) || bMeshHeader->ident != BMESH_IDENT) {
         BE_WARNLOG("Mesh::LoadBinaryMesh: bad format %s\n", filename);
-        fileSystem.FreeFile(data);
+        CloseMeshData();
         return false;
     }
 
+    bool ret;
+    if (bMeshHeader->version == 1) {
+        ret = LoadBinaryMeshV1(data, size);
+
+        // Version 1 is copied to the sub meshes.
+        CloseMeshData();
+    } else if (bMeshHeader->version == 2) {
+        ret = LoadBinaryMeshV2(data, size);
+    } else {
+        BE_WARNLOG("Mesh::LoadBinaryMesh: unsupported version %i %s\n", bMeshHeader->version, filename);
+        ret = false;
+    }
+
+    if (!ret) {
+        BE_WARNLOG("Mesh::LoadBinaryMesh: failed to load %s\n", filename);
+        Purge();
+        return false;
+    }
+
+    FinishSurfaces();
+
+    return true;
+}
+
+bool Mesh::LoadBinaryMeshV1(const byte *data, size_t size) {
+    const BMeshHeader *bMeshHeader = (const BMeshHeader *)data;
+    const byte *ptr = data + sizeof(BMeshHeader);
     numJoints = bMeshHeader->numJoints;
     if (numJoints > 0) {
         joints = new Joint[numJoints];
@@ -159,13 +243,273 @@ bool Mesh::LoadBinaryMesh(const char *filename) {
         ptr += AlignUp(offset, 8) - offset;
     }
 
-    fileSystem.FreeFile(data);
+    return true;
+}
 
-    FinishSurfaces();
+
+bool Mesh::LoadBinaryMeshV2(const byte *data, size_t size) {
+    const BMeshHeader *bMeshHeader = (const BMeshHeader *)data;
+    size_t offset = sizeof(BMeshHeader);
+
+    if (offset + sizeof(BMeshLayout) > size) {
+        return false;
+    }
+
+    const BMeshLayout *bMeshLayout = (const BMeshLayout *)(data + offset);
+    offset += sizeof(BMeshLayout);
+
+#ifdef COMPRESSED_VERTEX_NORMAL_TANGENTS
+    const uint32_t layoutFlags = BMeshLayoutFlag::CompressedNormals;
+#else
+    const uint32_t layoutFlags = 0;
+#endif
+
+    // Streams are used as they are, so the runtime vertex formats must match.
+    if (bMeshLayout->vertexSize != sizeof(VertexGenericLit) || bMeshLayout->weightSize4 != sizeof(VertexWeight4) ||
+        bMeshLayout->weightSize8 != sizeof(VertexWeight8) || (bMeshLayout->flags & BMeshLayoutFlag::CompressedNormals) != layoutFlags) {
+        BE_WARNLOG("Mesh::LoadBinaryMeshV2: vertex layout mismatch, re-import the mesh\n");
+        return false;
+    }
+
+    if (offset + bMeshHeader->numJoints * sizeof(BJoint) > size) {
+        return false;
+    }
+
+    numJoints = bMeshHeader->numJoints;
+    if (numJoints > 0) {
+        joints = new Joint[numJoints];
+
+        // --- joints ---
+        for (int jointIndex = 0; jointIndex < numJoints; jointIndex++) {
+            const BJoint *bJoint = (const BJoint *)(data + offset);
+
+            joints[jointIndex].name = bJoint->name;
+            joints[jointIndex].parent = bJoint->parentIndex >= 0 && bJoint->parentIndex < numJoints ? &this->joints[bJoint->parentIndex] : nullptr;
+
+            offset += sizeof(BJoint);
+        }
+    }
+
+    aabb = AABB(bMeshHeader->aabbMin, bMeshHeader->aabbMax);
+
+    useCompactVertices = !!(bMeshLayout->flags & BMeshLayoutFlag::CompactVertices);
+
+    // --- surfaces ---
+    for (int surfaceIndex = 0; surfaceIndex < bMeshHeader->numSurfs; surfaceIndex++) {
+        int32_t materialIndex;
+        SubMesh *subMesh = LoadBinarySubMeshV2(data, size, offset, materialIndex);
+        if (!subMesh) {
+            return false;
+        }
+
+        MeshSurf *meshSurf = new MeshSurf;
+        meshSurf->subMesh = subMesh;
+        meshSurf->materialIndex = materialIndex;
+        surfaces.Append(meshSurf);
+    }
+
+    // --- LODs ---
+    if (bMeshLayout->flags & BMeshLayoutFlag::LODs) {
+        if (offset + sizeof(BMeshLODs) > size) {
+            return false;
+        }
+
+        const BMeshLODs *bMeshLODs = (const BMeshLODs *)(data + offset);
+        offset += sizeof(BMeshLODs);
+
+        if (bMeshLODs->numLODs < 1 || bMeshLODs->numLODs > MeshSurf::MaxLODs) {
+            return false;
+        }
+
+        for (int lodIndex = 1; lodIndex < bMeshLODs->numLODs; lodIndex++) {
+            for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+                int32_t materialIndex;
+                SubMesh *subMesh = LoadBinarySubMeshV2(data, size, offset, materialIndex);
+                if (!subMesh) {
+                    return false;
+                }
+
+                surfaces[surfaceIndex]->lodSubMeshes[lodIndex - 1] = subMesh;
+            }
+        }
+
+        numLODs = bMeshLODs->numLODs;
+    }
+
+    // --- clusters ---
+    if (bMeshLayout->flags & BMeshLayoutFlag::Clusters) {
+        for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+            if (offset + sizeof(BMeshClusters) > size) {
+                return false;
+            }
+
+            const BMeshClusters *bMeshClusters = (const BMeshClusters *)(data + offset);
+            offset += sizeof(BMeshClusters);
+
+            if (offset + bMeshClusters->numClusters * sizeof(BMeshCluster) > size) {
+                return false;
+            }
+
+            SubMesh *subMesh = surfaces[surfaceIndex]->subMesh;
+
+            if (bMeshClusters->numClusters > 0) {
+                subMesh->numClusters = bMeshClusters->numClusters;
+                subMesh->clusters = (MeshCluster *)Mem_Alloc16(sizeof(MeshCluster) * subMesh->numClusters);
+
+                for (int clusterIndex = 0; clusterIndex < subMesh->numClusters; clusterIndex++) {
+                    const BMeshCluster *bMeshCluster = (const BMeshCluster *)(data + offset);
+                    offset += sizeof(BMeshCluster);
+
+                    if (bMeshCluster->firstIndex < 0 || bMeshCluster->numIndexes < 0 || bMeshCluster->firstIndex + bMeshCluster->numIndexes > subMesh->numIndexes) {
+                        return false;
+                    }
+
+                    MeshCluster &cluster = subMesh->clusters[clusterIndex];
+                    cluster.firstIndex = bMeshCluster->firstIndex;
+                    cluster.numIndexes = bMeshCluster->numIndexes;
+                    cluster.center = bMeshCluster->center;
+                    cluster.radius = bMeshCluster->radius;
+                    cluster.coneAxis = bMeshCluster->coneAxis;
+                    cluster.coneCutoff = bMeshCluster->coneCutoff;
+                    cluster.aabb = AABB(bMeshCluster->aabbMin, bMeshCluster->aabbMax);
+                }
+            }
+        }
+    }
+
+    // Nothing points to the file data after conversion.
+    bool hasExternalSurfaces = false;
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        const MeshSurf *surf = surfaces[surfaceIndex];
+        if (surf->subMesh->externalData) {
+            hasExternalSurfaces = true;
+            break;
+        }
+        for (int lodIndex = 0; lodIndex < COUNT_OF(surf->lodSubMeshes); lodIndex++) {
+            if (surf->lodSubMeshes[lodIndex] && surf->lodSubMeshes[lodIndex]->externalData) {
+                hasExternalSurfaces = true;
+            }
+        }
+    }
+    if (!hasExternalSurfaces) {
+        CloseMeshData();
+    }
 
     return true;
 }
 
+SubMesh *Mesh::LoadBinarySubMeshV2(const byte *data, size_t size, size_t &offset, int32_t &materialIndex) const {
+    if (offset + sizeof(BMeshSurf) > size) {
+        return nullptr;
+    }
+
+    const BMeshSurf *bMeshSurf = (const BMeshSurf *)(data + offset);
+    offset += sizeof(BMeshSurf);
+
+    int vertexWeightSize = 0;
+    int gpuSkinningVersionIndex = 0;
+    if (bMeshSurf->maxWeights == 1) {
+        vertexWeightSize = sizeof(VertexWeight1);
+        gpuSkinningVersionIndex = 0;
+    } else if (bMeshSurf->maxWeights == 4) {
+        vertexWeightSize = sizeof(VertexWeight4);
+        gpuSkinningVersionIndex = 1;
+    } else if (bMeshSurf->maxWeights == 8) {
+        vertexWeightSize = sizeof(VertexWeight8);
+        gpuSkinningVersionIndex = 2;
+    } else if (bMeshSurf->maxWeights != 0) {
+        return nullptr;
+    }
+
+    size_t vertsOffset = AlignUp(offset, BMESH_STREAM_ALIGNMENT);
+    size_t weightsOffset = AlignUp(vertsOffset + bMeshSurf->numVerts * sizeof(VertexGenericLit), BMESH_STREAM_ALIGNMENT);
+    size_t indexesOffset = AlignUp(weightsOffset + bMeshSurf->numVerts * vertexWeightSize, BMESH_STREAM_ALIGNMENT);
+    size_t endOffset = AlignUp(indexesOffset + bMeshSurf->numIndexes * bMeshSurf->indexSize, BMESH_STREAM_ALIGNMENT);
+
+    if (endOffset > size) {
+        return nullptr;
+    }
+
+    VertexGenericLit *verts = (VertexGenericLit *)(data + vertsOffset);
+
+    SubMesh *subMesh = new SubMesh;
+    if (bMeshSurf->indexSize == sizeof(TriIndex)) {
+        // Sub mesh points to the file data without copy.
+        subMesh->AllocExternalSubMesh(bMeshSurf->numVerts, verts, bMeshSurf->numIndexes, (TriIndex *)(data + indexesOffset));
+        subMesh->vertWeights = vertexWeightSize > 0 ? (void *)(data + weightsOffset) : nullptr;
+    } else {
+        // Index size differs from the runtime TriIndex, so convert to the owned memory.
+        subMesh->AllocSubMesh(bMeshSurf->numVerts, bMeshSurf->numIndexes);
+        simdProcessor->Memcpy(subMesh->verts, verts, bMeshSurf->numVerts * sizeof(VertexGenericLit));
+
+        if (vertexWeightSize > 0) {
+            subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
+            simdProcessor->Memcpy(subMesh->vertWeights, data + weightsOffset, vertexWeightSize * bMeshSurf->numVerts);
+        }
+
+        if (bMeshSurf->indexSize == sizeof(uint32_t)) {
+            const uint32_t *srcIndexes = (const uint32_t *)(data + indexesOffset);
+            for (int i = 0; i < bMeshSurf->numIndexes; i++) {
+                subMesh->indexes[i] = (TriIndex)srcIndexes[i];
+            }
+        } else if (bMeshSurf->indexSize == sizeof(uint16_t)) {
+            const uint16_t *srcIndexes = (const uint16_t *)(data + indexesOffset);
+            for (int i = 0; i < bMeshSurf->numIndexes; i++) {
+                subMesh->indexes[i] = srcIndexes[i];
+            }
+        } else {
+            delete subMesh;
+            return nullptr;
+        }
+    }
+
+    subMesh->aabb = AABB(bMeshSurf->aabbMin, bMeshSurf->aabbMax);
+    subMesh->gpuSkinningVersionIndex = gpuSkinningVersionIndex;
+    subMesh->useCompactVertex = useCompactVertices;
+
+    materialIndex = bMeshSurf->materialIndex;
+
+    offset = endOffset;
+
+    return subMesh;
+}
+
+static void WriteAlignmentPadding(File *fp, int alignment) {
+    static const byte dummy[BMESH_STREAM_ALIGNMENT] = { 0, };
+    int offset = fp->Tell();
+    int dummyBytes = AlignUp(offset, alignment) - offset;
+    fp->Write(dummy, dummyBytes);
+}
+
+void Mesh::WriteBinarySubMesh(File *fp, const SubMesh *subMesh, int32_t materialIndex) const {
+    BMeshSurf bMeshSurf;
+    bMeshSurf.materialIndex     = materialIndex;
+    bMeshSurf.numVerts          = subMesh->numVerts;
+    bMeshSurf.numIndexes        = subMesh->numIndexes;
+    bMeshSurf.indexSize         = sizeof(TriIndex);
+    bMeshSurf.maxWeights        = subMesh->MaxVertexWeights();
+    bMeshSurf.aabbMin           = subMesh->GetAABB()[0];
+    bMeshSurf.aabbMax           = subMesh->GetAABB()[1];
+    fp->Write(&bMeshSurf, sizeof(bMeshSurf));
+
+    // Streams are written in the runtime formats, aligned for the direct use from the mapped file.
+    // --- vertexes ---
+    WriteAlignmentPadding(fp, BMESH_STREAM_ALIGNMENT);
+    fp->Write(subMesh->verts, sizeof(VertexGenericLit) * subMesh->numVerts);
+
+    // --- vertex weights ---
+    WriteAlignmentPadding(fp, BMESH_STREAM_ALIGNMENT);
+    if (bMeshSurf.maxWeights > 0) {
+        fp->Write(subMesh->vertWeights, subMesh->VertexWeightSize() * subMesh->numVerts);
+    }
+
+    // --- indexes ---
+    WriteAlignmentPadding(fp, BMESH_STREAM_ALIGNMENT);
+    fp->Write(subMesh->indexes, sizeof(TriIndex) * subMesh->numIndexes);
+
+    WriteAlignmentPadding(fp, BMESH_STREAM_ALIGNMENT);
+}
+
 void Mesh::WriteBinaryMesh(const char *filename) {
     File *fp = fileSystem.OpenFile(filename, File::Mode::Write);
     if (!fp) {
@@ -182,6 +526,29 @@ void Mesh::WriteBinaryMesh(const char *filename) {
     bMeshHeader.aabbMax = GetAABB()[1];
     fp->Write(&bMeshHeader, sizeof(bMeshHeader));
 
+    BMeshLayout bMeshLayout;
+    bMeshLayout.vertexSize = sizeof(VertexGenericLit);
+    bMeshLayout.weightSize4 = sizeof(VertexWeight4);
+    bMeshLayout.weightSize8 = sizeof(VertexWeight8);
+#ifdef COMPRESSED_VERTEX_NORMAL_TANGENTS
+    bMeshLayout.flags = BMeshLayoutFlag::CompressedNormals;
+#else
+    bMeshLayout.flags = 0;
+#endif
+    if (useCompactVertices) {
+        bMeshLayout.flags |= BMeshLayoutFlag::CompactVertices;
+    }
+    if (numLODs > 1) {
+        bMeshLayout.flags |= BMeshLayoutFlag::LODs;
+    }
+    for (int surfaceIndex = 0; surfaceIndex < NumSurfaces(); surfaceIndex++) {
+        if (GetSurface(surfaceIndex)->subMesh->numClusters > 0) {
+            bMeshLayout.flags |= BMeshLayoutFlag::Clusters;
+            break;
+        }
+    }
+    fp->Write(&bMeshLayout, sizeof(bMeshLayout));
+
     if (bMeshHeader.numJoints > 0) {
         // --- joints ---
         for (int jointIndexes = 0; jointIndexes < bMeshHeader.numJoints; jointIndexes++) {
@@ -197,92 +564,51 @@ void Mesh::WriteBinaryMesh(const char *filename) {
     // --- surfaces ---
     for (int surfaceIndex = 0; surfaceIndex < bMeshHeader.numSurfs; surfaceIndex++) {
         const MeshSurf *meshSurf = GetSurface(surfaceIndex);
-        const SubMesh *subMesh = meshSurf->subMesh;
-
-        BMeshSurf bMeshSurf;
-        bMeshSurf.materialIndex     = meshSurf->materialIndex;
-        bMeshSurf.numVerts          = subMesh->numVerts;
-        bMeshSurf.numIndexes        = subMesh->numIndexes;
-        bMeshSurf.indexSize         = subMesh->numIndexes < BIT(16) ? sizeof(uint16_t) : sizeof(uint32_t);
-        bMeshSurf.maxWeights        = subMesh->MaxVertexWeights();
-        bMeshSurf.aabbMin           = subMesh->GetAABB()[0];
-        bMeshSurf.aabbMax           = subMesh->GetAABB()[1];
-        fp->Write(&bMeshSurf, sizeof(bMeshSurf));
 
-        // --- vertexes ---
-        for (int i = 0; i < subMesh->numVerts; i++) {
-            const VertexGenericLit *v = &subMesh->verts[i];
-
-            BMeshVert bMeshVert;
-            bMeshVert.position = v->GetPosition();
-            bMeshVert.texCoord = v->GetTexCoord();
-            bMeshVert.normal = v->GetNormal();
-            bMeshVert.tangent = v->GetTangent();
-            bMeshVert.bitangent = v->GetBiTangent();
-            bMeshVert.color = v->GetColor();
-            fp->Write(&bMeshVert, sizeof(bMeshVert));
-        }
+        WriteBinarySubMesh(fp, meshSurf->subMesh, meshSurf->materialIndex);
+    }
 
-        // --- vertex weights ---
-        if (bMeshSurf.maxWeights > 0) {
-            if (bMeshSurf.maxWeights == 1) {
-                VertexWeight1 *vw = (VertexWeight1 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->jointIndex);
-                }
-            } else if (bMeshSurf.maxWeights <= 4) {
-                VertexWeight4 *vw = (VertexWeight4 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->jointIndexes[0]);
-                    fp->WriteUChar(vw->jointIndexes[1]);
-                    fp->WriteUChar(vw->jointIndexes[2]);
-                    fp->WriteUChar(vw->jointIndexes[3]);
-
-                    fp->WriteUChar(vw->jointWeights[0]);
-                    fp->WriteUChar(vw->jointWeights[1]);
-                    fp->WriteUChar(vw->jointWeights[2]);
-                    fp->WriteUChar(vw->jointWeights[3]);
-                }
-            } else if (bMeshSurf.maxWeights <= 8) {
-                VertexWeight8 *vw = (VertexWeight8 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->jointIndexes[0]);
-                    fp->WriteUChar(vw->jointIndexes[1]);
-                    fp->WriteUChar(vw->jointIndexes[2]);
-                    fp->WriteUChar(vw->jointIndexes[3]);
-                    fp->WriteUChar(vw->jointIndexes[4]);
-                    fp->WriteUChar(vw->jointIndexes[5]);
-                    fp->WriteUChar(vw->jointIndexes[6]);
-                    fp->WriteUChar(vw->jointIndexes[7]);
-
-                    fp->WriteUChar(vw->jointWeights[0]);
-                    fp->WriteUChar(vw->jointWeights[1]);
-                    fp->WriteUChar(vw->jointWeights[2]);
-                    fp->WriteUChar(vw->jointWeights[3]);
-                    fp->WriteUChar(vw->jointWeights[4]);
-                    fp->WriteUChar(vw->jointWeights[5]);
-                    fp->WriteUChar(vw->jointWeights[6]);
-                    fp->WriteUChar(vw->jointWeights[7]);
-                }
+    // --- LODs ---
+    if (numLODs > 1) {
+        BMeshLODs bMeshLODs;
+        bMeshLODs.numLODs = numLODs;
+        bMeshLODs.padding = 0;
+        fp->Write(&bMeshLODs, sizeof(bMeshLODs));
+
+        for (int lodIndex = 1; lodIndex < numLODs; lodIndex++) {
+            for (int surfaceIndex = 0; surfaceIndex < bMeshHeader.numSurfs; surfaceIndex++) {
+                const MeshSurf *meshSurf = GetSurface(surfaceIndex);
+
+                WriteBinarySubMesh(fp, meshSurf->GetLODSubMesh(lodIndex), meshSurf->materialIndex);
             }
         }
+    }
 
-        // --- indexes ---
-        if (subMesh->numIndexes < BIT(16)) {
-            for (int i = 0; i < subMesh->numIndexes; i++) {
-                fp->WriteUInt16(subMesh->indexes[i]);
-            }
-        } else {
-            for (int i = 0; i < subMesh->numIndexes; i++) {
-                fp->WriteUInt32(subMesh->indexes[i]);
+    // --- clusters ---
+    if (bMeshLayout.flags & BMeshLayoutFlag::Clusters) {
+        for (int surfaceIndex = 0; surfaceIndex < bMeshHeader.numSurfs; surfaceIndex++) {
+            const SubMesh *subMesh = GetSurface(surfaceIndex)->subMesh;
+
+            BMeshClusters bMeshClusters;
+            bMeshClusters.numClusters = subMesh->numClusters;
+            bMeshClusters.padding = 0;
+            fp->Write(&bMeshClusters, sizeof(bMeshClusters));
+
+            for (int clusterIndex = 0; clusterIndex < subMesh->numClusters; clusterIndex++) {
+                const MeshCluster &cluster = subMesh->clusters[clusterIndex];
+
+                BMeshCluster bMeshCluster;
+                bMeshCluster.firstIndex = cluster.firstIndex;
+                bMeshCluster.numIndexes = cluster.numIndexes;
+                bMeshCluster.center = cluster.center;
+                bMeshCluster.radius = cluster.radius;
+                bMeshCluster.coneAxis = cluster.coneAxis;
+                bMeshCluster.coneCutoff = cluster.coneCutoff;
+                bMeshCluster.aabbMin = cluster.aabb[0];
+                bMeshCluster.aabbMax = cluster.aabb[1];
+                fp->Write(&bMeshCluster, sizeof(bMeshCluster));
             }
         }
-
-        // guarantee 8 bytes aligned write
-        byte dummy[8] = { 0, };
-        int offset = fp->Tell();
-        int dummyBytes = AlignUp(offset, 8) - offset;
-        fp->Write(dummy, dummyBytes);
     }
 
     fileSystem.CloseFile(fp);
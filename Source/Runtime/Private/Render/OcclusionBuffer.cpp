@@ -0,0 +1,401 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/Heap.h"
+#include "Core/JobPool.h"
+#include "Math/Math.h"
+#include "SIMD/SIMD.h"
+#include "Render/OcclusionBuffer.h"
+
+BE_NAMESPACE_BEGIN
+
+static const float FarDepth = 1.0f;
+
+void OcclusionBuffer::Init(int width, int height) {
+    Shutdown();
+
+    this->width = Max(TileWidth, (width + TileWidth - 1) & ~(TileWidth - 1));
+    this->height = Max(TileHeight, (height + TileHeight - 1) & ~(TileHeight - 1));
+
+    numTilesX = this->width / TileWidth;
+    numTilesY = this->height / TileHeight;
+    numBlocksX = this->width / BlockSize;
+    numBlocksY = this->height / BlockSize;
+
+    depthBuffer = (float *)Mem_Alloc16(this->width * this->height * sizeof(float));
+    blockMaxDepth = (float *)Mem_Alloc16(numBlocksX * numBlocksY * sizeof(float));
+
+    tileBins.SetCount(numTilesX * numTilesY);
+    tileTasks.Reserve(numTilesX * numTilesY);
+
+    Clear(Mat4::identity);
+}
+
+void OcclusionBuffer::Shutdown() {
+    if (depthBuffer) {
+        Mem_AlignedFree(depthBuffer);
+        depthBuffer = nullptr;
+    }
+
+    if (blockMaxDepth) {
+        Mem_AlignedFree(blockMaxDepth);
+        blockMaxDepth = nullptr;
+    }
+
+    clipVerts.Clear();
+    triangles.Clear();
+    tileBins.Clear();
+    tileTasks.Clear();
+
+    width = 0;
+    height = 0;
+}
+
+void OcclusionBuffer::Clear(const Mat4 &viewProjMatrix) {
+    this->viewProjMatrix = viewProjMatrix;
+
+    for (int i = 0; i < width * height; i++) {
+        depthBuffer[i] = FarDepth;
+    }
+
+    for (int i = 0; i < numBlocksX * numBlocksY; i++) {
+        blockMaxDepth[i] = FarDepth;
+    }
+
+    triangles.SetCount(0, false);
+
+    for (int i = 0; i < tileBins.Count(); i++) {
+        tileBins[i].SetCount(0, false);
+    }
+}
+
+void OcclusionBuffer::AddOccluder(const Mat4 &modelViewProjMatrix, const Vec3 *xyz, int stride, int numVerts, const TriIndex *indexes, int numIndexes) {
+    assert(depthBuffer);
+
+    clipVerts.SetCount(numVerts, false);
+
+    const byte *xyzPtr = (const byte *)xyz;
+    for (int i = 0; i < numVerts; i++, xyzPtr += stride) {
+        clipVerts[i] = modelViewProjMatrix * Vec4(*(const Vec3 *)xyzPtr, 1.0f);
+    }
+
+    for (int i = 0; i < numIndexes; i += 3) {
+        const Vec4 &v0 = clipVerts[indexes[i + 0]];
+        const Vec4 &v1 = clipVerts[indexes[i + 1]];
+        const Vec4 &v2 = clipVerts[indexes[i + 2]];
+
+        // Trivial reject if all the vertices are outside of the same frustum side plane.
+        if ((v0.x < -v0.w && v1.x < -v1.w && v2.x < -v2.w) ||
+            (v0.x > v0.w && v1.x > v1.w && v2.x > v2.w) ||
+            (v0.y < -v0.w && v1.y < -v1.w && v2.y < -v2.w) ||
+            (v0.y > v0.w && v1.y > v1.w && v2.y > v2.w) ||
+            (v0.z > v0.w && v1.z > v1.w && v2.z > v2.w)) {
+            continue;
+        }
+
+        float d0 = v0.z + v0.w;
+        float d1 = v1.z + v1.w;
+        float d2 = v2.z + v2.w;
+
+        if (d0 >= 0.0f && d1 >= 0.0f && d2 >= 0.0f) {
+            BinTriangle(v0, v1, v2);
+            continue;
+        }
+
+        if (d0 < 0.0f && d1 < 0.0f && d2 < 0.0f) {
+            continue;
+        }
+
+        // Clip against the near plane (z = -w). The result polygon has 3 or 4 vertices.
+        const Vec4 *in[3] = { &v0, &v1, &v2 };
+        const float dist[3] = { d0, d1, d2 };
+        Vec4 out[4];
+        int numOut = 0;
+
+        for (int j = 0; j < 3; j++) {
+            int k = j == 2 ? 0 : j + 1;
+
+            if (dist[j] >= 0.0f) {
+                out[numOut++] = *in[j];
+            }
+            if ((dist[j] >= 0.0f) != (dist[k] >= 0.0f)) {
+                float t = dist[j] / (dist[j] - dist[k]);
+                out[numOut++] = *in[j] + (*in[k] - *in[j]) * t;
+            }
+        }
+
+        for (int j = 2; j < numOut; j++) {
+            BinTriangle(out[0], out[j - 1], out[j]);
+        }
+    }
+}
+
+void OcclusionBuffer::BinTriangle(const Vec4 &v0, const Vec4 &v1, const Vec4 &v2) {
+    const float halfWidth = width * 0.5f;
+    const float halfHeight = height * 0.5f;
+
+    float invW0 = 1.0f / v0.w;
+    float invW1 = 1.0f / v1.w;
+    float invW2 = 1.0f / v2.w;
+
+    float x0 = (v0.x * invW0 + 1.0f) * halfWidth;
+    float y0 = (v0.y * invW0 + 1.0f) * halfHeight;
+    float z0 = v0.z * invW0;
+    float x1 = (v1.x * invW1 + 1.0f) * halfWidth;
+    float y1 = (v1.y * invW1 + 1.0f) * halfHeight;
+    float z1 = v1.z * invW1;
+    float x2 = (v2.x * invW2 + 1.0f) * halfWidth;
+    float y2 = (v2.y * invW2 + 1.0f) * halfHeight;
+    float z2 = v2.z * invW2;
+
+    float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+    if (Math::Fabs(area) < 1e-6f) {
+        return;
+    }
+
+    // Both faces are rasterized since the occluder materials might be two sided.
+    int minX = Max(Math::Ftoi(Math::Floor(Min3(x0, x1, x2))), 0);
+    int minY = Max(Math::Ftoi(Math::Floor(Min3(y0, y1, y2))), 0);
+    int maxX = Min(Math::Ftoi(Math::Ceil(Max3(x0, x1, x2))), width - 1);
+    int maxY = Min(Math::Ftoi(Math::Ceil(Max3(y0, y1, y2))), height - 1);
+
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
+
+    int triangleIndex = triangles.Count();
+    ScreenTriangle &tri = triangles.Alloc();
+
+    // Edge functions are positive inside of the triangle.
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+
+    tri.edgeA[0] = (y1 - y2) * sign;
+    tri.edgeB[0] = (x2 - x1) * sign;
+    tri.edgeC[0] = (x1 * y2 - x2 * y1) * sign;
+    tri.edgeA[1] = (y2 - y0) * sign;
+    tri.edgeB[1] = (x0 - x2) * sign;
+    tri.edgeC[1] = (x2 * y0 - x0 * y2) * sign;
+    tri.edgeA[2] = (y0 - y1) * sign;
+    tri.edgeB[2] = (x1 - x0) * sign;
+    tri.edgeC[2] = (x0 * y1 - x1 * y0) * sign;
+
+    // Depth plane equation z = depthA * x + depthB * y + depthC.
+    float invArea = 1.0f / area;
+    tri.depthA = ((z1 - z0) * (y2 - y0) - (z2 - z0) * (y1 - y0)) * invArea;
+    tri.depthB = ((z2 - z0) * (x1 - x0) - (z1 - z0) * (x2 - x0)) * invArea;
+    tri.depthC = z0 - tri.depthA * x0 - tri.depthB * y0;
+
+    tri.minX = minX;
+    tri.minY = minY;
+    tri.maxX = maxX;
+    tri.maxY = maxY;
+
+    int minTileX = minX / TileWidth;
+    int minTileY = minY / TileHeight;
+    int maxTileX = maxX / TileWidth;
+    int maxTileY = maxY / TileHeight;
+
+    for (int tileY = minTileY; tileY <= maxTileY; tileY++) {
+        for (int tileX = minTileX; tileX <= maxTileX; tileX++) {
+            tileBins[tileY * numTilesX + tileX].Append(triangleIndex);
+        }
+    }
+}
+
+void OcclusionBuffer::Rasterize() {
+    assert(depthBuffer);
+
+    if (triangles.Count() == 0) {
+        return;
+    }
+
+    // Rasterize only the tiles which have the binned triangles.
+    tileTasks.SetCount(0, false);
+
+    for (int i = 0; i < tileBins.Count(); i++) {
+        if (tileBins[i].Count() > 0) {
+            TileTask &task = tileTasks.Alloc();
+            task.buffer = this;
+            task.tileIndex = i;
+        }
+    }
+
+    jobPool.Run(RasterizeTileTask, tileTasks);
+}
+
+void OcclusionBuffer::RasterizeTileTask(void *data) {
+    TileTask *task = (TileTask *)data;
+    task->buffer->RasterizeTile(task->tileIndex);
+}
+
+void OcclusionBuffer::RasterizeTile(int tileIndex) {
+    const int tileX0 = (tileIndex % numTilesX) * TileWidth;
+    const int tileY0 = (tileIndex / numTilesX) * TileHeight;
+    const int tileX1 = tileX0 + TileWidth - 1;
+    const int tileY1 = tileY0 + TileHeight - 1;
+
+    const Array<int> &bin = tileBins[tileIndex];
+
+    for (int binIndex = 0; binIndex < bin.Count(); binIndex++) {
+        const ScreenTriangle &tri = triangles[bin[binIndex]];
+
+        // Spans are aligned to 4 pixels. Pixels outside of the triangle are rejected by the edge functions.
+        int x0 = Max(tri.minX, tileX0) & ~3;
+        int x1 = Min(tri.maxX, tileX1);
+        int y0 = Max(tri.minY, tileY0);
+        int y1 = Min(tri.maxY, tileY1);
+
+        for (int y = y0; y <= y1; y++) {
+            float *row = depthBuffer + y * width;
+            float py = y + 0.5f;
+
+#if defined(ENABLE_SIMD4_INTRIN)
+            const simd4f laneOffsets = set_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+            simd4f rowE0 = set1_ps(tri.edgeB[0] * py + tri.edgeC[0]);
+            simd4f rowE1 = set1_ps(tri.edgeB[1] * py + tri.edgeC[1]);
+            simd4f rowE2 = set1_ps(tri.edgeB[2] * py + tri.edgeC[2]);
+            simd4f rowZ = set1_ps(tri.depthB * py + tri.depthC);
+
+            simd4f edgeA0 = set1_ps(tri.edgeA[0]);
+            simd4f edgeA1 = set1_ps(tri.edgeA[1]);
+            simd4f edgeA2 = set1_ps(tri.edgeA[2]);
+            simd4f depthA = set1_ps(tri.depthA);
+            simd4f zero = setzero_ps();
+
+            for (int x = x0; x <= x1; x += 4) {
+                simd4f px = set1_ps((float)x) + laneOffsets;
+
+                simd4f e0 = madd_ps(edgeA0, px, rowE0);
+                simd4f e1 = madd_ps(edgeA1, px, rowE1);
+                simd4f e2 = madd_ps(edgeA2, px, rowE2);
+
+                simd4f minEdge = min_ps(min_ps(e0, e1), e2);
+                if (reduce_max_ps(minEdge) < 0.0f) {
+                    continue;
+                }
+
+                simd4f inside = minEdge >= zero;
+                simd4f z = madd_ps(depthA, px, rowZ);
+                simd4f oldZ = load_ps(row + x);
+                simd4f newZ = min_ps(oldZ, z);
+
+                // Bitwise select the new depth for the covered pixels.
+                store_ps(oldZ ^ ((oldZ ^ newZ) & inside), row + x);
+            }
+#else
+            for (int x = x0; x <= x1; x++) {
+                float px = x + 0.5f;
+
+                if (tri.edgeA[0] * px + tri.edgeB[0] * py + tri.edgeC[0] < 0.0f ||
+                    tri.edgeA[1] * px + tri.edgeB[1] * py + tri.edgeC[1] < 0.0f ||
+                    tri.edgeA[2] * px + tri.edgeB[2] * py + tri.edgeC[2] < 0.0f) {
+                    continue;
+                }
+
+                float z = tri.depthA * px + tri.depthB * py + tri.depthC;
+                if (z < row[x]) {
+                    row[x] = z;
+                }
+            }
+#endif
+        }
+    }
+
+    // Update farthest depth of the blocks in this tile.
+    for (int blockY = tileY0; blockY < tileY0 + TileHeight; blockY += BlockSize) {
+        for (int blockX = tileX0; blockX < tileX0 + TileWidth; blockX += BlockSize) {
+            float maxDepth = -FLT_MAX;
+
+            for (int y = blockY; y < blockY + BlockSize; y++) {
+                const float *row = depthBuffer + y * width + blockX;
+
+                for (int x = 0; x < BlockSize; x++) {
+                    maxDepth = Max(maxDepth, row[x]);
+                }
+            }
+
+            blockMaxDepth[(blockY / BlockSize) * numBlocksX + blockX / BlockSize] = maxDepth;
+        }
+    }
+}
+
+bool OcclusionBuffer::IsAABBVisible(const AABB &worldAABB) const {
+    if (!depthBuffer) {
+        return true;
+    }
+
+    float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+    for (int i = 0; i < 8; i++) {
+        Vec3 corner(worldAABB[(i >> 0) & 1].x, worldAABB[(i >> 1) & 1].y, worldAABB[(i >> 2) & 1].z);
+        Vec4 clip = viewProjMatrix * Vec4(corner, 1.0f);
+
+        // Treat as visible if the bounds cross the near plane.
+        if (clip.w <= 0.0f || clip.z < -clip.w) {
+            return true;
+        }
+
+        float invW = 1.0f / clip.w;
+        float x = clip.x * invW;
+        float y = clip.y * invW;
+        float z = clip.z * invW;
+
+        minX = Min(minX, x);
+        minY = Min(minY, y);
+        minZ = Min(minZ, z);
+        maxX = Max(maxX, x);
+        maxY = Max(maxY, y);
+    }
+
+    int x0 = Max(Math::Ftoi(Math::Floor((minX + 1.0f) * width * 0.5f)), 0);
+    int y0 = Max(Math::Ftoi(Math::Floor((minY + 1.0f) * height * 0.5f)), 0);
+    int x1 = Min(Math::Ftoi(Math::Floor((maxX + 1.0f) * width * 0.5f)), width - 1);
+    int y1 = Min(Math::Ftoi(Math::Floor((maxY + 1.0f) * height * 0.5f)), height - 1);
+
+    if (x0 > x1 || y0 > y1) {
+        // Not covered by the buffer.
+        return true;
+    }
+
+    for (int blockY = y0 / BlockSize; blockY <= y1 / BlockSize; blockY++) {
+        for (int blockX = x0 / BlockSize; blockX <= x1 / BlockSize; blockX++) {
+            // Whole block is in front of the bounds.
+            if (minZ > blockMaxDepth[blockY * numBlocksX + blockX]) {
+                continue;
+            }
+
+            int bx0 = Max(blockX * BlockSize, x0);
+            int by0 = Max(blockY * BlockSize, y0);
+            int bx1 = Min(blockX * BlockSize + BlockSize - 1, x1);
+            int by1 = Min(blockY * BlockSize + BlockSize - 1, y1);
+
+            for (int y = by0; y <= by1; y++) {
+                const float *row = depthBuffer + y * width;
+
+                for (int x = bx0; x <= bx1; x++) {
+                    if (minZ <= row[x]) {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+BE_NAMESPACE_END
@@ -15,10 +15,12 @@
 #include "Precompiled.h"
 #include "Render/Render.h"
 #include "RenderInternal.h"
+#include "Core/JobPool.h"
 
 BE_NAMESPACE_BEGIN
 
 ParticleMesh::ParticleMesh() {
+    currentSurf = nullptr;
     totalVerts = 0;
     totalIndexes = 0;
 }
@@ -79,14 +81,14 @@ void ParticleMesh::DrawQuad(const VertexGeneric *verts, const Material *material
     }
 }
 
-int ParticleMesh::CountDrawingVerts(const ParticleSystem::Stage &stage, const Particle *stageParticles) const {
+int ParticleMesh::CountDrawingVerts(const ParticleSystem::Stage &stage, const Particle *stageParticles, int firstParticle, int numParticles) const {
     int numVerts = 0;
     
     int trailCount = (stage.moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) ? stage.trailsModule.count : 0;
+    int particleSize = sizeof(Particle) + sizeof(Particle::Trail) * trailCount;
 
-    for (int particleIndex = 0; particleIndex < stage.standardModule.count; particleIndex++) {
-        int particleSize = sizeof(Particle) + sizeof(Particle::Trail) * trailCount;
-        Particle *particle = (Particle *)((byte *)stageParticles + particleIndex * particleSize);
+    for (int particleIndex = firstParticle; particleIndex < firstParticle + numParticles; particleIndex++) {
+        const Particle *particle = (const Particle *)((const byte *)stageParticles + particleIndex * particleSize);
         
         if (particle->alive) {
             if (stage.standardModule.orientation == ParticleSystem::StandardModule::Orientation::Aimed ||
@@ -101,6 +103,27 @@ int ParticleMesh::CountDrawingVerts(const ParticleSystem::Stage &stage, const Pa
     return numVerts;
 }
 
+bool ParticleMesh::IsViewDependent(const ParticleSystem *particleSystem) {
+    for (int stageIndex = 0; stageIndex < particleSystem->stages.Count(); stageIndex++) {
+        const ParticleSystem::Stage &stage = particleSystem->stages[stageIndex];
+
+        if (stage.skipRender) {
+            continue;
+        }
+
+        switch (stage.standardModule.orientation) {
+        case ParticleSystem::StandardModule::Orientation::X:
+        case ParticleSystem::StandardModule::Orientation::Y:
+        case ParticleSystem::StandardModule::Orientation::Z:
+            break;
+        default:
+            return true;
+        }
+    }
+
+    return false;
+}
+
 static Mat3 ComputeParticleAxis(ParticleSystem::StandardModule::Orientation::Enum orientation, const Mat3 &modelAxis, const Mat3 &viewAxis) {
     Mat3 worldAxis; // forward, left, up
 
@@ -161,15 +184,10 @@ void ParticleMesh::ComputeTextureCoordinates(const ParticleSystem::StandardModul
 }
 
 void ParticleMesh::Draw(const ParticleSystem *particleSystem, const Array<Particle *> &stageParticles, const RenderObject *renderObject, const RenderCamera *renderCamera) {
-    Vec3 worldPos[Particle::MaxTrails + 1];
-    Vec3 cameraDir[Particle::MaxTrails + 1];
-    Vec3 tangentDir[Particle::MaxTrails + 1];
-    Mat3 localAxis;
-    Vec3 rtv, upv;
-    float s1;
-    float t1;
-    float s2;
-    float t2;
+    vertexTasks.SetCount(0, false);
+
+    const int firstSurface = surfaces.Count();
+    int numVerts = 0;
 
     for (int stageIndex = 0; stageIndex < particleSystem->stages.Count(); stageIndex++) {
         const ParticleSystem::Stage &stage = particleSystem->stages[stageIndex];
@@ -178,175 +196,236 @@ void ParticleMesh::Draw(const ParticleSystem *particleSystem, const Array<Partic
             continue;
         }
 
-        int numVerts = CountDrawingVerts(stage, stageParticles[stageIndex]);
-        if (numVerts > 0) {
-            if (!currentSurf || 1) {//stage.standardModule.material != currentSurf->material) { FIXME
-                PrepareNextSurf();
-                
-                currentSurf->material = stage.standardModule.material;
-            }
-
-            // number of indices for the quad that consist of two triangles
-            int numIndexes = numVerts * 3 / 2;
+        const int firstVert = numVerts;
 
-            totalVerts += numVerts;
-            totalIndexes += numIndexes;
+        // Split the stage into the particle ranges which are drawn in the pre-reserved vertex range.
+        for (int firstParticle = 0; firstParticle < stage.standardModule.count; firstParticle += ParticlesPerTask) {
+            int numParticles = Min(firstParticle + ParticlesPerTask, stage.standardModule.count) - firstParticle;
 
-            currentSurf->numVerts += numVerts;
-            currentSurf->numIndexes += numIndexes;
+            int taskVerts = CountDrawingVerts(stage, stageParticles[stageIndex], firstParticle, numParticles);
+            if (taskVerts == 0) {
+                continue;
+            }
 
-            ComputeTextureCoordinates(stage.standardModule, MILLI2SEC(renderObject->GetState().time) - renderObject->GetState().stageStartDelay[stageIndex], s1, t1, s2, t2);
+            VertexTask &task = vertexTasks.Alloc();
+            task.stage = &stage;
+            task.particles = stageParticles[stageIndex];
+            task.firstParticle = firstParticle;
+            task.numParticles = numParticles;
+            task.firstVert = numVerts;
+            task.renderObject = renderObject;
+            task.renderCamera = renderCamera;
 
-            float16_t hs1 = F16Converter::FromF32(s1);
-            float16_t ht1 = F16Converter::FromF32(t1);
-            float16_t hs2 = F16Converter::FromF32(s2);
-            float16_t ht2 = F16Converter::FromF32(t2);
+            ComputeTextureCoordinates(stage.standardModule, MILLI2SEC(renderObject->GetState().time) - renderObject->GetState().stageStartDelay[stageIndex], task.s1, task.t1, task.s2, task.t2);
 
             if (stage.standardModule.orientation != ParticleSystem::StandardModule::Orientation::Aimed &&
                 stage.standardModule.orientation != ParticleSystem::StandardModule::Orientation::AimedZ) {
-                localAxis = ComputeParticleAxis(stage.standardModule.orientation, renderObject->GetWorldMatrix().ToMat3(), renderCamera->GetState().axis);
+                task.localAxis = ComputeParticleAxis(stage.standardModule.orientation, renderObject->GetWorldMatrix().ToMat3(), renderCamera->GetState().axis);
             }
 
-            // Cache vertices
-            BufferCache vertexCache;
-            bufferCacheManager.AllocVertex(numVerts, sizeof(VertexGeneric), nullptr, &vertexCache);
-            VertexGeneric *vertexPointer = (VertexGeneric *)bufferCacheManager.MapVertexBuffer(&vertexCache);
-           
-            int trailCount = (stage.moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) ? stage.trailsModule.count : 0;
+            numVerts += taskVerts;
+        }
+
+        const int stageVerts = numVerts - firstVert;
+        if (stageVerts == 0) {
+            continue;
+        }
 
-            for (int particleIndex = 0; particleIndex < stage.standardModule.count; particleIndex++) {
-                int pivotCount = trailCount + 1;
+        // Consecutive stages with the same material are merged into one surface.
+        if (surfaces.Count() == firstSurface || stage.standardModule.material != currentSurf->material) {
+            PrepareNextSurf();
 
-                int particleSize = sizeof(Particle) + sizeof(Particle::Trail) * trailCount;
-                Particle *particle = (Particle *)((byte *)stageParticles[stageIndex] + particleIndex * particleSize);
+            currentSurf->material = stage.standardModule.material;
+        }
 
-                if (!particle->alive) {
-                    continue;
-                }
+        // number of indices for the quad that consist of two triangles
+        int numIndexes = stageVerts * 3 / 2;
+
+        currentSurf->numVerts += stageVerts;
+        currentSurf->numIndexes += numIndexes;
+
+        totalVerts += stageVerts;
+        totalIndexes += numIndexes;
+    }
+
+    if (numVerts == 0) {
+        return;
+    }
+
+    // Cache vertices of all stages in one vertex range
+    BufferCache vertexCache;
+    bufferCacheManager.AllocVertex(numVerts, sizeof(VertexGeneric), nullptr, &vertexCache);
+    VertexGeneric *vertexBase = (VertexGeneric *)bufferCacheManager.MapVertexBuffer(&vertexCache);
+
+    uint32_t offset = vertexCache.offset;
+    for (int surfaceIndex = firstSurface; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        PrtMeshSurf *surf = &surfaces[surfaceIndex];
+
+        surf->vertexCache = vertexCache;
+        surf->vertexCache.offset = offset;
+        surf->vertexCache.bytes = sizeof(VertexGeneric) * surf->numVerts;
+
+        offset += surf->vertexCache.bytes;
+    }
+
+    for (int taskIndex = 0; taskIndex < vertexTasks.Count(); taskIndex++) {
+        vertexTasks[taskIndex].vertexPointer = vertexBase + vertexTasks[taskIndex].firstVert;
+    }
+
+    jobPool.Run(DrawParticlesTask, vertexTasks);
+
+    bufferCacheManager.UnmapVertexBuffer(&vertexCache);
+}
+
+void ParticleMesh::DrawParticlesTask(void *data) {
+    DrawParticles(*(const VertexTask *)data);
+}
+
+void ParticleMesh::DrawParticles(const VertexTask &task) {
+    const ParticleSystem::Stage &stage = *task.stage;
+    const RenderObject *renderObject = task.renderObject;
+    const RenderCamera *renderCamera = task.renderCamera;
+    const Mat3 &localAxis = task.localAxis;
+    Vec3 worldPos[Particle::MaxTrails + 1];
+    Vec3 cameraDir[Particle::MaxTrails + 1];
+    Vec3 tangentDir[Particle::MaxTrails + 1];
+    Vec3 rtv, upv;
+
+    float16_t hs1 = F16Converter::FromF32(task.s1);
+    float16_t ht1 = F16Converter::FromF32(task.t1);
+    float16_t hs2 = F16Converter::FromF32(task.s2);
+    float16_t ht2 = F16Converter::FromF32(task.t2);
+
+    VertexGeneric *vertexPointer = task.vertexPointer;
+
+    int trailCount = (stage.moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) ? stage.trailsModule.count : 0;
+    int pivotCount = trailCount + 1;
+    int particleSize = sizeof(Particle) + sizeof(Particle::Trail) * trailCount;
+
+    for (int particleIndex = task.firstParticle; particleIndex < task.firstParticle + task.numParticles; particleIndex++) {
+        const Particle *particle = (const Particle *)((const byte *)task.particles + particleIndex * particleSize);
+
+        if (!particle->alive) {
+            continue;
+        }
+
+        uint32_t color = particle->trails[0].color.ToUInt32();
+
+        if (stage.standardModule.orientation == ParticleSystem::StandardModule::Orientation::Aimed ||
+            stage.standardModule.orientation == ParticleSystem::StandardModule::Orientation::AimedZ) {
+            // Compute world position of all particle pivots including trails
+            for (int pivotIndex = 0; pivotIndex < pivotCount; pivotIndex++) {
+                const Particle::Trail *trail = &particle->trails[pivotIndex];
+
+                worldPos[pivotIndex] = renderObject->GetWorldMatrix() * trail->position;
+            }
+
+            // Compute cameraDir/tangentDir of all particle pivots including trails
+            for (int pivotIndex = 0; pivotIndex < pivotCount; pivotIndex++) {
+                const Particle::Trail *trail = &particle->trails[pivotIndex];
 
-                uint32_t color = particle->trails[0].color.ToUInt32();
-
-                if (stage.standardModule.orientation == ParticleSystem::StandardModule::Orientation::Aimed ||
-                    stage.standardModule.orientation == ParticleSystem::StandardModule::Orientation::AimedZ) {
-                    // Compute world position of all particle pivots including trails
-                    for (int pivotIndex = 0; pivotIndex < pivotCount; pivotIndex++) {
-                        const Particle::Trail *trail = &particle->trails[pivotIndex];
-
-                        worldPos[pivotIndex] = renderObject->GetWorldMatrix() * trail->position;
-                    }
-
-                    // Compute cameraDir/tangentDir of all particle pivots including trails
-                    for (int pivotIndex = 0; pivotIndex < pivotCount; pivotIndex++) {
-                        const Particle::Trail *trail = &particle->trails[pivotIndex];
-
-                        if (pivotIndex == 0) {
-                            cameraDir[pivotIndex] = renderCamera->GetState().origin - (worldPos[pivotIndex + 1] + worldPos[pivotIndex]) * 0.5f;
-                            tangentDir[pivotIndex] = worldPos[pivotIndex + 1] - worldPos[pivotIndex];
-                        } else if (pivotIndex == trailCount) {
-                            cameraDir[pivotIndex] = renderCamera->GetState().origin - (worldPos[pivotIndex] + worldPos[pivotIndex - 1]) * 0.5f;
-                            tangentDir[pivotIndex] = worldPos[pivotIndex] - worldPos[pivotIndex - 1];
-                        } else {
-                            cameraDir[pivotIndex] = renderCamera->GetState().origin - worldPos[pivotIndex];
-                            tangentDir[pivotIndex] = worldPos[pivotIndex + 1] - worldPos[pivotIndex - 1];
-                        }
-
-                        if (stage.standardModule.orientation == ParticleSystem::StandardModule::Orientation::AimedZ) {
-                            cameraDir[pivotIndex].x = 0;
-                            cameraDir[pivotIndex].y = 0;
-                        }
-
-                        cameraDir[pivotIndex].Normalize();
-                        tangentDir[pivotIndex].Normalize();
-                    }
-
-                    for (int quadIndex = 0; quadIndex < trailCount; quadIndex++) {
-                        const Particle::Trail *trail = &particle->trails[quadIndex];
-                        
-                        ht1 = F16Converter::FromF32((float)quadIndex / trailCount);
-                        ht2 = F16Converter::FromF32((float)(quadIndex + 1) / trailCount);
-
-                        rtv.SetFromCross(cameraDir[quadIndex], tangentDir[quadIndex]);
-                        rtv.Normalize();
-                        rtv = renderObject->GetWorldMatrix().ToMat3().TransposedMulVec(rtv);
-                        rtv *= particle->trails[0].size * 0.5f;
-
-                        vertexPointer->xyz = trail[0].position - rtv;
-                        vertexPointer->st[0] = hs1;
-                        vertexPointer->st[1] = ht1;
-                        *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
-                        vertexPointer++;
-
-                        vertexPointer->xyz = trail[0].position + rtv;
-                        vertexPointer->st[0] = hs2;
-                        vertexPointer->st[1] = ht1;
-                        *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
-                        vertexPointer++;
-
-                        rtv.SetFromCross(cameraDir[quadIndex + 1], tangentDir[quadIndex + 1]);
-                        rtv.Normalize();
-                        rtv = renderObject->GetWorldMatrix().ToMat3().TransposedMulVec(rtv);
-                        rtv *= particle->trails[0].size * 0.5f;
-
-                        vertexPointer->xyz = trail[1].position - rtv;
-                        vertexPointer->st[0] = hs1;
-                        vertexPointer->st[1] = ht2;
-                        *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
-                        vertexPointer++;
-
-                        vertexPointer->xyz = trail[1].position + rtv;
-                        vertexPointer->st[0] = hs2;
-                        vertexPointer->st[1] = ht2;
-                        *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
-                        vertexPointer++;
-                    }
+                if (pivotIndex == 0) {
+                    cameraDir[pivotIndex] = renderCamera->GetState().origin - (worldPos[pivotIndex + 1] + worldPos[pivotIndex]) * 0.5f;
+                    tangentDir[pivotIndex] = worldPos[pivotIndex + 1] - worldPos[pivotIndex];
+                } else if (pivotIndex == trailCount) {
+                    cameraDir[pivotIndex] = renderCamera->GetState().origin - (worldPos[pivotIndex] + worldPos[pivotIndex - 1]) * 0.5f;
+                    tangentDir[pivotIndex] = worldPos[pivotIndex] - worldPos[pivotIndex - 1];
                 } else {
-                    for (int quadIndex = 0; quadIndex < pivotCount; quadIndex++) {
-                        const Particle::Trail *trail = &particle->trails[quadIndex];
-                        
-                        Vec3 rt = localAxis[1];
-                        Vec3 up = localAxis[2];
-
-                        if (trail->angle != 0) {
-                            Rotation rotation(Vec3::origin, localAxis[0], trail->angle);
-                            rt = rotation.RotatePoint(rt);
-                            up = rotation.RotatePoint(up);
-                        }
-
-                        const float halfSize = trail->size * 0.5f;
-
-                        rtv = rt * halfSize * trail->aspectRatio;
-                        upv = up * halfSize;
-
-                        vertexPointer->xyz = trail->position + upv - rtv;
-                        vertexPointer->st[0] = hs1;
-                        vertexPointer->st[1] = ht1;
-                        *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
-                        vertexPointer++;
-
-                        vertexPointer->xyz = trail->position + upv + rtv;
-                        vertexPointer->st[0] = hs2;
-                        vertexPointer->st[1] = ht1;
-                        *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
-                        vertexPointer++;
-
-                        vertexPointer->xyz = trail->position - upv - rtv;
-                        vertexPointer->st[0] = hs1;
-                        vertexPointer->st[1] = ht2;
-                        *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
-                        vertexPointer++;
-
-                        vertexPointer->xyz = trail->position - upv + rtv;
-                        vertexPointer->st[0] = hs2;
-                        vertexPointer->st[1] = ht2;
-                        *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
-                        vertexPointer++;
-                    }
+                    cameraDir[pivotIndex] = renderCamera->GetState().origin - worldPos[pivotIndex];
+                    tangentDir[pivotIndex] = worldPos[pivotIndex + 1] - worldPos[pivotIndex - 1];
                 }
+
+                if (stage.standardModule.orientation == ParticleSystem::StandardModule::Orientation::AimedZ) {
+                    cameraDir[pivotIndex].x = 0;
+                    cameraDir[pivotIndex].y = 0;
+                }
+
+                cameraDir[pivotIndex].Normalize();
+                tangentDir[pivotIndex].Normalize();
             }
 
-            bufferCacheManager.UnmapVertexBuffer(&vertexCache);
+            for (int quadIndex = 0; quadIndex < trailCount; quadIndex++) {
+                const Particle::Trail *trail = &particle->trails[quadIndex];
+                
+                ht1 = F16Converter::FromF32((float)quadIndex / trailCount);
+                ht2 = F16Converter::FromF32((float)(quadIndex + 1) / trailCount);
+
+                rtv.SetFromCross(cameraDir[quadIndex], tangentDir[quadIndex]);
+                rtv.Normalize();
+                rtv = renderObject->GetWorldMatrix().ToMat3().TransposedMulVec(rtv);
+                rtv *= particle->trails[0].size * 0.5f;
+
+                vertexPointer->xyz = trail[0].position - rtv;
+                vertexPointer->st[0] = hs1;
+                vertexPointer->st[1] = ht1;
+                *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
+                vertexPointer++;
+
+                vertexPointer->xyz = trail[0].position + rtv;
+                vertexPointer->st[0] = hs2;
+                vertexPointer->st[1] = ht1;
+                *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
+                vertexPointer++;
+
+                rtv.SetFromCross(cameraDir[quadIndex + 1], tangentDir[quadIndex + 1]);
+                rtv.Normalize();
+                rtv = renderObject->GetWorldMatrix().ToMat3().TransposedMulVec(rtv);
+                rtv *= particle->trails[0].size * 0.5f;
+
+                vertexPointer->xyz = trail[1].position - rtv;
+                vertexPointer->st[0] = hs1;
+                vertexPointer->st[1] = ht2;
+                *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
+                vertexPointer++;
+
+                vertexPointer->xyz = trail[1].position + rtv;
+                vertexPointer->st[0] = hs2;
+                vertexPointer->st[1] = ht2;
+                *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
+                vertexPointer++;
+            }
+        } else {
+            for (int quadIndex = 0; quadIndex < pivotCount; quadIndex++) {
+                const Particle::Trail *trail = &particle->trails[quadIndex];
+                
+                Vec3 rt = localAxis[1];
+                Vec3 up = localAxis[2];
+
+                if (trail->angle != 0) {
+                    Rotation rotation(Vec3::origin, localAxis[0], trail->angle);
+                    rt = rotation.RotatePoint(rt);
+                    up = rotation.RotatePoint(up);
+                }
 
-            currentSurf->vertexCache = vertexCache;
+                const float halfSize = trail->size * 0.5f;
+
+                rtv = rt * halfSize * trail->aspectRatio;
+                upv = up * halfSize;
+
+                vertexPointer->xyz = trail->position + upv - rtv;
+                vertexPointer->st[0] = hs1;
+                vertexPointer->st[1] = ht1;
+                *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
+                vertexPointer++;
+
+                vertexPointer->xyz = trail->position + upv + rtv;
+                vertexPointer->st[0] = hs2;
+                vertexPointer->st[1] = ht1;
+                *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
+                vertexPointer++;
+
+                vertexPointer->xyz = trail->position - upv - rtv;
+                vertexPointer->st[0] = hs1;
+                vertexPointer->st[1] = ht2;
+                *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
+                vertexPointer++;
+
+                vertexPointer->xyz = trail->position - upv + rtv;
+                vertexPointer->st[0] = hs2;
+                vertexPointer->st[1] = ht2;
+                *reinterpret_cast<uint32_t *>(vertexPointer->color) = color;
+                vertexPointer++;
+            }
         }
     }
 }
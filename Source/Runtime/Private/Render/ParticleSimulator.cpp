@@ -0,0 +1,684 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/JobPool.h"
+#include "Math/Math.h"
+#include "SIMD/SIMD.h"
+#include "Render/ParticleSimulator.h"
+
+BE_NAMESPACE_BEGIN
+
+// Number of the particles processed at once in the SIMD path.
+static constexpr int ParticleBlockSize = 64;
+
+// Structure-of-arrays streams of the particles in a block. The particle state is gathered once per block,
+// and the trail pivots of all the particles are simulated together one pivot index at a time.
+struct ParticleBlock {
+    // Particle state
+    ALIGN_AS32 float        direction[3][ParticleBlockSize];
+    ALIGN_AS32 float        initialPosition[3][ParticleBlockSize];
+    ALIGN_AS32 float        initialSpeed[ParticleBlockSize];
+    ALIGN_AS32 float        initialSize[ParticleBlockSize];
+    ALIGN_AS32 float        initialAspectRatio[ParticleBlockSize];
+    ALIGN_AS32 float        initialAngle[ParticleBlockSize];
+    ALIGN_AS32 float        initialColor[4][ParticleBlockSize];
+    ALIGN_AS32 float        randomForce[3][ParticleBlockSize];
+    ALIGN_AS32 float        randomSpeed[ParticleBlockSize];
+    ALIGN_AS32 float        randomSize[ParticleBlockSize];
+    ALIGN_AS32 float        randomAspectRatio[ParticleBlockSize];
+    ALIGN_AS32 float        randomAngularVelocity[ParticleBlockSize];
+    ALIGN_AS32 float        particleAge[ParticleBlockSize];
+
+    // Values of the curves which don't vary with the age, shared by all the trail pivots
+    ALIGN_AS32 float        speedCurve[ParticleBlockSize];
+    ALIGN_AS32 float        sizeCurve[ParticleBlockSize];
+    ALIGN_AS32 float        aspectRatioCurve[ParticleBlockSize];
+    ALIGN_AS32 float        rotationCurve[ParticleBlockSize];
+    ALIGN_AS32 float        forceCurve[3][ParticleBlockSize];
+
+    // Evaluated state of the trail pivots at the current pivot index
+    ALIGN_AS32 float        age[ParticleBlockSize];     ///< Trail age in milliseconds
+    ALIGN_AS32 float        frac[ParticleBlockSize];    ///< Trail age fraction of the life time
+    ALIGN_AS32 float        speed[ParticleBlockSize];
+    ALIGN_AS32 float        dist[ParticleBlockSize];    ///< Moved distance along the direction
+    ALIGN_AS32 float        size[ParticleBlockSize];
+    ALIGN_AS32 float        aspectRatio[ParticleBlockSize];
+    ALIGN_AS32 float        angle[ParticleBlockSize];
+    ALIGN_AS32 float        color[4][ParticleBlockSize];
+    ALIGN_AS32 float        position[3][ParticleBlockSize];
+    ALIGN_AS32 float        temp[2][ParticleBlockSize];
+
+    Mat3x4                  offsetMatrices[ParticleBlockSize];  ///< Particle to local space matrices for the global simulation space
+    Particle *              particles[ParticleBlockSize];
+    int                     count;
+};
+
+static int TrailCount(const ParticleSystem::Stage *stage) {
+    return (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) ? stage->trailsModule.count : 0;
+}
+
+static float TrailAge(const ParticleSystem::Stage *stage, int particleAge, int pivotIndex, int trailCount) {
+    float trailAge = particleAge;
+
+    if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) {
+        trailAge -= (stage->standardModule.lifeTime * stage->trailsModule.length) * pivotIndex / trailCount;
+
+        if (stage->trailsModule.trailCut) {
+            if (trailAge < 0) {
+                trailAge = 0;
+            }
+        }
+    }
+
+    return trailAge;
+}
+
+static float PivotRadius(const ParticleSystem::Stage *stage, float size) {
+    if (stage->standardModule.orientation == ParticleSystem::StandardModule::Orientation::Aimed ||
+        stage->standardModule.orientation == ParticleSystem::StandardModule::Orientation::AimedZ) {
+        return size * 0.5f * 2.0f;
+    }
+    return size * 0.5f;
+}
+
+static void ComputeCustomPathPosition(const ParticleSystem::CustomPathModule &customPathModule, const Particle *particle, float t, Vec3 &position) {
+    if (customPathModule.customPath == ParticleSystem::CustomPathModule::CustomPath::Cone) {
+        float radialTheta = t * DEG2RAD(customPathModule.radialSpeed);
+        float s, c;
+        Math::SinCos(radialTheta, s, c);
+        c = c * (1.0f - t);
+        s = s * (1.0f - t);
+
+        position.x = particle->initialPosition.x * c + particle->initialPosition.y * s;
+        position.y = particle->initialPosition.y * c - particle->initialPosition.x * s;
+        position.z = 0;
+        return;
+    }
+
+    if (customPathModule.customPath == ParticleSystem::CustomPathModule::CustomPath::Helix) {
+        float radialTheta = t * DEG2RAD(customPathModule.radialSpeed);
+        float s, c;
+        Math::SinCos(radialTheta, s, c);
+
+        position.x = particle->initialPosition.x * c + particle->initialPosition.y * s;
+        position.y = particle->initialPosition.y * c - particle->initialPosition.x * s;
+        position.z = particle->initialPosition.z + t * particle->direction.z;
+        return;
+    }
+
+    if (customPathModule.customPath == ParticleSystem::CustomPathModule::CustomPath::Spherical) {
+        float radialTheta = t * DEG2RAD(customPathModule.radialSpeed);
+        float axialTheta = t * customPathModule.axialSpeed;
+        float s, c;
+        Math::SinCos(radialTheta, s, c);
+
+        Vec3 tmp = particle->initialPosition;
+        tmp.Normalize();
+        Vec3 rotDir = Vec3::unitZ.Cross(tmp);
+        Rotation rotation(Vec3::origin, rotDir, axialTheta);
+        Vec3 vec = rotation.RotatePoint(particle->initialPosition);
+
+        position.x = vec.x * c + vec.y * s;
+        position.y = vec.y * c - vec.x * s;
+        position.z = vec.z;
+        return;
+    }
+
+    assert(0);
+}
+
+void ParticleSimulator::Simulate(StageJob *jobs, int numJobs, bool useSIMD) {
+    jobPool.Run(useSIMD ? SimulateStageSIMDTask : SimulateStageScalarTask, jobs, sizeof(StageJob), numJobs);
+}
+
+void ParticleSimulator::SimulateStageScalarTask(void *data) {
+    SimulateStageScalar(*(StageJob *)data);
+}
+
+void ParticleSimulator::SimulateStageSIMDTask(void *data) {
+    SimulateStageSIMD(*(StageJob *)data);
+}
+
+void ParticleSimulator::SimulateStageScalar(StageJob &job) {
+    const ParticleSystem::Stage *stage = job.stage;
+    const bool globalSpace = stage->standardModule.simulationSpace == ParticleSystem::StandardModule::SimulationSpace::Global;
+    const int trailCount = TrailCount(stage);
+    const int pivotCount = 1 + trailCount;
+
+    job.bounds.Clear();
+
+    for (int aliveIndex = 0; aliveIndex < job.numAliveParticles; aliveIndex++) {
+        Particle *particle = (Particle *)((byte *)job.particles + job.aliveParticles[aliveIndex] * job.particleSize);
+        int particleAge = job.particleAges[aliveIndex];
+
+        ALIGN_AS32 Mat3x4 offsetMatrix;
+
+        if (globalSpace) {
+            offsetMatrix = job.invWorldMatrix * particle->worldMatrix;
+        }
+
+        for (int pivotIndex = 0; pivotIndex < pivotCount; pivotIndex++) {
+            Particle::Trail *trail = &particle->trails[pivotIndex];
+
+            float trailAge = TrailAge(stage, particleAge, pivotIndex, trailCount);
+            float trailFrac = trailAge / stage->standardModule.lifeTime;
+
+            float trailSpeed;
+
+            if (stage->moduleFlags & (BIT(ParticleSystem::ModuleBit::SizeBySpeed) | BIT(ParticleSystem::ModuleBit::RotationBySpeed))) {
+                if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::CustomPath)) {
+                    trailSpeed = 0;
+                } else if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTSpeed)) {
+                    trailSpeed = particle->initialSpeed + MeterToUnit(stage->speedOverLifetimeModule.speed.Evaluate(particle->randomSpeed, trailFrac));
+                } else {
+                    trailSpeed = particle->initialSpeed;
+                }
+            }
+
+            // Compute size.
+            if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTSize)) {
+                trail->size = particle->initialSize * stage->sizeOverLifetimeModule.size.Evaluate(particle->randomSize, trailFrac);
+            } else if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::SizeBySpeed)) {
+                float l = Math::Fabs(stage->sizeBySpeedModule.speedRange[1] - stage->sizeBySpeedModule.speedRange[0]);
+                float speedFrac = (UnitToMeter(trailSpeed) - stage->sizeBySpeedModule.speedRange[0]) / l;
+                trail->size = particle->initialSize * stage->sizeBySpeedModule.size.Evaluate(particle->randomSize, speedFrac);
+            } else {
+                trail->size = particle->initialSize;
+            }
+
+            if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) {
+                trail->size *= Math::Lerp(1.0f, stage->trailsModule.trailScale, (float)pivotIndex / trailCount);
+            }
+
+            // Compute aspect ratio.
+            if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTAspectRatio)) {
+                trail->aspectRatio = particle->initialAspectRatio * stage->aspectRatioOverLifetimeModule.aspectRatio.Evaluate(particle->randomAspectRatio, trailFrac);
+            } else {
+                trail->aspectRatio = particle->initialAspectRatio;
+            }
+
+            // Compute rotation angle.
+            if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTRotation)) {
+                float angularVelocity = stage->rotationOverLifetimeModule.rotation.Evaluate(particle->randomAngularVelocity, trailFrac);
+                trail->angle = particle->initialAngle + MILLI2SEC(trailAge) * angularVelocity;
+            } else if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::RotationBySpeed)) {
+                float l = Math::Fabs(stage->rotationBySpeedModule.speedRange[1] - stage->rotationBySpeedModule.speedRange[0]);
+                float speedFrac = (UnitToMeter(trailSpeed) - stage->rotationBySpeedModule.speedRange[0]) / l;
+                float angularVelocity = stage->rotationBySpeedModule.rotation.Evaluate(particle->randomSize, speedFrac);
+                trail->angle = particle->initialAngle + MILLI2SEC(trailAge) * angularVelocity;
+            } else {
+                trail->angle = particle->initialAngle;
+            }
+
+            // Compute color.
+            if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTColor)) {
+                if (trailFrac < stage->colorOverLifetimeModule.fadeLocation) {
+                    // fade in.
+                    float f = trailFrac / stage->colorOverLifetimeModule.fadeLocation;
+                    trail->color = Math::Lerp(stage->colorOverLifetimeModule.targetColor, particle->initialColor, f);
+                } else {
+                    // fade out.
+                    float f = (trailFrac - stage->colorOverLifetimeModule.fadeLocation) / (1.f - stage->colorOverLifetimeModule.fadeLocation);
+                    trail->color = Math::Lerp(particle->initialColor, stage->colorOverLifetimeModule.targetColor, f);
+                }
+            } else {
+                trail->color = particle->initialColor;
+            }
+
+            // Compute position.
+            if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::CustomPath)) {
+                ComputeCustomPathPosition(stage->customPathModule, particle, trailFrac, trail->position);
+            } else if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTSpeed)) {
+                float dist = particle->initialSpeed * trailFrac + MeterToUnit(stage->speedOverLifetimeModule.speed.Integrate(particle->randomSpeed, trailFrac));
+
+                trail->position = particle->initialPosition + particle->direction * dist;
+            } else {
+                float dist = particle->initialSpeed * trailFrac;
+
+                trail->position = particle->initialPosition + particle->direction * dist;
+            }
+
+            // Apply force.
+            if (stage->moduleFlags & BIT(ParticleSystem::ModuleBit::LTForce)) {
+                Vec3 force(
+                    MeterToUnit(stage->forceOverLifetimeModule.force[0].Evaluate(particle->randomForce.x, trailFrac)),
+                    MeterToUnit(stage->forceOverLifetimeModule.force[1].Evaluate(particle->randomForce.y, trailFrac)),
+                    MeterToUnit(stage->forceOverLifetimeModule.force[2].Evaluate(particle->randomForce.z, trailFrac)));
+
+                trail->position += force * 0.5f * trailFrac * trailFrac;
+            }
+
+            // Apply gravity.
+            trail->position.z -= MeterToUnit(stage->standardModule.gravity) * 0.5f * trailFrac * trailFrac;
+
+            if (globalSpace) {
+                trail->position = offsetMatrix * trail->position;
+            }
+
+            // Add trail bounds to the stage bounds.
+            job.bounds.AddAABB(Sphere(trail->position, PivotRadius(stage, trail->size)).ToAABB());
+        }
+    }
+}
+
+// Returns true if the curve value doesn't depend on t.
+static bool IsTimeInvariant(const MinMaxCurve &curve) {
+    return curve.type == MinMaxCurve::Type::Constant || curve.type == MinMaxCurve::Type::RandomBetweenTwoConstants;
+}
+
+// Evaluates the curve for the pivots. Constant curves are evaluated without branches in the loop.
+static void EvaluateCurve(const MinMaxCurve &curve, const float *random, const float *t, float *dst, int count) {
+    const float scalar = curve.scalar;
+
+    if (curve.type == MinMaxCurve::Type::Constant) {
+        const float value = scalar * curve.maxCurve.GetPoint(0);
+        for (int i = 0; i < count; i++) {
+            dst[i] = value;
+        }
+    } else if (curve.type == MinMaxCurve::Type::RandomBetweenTwoConstants) {
+        const float minValue = curve.minCurve.GetPoint(0);
+        const float maxValue = curve.maxCurve.GetPoint(0);
+        for (int i = 0; i < count; i++) {
+            dst[i] = scalar * Math::Lerp(minValue, maxValue, random[i]);
+        }
+    } else if (curve.type == MinMaxCurve::Type::Curve) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = scalar * curve.maxCurve.Evaluate(t[i]);
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            dst[i] = curve.Evaluate(random[i], t[i]);
+        }
+    }
+}
+
+// Returns the curve values for the pivots. Values of the time invariant curves are taken from the cache
+// filled once per block, and the others are evaluated into dst.
+static const float *CurveValues(const MinMaxCurve &curve, const float *random, const float *t, const float *cache, float *dst, int count) {
+    if (IsTimeInvariant(curve)) {
+        return cache;
+    }
+    EvaluateCurve(curve, random, t, dst, count);
+    return dst;
+}
+
+// Integrates the curve from 0 to t for the pivots.
+static void IntegrateCurve(const MinMaxCurve &curve, const float *random, const float *t, const float *cache, float *dst, int count) {
+    if (IsTimeInvariant(curve)) {
+        // Integral of the time invariant curve is the cached value multiplied by t.
+        simdProcessor->Mul(dst, cache, t, count);
+    } else {
+        for (int i = 0; i < count; i++) {
+            dst[i] = curve.Integrate(random[i], t[i]);
+        }
+    }
+}
+
+static void MetersToUnits(float *dst, const float *src, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = MeterToUnit(src[i]);
+    }
+}
+
+// Evaluates the time invariant curves of the lifetime modules once for the particles of the block.
+static void EvaluateTimeInvariantCurves(const ParticleSystem::Stage *stage, ParticleBlock &block) {
+    const int moduleFlags = stage->moduleFlags;
+    const int count = block.count;
+
+    // Time invariant curves ignore t.
+    const float *t = block.particleAge;
+
+    // Speed curve is not used for the custom path.
+    if ((moduleFlags & BIT(ParticleSystem::ModuleBit::LTSpeed)) && !(moduleFlags & BIT(ParticleSystem::ModuleBit::CustomPath))) {
+        const MinMaxCurve &curve = stage->speedOverLifetimeModule.speed;
+        if (IsTimeInvariant(curve)) {
+            EvaluateCurve(curve, block.randomSpeed, t, block.speedCurve, count);
+        }
+    }
+
+    if (moduleFlags & (BIT(ParticleSystem::ModuleBit::LTSize) | BIT(ParticleSystem::ModuleBit::SizeBySpeed))) {
+        const MinMaxCurve &curve = (moduleFlags & BIT(ParticleSystem::ModuleBit::LTSize)) ? stage->sizeOverLifetimeModule.size : stage->sizeBySpeedModule.size;
+        if (IsTimeInvariant(curve)) {
+            EvaluateCurve(curve, block.randomSize, t, block.sizeCurve, count);
+        }
+    }
+
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTAspectRatio)) {
+        const MinMaxCurve &curve = stage->aspectRatioOverLifetimeModule.aspectRatio;
+        if (IsTimeInvariant(curve)) {
+            EvaluateCurve(curve, block.randomAspectRatio, t, block.aspectRatioCurve, count);
+        }
+    }
+
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTRotation)) {
+        const MinMaxCurve &curve = stage->rotationOverLifetimeModule.rotation;
+        if (IsTimeInvariant(curve)) {
+            EvaluateCurve(curve, block.randomAngularVelocity, t, block.rotationCurve, count);
+        }
+    } else if (moduleFlags & BIT(ParticleSystem::ModuleBit::RotationBySpeed)) {
+        const MinMaxCurve &curve = stage->rotationBySpeedModule.rotation;
+        if (IsTimeInvariant(curve)) {
+            EvaluateCurve(curve, block.randomSize, t, block.rotationCurve, count);
+        }
+    }
+
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTForce)) {
+        for (int axis = 0; axis < 3; axis++) {
+            const MinMaxCurve &curve = stage->forceOverLifetimeModule.force[axis];
+            if (IsTimeInvariant(curve)) {
+                EvaluateCurve(curve, block.randomForce[axis], t, block.forceCurve[axis], count);
+            }
+        }
+    }
+}
+
+// Applies the lifetime modules to the trail pivots at the pivot index. Every stream operation matches the
+// scalar path in the order of the floating point operations, so the results are bitwise identical.
+static void SimulatePivots(const ParticleSystem::Stage *stage, int trailCount, int pivotIndex, ParticleBlock &block) {
+    const int moduleFlags = stage->moduleFlags;
+    const int count = block.count;
+
+    float *temp0 = block.temp[0];
+    float *temp1 = block.temp[1];
+    const float *values;
+
+    // Speed is needed only for the speed dependent modules.
+    if (moduleFlags & (BIT(ParticleSystem::ModuleBit::SizeBySpeed) | BIT(ParticleSystem::ModuleBit::RotationBySpeed))) {
+        if (moduleFlags & BIT(ParticleSystem::ModuleBit::CustomPath)) {
+            simdProcessor->Memset(block.speed, 0, count * sizeof(float));
+        } else if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTSpeed)) {
+            // LTSpeed module: speed = initialSpeed + speed(t)
+            values = CurveValues(stage->speedOverLifetimeModule.speed, block.randomSpeed, block.frac, block.speedCurve, temp0, count);
+            MetersToUnits(temp0, values, count);
+            simdProcessor->Add(block.speed, block.initialSpeed, temp0, count);
+        } else {
+            simdProcessor->Memcpy(block.speed, block.initialSpeed, count * sizeof(float));
+        }
+    }
+
+    // Compute size.
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTSize)) {
+        // LTSize module: size = initialSize * size(t)
+        values = CurveValues(stage->sizeOverLifetimeModule.size, block.randomSize, block.frac, block.sizeCurve, temp0, count);
+        simdProcessor->Mul(block.size, block.initialSize, values, count);
+    } else if (moduleFlags & BIT(ParticleSystem::ModuleBit::SizeBySpeed)) {
+        const ParticleSystem::SizeBySpeedModule &sizeBySpeedModule = stage->sizeBySpeedModule;
+        const float minSpeed = sizeBySpeedModule.speedRange[0];
+        const float l = Math::Fabs(sizeBySpeedModule.speedRange[1] - minSpeed);
+        for (int i = 0; i < count; i++) {
+            temp1[i] = (UnitToMeter(block.speed[i]) - minSpeed) / l;
+        }
+        values = CurveValues(sizeBySpeedModule.size, block.randomSize, temp1, block.sizeCurve, temp0, count);
+        simdProcessor->Mul(block.size, block.initialSize, values, count);
+    } else {
+        simdProcessor->Memcpy(block.size, block.initialSize, count * sizeof(float));
+    }
+
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::Trails)) {
+        const float trailScale = Math::Lerp(1.0f, stage->trailsModule.trailScale, (float)pivotIndex / trailCount);
+        simdProcessor->Mul(block.size, trailScale, block.size, count);
+    }
+
+    // Compute aspect ratio.
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTAspectRatio)) {
+        values = CurveValues(stage->aspectRatioOverLifetimeModule.aspectRatio, block.randomAspectRatio, block.frac, block.aspectRatioCurve, temp0, count);
+        simdProcessor->Mul(block.aspectRatio, block.initialAspectRatio, values, count);
+    }
+
+    // Compute rotation angle.
+    if (moduleFlags & (BIT(ParticleSystem::ModuleBit::LTRotation) | BIT(ParticleSystem::ModuleBit::RotationBySpeed))) {
+        if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTRotation)) {
+            values = CurveValues(stage->rotationOverLifetimeModule.rotation, block.randomAngularVelocity, block.frac, block.rotationCurve, temp0, count);
+        } else {
+            // RotationBySpeed module
+            const ParticleSystem::RotationBySpeedModule &rotationBySpeedModule = stage->rotationBySpeedModule;
+            const float minSpeed = rotationBySpeedModule.speedRange[0];
+            const float l = Math::Fabs(rotationBySpeedModule.speedRange[1] - minSpeed);
+            for (int i = 0; i < count; i++) {
+                temp1[i] = (UnitToMeter(block.speed[i]) - minSpeed) / l;
+            }
+            values = CurveValues(rotationBySpeedModule.rotation, block.randomSize, temp1, block.rotationCurve, temp0, count);
+        }
+
+        // angle = initialAngle + MILLI2SEC(age) * angularVelocity
+        simdProcessor->Mul(temp1, Math::MulMilliToSecond, block.age, count);
+        simdProcessor->Mul(temp0, temp1, values, count);
+        simdProcessor->Add(block.angle, block.initialAngle, temp0, count);
+    }
+
+    // Compute color.
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTColor)) {
+        // LTColor module: fade in from the target color to the initial color, and fade out to the target color.
+        const Color4 &targetColor = stage->colorOverLifetimeModule.targetColor;
+        const float fadeLocation = stage->colorOverLifetimeModule.fadeLocation;
+
+        // Numerator and denominator of the fade fraction are selected without branches.
+        const float fadeOutLength = 1.f - fadeLocation;
+        for (int i = 0; i < count; i++) {
+            bool fadeIn = block.frac[i] < fadeLocation;
+            float numerator = fadeIn ? block.frac[i] : block.frac[i] - fadeLocation;
+            float denominator = fadeIn ? fadeLocation : fadeOutLength;
+            temp0[i] = numerator / denominator;
+        }
+
+        for (int c = 0; c < 4; c++) {
+            const float *initialColor = block.initialColor[c];
+            float *color = block.color[c];
+            const float target = targetColor[c];
+
+            for (int i = 0; i < count; i++) {
+                bool fadeIn = block.frac[i] < fadeLocation;
+                float from = fadeIn ? target : initialColor[i];
+                float to = fadeIn ? initialColor[i] : target;
+                color[i] = from + ((to - from) * temp0[i]);
+            }
+        }
+    }
+
+    // Compute position.
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::CustomPath)) {
+        for (int i = 0; i < count; i++) {
+            Vec3 position;
+            ComputeCustomPathPosition(stage->customPathModule, block.particles[i], block.frac[i], position);
+
+            block.position[0][i] = position.x;
+            block.position[1][i] = position.y;
+            block.position[2][i] = position.z;
+        }
+    } else {
+        // dist = initialSpeed * frac
+        simdProcessor->Mul(block.dist, block.initialSpeed, block.frac, count);
+
+        if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTSpeed)) {
+            // LTSpeed module: dist += integral of speed(t)
+            IntegrateCurve(stage->speedOverLifetimeModule.speed, block.randomSpeed, block.frac, block.speedCurve, temp0, count);
+            MetersToUnits(temp0, temp0, count);
+            simdProcessor->Add(block.dist, block.dist, temp0, count);
+        }
+
+        // position = initialPosition + direction * dist
+        for (int axis = 0; axis < 3; axis++) {
+            simdProcessor->Mul(block.position[axis], block.direction[axis], block.dist, count);
+            simdProcessor->Add(block.position[axis], block.initialPosition[axis], block.position[axis], count);
+        }
+    }
+
+    // Apply force.
+    if (moduleFlags & BIT(ParticleSystem::ModuleBit::LTForce)) {
+        // LTForce module: position += force * 0.5 * frac * frac
+        for (int axis = 0; axis < 3; axis++) {
+            values = CurveValues(stage->forceOverLifetimeModule.force[axis], block.randomForce[axis], block.frac, block.forceCurve[axis], temp0, count);
+            MetersToUnits(temp0, values, count);
+            simdProcessor->Mul(temp0, 0.5f, temp0, count);
+            simdProcessor->Mul(temp0, temp0, block.frac, count);
+            simdProcessor->Mul(temp0, temp0, block.frac, count);
+            simdProcessor->Add(block.position[axis], block.position[axis], temp0, count);
+        }
+    }
+
+    // Apply gravity.
+    simdProcessor->Mul(temp0, MeterToUnit(stage->standardModule.gravity) * 0.5f, block.frac, count);
+    simdProcessor->Mul(temp0, temp0, block.frac, count);
+    simdProcessor->Sub(block.position[2], block.position[2], temp0, count);
+}
+
+// Transforms the pivot positions into the local space of the particle system and adds the pivot bounds.
+static void ComputePivotBounds(const ParticleSystem::Stage *stage, ParticleBlock &block, AABB &bounds) {
+    const int count = block.count;
+
+    if (stage->standardModule.simulationSpace == ParticleSystem::StandardModule::SimulationSpace::Global) {
+        for (int i = 0; i < count; i++) {
+            Vec3 position = block.offsetMatrices[i] * Vec3(block.position[0][i], block.position[1][i], block.position[2][i]);
+
+            block.position[0][i] = position.x;
+            block.position[1][i] = position.y;
+            block.position[2][i] = position.z;
+        }
+    }
+
+    float *radius = block.temp[0];
+    simdProcessor->Mul(radius, 0.5f, block.size, count);
+
+    if (stage->standardModule.orientation == ParticleSystem::StandardModule::Orientation::Aimed ||
+        stage->standardModule.orientation == ParticleSystem::StandardModule::Orientation::AimedZ) {
+        simdProcessor->Mul(radius, 2.0f, radius, count);
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        const float *position = block.position[axis];
+        float minValue = bounds[0][axis];
+        float maxValue = bounds[1][axis];
+
+        for (int i = 0; i < count; i++) {
+            float lo = position[i] - radius[i];
+            float hi = position[i] + radius[i];
+            minValue = lo < minValue ? lo : minValue;
+            maxValue = hi > maxValue ? hi : maxValue;
+        }
+
+        bounds[0][axis] = minValue;
+        bounds[1][axis] = maxValue;
+    }
+}
+
+void ParticleSimulator::SimulateStageSIMD(StageJob &job) {
+    const ParticleSystem::Stage *stage = job.stage;
+    const bool globalSpace = stage->standardModule.simulationSpace == ParticleSystem::StandardModule::SimulationSpace::Global;
+    const int trailCount = TrailCount(stage);
+    const int pivotCount = 1 + trailCount;
+    const float lifeTime = stage->standardModule.lifeTime;
+    const bool trailCut = trailCount > 0 && stage->trailsModule.trailCut;
+
+    assert(trailCount <= Particle::MaxTrails);
+
+    const int moduleFlags = stage->moduleFlags;
+    const bool hasRandomSize = (moduleFlags & (BIT(ParticleSystem::ModuleBit::LTSize) | BIT(ParticleSystem::ModuleBit::SizeBySpeed) | BIT(ParticleSystem::ModuleBit::RotationBySpeed))) != 0;
+    const bool hasLTAspectRatio = (moduleFlags & BIT(ParticleSystem::ModuleBit::LTAspectRatio)) != 0;
+    const bool hasAngle = (moduleFlags & (BIT(ParticleSystem::ModuleBit::LTRotation) | BIT(ParticleSystem::ModuleBit::RotationBySpeed))) != 0;
+    const bool hasLTColor = (moduleFlags & BIT(ParticleSystem::ModuleBit::LTColor)) != 0;
+    const bool hasLTForce = (moduleFlags & BIT(ParticleSystem::ModuleBit::LTForce)) != 0;
+    const bool movesAlongDirection = (moduleFlags & BIT(ParticleSystem::ModuleBit::CustomPath)) == 0;
+
+    job.bounds.Clear();
+
+    ParticleBlock block;
+
+    for (int firstIndex = 0; firstIndex < job.numAliveParticles; firstIndex += ParticleBlockSize) {
+        const int count = Min(ParticleBlockSize, job.numAliveParticles - firstIndex);
+
+        // Gather the particle state into the streams. Only the streams read by the modules are gathered.
+        for (int i = 0; i < count; i++) {
+            Particle *particle = (Particle *)((byte *)job.particles + job.aliveParticles[firstIndex + i] * job.particleSize);
+
+            block.particles[i] = particle;
+            block.particleAge[i] = job.particleAges[firstIndex + i];
+            block.initialSpeed[i] = particle->initialSpeed;
+            block.initialSize[i] = particle->initialSize;
+
+            if (movesAlongDirection) {
+                for (int axis = 0; axis < 3; axis++) {
+                    block.direction[axis][i] = particle->direction[axis];
+                    block.initialPosition[axis][i] = particle->initialPosition[axis];
+                }
+                block.randomSpeed[i] = particle->randomSpeed;
+            }
+            if (hasLTForce) {
+                for (int axis = 0; axis < 3; axis++) {
+                    block.randomForce[axis][i] = particle->randomForce[axis];
+                }
+            }
+            if (hasRandomSize) {
+                block.randomSize[i] = particle->randomSize;
+            }
+            if (hasLTAspectRatio) {
+                block.initialAspectRatio[i] = particle->initialAspectRatio;
+                block.randomAspectRatio[i] = particle->randomAspectRatio;
+            }
+            if (hasAngle) {
+                block.initialAngle[i] = particle->initialAngle;
+                block.randomAngularVelocity[i] = particle->randomAngularVelocity;
+            }
+            if (hasLTColor) {
+                block.initialColor[0][i] = particle->initialColor.r;
+                block.initialColor[1][i] = particle->initialColor.g;
+                block.initialColor[2][i] = particle->initialColor.b;
+                block.initialColor[3][i] = particle->initialColor.a;
+            }
+            if (globalSpace) {
+                block.offsetMatrices[i] = job.invWorldMatrix * particle->worldMatrix;
+            }
+        }
+
+        block.count = count;
+
+        EvaluateTimeInvariantCurves(stage, block);
+
+        for (int pivotIndex = 0; pivotIndex < pivotCount; pivotIndex++) {
+            // Age offset of the trail pivots is same for all particles.
+            const float ageOffset = trailCount > 0 ? (stage->standardModule.lifeTime * stage->trailsModule.length) * pivotIndex / trailCount : 0.0f;
+
+            for (int i = 0; i < count; i++) {
+                float age = block.particleAge[i] - ageOffset;
+                if (trailCut) {
+                    age = age < 0 ? 0 : age;
+                }
+                block.age[i] = age;
+                block.frac[i] = age / lifeTime;
+            }
+
+            SimulatePivots(stage, trailCount, pivotIndex, block);
+
+            ComputePivotBounds(stage, block, job.bounds);
+
+            // Scatter the pivots to the particle trails. State not modified by the modules is copied from the particles.
+            for (int i = 0; i < count; i++) {
+                const Particle *particle = block.particles[i];
+                Particle::Trail *trail = &block.particles[i]->trails[pivotIndex];
+
+                trail->position.Set(block.position[0][i], block.position[1][i], block.position[2][i]);
+                trail->size = block.size[i];
+                trail->aspectRatio = hasLTAspectRatio ? block.aspectRatio[i] : particle->initialAspectRatio;
+                trail->angle = hasAngle ? block.angle[i] : particle->initialAngle;
+                if (hasLTColor) {
+                    trail->color.Set(block.color[0][i], block.color[1][i], block.color[2][i], block.color[3][i]);
+                } else {
+                    trail->color = particle->initialColor;
+                }
+            }
+        }
+    }
+}
+
+BE_NAMESPACE_END
@@ -95,7 +95,7 @@ void Batch::AddInstance(const DrawSurf *drawSurf) {
             RHI::DrawElementsIndirectCommand *currentIndirectCommand = &indirectCommands[numIndirectCommands - 1];
 
             // Check if continuous instance index
-            if (currentIndirectCommand->baseInstance + currentIndirectCommand->instanceCount == drawSurf->space->instanceIndex) {
+            if (currentIndirectCommand->baseInstance + currentIndirectCommand->instanceCount == drawSurf->instanceIndex) {
                 if (currentIndirectCommand->instanceCount < maxInstancingCount) {
                     currentIndirectCommand->instanceCount++;
                     numInstances++;
@@ -114,22 +114,23 @@ void Batch::AddInstance(const DrawSurf *drawSurf) {
         indirectCommands[numIndirectCommands].instanceCount = 1;
         indirectCommands[numIndirectCommands].firstIndex = 0;
         indirectCommands[numIndirectCommands].baseVertex = 0;
-        indirectCommands[numIndirectCommands].baseInstance = drawSurf->space->instanceIndex;
+        indirectCommands[numIndirectCommands].baseInstance = drawSurf->instanceIndex;
         numIndirectCommands++;
         numInstances++;
     } else {
         //assert(renderGlobal.instancingMethod == Mesh::InstancingMethod::UniformBuffer);
         if (instanceStartIndex < 0) {
-            instanceStartIndex = drawSurf->space->instanceIndex;
-        } else if (drawSurf->space->instanceIndex - instanceStartIndex + 1 >= maxInstancingCount) {
+            instanceStartIndex = drawSurf->instanceIndex;
+        } else if (drawSurf->instanceIndex < instanceStartIndex || Max(instanceEndIndex, drawSurf->instanceIndex) - instanceStartIndex + 1 >= maxInstancingCount) {
+            // Instance indexes are persistent slots, so the bound range [start, end] must cover every instance in the batch.
             Flush();
 
-            instanceStartIndex = drawSurf->space->instanceIndex;
+            instanceStartIndex = drawSurf->instanceIndex;
         }
 
-        instanceEndIndex = drawSurf->space->instanceIndex;
+        instanceEndIndex = Max(instanceEndIndex, drawSurf->instanceIndex);
 
-        instanceLocalIndexes[numInstances] = drawSurf->space->instanceIndex - instanceStartIndex;
+        instanceLocalIndexes[numInstances] = drawSurf->instanceIndex - instanceStartIndex;
 
         numInstances++;
     }
@@ -188,9 +189,12 @@ void Batch::DrawDynamicSubMesh(SubMesh *subMesh) {
 }
 
 void Batch::SetSubMeshVertexFormat(const SubMesh *subMesh, int vertexFormatIndex) const {
-    // HACK!!
-    // TODO: check vertex type of the subMesh instead of this.
-    int vertexSize = subMesh->GetType() != Mesh::Type::Dynamic ? sizeof(VertexGenericLit) : sizeof(VertexGeneric);
+    int vertexSize = subMesh->VertexSize();
+
+    if (subMesh->IsCompactVertex()) {
+        // Compact vertex formats have the same layout of the indices as the generic ones.
+        vertexFormatIndex += VertexFormat::Type::CompactXyz - VertexFormat::Type::GenericXyz;
+    }
 
     if (numIndirectCommands > 0 && renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays) {
         if (subMesh->useGpuSkinning) {
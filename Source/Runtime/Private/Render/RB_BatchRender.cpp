@@ -224,7 +224,23 @@ void Batch::SetSkinningConstants(const Shader *shader, const SkinningJointCache
     }
 }
 
+void Batch::SetVertexDecodeConstants(const Shader *shader) const {
+    if (!subMesh->IsCompactVertex()) {
+        // vertexDecodeScale.w is zero for the uncompressed vertices.
+        shader->SetConstant4f(shader->builtInConstantIndices[Shader::BuiltInConstant::VertexDecodeScale], Vec4::zero);
+        return;
+    }
+
+    Vec3 decodeScale, decodeBias;
+    subMesh->GetPositionDecodeScaleBias(decodeScale, decodeBias);
+
+    shader->SetConstant4f(shader->builtInConstantIndices[Shader::BuiltInConstant::VertexDecodeScale], Vec4(decodeScale, 1.0f));
+    shader->SetConstant3f(shader->builtInConstantIndices[Shader::BuiltInConstant::VertexDecodeBias], decodeBias);
+}
+
 void Batch::SetEntityConstants(const Material::ShaderPass *mtrlPass, const Shader *shader) const {
+    SetVertexDecodeConstants(shader);
+
     if (subMesh->useGpuSkinning) {
         SetSkinningConstants(shader, surfSpace->def->GetState().mesh->skinningJointCache);
     }
@@ -297,6 +313,24 @@ void Batch::SetProbeConstants(const Shader *shader) const {
     }
 }
 
+void Batch::SetLightGridConstants(const Shader *shader) const {
+    if (!r_clusteredLighting.GetBool()) {
+        return;
+    }
+
+    if (!backEnd.camera->clusteredLighting) {
+        // .w holds the number of the clustered lights.
+        static const int noClusteredLights[4] = { 0, 0, 0, 0 };
+        shader->SetConstant4i("clusterDataBase", noClusteredLights);
+        return;
+    }
+
+    shader->SetTexture("clusterLightMap", backEnd.camera->lightGridBufferCache->texture);
+    shader->SetConstant4i("clusterDataBase", backEnd.camera->lightGridBase);
+    shader->SetConstant2f("clusterSliceScaleBias", backEnd.camera->lightGridSliceScaleBias);
+    shader->SetConstant4x4f("clusterViewProjectionMatrix", true, backEnd.camera->def->GetViewProjMatrix());
+}
+
 void Batch::SetMaterialConstants(const Material::ShaderPass *mtrlPass, const Shader *shader) const {
     if (shader->builtInConstantIndices[Shader::BuiltInConstant::TextureMatrixS] >= 0) {
         Vec4 textureMatrixS = Vec4(mtrlPass->tcScale[0], 0.0f, 0.0f, mtrlPass->tcTranslation[0]);
@@ -499,6 +533,8 @@ void Batch::RenderVelocity(const Material::ShaderPass *mtrlPass) const {
         shader->SetConstant1f(shader->builtInConstantIndices[Shader::BuiltInConstant::PerforatedAlpha], mtrlPass->cutoffAlpha);
     }
 
+    SetVertexDecodeConstants(shader);
+
     if (subMesh->useGpuSkinning) {
         SetSkinningConstants(shader, surfSpace->def->GetState().mesh->skinningJointCache);
     }
@@ -666,6 +702,8 @@ void Batch::RenderIndirectLit(const Material::ShaderPass *mtrlPass) const {
 
     shader->SetConstant3f(shader->builtInConstantIndices[Shader::BuiltInConstant::ViewOrigin], backEnd.camera->def->GetState().origin);
 
+    SetLightGridConstants(shader);
+
     DrawPrimitives();
 }
 
@@ -693,7 +731,7 @@ void Batch::RenderAmbient_DirectLit(const Material::ShaderPass *mtrlPass, float
 
     bool useShadowMap = false;
     if (r_shadows.GetInteger()) {
-        if ((surfLight->def->GetState().flags & RenderLight::Flag::CastShadows) && (surfSpace->def->GetState().flags & RenderObject::Flag::ReceiveShadows)) {
+        if (surfLight->castShadows && (surfSpace->def->GetState().flags & RenderObject::Flag::ReceiveShadows)) {
             shader = GetShadowShader(shader, surfLight->def->GetState().type);
             useShadowMap = true;
         }
@@ -760,7 +798,7 @@ void Batch::RenderIndirectLit_DirectLit(const Material::ShaderPass *mtrlPass) co
 
     bool useShadowMap = false;
     if (r_shadows.GetInteger()) {
-        if ((surfLight->def->GetState().flags & RenderLight::Flag::CastShadows) && (surfSpace->def->GetState().flags & RenderObject::Flag::ReceiveShadows)) {
+        if (surfLight->castShadows && (surfSpace->def->GetState().flags & RenderObject::Flag::ReceiveShadows)) {
             shader = GetShadowShader(shader, surfLight->def->GetState().type);
             useShadowMap = true;
         }
@@ -810,6 +848,8 @@ void Batch::RenderIndirectLit_DirectLit(const Material::ShaderPass *mtrlPass) co
 
     SetupLightingShader(mtrlPass, shader, useShadowMap);
 
+    SetLightGridConstants(shader);
+
     DrawPrimitives();
 }
 
@@ -852,10 +892,23 @@ void Batch::SetupLightingShader(const Material::ShaderPass *mtrlPass, const Shad
 
             shader->SetTexture(shader->builtInSamplerUnits[Shader::BuiltInSampler::CubicNormalCubeMap], textureManager.cubicNormalCubeMapTexture);
             shader->SetTexture(shader->builtInSamplerUnits[Shader::BuiltInSampler::IndirectionCubeMap], backEnd.ctx->indirectionCubeMapTexture);
-            shader->SetTexture(shader->builtInSamplerUnits[Shader::BuiltInSampler::ShadowMap], backEnd.ctx->vscmRT->DepthStencilTexture());
+            shader->SetTexture(shader->builtInSamplerUnits[Shader::BuiltInSampler::ShadowMap], backEnd.ctx->shadowAtlasRT->DepthStencilTexture());
+
+            // Scale and bias the normalized VSCM coordinates to the tile inside the border.
+            const Rect &tileRect = backEnd.ctx->shadowAtlas.GetTileRect(surfLight->shadowCache->tile);
+            float invAtlasSize = 1.0f / backEnd.ctx->shadowAtlasRT->GetWidth();
+            int vscmFaceWidth = (tileRect.w - 2) / 3;
+            int vscmFaceHeight = (tileRect.h - 2) / 2;
+
+            Vec4 tileScaleBias;
+            tileScaleBias.x = vscmFaceWidth * 3 * invAtlasSize;
+            tileScaleBias.y = vscmFaceHeight * 2 * invAtlasSize;
+            tileScaleBias.z = (tileRect.x + 1) * invAtlasSize;
+            tileScaleBias.w = (tileRect.y + 1) * invAtlasSize;
+            shader->SetConstant4f("shadowAtlasTileScaleBias", tileScaleBias);
         } else if (surfLight->def->GetState().type == RenderLight::Type::Spot) {
             shader->SetConstant4x4f(shader->builtInConstantIndices[Shader::BuiltInConstant::ShadowProjMatrix], true, backEnd.shadowViewProjectionScaleBiasMatrix[0]);
-            shader->SetTexture(shader->builtInSamplerUnits[Shader::BuiltInSampler::ShadowArrayMap], backEnd.ctx->shadowMapRT->DepthStencilTexture());
+            shader->SetTexture(shader->builtInSamplerUnits[Shader::BuiltInSampler::ShadowMap], backEnd.ctx->shadowAtlasRT->DepthStencilTexture());
         } else if (surfLight->def->GetState().type == RenderLight::Type::Directional) {
             shader->SetConstantArray4x4f(shader->builtInConstantIndices[Shader::BuiltInConstant::ShadowCascadeProjMatrix], true, r_CSM_count.GetInteger(), backEnd.shadowViewProjectionScaleBiasMatrix);
 
@@ -872,9 +925,9 @@ void Batch::SetupLightingShader(const Material::ShaderPass *mtrlPass, const Shad
 
         Vec2 shadowMapTexelSize;
 
-        if (surfLight->def->GetState().type == RenderLight::Type::Point) {
-            shadowMapTexelSize.x = 1.0f / backEnd.ctx->vscmRT->GetWidth();
-            shadowMapTexelSize.y = 1.0f / backEnd.ctx->vscmRT->GetHeight();
+        if (surfLight->def->GetState().type != RenderLight::Type::Directional) {
+            shadowMapTexelSize.x = 1.0f / backEnd.ctx->shadowAtlasRT->GetWidth();
+            shadowMapTexelSize.y = 1.0f / backEnd.ctx->shadowAtlasRT->GetHeight();
         } else {
             shadowMapTexelSize.x = 1.0f / backEnd.ctx->shadowMapRT->GetWidth();
             shadowMapTexelSize.y = 1.0f / backEnd.ctx->shadowMapRT->GetHeight();
@@ -922,7 +975,7 @@ void Batch::RenderLightInteraction(const Material::ShaderPass *mtrlPass) const {
 
     bool useShadowMap = false;
     if (r_shadows.GetInteger()) {
-        if ((surfLight->def->GetState().flags & RenderLight::Flag::CastShadows) && (surfSpace->def->GetState().flags & RenderObject::Flag::ReceiveShadows)) {
+        if (surfLight->castShadows && (surfSpace->def->GetState().flags & RenderObject::Flag::ReceiveShadows)) {
             shader = GetShadowShader(shader, surfLight->def->GetState().type);
             useShadowMap = true;
         }
@@ -995,6 +1048,8 @@ void Batch::RenderFogLightInteraction(const Material::ShaderPass *mtrlPass) cons
     shader->SetConstant4x4f(shader->builtInConstantIndices[Shader::BuiltInConstant::LightTextureMatrix], true, viewProjScaleBiasMat);
     shader->SetConstant3f("fogColor", &surfLight->def->GetState().materialParms[RenderObject::MaterialParm::Red]);
 
+    SetVertexDecodeConstants(shader);
+
     ALIGN_AS32 Vec3 vec = surfLight->def->GetState().origin - backEnd.camera->def->GetState().origin;
     bool fogEnter = vec.Dot(surfLight->def->GetState().axis[0]) < 0.0f ? true : false;
 
@@ -1041,6 +1096,8 @@ void Batch::RenderBlendLightInteraction(const Material::ShaderPass *mtrlPass) co
     shader->SetConstant4x4f(shader->builtInConstantIndices[Shader::BuiltInConstant::LightTextureMatrix], true, viewProjScaleBiasMat);
     shader->SetConstant3f("blendColor", blendColor);
 
+    SetVertexDecodeConstants(shader);
+
     const Material *lightMaterial = surfLight->def->GetState().material;
     shader->SetTexture("blendProjectionMap", lightMaterial->GetPass()->texture);
 
@@ -42,6 +42,11 @@ static void RB_LitPass(const VisLight *visLight) {
             continue;
         }
 
+        // Clustered light is already applied to the surfaces which are indirect lit in the base pass.
+        if (visLight->clustered && r_indirectLit.GetBool() && drawSurf->space->envProbeInfo[0].envProbe) {
+            continue;
+        }
+
         if (drawSurf->material->GetPass()->renderingMode != Material::RenderingMode::AlphaBlend || 
             drawSurf->material->GetPass()->transparency == Material::Transparency::TwoPassesOneSide) {
             if (!depthBoundTestEnabled && r_useDepthBoundTest.GetBool()) {
@@ -162,11 +167,8 @@ void RB_ForwardAdditivePass(const LinkList<VisLight> *visLights) {
 
         RB_SetupLight(visLight);
 
-        if (r_shadows.GetInteger() != 0) {
-            if ((visLight->def->GetState().flags & RenderLight::Flag::CastShadows) &&
-                !(backEnd.camera->def->GetState().flags & RenderCamera::Flag::NoShadows)) {
-                RB_ShadowPass(visLight);
-            }
+        if (visLight->castShadows) {
+            RB_ShadowPass(visLight);
         }
 
         RB_LitPass(visLight);
@@ -111,11 +111,8 @@ void RB_ForwardBasePass(int numDrawSurfs, DrawSurf **drawSurfs) {
     if (backEnd.primaryLight) {
         RB_SetupLight(backEnd.primaryLight);
 
-        if (r_shadows.GetInteger() != 0) {
-            if ((backEnd.primaryLight->def->GetState().flags & RenderLight::Flag::CastShadows) &&
-                !(backEnd.camera->def->GetState().flags & RenderCamera::Flag::NoShadows)) {
-                RB_ShadowPass(backEnd.primaryLight);
-            }
+        if (backEnd.primaryLight->castShadows) {
+            RB_ShadowPass(backEnd.primaryLight);
         }
     }
 
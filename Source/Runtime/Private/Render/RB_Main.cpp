@@ -16,6 +16,7 @@
 #include "Render/Render.h"
 #include "RenderInternal.h"
 #include "Platform/PlatformTime.h"
+#include "Image/EnvCubePrefilter.h"
 #include "RBackEnd.h"
 #include "Profiler/Profiler.h"
 
@@ -23,6 +24,7 @@ BE_NAMESPACE_BEGIN
 
 static const int HOM_CULL_TEXTURE_WIDTH = 4096;
 static const int HOM_CULL_TEXTURE_HEIGHT = 1;
+static const int DFG_SUM_GGX_TEXTURE_SIZE = 512;
 
 RenderBackEnd   backEnd;
 
@@ -81,8 +83,12 @@ void RB_Init() {
     memset(backEnd.csmUpdate, 0, sizeof(backEnd.csmUpdate));
 
     backEnd.dfgSumGgxTexture = textureManager.AllocTexture("_dfgSumGgx");
-    backEnd.dfgSumGgxTexture->Load("Data/EngineTextures/DFGSumGGX.dds",
-        Texture::Flag::Clamp | Texture::Flag::Nearest | Texture::Flag::NoMipmaps | Texture::Flag::HighQuality);
+    if (!backEnd.dfgSumGgxTexture->Load("Data/EngineTextures/DFGSumGGX.dds",
+        Texture::Flag::Clamp | Texture::Flag::Nearest | Texture::Flag::NoMipmaps | Texture::Flag::HighQuality)) {
+        // Generate DFG LUT on the CPU if the baked one is missing.
+        backEnd.dfgSumGgxTexture->Create(RHI::TextureType::Texture2D, EnvCubePrefilter::GetGGXDFGSumImage(DFG_SUM_GGX_TEXTURE_SIZE),
+            Texture::Flag::Clamp | Texture::Flag::Nearest | Texture::Flag::NoMipmaps | Texture::Flag::HighQuality);
+    }
 
     if (r_HOM.GetBool()) {
         // TODO: create one for each context
@@ -104,6 +110,8 @@ void RB_Shutdown() {
 
     RB_FreeStencilStates();
 
+    EnvCubePrefilter::FreeCachedGGXDFGSumImages();
+
     backEnd.batch.Shutdown();
 }
 
@@ -524,7 +532,7 @@ static void RB_HiOcclusionPass(int numDrawSurfs, DrawSurf **drawSurfs) {
         return;
     }
 
-    if (backEnd.camera->def->GetState().clearMethod != RenderCamera::ClearMethod::Color || 
+    if (backEnd.camera->def->GetState().clearMethod != RenderCamera::ClearMethod::Color && 
         backEnd.camera->def->GetState().clearMethod != RenderCamera::ClearMethod::Skybox) {
         return;
     }
@@ -643,7 +651,7 @@ static void RB_DrawDebugShadowMap() {
         float x = space;
         float y = space;
 
-        const Texture *shadowTexture = backEnd.ctx->vscmRT->DepthStencilTexture();
+        const Texture *shadowTexture = backEnd.ctx->shadowAtlasRT->DepthStencilTexture();
 
         shadowTexture->Bind();
         rhi.SetTextureShadowFunc(false);
@@ -195,7 +195,7 @@ static bool RB_ComputeShadowCropMatrix(const Frustum &lightFrustum, const Frustu
     return true;
 }
 
-static bool RB_ShadowCubeMapFacePass(const VisLight *visLight, const Mat4 &lightViewMatrix, const Frustum &lightFrustum, const Frustum &viewFrustum, bool forceClear, int cubeMapFace) {
+static bool RB_ShadowCubeMapFacePass(const VisLight *visLight, const Mat4 &lightViewMatrix, const Frustum &lightFrustum, const Rect &faceRect) {
     const VisObject *   prevSpace = nullptr;
     const SubMesh *     prevSubMesh = nullptr;
     const VisObject *   skipObject = nullptr;
@@ -263,35 +263,15 @@ static bool RB_ShadowCubeMapFacePass(const VisLight *visLight, const Mat4 &light
         if (firstDraw) {
             firstDraw = false;
 
-            backEnd.ctx->vscmRT->Begin();
-
-            int vscmFaceWidth = backEnd.ctx->vscmRT->GetWidth() / 3;
-            int vscmFaceHeight = backEnd.ctx->vscmRT->GetHeight() / 2;
-
-            Rect faceRect;
-            faceRect.x = vscmFaceWidth * (cubeMapFace >> 1);
-            faceRect.y = vscmFaceHeight * (cubeMapFace & 1);
-            faceRect.w = vscmFaceWidth;
-            faceRect.h = vscmFaceHeight;
-
             rhi.SetViewport(faceRect);
             rhi.SetScissor(faceRect);
-
-            if (!backEnd.ctx->vscmCleared[cubeMapFace]) {
-                rhi.SetStateBits(RHI::DepthWrite);
-                rhi.Clear(RHI::ClearBit::Depth, Color4::black, 1.0f, 0);
-            } else {
-                backEnd.ctx->vscmCleared[cubeMapFace] = false;
-            }
         }
 
-        if (drawSurf->space != entity2) {
-            if (!(drawSurf->flags & DrawSurf::Flag::UseInstancing)) {
-                backEnd.modelViewMatrix = lightViewMatrix * drawSurf->space->def->GetWorldMatrix();
-                backEnd.modelViewProjMatrix = backEnd.projMatrix * backEnd.modelViewMatrix;
-            } else {
-                backEnd.batch.AddInstance(drawSurf);
-            }
+        if (drawSurf->flags & DrawSurf::Flag::UseInstancing) {
+            backEnd.batch.AddInstance(drawSurf);
+        } else if (drawSurf->space != entity2) {
+            backEnd.modelViewMatrix = lightViewMatrix * drawSurf->space->def->GetWorldMatrix();
+            backEnd.modelViewProjMatrix = backEnd.projMatrix * backEnd.modelViewMatrix;
 
             entity2 = drawSurf->space;
         }
@@ -301,37 +281,20 @@ static bool RB_ShadowCubeMapFacePass(const VisLight *visLight, const Mat4 &light
 
     if (!firstDraw) {
         backEnd.batch.Flush();
-
-        backEnd.ctx->vscmRT->End();
-    } else if (forceClear && !backEnd.ctx->vscmCleared[cubeMapFace]) {
-        firstDraw = false;
-
-        backEnd.ctx->vscmRT->Begin();
-
-        int vscmFaceWidth = backEnd.ctx->vscmRT->GetWidth() / 3;
-        int vscmFaceHeight = backEnd.ctx->vscmRT->GetHeight() / 2;
-
-        Rect faceRect;
-        faceRect.x = vscmFaceWidth * (cubeMapFace >> 1);
-        faceRect.y = vscmFaceHeight * (cubeMapFace & 1);
-        faceRect.w = vscmFaceWidth;
-        faceRect.h = vscmFaceHeight;
-
-        rhi.SetViewport(faceRect);
-        rhi.SetScissor(faceRect);
-                
-        rhi.SetStateBits(RHI::DepthWrite);
-        rhi.Clear(RHI::ClearBit::Depth, Color4::black, 1.0f, 0);
-
-        backEnd.ctx->vscmRT->End();
-
-        backEnd.ctx->vscmCleared[cubeMapFace] = true;
     }
 
     return !firstDraw;
 }
 
 static void RB_ShadowCubeMapPass(const VisLight *visLight, const Frustum &viewFrustum) {
+    RenderContext::ShadowCache *shadowCache = visLight->shadowCache;
+
+    if (visLight->shadowUpdate == VisLight::ShadowUpdate::Cached) {
+        // Shadow map in the tile is still valid.
+        backEnd.shadowProjectionDepth = shadowCache->projectionDepth;
+        return;
+    }
+
     float zNear = r_shadowCubeMapZNear.GetFloat();
     float zFar = visLight->def->GetMajorRadius();
     float zRangeInv = 1.0f / (zFar - zNear);
@@ -348,6 +311,14 @@ static void RB_ShadowCubeMapPass(const VisLight *visLight, const Frustum &viewFr
     float size = zFar * Math::Tan(Math::OneFourthPi);
     lightFrustum.SetSize(zNear, zFar, size, size);
 
+    // VSCM faces are placed inside the 1 texel border of the tile, so that the filtering doesn't read the neighbor tiles.
+    const Rect &tileRect = backEnd.ctx->shadowAtlas.GetTileRect(shadowCache->tile);
+    int vscmFaceWidth = (tileRect.w - 2) / 3;
+    int vscmFaceHeight = (tileRect.h - 2) / 2;
+
+    // Shadow map to be cached is rendered for all the faces regardless of the view.
+    bool cullFaces = visLight->shadowUpdate != VisLight::ShadowUpdate::Cache;
+
     int shadowMapDraw = 0;
 
     Mat3 axis;
@@ -357,12 +328,19 @@ static void RB_ShadowCubeMapPass(const VisLight *visLight, const Frustum &viewFr
     ALIGN_AS32 Mat4 prevViewProjMatrix = backEnd.viewProjMatrix;
     backEnd.projMatrix = backEnd.shadowProjectionMatrix;
 
+    backEnd.ctx->shadowAtlasRT->Begin();
+
+    rhi.SetViewport(tileRect);
+    rhi.SetScissor(tileRect);
+    rhi.SetStateBits(RHI::DepthWrite);
+    rhi.Clear(RHI::ClearBit::Depth, Color4::black, 1.0f, 0);
+
     for (int faceIndex = RHI::CubeMapFace::PositiveX; faceIndex <= RHI::CubeMapFace::NegativeZ; faceIndex++) {
         R_EnvCubeMapFaceToOpenGLAxis((RHI::CubeMapFace::Enum)faceIndex, axis);
 
         lightFrustum.SetAxis(axis);
 
-        if (viewFrustum.CullFrustum(lightFrustum)) {
+        if (cullFaces && viewFrustum.CullFrustum(lightFrustum)) {
             continue;
         }
 
@@ -376,13 +354,21 @@ static void RB_ShadowCubeMapPass(const VisLight *visLight, const Frustum &viewFr
 
         rhi.SetDepthBias(backEnd.shadowMapOffsetFactor, backEnd.shadowMapOffsetUnits);
 
-        if (RB_ShadowCubeMapFacePass(visLight, lightViewMatrix, lightFrustum, viewFrustum, true, faceIndex)) {
+        Rect faceRect;
+        faceRect.x = tileRect.x + 1 + vscmFaceWidth * (faceIndex >> 1);
+        faceRect.y = tileRect.y + 1 + vscmFaceHeight * (faceIndex & 1);
+        faceRect.w = vscmFaceWidth;
+        faceRect.h = vscmFaceHeight;
+
+        if (RB_ShadowCubeMapFacePass(visLight, lightViewMatrix, lightFrustum, faceRect)) {
             shadowMapDraw++;
         }
 
         rhi.SetDepthBias(0.0f, 0.0f);
     }
 
+    backEnd.ctx->shadowAtlasRT->End();
+
     backEnd.projMatrix = prevProjMatrix;
     backEnd.viewProjMatrix = prevViewProjMatrix;
 
@@ -390,10 +376,16 @@ static void RB_ShadowCubeMapPass(const VisLight *visLight, const Frustum &viewFr
     rhi.SetViewport(backEnd.renderRect);
 
     backEnd.ctx->GetRenderCounter().numShadowMapDraw += shadowMapDraw;
+
+    shadowCache->projectionDepth = backEnd.shadowProjectionDepth;
+
+    if (visLight->shadowUpdate == VisLight::ShadowUpdate::Cache) {
+        shadowCache->cachedVersion = visLight->shadowCacheVersion;
+        shadowCache->cachedCasterFilter = visLight->shadowCasterFilter;
+    }
 }
 
-// TODO: To be culled by for each cascades.
-static bool RB_ShadowMapPass(const VisLight *visLight, const Frustum &viewFrustum, int cascadeIndex, bool forceClear) {
+static bool RB_ShadowMapPass(const VisLight *visLight, const Frustum &viewFrustum, const RenderTarget *shadowRT, int cascadeIndex, const Rect &viewportRect, const Rect &scissorRect, bool forceClear) {
     const VisObject *   prevSpace = nullptr;
     const SubMesh *     prevSubMesh = nullptr;
     const Material *    prevMaterial = nullptr;
@@ -420,6 +412,11 @@ static bool RB_ShadowMapPass(const VisLight *visLight, const Frustum &viewFrustu
         if (!(drawSurf->flags & DrawSurf::Flag::ShadowVisible)) {
             continue;
         }
+
+        // Skip the shadow caster culled by this cascade in the frontend.
+        if (!(drawSurf->cascadeMask & BIT(cascadeIndex))) {
+            continue;
+        }
         
         if (!(drawSurf->material->GetSort() == Material::Sort::Opaque || drawSurf->material->GetSort() == Material::Sort::AlphaTest) && 
             !(drawSurf->material->GetFlags() & Material::Flag::ForceShadow)) {
@@ -429,12 +426,12 @@ static bool RB_ShadowMapPass(const VisLight *visLight, const Frustum &viewFrustu
         if (firstDraw) {
             firstDraw = false;
 
-            backEnd.ctx->shadowMapRT->Begin(0, cascadeIndex);
+            shadowRT->Begin(0, cascadeIndex);
 
-            rhi.SetViewport(Rect(0, 0, backEnd.ctx->shadowMapRT->GetWidth(), backEnd.ctx->shadowMapRT->GetHeight()));
+            rhi.SetViewport(viewportRect);
 
             prevScissorRect = rhi.GetScissor();
-            rhi.SetScissor(Rect::zero);
+            rhi.SetScissor(scissorRect);
             rhi.SetStateBits(RHI::DepthWrite);
             rhi.Clear(RHI::ClearBit::Depth, Color4::black, 1.0f, 0);
         }
@@ -475,23 +472,23 @@ static bool RB_ShadowMapPass(const VisLight *visLight, const Frustum &viewFrustu
     if (!firstDraw) {
         backEnd.batch.Flush();
 
-        backEnd.ctx->shadowMapRT->End();
+        shadowRT->End();
 
         rhi.SetScissor(prevScissorRect);
         rhi.SetViewport(backEnd.renderRect);
     } else if (forceClear) {
         firstDraw = false;
 
-        backEnd.ctx->shadowMapRT->Begin(0, cascadeIndex);
+        shadowRT->Begin(0, cascadeIndex);
 
-        rhi.SetViewport(Rect(0, 0, backEnd.ctx->shadowMapRT->GetWidth(), backEnd.ctx->shadowMapRT->GetHeight()));
+        rhi.SetViewport(viewportRect);
         prevScissorRect = rhi.GetScissor();
-        rhi.SetScissor(Rect::zero);
+        rhi.SetScissor(scissorRect);
         
         rhi.SetStateBits(RHI::DepthWrite);
         rhi.Clear(RHI::ClearBit::Depth, Color4::black, 1.0f, 0);
 
-        backEnd.ctx->shadowMapRT->End();
+        shadowRT->End();
 
         rhi.SetScissor(prevScissorRect);
         rhi.SetViewport(backEnd.renderRect);
@@ -544,19 +541,33 @@ static void RB_OrthogonalShadowMapPass(const VisLight *visLight, const Frustum &
     ALIGN_AS32 static const Mat4 textureScaleBiasMatrix(Vec4(0.5, 0, 0, 0.5), Vec4(0, 0.5, 0, 0.5), Vec4(0, 0, 0.5, 0.5), Vec4(0.0, 0.0, 0.0, 1));
     backEnd.shadowViewProjectionScaleBiasMatrix[0] = textureScaleBiasMatrix * backEnd.shadowProjectionMatrix * visLight->def->GetViewMatrix();
 
-    if (RB_ShadowMapPass(visLight, viewFrustum, 0, false)) {
+    const Rect shadowMapRect(0, 0, backEnd.ctx->shadowMapRT->GetWidth(), backEnd.ctx->shadowMapRT->GetHeight());
+
+    if (RB_ShadowMapPass(visLight, viewFrustum, backEnd.ctx->shadowMapRT, 0, shadowMapRect, Rect::zero, false)) {
         backEnd.ctx->GetRenderCounter().numShadowMapDraw++;
     }
 }
 
 static void RB_ProjectedShadowMapPass(const VisLight *visLight, const Frustum &viewFrustum) {
+    RenderContext::ShadowCache *shadowCache = visLight->shadowCache;
+
+    if (visLight->shadowUpdate == VisLight::ShadowUpdate::Cached) {
+        // Shadow map in the tile is still valid.
+        backEnd.shadowViewProjectionScaleBiasMatrix[0] = shadowCache->viewProjScaleBiasMatrix;
+        return;
+    }
+
     backEnd.shadowViewProjectionScaleBiasMatrix[0].SetZero();
 
     backEnd.shadowMapOffsetFactor = visLight->def->GetState().shadowOffsetFactor;
     backEnd.shadowMapOffsetUnits = visLight->def->GetState().shadowOffsetUnits;
 
     float dNear, dFar;
-    if (!RB_ComputeNearFar(visLight->def->GetWorldFrustum(), visLight->shadowCastersAABB, viewFrustum, &dNear, &dFar)) {
+    if (visLight->shadowUpdate == VisLight::ShadowUpdate::Cache) {
+        // Shadow map to be cached uses the whole light frustum regardless of the view.
+        dNear = visLight->def->GetWorldFrustum().GetNearDistance();
+        dFar = visLight->def->GetWorldFrustum().GetFarDistance();
+    } else if (!RB_ComputeNearFar(visLight->def->GetWorldFrustum(), visLight->shadowCastersAABB, viewFrustum, &dNear, &dFar)) {
         return;
     }
 
@@ -588,12 +599,30 @@ static void RB_ProjectedShadowMapPass(const VisLight *visLight, const Frustum &v
 
     backEnd.shadowMapFilterSize[0] = r_shadowMapFilterSize.GetFloat();
 
-    static const Mat4 textureScaleBiasMatrix(Vec4(0.5, 0, 0, 0.5), Vec4(0, 0.5, 0, 0.5), Vec4(0, 0, 0.5, 0.5), Vec4(0.0, 0.0, 0.0, 1));
+    // Shadow map is rendered inside the 1 texel border of the tile, so that the filtering doesn't read the neighbor tiles.
+    const Rect &tileRect = backEnd.ctx->shadowAtlas.GetTileRect(shadowCache->tile);
+    const Rect viewportRect(tileRect.x + 1, tileRect.y + 1, tileRect.w - 2, tileRect.h - 2);
+
+    float invAtlasSize = 1.0f / backEnd.ctx->shadowAtlasRT->GetWidth();
+    float sx = viewportRect.w * invAtlasSize;
+    float sy = viewportRect.h * invAtlasSize;
+    float bx = viewportRect.x * invAtlasSize;
+    float by = viewportRect.y * invAtlasSize;
+
+    // Texture scale bias matrix to the tile.
+    const Mat4 textureScaleBiasMatrix(Vec4(0.5f * sx, 0, 0, 0.5f * sx + bx), Vec4(0, 0.5f * sy, 0, 0.5f * sy + by), Vec4(0, 0, 0.5, 0.5), Vec4(0.0, 0.0, 0.0, 1));
     backEnd.shadowViewProjectionScaleBiasMatrix[0] = textureScaleBiasMatrix * backEnd.shadowProjectionMatrix * visLight->def->GetViewMatrix();
 
-    if (RB_ShadowMapPass(visLight, viewFrustum, 0, false)) {
+    if (RB_ShadowMapPass(visLight, viewFrustum, backEnd.ctx->shadowAtlasRT, 0, viewportRect, tileRect, true)) {
         backEnd.ctx->GetRenderCounter().numShadowMapDraw++;
     }
+
+    shadowCache->viewProjScaleBiasMatrix = backEnd.shadowViewProjectionScaleBiasMatrix[0];
+
+    if (visLight->shadowUpdate == VisLight::ShadowUpdate::Cache) {
+        shadowCache->cachedVersion = visLight->shadowCacheVersion;
+        shadowCache->cachedCasterFilter = visLight->shadowCasterFilter;
+    }
 }
 
 static bool RB_SingleCascadedShadowMapPass(const VisLight *visLight, const Frustum &splitViewFrustum, int cascadeIndex, bool forceClear) {
@@ -661,19 +690,23 @@ static bool RB_SingleCascadedShadowMapPass(const VisLight *visLight, const Frust
     static const Mat4 textureScaleBiasMatrix(Vec4(0.5, 0, 0, 0.5), Vec4(0, 0.5, 0, 0.5), Vec4(0, 0, 0.5, 0.5), Vec4(0.0, 0.0, 0.0, 1));
     backEnd.shadowViewProjectionScaleBiasMatrix[cascadeIndex] = textureScaleBiasMatrix * backEnd.shadowProjectionMatrix * visLight->def->GetViewMatrix();
 
-    return RB_ShadowMapPass(visLight, splitViewFrustum, cascadeIndex, forceClear);
+    const Rect shadowMapRect(0, 0, backEnd.ctx->shadowMapRT->GetWidth(), backEnd.ctx->shadowMapRT->GetHeight());
+
+    return RB_ShadowMapPass(visLight, splitViewFrustum, backEnd.ctx->shadowMapRT, cascadeIndex, shadowMapRect, Rect::zero, forceClear);
 }
 
 static void RB_CascadedShadowMapPass(const VisLight *visLight) {
-    float dNear = backEnd.camera->def->GetFrustum().GetNearDistance();
-    float dFar = r_CSM_maxDistance.GetFloat();
-    int csmCount = r_CSM_count.GetInteger();
+    // Split view frustums are computed in the frontend to cull the shadow casters for each cascades.
+    const ShadowCascades *shadowCascades = visLight->shadowCascades;
+    int csmCount = shadowCascades->NumCascades();
 
-    R_ComputeSplitDistances(dNear, dFar, r_CSM_splitLambda.GetFloat(), csmCount, backEnd.csmDistances);
+    for (int i = 0; i <= csmCount; i++) {
+        backEnd.csmDistances[i] = shadowCascades->GetSplitDistance(i);
+    }
 
     if (r_CSM_selectionMethod.GetInteger() == 0) {
         // Z-based selection shader needs shadowSplitFar value.
-        for (int cascadeIndex = 0; cascadeIndex < r_CSM_count.GetInteger(); cascadeIndex++) {
+        for (int cascadeIndex = 0; cascadeIndex < csmCount; cascadeIndex++) {
             float dFar = backEnd.csmDistances[cascadeIndex + 1];
 
             backEnd.csmFar[cascadeIndex] = (backEnd.projMatrix[2][2] * -dFar + backEnd.projMatrix[2][3]) / dFar;
@@ -696,17 +729,7 @@ static void RB_CascadedShadowMapPass(const VisLight *visLight) {
         }
         backEnd.csmUpdate[cascadeIndex] -= 1.0f;
 
-        Frustum splitViewFrustum = backEnd.camera->def->GetFrustum();
-        float dNear = backEnd.csmDistances[cascadeIndex];
-        float dFar = backEnd.csmDistances[cascadeIndex + 1];
-
-        if (r_CSM_blend.GetBool() && cascadeIndex > 0) {
-            // FIXME
-            dNear -= (backEnd.csmDistances[cascadeIndex] - backEnd.csmDistances[cascadeIndex - 1]);
-        }
-
-        splitViewFrustum.MoveNearDistance(dNear);
-        splitViewFrustum.MoveFarDistance(dFar);
+        const Frustum &splitViewFrustum = shadowCascades->GetSplitFrustum(cascadeIndex);
 
         if (RB_SingleCascadedShadowMapPass(visLight, splitViewFrustum, cascadeIndex, true)) {
             backEnd.ctx->GetRenderCounter().numShadowMapDraw++;
@@ -720,7 +743,7 @@ void RB_ShadowPass(const VisLight *visLight) {
     } else if (visLight->def->GetState().type == RenderLight::Type::Spot) {
         RB_ProjectedShadowMapPass(visLight, backEnd.camera->def->GetFrustum());
     } else if (visLight->def->GetState().type == RenderLight::Type::Directional) {
-        if ((visLight->def->GetState().flags & RenderLight::Flag::PrimaryLight) && r_CSM_count.GetInteger() > 1) {
+        if (visLight->shadowCascades) {
             RB_CascadedShadowMapPass(visLight);
         } else {
             RB_OrthogonalShadowMapPass(visLight, backEnd.camera->def->GetFrustum());
@@ -84,8 +84,10 @@ private:
     void                    SetMatrixConstants(const Shader *shader) const;
     void                    SetVertexColorConstants(const Shader *shader, const Material::VertexColorMode::Enum &vertexColor) const;
     void                    SetSkinningConstants(const Shader *shader, const SkinningJointCache *cache) const;
+    void                    SetVertexDecodeConstants(const Shader *shader) const;
     void                    SetEntityConstants(const Material::ShaderPass *mtrlPass, const Shader *shader) const;
     void                    SetProbeConstants(const Shader *shader) const;
+    void                    SetLightGridConstants(const Shader *shader) const;
     void                    SetMaterialConstants(const Material::ShaderPass *mtrlPass, const Shader *shader) const;
 
     void                    SetupLightingShader(const Material::ShaderPass *mtrlPass, const Shader *shader, bool useShadowMap) const;
@@ -176,7 +178,7 @@ struct RenderBackEnd {
     int                     numDrawSurfs;
     int                     numAmbientSurfs;
     DrawSurf **             drawSurfs;
-    BufferCache *           instanceBufferCache;
+    const BufferCache *     instanceBufferCache;
     LinkList<VisObject> *   visObjects;
     LinkList<VisLight> *    visLights;
     VisLight *              primaryLight;
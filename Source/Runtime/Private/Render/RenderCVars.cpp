@@ -33,11 +33,13 @@ CVAR(r_fastSkinning, "2", CVar::Flag::Integer | CVar::Flag::Archive, "matrix ski
 CVAR(r_vertexTextureUpdate, "2", CVar::Flag::Integer | CVar::Flag::Archive, "texel fetch buffer, 0 = direct copy, 1 = PBO, 2 = TBO");
 
 CVAR(r_shadows, "1", CVar::Flag::Integer | CVar::Flag::Archive, "enable shadows, 1 = shadow map");
-CVAR(r_shadowMapSize, "1024", CVar::Flag::Integer | CVar::Flag::Archive, "directional/projected shadow map size");
+CVAR(r_shadowMapSize, "1024", CVar::Flag::Integer | CVar::Flag::Archive, "directional shadow map size, and maximum projected shadow map size in the shadow atlas");
 CVAR(r_shadowMapFilterSize, "1.0", CVar::Flag::Float | CVar::Flag::Archive, "shadow map blurring filter size in centi-meter unit");
-CVAR(r_shadowCubeMapSize, "2048", CVar::Flag::Integer | CVar::Flag::Archive, "virtual shadow cube map size of each face");
+CVAR(r_shadowCubeMapSize, "2048", CVar::Flag::Integer | CVar::Flag::Archive, "maximum virtual shadow cube map size in the shadow atlas");
 CVAR(r_shadowCubeMapZNear, "0.04", CVar::Flag::Float, "");
-CVAR(r_shadowCubeMapFloat, "0", CVar::Flag::Bool | CVar::Flag::Archive, "use float texture for shadow cube map");
+CVAR(r_shadowCubeMapFloat, "0", CVar::Flag::Bool | CVar::Flag::Archive, "use float texture for shadow atlas");
+CVAR(r_shadowAtlasSize, "4096", CVar::Flag::Integer | CVar::Flag::Archive, "shadow atlas size for point/spot light shadow maps");
+CVAR(r_shadowCache, "1", CVar::Flag::Bool | CVar::Flag::Archive, "cache shadow maps of the point/spot lights while the light and shadow casters are not changed");
 CVAR(r_shadowMapQuality, "1", CVar::Flag::Integer | CVar::Flag::Archive, "shadow map PCF level, 0 = PCFx1, 1 = PCFx5, 2 = PCFx9, 3 = PCFx16 (randomly jittered sample)");
 CVAR(r_shadowMapCropAlign, "1", CVar::Flag::Bool, "");
 
@@ -61,11 +63,24 @@ CVAR(r_optimizedShadowProjection, "1", CVar::Flag::Integer, "");
 
 CVAR(r_HOM, "0", CVar::Flag::Bool, "use hierarchical occlusion map culling");
 CVAR(r_HOM_debug, "0", CVar::Flag::Bool, "");
+CVAR(r_softOcclusion, "1", CVar::Flag::Bool | CVar::Flag::Archive, "use occlusion culling with the CPU rasterized depth buffer");
+CVAR(r_softOcclusionWidth, "256", CVar::Flag::Integer, "width of the software occlusion buffer");
+CVAR(r_softOcclusionHeight, "128", CVar::Flag::Integer, "height of the software occlusion buffer");
+CVAR(r_softOcclusionMaxOccluders, "32", CVar::Flag::Integer, "maximum number of occluders rasterized per view");
+CVAR(r_softOcclusionAutoOccluderSize, "0", CVar::Flag::Float, "minimum projected size of objects automatically picked as occluders, 0 to use only flagged occluders");
+
+CVAR(r_lodBias, "1.0", CVar::Flag::Float | CVar::Flag::Archive, "projected screen sizes for the mesh LOD selection are multiplied by this");
+CVAR(r_lodHysteresis, "0.1", CVar::Flag::Float, "relative band of the LOD transition screen sizes to prevent LOD popping back and forth");
+CVAR(r_forceLOD, "-1", CVar::Flag::Integer, "force mesh LOD level, -1 to select LOD by the projected screen size");
+CVAR(r_clusterCulling, "1", CVar::Flag::Bool | CVar::Flag::Archive, "cull triangle clusters of the large static meshes");
+
+CVAR(r_particleMeshCache, "1", CVar::Flag::Bool, "generate vertices of the view independent particle systems once per frame and share them with all cameras");
 
 CVAR(r_ambientScale, "0.5", CVar::Flag::Float | CVar::Flag::Archive, "ambient intensities are mutipled by this");
 CVAR(r_lightScale, "1.0", CVar::Flag::Float | CVar::Flag::Archive, "all light intensities are multiplied by this");
 CVAR(r_indirectLit, "1", CVar::Flag::Bool | CVar::Flag::Archive, "use indirect lighting");
 CVAR(r_specularEnergyCompensation, "0", CVar::Flag::Bool | CVar::Flag::Archive, "use energy compensation for multiple scattering in a microfacet model");
+CVAR(r_clusteredLighting, "0", CVar::Flag::Bool | CVar::Flag::Archive, "shade point lights without shadows in the base pass with the clustered light grid instead of the additive passes");
 
 CVAR(r_probeBlending, "1", CVar::Flag::Bool | CVar::Flag::Archive, "use blending probe lighting");
 CVAR(r_probeBoxProjection, "1", CVar::Flag::Bool | CVar::Flag::Archive, "use box projected cubemap");
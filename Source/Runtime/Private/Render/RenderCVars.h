@@ -48,6 +48,8 @@ extern CVar     r_shadowMapFilterSize;
 extern CVar     r_shadowCubeMapSize;
 extern CVar     r_shadowCubeMapZNear;
 extern CVar     r_shadowCubeMapFloat;
+extern CVar     r_shadowAtlasSize;
+extern CVar     r_shadowCache;
 extern CVar     r_shadowMapQuality;
 extern CVar     r_shadowMapCropAlign;
 
@@ -71,11 +73,24 @@ extern CVar     r_optimizedShadowProjection;
 
 extern CVar     r_HOM;
 extern CVar     r_HOM_debug;
+extern CVar     r_softOcclusion;
+extern CVar     r_softOcclusionWidth;
+extern CVar     r_softOcclusionHeight;
+extern CVar     r_softOcclusionMaxOccluders;
+extern CVar     r_softOcclusionAutoOccluderSize;
+
+extern CVar     r_lodBias;
+extern CVar     r_lodHysteresis;
+extern CVar     r_forceLOD;
+extern CVar     r_clusterCulling;
+
+extern CVar     r_particleMeshCache;
 
 extern CVar     r_ambientScale;
 extern CVar     r_lightScale;
 extern CVar     r_indirectLit;
 extern CVar     r_specularEnergyCompensation;
+extern CVar     r_clusteredLighting;
 
 extern CVar     r_probeBlending;
 extern CVar     r_probeBoxProjection;
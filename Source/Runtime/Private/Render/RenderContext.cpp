@@ -389,6 +389,9 @@ void RenderContext::FreeHdrMapRT() {
     }
 }
 
+// Minimum tile size of the shadow atlas.
+static const int ShadowAtlasMinTileSize = 128;
+
 void RenderContext::InitShadowMapRT() {
     FreeShadowMapRT();
 
@@ -397,7 +400,7 @@ void RenderContext::InitShadowMapRT() {
     }
 
     Image::Format::Enum shadowImageFormat = Image::Format::Depth_24;
-    Image::Format::Enum shadowCubeImageFormat = (r_shadowCubeMapFloat.GetBool() && rhi.SupportsDepthBufferFloat()) ? Image::Format::Depth_32F : Image::Format::Depth_24;
+    Image::Format::Enum shadowAtlasImageFormat = (r_shadowCubeMapFloat.GetBool() && rhi.SupportsDepthBufferFloat()) ? Image::Format::Depth_32F : Image::Format::Depth_24;
 
     RHI::TextureType::Enum textureType = RHI::TextureType::Texture2DArray;
 
@@ -409,23 +412,21 @@ void RenderContext::InitShadowMapRT() {
         Texture::Flag::Shadow | Texture::Flag::Clamp | Texture::Flag::NoMipmaps | Texture::Flag::HighQuality | Texture::Flag::HighPriority);
     shadowMapRT = RenderTarget::Create(nullptr, shadowRenderTexture, 0);
 
-    // Create virtual shadow cube map.
-    vscmTexture = textureManager.AllocTexture(va("_%i_vscmRender", (int)contextHandle));
-    vscmTexture->CreateEmpty(RHI::TextureType::Texture2D, r_shadowCubeMapSize.GetInteger(), r_shadowCubeMapSize.GetInteger(), 1, 1, 1, shadowCubeImageFormat,
+    // Create shadow atlas for point/spot light shadow maps.
+    int shadowAtlasSize = Math::RoundUpPowerOfTwo(Max(r_shadowAtlasSize.GetInteger(), ShadowAtlasMinTileSize));
+
+    shadowAtlasTexture = textureManager.AllocTexture(va("_%i_shadowAtlas", (int)contextHandle));
+    shadowAtlasTexture->CreateEmpty(RHI::TextureType::Texture2D, shadowAtlasSize, shadowAtlasSize, 1, 1, 1, shadowAtlasImageFormat,
         Texture::Flag::Shadow | Texture::Flag::Clamp | Texture::Flag::NoMipmaps | Texture::Flag::HighQuality | Texture::Flag::HighPriority);
-    vscmRT = RenderTarget::Create(nullptr, vscmTexture, 0);
-    vscmRT->Clear(Color4(0, 0, 0, 0), 1.0f, 0);
+    shadowAtlasRT = RenderTarget::Create(nullptr, shadowAtlasTexture, 0);
+    shadowAtlasRT->Clear(Color4(0, 0, 0, 0), 1.0f, 0);
 
-    vscmCleared[0] = false;
-    vscmCleared[1] = false;
-    vscmCleared[2] = false;
-    vscmCleared[3] = false;
-    vscmCleared[4] = false;
-    vscmCleared[5] = false;
+    shadowAtlas.Init(shadowAtlasSize, ShadowAtlasMinTileSize);
 
+    // Indirection cube map to the normalized VSCM layout. It is scaled and biased to the tile of the point light in the shader.
     if (!indirectionCubeMapTexture) {
         indirectionCubeMapTexture = textureManager.AllocTexture(va("_%i_indirectionCubeMap", (int)contextHandle));
-        indirectionCubeMapTexture->CreateIndirectionCubemap(256, vscmRT->GetWidth(), vscmRT->GetHeight());
+        indirectionCubeMapTexture->CreateIndirectionCubemap(256, 3, 2);
     }
     vscmBiasedFov = DEG2RAD(90.0f + 0.8f);
     vscmBiasedScale = 1.0f / Math::Tan(vscmBiasedFov * 0.5f);
@@ -443,23 +444,113 @@ void RenderContext::FreeShadowMapRT() {
         }
     }
 
-    if (vscmRT) {
-        if (vscmTexture) {
-            textureManager.ReleaseTexture(vscmTexture, true);
+    if (shadowAtlasRT) {
+        if (shadowAtlasTexture) {
+            textureManager.ReleaseTexture(shadowAtlasTexture, true);
         }
 
-        if (vscmRT) {
-            RenderTarget::Delete(vscmRT);
-            vscmRT = nullptr;
+        if (shadowAtlasRT) {
+            RenderTarget::Delete(shadowAtlasRT);
+            shadowAtlasRT = nullptr;
         }
     }
 
+    FreeShadowCaches();
+
+    shadowAtlas.Shutdown();
+
     if (indirectionCubeMapTexture) {
         textureManager.ReleaseTexture(indirectionCubeMapTexture, true);
         indirectionCubeMapTexture = nullptr;
     }
 }
 
+void RenderContext::FreeShadowCaches() {
+    shadowCaches.DeleteContents(true);
+
+    shadowAtlas.FreeAllTiles();
+}
+
+RenderContext::ShadowCache *RenderContext::GetShadowCache(int lightKey, int tileSize) {
+    if (!shadowAtlas.IsInitialized()) {
+        return nullptr;
+    }
+
+    tileSize = shadowAtlas.ClampTileSize(tileSize);
+
+    ShadowCache *shadowCache;
+
+    auto *entry = shadowCaches.Get(lightKey);
+    if (entry) {
+        shadowCache = entry->second;
+    } else {
+        shadowCache = new ShadowCache;
+        shadowCaches.Set(lightKey, shadowCache);
+    }
+
+    if (shadowCache->tile >= 0) {
+        int currentTileSize = shadowAtlas.GetTileRect(shadowCache->tile).w;
+
+        // Keep the tile which is already used in this frame, or unless the size has grown or shrunk to a quarter.
+        if (shadowCache->lastUsedFrame == frameCount || (tileSize <= currentTileSize && tileSize > currentTileSize / 4)) {
+            shadowCache->lastUsedFrame = frameCount;
+            return shadowCache;
+        }
+
+        shadowAtlas.FreeTile(shadowCache->tile);
+        shadowCache->tile = -1;
+        shadowCache->cachedVersion = -1;
+    }
+
+    shadowCache->lastUsedFrame = frameCount;
+
+    // Evict the least recently used shadow caches, or shrink the tile if the atlas is full.
+    while (1) {
+        shadowCache->tile = shadowAtlas.AllocTile(tileSize);
+        if (shadowCache->tile >= 0) {
+            return shadowCache;
+        }
+
+        if (EvictShadowCache()) {
+            continue;
+        }
+
+        if (tileSize <= shadowAtlas.GetMinTileSize()) {
+            return nullptr;
+        }
+
+        tileSize >>= 1;
+    }
+}
+
+bool RenderContext::EvictShadowCache() {
+    // Shadow caches used in this frame are not evicted since the tiles are not rendered yet.
+    int evictIndex = -1;
+    int evictFrame = frameCount;
+
+    for (int i = 0; i < shadowCaches.Count(); i++) {
+        const ShadowCache *shadowCache = shadowCaches.GetByIndex(i)->second;
+
+        if (shadowCache->tile >= 0 && shadowCache->lastUsedFrame < evictFrame) {
+            evictIndex = i;
+            evictFrame = shadowCache->lastUsedFrame;
+        }
+    }
+
+    if (evictIndex < 0) {
+        return false;
+    }
+
+    auto *entry = shadowCaches.GetByIndex(evictIndex);
+    int lightKey = entry->first;
+
+    shadowAtlas.FreeTile(entry->second->tile);
+    delete entry->second;
+
+    shadowCaches.Remove(lightKey);
+    return true;
+}
+
 void RenderContext::OnResize(int width, int height) {
     float upscaleX = GetUpscaleFactorX();
     float upscaleY = GetUpscaleFactorY();
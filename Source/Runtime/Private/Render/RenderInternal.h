@@ -23,7 +23,7 @@ public:
     ALIGN_AS32 Mat4         modelViewProjMatrix;
     ALIGN_AS32 Mat3x4       modelViewMatrix;
 
-    int                     instanceIndex;
+    int                     lodIndex;           // mesh LOD level selected for this view
 
     EnvProbeBlendInfo       envProbeInfo[2];
 
@@ -37,6 +37,14 @@ public:
 
 class VisLight {
 public:
+    struct ShadowUpdate {
+        enum Enum {
+            Dynamic,            // Shadow map is rendered for this view
+            Cache,              // Shadow map is rendered independently of the view to be cached
+            Cached              // Cached shadow map is used
+        };
+    };
+
     ALIGN_AS32 Mat4         viewProjTexMatrix;
 
     Color4                  lightColor;
@@ -55,6 +63,19 @@ public:
                             // light bounding volume 에 포함되고, shadow caster 가 view frustum 에 보이는 surfaces (litSurfsAABB 를 포함한다)
     AABB                    shadowCastersAABB;
 
+                            // shaded in the base pass with the clustered light grid instead of the additive pass
+    bool                    clustered;
+
+                            // shadow map is rendered for this light
+    bool                    castShadows;
+                            // point/spot light shadow map in the tile of the shadow atlas
+    RenderContext::ShadowCache *shadowCache;
+    ShadowUpdate::Enum      shadowUpdate;
+    int                     shadowCacheVersion;
+    int                     shadowCasterFilter;
+                            // shadow cascades of the primary directional light to cull the shadow casters for each cascades
+    ShadowCascades *        shadowCascades;
+
     const RenderLight *     def;
     LinkList<VisLight>      node;
     int                     index;
@@ -77,10 +98,19 @@ public:
 
     int                     numAmbientSurfs;
 
+                            // occludees are tested against the software occlusion buffer
+    bool                    occlusionCulling;
+
     int                     numVisibleObjects;
     int                     numVisibleLights;
 
-    BufferCache *           instanceBufferCache;
+    const BufferCache *     instanceBufferCache;
+
+                            // lights, clusters and light indexes of the clustered light grid packed in the texel buffer
+    bool                    clusteredLighting;
+    const BufferCache *     lightGridBufferCache;
+    int                     lightGridBase[4];   // texel offsets of the lights, clusters and light indexes, and the number of lights
+    Vec2                    lightGridSliceScaleBias;
 
     LinkList<VisObject>     visObjects;
     LinkList<VisLight>      visLights;
@@ -92,7 +122,7 @@ struct RenderGlobal {
     int                     vertexTextureMethod;
     int                     instancingMethod;
     int                     instanceBufferOffsetAlignment;
-    void *                  instanceBufferData;
+    int                     maxInstances;       // initial slot count of the persistent instance buffer
 };
 
 extern RenderGlobal         renderGlobal;
@@ -19,6 +19,9 @@
 
 BE_NAMESPACE_BEGIN
 
+// Shadow cache keys and versions are issued from the same counter, so that they are unique in all the render worlds.
+static int shadowCacheCounter = 0;
+
 RenderLight::RenderLight(RenderWorld *renderWorld, int index) {
     this->renderWorld = renderWorld;
     this->index = index;
@@ -35,6 +38,9 @@ RenderLight::RenderLight(RenderWorld *renderWorld, int index) {
     proxy = nullptr;
 
     firstUpdate = true;
+
+    shadowCacheKey = ++shadowCacheCounter;
+    shadowCacheVersion = ++shadowCacheCounter;
 }
 
 RenderLight::~RenderLight() {
@@ -43,6 +49,10 @@ RenderLight::~RenderLight() {
     }
 }
 
+void RenderLight::InvalidateShadowCache() {
+    shadowCacheVersion = ++shadowCacheCounter;
+}
+
 void RenderLight::Update(const RenderLight::State *stateDef) {
     state = *stateDef;
 
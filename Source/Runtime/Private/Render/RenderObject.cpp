@@ -51,6 +51,9 @@ void RenderObject::Update(const State *stateDef) {
 
     worldAABB.SetFromTransformedAABBFast(state.aabb, worldMatrix);
     worldOBB = OBB(state.aabb, worldMatrix);
+
+    // Particles might be changed in the middle of the frame.
+    particleMeshFrameCount = -1;
 }
 
 BE_NAMESPACE_END
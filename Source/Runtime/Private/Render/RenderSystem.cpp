@@ -74,8 +74,8 @@ void RenderSystem::Init() {
         renderGlobal.instanceBufferOffsetAlignment = 0;
     }
 
-    renderGlobal.instanceBufferData = Mem_Alloc16(8192 * renderGlobal.instanceBufferOffsetAlignment);
-    memset(renderGlobal.instanceBufferData, 0, sizeof(8192 * renderGlobal.instanceBufferOffsetAlignment));
+    // Instance buffer of each render world grows from this.
+    renderGlobal.maxInstances = 16384;
 
     textureManager.Init();
 
@@ -144,8 +144,6 @@ void RenderSystem::Shutdown() {
 
     textureManager.Shutdown();
 
-    Mem_AlignedFree(renderGlobal.instanceBufferData);
-
     rhi.Shutdown();
 
     initialized = false;
@@ -494,6 +492,24 @@ void RenderSystem::CheckModifiedCVars() {
         }
     }
 
+    if (r_clusteredLighting.IsModified()) {
+        r_clusteredLighting.ClearModified();
+
+        bool foundDefine = shaderManager.FindGlobalHeader("#define CLUSTERED_LIGHTING\n");
+
+        if (r_clusteredLighting.GetBool() && renderGlobal.vertexTextureMethod == BufferCacheManager::VertexTextureMethod::Tbo) {
+            if (!foundDefine) {
+                shaderManager.AddGlobalHeader("#define CLUSTERED_LIGHTING\n");
+                shaderManager.ReloadLitSurfaceShaders();
+            }
+        } else {
+            if (foundDefine) {
+                shaderManager.RemoveGlobalHeader("#define CLUSTERED_LIGHTING\n");
+                shaderManager.ReloadLitSurfaceShaders();
+            }
+        }
+    }
+
     if (r_specularEnergyCompensation.IsModified()) {
         r_specularEnergyCompensation.ClearModified();
 
@@ -527,6 +543,19 @@ void RenderSystem::CheckModifiedCVars() {
         RecreateShadowMapRT();
     }
 
+    if (r_shadowAtlasSize.IsModified()) {
+        r_shadowAtlasSize.ClearModified();
+        RecreateShadowMapRT();
+    }
+
+    if (r_shadowCache.IsModified()) {
+        r_shadowCache.ClearModified();
+
+        for (int i = 0; i < renderContexts.Count(); i++) {
+            renderContexts[i]->FreeShadowCaches();
+        }
+    }
+
     if (r_shadows.IsModified()) {
         r_shadows.ClearModified();
 
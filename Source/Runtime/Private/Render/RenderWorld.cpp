@@ -62,6 +62,7 @@ void RenderWorld::ClearScene() {
     for (int i = 0; i < renderObjects.Count(); i++) {
         SAFE_DELETE(renderObjects[i]);
     }
+    instanceBuffer.Shutdown();
     for (int i = 0; i < renderLights.Count(); i++) {
         SAFE_DELETE(renderLights[i]);
     }
@@ -132,12 +133,28 @@ void RenderWorld::UpdateRenderObject(int handle, const RenderObject::State *def)
                 meshSurfProxy->id = staticMeshDbvt.CreateProxy(renderObject->meshSurfProxies[surfaceIndex].worldAABB, MeterToUnit(0.0f), &renderObject->meshSurfProxies[surfaceIndex]);
             }
         }
+
+        UpdateInstanceSlots(renderObject);
+
+        if (renderObject->state.flags & RenderObject::Flag::CastShadows) {
+            InvalidateShadowCaches(renderObject->GetWorldAABB());
+        }
     } else {
         const bool worldMatrixMatch = (def->worldMatrix == renderObject->state.worldMatrix);
         const bool aabbMatch = (def->aabb == renderObject->state.aabb);
         const bool meshMatch = (def->mesh == renderObject->state.mesh);
         const bool proxyMoved = !worldMatrixMatch || !aabbMatch;
 
+        // Skinned meshes are posed by the joints in every update, so they always invalidate the shadow caches.
+        const bool shadowChanged = proxyMoved || !meshMatch || def->joints ||
+            ((def->flags ^ renderObject->state.flags) & RenderObject::Flag::CastShadows) ||
+            !(def->materials == renderObject->state.materials);
+
+        // Shadow maps of the lights around the shadow caster should be updated at the previous and the new position.
+        if (shadowChanged && ((def->flags | renderObject->state.flags) & RenderObject::Flag::CastShadows)) {
+            InvalidateShadowCaches(renderObject->GetWorldAABB());
+        }
+
         Vec3 displacement;
         if (proxyMoved) {
             displacement = def->worldMatrix.ToTranslationVec3() - renderObject->state.worldMatrix.ToTranslationVec3();
@@ -180,6 +197,12 @@ void RenderWorld::UpdateRenderObject(int handle, const RenderObject::State *def)
         }
 
         renderObject->Update(def);
+
+        UpdateInstanceSlots(renderObject);
+
+        if ((renderObject->state.flags & RenderObject::Flag::CastShadows) && proxyMoved) {
+            InvalidateShadowCaches(renderObject->GetWorldAABB());
+        }
     }
 }
 
@@ -195,11 +218,17 @@ void RenderWorld::RemoveRenderObject(int handle) {
         return;
     }
 
+    if (renderObject->state.flags & RenderObject::Flag::CastShadows) {
+        InvalidateShadowCaches(renderObject->GetWorldAABB());
+    }
+
     objectDbvt.DestroyProxy(renderObject->proxy->id);
     for (int i = 0; i < renderObject->numMeshSurfProxies; i++) {
         staticMeshDbvt.DestroyProxy(renderObject->meshSurfProxies[i].id);
     }
 
+    FreeInstanceSlots(renderObject);
+
     delete renderObjects[handle];
     renderObjects[handle] = nullptr;
 }
@@ -251,6 +280,12 @@ void RenderWorld::UpdateRenderLight(int handle, const RenderLight::State *def) {
         const bool axisMatch = (def->axis == renderLight->state.axis);
         const bool valueMatch = (def->size == renderLight->state.size);
         const bool zNearMatch = (def->zNear == renderLight->state.zNear);
+        const bool shadowMatch = (def->type == renderLight->state.type && def->flags == renderLight->state.flags && def->layer == renderLight->state.layer &&
+            def->shadowOffsetFactor == renderLight->state.shadowOffsetFactor && def->shadowOffsetUnits == renderLight->state.shadowOffsetUnits);
+
+        if (!originMatch || !axisMatch || !valueMatch || !zNearMatch || !shadowMatch) {
+            renderLight->InvalidateShadowCache();
+        }
 
         if (!originMatch || !axisMatch || !valueMatch || !zNearMatch) {
             const Vec3 displacement = def->origin - renderLight->state.origin;
@@ -283,6 +318,18 @@ void RenderWorld::RemoveRenderLight(int handle) {
     renderLights[handle] = nullptr;
 }
 
+// Invalidates cached shadow maps of the lights intersecting with the bounds of the changed shadow caster.
+void RenderWorld::InvalidateShadowCaches(const AABB &worldAABB) {
+    lightDbvt.Query(worldAABB, [this](int32_t proxyId) -> bool {
+        const DbvtProxy *proxy = (const DbvtProxy *)lightDbvt.GetUserData(proxyId);
+
+        if (proxy->renderLight) {
+            proxy->renderLight->InvalidateShadowCache();
+        }
+        return true;
+    });
+}
+
 EnvProbe *RenderWorld::GetEnvProbe(int handle) const {
     if (handle < 0 || handle >= envProbes.Count()) {
         BE_WARNLOG("RenderWorld::GetEnvProbe: handle %i > %i\n", handle, envProbes.Count() - 1);
@@ -535,7 +582,7 @@ void RenderWorld::RenderScene(const RenderCamera *renderCamera) {
     currentVisCamera->def = renderCamera;
     currentVisCamera->maxDrawSurfs = MaxViewDrawSurfs; 
     currentVisCamera->drawSurfs = (DrawSurf **)frameData.Alloc(currentVisCamera->maxDrawSurfs * sizeof(DrawSurf *));
-    currentVisCamera->instanceBufferCache = (BufferCache *)frameData.ClearedAlloc(sizeof(BufferCache));
+    currentVisCamera->instanceBufferCache = instanceBuffer.GetBufferCache();
 
     new (&currentVisCamera->visObjects) LinkList<VisObject>();
     new (&currentVisCamera->visLights) LinkList<VisLight>();
@@ -76,6 +76,201 @@ VisLight *RenderWorld::RegisterVisLight(VisCamera *camera, RenderLight *renderLi
     return visLight;
 }
 
+// Select mesh LOD level by the projected screen height of the bounding sphere.
+// The transition screen size is widened by r_lodHysteresis in the direction away from the LOD
+// selected in the last main camera view, so that objects near the transition don't flicker.
+int RenderWorld::SelectMeshLOD(const VisCamera *camera, RenderObject *renderObject, const AABB &worldAABB) const {
+    const Mesh *mesh = renderObject->state.mesh;
+    if (!mesh || mesh->NumLODs() <= 1) {
+        return 0;
+    }
+
+    int maxLOD = mesh->NumLODs() - 1;
+
+    if (r_forceLOD.GetInteger() >= 0) {
+        return Min(r_forceLOD.GetInteger(), maxLOD);
+    }
+
+    const Array<float> &lodScreenSizes = renderObject->state.lodScreenSizes;
+    int numTransitions = Min(lodScreenSizes.Count(), maxLOD);
+    if (numTransitions == 0) {
+        return 0;
+    }
+
+    const RenderCamera::State &cameraState = camera->def->GetState();
+
+    float radius = (worldAABB[1] - worldAABB[0]).Length() * 0.5f;
+    float screenSize;
+    if (cameraState.orthogonal) {
+        screenSize = radius / cameraState.sizeY;
+    } else {
+        float distance = Max(worldAABB.Center().Distance(cameraState.origin), cameraState.zNear);
+        screenSize = radius / (distance * Math::Tan(DEG2RAD(cameraState.fovY) * 0.5f));
+    }
+    screenSize *= r_lodBias.GetFloat();
+
+    int lod = 0;
+    while (lod < numTransitions && screenSize < lodScreenSizes[lod]) {
+        lod++;
+    }
+
+    int prevLOD = Min(renderObject->lodIndex, numTransitions);
+    float hysteresis = r_lodHysteresis.GetFloat();
+
+    if (lod > prevLOD) {
+        // Switch to the coarser LOD only when the screen size is below the transition size by the hysteresis band.
+        while (lod > prevLOD && screenSize >= lodScreenSizes[lod - 1] * (1.0f - hysteresis)) {
+            lod--;
+        }
+    } else if (lod < prevLOD) {
+        // Switch to the finer LOD only when the screen size is above the transition size by the hysteresis band.
+        while (lod < prevLOD && screenSize < lodScreenSizes[lod] * (1.0f + hysteresis)) {
+            lod++;
+        }
+    }
+
+    // Sub cameras (e.g. reflection probes) don't disturb the hysteresis of the main view.
+    if (!camera->isSubCamera) {
+        renderObject->lodIndex = lod;
+    }
+
+    return lod;
+}
+
+// Rasterize occluders into the software occlusion buffer.
+// Occluders are the static mesh objects flagged as occluder, or the objects large enough on screen.
+void RenderWorld::RasterizeOccluders(VisCamera *camera) {
+    camera->occlusionCulling = false;
+
+    if (!r_softOcclusion.GetBool() || camera->is2D) {
+        return;
+    }
+
+    BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::RasterizeOccluders");
+
+    const RenderCamera::State &cameraState = camera->def->GetState();
+    const float autoOccluderSize = r_softOcclusionAutoOccluderSize.GetFloat();
+
+    struct Occluder {
+        RenderObject *      renderObject;
+        float               projectedSize;
+    };
+    Array<Occluder> occluders;
+
+    // Called for each scene objects that intersects with camera frustum.
+    // Returns true if it want to proceed next query.
+    auto addOccluders = [this, camera, &cameraState, autoOccluderSize, &occluders](int32_t proxyId) -> bool {
+        const DbvtProxy *proxy = (const DbvtProxy *)objectDbvt.GetUserData(proxyId);
+        RenderObject *renderObject = proxy->renderObject;
+
+        if (!renderObject || !renderObject->state.mesh || !renderObject->state.mesh->IsStaticMesh()) {
+            return true;
+        }
+
+        if (renderObject->state.flags & (RenderObject::Flag::SkipRendering | RenderObject::Flag::Billboard | RenderObject::Flag::DepthHack)) {
+            return true;
+        }
+
+        if (!(BIT(renderObject->state.layer) & cameraState.layerMask)) {
+            return true;
+        }
+
+        if (cameraState.flags & RenderCamera::Flag::StaticOnly) {
+            if (!(renderObject->state.staticMask & cameraState.staticMask)) {
+                return true;
+            }
+        }
+
+        if ((renderObject->state.flags & RenderObject::Flag::FirstPersonOnly) && camera->isSubCamera) {
+            return true;
+        }
+
+        if ((renderObject->state.flags & RenderObject::Flag::ThirdPersonOnly) && !camera->isSubCamera) {
+            return true;
+        }
+
+        // Approximate projected size with the bounding sphere.
+        float radius = (proxy->worldAABB[1] - proxy->worldAABB[0]).Length() * 0.5f;
+        float projectedSize;
+        if (cameraState.orthogonal) {
+            projectedSize = radius / cameraState.sizeY;
+        } else {
+            projectedSize = radius / Max(proxy->worldAABB.Center().Distance(cameraState.origin), cameraState.zNear);
+        }
+
+        if (!(renderObject->state.flags & RenderObject::Flag::Occluder)) {
+            if (autoOccluderSize <= 0.0f || projectedSize < autoOccluderSize) {
+                return true;
+            }
+        }
+
+        Occluder &occluder = occluders.Alloc();
+        occluder.renderObject = renderObject;
+        occluder.projectedSize = projectedSize;
+
+        return true;
+    };
+
+    if (cameraState.orthogonal) {
+        objectDbvt.Query(camera->def->box, addOccluders);
+    } else {
+        objectDbvt.Query(camera->def->frustum, addOccluders);
+    }
+
+    if (occluders.Count() == 0) {
+        return;
+    }
+
+    // Rasterize largest occluders first.
+    occluders.Sort([](const Occluder &a, const Occluder &b) {
+        return a.projectedSize > b.projectedSize;
+    });
+
+    int width = r_softOcclusionWidth.GetInteger();
+    int height = r_softOcclusionHeight.GetInteger();
+
+    if (!occlusionBuffer.IsInitialized() ||
+        occlusionBuffer.GetWidth() != ((width + OcclusionBuffer::TileWidth - 1) & ~(OcclusionBuffer::TileWidth - 1)) ||
+        occlusionBuffer.GetHeight() != ((height + OcclusionBuffer::TileHeight - 1) & ~(OcclusionBuffer::TileHeight - 1))) {
+        occlusionBuffer.Init(width, height);
+    }
+
+    occlusionBuffer.Clear(camera->def->viewProjMatrix);
+
+    int numOccluders = Min(occluders.Count(), r_softOcclusionMaxOccluders.GetInteger());
+
+    for (int occluderIndex = 0; occluderIndex < numOccluders; occluderIndex++) {
+        RenderObject *renderObject = occluders[occluderIndex].renderObject;
+        const Mesh *mesh = renderObject->state.mesh;
+
+        Mat4 modelViewProjMatrix = camera->def->viewProjMatrix * renderObject->GetWorldMatrix();
+
+        for (int surfaceIndex = 0; surfaceIndex < mesh->NumSurfaces(); surfaceIndex++) {
+            const MeshSurf *surf = mesh->GetSurface(surfaceIndex);
+            const Material *material = renderObject->state.materials[surf->materialIndex];
+
+            // Only opaque surfaces can occlude.
+            if (material->GetSort() != Material::Sort::Opaque) {
+                continue;
+            }
+
+            const SubMesh *subMesh = surf->subMesh;
+            if (!subMesh->Verts() || !subMesh->Indexes()) {
+                continue;
+            }
+
+            occlusionBuffer.AddOccluder(modelViewProjMatrix, &subMesh->Verts()->xyz, sizeof(VertexGenericLit), 
+                subMesh->NumVerts(), subMesh->Indexes(), subMesh->NumIndexes());
+        }
+
+        renderObject->occluderViewCount = viewCount;
+    }
+
+    occlusionBuffer.Rasterize();
+
+    camera->occlusionCulling = occlusionBuffer.NumTriangles() > 0;
+}
+
 // Add visible lights/objects using bounding view volume.
 void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
     BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::FindVisLightsAndObjects");
@@ -116,6 +311,11 @@ void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
             return true;
         }
 
+        // Skip if light bounding volume is hidden behind the occluders.
+        if (camera->occlusionCulling && !occlusionBuffer.IsAABBVisible(proxy->worldAABB)) {
+            return true;
+        }
+
         // Calculate light scissor rect
         Rect screenClipRect;
         if (!renderLight->ComputeScreenClipRect(camera->def, screenClipRect)) {
@@ -173,10 +373,16 @@ void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
             }
         }
 
+        // Skip if a object is hidden behind the occluders. Occluders are not tested against themselves.
+        if (camera->occlusionCulling && renderObject->occluderViewCount != viewCount && !occlusionBuffer.IsAABBVisible(proxy->worldAABB)) {
+            return true;
+        }
+
         // Register visible object form the render object.
         VisObject *visObject = RegisterVisObject(camera, renderObject);
 
         visObject->ambientVisible = true;
+        visObject->lodIndex = SelectMeshLOD(camera, renderObject, proxy->worldAABB);
         visObject->modelViewMatrix = camera->def->viewMatrix * renderObject->GetWorldMatrix();
         visObject->modelViewProjMatrix = camera->def->viewProjMatrix * renderObject->GetWorldMatrix();
 
@@ -236,6 +442,113 @@ void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
     }
 }
 
+// Returns sub mesh drawing only the visible triangle clusters of the given static sub mesh.
+// Returns the given sub mesh if all the clusters are visible, or nullptr if all the clusters are culled.
+SubMesh *RenderWorld::CullSubMeshClusters(const VisCamera *camera, const VisObject *visObject, const Material *material, SubMesh *subMesh, bool occlusionTest) {
+    if (!r_clusterCulling.GetBool() || subMesh->numClusters == 0) {
+        return subMesh;
+    }
+
+    const RenderObject *renderObject = visObject->def;
+    const Mat3x4 &worldMatrix = renderObject->GetWorldMatrix();
+    const bool orthogonal = camera->def->GetState().orthogonal;
+
+    if (!material) {
+        material = materialManager.defaultMaterial;
+    }
+
+    // Normal cones are tested in local space. Mirrored transform flips the front faces.
+    bool backFaceCulling = !orthogonal && material->GetCullType() == RHI::CullType::Back && worldMatrix.ToMat3().Determinant() > 0.0f;
+    Vec3 localViewOrigin = renderObject->GetWorldMatrixInverse() * camera->def->GetState().origin;
+
+    Vec3 scale = worldMatrix.ToScaleVec3();
+    float maxScale = Max3(scale.x, scale.y, scale.z);
+
+    bool *clusterVisible = (bool *)frameData.Alloc(sizeof(bool) * subMesh->numClusters);
+    int numVisibleIndexes = 0;
+
+    for (int clusterIndex = 0; clusterIndex < subMesh->numClusters; clusterIndex++) {
+        const MeshCluster &cluster = subMesh->clusters[clusterIndex];
+
+        clusterVisible[clusterIndex] = false;
+
+        if (backFaceCulling && cluster.IsBackFacing(localViewOrigin)) {
+            continue;
+        }
+
+        Sphere worldSphere(worldMatrix * cluster.center, cluster.radius * maxScale);
+
+        if (orthogonal ? !camera->def->box.IsIntersectSphere(worldSphere) : camera->def->frustum.CullSphere(worldSphere)) {
+            continue;
+        }
+
+        if (occlusionTest) {
+            AABB worldAABB;
+            worldAABB.SetFromTransformedAABB(cluster.aabb, worldMatrix);
+
+            if (!occlusionBuffer.IsAABBVisible(worldAABB)) {
+                continue;
+            }
+        }
+
+        clusterVisible[clusterIndex] = true;
+        numVisibleIndexes += cluster.numIndexes;
+    }
+
+    if (numVisibleIndexes == subMesh->numIndexes) {
+        return subMesh;
+    }
+
+    if (numVisibleIndexes == 0) {
+        return nullptr;
+    }
+
+    // Static vertex buffer should be cached before it is shared with the culled sub mesh.
+    if (!bufferCacheManager.IsCached(subMesh->vertexCache)) {
+        subMesh->CacheStaticDataToGpu();
+    }
+
+    // Write index ranges of the visible clusters to the index stream.
+    BufferCache indexCache;
+    bufferCacheManager.AllocIndex(numVisibleIndexes, sizeof(TriIndex), nullptr, &indexCache);
+    TriIndex *indexPointer = (TriIndex *)bufferCacheManager.MapIndexBuffer(&indexCache);
+
+    for (int clusterIndex = 0; clusterIndex < subMesh->numClusters; clusterIndex++) {
+        if (!clusterVisible[clusterIndex]) {
+            continue;
+        }
+
+        // Merge adjacent visible clusters into one copy.
+        int firstIndex = subMesh->clusters[clusterIndex].firstIndex;
+        int numIndexes = subMesh->clusters[clusterIndex].numIndexes;
+
+        while (clusterIndex + 1 < subMesh->numClusters && clusterVisible[clusterIndex + 1]) {
+            clusterIndex++;
+            numIndexes += subMesh->clusters[clusterIndex].numIndexes;
+        }
+
+        simdProcessor->Memcpy(indexPointer, subMesh->indexes + firstIndex, sizeof(TriIndex) * numIndexes);
+        indexPointer += numIndexes;
+    }
+
+    bufferCacheManager.UnmapIndexBuffer(&indexCache);
+
+    // Copy this SubMesh to the temporary frame data to use in the backend.
+    SubMesh *culledSubMesh = (SubMesh *)frameData.Alloc(sizeof(SubMesh));
+    new (culledSubMesh) SubMesh(*subMesh);
+
+    // Index range differs from the other instances, so it should not be shared for the instancing.
+    culledSubMesh->refSubMesh = culledSubMesh;
+    culledSubMesh->numIndexes = numVisibleIndexes;
+    culledSubMesh->numClusters = 0;
+    culledSubMesh->clusters = nullptr;
+
+    culledSubMesh->indexCache = (BufferCache *)frameData.Alloc(sizeof(BufferCache));
+    *(culledSubMesh->indexCache) = indexCache;
+
+    return culledSubMesh;
+}
+
 // Add drawing surfaces of visible static meshes.
 void RenderWorld::AddStaticMeshes(VisCamera *camera) {
     BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::AddStaticMeshes");
@@ -255,14 +568,10 @@ void RenderWorld::AddStaticMeshes(VisCamera *camera) {
             return true;
         }
 
-        /*if (proxy->lodGroup >= 0) {
-            // Compute LOD value [0, 1]
-            AABB aabb = surf->subMesh->GetAABB() * proxy->renderObject->state.scale;
-            Vec3 size = aabb[1] - aabb[0];
-            float area = camera->def->state.axis[0].Abs().Dot(Vec3(size.y * size.z, size.z * size.x, size.x * size.y));
-            float d = camera->def->state.origin.DistanceSqr(proxy->renderObject->state.origin);
-            float lodValue = area / d;
-        }*/
+        // Skip if the surface is hidden behind the occluders.
+        if (camera->occlusionCulling && proxy->renderObject->occluderViewCount != this->viewCount && !occlusionBuffer.IsAABBVisible(proxy->worldAABB)) {
+            return true;
+        }
 
 #if 0
         // More accurate OBB culling
@@ -277,8 +586,19 @@ void RenderWorld::AddStaticMeshes(VisCamera *camera) {
             flags |= DrawSurf::Flag::ShowWires;
         }
 
+        // LOD sub meshes have their own sub mesh index, so the objects with the same LOD are batched together.
         VisObject *visObject = proxy->renderObject->visObject;
-        AddDrawSurf(camera, nullptr, visObject, visObject->def->state.materials[surf->materialIndex], surf->subMesh, flags);
+        const Material *material = visObject->def->state.materials[surf->materialIndex];
+
+        bool occlusionTest = camera->occlusionCulling && proxy->renderObject->occluderViewCount != this->viewCount;
+        SubMesh *subMesh = CullSubMeshClusters(camera, visObject, material, surf->GetLODSubMesh(visObject->lodIndex), occlusionTest);
+
+        // Skip if all the clusters are culled.
+        if (!subMesh) {
+            return true;
+        }
+
+        AddDrawSurf(camera, nullptr, visObject, material, subMesh, flags);
 
         camera->numAmbientSurfs++;
 
@@ -411,6 +731,8 @@ void RenderWorld::AddRawMeshes(VisCamera *camera) {
 void RenderWorld::AddParticleMeshes(VisCamera *camera) {
     BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::AddParticleMeshes");
 
+    const int frameCount = renderSystem.GetCurrentRenderContext()->frameCount;
+
     for (VisObject *visObject = camera->visObjects.Next(); visObject; visObject = visObject->node.Next()) {
         if (!visObject->ambientVisible) {
             continue;
@@ -427,12 +749,30 @@ void RenderWorld::AddParticleMeshes(VisCamera *camera) {
             flags |= DrawSurf::Flag::ShowWires;
         }
 
-        particleMesh.Clear();
-        particleMesh.Draw(renderObjectDef.particleSystem, renderObjectDef.stageParticles, visObject->def, camera->def);
-        particleMesh.CacheIndexes();
+        const Array<PrtMeshSurf> *prtMeshSurfs = &particleMesh.surfaces;
+
+        if (r_particleMeshCache.GetBool() && !ParticleMesh::IsViewDependent(renderObjectDef.particleSystem)) {
+            // Vertices of the view independent particle system are generated once per frame and shared by all cameras.
+            RenderObject *renderObject = renderObjects[visObject->def->index];
+
+            if (renderObject->particleMeshFrameCount != frameCount) {
+                particleMesh.Clear();
+                particleMesh.Draw(renderObjectDef.particleSystem, renderObjectDef.stageParticles, visObject->def, camera->def);
+                particleMesh.CacheIndexes();
+
+                renderObject->particleMeshSurfs = particleMesh.surfaces;
+                renderObject->particleMeshFrameCount = frameCount;
+            }
 
-        for (int surfaceIndex = 0; surfaceIndex < particleMesh.surfaces.Count(); surfaceIndex++) {
-            const PrtMeshSurf *prtMeshSurf = &particleMesh.surfaces[surfaceIndex];
+            prtMeshSurfs = &renderObject->particleMeshSurfs;
+        } else {
+            particleMesh.Clear();
+            particleMesh.Draw(renderObjectDef.particleSystem, renderObjectDef.stageParticles, visObject->def, camera->def);
+            particleMesh.CacheIndexes();
+        }
+
+        for (int surfaceIndex = 0; surfaceIndex < prtMeshSurfs->Count(); surfaceIndex++) {
+            const PrtMeshSurf *prtMeshSurf = &(*prtMeshSurfs)[surfaceIndex];
             if (!prtMeshSurf->numIndexes) {
                 break;
             }
@@ -570,6 +910,75 @@ void RenderWorld::AddSkyBoxMeshes(VisCamera *camera) {
     camera->numAmbientSurfs++;
 }
 
+// Allocates the tiles in the shadow atlas for the shadows of point/spot lights sized by the screen coverage of the light.
+// Shadow map is rendered for this view while the light or the shadow casters in the light volume are changing.
+// Otherwise it is rendered independently of the view once, and the cached one is used in the following frames.
+void RenderWorld::SetupShadowCaches(VisCamera *camera) {
+    RenderContext *renderContext = renderSystem.currentContext;
+
+    const RenderCamera::State &cameraState = camera->def->GetState();
+    const bool shadowsEnabled = r_shadows.GetInteger() != 0 && !(cameraState.flags & RenderCamera::Flag::NoShadows);
+
+    // Shadow casters are filtered by the camera, so the cached shadow map is valid only for the camera with the same filter.
+    int casterFilter = cameraState.layerMask;
+    casterFilter = casterFilter * 31 + ((cameraState.flags & RenderCamera::Flag::StaticOnly) ? cameraState.staticMask : -1);
+    casterFilter = casterFilter * 31 + (camera->isSubCamera ? 1 : 0);
+
+    const int renderingSize = Max(renderContext->GetRenderingWidth(), renderContext->GetRenderingHeight());
+
+    for (VisLight *visLight = camera->visLights.Next(); visLight; visLight = visLight->node.Next()) {
+        const RenderLight *renderLight = visLight->def;
+
+        visLight->castShadows = shadowsEnabled && (renderLight->state.flags & RenderLight::Flag::CastShadows);
+        visLight->shadowCache = nullptr;
+        visLight->shadowUpdate = VisLight::ShadowUpdate::Dynamic;
+        visLight->shadowCascades = nullptr;
+
+        if (!visLight->castShadows) {
+            continue;
+        }
+
+        if (renderLight->state.type == RenderLight::Type::Directional) {
+            if ((renderLight->state.flags & RenderLight::Flag::PrimaryLight) && r_CSM_count.GetInteger() > 1) {
+                // Split view frustums are computed here, so that the shadow casters are culled for each cascades.
+                visLight->shadowCascades = new (frameData.Alloc(sizeof(ShadowCascades))) ShadowCascades;
+                visLight->shadowCascades->Setup(renderLight->state.axis, camera->def->frustum, r_CSM_maxDistance.GetFloat(), r_CSM_splitLambda.GetFloat(),
+                    Min(r_CSM_count.GetInteger(), (int)ShadowCascades::MaxCascades), r_CSM_blend.GetBool());
+            }
+            continue;
+        }
+
+        int maxTileSize = renderLight->state.type == RenderLight::Type::Point ? r_shadowCubeMapSize.GetInteger() : r_shadowMapSize.GetInteger();
+        int tileSize = maxTileSize * Max(visLight->scissorRect.w, visLight->scissorRect.h) / renderingSize;
+
+        RenderContext::ShadowCache *shadowCache = renderContext->GetShadowCache(renderLight->shadowCacheKey, Min(tileSize, maxTileSize));
+        if (!shadowCache) {
+            // No more space in the shadow atlas.
+            visLight->castShadows = false;
+            continue;
+        }
+
+        visLight->shadowCache = shadowCache;
+        visLight->shadowCacheVersion = renderLight->shadowCacheVersion;
+        visLight->shadowCasterFilter = casterFilter;
+
+        if (shadowCache->lightVersion != renderLight->shadowCacheVersion) {
+            shadowCache->lightVersion = renderLight->shadowCacheVersion;
+            shadowCache->lastChangedFrame = renderContext->frameCount;
+        }
+
+        if (!r_shadowCache.GetBool()) {
+            shadowCache->cachedVersion = -1;
+        } else if (shadowCache->cachedVersion == renderLight->shadowCacheVersion && shadowCache->cachedCasterFilter == casterFilter) {
+            visLight->shadowUpdate = VisLight::ShadowUpdate::Cached;
+        } else if (shadowCache->lastChangedFrame < renderContext->frameCount) {
+            visLight->shadowUpdate = VisLight::ShadowUpdate::Cache;
+        } else {
+            shadowCache->cachedVersion = -1;
+        }
+    }
+}
+
 // Add lit drawing surfaces of visible static meshes for each light.
 void RenderWorld::AddStaticMeshesForLights(VisCamera *camera) {
     BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::AddStaticMeshesForLights");
@@ -615,7 +1024,8 @@ void RenderWorld::AddStaticMeshesForLights(VisCamera *camera) {
         }
 
         // Skip if the object is farther than maximum visible distance.
-        if (!(renderObject->state.flags & RenderObject::Flag::NoVisDist)) {
+        // Shadow map to be cached should not depend on the view, so the shadow casters are not culled by the view.
+        if (!(renderObject->state.flags & RenderObject::Flag::NoVisDist) && visLight->shadowUpdate != VisLight::ShadowUpdate::Cache) {
             if (renderObject->state.worldMatrix.ToTranslationVec3().DistanceSqr(camera->def->state.origin) > renderObject->maxVisDistSquared) {
                 return true;
             }
@@ -623,13 +1033,34 @@ void RenderWorld::AddStaticMeshesForLights(VisCamera *camera) {
 
         const Material *material = renderObject->state.materials[surf->materialIndex];
 
-        bool isShadowCaster = (visLight->def->state.flags & RenderLight::Flag::CastShadows) && (renderObject->state.flags & RenderObject::Flag::CastShadows) && material->IsShadowCaster();
+        // Shadow casters are not needed if the cached shadow map is used.
+        bool isShadowCaster = visLight->castShadows && visLight->shadowUpdate != VisLight::ShadowUpdate::Cached &&
+            (renderObject->state.flags & RenderObject::Flag::CastShadows) && material->IsShadowCaster();
+
+        // Cascades of the primary directional light which this surface can cast shadows on.
+        int cascadeMask = -1;
+        if (isShadowCaster && visLight->shadowCascades) {
+            cascadeMask = visLight->shadowCascades->CascadeMask(proxy->worldAABB);
+            if (!cascadeMask) {
+                isShadowCaster = false;
+            }
+        }
 
         // Already visible in this frame.
         if (surf->viewCount == this->viewCount) {
             if ((surf->drawSurf->flags & DrawSurf::Flag::Visible) && material->IsLitSurface()) {
-                // Add drawSurf from visible drawSurf.
-                AddDrawSurfFromAmbient(camera, visLight, isShadowCaster, surf->drawSurf);
+                SubMesh *subMesh = surf->GetLODSubMesh(renderObject->visObject->lodIndex);
+
+                if (isShadowCaster && surf->drawSurf->subMesh != subMesh) {
+                    // Clusters culled by the camera might cast shadows, so the shadow is drawn with the whole sub mesh.
+                    AddDrawSurfFromAmbient(camera, visLight, false, surf->drawSurf);
+                    AddDrawSurf(camera, visLight, renderObject->visObject, material, subMesh, DrawSurf::Flag::ShadowVisible, cascadeMask);
+
+                    visLight->numDrawSurfs++;
+                } else {
+                    // Add drawSurf from visible drawSurf.
+                    AddDrawSurfFromAmbient(camera, visLight, isShadowCaster, surf->drawSurf, cascadeMask);
+                }
 
                 visLight->numDrawSurfs++;
                 visLight->litSurfsAABB.AddAABB(proxy->worldAABB);
@@ -641,13 +1072,14 @@ void RenderWorld::AddStaticMeshesForLights(VisCamera *camera) {
         } else if (isShadowCaster) {
             OBB surfBounds = OBB(surf->subMesh->GetAABB(), renderObject->state.worldMatrix);
 
-            if (!visLight->def->CullShadowCaster(surfBounds, camera->def->frustum, camera->worldAABB)) {
+            if (visLight->shadowUpdate == VisLight::ShadowUpdate::Cache || !visLight->def->CullShadowCaster(surfBounds, camera->def->frustum, camera->worldAABB)) {
                 // This surface is not visible but shadow might be visible as a shadow caster.
                 // Register a visObject used only for shadow caster.
                 VisObject *shadowCasterObject = RegisterVisObject(camera, renderObject);
                 shadowCasterObject->shadowVisible = true;
 
-                AddDrawSurf(camera, visLight, shadowCasterObject, material, surf->subMesh, DrawSurf::Flag::ShadowVisible);
+                // Shadow only object uses the LOD selected in the last main camera view.
+                AddDrawSurf(camera, visLight, shadowCasterObject, material, surf->GetLODSubMesh(renderObject->lodIndex), DrawSurf::Flag::ShadowVisible, cascadeMask);
 
                 surf->viewCount = this->viewCount;
                 surf->drawSurf = camera->drawSurfs[camera->numDrawSurfs - 1];
@@ -734,10 +1166,19 @@ void RenderWorld::AddSkinnedMeshesForLights(VisCamera *camera) {
             return true;
         }
 
-        bool isShadowCaster = (visLight->def->state.flags & RenderLight::Flag::CastShadows) && (renderObject->state.flags & RenderObject::Flag::CastShadows);
+        bool isShadowCaster = visLight->castShadows && visLight->shadowUpdate != VisLight::ShadowUpdate::Cached && (renderObject->state.flags & RenderObject::Flag::CastShadows);
         bool shadowCasterCulled = false;
 
-        if (isShadowCaster && !renderObject->visObject) {
+        // Cascades of the primary directional light which this object can cast shadows on.
+        int cascadeMask = -1;
+        if (isShadowCaster && visLight->shadowCascades) {
+            cascadeMask = visLight->shadowCascades->CascadeMask(proxy->worldAABB);
+            if (!cascadeMask) {
+                isShadowCaster = false;
+            }
+        }
+
+        if (isShadowCaster && !renderObject->visObject && visLight->shadowUpdate != VisLight::ShadowUpdate::Cache) {
             OBB worldOBB = renderObject->GetWorldOBB();
 
             shadowCasterCulled = visLight->def->CullShadowCaster(worldOBB, camera->def->frustum, camera->worldAABB);
@@ -754,7 +1195,7 @@ void RenderWorld::AddSkinnedMeshesForLights(VisCamera *camera) {
             if (surf->viewCount == this->viewCount) {
                 if ((surf->drawSurf->flags & DrawSurf::Flag::Visible) && material->IsLitSurface()) {
                     // Add drawSurf from visible drawSurf.
-                    AddDrawSurfFromAmbient(camera, visLight, isShadowCaster && material->IsShadowCaster(), surf->drawSurf);
+                    AddDrawSurfFromAmbient(camera, visLight, isShadowCaster && material->IsShadowCaster(), surf->drawSurf, cascadeMask);
 
                     visLight->numDrawSurfs++;
                     visLight->litSurfsAABB.AddAABB(proxy->worldAABB);
@@ -776,7 +1217,7 @@ void RenderWorld::AddSkinnedMeshesForLights(VisCamera *camera) {
                         shadowCasterObject->def->state.mesh->UpdateSkinningJointCache(shadowCasterObject->def->state.skeleton, shadowCasterObject->def->state.joints);
                     }
 
-                    AddDrawSurf(camera, visLight, shadowCasterObject, material, surf->subMesh, DrawSurf::Flag::ShadowVisible);
+                    AddDrawSurf(camera, visLight, shadowCasterObject, material, surf->subMesh, DrawSurf::Flag::ShadowVisible, cascadeMask);
 
                     surf->viewCount = this->viewCount;
                     surf->drawSurf = camera->drawSurfs[camera->numDrawSurfs - 1];
@@ -817,84 +1258,122 @@ void RenderWorld::AddSkinnedMeshesForLights(VisCamera *camera) {
     }
 }
 
-void RenderWorld::CacheInstanceBuffer(VisCamera *camera) {
-    BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::CacheInstanceBuffer");
+// Instance data is written per material slot of the render object when the render object is updated.
+// Instance data layout: world matrix, color, and skinning texture coordinates base for GPU skinning.
+static void WriteInstanceData(byte *instanceData, const RenderObject *renderObject, const Material::ShaderPass *pass) {
+    *(Mat3x4 *)instanceData = renderObject->GetWorldMatrix();
+    instanceData += 48;
+
+    if (renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays) {
+        if (pass->useOwnerColor) {
+            *(uint32_t *)instanceData = Color4(&renderObject->GetState().materialParms[RenderObject::MaterialParm::Red]).ToUInt32();
+        } else {
+            *(uint32_t *)instanceData = pass->constantColor.ToUInt32();
+        }
+    } else {
+        if (pass->useOwnerColor) {
+            *(Color4 *)instanceData = Color4(&renderObject->GetState().materialParms[RenderObject::MaterialParm::Red]);
+        } else {
+            *(Color4 *)instanceData = pass->constantColor;
+        }
+    }
+}
+
+static void WriteInstanceSkinningData(byte *instanceData, const SkinningJointCache *skinningJointCache) {
+    instanceData += 48;
+    instanceData += renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays ? sizeof(uint32_t) : sizeof(Color4);
+
+    if (renderGlobal.vertexTextureMethod == BufferCacheManager::VertexTextureMethod::Tbo) {
+        *(uint32_t *)instanceData = (uint32_t)skinningJointCache->GetBufferCache().tcBase[0];
+    } else {
+        *(Vec2 *)instanceData = Vec2(skinningJointCache->GetBufferCache().tcBase[0], skinningJointCache->GetBufferCache().tcBase[1]);
+    }
+}
 
+void RenderWorld::UpdateInstanceSlots(RenderObject *renderObject) {
     if (renderGlobal.instancingMethod == Mesh::InstancingMethod::NoInstancing) {
         return;
     }
 
-    int numInstances = 0;
+    // Only meshes can be drawn with instancing.
+    int numSlots = renderObject->state.mesh ? Max(renderObject->state.materials.Count(), 1) : 0;
 
-    for (VisObject *visObject = camera->visObjects.Next(); visObject; visObject = visObject->node.Next()) {
-        const RenderObject *renderObject = visObject->def;
+    if (numSlots != renderObject->numInstanceSlots) {
+        FreeInstanceSlots(renderObject);
 
-        // Only for mesh type render object.
-        if (!renderObject->state.mesh) {
-            continue;
+        if (numSlots == 0) {
+            return;
         }
 
-        for (int surfaceIndex = 0; surfaceIndex < renderObject->state.mesh->NumSurfaces(); surfaceIndex++) {
-            const MeshSurf *surf = renderObject->state.mesh->GetSurface(surfaceIndex);
+        if (!instanceBuffer.IsInitialized()) {
+            RHI::BufferType::Enum bufferType = renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays ? RHI::BufferType::Vertex : RHI::BufferType::Uniform;
+            instanceBuffer.Init(bufferType, renderGlobal.instanceBufferOffsetAlignment, renderGlobal.maxInstances);
+        }
 
-            if (surf->viewCount != viewCount) {
-                continue;
-            }
+        renderObject->instanceSlot = instanceBuffer.AllocSlots(numSlots);
+        renderObject->numInstanceSlots = numSlots;
+    }
 
-            if (!(surf->drawSurf->flags & DrawSurf::Flag::UseInstancing)) {
-                continue;
-            }
+    for (int i = 0; i < numSlots; i++) {
+        const Material *material = i < renderObject->state.materials.Count() ? renderObject->state.materials[i] : nullptr;
+        if (!material) {
+            material = materialManager.defaultMaterial;
+        }
 
-            byte *instanceData = ((byte *)renderGlobal.instanceBufferData + numInstances * renderGlobal.instanceBufferOffsetAlignment);
+        WriteInstanceData(instanceBuffer.GetSlotData(renderObject->instanceSlot + i), renderObject, material->GetPass());
+    }
 
-            const Mat3x4 &localToWorldMatrix = renderObject->GetWorldMatrix();
-            *(Mat3x4 *)instanceData = localToWorldMatrix;
-            instanceData += 48;
+    instanceBuffer.MarkDirty(renderObject->instanceSlot, numSlots);
+}
 
-            /*if (surf->drawSurf->material->GetPass()->shader->GetPropertyInfoHashMap().Get("_PARALLAX")) {
-                Mat3x4 worldToLocalMatrix = renderObject->GetWorldMatrixInverse();
-                *(Mat3x4 *)instanceData = worldToLocalMatrix; 
-                instanceData += 48;
-            }*/
+void RenderWorld::FreeInstanceSlots(RenderObject *renderObject) {
+    if (renderObject->numInstanceSlots > 0) {
+        instanceBuffer.FreeSlots(renderObject->instanceSlot, renderObject->numInstanceSlots);
 
-            if (renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays) {
-                if (surf->drawSurf->material->GetPass()->useOwnerColor) {
-                    *(uint32_t *)instanceData = Color4(&renderObject->state.materialParms[RenderObject::MaterialParm::Red]).ToUInt32();
-                } else {
-                    *(uint32_t *)instanceData = surf->drawSurf->material->GetPass()->constantColor.ToUInt32();
-                }
-                instanceData += sizeof(uint32_t);
-            } else {
-                if (surf->drawSurf->material->GetPass()->useOwnerColor) {
-                    *(Color4 *)instanceData = Color4(&renderObject->state.materialParms[RenderObject::MaterialParm::Red]);
-                } else {
-                    *(Color4 *)instanceData = surf->drawSurf->material->GetPass()->constantColor;
-                }
-                instanceData += sizeof(Color4);
-            }
+        renderObject->instanceSlot = -1;
+        renderObject->numInstanceSlots = 0;
+    }
+}
 
-            if (surf->subMesh->IsGpuSkinning()) {
-                const SkinningJointCache *skinningJointCache = renderObject->state.mesh->skinningJointCache;
+void RenderWorld::CacheInstanceBuffer(VisCamera *camera) {
+    BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::CacheInstanceBuffer");
 
-                if (renderGlobal.vertexTextureMethod == BufferCacheManager::VertexTextureMethod::Tbo) {
-                    *(uint32_t *)instanceData = (uint32_t)skinningJointCache->GetBufferCache().tcBase[0];
-                } else {
-                    *(Vec2 *)instanceData = Vec2(skinningJointCache->GetBufferCache().tcBase[0], skinningJointCache->GetBufferCache().tcBase[1]);
-                }
-            }
+    if (renderGlobal.instancingMethod == Mesh::InstancingMethod::NoInstancing) {
+        return;
+    }
 
-            visObject->instanceIndex = numInstances++;
-            break;
+    for (int i = 0; i < camera->numDrawSurfs; i++) {
+        DrawSurf *drawSurf = camera->drawSurfs[i];
+
+        if (!(drawSurf->flags & DrawSurf::Flag::UseInstancing)) {
+            continue;
         }
-    }
 
-    if (numInstances > 0) {
-        if (renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays) {
-            bufferCacheManager.AllocVertex(numInstances, renderGlobal.instanceBufferOffsetAlignment, renderGlobal.instanceBufferData, camera->instanceBufferCache);
-        } else if (renderGlobal.instancingMethod == Mesh::InstancingMethod::UniformBuffer) {
-            bufferCacheManager.AllocUniform(numInstances * renderGlobal.instanceBufferOffsetAlignment, renderGlobal.instanceBufferData, camera->instanceBufferCache);
+        const RenderObject *renderObject = drawSurf->space->def;
+
+        // Instance data is written in UpdateRenderObject() per material of the render object.
+        int materialIndex = renderObject->state.materials.FindIndex(const_cast<Material *>(drawSurf->material));
+        if (materialIndex < 0 && drawSurf->material == materialManager.defaultMaterial) {
+            materialIndex = renderObject->state.materials.FindIndex(nullptr);
+        }
+
+        // Draw without instancing if the surface has no instance data.
+        if (materialIndex < 0 || materialIndex >= renderObject->numInstanceSlots) {
+            drawSurf->flags &= ~DrawSurf::Flag::UseInstancing;
+            continue;
+        }
+
+        drawSurf->instanceIndex = renderObject->instanceSlot + materialIndex;
+
+        // Skinning joint cache is reallocated every frame.
+        if (drawSurf->subMesh->IsGpuSkinning()) {
+            WriteInstanceSkinningData(instanceBuffer.GetSlotData(drawSurf->instanceIndex), renderObject->state.mesh->skinningJointCache);
+
+            instanceBuffer.MarkDirty(drawSurf->instanceIndex, 1);
         }
     }
+
+    instanceBuffer.Upload();
 }
 
 void RenderWorld::OptimizeLights(VisCamera *camera) {
@@ -945,11 +1424,140 @@ void RenderWorld::OptimizeLights(VisCamera *camera) {
     }
 }
 
+// Texels per light in the light grid buffer: origin and fall off exponent, color, 3 rows of fall off matrix.
+static const int LightGridLightTexels = 5;
+// Upper limit of the light grid buffer size not to exhaust the texel cache.
+static const int MaxLightGridBytes = 256 * 1024;
+
+static bool IsClusterableLight(const VisCamera *camera, const VisLight *visLight) {
+    const RenderLight *renderLight = visLight->def;
+    const RenderLight::State &lightState = renderLight->GetState();
+
+    if (lightState.type != RenderLight::Type::Point || (lightState.flags & RenderLight::Flag::PrimaryLight)) {
+        return false;
+    }
+
+    if (visLight->castShadows) {
+        return false;
+    }
+
+    // Light projection texture is not sampled in the clustered lighting.
+    if (lightState.material != MaterialManager::zeroClampLightMaterial && lightState.material != MaterialManager::whiteLightMaterial) {
+        return false;
+    }
+
+    return true;
+}
+
+// Assigns point lights without shadows to the clusters of the light grid,
+// and packs lights, clusters and light indexes into the texel buffer for the base pass.
+void RenderWorld::BuildLightGrid(VisCamera *camera) {
+    camera->clusteredLighting = false;
+
+    if (!r_clusteredLighting.GetBool() || camera->is2D || camera->def->GetState().orthogonal ||
+        renderGlobal.vertexTextureMethod != BufferCacheManager::VertexTextureMethod::Tbo) {
+        return;
+    }
+
+    BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::BuildLightGrid");
+
+    const Mat4 &viewMatrix = camera->def->GetViewMatrix();
+
+    Array<VisLight *> clusteredLights;
+    Array<Sphere> lightSpheres;
+
+    for (VisLight *visLight = camera->visLights.Next(); visLight; visLight = visLight->node.Next()) {
+        if (!IsClusterableLight(camera, visLight)) {
+            continue;
+        }
+
+        clusteredLights.Append(visLight);
+        lightSpheres.Append(Sphere(viewMatrix * visLight->def->GetOrigin(), visLight->def->GetMajorRadius()));
+    }
+
+    if (clusteredLights.Count() == 0) {
+        return;
+    }
+
+    if (!lightGrid.IsInitialized()) {
+        lightGrid.Init();
+    }
+
+    lightGrid.Setup(camera->def->GetProjMatrix(), camera->def->GetZNear(), camera->def->GetZFar());
+    lightGrid.AssignLights(lightSpheres.Ptr(), lightSpheres.Count());
+
+    const int numLightTexels = clusteredLights.Count() * LightGridLightTexels;
+    const int numClusterTexels = LightGrid::NumClusters;
+    const int numIndexTexels = (lightGrid.NumLightIndexes() + 3) / 4;
+    const int numBytes = (numLightTexels + numClusterTexels + numIndexTexels) * 4 * sizeof(float);
+
+    if (numBytes > MaxLightGridBytes) {
+        return;
+    }
+
+    Vec4 *texels = (Vec4 *)frameData.Alloc(numBytes);
+    Vec4 *lightTexels = texels;
+    Vec4 *clusterTexels = lightTexels + numLightTexels;
+    float *indexes = (float *)(clusterTexels + numClusterTexels);
+
+    for (int i = 0; i < clusteredLights.Count(); i++) {
+        const RenderLight *renderLight = clusteredLights[i]->def;
+        const Material::ShaderPass *lightPass = renderLight->GetMaterial()->GetPass();
+
+        // Same light color with the additive pass.
+        Color4 lightColor = lightPass->useOwnerColor ? Color4(&renderLight->GetState().materialParms[RenderObject::MaterialParm::Red]) : lightPass->constantColor;
+        if (rhi.IsSRGBWriteEnabled()) {
+            lightColor.ToColor3() = lightColor.ToColor3().SRGBToLinear();
+        }
+        lightColor *= renderLight->GetState().intensity * r_lightScale.GetFloat();
+
+        const Mat3x4 &fallOffMatrix = renderLight->GetFallOffMatrix();
+
+        Vec4 *lightTexel = &lightTexels[i * LightGridLightTexels];
+        lightTexel[0] = Vec4(renderLight->GetOrigin(), renderLight->GetState().fallOffExponent);
+        lightTexel[1] = Vec4(lightColor.r, lightColor.g, lightColor.b, lightColor.a);
+        lightTexel[2] = fallOffMatrix[0];
+        lightTexel[3] = fallOffMatrix[1];
+        lightTexel[4] = fallOffMatrix[2];
+    }
+
+    const int32_t *clusterOffsets = lightGrid.GetClusterOffsets();
+
+    for (int i = 0; i < numClusterTexels; i++) {
+        clusterTexels[i] = Vec4((float)clusterOffsets[i], (float)(clusterOffsets[i + 1] - clusterOffsets[i]), 0.0f, 0.0f);
+    }
+
+    const int32_t *lightIndexes = lightGrid.GetLightIndexes();
+
+    for (int i = 0; i < numIndexTexels * 4; i++) {
+        indexes[i] = i < lightGrid.NumLightIndexes() ? (float)lightIndexes[i] : 0.0f;
+    }
+
+    BufferCache *bufferCache = (BufferCache *)frameData.ClearedAlloc(sizeof(BufferCache));
+    bufferCacheManager.AllocTexel(numBytes, texels, bufferCache);
+
+    camera->lightGridBufferCache = bufferCache;
+    camera->lightGridBase[0] = bufferCache->tcBase[0];
+    camera->lightGridBase[1] = bufferCache->tcBase[0] + numLightTexels;
+    camera->lightGridBase[2] = bufferCache->tcBase[0] + numLightTexels + numClusterTexels;
+    camera->lightGridBase[3] = clusteredLights.Count();
+    camera->lightGridSliceScaleBias = Vec2(lightGrid.GetSliceScale(), lightGrid.GetSliceBias());
+    camera->clusteredLighting = true;
+
+    for (int i = 0; i < clusteredLights.Count(); i++) {
+        clusteredLights[i]->clustered = true;
+    }
+}
+
 void RenderWorld::DrawCamera(VisCamera *camera) {
     BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::DrawCamera");
 
     viewCount++;
 
+    // Rasterize occluders into the software occlusion buffer.
+    // Lights, objects and static mesh surfaces found in the following steps are tested against it.
+    RasterizeOccluders(camera);
+
     // Find visible renderLights by querying view frustum in lightDBVT.
     // Then register each visible renderLight to the current camera as VisLight.
     // Find visible renderObjects by querying view frustum in objectDBVT.
@@ -976,6 +1584,9 @@ void RenderWorld::DrawCamera(VisCamera *camera) {
     // Add drawing surface of skybox.
     AddSkyBoxMeshes(camera);
     
+    // Allocate shadow map tiles of point/spot lights in the shadow atlas, and check if the cached shadow maps are valid.
+    SetupShadowCaches(camera);
+
     // Add drawing surfaces of static meshes by querying light BV in staticMeshDBVT.
     // Added drawing surface might be the shadow caster only surface if it is not the visible in the previous steps.
     AddStaticMeshesForLights(camera);
@@ -987,12 +1598,15 @@ void RenderWorld::DrawCamera(VisCamera *camera) {
     // Compute scissor rect of each visLights and exclude if it is not visible.
     OptimizeLights(camera);
 
-    // Cache instance data for instancing.
-    CacheInstanceBuffer(camera);
-    
+    // Assign point lights without shadows to the clusters of the light grid to shade them in the base pass.
+    BuildLightGrid(camera);
+
     // Sort drawing surfaces.
     SortDrawSurfs(camera);
 
+    // Cache instance data for instancing in the sorted order.
+    CacheInstanceBuffer(camera);
+
     renderSystem.CmdDrawCamera(camera);
 }
 
@@ -1026,7 +1640,7 @@ void RenderWorld::DrawSubCamera(const VisObject *visObject, const DrawSurf *draw
     BE_PROFILE_CPU_SCOPE_STATIC("RenderWorld::DrawSubCamera");
 }
 
-void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *visObject, const Material *material, SubMesh *subMesh, int flags) {
+void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *visObject, const Material *material, SubMesh *subMesh, int flags, int cascadeMask) {
     if (camera->numDrawSurfs + 1 > camera->maxDrawSurfs) {
         BE_WARNLOG("RenderWorld::AddDrawSurf: not enough renderable surfaces\n");
         return;
@@ -1077,18 +1691,25 @@ void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *
     drawSurf->materialRegisters = nullptr;//outputValues;
     drawSurf->subMesh = subMesh;
     drawSurf->flags = flags;
+    drawSurf->cascadeMask = cascadeMask;
 
     uint64_t visLightIndex = visLight ? visLight->index + 1 : 0;
     uint64_t visObjectIndex = visObject->index;
     uint64_t materialIndex = materialManager.GetIndexByMaterial(actualMaterial);
 
+    // Instanced surfaces are ordered by the persistent instance slot of the render object instead of the visObject index,
+    // so that the batchable surfaces have ascending instance indexes and form contiguous runs in the instance buffer.
+    if ((flags & DrawSurf::Flag::UseInstancing) && visObject->def->instanceSlot >= 0) {
+        visObjectIndex = visObject->def->instanceSlot & 0xFFFF;
+    }
+
     if (visObject->def->state.flags & RenderObject::Flag::UseRenderingOrder) {
         //---------------------------------------------------
         // 0xFFF0000000000000 (0~4095)  : visLight index
         // 0x000F000000000000 (0~15)    : material sort (Material::Sort::Overlay)
         // 0x0000FFFF00000000 (0~65535) : rendering order
         // 0x00000000FFFF0000 (0~65535) : material index
-        // 0x000000000000FFFF (0~65535) : visObject index
+        // 0x000000000000FFFF (0~65535) : visObject index (instance slot for instanced surfaces)
         //---------------------------------------------------
         uint64_t materialSort = Material::Sort::Overlay;
         uint64_t renderingOrder = visObject->def->state.renderingOrder & 0xFFFF;
@@ -1112,7 +1733,7 @@ void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *
             // 0x000F000000000000 (0~15)    : material sort
             // 0x0000FFFF00000000 (0~65535) : depth distance
             // 0x00000000FFFF0000 (0~65535) : material index
-            // 0x000000000000FFFF (0~65535) : visObject index
+            // 0x000000000000FFFF (0~65535) : visObject index (instance slot for instanced surfaces)
             //---------------------------------------------------
             drawSurf->sortKey = ((visLightIndex << 52) | (materialSort << 48) | (depthDist << 32) | (materialIndex << 16) | visObjectIndex);
         } else {
@@ -1123,7 +1744,7 @@ void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *
             // 0x000F000000000000 (0~15)    : material sort
             // 0x0000FFFF00000000 (0~65535) : sub mesh index
             // 0x00000000FFFF0000 (0~65535) : material index
-            // 0x000000000000FFFF (0~65535) : visObject index
+            // 0x000000000000FFFF (0~65535) : visObject index (instance slot for instanced surfaces)
             //---------------------------------------------------
             drawSurf->sortKey = ((visLightIndex << 52) | (materialSort << 48) | (subMeshIndex << 32) | (materialIndex << 16) | visObjectIndex);
         }
@@ -1132,7 +1753,7 @@ void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *
     camera->drawSurfs[camera->numDrawSurfs++] = drawSurf;
 }
 
-void RenderWorld::AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *visLight, bool shadowVisible, const DrawSurf *visibleDrawSurf) {
+void RenderWorld::AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *visLight, bool shadowVisible, const DrawSurf *visibleDrawSurf, int cascadeMask) {
     if (camera->numDrawSurfs + 1 > camera->maxDrawSurfs) {
         BE_WARNLOG("RenderWorld::AddDrawSurfFromAmbient: not enough renderable surfaces\n");
         return;
@@ -1145,6 +1766,7 @@ void RenderWorld::AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *visL
     drawSurf->material = visibleDrawSurf->material;
     drawSurf->materialRegisters = visibleDrawSurf->materialRegisters;
     drawSurf->subMesh = visibleDrawSurf->subMesh;
+    drawSurf->cascadeMask = cascadeMask;
 
     camera->drawSurfs[camera->numDrawSurfs++] = drawSurf;
 }
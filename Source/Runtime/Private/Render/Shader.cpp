@@ -41,6 +41,8 @@ static const char *builtInConstantNames[] = {
     "instanceIndexes",                      // InstanceIndexes
     "localToWorldMatrix",                   // LocalToWorldMatrix
     "worldToLocalMatrix",                   // WorldToLocalMatrix
+    "vertexDecodeScale",                    // VertexDecodeScale
+    "vertexDecodeBias",                     // VertexDecodeBias
     "textureMatrixS",                       // TextureMatrixS
     "textureMatrixT",                       // TextureMatrixT
     "constantColor",                        // ConstantColor
@@ -216,6 +216,14 @@ void ShaderManager::InitGlobalDefines() {
 
     if (renderGlobal.vertexTextureMethod == BufferCacheManager::VertexTextureMethod::Tbo) {
         shaderManager.AddGlobalHeader("#define USE_BUFFER_TEXTURE\n");
+
+        shaderManager.AddGlobalHeader(va("#define CLUSTER_GRID_X %i\n", LightGrid::GridSizeX));
+        shaderManager.AddGlobalHeader(va("#define CLUSTER_GRID_Y %i\n", LightGrid::GridSizeY));
+        shaderManager.AddGlobalHeader(va("#define CLUSTER_GRID_Z %i\n", LightGrid::GridSizeZ));
+
+        if (r_clusteredLighting.GetBool()) {
+            shaderManager.AddGlobalHeader("#define CLUSTERED_LIGHTING\n");
+        }
     }
 
     shaderManager.AddGlobalHeader(va("#define USE_GAMMA_SPACE %i\n", r_sRGB.GetBool() ? 0 : 1));
@@ -0,0 +1,182 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Math/Math.h"
+#include "Render/ShadowAtlas.h"
+
+BE_NAMESPACE_BEGIN
+
+void ShadowAtlas::Init(int atlasSize, int minTileSize) {
+    Shutdown();
+
+    assert(Math::IsPowerOfTwo(atlasSize) && Math::IsPowerOfTwo(minTileSize));
+    assert(minTileSize <= atlasSize);
+
+    this->atlasSize = atlasSize;
+    this->minTileSize = minTileSize;
+    this->numLevels = Math::ILog2(atlasSize / minTileSize) + 1;
+
+    freeNodes.SetCount(numLevels);
+
+    int root = NewNode(0, -1, Rect(0, 0, atlasSize, atlasSize));
+    freeNodes[0].Append(root);
+}
+
+void ShadowAtlas::Shutdown() {
+    nodes.Clear();
+    unusedNodes.Clear();
+    freeNodes.Clear();
+
+    atlasSize = 0;
+    minTileSize = 0;
+    numLevels = 0;
+    numTiles = 0;
+}
+
+void ShadowAtlas::FreeAllTiles() {
+    if (IsInitialized()) {
+        Init(atlasSize, minTileSize);
+    }
+}
+
+int ShadowAtlas::ClampTileSize(int tileSize) const {
+    tileSize = Math::RoundUpPowerOfTwo(Max(tileSize, minTileSize));
+    return Min(tileSize, atlasSize);
+}
+
+int ShadowAtlas::NewNode(int level, int parent, const Rect &rect) {
+    int node;
+    if (unusedNodes.Count() > 0) {
+        node = unusedNodes[unusedNodes.Count() - 1];
+        unusedNodes.SetCount(unusedNodes.Count() - 1);
+    } else {
+        node = nodes.Append(Node());
+    }
+
+    Node &newNode = nodes[node];
+    newNode.rect = rect;
+    newNode.level = level;
+    newNode.parent = parent;
+    newNode.children[0] = -1;
+    newNode.children[1] = -1;
+    newNode.children[2] = -1;
+    newNode.children[3] = -1;
+    newNode.state = Node::Free;
+
+    return node;
+}
+
+void ShadowAtlas::DeleteNode(int node) {
+    nodes[node].state = Node::Unused;
+    unusedNodes.Append(node);
+}
+
+void ShadowAtlas::SplitNode(int node) {
+    const Rect rect = nodes[node].rect;
+    const int childLevel = nodes[node].level + 1;
+    const int childSize = rect.w >> 1;
+
+    nodes[node].state = Node::Split;
+
+    // Children are pushed in the reverse order, so that the tiles are packed from the first child.
+    for (int i = 3; i >= 0; i--) {
+        Rect childRect(rect.x + (i & 1) * childSize, rect.y + (i >> 1) * childSize, childSize, childSize);
+
+        int child = NewNode(childLevel, node, childRect);
+        nodes[node].children[i] = child;
+
+        freeNodes[childLevel].Append(child);
+    }
+}
+
+int ShadowAtlas::AllocTile(int tileSize) {
+    assert(IsInitialized());
+
+    tileSize = ClampTileSize(tileSize);
+
+    const int level = Math::ILog2(atlasSize / tileSize);
+
+    // Find the smallest free node which can contain the tile.
+    int nodeLevel = level;
+    while (nodeLevel >= 0 && freeNodes[nodeLevel].Count() == 0) {
+        nodeLevel--;
+    }
+
+    if (nodeLevel < 0) {
+        return -1;
+    }
+
+    // Split the free node down to the level of the tile size.
+    while (1) {
+        Array<int> &levelFreeNodes = freeNodes[nodeLevel];
+
+        int node = levelFreeNodes[levelFreeNodes.Count() - 1];
+        levelFreeNodes.SetCount(levelFreeNodes.Count() - 1);
+
+        if (nodeLevel == level) {
+            nodes[node].state = Node::Allocated;
+            numTiles++;
+            return node;
+        }
+
+        SplitNode(node);
+        nodeLevel++;
+    }
+}
+
+void ShadowAtlas::FreeTile(int tile) {
+    assert(tile >= 0 && tile < nodes.Count() && nodes[tile].state == Node::Allocated);
+
+    numTiles--;
+
+    int node = tile;
+
+    // Merge the free siblings back into the parent node.
+    while (nodes[node].parent >= 0) {
+        const Node &parentNode = nodes[nodes[node].parent];
+
+        bool siblingsFree = true;
+        for (int i = 0; i < 4; i++) {
+            int child = parentNode.children[i];
+            if (child != node && nodes[child].state != Node::Free) {
+                siblingsFree = false;
+                break;
+            }
+        }
+
+        if (!siblingsFree) {
+            break;
+        }
+
+        int parent = nodes[node].parent;
+
+        for (int i = 0; i < 4; i++) {
+            int child = nodes[parent].children[i];
+            if (child != node) {
+                freeNodes[nodes[child].level].RemoveFast(child);
+            }
+            DeleteNode(child);
+
+            nodes[parent].children[i] = -1;
+        }
+
+        node = parent;
+    }
+
+    nodes[node].state = Node::Free;
+    freeNodes[nodes[node].level].Append(node);
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,77 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderUtils.h"
+
+BE_NAMESPACE_BEGIN
+
+void ShadowCascades::Setup(const Mat3 &lightAxis, const Frustum &viewFrustum, float dFar, float splitLambda, int numCascades, bool blend) {
+    assert(numCascades > 0 && numCascades <= MaxCascades);
+
+    this->lightAxis = lightAxis;
+    this->numCascades = numCascades;
+
+    R_ComputeSplitDistances(viewFrustum.GetNearDistance(), dFar, splitLambda, numCascades, splitDistances);
+
+    for (int cascadeIndex = 0; cascadeIndex < numCascades; cascadeIndex++) {
+        float dNear = splitDistances[blend && cascadeIndex > 0 ? cascadeIndex - 1 : cascadeIndex];
+
+        Frustum &splitFrustum = splitFrustums[cascadeIndex];
+        splitFrustum = viewFrustum;
+        splitFrustum.MoveNearDistance(dNear);
+        splitFrustum.MoveFarDistance(splitDistances[cascadeIndex + 1]);
+
+        splitFrustum.ProjectOnAxis(lightAxis, lightBounds[cascadeIndex]);
+    }
+}
+
+int ShadowCascades::CascadeMask(const AABB &casterAABB) const {
+    const Vec3 center = casterAABB.Center();
+    const Vec3 extents = casterAABB[1] - center;
+
+    // Light space bounds of the caster AABB.
+    AABB casterBounds;
+    for (int i = 0; i < 3; i++) {
+        float c = lightAxis[i].Dot(center);
+        float e = Math::Fabs(lightAxis[i].x) * extents.x + Math::Fabs(lightAxis[i].y) * extents.y + Math::Fabs(lightAxis[i].z) * extents.z;
+
+        casterBounds[0][i] = c - e;
+        casterBounds[1][i] = c + e;
+    }
+
+    int cascadeMask = 0;
+
+    for (int cascadeIndex = 0; cascadeIndex < numCascades; cascadeIndex++) {
+        const AABB &bounds = lightBounds[cascadeIndex];
+
+        // Caster entirely behind the split view frustum along the light direction.
+        if (casterBounds[0].x > bounds[1].x) {
+            continue;
+        }
+
+        // Caster doesn't overlap the split view frustum in the lateral axes.
+        if (casterBounds[1].y < bounds[0].y || casterBounds[0].y > bounds[1].y ||
+            casterBounds[1].z < bounds[0].z || casterBounds[0].z > bounds[1].z) {
+            continue;
+        }
+
+        cascadeMask |= BIT(cascadeIndex);
+    }
+
+    return cascadeMask;
+}
+
+BE_NAMESPACE_END
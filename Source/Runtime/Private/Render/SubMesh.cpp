@@ -17,17 +17,16 @@
 #include "RenderInternal.h"
 #include "SIMD/SIMD.h"
 #include "Core/Heap.h"
-#include "NvTriStrip.h"
 
 BE_NAMESPACE_BEGIN
 
 int SubMesh::Allocated() const {
     int size = 0;
 
-    if (verts) {
+    if (verts && !externalData) {
         size += sizeof(verts[0]) * numVerts;
     }
-    if (indexes) {
+    if (indexes && !externalData) {
         size += sizeof(indexes[0]) * numIndexes;
     }
     if (dominantTris) {
@@ -36,6 +35,9 @@ int SubMesh::Allocated() const {
     if (edges) {
         size += sizeof(edges[0]) * numEdges;
     }
+    if (clusters) {
+        size += sizeof(clusters[0]) * numClusters;
+    }
     if (vertexCache) {
         size += sizeof(BufferCache);
     }
@@ -47,9 +49,20 @@ int SubMesh::Allocated() const {
 }
 
 void SubMesh::AllocSubMesh(int numVerts, int numIndexes) {
-    static int subMeshCounter = 0;
+    VertexGenericLit *verts = (VertexGenericLit *)Mem_Alloc16(sizeof(VertexGenericLit) * numVerts);
+    TriIndex *indexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * numIndexes);
+
+    AllocExternalSubMesh(numVerts, verts, numIndexes, indexes);
+
+    this->externalData              = false;
+}
+
+void SubMesh::AllocExternalSubMesh(int numVerts, VertexGenericLit *verts, int numIndexes, TriIndex *indexes) {
+    // Sub meshes are allocated in the job threads by the mesh combiner.
+    static std::atomic<int> subMeshCounter = { 0 };
 
     this->alloced                   = true;
+    this->externalData              = true;
     this->normalsCalculated         = false;
     this->tangentsCalculated        = false;
     this->edgesCalculated           = false;
@@ -59,18 +72,21 @@ void SubMesh::AllocSubMesh(int numVerts, int numIndexes) {
     this->subMeshIndex              = subMeshCounter++;
 
     this->numVerts                  = numVerts;
-    this->verts                     = (VertexGenericLit *)Mem_Alloc16(sizeof(VertexGenericLit) * numVerts);
+    this->verts                     = verts;
     this->numMirroredVerts          = 0;
     this->mirroredVerts             = nullptr;
 
     this->numIndexes                = numIndexes;
-    this->indexes                   = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * numIndexes);
+    this->indexes                   = indexes;
 
     this->dominantTris              = nullptr;
     this->numEdges                  = 0;
     this->edges                     = nullptr;
     this->edgeIndexes               = nullptr;
 
+    this->numClusters               = 0;
+    this->clusters                  = nullptr;
+
     this->numJointWeights           = 0;
     this->jointWeights              = nullptr;
     this->jointWeightVerts          = nullptr;
@@ -79,14 +95,39 @@ void SubMesh::AllocSubMesh(int numVerts, int numIndexes) {
     this->useGpuSkinning            = false;
     this->gpuSkinningVersionIndex   = 0;
 
+    this->useCompactVertex          = false;
+
     this->vertexCache               = (BufferCache *)Mem_ClearedAlloc(sizeof(BufferCache));
     this->indexCache                = (BufferCache *)Mem_ClearedAlloc(sizeof(BufferCache));
 }
 
+void SubMesh::DetachExternalData() {
+    if (!externalData) {
+        return;
+    }
+
+    externalData = false;
+
+    VertexGenericLit *externalVerts = verts;
+    verts = (VertexGenericLit *)Mem_Alloc16(sizeof(VertexGenericLit) * numVerts);
+    simdProcessor->Memcpy(verts, externalVerts, sizeof(VertexGenericLit) * numVerts);
+
+    TriIndex *externalIndexes = indexes;
+    indexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * numIndexes);
+    simdProcessor->Memcpy(indexes, externalIndexes, sizeof(TriIndex) * numIndexes);
+
+    if (vertWeights) {
+        void *externalVertWeights = vertWeights;
+        vertWeights = Mem_Alloc16(VertexWeightSize() * numVerts);
+        simdProcessor->Memcpy(vertWeights, externalVertWeights, VertexWeightSize() * numVerts);
+    }
+}
+
 void SubMesh::AllocInstantiatedSubMesh(const SubMesh *ref, int meshType) {
     assert(ref->type == Mesh::Type::Reference);
 
     this->alloced                   = true;
+    this->externalData              = false;
     this->normalsCalculated         = ref->normalsCalculated;
     this->tangentsCalculated        = ref->tangentsCalculated;
     this->edgesCalculated           = ref->edgesCalculated;
@@ -107,6 +148,9 @@ void SubMesh::AllocInstantiatedSubMesh(const SubMesh *ref, int meshType) {
     this->edges                     = ref->edges;
     this->edgeIndexes               = ref->edgeIndexes;
 
+    this->numClusters               = ref->numClusters;
+    this->clusters                  = ref->clusters;
+
     this->numJointWeights           = ref->numJointWeights;
     this->jointWeights              = ref->jointWeights;
     this->jointWeightVerts          = ref->jointWeightVerts;
@@ -115,6 +159,9 @@ void SubMesh::AllocInstantiatedSubMesh(const SubMesh *ref, int meshType) {
     this->useGpuSkinning            = (ref->vertWeights && meshType == Mesh::Type::Skinned) ? true : false;
     this->gpuSkinningVersionIndex   = ref->gpuSkinningVersionIndex;
 
+    // CPU skinned vertices are written to the dynamic vertex buffer as VertexGeneric.
+    this->useCompactVertex          = ref->useCompactVertex && (meshType == Mesh::Type::Static || this->useGpuSkinning);
+
     this->aabb                      = ref->aabb;
 
     if (this->type == Mesh::Type::Static || this->useGpuSkinning) {
@@ -150,15 +197,18 @@ void SubMesh::FreeSubMesh() {
             indexCache->buffer = RHI::NullBuffer;
         }
 
-        Mem_AlignedFree(verts);
+        if (!externalData) {
+            Mem_AlignedFree(verts);
+            Mem_AlignedFree(indexes);
+            Mem_AlignedFree(vertWeights);
+        }
         Mem_AlignedFree(mirroredVerts);
-        Mem_AlignedFree(indexes);
         Mem_AlignedFree(dominantTris);
         Mem_AlignedFree(edges);
         Mem_AlignedFree(edgeIndexes);
+        Mem_AlignedFree(clusters);
         Mem_AlignedFree(jointWeights);
         Mem_AlignedFree(jointWeightVerts);
-        Mem_AlignedFree(vertWeights);
 
         Mem_Free(vertexCache);
         Mem_Free(indexCache);
@@ -171,13 +221,21 @@ void SubMesh::FreeSubMesh() {
     }
 }
 
+int SubMesh::VertexSize() const {
+    if (type == Mesh::Type::Dynamic) {
+        return sizeof(VertexGeneric);
+    }
+    return useCompactVertex ? sizeof(VertexGenericLitCompact) : sizeof(VertexGenericLit);
+}
+
 void SubMesh::CacheStaticDataToGpu() {
     // Fill in static vertex buffer.
     if (!bufferCacheManager.IsCached(vertexCache)) {
-        int sizeVerts = sizeof(VertexGenericLit) * numVerts;
+        int sizeVerts = VertexSize() * numVerts;
 
         // Write vertex weights after vertex data in the vertex buffer.
-        if (vertWeights) {//surfSpace->def->state.joints && useGpuSkinning) {
+        // Compact vertices are encoded into the mapped buffer directly.
+        if (vertWeights || useCompactVertex) {//surfSpace->def->state.joints && useGpuSkinning) {
             int sizeVertsAligned = ((sizeVerts + 15) >> 4) << 4;
             int sizeWeights = VertexWeightSize() * numVerts;
             int size = sizeVertsAligned + sizeWeights;
@@ -187,8 +245,15 @@ void SubMesh::CacheStaticDataToGpu() {
             rhi.BindBuffer(RHI::BufferType::Vertex, vertexCache->buffer);
             byte *ptr = (byte *)rhi.MapBuffer(vertexCache->buffer, RHI::BufferLockMode::WriteOnly);
 
-            rhi.WriteBuffer(ptr, (const byte *)verts, sizeVerts);
-            rhi.WriteBuffer(ptr + sizeVertsAligned, (const byte *)vertWeights, sizeWeights);
+            if (useCompactVertex) {
+                WriteCompactVerts((VertexGenericLitCompact *)ptr);
+            } else {
+                rhi.WriteBuffer(ptr, (const byte *)verts, sizeVerts);
+            }
+
+            if (sizeWeights > 0) {
+                rhi.WriteBuffer(ptr + sizeVertsAligned, (const byte *)vertWeights, sizeWeights);
+            }
 
             if (!rhi.UnmapBuffer(vertexCache->buffer)) {
                 BE_WARNLOG("Error unmapping buffer\n");
@@ -204,6 +269,19 @@ void SubMesh::CacheStaticDataToGpu() {
     }
 }
 
+void SubMesh::GetPositionDecodeScaleBias(Vec3 &decodeScale, Vec3 &decodeBias) const {
+    VertexGenericLitCompact::GetDecodeScaleBias(aabb, decodeScale, decodeBias);
+}
+
+void SubMesh::WriteCompactVerts(VertexGenericLitCompact *dst) const {
+    Vec3 decodeScale, decodeBias;
+    GetPositionDecodeScaleBias(decodeScale, decodeBias);
+
+    for (int i = 0; i < numVerts; i++) {
+        dst[i].Encode(verts[i], decodeScale, decodeBias);
+    }
+}
+
 void SubMesh::CacheDynamicDataToGpu(const Mat3x4 *joints, const Material *material) {
     if (bufferCacheManager.IsCached(vertexCache)) {
         return;
@@ -246,6 +324,8 @@ void SubMesh::SplitMirroredVerts() {
     Vec3        tangents[2];
     float       handedness;
 
+    DetachExternalData();
+
     static const TriIndex invalidIndex = std::numeric_limits<TriIndex>::max();
     float *vertHandednesses = (float *)_alloca16(sizeof(float) * numVerts);
     TriIndex *mirroredVertsIndexMap = (TriIndex *)_alloca16(sizeof(TriIndex) * numVerts);
@@ -415,6 +495,8 @@ void SubMesh::ComputeNormals() {
         return;
     }
 
+    DetachExternalData();
+
     Vec3 *tempNormals = (Vec3 *)Mem_Alloc16(numVerts * sizeof(Vec3));
 
     for (int i = 0; i < numVerts; i++) {
@@ -857,6 +939,8 @@ void SubMesh::ComputeTangents(bool includeNormals, bool useUnsmoothedTangents) {
         return;
     }
 
+    DetachExternalData();
+
     if (useUnsmoothedTangents) {
         ComputeDominantTris();
         R_DeriveUnsmoothedNormalsAndTangents(verts, dominantTris, numVerts);
@@ -1315,40 +1399,4 @@ const Mat3 SubMesh::ComputeInertiaTensor(const Vec3 &centroid, float mass) const
 #endif
 }
 
-void SubMesh::OptimizeIndexedTriangles() {
-#if 0
-    // NOTE: consider if size of the index is greater than 16 bit number or not
-    PrimitiveGroup *srcPrimGroup = new PrimitiveGroup;
-    srcPrimGroup->type = PrimType::PT_LIST;
-    srcPrimGroup->numIndices = numIndexes;
-    srcPrimGroup->indices = new unsigned short [numIndexes];
-
-    for (int i = 0; i < numIndexes; i++) {
-        srcPrimGroup->indices[i] = indexes[i];
-    }
-
-    PrimitiveGroup *dstPrimGroup;
-
-    // remap indices
-    RemapIndices(srcPrimGroup, 1, numVerts, &dstPrimGroup);
-
-    for (int i = 0; i < numIndexes; i++) {
-        indexes[i] = dstPrimGroup->indices[i];
-    }
-
-    // remap vertices
-    VertexGenericLit *remappedVerts = (VertexGenericLit *)Mem_Alloc16(sizeof(verts[0]) * numVerts);
-
-    for (int i = 0; i < numIndexes; i++) {
-        remappedVerts[dstPrimGroup->indices[i]] = verts[srcPrimGroup->indices[i]];
-    }
-
-    Mem_AlignedFree(verts);
-    verts = remappedVerts;
-    
-    delete srcPrimGroup;
-    delete [] dstPrimGroup;
-#endif
-}
-
 BE_NAMESPACE_END
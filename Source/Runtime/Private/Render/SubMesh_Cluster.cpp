@@ -0,0 +1,300 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "Core/Heap.h"
+
+BE_NAMESPACE_BEGIN
+
+/*
+-------------------------------------------------------------------------------
+
+    Triangle clusters
+
+    Clusters are grown greedily from the first unassigned triangle by adding
+    the adjacent triangle which is closest to the cluster and has the most similar normal.
+    Triangles of each cluster keep their previous relative order,
+    so the vertex cache order made by OptimizeIndexedTriangles() is mostly preserved.
+
+-------------------------------------------------------------------------------
+*/
+
+// Cluster normal cone is too wide to be back face culled if the cosine of the cone angle is less than this.
+static const float      ClusterMinConeCos = 0.1f;
+
+// Assigns a cluster index for each triangle and returns the number of clusters.
+static int GrowTriangleClusters(const VertexGenericLit *verts, int numVerts, const TriIndex *indexes, int numTris, int maxClusterTris, int32_t *triClusters) {
+    Array<Vec3> triNormals;
+    Array<Vec3> triCenters;
+    triNormals.SetCount(numTris);
+    triCenters.SetCount(numTris);
+
+    float totalArea = 0.0f;
+
+    for (int i = 0; i < numTris; i++) {
+        const Vec3 &p0 = verts[indexes[i * 3 + 0]].xyz;
+        const Vec3 &p1 = verts[indexes[i * 3 + 1]].xyz;
+        const Vec3 &p2 = verts[indexes[i * 3 + 2]].xyz;
+
+        triNormals[i] = (p1 - p0).Cross(p2 - p0);
+        totalArea += triNormals[i].Normalize() * 0.5f;
+        triCenters[i] = (p0 + p1 + p2) / 3.0f;
+    }
+
+    // Expected radius of the disk shaped cluster to normalize the distance cost.
+    float expectedRadius = Math::Sqrt(totalArea / numTris * maxClusterTris / Math::Pi);
+    float invExpectedRadius = expectedRadius > 0.0f ? 1.0f / expectedRadius : 0.0f;
+
+    // Vertex to triangle adjacency.
+    Array<int32_t> adjacencyOffsets;
+    adjacencyOffsets.SetCount(numVerts + 1);
+    memset(adjacencyOffsets.Ptr(), 0, adjacencyOffsets.MemoryUsed());
+
+    for (int i = 0; i < numTris * 3; i++) {
+        adjacencyOffsets[indexes[i] + 1]++;
+    }
+    for (int i = 0; i < numVerts; i++) {
+        adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+    }
+
+    Array<int32_t> adjacency;
+    adjacency.SetCount(numTris * 3);
+
+    Array<int32_t> fillCount;
+    fillCount.SetCount(numVerts);
+    memset(fillCount.Ptr(), 0, fillCount.MemoryUsed());
+
+    for (int i = 0; i < numTris * 3; i++) {
+        int32_t v = indexes[i];
+        adjacency[adjacencyOffsets[v] + fillCount[v]++] = i / 3;
+    }
+
+    // Triangles in the frontier are marked as -2.
+    for (int i = 0; i < numTris; i++) {
+        triClusters[i] = -1;
+    }
+
+    Array<int32_t> frontier;
+    frontier.Reserve(maxClusterTris * 16);
+
+    int numClusters = 0;
+
+    for (int seed = 0; seed < numTris; seed++) {
+        if (triClusters[seed] != -1) {
+            continue;
+        }
+
+        const int clusterIndex = numClusters++;
+
+        Vec3 normalSum = Vec3::zero;
+        Vec3 centerSum = Vec3::zero;
+        Vec3 axis = triNormals[seed];
+        Vec3 center = triCenters[seed];
+        int numClusterTris = 0;
+
+        frontier.SetCount(0, false);
+        frontier.Append(seed);
+        triClusters[seed] = -2;
+
+        while (frontier.Count() > 0 && numClusterTris < maxClusterTris) {
+            // Find the best triangle in the frontier. Ties are broken by the order in the frontier.
+            int bestFrontierIndex = 0;
+            float bestCost = FLT_MAX;
+
+            for (int i = 0; i < frontier.Count(); i++) {
+                int32_t t = frontier[i];
+                float cost = (1.0f - triNormals[t].Dot(axis)) + triCenters[t].Distance(center) * invExpectedRadius;
+
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestFrontierIndex = i;
+                }
+            }
+
+            int32_t t = frontier[bestFrontierIndex];
+            frontier.RemoveIndexFast(bestFrontierIndex);
+
+            triClusters[t] = clusterIndex;
+            numClusterTris++;
+
+            normalSum += triNormals[t];
+            centerSum += triCenters[t];
+
+            axis = normalSum;
+            if (axis.Normalize() == 0.0f) {
+                axis = triNormals[t];
+            }
+            center = centerSum / numClusterTris;
+
+            // Add unassigned triangles sharing the vertices to the frontier.
+            for (int j = 0; j < 3; j++) {
+                int32_t v = indexes[t * 3 + j];
+
+                for (int k = adjacencyOffsets[v]; k < adjacencyOffsets[v + 1]; k++) {
+                    int32_t adjacentTri = adjacency[k];
+
+                    if (triClusters[adjacentTri] == -1) {
+                        triClusters[adjacentTri] = -2;
+                        frontier.Append(adjacentTri);
+                    }
+                }
+            }
+        }
+
+        // Remaining frontier triangles are left for the following clusters.
+        for (int i = 0; i < frontier.Count(); i++) {
+            triClusters[frontier[i]] = -1;
+        }
+    }
+
+    return numClusters;
+}
+
+static void ComputeClusterBounds(const VertexGenericLit *verts, const TriIndex *indexes, MeshCluster &cluster) {
+    const TriIndex *clusterIndexes = &indexes[cluster.firstIndex];
+
+    cluster.aabb.Clear();
+    for (int i = 0; i < cluster.numIndexes; i++) {
+        cluster.aabb.AddPoint(verts[clusterIndexes[i]].xyz);
+    }
+
+    cluster.center = cluster.aabb.Center();
+
+    float radiusSqr = 0.0f;
+    for (int i = 0; i < cluster.numIndexes; i++) {
+        radiusSqr = Max(radiusSqr, verts[clusterIndexes[i]].xyz.DistanceSqr(cluster.center));
+    }
+    cluster.radius = Math::Sqrt(radiusSqr);
+
+    Vec3 normalSum = Vec3::zero;
+    for (int i = 0; i < cluster.numIndexes; i += 3) {
+        const Vec3 &p0 = verts[clusterIndexes[i + 0]].xyz;
+        const Vec3 &p1 = verts[clusterIndexes[i + 1]].xyz;
+        const Vec3 &p2 = verts[clusterIndexes[i + 2]].xyz;
+
+        Vec3 normal = (p1 - p0).Cross(p2 - p0);
+        normal.Normalize();
+        normalSum += normal;
+    }
+
+    cluster.coneAxis = normalSum;
+    cluster.coneCutoff = 1.0f;
+
+    if (cluster.coneAxis.Normalize() == 0.0f) {
+        return;
+    }
+
+    float minDot = 1.0f;
+    for (int i = 0; i < cluster.numIndexes; i += 3) {
+        const Vec3 &p0 = verts[clusterIndexes[i + 0]].xyz;
+        const Vec3 &p1 = verts[clusterIndexes[i + 1]].xyz;
+        const Vec3 &p2 = verts[clusterIndexes[i + 2]].xyz;
+
+        Vec3 normal = (p1 - p0).Cross(p2 - p0);
+        if (normal.Normalize() == 0.0f) {
+            continue;
+        }
+        minDot = Min(minDot, normal.Dot(cluster.coneAxis));
+    }
+
+    if (minDot > ClusterMinConeCos) {
+        cluster.coneCutoff = Math::Sqrt(1.0f - minDot * minDot);
+    }
+}
+
+void SubMesh::BuildClusters() {
+    FreeClusters();
+
+    // Instantiated sub mesh shares the data with the reference sub mesh.
+    if (type != Mesh::Type::Reference) {
+        return;
+    }
+
+    const int numTris = numIndexes / 3;
+
+    // Nothing to cull with only one cluster.
+    if (numTris <= MaxClusterTris) {
+        return;
+    }
+
+    DetachExternalData();
+
+    Array<int32_t> triClusters;
+    triClusters.SetCount(numTris);
+
+    int numNewClusters = GrowTriangleClusters(verts, numVerts, indexes, numTris, MaxClusterTris, triClusters.Ptr());
+
+    // Counting sort of the triangles by the cluster index keeps the relative order in each cluster.
+    Array<int32_t> clusterOffsets;
+    clusterOffsets.SetCount(numNewClusters + 1);
+    memset(clusterOffsets.Ptr(), 0, clusterOffsets.MemoryUsed());
+
+    for (int i = 0; i < numTris; i++) {
+        clusterOffsets[triClusters[i] + 1]++;
+    }
+    for (int i = 0; i < numNewClusters; i++) {
+        clusterOffsets[i + 1] += clusterOffsets[i];
+    }
+
+    TriIndex *sortedIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * numIndexes);
+
+    Array<int32_t> fillCount;
+    fillCount.SetCount(numNewClusters);
+    memset(fillCount.Ptr(), 0, fillCount.MemoryUsed());
+
+    for (int i = 0; i < numTris; i++) {
+        int32_t clusterIndex = triClusters[i];
+        int32_t dstTri = clusterOffsets[clusterIndex] + fillCount[clusterIndex]++;
+
+        sortedIndexes[dstTri * 3 + 0] = indexes[i * 3 + 0];
+        sortedIndexes[dstTri * 3 + 1] = indexes[i * 3 + 1];
+        sortedIndexes[dstTri * 3 + 2] = indexes[i * 3 + 2];
+    }
+
+    Mem_AlignedFree(indexes);
+    indexes = sortedIndexes;
+
+    numClusters = numNewClusters;
+    clusters = (MeshCluster *)Mem_Alloc16(sizeof(MeshCluster) * numClusters);
+
+    for (int clusterIndex = 0; clusterIndex < numClusters; clusterIndex++) {
+        MeshCluster &cluster = clusters[clusterIndex];
+        cluster.firstIndex = clusterOffsets[clusterIndex] * 3;
+        cluster.numIndexes = (clusterOffsets[clusterIndex + 1] - clusterOffsets[clusterIndex]) * 3;
+
+        ComputeClusterBounds(verts, indexes, cluster);
+    }
+
+    // Edge indexes are per triangle edge.
+    if (edgesCalculated) {
+        Mem_AlignedFree(edges);
+        Mem_AlignedFree(edgeIndexes);
+        edges = nullptr;
+        edgeIndexes = nullptr;
+        numEdges = 0;
+        edgesCalculated = false;
+    }
+}
+
+void SubMesh::FreeClusters() {
+    if (type == Mesh::Type::Reference) {
+        Mem_AlignedFree(clusters);
+    }
+    clusters = nullptr;
+    numClusters = 0;
+}
+
+BE_NAMESPACE_END
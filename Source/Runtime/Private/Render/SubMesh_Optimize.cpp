@@ -0,0 +1,444 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "Core/Heap.h"
+
+BE_NAMESPACE_BEGIN
+
+/*
+-------------------------------------------------------------------------------
+
+    Triangle order optimization
+
+    Based on "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+    (Sander, Nehab, Barczak 2007).
+
+    1. Tipsify reorders triangles for the post-transform vertex cache.
+    2. The reordered triangles are split into clusters at the cache flushes,
+       and then clusters are sorted from the outside of the mesh to reduce overdraw.
+    3. Vertices are reordered by first use for the vertex fetch locality.
+
+    Everything is processed in the 32 bit indexes and ties are broken by the index,
+    so the result only depends on the input.
+
+-------------------------------------------------------------------------------
+*/
+
+static const int        OptimizeCacheSize = 16;
+// Soft cluster boundary is made if the ACMR of the cluster so far is less than this scale of the hard cluster ACMR.
+static const float      OptimizeClusterACMRScale = 1.05f;
+// Minimum number of triangles of the soft clusters. Smaller clusters reduce more overdraw but break the vertex cache more often.
+static const int        OptimizeMinClusterTris = 128;
+
+static int32_t TipsifyNextVertex(int numVerts, int cacheSize, int32_t time, const Array<int32_t> &candidates,
+    const Array<int32_t> &cacheTime, const Array<int32_t> &liveTriCount, Array<int32_t> &deadEndStack, int32_t &cursor) {
+    int32_t bestVertex = -1;
+    int32_t bestPriority = -1;
+
+    for (int i = 0; i < candidates.Count(); i++) {
+        int32_t v = candidates[i];
+
+        if (liveTriCount[v] > 0) {
+            int32_t priority = 0;
+            // Prefer the vertex which will be still in the cache after fanning all of its triangles.
+            if (time - cacheTime[v] + 2 * liveTriCount[v] <= cacheSize) {
+                priority = time - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                bestVertex = v;
+            }
+        }
+    }
+
+    if (bestVertex >= 0) {
+        return bestVertex;
+    }
+
+    // Recently referenced vertex which still has triangles to emit.
+    while (deadEndStack.Count() > 0) {
+        int32_t v = deadEndStack[deadEndStack.Count() - 1];
+        deadEndStack.SetCount(deadEndStack.Count() - 1, false);
+
+        if (liveTriCount[v] > 0) {
+            return v;
+        }
+    }
+
+    // Next vertex in the input order.
+    while (cursor < numVerts) {
+        int32_t v = cursor++;
+
+        if (liveTriCount[v] > 0) {
+            return v;
+        }
+    }
+
+    return -1;
+}
+
+// Returns triangle order optimized for the vertex cache of the given size.
+static void TipsifyTriangles(const int32_t *indexes, int numTris, int numVerts, int cacheSize, Array<int32_t> &triOrder) {
+    // Vertex to triangle adjacency.
+    Array<int32_t> liveTriCount;
+    liveTriCount.SetCount(numVerts);
+    memset(liveTriCount.Ptr(), 0, liveTriCount.MemoryUsed());
+
+    for (int i = 0; i < numTris * 3; i++) {
+        liveTriCount[indexes[i]]++;
+    }
+
+    Array<int32_t> adjacencyOffsets;
+    adjacencyOffsets.SetCount(numVerts + 1);
+    adjacencyOffsets[0] = 0;
+    for (int i = 0; i < numVerts; i++) {
+        adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriCount[i];
+    }
+
+    Array<int32_t> adjacency;
+    adjacency.SetCount(numTris * 3);
+
+    Array<int32_t> fillCount;
+    fillCount.SetCount(numVerts);
+    memset(fillCount.Ptr(), 0, fillCount.MemoryUsed());
+
+    for (int i = 0; i < numTris * 3; i++) {
+        int32_t v = indexes[i];
+        adjacency[adjacencyOffsets[v] + fillCount[v]++] = i / 3;
+    }
+
+    Array<int32_t> cacheTime;
+    cacheTime.SetCount(numVerts);
+    memset(cacheTime.Ptr(), 0, cacheTime.MemoryUsed());
+
+    Array<bool> emitted;
+    emitted.SetCount(numTris);
+    memset(emitted.Ptr(), 0, emitted.MemoryUsed());
+
+    Array<int32_t> deadEndStack;
+    deadEndStack.Reserve(numTris * 3);
+
+    Array<int32_t> candidates;
+    candidates.Reserve(64);
+
+    triOrder.SetCount(0, false);
+    triOrder.Reserve(numTris);
+
+    int32_t time = cacheSize + 1;
+    int32_t cursor = 1;
+    int32_t fanningVertex = 0;
+
+    while (fanningVertex >= 0) {
+        candidates.SetCount(0, false);
+
+        for (int i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++) {
+            int32_t t = adjacency[i];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+            triOrder.Append(t);
+
+            for (int j = 0; j < 3; j++) {
+                int32_t v = indexes[t * 3 + j];
+
+                deadEndStack.Append(v);
+                candidates.Append(v);
+                liveTriCount[v]--;
+
+                if (time - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = time;
+                    time++;
+                }
+            }
+        }
+
+        fanningVertex = TipsifyNextVertex(numVerts, cacheSize, time, candidates, cacheTime, liveTriCount, deadEndStack, cursor);
+    }
+}
+
+// Simulates FIFO cache and returns the number of the missed vertices for each triangles.
+static int SimulateVertexCache(const int32_t *indexes, int numTris, int numVerts, int cacheSize, uint8_t *triMisses) {
+    Array<int32_t> cacheTime;
+    cacheTime.SetCount(numVerts);
+    memset(cacheTime.Ptr(), 0, cacheTime.MemoryUsed());
+
+    int32_t time = cacheSize + 1;
+    int misses = 0;
+
+    for (int i = 0; i < numTris; i++) {
+        uint8_t triMiss = 0;
+
+        for (int j = 0; j < 3; j++) {
+            int32_t v = indexes[i * 3 + j];
+
+            if (time - cacheTime[v] > cacheSize) {
+                cacheTime[v] = time;
+                time++;
+                triMiss++;
+            }
+        }
+
+        if (triMisses) {
+            triMisses[i] = triMiss;
+        }
+        misses += triMiss;
+    }
+    return misses;
+}
+
+// Splits triangles into clusters and sorts them so that the clusters which are facing outward from the mesh center are drawn first.
+static void SortClustersForOverdraw(const VertexGenericLit *verts, int numVerts, int32_t *indexes, int numTris, int cacheSize) {
+    Array<uint8_t> triMisses;
+    triMisses.SetCount(numTris);
+    SimulateVertexCache(indexes, numTris, numVerts, cacheSize, triMisses.Ptr());
+
+    // Hard boundaries are at the triangles which miss all the vertices.
+    Array<int32_t> clusterStarts;
+    clusterStarts.Reserve(64);
+
+    int hardStart = 0;
+    while (hardStart < numTris) {
+        int hardEnd = hardStart + 1;
+        int hardMisses = triMisses[hardStart];
+        while (hardEnd < numTris && triMisses[hardEnd] < 3) {
+            hardMisses += triMisses[hardEnd];
+            hardEnd++;
+        }
+
+        // Soft boundaries are made once the cluster amortizes its cold cache cost.
+        float hardACMR = (float)hardMisses / (hardEnd - hardStart);
+        int softStart = hardStart;
+        int softMisses = 0;
+
+        clusterStarts.Append(hardStart);
+
+        for (int i = hardStart; i < hardEnd; i++) {
+            softMisses += triMisses[i];
+
+            int softTris = i + 1 - softStart;
+
+            if (i + 1 < hardEnd && softTris >= OptimizeMinClusterTris && (float)softMisses <= hardACMR * OptimizeClusterACMRScale * softTris) {
+                softStart = i + 1;
+                softMisses = 0;
+                clusterStarts.Append(softStart);
+            }
+        }
+
+        hardStart = hardEnd;
+    }
+
+    int numClusters = clusterStarts.Count();
+    if (numClusters <= 1) {
+        return;
+    }
+    clusterStarts.Append(numTris);
+
+    // Area weighted centroid and normal of each clusters.
+    struct Cluster {
+        int32_t             index;
+        float               sortKey;
+        Vec3                centroid;
+        Vec3                normal;
+        float               area;
+    };
+
+    Array<Cluster> clusters;
+    clusters.SetCount(numClusters);
+
+    Vec3 meshCentroid = Vec3::origin;
+    float meshArea = 0.0f;
+
+    for (int clusterIndex = 0; clusterIndex < numClusters; clusterIndex++) {
+        Cluster &cluster = clusters[clusterIndex];
+        cluster.index = clusterIndex;
+        cluster.centroid = Vec3::origin;
+        cluster.normal = Vec3::origin;
+        cluster.area = 0.0f;
+
+        for (int i = clusterStarts[clusterIndex]; i < clusterStarts[clusterIndex + 1]; i++) {
+            const Vec3 &p0 = verts[indexes[i * 3 + 0]].xyz;
+            const Vec3 &p1 = verts[indexes[i * 3 + 1]].xyz;
+            const Vec3 &p2 = verts[indexes[i * 3 + 2]].xyz;
+
+            Vec3 n = (p1 - p0).Cross(p2 - p0);
+            float area = n.Length();
+
+            cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+            cluster.normal += n;
+            cluster.area += area;
+        }
+
+        meshCentroid += cluster.centroid;
+        meshArea += cluster.area;
+
+        if (cluster.area > 0.0f) {
+            cluster.centroid /= cluster.area;
+        }
+        cluster.normal.Normalize();
+    }
+
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    for (int clusterIndex = 0; clusterIndex < numClusters; clusterIndex++) {
+        Cluster &cluster = clusters[clusterIndex];
+        cluster.sortKey = (cluster.centroid - meshCentroid).Dot(cluster.normal);
+    }
+
+    clusters.Sort([](const Cluster &a, const Cluster &b) {
+        if (a.sortKey != b.sortKey) {
+            return a.sortKey > b.sortKey;
+        }
+        return a.index < b.index;
+    });
+
+    Array<int32_t> sortedIndexes;
+    sortedIndexes.SetCount(numTris * 3);
+
+    int numSortedIndexes = 0;
+    for (int clusterIndex = 0; clusterIndex < numClusters; clusterIndex++) {
+        int first = clusterStarts[clusters[clusterIndex].index];
+        int last = clusterStarts[clusters[clusterIndex].index + 1];
+
+        memcpy(&sortedIndexes[numSortedIndexes], &indexes[first * 3], sizeof(indexes[0]) * (last - first) * 3);
+        numSortedIndexes += (last - first) * 3;
+    }
+
+    memcpy(indexes, sortedIndexes.Ptr(), sortedIndexes.MemoryUsed());
+}
+
+float SubMesh::ComputeACMR(int cacheSize) const {
+    if (numIndexes < 3) {
+        return 0.0f;
+    }
+
+    Array<int32_t> indexes32;
+    indexes32.SetCount(numIndexes);
+    for (int i = 0; i < numIndexes; i++) {
+        indexes32[i] = indexes[i];
+    }
+
+    int misses = SimulateVertexCache(indexes32.Ptr(), numIndexes / 3, numVerts, cacheSize, nullptr);
+    return (float)misses / (numIndexes / 3);
+}
+
+void SubMesh::OptimizeIndexedTriangles() {
+    // Instantiated sub mesh shares the data with the reference sub mesh.
+    if (type != Mesh::Type::Reference) {
+        return;
+    }
+
+    if (numIndexes < 3 || numVerts == 0) {
+        return;
+    }
+
+    DetachExternalData();
+
+    // Clusters are made from the triangle order, so they should be rebuilt.
+    FreeClusters();
+
+    const int numTris = numIndexes / 3;
+
+    Array<int32_t> indexes32;
+    indexes32.SetCount(numTris * 3);
+    for (int i = 0; i < numTris * 3; i++) {
+        indexes32[i] = indexes[i];
+    }
+
+    // Reorder triangles for the vertex cache.
+    Array<int32_t> triOrder;
+    TipsifyTriangles(indexes32.Ptr(), numTris, numVerts, OptimizeCacheSize, triOrder);
+
+    Array<int32_t> orderedIndexes;
+    orderedIndexes.SetCount(numTris * 3);
+    for (int i = 0; i < numTris; i++) {
+        int32_t t = triOrder[i];
+        orderedIndexes[i * 3 + 0] = indexes32[t * 3 + 0];
+        orderedIndexes[i * 3 + 1] = indexes32[t * 3 + 1];
+        orderedIndexes[i * 3 + 2] = indexes32[t * 3 + 2];
+    }
+
+    // Reorder clusters for the overdraw.
+    SortClustersForOverdraw(verts, numVerts, orderedIndexes.Ptr(), numTris, OptimizeCacheSize);
+
+    // Mirrored vertices and CPU skinning weights refer the vertex indexes, so vertices can't be moved.
+    if (numMirroredVerts == 0 && numJointWeights == 0) {
+        // Reorder vertices by the first use for the vertex fetch.
+        Array<int32_t> vertexRemap;
+        vertexRemap.SetCount(numVerts);
+        memset(vertexRemap.Ptr(), -1, vertexRemap.MemoryUsed());
+
+        int32_t numRemappedVerts = 0;
+        for (int i = 0; i < numTris * 3; i++) {
+            int32_t &remap = vertexRemap[orderedIndexes[i]];
+            if (remap < 0) {
+                remap = numRemappedVerts++;
+            }
+        }
+        // Unreferenced vertices are placed at the end.
+        for (int i = 0; i < numVerts; i++) {
+            if (vertexRemap[i] < 0) {
+                vertexRemap[i] = numRemappedVerts++;
+            }
+        }
+
+        VertexGenericLit *remappedVerts = (VertexGenericLit *)Mem_Alloc16(sizeof(verts[0]) * numVerts);
+        for (int i = 0; i < numVerts; i++) {
+            remappedVerts[vertexRemap[i]] = verts[i];
+        }
+        Mem_AlignedFree(verts);
+        verts = remappedVerts;
+
+        if (vertWeights) {
+            int vertexWeightSize = VertexWeightSize();
+            void *remappedVertWeights = Mem_Alloc16(vertexWeightSize * numVerts);
+            for (int i = 0; i < numVerts; i++) {
+                memcpy((byte *)remappedVertWeights + vertexWeightSize * vertexRemap[i], (byte *)vertWeights + vertexWeightSize * i, vertexWeightSize);
+            }
+            Mem_AlignedFree(vertWeights);
+            vertWeights = remappedVertWeights;
+        }
+
+        for (int i = 0; i < numTris * 3; i++) {
+            orderedIndexes[i] = vertexRemap[orderedIndexes[i]];
+        }
+
+        // Dominant triangles refer the vertex indexes. They will be recomputed with the tangents.
+        if (dominantTris) {
+            Mem_AlignedFree(dominantTris);
+            dominantTris = nullptr;
+        }
+    }
+
+    for (int i = 0; i < numTris * 3; i++) {
+        indexes[i] = orderedIndexes[i];
+    }
+
+    // Edge indexes are per triangle edge.
+    if (edgesCalculated) {
+        Mem_AlignedFree(edges);
+        Mem_AlignedFree(edgeIndexes);
+        edges = nullptr;
+        edgeIndexes = nullptr;
+        numEdges = 0;
+        edgesCalculated = false;
+    }
+}
+
+BE_NAMESPACE_END
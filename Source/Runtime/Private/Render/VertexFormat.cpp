@@ -160,6 +160,113 @@ void VertexFormat::Init() {
         CreateInstancingVertexFormats(2, VertexFormat::Type::GenericXyzStColorNTSkinning8, VertexFormat::Type::GenericXyzStColorNTInstancingSkinning8, true);
     }
 
+    // Compact vertex formats use the same layout of the indices as the generic ones.
+    // Position is normalized in the sub mesh AABB, and w holds the bitangent sign.
+    // Normal and tangent are octahedral encoded.
+
+    // CompactXyz
+    vertexFormats[VertexFormat::Type::CompactXyz].Append(0, OFFSET_OF(VertexGenericLitCompact, xyz), RHI::VertexElement::Usage::Position, 4, RHI::VertexElement::Type::Short, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyz].Create();
+
+    // CompactXyzSkinning1, CompactXyzSkinning4, CompactXyzSkinning8
+    CreateSkinningVertexFormats(1, VertexFormat::Type::CompactXyz,
+        VertexFormat::Type::CompactXyzSkinning1,
+        VertexFormat::Type::CompactXyzSkinning4,
+        VertexFormat::Type::CompactXyzSkinning8);
+
+    // CompactXyzSt
+    vertexFormats[VertexFormat::Type::CompactXyzSt].Append(0, OFFSET_OF(VertexGenericLitCompact, xyz), RHI::VertexElement::Usage::Position, 4, RHI::VertexElement::Type::Short, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzSt].Append(0, OFFSET_OF(VertexGenericLitCompact, st), RHI::VertexElement::Usage::TexCoord0, 2, RHI::VertexElement::Type::Half, false, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzSt].Create();
+
+    // CompactXyzStSkinning1, CompactXyzStSkinning4, CompactXyzStSkinning8
+    CreateSkinningVertexFormats(1, VertexFormat::Type::CompactXyzSt,
+        VertexFormat::Type::CompactXyzStSkinning1,
+        VertexFormat::Type::CompactXyzStSkinning4,
+        VertexFormat::Type::CompactXyzStSkinning8);
+
+    // CompactXyzStColor
+    vertexFormats[VertexFormat::Type::CompactXyzStColor].Append(0, OFFSET_OF(VertexGenericLitCompact, xyz), RHI::VertexElement::Usage::Position, 4, RHI::VertexElement::Type::Short, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStColor].Append(0, OFFSET_OF(VertexGenericLitCompact, st), RHI::VertexElement::Usage::TexCoord0, 2, RHI::VertexElement::Type::Half, false, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStColor].Append(0, OFFSET_OF(VertexGenericLitCompact, color), RHI::VertexElement::Usage::Color, 4, RHI::VertexElement::Type::UByte, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStColor].Create();
+
+    // CompactXyzStColorSkinning1, CompactXyzStColorSkinning4, CompactXyzStColorSkinning8
+    CreateSkinningVertexFormats(1, VertexFormat::Type::CompactXyzStColor,
+        VertexFormat::Type::CompactXyzStColorSkinning1,
+        VertexFormat::Type::CompactXyzStColorSkinning4,
+        VertexFormat::Type::CompactXyzStColorSkinning8);
+
+    // CompactXyzNormal
+    vertexFormats[VertexFormat::Type::CompactXyzNormal].Append(0, OFFSET_OF(VertexGenericLitCompact, xyz), RHI::VertexElement::Usage::Position, 4, RHI::VertexElement::Type::Short, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzNormal].Append(0, OFFSET_OF(VertexGenericLitCompact, normal), RHI::VertexElement::Usage::Normal, 2, RHI::VertexElement::Type::Byte, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzNormal].Create();
+
+    // CompactXyzNormalSkinning1, CompactXyzNormalSkinning4, CompactXyzNormalSkinning8
+    CreateSkinningVertexFormats(1, VertexFormat::Type::CompactXyzNormal,
+        VertexFormat::Type::CompactXyzNormalSkinning1,
+        VertexFormat::Type::CompactXyzNormalSkinning4,
+        VertexFormat::Type::CompactXyzNormalSkinning8);
+
+    // CompactXyzStNT
+    vertexFormats[VertexFormat::Type::CompactXyzStNT].Append(0, OFFSET_OF(VertexGenericLitCompact, xyz), RHI::VertexElement::Usage::Position, 4, RHI::VertexElement::Type::Short, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStNT].Append(0, OFFSET_OF(VertexGenericLitCompact, st), RHI::VertexElement::Usage::TexCoord0, 2, RHI::VertexElement::Type::Half, false, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStNT].Append(0, OFFSET_OF(VertexGenericLitCompact, normal), RHI::VertexElement::Usage::Normal, 2, RHI::VertexElement::Type::Byte, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStNT].Append(0, OFFSET_OF(VertexGenericLitCompact, tangent), RHI::VertexElement::Usage::Tangent, 2, RHI::VertexElement::Type::Byte, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStNT].Create();
+
+    // CompactXyzStNTSkinning1, CompactXyzStNTSkinning4, CompactXyzStNTSkinning8
+    CreateSkinningVertexFormats(1, VertexFormat::Type::CompactXyzStNT,
+        VertexFormat::Type::CompactXyzStNTSkinning1,
+        VertexFormat::Type::CompactXyzStNTSkinning4,
+        VertexFormat::Type::CompactXyzStNTSkinning8);
+
+    // CompactXyzStColorNT
+    vertexFormats[VertexFormat::Type::CompactXyzStColorNT].Append(0, OFFSET_OF(VertexGenericLitCompact, xyz), RHI::VertexElement::Usage::Position, 4, RHI::VertexElement::Type::Short, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStColorNT].Append(0, OFFSET_OF(VertexGenericLitCompact, st), RHI::VertexElement::Usage::TexCoord0, 2, RHI::VertexElement::Type::Half, false, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStColorNT].Append(0, OFFSET_OF(VertexGenericLitCompact, color), RHI::VertexElement::Usage::Color, 4, RHI::VertexElement::Type::UByte, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStColorNT].Append(0, OFFSET_OF(VertexGenericLitCompact, normal), RHI::VertexElement::Usage::Normal, 2, RHI::VertexElement::Type::Byte, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStColorNT].Append(0, OFFSET_OF(VertexGenericLitCompact, tangent), RHI::VertexElement::Usage::Tangent, 2, RHI::VertexElement::Type::Byte, true, 0);
+    vertexFormats[VertexFormat::Type::CompactXyzStColorNT].Create();
+
+    // CompactXyzStColorNTSkinning1, CompactXyzStColorNTSkinning4, CompactXyzStColorNTSkinning8
+    CreateSkinningVertexFormats(1, VertexFormat::Type::CompactXyzStColorNT,
+        VertexFormat::Type::CompactXyzStColorNTSkinning1,
+        VertexFormat::Type::CompactXyzStColorNTSkinning4,
+        VertexFormat::Type::CompactXyzStColorNTSkinning8);
+
+    if (renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays) {
+        CreateInstancingVertexFormats(1, VertexFormat::Type::CompactXyz, VertexFormat::Type::CompactXyzInstancing, false);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzSkinning1, VertexFormat::Type::CompactXyzInstancingSkinning1, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzSkinning4, VertexFormat::Type::CompactXyzInstancingSkinning4, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzSkinning8, VertexFormat::Type::CompactXyzInstancingSkinning8, true);
+
+        CreateInstancingVertexFormats(1, VertexFormat::Type::CompactXyzSt, VertexFormat::Type::CompactXyzStInstancing, false);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStSkinning1, VertexFormat::Type::CompactXyzStInstancingSkinning1, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStSkinning4, VertexFormat::Type::CompactXyzStInstancingSkinning4, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStSkinning8, VertexFormat::Type::CompactXyzStInstancingSkinning8, true);
+
+        CreateInstancingVertexFormats(1, VertexFormat::Type::CompactXyzStColor, VertexFormat::Type::CompactXyzStColorInstancing, false);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStColorSkinning1, VertexFormat::Type::CompactXyzStColorInstancingSkinning1, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStColorSkinning4, VertexFormat::Type::CompactXyzStColorInstancingSkinning4, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStColorSkinning8, VertexFormat::Type::CompactXyzStColorInstancingSkinning8, true);
+
+        CreateInstancingVertexFormats(1, VertexFormat::Type::CompactXyzNormal, VertexFormat::Type::CompactXyzNormalInstancing, false);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzNormalSkinning1, VertexFormat::Type::CompactXyzNormalInstancingSkinning1, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzNormalSkinning4, VertexFormat::Type::CompactXyzNormalInstancingSkinning4, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzNormalSkinning8, VertexFormat::Type::CompactXyzNormalInstancingSkinning8, true);
+
+        CreateInstancingVertexFormats(1, VertexFormat::Type::CompactXyzStNT, VertexFormat::Type::CompactXyzStNTInstancing, false);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStNTSkinning1, VertexFormat::Type::CompactXyzStNTInstancingSkinning1, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStNTSkinning4, VertexFormat::Type::CompactXyzStNTInstancingSkinning4, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStNTSkinning8, VertexFormat::Type::CompactXyzStNTInstancingSkinning8, true);
+
+        CreateInstancingVertexFormats(1, VertexFormat::Type::CompactXyzStColorNT, VertexFormat::Type::CompactXyzStColorNTInstancing, false);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStColorNTSkinning1, VertexFormat::Type::CompactXyzStColorNTInstancingSkinning1, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStColorNTSkinning4, VertexFormat::Type::CompactXyzStColorNTInstancingSkinning4, true);
+        CreateInstancingVertexFormats(2, VertexFormat::Type::CompactXyzStColorNTSkinning8, VertexFormat::Type::CompactXyzStColorNTInstancingSkinning8, true);
+    }
+
     // Occludee
     vertexFormats[VertexFormat::Type::Occludee].Append(0, 0, RHI::VertexElement::Usage::Position, 2, RHI::VertexElement::Type::Float, false, 0);
     vertexFormats[VertexFormat::Type::Occludee].Append(0, 8, RHI::VertexElement::Usage::TexCoord0, 3, RHI::VertexElement::Type::Float, false, 0);
@@ -230,10 +337,13 @@ void VertexFormat::Append(int stream, int offset, RHI::VertexElement::Usage::Enu
 
     int typeSize;
     switch (type) {
+    case RHI::VertexElement::Type::Byte:
     case RHI::VertexElement::Type::UByte:
         typeSize = 1; 
         break;
     case RHI::VertexElement::Type::Half:
+    case RHI::VertexElement::Type::Short:
+    case RHI::VertexElement::Type::UShort:
         typeSize = 2;
         break;
     case RHI::VertexElement::Type::UInt:
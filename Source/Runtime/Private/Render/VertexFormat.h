@@ -85,6 +85,55 @@ public:
             GenericXyzStColorNTInstancingSkinning1,
             GenericXyzStColorNTInstancingSkinning4,
             GenericXyzStColorNTInstancingSkinning8,
+            // --- VertexGenericLitCompact ---
+            CompactXyz,
+            CompactXyzSkinning1,
+            CompactXyzSkinning4,
+            CompactXyzSkinning8,
+            CompactXyzInstancing,
+            CompactXyzInstancingSkinning1,
+            CompactXyzInstancingSkinning4,
+            CompactXyzInstancingSkinning8,
+            CompactXyzSt,
+            CompactXyzStSkinning1,
+            CompactXyzStSkinning4,
+            CompactXyzStSkinning8,
+            CompactXyzStInstancing,
+            CompactXyzStInstancingSkinning1,
+            CompactXyzStInstancingSkinning4,
+            CompactXyzStInstancingSkinning8,
+            CompactXyzStColor,
+            CompactXyzStColorSkinning1,
+            CompactXyzStColorSkinning4,
+            CompactXyzStColorSkinning8,
+            CompactXyzStColorInstancing,
+            CompactXyzStColorInstancingSkinning1,
+            CompactXyzStColorInstancingSkinning4,
+            CompactXyzStColorInstancingSkinning8,
+            CompactXyzNormal,
+            CompactXyzNormalSkinning1,
+            CompactXyzNormalSkinning4,
+            CompactXyzNormalSkinning8,
+            CompactXyzNormalInstancing,
+            CompactXyzNormalInstancingSkinning1,
+            CompactXyzNormalInstancingSkinning4,
+            CompactXyzNormalInstancingSkinning8,
+            CompactXyzStNT,
+            CompactXyzStNTSkinning1,
+            CompactXyzStNTSkinning4,
+            CompactXyzStNTSkinning8,
+            CompactXyzStNTInstancing,
+            CompactXyzStNTInstancingSkinning1,
+            CompactXyzStNTInstancingSkinning4,
+            CompactXyzStNTInstancingSkinning8,
+            CompactXyzStColorNT,
+            CompactXyzStColorNTSkinning1,
+            CompactXyzStColorNTSkinning4,
+            CompactXyzStColorNTSkinning8,
+            CompactXyzStColorNTInstancing,
+            CompactXyzStColorNTInstancingSkinning1,
+            CompactXyzStColorNTInstancingSkinning4,
+            CompactXyzStColorNTInstancingSkinning8,
             // -----------------------------
             Occludee,
             Count
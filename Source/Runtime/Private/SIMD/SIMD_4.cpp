@@ -154,7 +154,7 @@ void BE_FASTCALL SIMD_4::Sub(float *dst, const float constant, const float *src,
     }
 
     while (count > 0) {
-        *dst_ptr++ = constant + *src_ptr++;
+        *dst_ptr++ = constant - *src_ptr++;
         count--;
     }
 }
@@ -200,7 +200,7 @@ void BE_FASTCALL SIMD_4::Sub(float *dst, const float *src0, const float *src1, c
     }
 
     while (count > 0) {
-        *dst_ptr++ = *src0_ptr++ + *src1_ptr++;
+        *dst_ptr++ = *src0_ptr++ - *src1_ptr++;
         count--;
     }
 }
@@ -239,7 +239,7 @@ void BE_FASTCALL SIMD_4::Mul(float *dst, const float constant, const float *src,
     }
 
     while (count > 0) {
-        *dst_ptr++ = constant + *src_ptr++;
+        *dst_ptr++ = constant * *src_ptr++;
         count--;
     }
 }
@@ -285,7 +285,7 @@ void BE_FASTCALL SIMD_4::Mul(float *dst, const float *src0, const float *src1, c
     }
 
     while (count > 0) {
-        *dst_ptr++ = *src0_ptr++ + *src1_ptr++;
+        *dst_ptr++ = *src0_ptr++ * *src1_ptr++;
         count--;
     }
 }
@@ -324,7 +324,7 @@ void BE_FASTCALL SIMD_4::Div(float *dst, const float constant, const float *src,
     }
 
     while (count > 0) {
-        *dst_ptr++ = constant + *src_ptr++;
+        *dst_ptr++ = constant / *src_ptr++;
         count--;
     }
 }
@@ -370,7 +370,7 @@ void BE_FASTCALL SIMD_4::Div(float *dst, const float *src0, const float *src1, c
     }
 
     while (count > 0) {
-        *dst_ptr++ = *src0_ptr++ + *src1_ptr++;
+        *dst_ptr++ = *src0_ptr++ / *src1_ptr++;
         count--;
     }
 }
@@ -242,7 +242,7 @@ void BE_FASTCALL SIMD_8::Sub(float *dst, const float constant, const float *src,
     }
 
     while (count > 0) {
-        *dst_ptr++ = constant + *src_ptr++;
+        *dst_ptr++ = constant - *src_ptr++;
         count--;
     }
 }
@@ -322,7 +322,7 @@ void BE_FASTCALL SIMD_8::Sub(float *dst, const float *src0, const float *src1, c
     }
 
     while (count > 0) {
-        *dst_ptr++ = *src0_ptr++ + *src1_ptr++;
+        *dst_ptr++ = *src0_ptr++ - *src1_ptr++;
         count--;
     }
 }
@@ -389,7 +389,7 @@ void BE_FASTCALL SIMD_8::Mul(float *dst, const float constant, const float *src,
     }
 
     while (count > 0) {
-        *dst_ptr++ = constant + *src_ptr++;
+        *dst_ptr++ = constant * *src_ptr++;
         count--;
     }
 }
@@ -469,7 +469,7 @@ void BE_FASTCALL SIMD_8::Mul(float *dst, const float *src0, const float *src1, c
     }
 
     while (count > 0) {
-        *dst_ptr++ = *src0_ptr++ + *src1_ptr++;
+        *dst_ptr++ = *src0_ptr++ * *src1_ptr++;
         count--;
     }
 }
@@ -536,7 +536,7 @@ void BE_FASTCALL SIMD_8::Div(float *dst, const float constant, const float *src,
     }
 
     while (count > 0) {
-        *dst_ptr++ = constant + *src_ptr++;
+        *dst_ptr++ = constant / *src_ptr++;
         count--;
     }
 }
@@ -616,7 +616,7 @@ void BE_FASTCALL SIMD_8::Div(float *dst, const float *src0, const float *src1, c
     }
 
     while (count > 0) {
-        *dst_ptr++ = *src0_ptr++ + *src1_ptr++;
+        *dst_ptr++ = *src0_ptr++ / *src1_ptr++;
         count--;
     }
 }
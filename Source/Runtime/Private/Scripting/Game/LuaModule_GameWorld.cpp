@@ -38,6 +38,10 @@ void LuaVM::RegisterGameWorld(LuaCpp::Module &module) {
         "intersect_ray", static_cast<Entity*(GameWorld::*)(const Ray &, int)const>(&GameWorld::IntersectRay),
         "instantiate_entity", &GameWorld::InstantiateEntity,
         "instantiate_entity_with_transform", &GameWorld::InstantiateEntityWithTransform,
+        "set_entity_pool_size", &GameWorld::SetEntityPoolSize,
+        "spawn_pooled_entity", &GameWorld::SpawnPooledEntity,
+        "despawn_pooled_entity", &GameWorld::DespawnPooledEntity,
+        "list_entity_pools", &GameWorld::ListEntityPools,
         "dont_destroy_on_load", &GameWorld::DontDestroyOnLoad,
         "map_filename", &GameWorld::MapFilename,
         "restart_game", &GameWorld::RestartGame,
@@ -73,7 +73,8 @@ void Pcm::Free() {
 bool Pcm::Open(const char *filename) {
     Purge();
     
-    File *fp = fileSystem.OpenFile(filename, File::Mode::Read);
+    // Streamed sound reads small chunks, so the next block is read ahead in background.
+    File *fp = fileSystem.OpenFileReadBuffered(filename, true, FileBuffered::DefaultBufferSize, true);
     if (!fp) {
         return false;
     }
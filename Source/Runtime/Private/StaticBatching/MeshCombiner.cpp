@@ -13,17 +13,34 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/JobPool.h"
 #include "Render/Render.h"
+#include "IO/FileSystem.h"
+#include "Platform/PlatformFile.h"
+#include "Platform/PlatformSystem.h"
+#include "Asset/DerivedDataCache.h"
 #include "Game/Entity.h"
 #include "Components/ComTransform.h"
 #include "Components/ComStaticMeshRenderer.h"
 #include "MeshCombiner.h"
 #include "StaticBatching/StaticBatch.h"
+#include "Profiler/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
+// Increase this when the combined mesh data in the derived data cache is changed.
+static const int            CombinedMeshVersion = 1;
+
+// Combined meshes are optimized for the vertex cache and clustered for the cluster culling.
+static const int            CombinedMeshFinishFlags = Mesh::FinishFlag::OptimizeIndices | Mesh::FinishFlag::BuildClusters;
+
+static const int            MaxCombinedVerts = 65535;
+
 static int CompareMesh(const RenderObject::State *renderObjectDef1, const RenderObject::State *renderObjectDef2) {
     int compare = renderObjectDef1->flags - renderObjectDef2->flags;
+    if (compare == 0) {
+        compare = renderObjectDef1->layer - renderObjectDef2->layer;
+    }
     if (compare == 0) {
         int materialIndex1 = -1;
         int materialIndex2 = -1;
@@ -48,139 +65,225 @@ static int CompareMesh(const RenderObject::State *renderObjectDef1, const Render
     return compare;
 }
 
-void MeshCombiner::CombineHierarchy(const Hierarchy<Entity> &staticRoot) {
-    Entity *staticRootEntity = staticRoot.Owner();
-    if (staticRootEntity) {
-        // Skip if this entity has mesh component that is already combined with others
-        ComStaticMeshRenderer *meshRenderer = staticRootEntity->GetComponent<ComStaticMeshRenderer>();
-        if (meshRenderer) {
-            if (meshRenderer->staticBatchIndex >= 0) {
-                return;
-            }
+ComStaticMeshRenderer *MeshCombiner::GetCombinableMeshRenderer(const Entity *entity) {
+    if (!entity->GetStaticMask()) { // TODO: Check BatchingStatic
+        return nullptr;
+    }
+
+    ComStaticMeshRenderer *meshRenderer = entity->GetComponent<ComStaticMeshRenderer>();
+    if (!meshRenderer || !meshRenderer->referenceMesh) {
+        return nullptr;
+    }
+
+    if (meshRenderer->referenceMesh->NumSurfaces() > 1) {
+        return nullptr;
+    }
+
+    if (meshRenderer->renderObjectDef.materials.Count() > 1) {
+        return nullptr;
+    }
+
+    return meshRenderer;
+}
+
+void MeshCombiner::EnumerateCombinableMeshRenderers(const Hierarchy<Entity> &rootNode, Array<ComStaticMeshRenderer *> &meshRenderers) {
+    for (Entity *entity = rootNode.GetFirstChild(); entity; entity = entity->GetNode().GetNext()) {
+        ComStaticMeshRenderer *meshRenderer = GetCombinableMeshRenderer(entity);
+
+        // Skip if this mesh renderer is already combined with others.
+        if (meshRenderer && meshRenderer->staticBatchIndex < 0) {
+            meshRenderers.Append(meshRenderer);
         }
     }
+}
 
-    // Enumerate combinable entities
-    Array<Entity *> combinableEntities;
-    EnumerateCombinableEntities(staticRoot, combinableEntities);
+void MeshCombiner::CombineMeshRenderers(Array<ComStaticMeshRenderer *> &meshRenderers) {
+    BE_PROFILE_CPU_SCOPE_STATIC("MeshCombiner::CombineMeshRenderers");
 
-    if (combinableEntities.Count() <= 1) {
+    if (meshRenderers.Count() <= 1) {
         return;
     }
 
-    // Sort entities by material
-    combinableEntities.Sort([](Entity *e1, Entity *e2) -> bool {
-        const auto *renderable1 = e1->GetComponent<ComRenderable>();
-        const auto *renderable2 = e2->GetComponent<ComRenderable>();
+    struct CombinableMesh {
+        ComStaticMeshRenderer * meshRenderer;
+        uint64_t            cellKey;
+    };
 
-        int compare = 0;
+    Array<CombinableMesh> combinableMeshes;
+    combinableMeshes.SetCount(meshRenderers.Count());
 
-        if (renderable1 && renderable2) {
-            compare = CompareMesh(&renderable1->renderObjectDef, &renderable2->renderObjectDef);
-        }
+    for (int i = 0; i < meshRenderers.Count(); i++) {
+        combinableMeshes[i].meshRenderer = meshRenderers[i];
+        combinableMeshes[i].cellKey = StaticBatch::CellKey(meshRenderers[i]->GetEntity()->GetWorldAABBFast().Center());
+    }
 
-        return compare < 0;
+    // Sort mesh renderers by the render states, and then by the cells.
+    combinableMeshes.Sort([](const CombinableMesh &m1, const CombinableMesh &m2) -> bool {
+        int compare = CompareMesh(&m1.meshRenderer->renderObjectDef, &m2.meshRenderer->renderObjectDef);
+        if (compare != 0) {
+            return compare < 0;
+        }
+        return m1.cellKey < m2.cellKey;
     });
 
-    MakeCombiendMeshes(combinableEntities);
-}
-
-void MeshCombiner::MakeCombiendMeshes(const Array<Entity *> combinableEntities) {
-    Entity *combineRoot = nullptr;
-    const RenderObject::State *prevRenderObjectDef = nullptr;
-    const int maxCombinedVerts = 65535;
+    Array<CombineTask> tasks;
+    Array<ComStaticMeshRenderer *> batchMeshRenderers;
     int numCombinedVerts = 0;
-    int batchIndex = 0;
 
-    Array<ComStaticMeshRenderer *> meshRenderers;
+    for (int i = 0; i < combinableMeshes.Count(); i++) {
+        const CombinableMesh &combinableMesh = combinableMeshes[i];
 
-    for (int entityIndex = 0; entityIndex < combinableEntities.Count(); entityIndex++) {
-        Entity *entity = combinableEntities[entityIndex];
+        int numVerts = combinableMesh.meshRenderer->referenceMesh->GetSurface(0)->subMesh->NumVerts();
 
-        ComStaticMeshRenderer *meshRenderer = entity->GetComponent<ComStaticMeshRenderer>();
+        if (i > 0) {
+            const CombinableMesh &prevCombinableMesh = combinableMeshes[i - 1];
 
-        int numVerts = meshRenderer->referenceMesh->GetSurface(0)->subMesh->NumVerts();
+            if (CompareMesh(&prevCombinableMesh.meshRenderer->renderObjectDef, &combinableMesh.meshRenderer->renderObjectDef) != 0 ||
+                prevCombinableMesh.cellKey != combinableMesh.cellKey || numCombinedVerts + numVerts >= MaxCombinedVerts) {
+                if (batchMeshRenderers.Count() > 1) {
+                    MakeStaticBatch(batchMeshRenderers, prevCombinableMesh.cellKey, tasks);
+                }
 
-        const RenderObject::State *renderObjectDef = &meshRenderer->renderObjectDef;
+                batchMeshRenderers.SetCount(0, false);
 
-        if (!combineRoot) {
-            combineRoot = entity;
+                numCombinedVerts = 0;
+            }
         }
 
-        if ((prevRenderObjectDef && CompareMesh(prevRenderObjectDef, renderObjectDef) != 0) || numCombinedVerts + numVerts >= maxCombinedVerts) {
-            if (meshRenderers.Count() > 1) {
-                MakeCombinedMesh(combineRoot, meshRenderers, batchIndex++);
-            }
+        batchMeshRenderers.Append(combinableMesh.meshRenderer);
 
-            combineRoot = nullptr;
+        numCombinedVerts += numVerts;
+    }
 
-            meshRenderers.Clear();
+    if (batchMeshRenderers.Count() > 1) {
+        MakeStaticBatch(batchMeshRenderers, combinableMeshes.Last().cellKey, tasks);
+    }
 
-            numCombinedVerts = 0;
-        }
+    if (tasks.Count() == 0) {
+        return;
+    }
 
-        meshRenderers.Append(meshRenderer);
+    // Derived data keys hash all the vertices, so compute them in parallel too.
+    jobPool.Run(ComputeDerivedDataKeyTask, tasks);
 
-        numCombinedVerts += numVerts;
+    int numCachedMeshes = 0;
 
-        prevRenderObjectDef = renderObjectDef;
+    for (int i = 0; i < tasks.Count(); i++) {
+        if (derivedDataCache.Get(tasks[i].derivedDataKey, &tasks[i].cachedData, &tasks[i].cachedDataSize)) {
+            numCachedMeshes++;
+        }
     }
 
-    if (meshRenderers.Count() > 1) {
-        MakeCombinedMesh(combineRoot, meshRenderers, batchIndex);
+    jobPool.Run(CombineTaskFunc, tasks);
+
+    for (int i = 0; i < tasks.Count(); i++) {
+        CombineTask &task = tasks[i];
+
+        if (task.cachedData) {
+            fileSystem.FreeFile(task.cachedData);
+        }
+
+        if (!task.loaded) {
+            // bmesh is written to the temporary file to store it in the derived data cache.
+            Str tempFilename = PlatformSystem::UserTempDir();
+            tempFilename.AppendPath(task.derivedDataKey + ".bmesh");
+
+            task.mesh->Write(tempFilename);
+
+            void *data;
+            size_t size = fileSystem.LoadFile(tempFilename, false, &data);
+            if (data) {
+                derivedDataCache.Put(task.derivedDataKey, data, size);
+                fileSystem.FreeFile(data);
+            }
+
+            PlatformFile::RemoveFile(tempFilename);
+        }
+
+        StaticBatch *staticBatch = task.staticBatch;
+        staticBatch->SetMesh(task.mesh, staticBatch->meshRenderers[0]->renderObjectDef, task.origin);
+
+        // Combined mesh renderers are rendered by the static batch.
+        for (int meshRendererIndex = 0; meshRendererIndex < staticBatch->meshRenderers.Count(); meshRendererIndex++) {
+            staticBatch->meshRenderers[meshRendererIndex]->OnInactive();
+        }
+
+        staticBatch->UpdateVisuals();
     }
+
+    BE_LOG("%i static batches combined (%i cached)\n", tasks.Count(), numCachedMeshes);
 }
 
-void MeshCombiner::MakeCombinedMesh(Entity *staticBatchRoot, Array<ComStaticMeshRenderer *> &meshRenderers, int batchIndex) {
+void MeshCombiner::MakeStaticBatch(Array<ComStaticMeshRenderer *> &meshRenderers, uint64_t cellKey, Array<CombineTask> &tasks) {
     assert(meshRenderers.Count() > 1);
 
-    StaticBatch *staticBatch = StaticBatch::AllocStaticBatch(staticBatchRoot);
+    StaticBatch *staticBatch = StaticBatch::AllocStaticBatch(meshRenderers[0]->renderWorld, cellKey);
 
-    ALIGN_AS32 Mat3x4 worldToLocalMatrix = staticBatchRoot->GetTransform()->GetMatrix().Inverse();
+    AABB worldAABB;
+    worldAABB.Clear();
 
-    Array<BatchSubMesh> batchSubMeshes;
+    for (int i = 0; i < meshRenderers.Count(); i++) {
+        worldAABB.AddAABB(meshRenderers[i]->GetEntity()->GetWorldAABBFast());
+    }
+
+    CombineTask &task = tasks.Alloc();
+    task.staticBatch = staticBatch;
+    task.origin = worldAABB.Center();
+    task.mesh = meshManager.AllocMesh(va("Combined Mesh %i", staticBatch->GetIndex()));
+    task.cachedData = nullptr;
+    task.cachedDataSize = 0;
+    task.loaded = false;
 
     for (int i = 0; i < meshRenderers.Count(); i++) {
         ComStaticMeshRenderer *batchMesh = meshRenderers[i];
         batchMesh->staticBatchIndex = staticBatch->GetIndex();
 
+        staticBatch->meshRenderers.Append(batchMesh);
+
+        // Vertices are combined relative to the origin of the static batch.
         BatchSubMesh batchSubMesh;
         batchSubMesh.subMesh = batchMesh->referenceMesh->GetSurface(0)->subMesh;
-        batchSubMesh.localTransform = worldToLocalMatrix * batchMesh->GetEntity()->GetTransform()->GetMatrix();
+        batchSubMesh.localTransform = batchMesh->GetEntity()->GetTransform()->GetMatrix();
+        batchSubMesh.localTransform.SetTranslation(batchSubMesh.localTransform.ToTranslationVec3() - task.origin);
 
-        batchSubMeshes.Append(batchSubMesh);
+        task.batchSubMeshes.Append(batchSubMesh);
     }
+}
 
-    Str combinedMeshName = "Combined Mesh (" + staticBatchRoot->GetName() + ")";
-    if (batchIndex > 0) {
-        combinedMeshName += " " + Str(batchIndex + 1);
-    }
+void MeshCombiner::ComputeDerivedDataKeyTask(void *data) {
+    CombineTask *task = (CombineTask *)data;
 
-    Mesh *combinedMesh = meshManager.CreateCombinedMesh(combinedMeshName, batchSubMeshes);
-    staticBatch->SetMesh(combinedMesh);
-}
+    DerivedDataKeyBuilder keyBuilder;
+    keyBuilder.AppendString("CombinedMesh");
+    keyBuilder.AppendInt(CombinedMeshVersion);
+    keyBuilder.AppendInt(CombinedMeshFinishFlags);
+    keyBuilder.AppendInt(task->batchSubMeshes.Count());
 
-void MeshCombiner::EnumerateCombinableEntities(const Hierarchy<Entity> &rootNode, Array<Entity *> &staticChildren) {
-    for (Entity *entity = rootNode.GetFirstChild(); entity; entity = entity->GetNode().GetNext()) {
-        if (!entity->GetStaticMask()) { // TODO: Check BatchingStatic
-            continue;
-        }
+    for (int i = 0; i < task->batchSubMeshes.Count(); i++) {
+        const BatchSubMesh &batchSubMesh = task->batchSubMeshes[i];
+        const SubMesh *subMesh = batchSubMesh.subMesh;
 
-        ComStaticMeshRenderer *meshRenderer = entity->GetComponent<ComStaticMeshRenderer>();
-        if (!meshRenderer || !meshRenderer->referenceMesh) {
-            continue;
-        }
+        keyBuilder.AppendInt(subMesh->NumVerts());
+        keyBuilder.AppendInt(subMesh->NumIndexes());
+        keyBuilder.Append(subMesh->Verts(), sizeof(VertexGenericLit) * subMesh->NumVerts());
+        keyBuilder.Append(subMesh->Indexes(), sizeof(TriIndex) * subMesh->NumIndexes());
+        keyBuilder.Append(batchSubMesh.localTransform.Ptr(), sizeof(float) * 12);
+    }
 
-        if (meshRenderer->referenceMesh->NumSurfaces() > 1) {
-            continue;
-        }
+    task->derivedDataKey = keyBuilder.Finalize();
+}
 
-        if (meshRenderer->renderObjectDef.materials.Count() > 1) {
-            continue;
-        }
+void MeshCombiner::CombineTaskFunc(void *data) {
+    CombineTask *task = (CombineTask *)data;
 
-        staticChildren.Append(entity);
+    if (task->cachedData) {
+        task->loaded = task->mesh->LoadFromMemory(task->cachedData, task->cachedDataSize);
+        if (task->loaded) {
+            return;
+        }
     }
+
+    task->mesh->CombineSubMeshes(task->batchSubMeshes, CombinedMeshFinishFlags);
 }
 
 BE_NAMESPACE_END
@@ -14,19 +14,42 @@
 
 #pragma once
 
+#include "Core/Task.h"
+
 BE_NAMESPACE_BEGIN
 
 class ComStaticMeshRenderer;
 class Entity;
+class StaticBatch;
 
 class MeshCombiner {
 public:
-    static void CombineHierarchy(const Hierarchy<Entity> &staticRoot);
+                            /// Returns static mesh renderer of the entity if it can be combined with others.
+    static ComStaticMeshRenderer *GetCombinableMeshRenderer(const Entity *entity);
+
+                            /// Lists up combinable static mesh renderers of the children of the hierarchy root.
+    static void             EnumerateCombinableMeshRenderers(const Hierarchy<Entity> &rootNode, Array<ComStaticMeshRenderer *> &meshRenderers);
+
+                            /// Combines the mesh renderers with the same render states in each cell into the static batches.
+                            /// Mesh renderers should not be in any static batch.
+    static void             CombineMeshRenderers(Array<ComStaticMeshRenderer *> &meshRenderers);
 
 private:
-    static void EnumerateCombinableEntities(const Hierarchy<Entity> &parentNode, Array<Entity *> &staticChildren);
-    static void MakeCombiendMeshes(const Array<Entity *> combinableEntities);
-    static void MakeCombinedMesh(Entity *staticBatchRoot, Array<ComStaticMeshRenderer *> &meshRenderers, int batchIndex);
+    struct CombineTask {
+        StaticBatch *       staticBatch;
+        Mesh *              mesh;
+        Vec3                origin;
+        Array<BatchSubMesh> batchSubMeshes;
+        Str                 derivedDataKey;
+        void *              cachedData;         ///< bmesh data loaded from the derived data cache
+        size_t              cachedDataSize;
+        bool                loaded;             ///< Loaded from the cached data
+    };
+
+    static void             ComputeDerivedDataKeyTask(void *data);
+    static void             CombineTaskFunc(void *data);
+
+    static void             MakeStaticBatch(Array<ComStaticMeshRenderer *> &meshRenderers, uint64_t cellKey, Array<CombineTask> &tasks);
 };
 
 BE_NAMESPACE_END
@@ -14,6 +14,7 @@
 
 #include "Precompiled.h"
 #include "Containers/Hierarchy.h"
+#include "Core/CVars.h"
 #include "Render/Render.h"
 #include "Game/Entity.h"
 #include "Components/ComStaticMeshRenderer.h"
@@ -22,61 +23,214 @@
 
 BE_NAMESPACE_BEGIN
 
+static CVar                 staticBatch_cellSize("staticBatch_cellSize", "32", CVar::Flag::Float | CVar::Flag::Archive, "size of the cells in meters to combine static meshes, one cell for all if 0");
+
 Array<StaticBatch *> StaticBatch::staticBatches;
+HashMap<uint64_t, StaticBatch::Cell> StaticBatch::cells;
 
 StaticBatch::StaticBatch() {
     index = -1;
-    rootEntity = nullptr;
+    cellKey = 0;
     referenceMesh = nullptr;
+    renderWorld = nullptr;
+    renderObjectHandle = -1;
 }
 
 StaticBatch::~StaticBatch() {
+    if (renderObjectHandle != -1) {
+        renderWorld->RemoveRenderObject(renderObjectHandle);
+    }
+
+    for (int i = 0; i < renderObjectDef.materials.Count(); i++) {
+        materialManager.ReleaseMaterial(renderObjectDef.materials[i]);
+    }
+
+    if (renderObjectDef.mesh) {
+        meshManager.ReleaseMesh(renderObjectDef.mesh);
+    }
+
     if (referenceMesh) {
         meshManager.ReleaseMesh(referenceMesh, true);
     }
 }
 
-StaticBatch *StaticBatch::AllocStaticBatch(Entity *rootEntity) {
+StaticBatch *StaticBatch::AllocStaticBatch(RenderWorld *renderWorld, uint64_t cellKey) {
     StaticBatch *staticBatch = new StaticBatch;
-    staticBatch->index = staticBatches.Append(staticBatch);
-    staticBatch->rootEntity = rootEntity;
+    staticBatch->renderWorld = renderWorld;
+    staticBatch->cellKey = cellKey;
+
+    // Reuse the freed slot.
+    staticBatch->index = staticBatches.FindIndex(nullptr);
+    if (staticBatch->index >= 0) {
+        staticBatches[staticBatch->index] = staticBatch;
+    } else {
+        staticBatch->index = staticBatches.Append(staticBatch);
+    }
 
     return staticBatch;
 }
 
 void StaticBatch::DestroyStaticBatch(StaticBatch *staticBatch) {
-    staticBatches.Remove(staticBatch);
+    staticBatches[staticBatch->index] = nullptr;
 
     delete staticBatch;
 }
 
+void StaticBatch::SetMesh(Mesh *mesh, const RenderObject::State &templateDef, const Vec3 &origin) {
+    referenceMesh = mesh;
+
+    // Render states are the same for all the combined mesh renderers.
+    renderObjectDef.flags = templateDef.flags;
+    renderObjectDef.layer = templateDef.layer;
+    renderObjectDef.staticMask = templateDef.staticMask;
+    renderObjectDef.maxVisDist = templateDef.maxVisDist;
+    renderObjectDef.wireframeMode = templateDef.wireframeMode;
+    renderObjectDef.wireframeColor = templateDef.wireframeColor;
+    memcpy(renderObjectDef.materialParms, templateDef.materialParms, sizeof(renderObjectDef.materialParms));
+
+    renderObjectDef.materials.SetCount(templateDef.materials.Count());
+    for (int i = 0; i < templateDef.materials.Count(); i++) {
+        renderObjectDef.materials[i] = templateDef.materials[i];
+        renderObjectDef.materials[i]->AddRefCount();
+    }
+
+    // Vertices are combined relative to the origin to keep the precision.
+    renderObjectDef.worldMatrix = Mat3x4(Mat3::identity, origin);
+    renderObjectDef.aabb = mesh->GetAABB();
+    renderObjectDef.mesh = mesh->InstantiateMesh(Mesh::Type::Static);
+}
+
+void StaticBatch::UpdateVisuals() {
+    if (renderObjectHandle == -1) {
+        renderObjectHandle = renderWorld->AddRenderObject(&renderObjectDef);
+    } else {
+        renderWorld->UpdateRenderObject(renderObjectHandle, &renderObjectDef);
+    }
+}
+
+uint64_t StaticBatch::CellKey(const Vec3 &position) {
+    float cellSize = MeterToUnit(staticBatch_cellSize.GetFloat());
+    if (cellSize <= 0.0f) {
+        return 0;
+    }
+
+    // 21 bits for each axis.
+    uint64_t x = (uint64_t)((int)Math::Floor(position.x / cellSize) + (1 << 20)) & 0x1FFFFF;
+    uint64_t y = (uint64_t)((int)Math::Floor(position.y / cellSize) + (1 << 20)) & 0x1FFFFF;
+    uint64_t z = (uint64_t)((int)Math::Floor(position.z / cellSize) + (1 << 20)) & 0x1FFFFF;
+
+    return x | (y << 21) | (z << 42);
+}
+
 void StaticBatch::CombineAll(Hierarchy<Entity> &entityHierarchy) {
-    MeshCombiner::CombineHierarchy(entityHierarchy);
+    Array<ComStaticMeshRenderer *> meshRenderers;
+    MeshCombiner::EnumerateCombinableMeshRenderers(entityHierarchy, meshRenderers);
+
+    for (int i = 0; i < meshRenderers.Count(); i++) {
+        Cell &cell = cells[CellKey(meshRenderers[i]->GetEntity()->GetWorldAABBFast().Center())];
+        cell.meshRenderers.AddUnique(meshRenderers[i]);
+    }
+
+    MeshCombiner::CombineMeshRenderers(meshRenderers);
+}
+
+void StaticBatch::AddEntity(Entity *entity) {
+    ComStaticMeshRenderer *meshRenderer = MeshCombiner::GetCombinableMeshRenderer(entity);
+    if (!meshRenderer || meshRenderer->staticBatchIndex >= 0) {
+        return;
+    }
+
+    Cell &cell = cells[CellKey(entity->GetWorldAABBFast().Center())];
+    cell.meshRenderers.AddUnique(meshRenderer);
+    cell.dirty = true;
+}
+
+void StaticBatch::RemoveEntity(Entity *entity) {
+    if (cells.Count() == 0) {
+        return;
+    }
+
+    ComStaticMeshRenderer *meshRenderer = entity->GetComponent<ComStaticMeshRenderer>();
+    if (!meshRenderer) {
+        return;
+    }
+
+    uint64_t key;
+
+    StaticBatch *staticBatch = GetStaticBatchByIndex(meshRenderer->staticBatchIndex);
+    if (staticBatch) {
+        staticBatch->meshRenderers.Remove(meshRenderer);
+        meshRenderer->staticBatchIndex = -1;
 
-    for (const Entity *ent = entityHierarchy.GetFirstChild(); ent; ent = ent->GetNode().GetNext()) {
-        ComStaticMeshRenderer *staticMeshRenderer = ent->GetComponent<ComStaticMeshRenderer>();
-        
-        if (staticMeshRenderer && staticMeshRenderer->staticBatchIndex >= 0) {
-            staticMeshRenderer->OnInactive();
+        key = staticBatch->cellKey;
+    } else {
+        key = CellKey(entity->GetWorldAABBFast().Center());
+    }
 
-            const StaticBatch *staticBatch = StaticBatch::GetStaticBatchByIndex(staticMeshRenderer->staticBatchIndex);
+    auto *entry = cells.Get(key);
+    if (entry && entry->second.meshRenderers.Remove(meshRenderer)) {
+        entry->second.dirty = true;
+    }
+}
 
-            if (staticBatch->GetRootEntity() == ent) {
-                if (staticMeshRenderer->renderObjectDef.mesh) {
-                    meshManager.ReleaseMesh(staticMeshRenderer->renderObjectDef.mesh);
+void StaticBatch::UpdateDirtyCells() {
+    Array<ComStaticMeshRenderer *> meshRenderers;
 
-                    staticMeshRenderer->renderObjectDef.mesh = staticBatch->GetMesh()->InstantiateMesh(Mesh::Type::Static);
-                    staticMeshRenderer->renderObjectDef.aabb = staticBatch->GetMesh()->GetAABB();
+    for (int cellIndex = 0; cellIndex < cells.Count(); cellIndex++) {
+        auto *entry = cells.GetByIndex(cellIndex);
+        if (!entry->second.dirty) {
+            continue;
+        }
 
-                    staticMeshRenderer->UpdateVisuals();
+        // Destroy the static batches of the dirty cell. Mesh renderers are shown again after combining if they are not combined.
+        for (int batchIndex = 0; batchIndex < staticBatches.Count(); batchIndex++) {
+            StaticBatch *staticBatch = staticBatches[batchIndex];
+
+            if (staticBatch && staticBatch->cellKey == entry->first) {
+                for (int i = 0; i < staticBatch->meshRenderers.Count(); i++) {
+                    staticBatch->meshRenderers[i]->staticBatchIndex = -1;
                 }
+                DestroyStaticBatch(staticBatch);
             }
         }
+
+        for (int i = 0; i < entry->second.meshRenderers.Count(); i++) {
+            meshRenderers.Append(entry->second.meshRenderers[i]);
+        }
+
+        entry->second.dirty = false;
+    }
+
+    if (meshRenderers.Count() == 0) {
+        return;
+    }
+
+    MeshCombiner::CombineMeshRenderers(meshRenderers);
+
+    for (int i = 0; i < meshRenderers.Count(); i++) {
+        if (meshRenderers[i]->staticBatchIndex < 0) {
+            meshRenderers[i]->UpdateVisuals();
+        }
     }
 }
 
 void StaticBatch::ClearAllStaticBatches() {
-    staticBatches.DeleteContents(false);
+    for (int batchIndex = 0; batchIndex < staticBatches.Count(); batchIndex++) {
+        StaticBatch *staticBatch = staticBatches[batchIndex];
+        if (!staticBatch) {
+            continue;
+        }
+
+        for (int i = 0; i < staticBatch->meshRenderers.Count(); i++) {
+            ComStaticMeshRenderer *meshRenderer = staticBatch->meshRenderers[i];
+            meshRenderer->staticBatchIndex = -1;
+            meshRenderer->UpdateVisuals();
+        }
+    }
+
+    staticBatches.DeleteContents(true);
+
+    cells.Clear();
 }
 
 StaticBatch *StaticBatch::GetStaticBatchByIndex(int index) {
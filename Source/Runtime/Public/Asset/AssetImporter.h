@@ -36,6 +36,21 @@ public:
     virtual Str             GetResourceFilename() const = 0;
 
     virtual void            Import() = 0;
+
+                            /// Version of the converter used by Import(). Increase it when the cooked output changes
+                            /// to invalidate the derived data cache.
+    virtual int             GetConverterVersion() const { return 1; }
+
+                            /// Returns the directory which Import() writes the cooked files to.
+                            /// Empty if the asset is not cooked.
+    virtual Str             GetCookedDirectory() const;
+
+                            /// Returns derived data cache key of the source bytes, importer settings and converter version.
+    Str                     GetDerivedDataKey() const;
+
+                            /// Restores the cooked files from the derived data cache, or imports and stores them to the cache.
+                            /// The cooked directory is emptied first. Returns true if restored from the cache.
+    bool                    ImportCached();
     
     virtual void            ApplyChanged();
 
@@ -45,6 +60,9 @@ public:
 
 protected:
     Asset *                 asset;
+
+private:
+    static void             ClearCookedDirectory(const char *cookedDir);
 };
 
 BE_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,105 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Derived data cache
+
+    Content addressed cache of the cooked asset data. Keys are MD5 hashes of
+    all the inputs of the cooking (source bytes, importer settings and
+    converter version), so the same inputs map to the same cached data on
+    any project and any machine sharing the cache directory.
+
+    Cached data are written to a temporary file and renamed into place, so
+    concurrent writers never expose a partially written entry.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Core/Str.h"
+#include "Core/Checksum_MD5.h"
+
+BE_NAMESPACE_BEGIN
+
+class CmdArgs;
+
+/// Builds a derived data cache key by hashing the inputs.
+class BE_API DerivedDataKeyBuilder {
+public:
+    DerivedDataKeyBuilder();
+
+    void                    Append(const void *data, size_t size);
+                            /// Appends string including the null terminator to separate it from the next input.
+    void                    AppendString(const char *string);
+    void                    AppendInt(int value);
+                            /// Appends contents of the file. Returns false if the file can't be read.
+    bool                    AppendFile(const char *filename);
+
+                            /// Returns the key as 32 hex digits.
+    Str                     Finalize();
+
+private:
+    MD5_CTX                 ctx;
+};
+
+class BE_API DerivedDataCache {
+public:
+    void                    Init();
+    void                    Shutdown();
+
+                            /// Returns the absolute path of the cache directory.
+    const char *            GetCacheDir() const { return cacheDir; }
+
+                            /// Returns true if the key is in the cache. Doesn't update statistics.
+    bool                    Exists(const char *key) const;
+
+                            /// Loads cached data of the key. The data must be freed by fileSystem.FreeFile().
+                            /// Returns false if the key is not in the cache.
+    bool                    Get(const char *key, void **data, size_t *size);
+                            /// Stores data for the key.
+    bool                    Put(const char *key, const void *data, size_t size);
+
+                            /// Restores all the files cached for the key into the directory.
+    bool                    GetDirectory(const char *key, const char *dstDir);
+                            /// Stores all the files in the directory for the key.
+    bool                    PutDirectory(const char *key, const char *srcDir);
+
+    int                     NumHits() const { return numHits; }
+    int                     NumMisses() const { return numMisses; }
+    float                   HitRate() const;
+
+    void                    ResetStats();
+    void                    PrintStats() const;
+
+private:
+    Str                     GetCachedFilename(const char *key) const;
+    bool                    WriteCachedFile(const char *key, const Array<const void *> &chunks, const Array<size_t> &chunkSizes);
+
+    static void             Cmd_DDCStats(const CmdArgs &args);
+
+    Str                     cacheDir;
+    std::atomic<int>        numHits = { 0 };
+    std::atomic<int>        numMisses = { 0 };
+    std::atomic<int>        numPuts = { 0 };
+    std::atomic<int64_t>    bytesRead = { 0 };
+    std::atomic<int64_t>    bytesWritten = { 0 };
+};
+
+extern DerivedDataCache     derivedDataCache;
+
+BE_NAMESPACE_END
@@ -22,6 +22,7 @@
 // Common
 #include "Core/Checksum_CRC32.h"
 #include "Core/Checksum_MD5.h"
+#include "Core/Compression_LZ4.h"
 #include "Core/BinSearch.h"
 #include "Core/Range.h"
 #include "Core/Heap.h"
@@ -79,8 +80,13 @@
 
 // IO
 #include "IO/File.h"
+#include "IO/AsyncIO.h"
 #include "IO/FileSystem.h"
 #include "IO/ZipArchiver.h"
+#include "IO/PackageReader.h"
+#include "IO/ZipReader.h"
+#include "IO/PakArchiver.h"
+#include "IO/PakReader.h"
 
 // Utils
 #include "Core/ByteOrder.h"
@@ -91,6 +97,7 @@
 #include "Core/CVars.h"
 #include "Core/Cmds.h"
 #include "Core/Task.h"
+#include "Core/JobPool.h"
 #include "Core/Vertex.h"
 #include "Core/JointPose.h"
 
@@ -100,11 +107,17 @@
 #include "Core/SignalObject.h"
 #include "Core/Property.h"
 #include "Core/Object.h"
+#include "Core/BinaryArchive.h"
 
 // Image
 #include "Image/Image.h"
 #include "Image/DxtEncoder.h"
 #include "Image/DxtDecoder.h"
+#include "Image/BptcEncoder.h"
+#include "Image/BptcDecoder.h"
+#include "Image/AstcEncoder.h"
+#include "Image/AstcDecoder.h"
+#include "Image/EnvCubePrefilter.h"
 
 // Sound
 #include "Sound/Pcm.h"
@@ -138,6 +151,7 @@
 // Asset
 #include "Asset/Asset.h"
 #include "Asset/AssetImporter.h"
+#include "Asset/DerivedDataCache.h"
 #include "Asset/Resource.h"
 #include "Asset/GuidMapper.h"
 
@@ -191,6 +205,7 @@
 
 // GameWorld
 #include "Game/Entity.h"
+#include "Game/EntityCloneTemplate.h"
 #include "Game/Prefab.h"
 #include "Game/MapRenderSettings.h"
 #include "Game/GameWorld.h"
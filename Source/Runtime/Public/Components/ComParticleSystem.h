@@ -16,6 +16,7 @@
 
 #include "ComRenderable.h"
 #include "Render/ParticleSystem.h"
+#include "Render/ParticleSimulator.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -47,8 +48,12 @@ public:
     virtual void            DrawGizmos(const RenderCamera *camera, bool selected, bool selectedByParent) override;
 #endif
 
+                            /// Generates particles and records the stage jobs which are simulated by the game world after updating the entities.
     void                    UpdateSimulation(int currentTime);
 
+                            /// Simulates the stage jobs of the particle systems at once, and updates their render objects.
+    static void             SimulateParticleSystems(const Array<ComParticleSystem *> &particleSystems);
+
     bool                    IsAlive() const;
 
     void                    Play();
@@ -70,10 +75,9 @@ protected:
     virtual void            UpdateVisuals() override;
     void                    ChangeParticleSystem(const Guid &particleSystemGuid);
     void                    InitializeParticle(Particle *particle, const ParticleSystem::Stage *stage, float inCycleFraction) const;
-    void                    ProcessTrail(Particle *particle, const ParticleSystem::Stage *stage, int genTimeDelta);
-    void                    ComputeTrailPositionFromCustomPath(const ParticleSystem::CustomPathModule &customPathModule, const Particle *particle, float t, Particle::Trail *trail) const;
     void                    ParticleSystemReloaded();
     void                    TransformUpdated(const ComTransform *transform);
+    void                    CancelSimulation();
 
     bool                    playOnAwake;
     Asset *                 particleSystemAsset;
@@ -81,6 +85,11 @@ protected:
     int                     currentTime;
     int                     stopTime;
 
+    Array<ParticleSimulator::StageJob> stageJobs;       ///< Simulation jobs of the stages which have alive particles
+    GameWorld *             simulatingWorld;            ///< Game world which simulates the stage jobs in this frame
+    Array<int>              aliveParticles;             ///< Indexes of the alive particles of all stages
+    Array<int>              particleAges;               ///< Ages of the alive particles in milliseconds
+
 #if WITH_EDITOR
     RenderObject::State     spriteDef;
     int                     spriteHandle;
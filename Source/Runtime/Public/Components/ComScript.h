@@ -38,6 +38,12 @@ public:
 
                             /// Deserialize from JSON value.
     virtual void            Deserialize(const Json::Value &in) override;
+                            /// Deserialize from cooked binary object. Script properties are resolved by name.
+    virtual void            Deserialize(const BinaryObject &in) override;
+
+                            /// Copies property values from the other script component. Script properties are copied through
+                            /// the property info list of this component after the script is loaded.
+    virtual void            CopyProperties(const Serializable *other, const Array<PropertyInfo> &propertyInfoList, const HashTable<Guid, Guid> &guidMap) override;
 
     virtual void            Purge(bool chainPurge = true) override;
 
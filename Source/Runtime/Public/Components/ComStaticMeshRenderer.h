@@ -36,8 +36,18 @@ public:
     bool                    IsOccluder() const;
     void                    SetOccluder(bool occluder);
 
+                            /// Returns number of the LOD transitions.
+    int                     GetLODScreenSizeCount() const;
+                            /// Sets number of the LOD transitions. LODs are generated if the mesh has no LODs.
+    void                    SetLODScreenSizeCount(int count);
+                            /// Returns projected screen height in ratio below which the given LOD switches to the next coarser LOD.
+    float                   GetLODScreenSize(int index) const;
+    void                    SetLODScreenSize(int index, float screenSize);
+
 protected:
     virtual void            MeshUpdated() override;
+
+    void                    GenerateMeshLODs();
 };
 
 BE_NAMESPACE_END
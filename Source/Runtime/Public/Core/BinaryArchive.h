@@ -0,0 +1,213 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Binary archive
+
+    Compact binary form of serializable objects cooked from JSON values.
+    Property tables of each class are resolved to indices at cook time,
+    strings and GUIDs are interned in the shared tables, and loading reads
+    the memory mapped file directly without building an intermediate DOM.
+
+    File layout:
+
+    Header
+    String table    numStrings x uint32 offsets, null-terminated strings
+    GUID table      numGuids x 16 bytes
+    Class table     per class: nameIndex, numProperties, numProperties x PropertyDesc
+    Records         object records and int32 values in the written order
+
+    Object record:
+
+    classIndex (uint16), numValues (uint16), guidIndex (int32), size of values (uint32)
+    numValues x { propertyIndex (uint16), [numElements (uint32) if array], payload }
+
+    Str and Guid payloads are indices to the string and GUID tables.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Containers/StrArray.h"
+#include "Containers/HashIndex.h"
+#include "Containers/HashTable.h"
+#include "Core/Guid.h"
+#include "Core/Variant.h"
+#include "Core/Property.h"
+
+namespace Json {
+    class Value;
+}
+
+BE_NAMESPACE_BEGIN
+
+class MetaObject;
+class File;
+class BinaryArchive;
+
+struct BinaryArchiveHeader {
+    static const uint32_t   Magic = ('V' << 24) | ('R' << 16) | ('A' << 8) | 'B';
+    static const int32_t    Version = 1;
+
+    uint32_t                magic;
+    int32_t                 version;
+    int32_t                 userVersion;        ///< Version of the cooked contents (e.g. map version)
+    uint32_t                numStrings;
+    uint32_t                stringDataSize;
+    uint32_t                numGuids;
+    uint32_t                numClasses;
+    uint32_t                classTableSize;
+    uint32_t                recordsSize;
+};
+
+/// Read-only view of the object record in the binary archive.
+/// Valid until the next BinaryArchive::ReadObject() call with the same object.
+class BE_API BinaryObject {
+    friend class BinaryArchive;
+
+public:
+                            /// Returns class name of the object.
+    const char *            GetClassName() const;
+                            /// Returns meta object of the class, nullptr if the class is unknown in runtime.
+    const MetaObject *      GetMetaObject() const;
+                            /// Returns GUID of the object.
+    Guid                    GetGuid() const;
+
+                            /// Returns runtime property info list of the class. Resolved once per class in the archive.
+    const Array<PropertyInfo> &GetPropertyInfoList() const;
+
+                            /// Finds cooked value index of the runtime property. Returns -1 if the object has no value for it.
+                            /// propertyIndex is valid for the property info list which begins with GetPropertyInfoList().
+    int                     FindValue(const PropertyInfo &propertyInfo, int propertyIndex) const;
+                            /// Finds cooked value index by property name. Returns -1 if not found.
+    int                     FindValue(const char *name) const;
+
+                            /// Returns element count of the cooked array value.
+    int                     GetValueArrayCount(int valueIndex) const;
+                            /// Gets cooked value converted to the given type. Returns false if not convertible.
+    bool                    GetValue(int valueIndex, int elementIndex, Variant::Type::Enum type, Variant &out) const;
+
+private:
+    const BinaryArchive *   archive = nullptr;
+    int                     classIndex = -1;
+    int                     guidIndex = -1;
+    Array<const byte *>     values;             ///< Value pointers indexed by cooked property index
+};
+
+/// Memory mapped binary archive reader.
+class BE_API BinaryArchive {
+    friend class BinaryObject;
+
+public:
+    BinaryArchive() = default;
+    ~BinaryArchive();
+
+                            /// Opens binary archive file. Returns false if the file is not a binary archive.
+    bool                    Open(const char *filename);
+                            /// Closes binary archive file.
+    void                    Close();
+
+                            /// Tests if the file is a binary archive by checking the magic.
+    static bool             IsBinaryArchive(const char *filename);
+
+                            /// Returns version of the cooked contents.
+    int                     GetUserVersion() const { return header.userVersion; }
+
+                            /// Returns true if all records are read.
+    bool                    IsEOF() const { return readPtr >= recordsEnd; }
+
+                            /// Reads int32 value.
+    int32_t                 ReadInt32();
+                            /// Reads next object record. Returns false if the record is malformed.
+    bool                    ReadObject(BinaryObject &object);
+
+    const char *            GetString(int index) const;
+    Guid                    GetGuid(int index) const;
+
+private:
+    struct ClassEntry {
+        const char *        name;
+        const MetaObject *  metaObject;
+        const byte *        properties;
+        int                 numProperties;
+        bool                resolved;
+        Array<PropertyInfo> propertyInfos;      ///< Runtime property info list of the class
+        Array<int>          propertyToValue;    ///< Runtime property index to cooked property index
+    };
+
+    bool                    Parse();
+    const ClassEntry &      ResolveClass(int classIndex) const;
+    void                    GetPropertyDesc(const ClassEntry &classEntry, int propertyIndex, int &nameIndex, int &type, int &flags) const;
+
+    BinaryArchiveHeader     header;
+    void *                  fileMapping = nullptr;
+    File *                  mappedFile = nullptr;   ///< File which has the whole data in memory (e.g. stored zip entry)
+    byte *                  fileData = nullptr;
+    const byte *            data = nullptr;
+    size_t                  size = 0;
+    const byte *            stringOffsets = nullptr;
+    const char *            stringData = nullptr;
+    const byte *            guidTable = nullptr;
+    const byte *            recordsEnd = nullptr;
+    const byte *            readPtr = nullptr;
+    mutable Array<ClassEntry> classes;
+};
+
+/// Cooks JSON values of serializable objects into a binary archive.
+class BE_API BinaryArchiveWriter {
+public:
+                            /// Writes int32 value.
+    void                    WriteInt32(int32_t value);
+                            /// Cooks JSON value of the serializable object which has "classname" member into an object record.
+                            /// Members not found in the class properties (e.g. script fields) are cooked as dynamic properties
+                            /// with the JSON value type, and resolved by name at load time.
+    bool                    WriteObject(const Json::Value &objectValue);
+
+                            /// Writes all the tables and records to the file.
+    bool                    Save(const char *filename, int userVersion) const;
+
+private:
+    struct PropertyDesc {
+        int                 nameIndex;
+        Variant::Type::Enum type;
+        int                 flags;
+    };
+
+    struct ClassDesc {
+        int                 nameIndex;
+        Array<PropertyInfo> propertyInfos;      ///< Cooked static properties
+        Array<PropertyDesc> properties;         ///< Static properties followed by dynamic properties
+    };
+
+    int                     InternString(const char *string);
+    int                     InternGuid(const Guid &guid);
+    int                     FindClass(const char *classname);
+    int                     FindDynamicProperty(ClassDesc &classDesc, const char *name, Variant::Type::Enum type, bool isArray);
+
+    void                    WriteBytes(const void *data, size_t size);
+    void                    WriteVariant(const Variant &value);
+
+    Array<byte>             records;
+    StrArray                strings;
+    HashIndex               stringHash;
+    Array<Guid>             guids;
+    HashTable<Guid, int>    guidToIndex;
+    Array<ClassDesc>        classes;
+};
+
+BE_NAMESPACE_END
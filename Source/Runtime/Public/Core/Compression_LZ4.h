@@ -0,0 +1,37 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Compresses a block of data in the LZ4 block format.
+
+    Favors decoding speed over ratio. Decoded size must be known by the
+    caller, and the decoder never writes outside of the destination.
+
+-------------------------------------------------------------------------------
+*/
+
+BE_NAMESPACE_BEGIN
+
+/// Returns the maximum compressed size of the given source size.
+int BE_API LZ4_CompressBound(int srcSize);
+/// Returns compressed size, or 0 if the destination is not enough.
+int BE_API LZ4_CompressBlock(const void *src, int srcSize, void *dst, int dstCapacity);
+/// Returns decompressed size, or -1 if the source is malformed.
+int BE_API LZ4_DecompressBlock(const void *src, int srcSize, void *dst, int dstCapacity);
+
+BE_NAMESPACE_END
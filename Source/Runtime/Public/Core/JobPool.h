@@ -0,0 +1,68 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Job pool
+
+    Task threads shared by the engine subsystems for the fork-join jobs, so
+    that each subsystem doesn't create it's own threads. Number of threads is
+    taken from the jobPool_threads cvar, and threads are recreated when it is
+    changed. Jobs submitted while the pool is busy with the jobs of another
+    thread, or from the job itself, are run in the calling thread.
+
+-------------------------------------------------------------------------------
+*/
+
+#include <atomic>
+#include "Core/Task.h"
+
+BE_NAMESPACE_BEGIN
+
+class BE_API JobPool {
+public:
+    static constexpr int    MaxJobs = 256;
+
+    JobPool() = default;
+    ~JobPool();
+
+                            /// Frees job threads.
+    void                    Shutdown();
+
+                            /// Runs function for each of numJobs elements of jobSize bytes in the jobs array, and waits until all the jobs are done.
+                            /// Jobs are run in the calling thread if there is no job thread, just one job, or the pool is busy.
+    void                    Run(TaskFunc function, void *jobs, int jobSize, int numJobs);
+
+                            /// Runs function for each element of the jobs array.
+    template <typename T>
+    void                    Run(TaskFunc function, Array<T> &jobs) { Run(function, jobs.Ptr(), sizeof(T), jobs.Count()); }
+
+private:
+    void                    UpdateThreads();
+
+    int                     numThreads = 0;
+    TaskManager *           taskManager = nullptr;
+    std::atomic<bool>       busy = { false };
+};
+
+BE_INLINE JobPool::~JobPool() {
+    Shutdown();
+}
+
+extern JobPool              jobPool;
+
+BE_NAMESPACE_END
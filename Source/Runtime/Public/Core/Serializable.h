@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "Containers/HashTable.h"
 #include "Variant.h"
 #include "Signal.h"
 
@@ -24,6 +25,7 @@ namespace Json {
 BE_NAMESPACE_BEGIN
 
 class PropertyInfo;
+class BinaryObject;
 
 /// Interface for objects with automatic serialization through properties.
 class BE_API Serializable : public SignalObject {
@@ -39,6 +41,8 @@ public:
     virtual void            Serialize(Json::Value &out, bool forCopying = false) const;
                             /// Deserialize from JSON value.
     virtual void            Deserialize(const Json::Value &in);
+                            /// Deserialize from cooked binary object.
+    virtual void            Deserialize(const BinaryObject &in);
 
                             /// Returns a property default value by name. Returns empty variant if not found.
     Variant                 GetPropertyDefault(const char *name) const;
@@ -87,6 +91,18 @@ public:
                             /// Sets property array count by property info. This function is valid only if property is an array.
     void                    SetPropertyArrayCount(const PropertyInfo &propertyInfo, int numElements);
 
+                            /// Copies property values in the given property info list from the other object of the same class without serialization.
+                            /// GUID values found in guidMap are remapped. ReadOnly and SkipSerialization properties are not copied.
+    virtual void            CopyProperties(const Serializable *other, const Array<PropertyInfo> &propertyInfoList, const HashTable<Guid, Guid> &guidMap);
+
+protected:
+                            /// Copies a property value from the other object. Each property info describes the same property of each object.
+    void                    CopyProperty(const Serializable *other, const PropertyInfo &srcPropertyInfo, const PropertyInfo &dstPropertyInfo, const HashTable<Guid, Guid> &guidMap);
+                            /// Deserialize properties in the given property info list from cooked binary object.
+                            /// The list must begin with the class property info list of the binary object.
+    void                    DeserializeProperties(const BinaryObject &in, const Array<PropertyInfo> &propertyInfoList);
+
+public:
     static const SignalDef  SIG_PropertyChanged;            ///< A signal emitted when a property value changed.
     static const SignalDef  SIG_PropertyArrayCountChanged;  ///< A signal emitted when a property array count changed.
     static const SignalDef  SIG_PropertyInfoUpdated;        ///< A signal emitted when property info list updated.
@@ -387,6 +387,83 @@ BE_INLINE void VertexGenericLit::Transform(const Mat3 &rotation, const Vec3 &sca
     SetTangent(matrix.ToMat3() * GetTangent());
 }
 
+/*
+-------------------------------------------------------------------------------
+
+    VertexGenericLitCompact : compact vertex of VertexGenericLit for the static vertex buffer
+
+-------------------------------------------------------------------------------
+*/
+
+struct BE_API VertexGenericLitCompact {
+    int16_t         xyz[4];                 ///< Snorm16 position in the sub mesh AABB, w holds the bitangent sign
+    float16_t       st[2];
+    byte            color[4];
+    int8_t          normal[2];              ///< Snorm8 octahedral normal
+    int8_t          tangent[2];             ///< Snorm8 octahedral tangent
+
+                    /// Encodes VertexGenericLit. Decoded position is xyz * decodeScale + decodeBias.
+    void            Encode(const VertexGenericLit &v, const Vec3 &decodeScale, const Vec3 &decodeBias);
+
+                    /// Returns position decoding scale and bias to quantize the positions in the given bounds.
+    static void     GetDecodeScaleBias(const AABB &bounds, Vec3 &decodeScale, Vec3 &decodeBias);
+};
+
+// Maps the unit vector to the octahedron, and unfolds the lower hemisphere to the corners of the square.
+BE_INLINE void EncodeOctahedralNormal(const Vec3 &n, int8_t *out) {
+    float l1 = Math::Fabs(n.x) + Math::Fabs(n.y) + Math::Fabs(n.z);
+    float invL1 = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+    float x = n.x * invL1;
+    float y = n.y * invL1;
+
+    if (n.z < 0.0f) {
+        float ox = x;
+        x = (1.0f - Math::Fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - Math::Fabs(ox)) * (y >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    out[0] = ClampChar(Math::Ftoi(Math::Round(x * 127.0f)));
+    out[1] = ClampChar(Math::Ftoi(Math::Round(y * 127.0f)));
+}
+
+BE_INLINE const Vec3 DecodeOctahedralNormal(const int8_t *in) {
+    Vec3 n(Max(in[0] / 127.0f, -1.0f), Max(in[1] / 127.0f, -1.0f), 0.0f);
+    n.z = 1.0f - Math::Fabs(n.x) - Math::Fabs(n.y);
+
+    float t = Max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    n.Normalize();
+    return n;
+}
+
+BE_INLINE void VertexGenericLitCompact::GetDecodeScaleBias(const AABB &bounds, Vec3 &decodeScale, Vec3 &decodeBias) {
+    decodeBias = bounds.Center();
+    decodeScale = bounds[1] - decodeBias;
+
+    // Avoid division by zero for the flat bounds.
+    for (int i = 0; i < 3; i++) {
+        if (decodeScale[i] < FLT_EPSILON) {
+            decodeScale[i] = FLT_EPSILON;
+        }
+    }
+}
+
+BE_INLINE void VertexGenericLitCompact::Encode(const VertexGenericLit &v, const Vec3 &decodeScale, const Vec3 &decodeBias) {
+    for (int i = 0; i < 3; i++) {
+        float f = (v.xyz[i] - decodeBias[i]) / decodeScale[i];
+        xyz[i] = ClampShort(Math::Ftoi(Math::Round(f * 32767.0f)));
+    }
+    xyz[3] = v.GetBiTangentSign() < 0.0f ? -32767 : 32767;
+
+    st[0] = v.st[0];
+    st[1] = v.st[1];
+    *reinterpret_cast<uint32_t *>(color) = v.GetColor();
+
+    EncodeOctahedralNormal(v.GetNormal(), normal);
+    EncodeOctahedralNormal(v.GetTangent(), tangent);
+}
+
 /*
 -------------------------------------------------------------------------------
 
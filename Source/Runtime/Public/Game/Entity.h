@@ -34,6 +34,9 @@ class ComTransform;
 class ComRectTransform;
 class GameWorld;
 class Prefab;
+class BinaryArchive;
+class BinaryObject;
+class EntityCloneTemplate;
 class Entity;
 
 using EntityPtr = Entity*;
@@ -44,6 +47,7 @@ class Entity : public Object {
     friend class GameWorld;
     friend class Prefab;
     friend class Component;
+    friend class EntityCloneTemplate;
 
 public:
     struct WorldPosTrait {
@@ -219,6 +223,8 @@ public:
     virtual void                Serialize(Json::Value &data, bool forCopying = false) const override;
                                 /// Deserializes entity from JSON value.
     virtual void                Deserialize(const Json::Value &data) override;
+                                /// Deserializes entity from cooked binary object and reads the following component records in binary archive.
+    void                        Deserialize(const BinaryObject &entityObject, BinaryArchive &archive);
                                 /// Serializes given entity hierarchy to JSON value.
     static void                 SerializeHierarchy(const Entity *entity, Json::Value &entitiesValue, bool forCopying = false);
 
@@ -253,6 +259,8 @@ public:
 
                                 /// Creates an entity by JSON text.
     static Entity *             CreateEntity(Json::Value &data, GameWorld *gameWorld = nullptr, int sceneIndex = 0);
+                                /// Creates an entity by cooked binary object.
+    static Entity *             CreateEntity(const BinaryObject &entityObject, BinaryArchive &archive, GameWorld *gameWorld = nullptr, int sceneIndex = 0);
 
                                 /// Makes copy of JSON value of an entity and then replace each GUIDs of entity/components to the new ones.
     static Json::Value          CloneEntityValue(const Json::Value &entityValue, HashTable<Guid, Guid> &oldToNewGuidMap);
@@ -319,6 +327,8 @@ protected:
     int                         sceneNum = -1;
 
     ComponentPtrArray           components;         ///< 0'th component is always transform component
+
+    mutable EntityCloneTemplate *cloneTemplate = nullptr;   ///< Cached clone template of the prefab entity
 };
 
 template <typename T>
@@ -0,0 +1,83 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Entity clone template
+
+    Keeps the hierarchy layout and the property info lists of the source
+    entities, so that cloning copies property values directly from the
+    source objects without serializing them to JSON. Prefab entities keep
+    the template to instantiate them repeatedly, and to reset the pooled
+    instances to the prefab. Property infos of the script components are
+    not cached since they change with the script.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Containers/HashTable.h"
+#include "Core/Property.h"
+
+BE_NAMESPACE_BEGIN
+
+class Object;
+class MetaObject;
+class Entity;
+class GameWorld;
+
+class EntityCloneTemplate {
+public:
+                                /// Builds the template from the source entity and it's children.
+    void                        Init(const Entity *rootEntity);
+                                /// Clears the template.
+    void                        Clear();
+
+                                /// Returns true if the template matches with the current hierarchy of the source entity.
+    bool                        IsValid(const Entity *rootEntity) const;
+
+                                /// Creates clones of the source entities with new GUIDs. GUID references between the source objects are remapped to the cloned ones.
+                                /// Cloned entities are initialized but not registered to the game world. Returns the cloned root entity.
+    Entity *                    Clone(GameWorld *gameWorld, int sceneNum) const;
+
+                                /// Copies component properties of the source entities to the entities cloned before, which keep the hierarchy and the components of the template.
+                                /// GUID references between the source objects are remapped to the cloned ones. Returns false if the cloned entities don't match with the template.
+    bool                        ResetProperties(Entity *rootEntity) const;
+
+private:
+    struct ObjectEntry {
+        const Object *          source;
+        const MetaObject *      metaObject;         ///< Class of the source object to detect the address reuse by the other class
+        bool                    scriptProperties;   ///< Property infos are fetched at clone time because script properties might be reloaded
+        Array<PropertyInfo>     propertyInfos;
+    };
+
+    struct EntityEntry {
+        ObjectEntry             entity;
+        int                     firstComponent;
+        int                     numComponents;
+    };
+
+    void                        AddEntity(const Entity *entity);
+    bool                        MatchEntity(const Entity *entity, int &entityIndex) const;
+    bool                        MatchClonedEntity(Entity *entity, int &entityIndex, Array<Entity *> &clonedEntities, HashTable<Guid, Guid> &guidMap) const;
+
+    Array<EntityEntry>          entities;           ///< Source entities in hierarchy order
+    Array<ObjectEntry>          components;
+};
+
+BE_NAMESPACE_END
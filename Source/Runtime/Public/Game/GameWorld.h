@@ -38,13 +38,26 @@ class MapRenderSettings;
 class PlayerSettings;
 class GameWorld;
 class ComCamera;
+class BinaryArchive;
 class ComCanvas;
+class ComParticleSystem;
 
 class GameScene {
 public:
     Hierarchy<Entity>           root;
 };
 
+/// Parked instances of the prefab entity to be reused on the next spawn.
+class EntityPool {
+public:
+    Guid                        prefabGuid;         ///< GUID of the prefab source entity
+    int                         poolSize = 0;       ///< Maximum number of parked entities
+    EntityPtrArray              parkedEntities;
+    int                         numHits = 0;        ///< Number of spawns reusing the parked entity
+    int                         numMisses = 0;      ///< Number of spawns creating the new entity
+    int                         numOverflows = 0;   ///< Number of despawns destroying the entity because the pool is full
+};
+
 class GameWorld : public Object {
 public:
     static constexpr int MaxScenes = 16;
@@ -167,9 +180,33 @@ public:
     Entity *                    InstantiateEntity(const Entity *originalEntity);
     Entity *                    InstantiateEntityWithTransform(const Entity *originalEntity, const Vec3 &origin, const Quat &rotation);
 
+                                /// Sets the maximum number of parked instances of the prefab entity.
+    void                        SetEntityPoolSize(const Entity *prefabEntity, int poolSize);
+                                /// Returns the pool of the prefab entity. Returns nullptr if the pool size is not set.
+    const EntityPool *          GetEntityPool(const Entity *prefabEntity) const;
+                                /// Instantiates the prefab entity with transform. Reuses the parked instance in the pool if exists.
+                                /// Reused entity is reactivated with only transforms and active states reset to the prefab.
+    Entity *                    SpawnPooledEntity(const Entity *prefabEntity, const Vec3 &origin, const Quat &rotation);
+                                /// Deactivates and parks the entity instantiated from the prefab entity in the pool.
+                                /// Components keep their render objects, physics bodies and sounds while parked.
+                                /// The entity is destroyed if the prefab has no pool or the pool is full.
+    void                        DespawnPooledEntity(Entity *entity);
+                                /// Destroys all the parked entities. Pool sizes and statistics are kept.
+    void                        ClearEntityPools();
+                                /// Prints statistics of all the entity pools.
+    void                        ListEntityPools() const;
+
+                                /// Adds the particle system which is simulated with the others after updating the entities in this frame.
+    void                        AddUpdatedParticleSystem(ComParticleSystem *particleSystem) { updatedParticleSystems.AddUnique(particleSystem); }
+                                /// Removes the particle system added in this frame.
+    void                        RemoveUpdatedParticleSystem(ComParticleSystem *particleSystem) { updatedParticleSystems.Remove(particleSystem); }
+
     Entity *                    SpawnEntityFromJson(Json::Value &entityValue, int sceneIndex = 0);
     void                        SpawnEntitiesFromJson(Json::Value &entitiesValue, int sceneIndex = 0);
 
+    Entity *                    SpawnEntityFromBinary(BinaryArchive &archive, int sceneIndex = 0);
+    void                        SpawnEntitiesFromBinary(BinaryArchive &archive, int sceneIndex = 0);
+
     void                        SaveSnapshot();
     void                        RestoreSnapshot();
 
@@ -178,6 +215,9 @@ public:
     void                        NewMap();
     bool                        LoadMap(const char *filename, LoadSceneMode::Enum mode);
     void                        SaveMap(const char *filename);
+
+                                /// Cooks JSON map file into binary map file. LoadMap() loads either of them.
+    static bool                 CookMap(const char *filename, const char *binaryFilename);
     
     bool                        IsGameStarted() const { return gameStarted; }
 
@@ -207,10 +247,16 @@ private:
     void                        BeginMapLoading();
     void                        FinishMapLoading();
     Entity *                    CloneEntity(const Entity *originalEntity);
+    static const EntityCloneTemplate *GetPrefabCloneTemplate(const Entity *prefabEntity);
+    void                        LinkEntity(Entity *ent, int entityIndex);
+    void                        UnlinkEntity(Entity *ent);
+    EntityPool *                FindEntityPool(const Guid &prefabGuid);
+    void                        DestroyParkedEntity(Entity *entity);
     void                        FixedUpdateEntities(float timeStep);
     void                        FixedLateUpdateEntities(float timeStep);
     void                        UpdateEntities();
     void                        LateUpdateEntities();
+    void                        SimulateParticleSystems();
     void                        UpdateLuaVM();
 
     void                        ListUpActiveCameraComponents(StaticArray<ComCamera *, 16> &cameraComponents) const;
@@ -223,6 +269,10 @@ private:
 
     GameScene                   scenes[MaxScenes];
 
+    Array<EntityPool>           entityPools;
+
+    Array<ComParticleSystem *>  updatedParticleSystems; ///< Particle systems to be simulated in this frame
+
     Json::Value                 snapshotValues;
 
     Random                      random;
@@ -0,0 +1,191 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Asynchronous file I/O
+
+    Read requests are queued by priority and served by a fixed number of
+    I/O threads, which bounds the number of reads in flight. Files are
+    opened through the file system, so requests work the same way for
+    the real files and the entries of the mounted zip/pak packages.
+
+    Pending requests reading the same file with adjacent or overlapping
+    ranges are coalesced into a single read.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Core/Str.h"
+#include "Platform/PlatformThread.h"
+
+BE_NAMESPACE_BEGIN
+
+class File;
+class AsyncIOQueue;
+class AsyncReadRequest;
+
+struct AsyncIOPriority {
+    enum Enum {
+        Low,
+        Normal,
+        High,
+        Critical,
+        Count
+    };
+};
+
+using AsyncReadCallback = void (*)(AsyncReadRequest *request, void *userData);
+
+/// Handle of the asynchronous read request. Must be released by Release() after use.
+class BE_API AsyncReadRequest {
+    friend class AsyncIOQueue;
+
+public:
+    struct Status {
+        enum Enum {
+            Pending,
+            Reading,
+            Completed,
+            Failed,
+            Canceled
+        };
+    };
+
+                            /// Returns the request file name.
+    const char *            GetFileName() const { return filename; }
+
+                            /// Returns status of the request.
+    Status::Enum            GetStatus() const { return (Status::Enum)status.load(); }
+
+                            /// Returns true if the request is completed, failed or canceled, and the callback is returned.
+    bool                    IsDone() const { return done; }
+
+                            /// Returns the read data. Valid until Release().
+    const byte *            GetData() const { return buffer; }
+
+                            /// Returns number of bytes read.
+    size_t                  GetSize() const { return bytesRead; }
+
+                            /// Cancels the request if it is not read yet.
+                            /// Returns false if the read is already started or finished.
+    bool                    Cancel();
+
+                            /// Waits until the request is done.
+                            /// Returns immediately if called in the callback of this request.
+    void                    Wait();
+
+                            /// Releases the request and the buffer allocated by the queue.
+                            /// Pending request is canceled, and reading request is waited to be done.
+                            /// If called in the callback of this request, it is released after the callback returns.
+    void                    Release();
+
+private:
+    AsyncReadRequest() = default;
+
+    AsyncIOQueue *          queue = nullptr;
+    Str                     filename;
+    size_t                  offset = 0;
+    size_t                  size = 0;           ///< Requested size, 0 for reading to the end of file
+    byte *                  buffer = nullptr;
+    bool                    ownsBuffer = false;
+    size_t                  bytesRead = 0;
+    AsyncIOPriority::Enum   priority = AsyncIOPriority::Normal;
+    AsyncReadCallback       callback = nullptr;
+    void *                  userData = nullptr;
+    std::atomic<int>        status = { Status::Pending };
+    std::atomic<bool>       done = { false };
+    std::atomic<uint64_t>   callbackThreadId = { 0 };   ///< Thread running the callback, 0 if the callback is not running
+    bool                    releasing = false;          ///< Release() is in progress out of the callback
+    bool                    releasedInCallback = false; ///< Release() is called in the callback
+};
+
+class BE_API AsyncIOQueue {
+    friend class AsyncReadRequest;
+
+public:
+    static const int        DefaultMaxReadsInFlight = 4;
+                            /// Maximum size of the coalesced read
+    static const size_t     MaxCoalescedSize = 1024 * 1024;
+                            /// Maximum gap between the ranges to be coalesced
+    static const size_t     MaxCoalescedGap = 64 * 1024;
+
+    AsyncIOQueue() = default;
+    ~AsyncIOQueue();
+
+                            /// Starts I/O threads. maxReadsInFlight is the number of I/O threads.
+    void                    Init(int maxReadsInFlight = DefaultMaxReadsInFlight);
+                            /// Cancels all the pending requests and stops I/O threads.
+    void                    Shutdown();
+
+                            /// Queues a read request of size bytes at offset of the file.
+                            /// If size is 0, reads to the end of file. If buffer is nullptr, the queue allocates the buffer.
+                            /// The callback is called on the I/O thread when the request is done, or on the
+                            /// calling thread of Cancel(). Returns nullptr if the queue is not running.
+    AsyncReadRequest *      ReadAsync(const char *filename, size_t offset, size_t size, void *buffer = nullptr,
+                                AsyncIOPriority::Enum priority = AsyncIOPriority::Normal, AsyncReadCallback callback = nullptr, void *userData = nullptr);
+
+                            /// Waits until all the requests are done.
+    void                    WaitIdle();
+
+                            /// Returns number of pending requests.
+    int                     NumPendingRequests() const;
+
+                            /// Returns number of physical reads. Less than the number of requests if some are coalesced.
+    int                     NumReads() const { return numReads; }
+
+private:
+    struct Batch {
+        Array<AsyncReadRequest *> requests;
+        size_t              start;
+        size_t              end;
+    };
+
+    struct Worker {
+        AsyncIOQueue *      queue;
+        PlatformThread *    thread;
+        Str                 openedFileName;     ///< Last opened file kept open for the sequential requests
+        File *              openedFile;
+        Array<byte>         coalesceBuffer;
+    };
+
+    bool                    CancelRequest(AsyncReadRequest *request);
+    void                    WaitRequest(AsyncReadRequest *request);
+    void                    ReleaseRequest(AsyncReadRequest *request);
+
+    bool                    PopBatch(Batch &batch);
+    void                    ProcessBatch(Worker *worker, Batch &batch);
+    void                    FinishRequest(AsyncReadRequest *request, AsyncReadRequest::Status::Enum status);
+    void                    FreeRequest(AsyncReadRequest *request);
+    File *                  OpenFile(Worker *worker, const char *filename);
+
+    static void             IOThreadProc(void *param);
+
+    Array<AsyncReadRequest *> pendingRequests[AsyncIOPriority::Count];
+    int                     numActiveRequests = 0;
+    std::atomic<int>        numReads = { 0 };
+    bool                    running = false;
+
+    Array<Worker *>         workers;
+
+    PlatformMutex *         mutex = nullptr;
+    PlatformCondition *     requestCondition = nullptr;     ///< Signaled when a request is queued
+    PlatformCondition *     doneCondition = nullptr;        ///< Broadcasted when a request is done
+};
+
+BE_NAMESPACE_END
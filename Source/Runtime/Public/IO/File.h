@@ -18,6 +18,7 @@
 
 BE_NAMESPACE_BEGIN
 
+class AsyncReadRequest;
 class Guid;
 class Object;
 
@@ -53,6 +54,9 @@ public:
                             /// Writes data from the buffer to the file.
     virtual bool            Write(const void *buffer, size_t bytesToWrite) = 0;
 
+                            /// Returns whole file data in memory if it can be read without copy, otherwise nullptr.
+    virtual const void *    GetMappedData() const { return nullptr; }
+
                             /// Formatted output to file.
     virtual bool            Printf(const char *format, ...);
                             /// Formatted output to file in wide characters.
@@ -73,6 +77,13 @@ public:
     size_t                  ReadGuid(Guid &guid);
     size_t                  ReadObject(Object &object);
 
+                            /// Reads an array of values in a single read.
+    size_t                  ReadInt16Array(int16_t *values, int count);
+    size_t                  ReadUInt16Array(uint16_t *values, int count);
+    size_t                  ReadInt32Array(int32_t *values, int count);
+    size_t                  ReadUInt32Array(uint32_t *values, int count);
+    size_t                  ReadFloatArray(float *values, int count);
+
     size_t                  WriteBool(const bool value);
     size_t                  WriteChar(const char value);
     size_t                  WriteUChar(const unsigned char value);
@@ -124,7 +135,11 @@ class BE_API FileInZip : public File {
     friend class FileSystem;
     
 public:
-    FileInZip(const char *filename, void *pointer);
+                            /// Reads the entry data at dataOffset in the archive file with its own file handle.
+                            /// compressionMethod is either stored (0) or deflated (8).
+    FileInZip(const char *filename, PlatformFile *pf, size_t dataOffset, size_t compressedSize, size_t uncompressedSize, int compressionMethod);
+                            /// Reads the entry data in the memory mapped archive.
+    FileInZip(const char *filename, const byte *mappedData, size_t compressedSize, size_t uncompressedSize, int compressionMethod);
     virtual ~FileInZip();
     
     virtual const char *    GetFilePath() const override { return filename; }
@@ -135,6 +150,7 @@ public:
                             /// Returns offset in file.
     virtual int             Tell() const override;
                             /// Seeks from the start on a file.
+                            /// Seeking in the deflated entry restarts inflating from the nearest checkpoint before the offset.
     virtual int             Seek(int64_t offset) override;
                             /// Seeks from the end on a file.
     virtual int             SeekFromEnd(int64_t offset) override;
@@ -144,11 +160,83 @@ public:
 
                             /// Writes data from the buffer to the file.
     virtual bool            Write(const void *buffer, size_t bytesToWrite) override;
+
+                            /// Returns the entry data if it is stored in the memory mapped archive.
+    virtual const void *    GetMappedData() const override;
     
 protected:
+    static const size_t     InputBufferSize = 16 * 1024;
+    static const size_t     CheckpointInterval = 256 * 1024;
+
+    struct Checkpoint {
+        size_t              outPos;             ///< Uncompressed offset
+        size_t              inPos;              ///< Compressed offset consumed
+        void *              stream;             ///< Copy of the inflate stream
+    };
+
+    size_t                  Inflate(void *buffer, size_t bytesToRead) const;
+    void                    ResetInflate() const;
+
+    void                    InitInflate();
+
     char                    filename[MaxAbsolutePath];
-    void *                  pointer;
+    PlatformFile *          pf = nullptr;
+    const byte *            mappedData = nullptr;
+    size_t                  dataOffset = 0;
+    size_t                  compressedSize;
     size_t                  size;
+    int                     compressionMethod;
+    mutable size_t          pos = 0;            ///< Uncompressed offset
+    mutable size_t          inPos = 0;          ///< Compressed offset fed to the inflate stream
+    mutable void *          stream = nullptr;   ///< Inflate stream of the deflated entry
+    mutable byte *          inBuffer = nullptr;
+    mutable Array<Checkpoint> checkpoints;
+};
+
+/// Read-only file which reads the source file in large blocks.
+/// Small reads are served from the buffer, and the next block can be read ahead by the asynchronous I/O queue of the file system.
+class BE_API FileBuffered : public File {
+public:
+    static const size_t     DefaultBufferSize = 64 * 1024;
+
+                            /// Takes ownership of the source file.
+    FileBuffered(File *file, size_t bufferSize = DefaultBufferSize, bool readAhead = false);
+    virtual ~FileBuffered();
+
+    virtual const char *    GetFilePath() const override { return file->GetFilePath(); }
+
+                            /// Returns size of a file.
+    virtual size_t          Size() const override { return file->Size(); }
+
+                            /// Returns offset in file.
+    virtual int             Tell() const override { return (int)(bufferStart + bufferPos); }
+                            /// Seeks from the start on a file. Seeking inside the buffer doesn't touch the source file.
+    virtual int             Seek(int64_t offset) override;
+                            /// Seeks from the end on a file.
+    virtual int             SeekFromEnd(int64_t offset) override;
+
+                            /// Reads data from the file to the buffer.
+    virtual size_t          Read(void *buffer, size_t bytesToRead) const override;
+
+                            /// Writes data from the buffer to the file.
+    virtual bool            Write(const void *buffer, size_t bytesToWrite) override;
+
+protected:
+    bool                    FillBuffer() const;
+    void                    RequestReadAhead() const;
+
+    File *                  file;
+    size_t                  bufferSize;
+    byte *                  buffers[2];
+    mutable int             currentBuffer = 0;
+    mutable size_t          bufferStart = 0;    ///< File offset of the current buffer
+    mutable size_t          bufferLength = 0;
+    mutable size_t          bufferPos = 0;
+    mutable size_t          filePos = 0;        ///< File offset of the source file
+
+    bool                    readAhead;
+    mutable AsyncReadRequest *readAheadRequest = nullptr;  ///< Read of the next block into the back buffer
+    mutable size_t          readAheadStart = 0;
 };
 
 BE_NAMESPACE_END
@@ -24,11 +24,12 @@
 
 #include "Core/Dict.h"
 #include "IO/File.h"
+#include "IO/AsyncIO.h"
 
 BE_NAMESPACE_BEGIN
 
 class CmdArgs;
-struct ZipArchive;
+struct PackageArchive;
 
 struct ProgressCallback {
     virtual void        SetText(const char *text) = 0;
@@ -95,12 +96,19 @@ public:
         
     File *              OpenFile(const char *filename, File::Mode::Enum mode, bool searchDirs = true);
     File *              OpenFileRead(const char *filename, bool useSearchPath, size_t *fileSize = nullptr);
+    File *              OpenFileReadBuffered(const char *filename, bool useSearchPath, size_t bufferSize = FileBuffered::DefaultBufferSize, bool readAhead = false);
     File *              OpenFileWrite(const char *filename);
     File *              OpenFileAppend(const char *filename);
     void                CloseFile(File *f);
 
     size_t              LoadFile(const char *filename, bool searchDirs, void **buffer);
     void                FreeFile(void *buffer) const;
+
+                        /// Queues asynchronous read of the file. See AsyncIOQueue::ReadAsync().
+    AsyncReadRequest *  ReadAsync(const char *filename, size_t offset, size_t size, void *buffer = nullptr, 
+                            AsyncIOPriority::Enum priority = AsyncIOPriority::Normal, AsyncReadCallback callback = nullptr, void *userData = nullptr) { 
+                            return asyncIO.ReadAsync(filename, offset, size, buffer, priority, callback, userData); }
+    AsyncIOQueue &      GetAsyncIOQueue() { return asyncIO; }
     
     void                WriteFile(const char *filename, const void *buffer, int size);
 
@@ -115,15 +123,16 @@ public:
 private:
     struct SearchPath {
         char *          pathname;
-        ZipArchive *    archive;
+        PackageArchive *archive;
         SearchPath *    next;
     };
 
     SearchPath *        searchPath;
+    AsyncIOQueue        asyncIO;
     
     void                ClearSearchPath();
     void                AddSearchPath(const char *path);
-    void                AddSearchPath_ZIP(const char *path, const char *filename);
+    void                AddSearchPath_Package(const char *path, const char *filename);
     
     static void         Cmd_Dir(const CmdArgs &args);
     static void         Cmd_Path(const CmdArgs &args);
@@ -0,0 +1,43 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+BE_NAMESPACE_BEGIN
+
+class File;
+
+/// Read-only package of files mounted as a search path of the file system.
+/// Entry index is immutable after Open(), so entries can be opened from any thread.
+class BE_API PackageReader {
+public:
+    virtual ~PackageReader() {}
+
+                            /// Opens package file. filename is the path that PlatformFile can open.
+    virtual bool            Open(const char *filename) = 0;
+                            /// Closes package file. Files opened from the package must be closed before.
+    virtual void            Close() = 0;
+
+    virtual int             NumEntries() const = 0;
+    virtual const char *    GetEntryName(int index) const = 0;
+    virtual size_t          GetEntrySize(int index) const = 0;
+
+                            /// Finds entry index by name case-insensitively. Returns -1 if not found.
+    virtual int             FindEntry(const char *name) const = 0;
+
+                            /// Opens entry for reading. Safe to call from any thread.
+    virtual File *          OpenEntry(int index, const char *filename) const = 0;
+};
+
+BE_NAMESPACE_END
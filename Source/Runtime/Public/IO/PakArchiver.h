@@ -0,0 +1,72 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Containers/Array.h"
+#include "IO/PakReader.h"
+
+BE_NAMESPACE_BEGIN
+
+struct ProgressCallback;
+
+class BE_API PakArchiver {
+public:
+    PakArchiver();
+    PakArchiver(const char *filename);
+    ~PakArchiver();
+
+    bool            Open(const char *filename);
+                    /// Writes the tables and closes the pak file.
+    bool            Close();
+
+    bool            AddFile(const char *filename, PakCodec::Enum codec = PakCodec::LZ4);
+                    /// Adds data as an entry. contentHash is computed if it is not given.
+    bool            AddData(const char *name, const void *data, size_t size, PakCodec::Enum codec, const uint8_t *contentHash = nullptr);
+
+                    /// Archives files in the directory. If basePakFilename is given, files which have the same contents
+                    /// in the base pak are skipped to make a patch pak.
+    static bool     Archive(const char *pakFilename, const char *archiveDirectory, const char *filter, PakCodec::Enum codec = PakCodec::LZ4,
+                        const char *baseDir = "", const char *basePakFilename = nullptr, ProgressCallback *progress = nullptr);
+
+    static void     ComputeContentHash(const void *data, size_t size, uint8_t digest[16]);
+
+private:
+    bool            WriteBytes(const void *data, size_t size);
+    bool            WritePadding(uint32_t alignment);
+
+    File *          file;
+    uint64_t        writeOffset;
+    Array<PakEntry> entries;
+    Array<uint32_t> blockSizes;
+    Array<char>     names;
+    Array<byte>     compressBuffer;
+};
+
+BE_INLINE PakArchiver::PakArchiver() {
+    file = nullptr;
+    writeOffset = 0;
+}
+
+BE_INLINE PakArchiver::PakArchiver(const char *filename) {
+    file = nullptr;
+    writeOffset = 0;
+    Open(filename);
+}
+
+BE_INLINE PakArchiver::~PakArchiver() {
+    Close();
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,184 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Pak package reader
+
+    File layout:
+
+    Header
+    Entry data      each entry aligned to DataAlignment for memory mapping
+    Block table     numBlocks x uint32 compressed block sizes
+    Entry table     numEntries x PakEntry sorted by path hash
+    Name table      null-terminated entry names
+
+    Compressed entries are split into BlockSize blocks which are compressed
+    independently, so any offset can be read by decoding a single block.
+    A block whose compressed size equals its original size is stored as is.
+    Entries stored without compression are read from the mapped memory
+    without copy.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "IO/File.h"
+#include "IO/PackageReader.h"
+
+BE_NAMESPACE_BEGIN
+
+class PlatformBaseFile;
+class PlatformBaseFileMapping;
+
+struct PakCodec {
+    enum Enum {
+        None,
+        LZ4,                        ///< Fast decoding
+        Deflate                     ///< Smaller size
+    };
+};
+
+struct PakHeader {
+    static const uint32_t   Magic = ('K' << 24) | ('A' << 16) | ('P' << 8) | 'B';
+    static const int32_t    Version = 1;
+    static const uint32_t   BlockSize = 64 * 1024;
+    static const uint32_t   DataAlignment = 4096;
+
+    uint32_t                magic;
+    int32_t                 version;
+    uint32_t                numEntries;
+    uint32_t                numBlocks;
+    uint64_t                blockTableOffset;
+    uint64_t                entryTableOffset;
+    uint64_t                nameTableOffset;
+    uint32_t                nameTableSize;
+    uint32_t                reserved;
+};
+
+struct PakEntry {
+    uint32_t                pathHash;           ///< PakReader::HashPath() of the name
+    uint32_t                nameOffset;         ///< Offset in the name table
+    uint64_t                dataOffset;
+    uint64_t                size;               ///< Uncompressed size
+    uint64_t                compressedSize;
+    uint32_t                firstBlock;         ///< First index in the block table
+    uint8_t                 codec;              ///< PakCodec::Enum
+    uint8_t                 reserved[3];
+    uint8_t                 contentHash[16];    ///< MD5 digest of the uncompressed data
+};
+
+class BE_API PakReader : public PackageReader {
+public:
+    PakReader();
+    virtual ~PakReader();
+
+    virtual bool            Open(const char *filename) override;
+    virtual void            Close() override;
+
+    const char *            GetFilename() const { return filename; }
+
+    bool                    IsMapped() const { return mapping != nullptr; }
+
+    virtual int             NumEntries() const override { return entries.Count(); }
+    virtual const char *    GetEntryName(int index) const override { return &names[entries[index].nameOffset]; }
+    virtual size_t          GetEntrySize(int index) const override { return (size_t)entries[index].size; }
+    const PakEntry &        GetEntry(int index) const { return entries[index]; }
+                            /// Returns MD5 digest of the entry contents. Same digests mean same contents between paks.
+    const uint8_t *         GetEntryContentHash(int index) const { return entries[index].contentHash; }
+
+    virtual int             FindEntry(const char *name) const override;
+
+    virtual File *          OpenEntry(int index, const char *filename) const override;
+
+                            /// Decodes the block of the entry to the output buffer of BlockSize bytes.
+                            /// pf is used to read the block when the pak is not mapped. scratch must be BlockSize bytes.
+                            /// Returns decoded size, 0 on failure.
+    size_t                  ReadBlock(PlatformBaseFile *pf, int entryIndex, int blockIndex, byte *scratch, byte *out) const;
+
+                            /// Reads raw data of the entry stored without compression.
+    size_t                  ReadStored(PlatformBaseFile *pf, int entryIndex, size_t offset, size_t size, void *buffer) const;
+
+                            /// Returns pointer to the raw data in the mapped pak, nullptr if not mapped.
+    const byte *            GetMappedData(size_t offset) const;
+
+                            /// Returns case-insensitive hash of the path.
+    static uint32_t         HashPath(const char *path);
+
+private:
+    bool                    ReadBytes(PlatformBaseFile *pf, uint64_t offset, size_t size, void *buffer) const;
+
+    char                    filename[MaxAbsolutePath];
+    uint64_t                fileSize = 0;
+    PlatformBaseFileMapping *mapping = nullptr;
+    Array<PakEntry>         entries;
+    Array<uint32_t>         blockSizes;
+    Array<uint64_t>         blockOffsets;       ///< File offsets of the blocks
+    Array<char>             names;
+};
+
+BE_INLINE PakReader::PakReader() {
+    filename[0] = '\0';
+}
+
+BE_INLINE PakReader::~PakReader() {
+    Close();
+}
+
+/// Read-only file of the pak entry.
+class BE_API FileInPak : public File {
+public:
+                            /// pf is the own file handle of the pak, nullptr if the pak is mapped.
+    FileInPak(const char *filename, const PakReader *pak, int entryIndex, PlatformFile *pf);
+    virtual ~FileInPak();
+
+    virtual const char *    GetFilePath() const override { return filename; }
+
+                            /// Returns size of a file.
+    virtual size_t          Size() const override { return size; }
+
+                            /// Returns offset in file.
+    virtual int             Tell() const override { return (int)pos; }
+                            /// Seeks from the start on a file. Seeking doesn't decode anything until the next read.
+    virtual int             Seek(int64_t offset) override;
+                            /// Seeks from the end on a file.
+    virtual int             SeekFromEnd(int64_t offset) override;
+
+                            /// Reads data from the file to the buffer.
+    virtual size_t          Read(void *buffer, size_t bytesToRead) const override;
+
+                            /// Writes data from the buffer to the file.
+    virtual bool            Write(const void *buffer, size_t bytesToWrite) override;
+
+                            /// Returns the entry data if it is stored without compression in the mapped pak.
+    virtual const void *    GetMappedData() const override;
+
+protected:
+    char                    filename[MaxAbsolutePath];
+    const PakReader *       pak;
+    int                     entryIndex;
+    PlatformFile *          pf;
+    size_t                  size;
+    bool                    compressed;
+    mutable size_t          pos = 0;
+    mutable int             cachedBlock = -1;   ///< Block index decoded in the block buffer
+    mutable size_t          cachedBlockSize = 0;
+    byte *                  blockBuffer = nullptr;
+    byte *                  scratchBuffer = nullptr;
+};
+
+BE_NAMESPACE_END
@@ -0,0 +1,92 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Zip package reader
+
+    Central directory is parsed into a flat entry index when the package is
+    mounted, including the data offset of each entry. Opening an entry does
+    not touch any shared state, so entries can be opened and read from many
+    threads at once. The package is memory mapped if possible, then stored
+    entries are read without copy and deflated entries are inflated from
+    the mapped memory directly.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Containers/HashIndex.h"
+#include "IO/PackageReader.h"
+
+BE_NAMESPACE_BEGIN
+
+class PlatformBaseFile;
+class PlatformBaseFileMapping;
+
+class BE_API ZipReader : public PackageReader {
+public:
+    struct Entry {
+        int                 nameOffset;         ///< Offset in the name buffer
+        int                 compressionMethod;  ///< 0: stored, 8: deflated
+        bool                encrypted;
+        size_t              dataOffset;         ///< Offset of the entry data in the package file
+        size_t              compressedSize;
+        size_t              uncompressedSize;
+    };
+
+    ZipReader();
+    virtual ~ZipReader();
+
+                            /// Opens zip package and reads the central directory.
+    virtual bool            Open(const char *filename) override;
+    virtual void            Close() override;
+
+    const char *            GetFilename() const { return filename; }
+
+    bool                    IsMapped() const { return mapping != nullptr; }
+
+    virtual int             NumEntries() const override { return entries.Count(); }
+    virtual const char *    GetEntryName(int index) const override { return &names[entries[index].nameOffset]; }
+    virtual size_t          GetEntrySize(int index) const override { return entries[index].uncompressedSize; }
+    const Entry &           GetEntry(int index) const { return entries[index]; }
+
+    virtual int             FindEntry(const char *name) const override;
+
+    virtual File *          OpenEntry(int index, const char *filename) const override;
+
+private:
+    bool                    ReadBytes(PlatformBaseFile *pf, size_t offset, size_t size, void *buffer) const;
+    bool                    ReadCentralDirectory(PlatformBaseFile *pf);
+
+    char                    filename[MaxAbsolutePath];
+    size_t                  fileSize = 0;
+    PlatformBaseFileMapping *mapping = nullptr;
+    Array<Entry>            entries;
+    Array<char>             names;
+    HashIndex               entryHash;
+};
+
+BE_INLINE ZipReader::ZipReader() {
+    filename[0] = '\0';
+}
+
+BE_INLINE ZipReader::~ZipReader() {
+    Close();
+}
+
+BE_NAMESPACE_END
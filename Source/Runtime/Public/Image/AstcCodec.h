@@ -0,0 +1,111 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+BE_NAMESPACE_BEGIN
+
+// ASTC: Adaptive scalable texture compression  - 128 bits block with the footprint from 4x4 to 12x12 texels
+//
+// Color endpoints and weights are stored with integer sequence encoding (ISE) which packs
+// values in bits, trits or quints. Weights are stored in a grid which can be smaller than
+// the block footprint and are bilinearly infilled.
+
+class BE_API ASTCCodec {
+public:
+    static const int        BlockSize = 16;
+    static const int        MaxTexels = 144;
+    static const int        MaxWeights = 64;
+    static const int        MaxColorValues = 18;
+
+    enum Quant {
+        Quant2, Quant3, Quant4, Quant5, Quant6, Quant8, Quant10, Quant12, Quant16, Quant20, Quant24, Quant32,
+        Quant40, Quant48, Quant64, Quant80, Quant96, Quant128, Quant160, Quant192, Quant256,
+        NumQuants
+    };
+
+    struct BlockMode {
+        int                 gridWidth;
+        int                 gridHeight;
+        bool                dualPlane;
+        int                 weightQuant;
+        int                 weightBits;         ///< Number of bits of the weight ISE
+    };
+
+                            /// Returns number of levels of the quantization method.
+    static int              QuantLevels(int quant);
+                            /// Returns number of bits to store the count values in ISE.
+    static int              ISEBitCount(int count, int quant);
+                            /// Returns the finest quantization method of color values fitting in the given bits. Returns -1 if none.
+    static int              ColorQuantForBits(int count, int bits);
+
+                            /// Decodes 11 bits 2D block mode. Returns false if the block mode is reserved or invalid.
+    static bool             DecodeBlockMode(int blockModeValue, BlockMode &mode);
+
+                            /// Unquantizes ISE color value to [0, 255].
+    static int              UnquantizeColor(int value, int quant);
+                            /// Unquantizes ISE weight value to [0, 64].
+    static int              UnquantizeWeight(int value, int quant);
+
+                            /// Returns partition index of the texel using the partition hash function.
+    static int              SelectPartition(int seed, int x, int y, int z, int partitionCount, bool smallBlock);
+
+                            /// Computes 4 grid indices and weights (sum to 16) to infill the weight of the texel (s, t).
+    static void             ComputeInfillTaps(int blockWidth, int blockHeight, int gridWidth, int gridHeight, int s, int t, int *indices, int *weights);
+
+                            /// Reads count values of ISE starting at the bit offset.
+    static void             DecodeISE(const byte *block, int bitOffset, int count, int quant, byte *values);
+                            /// Writes count values of ISE starting at the bit offset.
+    static void             EncodeISE(const byte *values, int count, int quant, byte *block, int bitOffset);
+
+    static int              ReadBits(const byte *block, int bitOffset, int numBits);
+    static void             WriteBits(byte *block, int bitOffset, int numBits, int value);
+
+                            /// Reverses bit order of the 128 bits block. Weights are stored from the most significant bit.
+    static void             ReverseBlockBits(const byte *src, byte *dst);
+
+protected:
+    struct QuantInfo {
+        int                 levels;
+        int                 trits;
+        int                 quints;
+        int                 bits;
+    };
+
+    static const QuantInfo  quantInfo[NumQuants];
+    static const byte       tritEncodeTable[243];
+    static const byte       quintEncodeTable[125];
+};
+
+BE_INLINE int ASTCCodec::QuantLevels(int quant) {
+    return quantInfo[quant].levels;
+}
+
+BE_INLINE int ASTCCodec::ReadBits(const byte *block, int bitOffset, int numBits) {
+    int value = 0;
+    for (int i = 0; i < numBits; i++) {
+        int pos = bitOffset + i;
+        value |= ((block[pos >> 3] >> (pos & 7)) & 1) << i;
+    }
+    return value;
+}
+
+BE_INLINE void ASTCCodec::WriteBits(byte *block, int bitOffset, int numBits, int value) {
+    for (int i = 0; i < numBits; i++) {
+        int pos = bitOffset + i;
+        block[pos >> 3] = (block[pos >> 3] & ~(1 << (pos & 7))) | (((value >> i) & 1) << (pos & 7));
+    }
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,45 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "AstcCodec.h"
+
+BE_NAMESPACE_BEGIN
+
+//--------------------------------------------------------------------------------
+//
+// ASTC Decoder
+//
+// Decodes 2D LDR blocks. HDR endpoint modes and illegal blocks decode to the
+// error color (magenta).
+//
+//--------------------------------------------------------------------------------
+
+class BE_API ASTCDecoder : public ASTCCodec {
+public:
+                            /// Decompress ASTC blocks to RGBA8888
+    static void             DecompressImageASTC(const byte *src, const int blockWidth, const int blockHeight, const int width, const int height, const int depth, byte *out);
+
+                            /// Decode 128 bits ASTC block to blockWidth x blockHeight RGBA8888
+    static void             DecodeBlock(const byte *block, const int blockWidth, const int blockHeight, byte *out);
+
+                            /// Decodes LDR color endpoints of the color endpoint mode. Returns false for HDR modes.
+    static bool             DecodeColorEndpoints(int colorEndpointMode, const int *values, int *endpoint0, int *endpoint1);
+
+private:
+    static void             FillErrorColor(int numTexels, byte *out);
+};
+
+BE_NAMESPACE_END
@@ -0,0 +1,42 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Image/Image.h"
+#include "AstcCodec.h"
+
+BE_NAMESPACE_BEGIN
+
+//--------------------------------------------------------------------------------
+//
+// ASTC Encoder
+//
+// Encodes single partition, single plane blocks with RGB or RGBA direct endpoint
+// modes. Block modes are ranked per block footprint by the expected error and the
+// best candidates are encoded to pick the one with the least error. The number of
+// candidates depends on the quality.
+//
+//--------------------------------------------------------------------------------
+
+class BE_API ASTCEncoder : public ASTCCodec {
+public:
+                            /// Compress RGBA8888 image to ASTC blocks
+    static void             CompressImageASTC(const byte *src, const int blockWidth, const int blockHeight, const int width, const int height, const int depth, byte *dst, Image::CompressionQuality::Enum quality);
+
+                            /// Encode blockWidth x blockHeight RGBA8888 texels to 128 bits ASTC block
+    static void             EncodeBlock(const byte *texels, const int blockWidth, const int blockHeight, Image::CompressionQuality::Enum quality, byte *dst);
+};
+
+BE_NAMESPACE_END
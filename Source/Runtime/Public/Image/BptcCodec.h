@@ -0,0 +1,155 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+BE_NAMESPACE_BEGIN
+
+// BC6H: Three-component HDR color               - Half float RGB, unsigned or signed
+// BC7: Three-component color and alpha          - Color(4~7 bits), Alpha(0~8 bits) with p-bits
+//
+// Both formats encode 4x4 texels in 128 bits block and share the partition tables.
+
+class BE_API BPTCCodec {
+public:
+    static const int        BlockSize = 16;
+
+    struct BC7ModeInfo {
+        int                 numSubsets;
+        int                 partitionBits;
+        int                 rotationBits;
+        int                 indexSelectionBits;
+        int                 colorBits;
+        int                 alphaBits;
+        int                 endpointPBits;      ///< Unique p-bit per endpoint
+        int                 sharedPBits;        ///< Shared p-bit per subset
+        int                 indexBits;
+        int                 index2Bits;
+    };
+
+    struct BC6HModeInfo {
+        int                 modeValue;          ///< Value of 2 or 5 mode bits
+        int                 modeBits;
+        bool                transformed;        ///< Endpoints are stored as deltas from the first endpoint
+        int                 numRegions;
+        int                 endpointBits;
+        int                 deltaBits[3];
+        int                 numLayoutBits;
+        const byte *        layout;             ///< (endpoint * 3 + channel) << 4 | bit, per header bit after the mode bits
+    };
+
+    static const int        NumBC6HModes = 14;
+
+    static const BC7ModeInfo bc7Modes[8];
+    static const BC6HModeInfo bc6hModes[NumBC6HModes];
+
+                            /// Returns subset index of the pixel in the given partition.
+    static int              GetSubsetIndex(int numSubsets, int partition, int pixelIndex);
+                            /// Returns anchor pixel index of the subset in the given partition.
+    static int              GetAnchorIndex(int numSubsets, int partition, int subsetIndex);
+                            /// Returns true if the pixel is an anchor pixel in the given partition.
+    static bool             IsAnchorIndex(int numSubsets, int partition, int pixelIndex);
+
+                            /// Returns interpolation weight [0, 64] for the index with the given index bits.
+    static int              GetWeight(int indexBits, int index);
+
+                            /// Returns BC6H mode info of the given mode value, nullptr if it is reserved.
+    static const BC6HModeInfo *FindBC6HMode(int modeValue);
+
+    // Reads bits from the 128 bits block in LSB first order.
+    class BitReader {
+    public:
+        explicit BitReader(const byte *block) : data(block), pos(0) {}
+
+        int                 ReadBits(int numBits);
+        int                 Position() const { return pos; }
+
+    private:
+        const byte *        data;
+        int                 pos;
+    };
+
+    // Writes bits to the 128 bits block in LSB first order.
+    class BitWriter {
+    public:
+        explicit BitWriter(byte *block) : data(block), pos(0) { memset(data, 0, BlockSize); }
+
+        void                WriteBits(int value, int numBits);
+        int                 Position() const { return pos; }
+
+    private:
+        byte *              data;
+        int                 pos;
+    };
+
+protected:
+    static const uint16_t   partitionTable2[64];
+    static const uint32_t   partitionTable3[64];
+    static const byte       anchorTable2[64];
+    static const byte       anchorTable3a[64];
+    static const byte       anchorTable3b[64];
+    static const byte       weights2[4];
+    static const byte       weights3[8];
+    static const byte       weights4[16];
+};
+
+BE_INLINE int BPTCCodec::GetSubsetIndex(int numSubsets, int partition, int pixelIndex) {
+    if (numSubsets == 2) {
+        return (partitionTable2[partition] >> pixelIndex) & 1;
+    }
+    if (numSubsets == 3) {
+        return (partitionTable3[partition] >> (pixelIndex * 2)) & 3;
+    }
+    return 0;
+}
+
+BE_INLINE int BPTCCodec::GetAnchorIndex(int numSubsets, int partition, int subsetIndex) {
+    if (subsetIndex == 0) {
+        return 0;
+    }
+    if (numSubsets == 2) {
+        return anchorTable2[partition];
+    }
+    return subsetIndex == 1 ? anchorTable3a[partition] : anchorTable3b[partition];
+}
+
+BE_INLINE bool BPTCCodec::IsAnchorIndex(int numSubsets, int partition, int pixelIndex) {
+    return GetAnchorIndex(numSubsets, partition, GetSubsetIndex(numSubsets, partition, pixelIndex)) == pixelIndex;
+}
+
+BE_INLINE int BPTCCodec::GetWeight(int indexBits, int index) {
+    if (indexBits == 2) {
+        return weights2[index];
+    }
+    if (indexBits == 3) {
+        return weights3[index];
+    }
+    return weights4[index];
+}
+
+BE_INLINE int BPTCCodec::BitReader::ReadBits(int numBits) {
+    int value = 0;
+    for (int i = 0; i < numBits; i++, pos++) {
+        value |= ((data[pos >> 3] >> (pos & 7)) & 1) << i;
+    }
+    return value;
+}
+
+BE_INLINE void BPTCCodec::BitWriter::WriteBits(int value, int numBits) {
+    for (int i = 0; i < numBits; i++, pos++) {
+        data[pos >> 3] |= ((value >> i) & 1) << (pos & 7);
+    }
+}
+
+BE_NAMESPACE_END
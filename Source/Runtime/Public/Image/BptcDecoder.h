@@ -0,0 +1,45 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "BptcCodec.h"
+
+BE_NAMESPACE_BEGIN
+
+//--------------------------------------------------------------------------------
+//
+// BPTC (BC6H/BC7) Decoder
+//
+//--------------------------------------------------------------------------------
+
+class BE_API BPTCDecoder : public BPTCCodec {
+public:
+                            /// Decompress BC7 blocks to RGBA8888
+    static void             DecompressImageBC7(const byte *src, const int width, const int height, const int depth, byte *out);
+                            /// Decompress BC6H blocks to RGBA32F
+    static void             DecompressImageBC6H(const byte *src, const int width, const int height, const int depth, bool signedFormat, float *out);
+
+                            /// Decode 128 bits BC7 block to 4x4 RGBA8888
+    static void             DecodeBC7Block(const byte *block, byte *out);
+                            /// Decode 128 bits BC6H block to 4x4 RGB half floats
+    static void             DecodeBC6HBlock(const byte *block, bool signedFormat, uint16_t *out);
+
+                            /// Unquantizes BC6H endpoint component to 16 bits integer for interpolation.
+    static int              UnquantizeBC6H(int value, int bits, bool signedFormat);
+                            /// Converts interpolated 16 bits integer to half float bits.
+    static uint16_t         FinishUnquantizeBC6H(int value, bool signedFormat);
+};
+
+BE_NAMESPACE_END
@@ -0,0 +1,45 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Image/Image.h"
+#include "BptcCodec.h"
+
+BE_NAMESPACE_BEGIN
+
+//--------------------------------------------------------------------------------
+//
+// BPTC (BC6H/BC7) Encoder
+//
+// Endpoints are fitted along the principal axis of each subset and refined by
+// least squares. Partitions are ranked by the residual of the line fit and only
+// the best candidates are tried, the number of which depends on the quality.
+//
+//--------------------------------------------------------------------------------
+
+class BE_API BPTCEncoder : public BPTCCodec {
+public:
+                            /// Compress RGBA8888 image to BC7 blocks
+    static void             CompressImageBC7(const byte *src, const int width, const int height, const int depth, byte *dst, Image::CompressionQuality::Enum quality);
+                            /// Compress RGBA32F image to BC6H blocks (alpha is ignored)
+    static void             CompressImageBC6H(const float *src, const int width, const int height, const int depth, bool signedFormat, byte *dst, Image::CompressionQuality::Enum quality);
+
+                            /// Encode 4x4 RGBA8888 pixels to 128 bits BC7 block
+    static void             EncodeBC7Block(const byte *colorBlock, Image::CompressionQuality::Enum quality, byte *dst);
+                            /// Encode 4x4 RGBA32F pixels to 128 bits BC6H block
+    static void             EncodeBC6HBlock(const float *colorBlock, bool signedFormat, Image::CompressionQuality::Enum quality, byte *dst);
+};
+
+BE_NAMESPACE_END
@@ -0,0 +1,58 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "Image/Image.h"
+
+BE_NAMESPACE_BEGIN
+
+/*
+-------------------------------------------------------------------------------
+
+    CPU environment cubemap prefilter
+
+    CPU counterparts of RenderSystem::GenerateSHConvolvIrradianceEnvCubeRT,
+    RenderSystem::GenerateGGXLDSumRT and RenderSystem::GenerateGGXDFGSumImage.
+    Used for baking environment probes without a capable GPU.
+
+-------------------------------------------------------------------------------
+*/
+
+class BE_API EnvCubePrefilter {
+public:
+    static const int    NumSHCoeffs = 9;
+
+                        /// Projects radiance of the environment cubemap onto the 3rd order SH basis functions.
+    static void         ProjectSH(const Image &envCubeImage, Color3 shCoeffs[NumSHCoeffs]);
+
+                        /// Generates irradiance environment cubemap using SH convolution method.
+                        /// Output image has RGB_32F_32F_32F format in linear space.
+    static void         GenerateSHConvolvIrradianceEnvCube(const Image &envCubeImage, int size, Image &irradianceEnvCubeImage);
+
+                        /// Generates GGX specular prefiltered environment cubemap including all mip levels.
+                        /// Output image has RGB_32F_32F_32F format in linear space.
+    static void         GenerateGGXLDSumCube(const Image &envCubeImage, int size, Image &ldSumCubeImage);
+
+                        /// Generates GGX DFG integration 2D LUT in RG_16F_16F format.
+    static void         GenerateGGXDFGSumImage(int size, Image &integrationImage);
+
+                        /// Returns cached GGX DFG integration 2D LUT. LUT is generated at the first request for each size.
+    static const Image &GetGGXDFGSumImage(int size);
+
+                        /// Frees all the cached DFG LUTs.
+    static void         FreeCachedGGXDFGSumImages();
+};
+
+BE_NAMESPACE_END
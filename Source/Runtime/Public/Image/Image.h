@@ -18,6 +18,8 @@
 
 BE_NAMESPACE_BEGIN
 
+class File;
+
 /// Image representation
 class Image {
 public:
@@ -111,6 +113,25 @@ public:
             Depth_32F,
             DepthStencil_24_8,
             DepthStencil_32F_8,
+            // Compressed (BPTC) formats
+            RGB_BC6H_UF16,
+            RGB_BC6H_SF16,
+            RGBA_BC7,
+            // Compressed (ASTC) formats
+            RGBA_ASTC_4x4,
+            RGBA_ASTC_5x4,
+            RGBA_ASTC_5x5,
+            RGBA_ASTC_6x5,
+            RGBA_ASTC_6x6,
+            RGBA_ASTC_8x5,
+            RGBA_ASTC_8x6,
+            RGBA_ASTC_8x8,
+            RGBA_ASTC_10x5,
+            RGBA_ASTC_10x6,
+            RGBA_ASTC_10x8,
+            RGBA_ASTC_10x10,
+            RGBA_ASTC_12x10,
+            RGBA_ASTC_12x12,
             Count
         };
     };
@@ -367,11 +388,16 @@ public:
     Image &             AddNormalMapRGBA8888(const Image &normalMap);
 
                         /// Loads image from the file.
+                        /// PNG and JPG files are decoded from the file stream without loading the whole file into memory.
     bool                Load(const char *filename);
+                        /// Loads image downscaled to fit in maxSize x maxSize.
+                        /// PNG and JPG files are decoded directly into the downscaled image.
+    bool                LoadThumbnail(const char *filename, int maxSize);
 
                         /// Writes image to the file.
     bool                Write(const char *filename) const;
 
+    bool                WriteBTex(const char *filename) const;
     bool                WriteDDS(const char *filename) const;
     bool                WritePVR(const char *filename) const;
     bool                WriteBMP(const char *filename) const;
@@ -430,9 +456,10 @@ private:
     template <typename T>
     T                   WrapCoord(T coord, T maxCoord, SampleWrapMode::Enum wrapMode) const;
 
-    Color4              Sample2DNearest(const byte *src, const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWrapMode::Enum wrapModeT) const;
-    Color4              Sample2DBilinear(const byte *src, const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWrapMode::Enum wrapModeT) const;
+    Color4              Sample2DNearest(const byte *src, int level, const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWrapMode::Enum wrapModeT) const;
+    Color4              Sample2DBilinear(const byte *src, int level, const Vec2 &st, SampleWrapMode::Enum wrapModeS, SampleWrapMode::Enum wrapModeT) const;
 
+    bool                LoadBTexFromMemory(const char *name, const byte *data, size_t size);
     bool                LoadDDSFromMemory(const char *name, const byte *data, size_t size);
     bool                LoadPVRFromMemory(const char *name, const byte *data, size_t size);
     bool                LoadPVR2FromMemory(const char *name, const byte *data, size_t size);
@@ -443,6 +470,10 @@ private:
     bool                LoadJPGFromMemory(const char *name, const byte *data, size_t size);
     bool                LoadPNGFromMemory(const char *name, const byte *data, size_t size);
     bool                LoadHDRFromMemory(const char *name, const byte *data, size_t size);
+
+    bool                LoadFromFileStream(const char *filename, int maxSize);
+    bool                LoadJPGFromFile(const char *name, File *fp, int maxSize);
+    bool                LoadPNGFromFile(const char *name, File *fp, int maxSize);
     
     int                 width;          ///< Width
     int                 height;         ///< Height
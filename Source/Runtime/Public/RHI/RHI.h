@@ -309,6 +309,8 @@ public:
                 UInt                        = 3,
                 Float                       = 4,
                 Half                        = 5,
+                Short                       = 6,
+                UShort                      = 7,
             };
         };
 
@@ -286,6 +286,10 @@ public:
                             /// If overflow occurs, -1 is returned. If data == nullptr, write is not performed, so only overflow can be checked.
     int                     BufferWrite(Handle bufferHandle, int alignSize, int size, const void *data);
 
+                            /// Overwrites data at the given offset of the currently bound buffer.
+                            /// Write offset is not changed.
+    void                    BufferUpdate(Handle bufferHandle, int offset, int size, const void *data);
+
                             /// Quickly copy buffers created with CopyReadBuffer on GPU without burdening CPU memory copy.
     int                     BufferCopy(Handle readBufferHandle, Handle writeBufferHandle, int alignSize, int size);
 
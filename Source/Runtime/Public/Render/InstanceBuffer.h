@@ -0,0 +1,95 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Persistent instance buffer
+
+    Instance data of the render objects kept alive across frames.
+    Each render object owns a contiguous range of slots in the buffer,
+    and the slots are rewritten only when the render object is updated.
+    Dirty slots are merged into ranges and uploaded once per frame,
+    so draw surfaces refer to the instance data just by the slot index.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Render/BufferCache.h"
+
+BE_NAMESPACE_BEGIN
+
+class BE_API InstanceBuffer {
+public:
+    InstanceBuffer() = default;
+    ~InstanceBuffer();
+
+                            /// Allocates CPU side copy of the buffer. Each slot is stride bytes.
+                            /// GPU buffer of the given type is created in the first Upload().
+    void                    Init(RHI::BufferType::Enum bufferType, int stride, int initialCapacity);
+                            /// Frees CPU side copy and GPU buffer.
+    void                    Shutdown();
+
+    bool                    IsInitialized() const { return data != nullptr; }
+
+    int                     GetStride() const { return stride; }
+    int                     GetCapacity() const { return capacity; }
+
+                            /// Returns number of the allocated slots.
+    int                     NumAllocatedSlots() const { return numAllocatedSlots; }
+
+                            /// Allocates count contiguous slots and returns the first slot index.
+                            /// Buffer grows if there is no free range large enough.
+    int                     AllocSlots(int count);
+                            /// Frees slots allocated with AllocSlots().
+    void                    FreeSlots(int firstSlot, int count);
+
+                            /// Returns CPU side data of the slot. Call MarkDirty() after writing.
+    byte *                  GetSlotData(int slot) const { return data + slot * stride; }
+                            /// Marks slots to be uploaded in the next Upload().
+    void                    MarkDirty(int firstSlot, int count);
+
+                            /// Uploads dirty slots to the GPU buffer.
+    void                    Upload();
+
+                            /// Returns buffer cache to bind the GPU buffer. Offset is always 0.
+    const BufferCache *     GetBufferCache() const { return &bufferCache; }
+
+private:
+    struct SlotRange {
+        int                 firstSlot;
+        int                 count;
+    };
+
+    void                    Grow(int minCapacity);
+
+    RHI::BufferType::Enum   bufferType = RHI::BufferType::Vertex;
+    int                     stride = 0;
+    int                     capacity = 0;
+    int                     numAllocatedSlots = 0;
+    byte *                  data = nullptr;             ///< CPU side copy of the buffer
+    Array<SlotRange>        freeRanges;                 ///< Free slot ranges sorted by the first slot
+    Array<SlotRange>        dirtyRanges;                ///< Slot ranges to upload
+    bool                    bufferResized = false;      ///< GPU buffer should be recreated in the next Upload()
+    BufferCache             bufferCache = {};
+};
+
+BE_INLINE InstanceBuffer::~InstanceBuffer() {
+    Shutdown();
+}
+
+BE_NAMESPACE_END
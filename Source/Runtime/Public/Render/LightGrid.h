@@ -0,0 +1,116 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Clustered light grid
+
+    View frustum is divided into GridSizeX x GridSizeY screen tiles and
+    GridSizeZ depth slices (froxels). Depth slices are distributed exponentially
+    between the near and far planes, so the slice index of the view depth d is
+    floor(log(d) * sliceScale + sliceBias).
+
+    Lights are given as view space bounding spheres and assigned to the
+    intersecting clusters per depth slice in the job pool.
+    Assigned light indexes of all clusters are packed into one array
+    which is indexed by the offsets of each cluster.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Math/Math.h"
+
+BE_NAMESPACE_BEGIN
+
+class BE_API LightGrid {
+public:
+    static constexpr int    GridSizeX = 16;
+    static constexpr int    GridSizeY = 8;
+    static constexpr int    GridSizeZ = 24;
+    static constexpr int    NumClusters = GridSizeX * GridSizeY * GridSizeZ;
+
+    LightGrid() = default;
+    ~LightGrid();
+
+                            /// Allocates clusters.
+    void                    Init();
+                            /// Frees clusters.
+    void                    Shutdown();
+
+    bool                    IsInitialized() const { return clusterBounds.Count() > 0; }
+
+                            /// Computes view space bounds of the clusters with the perspective projection matrix.
+    void                    Setup(const Mat4 &projMatrix, float zNear, float zFar);
+
+                            /// Assigns lights to the clusters. Light index is the index in the given view space sphere array.
+    void                    AssignLights(const Sphere *viewSpaceSpheres, int numLights);
+
+    static int              ClusterIndex(int x, int y, int z) { return (z * GridSizeY + y) * GridSizeX + x; }
+
+                            /// Returns view space AABB of the cluster.
+    const AABB &            GetClusterBounds(int clusterIndex) const { return clusterBounds[clusterIndex]; }
+
+    float                   GetSliceScale() const { return sliceScale; }
+    float                   GetSliceBias() const { return sliceBias; }
+
+                            /// Returns offsets of the light indexes of each clusters. The last one is the total number of light indexes.
+    const int32_t *         GetClusterOffsets() const { return clusterOffsets.Ptr(); }
+
+    int                     NumLightIndexes() const { return clusterOffsets[NumClusters]; }
+    const int32_t *         GetLightIndexes() const { return lightIndexes.Ptr(); }
+
+    int                     NumClusterLights(int clusterIndex) const { return clusterOffsets[clusterIndex + 1] - clusterOffsets[clusterIndex]; }
+    const int32_t *         ClusterLightIndexes(int clusterIndex) const { return lightIndexes.Ptr() + clusterOffsets[clusterIndex]; }
+
+private:
+    struct SliceLight {
+        int32_t             lightIndex;
+        int                 minX, maxX;
+        int                 minY, maxY;
+    };
+
+    struct SliceTask {
+        LightGrid *         grid;
+        int                 slice;
+    };
+
+    void                    AssignSliceLights(int slice);
+    static void             AssignSliceLightsTask(void *data);
+
+    float                   sliceScale = 0.0f;
+    float                   sliceBias = 0.0f;
+
+    Array<AABB>             clusterBounds;
+    Array<float>            sliceDepths;                ///< View depth of the near plane of each slices, and the far plane
+
+    const Sphere *          spheres = nullptr;          ///< Light spheres while assigning lights
+    int                     numSpheres = 0;
+
+    Array<Array<SliceLight>> sliceLights;               ///< Lights overlapping the depth range of each slices
+    Array<Array<int32_t>>   sliceLightIndexes;          ///< Light indexes of the clusters in each slices sorted by the cluster
+    Array<int32_t>          sliceClusterCounts;         ///< Number of the lights of each clusters
+    Array<int32_t>          clusterOffsets;
+    Array<int32_t>          lightIndexes;
+    Array<SliceTask>        sliceTasks;
+};
+
+BE_INLINE LightGrid::~LightGrid() {
+    Shutdown();
+}
+
+BE_NAMESPACE_END
@@ -25,12 +25,14 @@
 #include "Math/Math.h"
 #include "Containers/Array.h"
 #include "Containers/HashMap.h"
+#include "Core/Vertex.h"
 
 class MeshImporter;
 
 BE_NAMESPACE_BEGIN
 
 class CmdArgs;
+class File;
 class Skeleton;
 class Joint;
 class Mat3x4;
@@ -41,12 +43,28 @@ class Ray;
 
 class MeshSurf {
 public:
-    SubMesh *               subMesh;
-    DrawSurf *              drawSurf;
-    int32_t                 materialIndex;
-    int32_t                 viewCount;
+    static constexpr int    MaxLODs = 4;
+
+                            /// Returns sub mesh of the given LOD level.
+                            /// Falls back to the coarsest available LOD if the level is not available.
+    SubMesh *               GetLODSubMesh(int lod) const;
+
+    SubMesh *               subMesh = nullptr;
+    SubMesh *               lodSubMeshes[MaxLODs - 1] = {}; ///< Simplified sub meshes for LOD 1 and the above
+    DrawSurf *              drawSurf = nullptr;
+    int32_t                 materialIndex = 0;
+    int32_t                 viewCount = 0;
 };
 
+BE_INLINE SubMesh *MeshSurf::GetLODSubMesh(int lod) const {
+    for (lod = Min(lod, MaxLODs - 1); lod > 0; lod--) {
+        if (lodSubMeshes[lod - 1]) {
+            return lodSubMeshes[lod - 1];
+        }
+    }
+    return subMesh;
+}
+
 struct BatchSubMesh {
     SubMesh *               subMesh;
     ALIGN_AS16 Mat3x4       localTransform;
@@ -83,7 +101,8 @@ public:
             ComputeTangents         = BIT(2),
             UseUnsmoothedTangents   = BIT(3),
             SortAndMerge            = BIT(4),
-            OptimizeIndices         = BIT(5)
+            OptimizeIndices         = BIT(5),
+            BuildClusters           = BIT(6)    ///< Build triangle clusters of the static meshes for the cluster culling
         };
     };
 
@@ -101,9 +120,28 @@ public:
 
     bool                    IsCompatibleSkeleton(const Skeleton *skeleton) const;
 
+                            /// Tests if the static vertex buffers use VertexGenericLitCompact.
+    bool                    UsesCompactVertices() const { return useCompactVertices; }
+                            /// Sets to use VertexGenericLitCompact for the static vertex buffers.
+                            /// This is chosen per mesh at import, and written to the bmesh file.
+                            /// Should be called before the static vertex buffers are cached.
+    void                    SetCompactVertices(bool compact);
+
     int                     NumSurfaces() const { return surfaces.Count(); }
     MeshSurf *              GetSurface(int index) const { assert(index >= 0 && index < surfaces.Count()); return surfaces[index]; }
 
+                            /// Returns number of LOD levels including the LOD 0.
+    int                     NumLODs() const { return numLODs; }
+                            /// Generates LOD chain of the reference mesh by the quadric error edge collapse simplification.
+                            /// Each LOD keeps triangleRatio of the triangles of the previous level.
+                            /// Instantiated static meshes are reinstantiated to use the generated LODs.
+    bool                    GenerateLODs(int numLODs, float triangleRatio = 0.5f);
+                            /// Sets surfaces of the imported mesh as the given LOD level.
+                            /// The LOD mesh should have the same number of surfaces with this mesh.
+    bool                    SetLODMesh(int lod, const Mesh *lodMesh);
+                            /// Removes all the LOD levels except the LOD 0.
+    void                    ClearLODs();
+
     int                     NumJoints() const { return numJoints; }
     const Joint *           GetJoints() const { return joints; }
 
@@ -118,8 +156,16 @@ public:
 
     void                    TransformVerts(const Mat3 &rotation, const Vec3 &scale, const Vec3 &translation);
 
+                            /// Fills this empty mesh with the sub meshes transformed into one surface.
+                            /// Mesh manager is not accessed, so this can be called in the task threads.
+    void                    CombineSubMeshes(const Array<BatchSubMesh> &batchSubMeshes, int finishFlags);
+
     void                    OptimizeIndexedTriangles();
 
+                            /// Reorders triangles of the reference static mesh into the clusters for the cluster culling.
+                            /// Should be called after OptimizeIndexedTriangles().
+    bool                    BuildClusters();
+
     void                    Voxelize();
 
     void                    UpdateSkinningJointCache(const Skeleton *skeleton, const Mat3x4 *joints);
@@ -150,6 +196,8 @@ public:
     void                    CreateRoundedBox(const Vec3 &origin, const Vec3 extents, float radius, int numSubdivisions);
 
     bool                    Load(const char *filename);
+                            /// Loads bmesh data in memory. The data is copied into this mesh.
+    bool                    LoadFromMemory(const void *data, size_t size);
     bool                    Reload();
 
     void                    Write(const char *filename);
@@ -159,7 +207,9 @@ public:
 
 private:
     void                    FreeSurface(MeshSurf *surf) const;
+    MeshSurf *              AllocExternalSurface(int numVerts, VertexGenericLit *verts, int numIndexes, TriIndex *indexes) const;
     MeshSurf *              AllocInstantiatedSurface(const MeshSurf *refSurf, int meshType) const;
+    SubMesh *               AllocLODSubMesh(const SubMesh *srcSubMesh, int numIndexes, const TriIndex *indexes) const;
 
     void                    Instantiate(int meshType);
 
@@ -172,8 +222,16 @@ private:
     void                    ComputeEdges();
 
     bool                    LoadBinaryMesh(const char *filename);
+    bool                    LoadBinaryMeshData(const byte *data, size_t size, const char *filename);
+    bool                    LoadBinaryMeshV1(const byte *data, size_t size);
+    bool                    LoadBinaryMeshV2(const byte *data, size_t size);
+    SubMesh *               LoadBinarySubMeshV2(const byte *data, size_t size, size_t &offset, int32_t &materialIndex) const;
+    void                    WriteBinarySubMesh(File *fp, const SubMesh *subMesh, int32_t materialIndex) const;
     void                    WriteBinaryMesh(const char *filename);
 
+    const byte *            OpenMeshData(const char *filename, size_t &size);
+    void                    CloseMeshData();
+
     Str                     hashName;
     Str                     name;
     mutable int             refCount = 0;
@@ -187,12 +245,20 @@ private:
     bool                    isSkinnedMesh = false;
     AABB                    aabb = AABB::empty;
     Array<MeshSurf *>       surfaces;
+    int                     numLODs = 1;
+
+    bool                    useCompactVertices = false;
 
     bool                    useGpuSkinning = false;
     SkinningJointCache *    skinningJointCache = nullptr;   // joint cache for HW skinning
 
     int32_t                 numJoints = 0;
     Joint *                 joints = nullptr;               // joint information array
+
+                                                            // bmesh file data which the sub meshes point to
+    void *                  fileMapping = nullptr;          // memory mapped file
+    File *                  mappedFile = nullptr;           // file which has the whole data in memory (e.g. stored pak entry)
+    byte *                  fileData = nullptr;             // loaded file if it can't be mapped
 };
 
 BE_INLINE Mesh::Mesh() {
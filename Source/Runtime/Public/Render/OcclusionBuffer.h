@@ -0,0 +1,121 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Software occlusion buffer
+
+    Low resolution depth buffer rasterized on the CPU.
+    Occluder triangles are transformed and binned into screen tiles,
+    then each tile is rasterized independently in the job pool.
+    Depth is stored as NDC z in [-1, 1], cleared to the far plane.
+
+    Occludee bounds are tested against the hierarchical max depth of
+    8x8 pixel blocks first, and then against the pixels of the blocks
+    which are not fully occluded.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Core/Vertex.h"
+
+BE_NAMESPACE_BEGIN
+
+class BE_API OcclusionBuffer {
+public:
+    static constexpr int    TileWidth = 32;
+    static constexpr int    TileHeight = 16;
+    static constexpr int    BlockSize = 8;
+
+    OcclusionBuffer() = default;
+    ~OcclusionBuffer();
+
+                            /// Allocates depth buffer. Width and height are rounded up to the multiple of tile size.
+    void                    Init(int width, int height);
+                            /// Frees depth buffer.
+    void                    Shutdown();
+
+    bool                    IsInitialized() const { return depthBuffer != nullptr; }
+
+    int                     GetWidth() const { return width; }
+    int                     GetHeight() const { return height; }
+
+                            /// Returns depth buffer. Rows are stored from the bottom.
+    const float *           GetDepthBuffer() const { return depthBuffer; }
+
+                            /// Returns number of the binned triangles after clipping.
+    int                     NumTriangles() const { return triangles.Count(); }
+
+                            /// Clears depth buffer and binned triangles.
+                            /// viewProjMatrix is used for the following occludee tests.
+    void                    Clear(const Mat4 &viewProjMatrix);
+
+                            /// Transforms triangles of the occluder to the screen space and bins them into the tiles.
+                            /// Vertex positions are read from xyz with the given stride in bytes.
+    void                    AddOccluder(const Mat4 &modelViewProjMatrix, const Vec3 *xyz, int stride, int numVerts, const TriIndex *indexes, int numIndexes);
+
+                            /// Rasterizes all the binned triangles and builds depth hierarchy.
+    void                    Rasterize();
+
+                            /// Returns true if any part of the world AABB may be visible.
+    bool                    IsAABBVisible(const AABB &worldAABB) const;
+
+private:
+    struct ScreenTriangle {
+        float               edgeA[3];
+        float               edgeB[3];
+        float               edgeC[3];
+        float               depthA;
+        float               depthB;
+        float               depthC;
+        int                 minX, minY;
+        int                 maxX, maxY;
+    };
+
+    struct TileTask {
+        OcclusionBuffer *   buffer;
+        int                 tileIndex;
+    };
+
+    void                    BinTriangle(const Vec4 &v0, const Vec4 &v1, const Vec4 &v2);
+    void                    RasterizeTile(int tileIndex);
+    static void             RasterizeTileTask(void *data);
+
+    int                     width = 0;
+    int                     height = 0;
+    int                     numTilesX = 0;
+    int                     numTilesY = 0;
+    int                     numBlocksX = 0;
+    int                     numBlocksY = 0;
+
+    float *                 depthBuffer = nullptr;
+    float *                 blockMaxDepth = nullptr;    ///< Farthest depth of each 8x8 pixel blocks
+
+    Mat4                    viewProjMatrix;
+
+    Array<Vec4>             clipVerts;                  ///< Scratch buffer for the transformed occluder vertices
+    Array<ScreenTriangle>   triangles;
+    Array<Array<int>>       tileBins;                   ///< Triangle indexes overlapping each tiles
+    Array<TileTask>         tileTasks;                  ///< Tasks of the tiles which have the binned triangles
+};
+
+BE_INLINE OcclusionBuffer::~OcclusionBuffer() {
+    Shutdown();
+}
+
+BE_NAMESPACE_END
@@ -39,6 +39,8 @@ class ParticleMesh {
     friend class RenderWorld;
 
 public:
+    static constexpr int    ParticlesPerTask = 256;
+
     ParticleMesh();
 
     int                     NumSurfaces() const { return surfaces.Count(); }
@@ -46,21 +48,42 @@ public:
 
     void                    Clear();
 
+                            /// Returns true if the drawing vertices of the particle system depend on the camera orientation.
+    static bool             IsViewDependent(const ParticleSystem *particleSystem);
+
     void                    Draw(const ParticleSystem *particleSystem, const Array<Particle *> &stageParticles, const RenderObject *renderObject, const RenderCamera *renderCamera);
 
     void                    CacheIndexes();
 
 private:
+    struct VertexTask {
+        const ParticleSystem::Stage *stage;
+        const Particle *    particles;                  ///< Particle array of the stage
+        int                 firstParticle;
+        int                 numParticles;
+        int                 firstVert;                  ///< Vertex offset in the pre-reserved vertex range
+        float               s1, t1, s2, t2;
+        Mat3                localAxis;                  ///< Particle axis in the local space for the non-aimed orientations
+        const RenderObject *renderObject;
+        const RenderCamera *renderCamera;
+        VertexGeneric *     vertexPointer;
+    };
+
     void                    PrepareNextSurf();
     void                    DrawQuad(const VertexGeneric *verts, const Material *material);
-    int                     CountDrawingVerts(const ParticleSystem::Stage &stage, const Particle *stageParticles) const;
+    int                     CountDrawingVerts(const ParticleSystem::Stage &stage, const Particle *stageParticles, int firstParticle, int numParticles) const;
     void                    ComputeTextureCoordinates(const ParticleSystem::StandardModule &standardModule, float time, float &s1, float &t1, float &s2, float &t2) const;
 
+    static void             DrawParticles(const VertexTask &task);
+    static void             DrawParticlesTask(void *data);
+
     Array<PrtMeshSurf>      surfaces;
     PrtMeshSurf *           currentSurf;
 
     int                     totalVerts;         ///< Total number of the vertices
     int                     totalIndexes;       ///< Total number of the indices
+
+    Array<VertexTask>       vertexTasks;                ///< Vertex generation tasks run in the job pool
 };
 
 BE_NAMESPACE_END
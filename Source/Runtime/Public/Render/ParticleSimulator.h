@@ -0,0 +1,68 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Particle simulator
+
+    Evaluates the trail pivots of the alive particles of the particle system
+    stages. Particles are generated with the random seeds by the caller in the
+    particle order, so the evaluation is deterministic and the stages of all
+    the particle systems can be simulated in the job pool at once.
+
+    SIMD path gathers the particles into the structure-of-arrays blocks once,
+    evaluates the curves which don't vary with the age once per block, and
+    applies the lifetime modules to the trail pivots of the whole block one
+    pivot index at a time with the SIMD processor. Results are scattered back to
+    the particle trails which are read by the ParticleMesh, and they are bitwise
+    identical to the scalar path.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Math/Math.h"
+#include "Render/ParticleSystem.h"
+
+BE_NAMESPACE_BEGIN
+
+class BE_API ParticleSimulator {
+public:
+    struct StageJob {
+        const ParticleSystem::Stage *stage;
+        Particle *          particles;                  ///< Particle array of the stage
+        int                 particleSize;               ///< Size of the particle including the trails
+        const int *         aliveParticles;             ///< Indexes of the alive particles
+        const int *         particleAges;               ///< Ages of the alive particles in milliseconds
+        int                 numAliveParticles;
+        Mat3x4              invWorldMatrix;             ///< Inverse world matrix of the particle system for the global simulation space
+        AABB                bounds;                     ///< Local bounds of the trail pivots
+    };
+
+                            /// Simulates the stage jobs in the job pool with the SIMD path, or with the scalar path if useSIMD is false.
+    static void             Simulate(StageJob *jobs, int numJobs, bool useSIMD);
+
+                            /// Simulates the stage job with the scalar path.
+    static void             SimulateStageScalar(StageJob &job);
+                            /// Simulates the stage job with the structure-of-arrays SIMD path.
+    static void             SimulateStageSIMD(StageJob &job);
+
+private:
+    static void             SimulateStageScalarTask(void *data);
+    static void             SimulateStageSIMDTask(void *data);
+};
+
+BE_NAMESPACE_END
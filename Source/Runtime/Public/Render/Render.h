@@ -27,12 +27,18 @@
 #include "Render/SubMesh.h"
 #include "Render/Mesh.h"
 #include "Render/ParticleMesh.h"
+#include "Render/ParticleSimulator.h"
 #include "Render/GuiMesh.h"
 #include "Render/Anim.h"
 #include "Render/RenderObject.h"
 #include "Render/RenderLight.h"
 #include "Render/EnvProbe.h"
 #include "Render/RenderCamera.h"
+#include "Render/OcclusionBuffer.h"
+#include "Render/InstanceBuffer.h"
+#include "Render/LightGrid.h"
+#include "Render/ShadowAtlas.h"
+#include "Render/ShadowCascades.h"
 #include "Render/RenderWorld.h"
 #include "Render/RenderContext.h"
 #include "Render/RenderSystem.h"
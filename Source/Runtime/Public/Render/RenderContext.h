@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include "Containers/HashMap.h"
 #include "GuiMesh.h"
+#include "ShadowAtlas.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -98,6 +100,19 @@ public:
         };
     };
 
+    /// Shadow map of the point/spot light in the tile of the shadow atlas.
+    /// Shadow map rendered independently of the view is reused while the light and the shadow casters in the light volume are not changed.
+    struct ShadowCache {
+        int                 tile = -1;                  ///< Tile handle in the shadow atlas
+        int                 lightVersion = -1;          ///< Last seen shadow cache version of the light
+        int                 lastChangedFrame = -1;      ///< Frame count when the light version has been changed
+        int                 lastUsedFrame = -1;
+        int                 cachedVersion = -1;         ///< Light version of the cached shadow map, -1 if the tile is not cached
+        int                 cachedCasterFilter = 0;     ///< Shadow caster filter of the camera for the cached shadow map
+        Mat4                viewProjScaleBiasMatrix;    ///< Cached shadow texture matrix of the spot light
+        Vec2                projectionDepth;            ///< Cached shadow projection depth of the point light
+    };
+
     RenderContext();
 
     void                    Init(RHI::WindowHandle hwnd, int renderingWidth, int renderingHeight, RHI::DisplayContextFunc displayFunc, void *displayFuncDataPtr, int flags = 0);
@@ -162,6 +177,10 @@ public:
 
     void                    TakeScreenShot(const char *filename, RenderWorld *renderWorld, int layerMask, const Vec3 &origin, const Mat3 &axis, float fov, int width, int height);
 
+                            // Returns the shadow cache of the light with the tile of the shadow atlas.
+                            // Returns nullptr if the tile can't be allocated.
+    ShadowCache *           GetShadowCache(int lightKey, int tileSize);
+
 //private:
     void                    InitScreenMapRT();
     void                    FreeScreenMapRT();
@@ -169,6 +188,8 @@ public:
     void                    FreeHdrMapRT();
     void                    InitShadowMapRT();
     void                    FreeShadowMapRT();
+    void                    FreeShadowCaches();
+    bool                    EvictShadowCache();
 
     RHI::Handle             contextHandle;
 
@@ -230,13 +251,14 @@ public:
     float                   vscmBiasedScale;
     float                   vscmBiasedFov;
 
-    bool                    vscmCleared[6] = { false, };
-
     Texture *               shadowRenderTexture = nullptr;;
-    Texture *               vscmTexture = nullptr;;
+    Texture *               shadowAtlasTexture = nullptr;
 
     RenderTarget *          shadowMapRT = nullptr;;
-    RenderTarget *          vscmRT = nullptr;;          // VSCM (Virtual Shadow Cube Map)
+    RenderTarget *          shadowAtlasRT = nullptr;    // Point/spot light shadow maps, VSCM (Virtual Shadow Cube Map) for point light
+
+    ShadowAtlas             shadowAtlas;
+    HashMap<int, ShadowCache *> shadowCaches;           // Shadow caches keyed by the light
 };
 
 BE_INLINE Color4 RenderContext::GetColor() const {
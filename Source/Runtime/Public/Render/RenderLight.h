@@ -139,6 +139,9 @@ private:
                             /// Updates this render light with the given state.
     void                    Update(const State *state);
 
+                            /// Marks the cached shadow map of this light is out of date.
+    void                    InvalidateShadowCache();
+
                             /// Frustum culling of light bounding volume.
     bool                    Cull(const Frustum &viewFrustum) const;
 
@@ -167,6 +170,9 @@ private:
 
     RenderWorld *           renderWorld;
     int                     index;              // index of light list in RenderWorld
+
+    int                     shadowCacheKey;     // unique key of the shadow cache in the render contexts
+    int                     shadowCacheVersion; // changed whenever the light or the shadow casters in the light volume are changed
     DbvtProxy *             proxy;
 };
 
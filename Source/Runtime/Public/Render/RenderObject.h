@@ -27,6 +27,7 @@
 #include "Math/Math.h"
 #include "Containers/Array.h"
 #include "Font.h"
+#include "ParticleMesh.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -57,7 +58,7 @@ public:
             EnvProbeLit         = BIT(6),
             CastShadows         = BIT(7),
             ReceiveShadows      = BIT(8),
-            Occluder            = BIT(9),   // for use in HOM
+            Occluder            = BIT(9),   // for use in occlusion culling
             SkipRendering       = BIT(10),
             SkipSelection       = BIT(11),
             RichText            = BIT(12),
@@ -164,6 +165,7 @@ public:
         const Skeleton *    skeleton = nullptr;         ///< Skeleton information for skeletal mesh
         int                 numJoints = 0;              ///< Number of joints
         Mat3x4 *            joints = nullptr;           ///< Joint transform matrices to animate skeletal mesh
+        Array<float>        lodScreenSizes;             ///< Projected screen heights in ratio below which each LOD switches to the next coarser LOD
 
         //
         // Raw indexed triangles rendering (typically for GUI rendering)
@@ -247,6 +249,8 @@ private:
 
     VisObject *             visObject = nullptr;
     int                     viewCount = 0;
+    int                     occluderViewCount = 0;      // viewCount when rasterized into the occlusion buffer
+    int                     lodIndex = 0;               // LOD selected in the last main camera view, used for hysteresis
 
     RenderWorld *           renderWorld;
     int                     index;                      // index of object list in RenderWorld
@@ -254,6 +258,12 @@ private:
 
     int                     numMeshSurfProxies = 0;     // number of proxies for static sub mesh
     DbvtProxy *             meshSurfProxies = nullptr;  // proxies for static sub mesh
+
+    int                     instanceSlot = -1;          // first slot in the instance buffer of RenderWorld, one slot per material
+    int                     numInstanceSlots = 0;
+
+    Array<PrtMeshSurf>      particleMeshSurfs;          // particle mesh surfaces shared by all cameras if the particle system is view independent
+    int                     particleMeshFrameCount = -1; // frame count when the particleMeshSurfs are generated
 };
 
 BE_NAMESPACE_END
@@ -160,6 +160,9 @@ public:
 private:
     VisObject *             RegisterVisObject(VisCamera *camera, RenderObject *object);
     VisLight *              RegisterVisLight(VisCamera *camera, RenderLight *light);
+    int                     SelectMeshLOD(const VisCamera *camera, RenderObject *renderObject, const AABB &worldAABB) const;
+    SubMesh *               CullSubMeshClusters(const VisCamera *camera, const VisObject *visObject, const Material *material, SubMesh *subMesh, bool occlusionTest);
+    void                    RasterizeOccluders(VisCamera *camera);
     void                    FindVisLightsAndObjects(VisCamera *camera);
     void                    AddStaticMeshes(VisCamera *camera);
     void                    AddSkinnedMeshes(VisCamera *camera);
@@ -167,13 +170,18 @@ private:
     void                    AddParticleMeshes(VisCamera *camera);
     void                    AddTextMeshes(VisCamera *camera);
     void                    AddSkyBoxMeshes(VisCamera *camera);
+    void                    SetupShadowCaches(VisCamera *camera);
     void                    AddStaticMeshesForLights(VisCamera *camera);
     void                    AddSkinnedMeshesForLights(VisCamera *camera);
     void                    AddSubCamera(VisCamera *camera);
+    void                    UpdateInstanceSlots(RenderObject *renderObject);
+    void                    FreeInstanceSlots(RenderObject *renderObject);
+    void                    InvalidateShadowCaches(const AABB &worldAABB);
     void                    CacheInstanceBuffer(VisCamera *camera);
     void                    OptimizeLights(VisCamera *camera);
-    void                    AddDrawSurf(VisCamera *camera, VisLight *light, VisObject *entity, const Material *material, SubMesh *subMesh, int flags);
-    void                    AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *light, bool shadowVisible, const DrawSurf *ambientDrawSurf);
+    void                    BuildLightGrid(VisCamera *camera);
+    void                    AddDrawSurf(VisCamera *camera, VisLight *light, VisObject *entity, const Material *material, SubMesh *subMesh, int flags, int cascadeMask = -1);
+    void                    AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *light, bool shadowVisible, const DrawSurf *ambientDrawSurf, int cascadeMask = -1);
     void                    SortDrawSurfs(VisCamera *camera);
 
     void                    DrawCamera(VisCamera *camera);
@@ -205,6 +213,10 @@ private:
     DynamicAABBTree         lightDbvt;              ///< Dynamic bounding volume tree for render lights
     DynamicAABBTree         probeDbvt;              ///< Dynamic bounding volume tree for environment probes
     DynamicAABBTree         staticMeshDbvt;         ///< Dynamic bounding volume tree for static meshes
+
+    OcclusionBuffer         occlusionBuffer;        ///< CPU rasterized depth buffer for occlusion culling
+    InstanceBuffer          instanceBuffer;         ///< Persistent instance data of the render objects
+    LightGrid               lightGrid;              ///< Clustered light grid of the current camera
 };
 
 BE_NAMESPACE_END
@@ -90,6 +90,8 @@ public:
             InstanceIndexes,
             LocalToWorldMatrix,
             WorldToLocalMatrix,
+            VertexDecodeScale,
+            VertexDecodeBias,
             TextureMatrixS,
             TextureMatrixT,
             ConstantColor,
@@ -0,0 +1,103 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Shadow atlas
+
+    Allocates square power of two tiles in the square shadow atlas texture.
+    Tiles are the nodes of the quadtree. The node of level L has the size of
+    atlasSize >> L, and it is split into 4 children when the smaller tile is
+    requested. Freed tiles are merged back into the parent node when all of
+    its 4 children are free.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/Array.h"
+#include "Math/Math.h"
+
+BE_NAMESPACE_BEGIN
+
+class BE_API ShadowAtlas {
+public:
+    ShadowAtlas() = default;
+    ~ShadowAtlas();
+
+                            /// Initializes with the atlas size and the minimum tile size. Both sizes should be power of two.
+    void                    Init(int atlasSize, int minTileSize);
+                            /// Frees all the tiles.
+    void                    Shutdown();
+
+    bool                    IsInitialized() const { return atlasSize > 0; }
+
+    int                     GetAtlasSize() const { return atlasSize; }
+    int                     GetMinTileSize() const { return minTileSize; }
+
+                            /// Returns the number of the allocated tiles.
+    int                     NumTiles() const { return numTiles; }
+
+                            /// Allocates a tile. Tile size is rounded up to the power of two and the minimum tile size.
+                            /// Returns tile handle, or -1 if there is no free space.
+    int                     AllocTile(int tileSize);
+                            /// Frees the tile allocated by AllocTile().
+    void                    FreeTile(int tile);
+                            /// Frees all the tiles.
+    void                    FreeAllTiles();
+
+                            /// Returns the rect of the tile in texels.
+    const Rect &            GetTileRect(int tile) const { return nodes[tile].rect; }
+
+                            /// Returns the size of the tile which is appropriate to allocate for the requested size.
+    int                     ClampTileSize(int tileSize) const;
+
+private:
+    struct Node {
+        enum State {
+            Unused,                                 ///< Node slot is not used
+            Free,                                   ///< In the free list of its level
+            Allocated,                              ///< Allocated as a tile
+            Split                                   ///< Split into 4 children
+        };
+
+        Rect                rect;
+        int                 level;
+        int                 parent;
+        int                 children[4];
+        State               state;
+    };
+
+    int                     NewNode(int level, int parent, const Rect &rect);
+    void                    DeleteNode(int node);
+
+    void                    SplitNode(int node);
+
+    int                     atlasSize = 0;
+    int                     minTileSize = 0;
+    int                     numLevels = 0;
+    int                     numTiles = 0;
+
+    Array<Node>             nodes;
+    Array<int>              unusedNodes;                ///< Reusable node slots
+    Array<Array<int>>       freeNodes;                  ///< Free nodes of each levels
+};
+
+BE_INLINE ShadowAtlas::~ShadowAtlas() {
+    Shutdown();
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,65 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Shadow cascades
+
+    View frustum is split into the cascades of the directional light along
+    the view depth. Each split view frustum is projected on the light axes,
+    and the shadow caster can cast shadows on the cascade only if it overlaps
+    the light space bounds of the split view frustum in the lateral axes and
+    it is not entirely behind the split view frustum along the light direction.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Math/Math.h"
+
+BE_NAMESPACE_BEGIN
+
+class BE_API ShadowCascades {
+public:
+    static constexpr int    MaxCascades = 8;
+
+                            /// Splits the view frustum from the near distance to dFar into the numCascades cascades.
+                            /// Each split view frustum is extended to the previous split distance if blend is true.
+    void                    Setup(const Mat3 &lightAxis, const Frustum &viewFrustum, float dFar, float splitLambda, int numCascades, bool blend);
+
+    int                     NumCascades() const { return numCascades; }
+
+                            /// Returns split distance. Index 0 is the near distance and index NumCascades() is the far distance.
+    float                   GetSplitDistance(int index) const { return splitDistances[index]; }
+
+                            /// Returns split view frustum of the cascade.
+    const Frustum &         GetSplitFrustum(int cascadeIndex) const { return splitFrustums[cascadeIndex]; }
+
+                            /// Returns light space bounds of the split view frustum of the cascade.
+    const AABB &            GetLightBounds(int cascadeIndex) const { return lightBounds[cascadeIndex]; }
+
+                            /// Returns bit mask of the cascades which the shadow caster can cast shadows on.
+    int                     CascadeMask(const AABB &casterAABB) const;
+
+private:
+    Mat3                    lightAxis;
+    int                     numCascades = 0;
+    float                   splitDistances[MaxCascades + 1];
+    Frustum                 splitFrustums[MaxCascades];
+    AABB                    lightBounds[MaxCascades];
+};
+
+BE_NAMESPACE_END
@@ -50,6 +50,26 @@ struct JointWeight {
     int32_t                 nextVertOffset;     ///< 0 means the same vertex.
 };
 
+/// Cluster of the adjacent triangles used for the culling of the large static meshes.
+/// Triangles of a cluster are stored contiguously in the index array.
+struct MeshCluster {
+    int32_t                 firstIndex;         ///< first index in the index array of the sub mesh
+    int32_t                 numIndexes;
+    Vec3                    center;             ///< bounding sphere center in local space
+    float                   radius;             ///< bounding sphere radius in local space
+    Vec3                    coneAxis;           ///< average direction of the triangle normals
+    float                   coneCutoff;         ///< sine of the normal cone angle. 1 means the cluster can't be back face culled.
+    AABB                    aabb;               ///< AABB in local space
+
+                            /// Returns true if all the triangles are back facing from the view origin in local space.
+    bool                    IsBackFacing(const Vec3 &localViewOrigin) const;
+};
+
+BE_INLINE bool MeshCluster::IsBackFacing(const Vec3 &localViewOrigin) const {
+    Vec3 dir = center - localViewOrigin;
+    return dir.Dot(coneAxis) >= coneCutoff * dir.Length() + radius;
+}
+
 struct BufferCache;
 
 class Material;
@@ -62,6 +82,8 @@ class SubMesh {
     friend class ::MeshImporter;
     
 public:
+    static constexpr int    MaxClusterTris = 128;
+
     SubMesh();
     ~SubMesh();
 
@@ -108,18 +130,40 @@ public:
     const Vec3              ComputeCentroid() const;
     const Mat3              ComputeInertiaTensor(const Vec3 &centroid, float mass) const;
 
+                            /// Reorders triangles for the post-transform vertex cache and the overdraw,
+                            /// and then reorders vertices by the first use for the vertex fetch.
+                            /// Edges and dominant triangles are invalidated.
     void                    OptimizeIndexedTriangles();
+                            /// Returns number of the triangle clusters. 0 if the clusters are not built.
+    int                     NumClusters() const { return numClusters; }
+    const MeshCluster *     Clusters() const { return clusters; }
+
+                            /// Returns average cache miss ratio (transformed vertices per triangle) of the FIFO vertex cache.
+    float                   ComputeACMR(int cacheSize = 16) const;
 
     bool                    IsGpuSkinning() const { return useGpuSkinning; }
 
+                            /// Tests if the static vertex buffer uses VertexGenericLitCompact.
+    bool                    IsCompactVertex() const { return useCompactVertex; }
+                            /// Returns vertex size in the vertex buffer.
+    int                     VertexSize() const;
+                            /// Returns scale and bias to decode the quantized positions of the compact vertices.
+    void                    GetPositionDecodeScaleBias(Vec3 &decodeScale, Vec3 &decodeBias) const;
+
     void                    CacheStaticDataToGpu();
     void                    CacheDynamicDataToGpu(const Mat3x4 *joints, const Material *material);
 
 private:
     void                    AllocSubMesh(int numVerts, int numIndexes);
+                            /// Allocates sub mesh which uses the given vertex and index data without copy.
+                            /// The data must be valid until the sub mesh is freed.
+    void                    AllocExternalSubMesh(int numVerts, VertexGenericLit *verts, int numIndexes, TriIndex *indexes);
     void                    AllocInstantiatedSubMesh(const SubMesh *refMesh, int meshType);
     void                    FreeSubMesh();
 
+                            /// Copies the external data to the owned memory to modify it.
+    void                    DetachExternalData();
+
     void                    SplitMirroredVerts();
     void                    FixMirroredVerts();
 
@@ -129,8 +173,15 @@ private:
     void                    ComputeTangents(bool includeNormals, bool useUnsmoothedTangents);
     void                    ComputeEdges();
 
+                            /// Reorders triangles into the clusters of up to MaxClusterTris adjacent triangles.
+    void                    BuildClusters();
+    void                    FreeClusters();
+
+    void                    WriteCompactVerts(VertexGenericLitCompact *dst) const;
+
     int                     type;
     bool                    alloced;
+    bool                    externalData;               // verts, indexes and vertWeights point to the data owned by the mesh (e.g. memory mapped file)
     const SubMesh *         refSubMesh;
     int                     subMeshIndex;
 
@@ -151,6 +202,9 @@ private:
     Edge *                  edges;                      // shared edges are not stored explicitly
     int32_t *               edgeIndexes;                // triangle edge indexes to edge indexes including negative index number
 
+    int                     numClusters;                // number of triangle clusters
+    MeshCluster *           clusters;                   // triangle clusters for the culling
+
     int                     numJointWeights;            // verts 와 별개로 weight 배열을 따로 관리 (for CPU skinning)
     JointWeight *           jointWeights;               // weight information array
     Vec4 *                  jointWeightVerts;           // local vertex of weight.
@@ -159,6 +213,8 @@ private:
     bool                    useGpuSkinning;
     int                     gpuSkinningVersionIndex;    // 0: VertexWeight1, 1: VertexWeight4, 2: VertexWeight8
 
+    bool                    useCompactVertex;           // verts are encoded to VertexGenericLitCompact in the static vertex buffer
+
     AABB                    aabb;                       // AABB in local submesh space
 
     BufferCache *           vertexCache;
@@ -14,40 +14,89 @@
 
 #pragma once
 
+/*
+-------------------------------------------------------------------------------
+
+    Static batching
+
+    Static mesh renderers with the same render states in the same spatial cell
+    are combined into one mesh, so the combined meshes can still be culled per cell.
+    Combined meshes are built in parallel and stored in the derived data cache.
+
+    Static entities added or removed while the game is running mark their cells
+    as dirty, and only the dirty cells are combined again.
+
+-------------------------------------------------------------------------------
+*/
+
 #include "Containers/Array.h"
+#include "Containers/HashMap.h"
+#include "Render/RenderObject.h"
 
 BE_NAMESPACE_BEGIN
 
 class Entity;
 class Mesh;
+class RenderWorld;
+class ComStaticMeshRenderer;
 
 class StaticBatch {
+    friend class MeshCombiner;
+
 public:
     StaticBatch();
     ~StaticBatch();
 
-    static StaticBatch *        AllocStaticBatch(Entity *rootEntity);
+    static StaticBatch *        AllocStaticBatch(RenderWorld *renderWorld, uint64_t cellKey);
     static void                 DestroyStaticBatch(StaticBatch *staticBatch);
 
+                                /// Destroys all the static batches and shows the combined mesh renderers again.
     static void                 ClearAllStaticBatches();
 
+                                /// Combines the static mesh renderers of the children of the hierarchy root.
     static void                 CombineAll(Hierarchy<Entity> &entityHierarchy);
 
+                                /// Adds the static entity to its cell to be combined in UpdateDirtyCells().
+    static void                 AddEntity(Entity *entity);
+                                /// Removes the static entity from its cell and static batch.
+                                /// Should be called before the components of the entity are destroyed.
+    static void                 RemoveEntity(Entity *entity);
+                                /// Combines again only the cells that static entities are added to or removed from.
+    static void                 UpdateDirtyCells();
+
     static StaticBatch *        GetStaticBatchByIndex(int index);
 
+                                /// Returns key of the cell which contains the given world position.
+    static uint64_t             CellKey(const Vec3 &position);
+
     int                         GetIndex() const { return index; }
-   
-    Entity *                    GetRootEntity() const { return rootEntity; }
+
+    uint64_t                    GetCellKey() const { return cellKey; }
 
     Mesh *                      GetMesh() const { return referenceMesh; }
-    void                        SetMesh(Mesh *mesh) { referenceMesh = mesh; }
+
+    int                         NumMeshRenderers() const { return meshRenderers.Count(); }
 
 private:
+    struct Cell {
+        Array<ComStaticMeshRenderer *> meshRenderers;   ///< Combinable mesh renderers in the cell
+        bool                    dirty = false;
+    };
+
+    void                        SetMesh(Mesh *mesh, const RenderObject::State &templateDef, const Vec3 &origin);
+    void                        UpdateVisuals();
+
     int                         index;
-    Entity *                    rootEntity;
+    uint64_t                    cellKey;
     Mesh *                      referenceMesh;
+    Array<ComStaticMeshRenderer *> meshRenderers;
+
+    RenderWorld *               renderWorld;
+    RenderObject::State         renderObjectDef;
+    int                         renderObjectHandle;
 
-    static Array<StaticBatch *> staticBatches;
+    static Array<StaticBatch *> staticBatches;          ///< Freed slots are set to nullptr to keep the indexes
+    static HashMap<uint64_t, Cell> cells;
 };
 
 BE_NAMESPACE_END
@@ -0,0 +1,8 @@
+// Generated automatically by cmake
+// Don't modify this file manually !
+
+#define BE_VERSION_MAJOR 0
+#define BE_VERSION_MINOR 7
+#define BE_VERSION_PATCH 0
+#define BE_VERSION_DATE "2026-10-18 15:05:57"
+
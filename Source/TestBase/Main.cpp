@@ -16,6 +16,10 @@
 #include "TestContainer.h"
 #include "TestMath.h"
 #include "TestSIMD.h"
+#include "TestImage.h"
+#include "TestIO.h"
+#include "TestRender.h"
+#include "TestGame.h"
 #include "TestCUDA.h"
 #include "TestLua.h"
 
@@ -45,6 +49,14 @@ int main(int argc, char *argv[]) {
     
     TestSIMD();
 
+    //TestImage();
+
+    //TestIO();
+
+    //TestRender();
+
+    //TestGame();
+
 #if TEST_CUDA
     bool cudaSupported = MyCuda::Init();
     
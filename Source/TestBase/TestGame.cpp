@@ -0,0 +1,109 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "TestGame.h"
+
+static const BE1::Vec3 prefabForce(1.0f, 2.0f, 3.0f);
+static const BE1::Vec3 prefabChildOrigin(0.0f, 0.0f, 10.0f);
+
+// Creates the prefab of the root entity with a constant force, and a child entity.
+static BE1::Entity *CreatePrefabEntity(BE1::GameWorld *prefabWorld) {
+    BE1::Guid rootGuid = BE1::Guid::CreateGuid();
+
+    Json::Value rootValue;
+    rootValue["classname"] = BE1::Entity::metaObject.ClassName();
+    rootValue["guid"] = rootGuid.ToString();
+    rootValue["name"] = "PooledPrefab";
+    rootValue["prefab"] = true;
+    rootValue["components"][0]["classname"] = BE1::ComTransform::metaObject.ClassName();
+    rootValue["components"][0]["origin"] = BE1::Vec3::zero.ToString();
+    rootValue["components"][1]["classname"] = BE1::ComConstantForce::metaObject.ClassName();
+    rootValue["components"][1]["force"] = prefabForce.ToString();
+
+    Json::Value childValue;
+    childValue["classname"] = BE1::Entity::metaObject.ClassName();
+    childValue["name"] = "PooledPrefabChild";
+    childValue["prefab"] = true;
+    childValue["parent"] = rootGuid.ToString();
+    childValue["components"][0]["classname"] = BE1::ComTransform::metaObject.ClassName();
+    childValue["components"][0]["origin"] = prefabChildOrigin.ToString();
+
+    BE1::Entity *rootEntity = BE1::Entity::CreateEntity(rootValue, prefabWorld);
+    rootEntity->Init();
+
+    BE1::Entity *childEntity = BE1::Entity::CreateEntity(childValue, prefabWorld);
+    childEntity->Init();
+
+    return rootEntity;
+}
+
+// Spawns the pooled entity, changes it's properties, and checks they are reset to the prefab when it is respawned.
+static void TestEntityPool(BE1::GameWorld *gameWorld, const BE1::Entity *prefabEntity) {
+    gameWorld->SetEntityPoolSize(prefabEntity, 1);
+
+    BE1::Entity *entity = gameWorld->SpawnPooledEntity(prefabEntity, BE1::Vec3(100, 0, 0), BE1::Quat::identity);
+
+    BE1::Entity *child = entity->GetNode().GetFirstChild();
+    entity->GetComponent<BE1::ComConstantForce>()->SetProperty("force", BE1::Vec3(9, 9, 9));
+    entity->GetTransform()->SetLocalScale(BE1::Vec3(2, 2, 2));
+    child->GetTransform()->SetLocalOrigin(BE1::Vec3(5, 5, 5));
+    child->SetActive(false);
+
+    gameWorld->DespawnPooledEntity(entity);
+
+    BE1::Entity *respawnedEntity = gameWorld->SpawnPooledEntity(prefabEntity, BE1::Vec3(0, 100, 0), BE1::Quat::identity);
+
+    int numFailed = 0;
+
+    if (respawnedEntity != entity) {
+        numFailed++;
+    } else {
+        BE1::Entity *respawnedChild = respawnedEntity->GetNode().GetFirstChild();
+
+        if (respawnedEntity->GetComponent<BE1::ComConstantForce>()->GetProperty("force").As<BE1::Vec3>() != prefabForce) {
+            numFailed++;
+        }
+        if (respawnedEntity->GetTransform()->GetLocalScale() != BE1::Vec3::one) {
+            numFailed++;
+        }
+        if (respawnedEntity->GetTransform()->GetOrigin() != BE1::Vec3(0, 100, 0)) {
+            numFailed++;
+        }
+        if (respawnedChild != child || respawnedChild->GetTransform()->GetLocalOrigin() != prefabChildOrigin || !respawnedChild->IsActiveSelf()) {
+            numFailed++;
+        }
+    }
+
+    const BE1::EntityPool *pool = gameWorld->GetEntityPool(prefabEntity);
+
+    BE_LOG("Entity pool respawn: %i failed, %i hits, %i misses\n", numFailed, pool->numHits, pool->numMisses);
+}
+
+void TestGame() {
+    BE1::GameWorld *prefabWorld = (BE1::GameWorld *)BE1::GameWorld::CreateInstance();
+    BE1::GameWorld *gameWorld = (BE1::GameWorld *)BE1::GameWorld::CreateInstance();
+
+    BE1::Entity *prefabEntity = CreatePrefabEntity(prefabWorld);
+
+    TestEntityPool(gameWorld, prefabEntity);
+
+    // Spawned entities and the pools are cleared with the game world.
+    BE1::GameWorld::DestroyInstanceImmediate(gameWorld);
+
+    // Prefab entities are not registered to the prefab world.
+    BE1::Entity::DestroyInstanceImmediate(prefabEntity->GetNode().GetFirstChild());
+    BE1::Entity::DestroyInstanceImmediate(prefabEntity);
+    BE1::GameWorld::DestroyInstanceImmediate(prefabWorld);
+}
@@ -0,0 +1,272 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "BlueshiftEngine.h"
+#include "TestIO.h"
+
+static const char *testDataDir = "TestIO/Data";
+
+// Mix of text, smooth binary and noise which are the typical contents of the shipped assets.
+static void GenerateTestData(int numFiles, int fileSize) {
+    BE1::Random random(1234);
+    BE1::Array<byte> data;
+    data.SetCount(fileSize);
+
+    for (int fileIndex = 0; fileIndex < numFiles; fileIndex++) {
+        int kind = fileIndex % 3;
+
+        if (kind == 0) {
+            BE1::Str text;
+            for (int i = 0; text.Length() < fileSize; i++) {
+                text += BE1::va("{ \"name\": \"Entity%i\", \"position\": [%i, %i, %i], \"active\": %s },\n", 
+                    i, random.RandomInt() % 1000, random.RandomInt() % 1000, random.RandomInt() % 1000, i & 1 ? "true" : "false");
+            }
+            memcpy(data.Ptr(), text.c_str(), fileSize);
+        } else if (kind == 1) {
+            for (int i = 0; i < fileSize; i++) {
+                data[i] = (byte)((i >> 4) + random.RandomInt(2));
+            }
+        } else {
+            // Low bits of the LCG repeat too soon to be an incompressible noise, so use xorshift here.
+            uint32_t x = 2463534242u + fileIndex;
+            for (int i = 0; i < fileSize; i++) {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                data[i] = (byte)(x >> 24);
+            }
+        }
+
+        BE1::Str filename = testDataDir;
+        filename.AppendPath(BE1::va("file%02i.bin", fileIndex));
+        BE1::fileSystem.WriteFile(filename, data.Ptr(), fileSize);
+    }
+}
+
+static bool VerifyPackage(const BE1::PackageReader &reader, const char *name) {
+    BE1::Array<byte> entryData;
+    BE1::Array<byte> chunk;
+    BE1::Random random(5678);
+
+    for (int i = 0; i < reader.NumEntries(); i++) {
+        const char *entryName = reader.GetEntryName(i);
+
+        void *srcData;
+        size_t srcSize = BE1::fileSystem.LoadFile(entryName, false, &srcData);
+
+        BE1::File *file = reader.OpenEntry(i, entryName);
+        entryData.SetCount((int)file->Size());
+        bool ok = file->Size() == srcSize && file->Read(entryData.Ptr(), srcSize) == srcSize && !memcmp(entryData.Ptr(), srcData, srcSize);
+
+        // Random access
+        for (int j = 0; j < 32 && ok; j++) {
+            int offset = random.RandomInt() % (int)srcSize;
+            int size = BE1::Min(random.RandomInt() % 100000, (int)srcSize - offset);
+            chunk.SetCount(size);
+            ok = file->Seek(offset) == 0 && file->Read(chunk.Ptr(), size) == size && !memcmp(chunk.Ptr(), (byte *)srcData + offset, size);
+        }
+
+        delete file;
+        BE1::fileSystem.FreeFile(srcData);
+
+        if (!ok) {
+            BE_LOG("%s: mismatch in '%s'\n", name, entryName);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void BenchmarkPackage(const BE1::PackageReader &reader, const char *name, size_t packageSize) {
+    BE1::Array<byte> buffer;
+    size_t totalSize = 0;
+
+    double startTime = BE1::PlatformTime::Seconds();
+
+    for (int i = 0; i < reader.NumEntries(); i++) {
+        BE1::File *file = reader.OpenEntry(i, reader.GetEntryName(i));
+        buffer.SetCount((int)file->Size(), false);
+        totalSize += file->Read(buffer.Ptr(), file->Size());
+        delete file;
+    }
+
+    double elapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    BE_LOG("%-12s: %6.2f MB -> %6.2f MB, decode %8.2f MB/s\n", name, totalSize / 1048576.0, packageSize / 1048576.0, totalSize / 1048576.0 / elapsed);
+}
+
+static void TestLZ4RoundTrip() {
+    BE1::Random random(4321);
+    BE1::Array<byte> src;
+    BE1::Array<byte> compressed;
+    BE1::Array<byte> decompressed;
+
+    int numFailed = 0;
+
+    for (int i = 0; i < 200; i++) {
+        int size = random.RandomInt() % 70000;
+        src.SetCount(size);
+        int period = 1 + random.RandomInt() % 64;
+        for (int j = 0; j < size; j++) {
+            src[j] = (random.RandomInt() % 8) == 0 ? (byte)random.RandomInt() : (byte)(j % period);
+        }
+
+        compressed.SetCount(BE1::LZ4_CompressBound(size));
+        int compressedSize = BE1::LZ4_CompressBlock(src.Ptr(), size, compressed.Ptr(), compressed.Count());
+
+        decompressed.SetCount(size);
+        if (BE1::LZ4_DecompressBlock(compressed.Ptr(), compressedSize, decompressed.Ptr(), size) != size || memcmp(src.Ptr(), decompressed.Ptr(), size)) {
+            numFailed++;
+        }
+
+        // Corrupted input must not write outside of the destination.
+        if (compressedSize > 0) {
+            compressed[random.RandomInt() % compressedSize] ^= 0x55;
+            BE1::LZ4_DecompressBlock(compressed.Ptr(), compressedSize, decompressed.Ptr(), size);
+        }
+    }
+
+    BE_LOG("LZ4 round trip: %i failed\n", numFailed);
+}
+
+struct AsyncReadTest {
+    BE1::AsyncReadRequest * request;
+    const byte *            srcData;
+};
+
+static void TestAsyncRead(int numFiles) {
+    BE1::Random random(8765);
+    BE1::Array<void *> srcData;
+    BE1::Array<AsyncReadTest> tests;
+
+    for (int i = 0; i < numFiles; i++) {
+        BE1::Str filename = testDataDir;
+        filename.AppendPath(BE1::va("file%02i.bin", i));
+
+        void *data;
+        BE1::fileSystem.LoadFile(filename, true, &data);
+        srcData.Append(data);
+    }
+
+    double startTime = BE1::PlatformTime::Seconds();
+
+    // Small reads clustered in a few regions of each file, as the streaming does.
+    int numCanceled = 0;
+    for (int i = 0; i < 2000; i++) {
+        int fileIndex = random.RandomInt(numFiles - 1);
+        int offset = (random.RandomInt(6) * 128 + random.RandomInt(127)) * 1024;
+        int size = 1 + random.RandomInt(16 * 1024);
+
+        BE1::Str filename = testDataDir;
+        filename.AppendPath(BE1::va("file%02i.bin", fileIndex));
+
+        AsyncReadTest test;
+        test.request = BE1::fileSystem.ReadAsync(filename, offset, size, nullptr, (BE1::AsyncIOPriority::Enum)random.RandomInt(BE1::AsyncIOPriority::Count - 1));
+        test.srcData = (const byte *)srcData[fileIndex] + offset;
+
+        if ((i % 10) == 0 && test.request->Cancel()) {
+            numCanceled++;
+        }
+        tests.Append(test);
+    }
+
+    BE1::fileSystem.GetAsyncIOQueue().WaitIdle();
+
+    double elapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    int numFailed = 0;
+    for (int i = 0; i < tests.Count(); i++) {
+        BE1::AsyncReadRequest *request = tests[i].request;
+        if (request->GetStatus() == BE1::AsyncReadRequest::Status::Completed) {
+            if (memcmp(request->GetData(), tests[i].srcData, request->GetSize())) {
+                numFailed++;
+            }
+        } else if (request->GetStatus() != BE1::AsyncReadRequest::Status::Canceled) {
+            numFailed++;
+        }
+        request->Release();
+    }
+
+    for (int i = 0; i < srcData.Count(); i++) {
+        BE1::fileSystem.FreeFile(srcData[i]);
+    }
+
+    BE_LOG("async read: %i requests (%i canceled), %i reads, %i failed, %.2f ms\n", 
+        tests.Count(), numCanceled, BE1::fileSystem.GetAsyncIOQueue().NumReads(), numFailed, elapsed * 1000.0);
+}
+
+static void ReleaseInCallback(BE1::AsyncReadRequest *request, void *userData) {
+    std::atomic<int> *numFinished = (std::atomic<int> *)userData;
+
+    // Waiting on or releasing the own request in the callback must not deadlock.
+    request->Wait();
+    request->Release();
+
+    (*numFinished)++;
+}
+
+static void TestAsyncReadReleaseInCallback(int numFiles) {
+    std::atomic<int> numFinished = { 0 };
+    const int numRequests = 200;
+
+    for (int i = 0; i < numRequests; i++) {
+        BE1::Str filename = testDataDir;
+        filename.AppendPath(BE1::va("file%02i.bin", i % numFiles));
+
+        // Request is owned by the callback after queued.
+        BE1::fileSystem.ReadAsync(filename, (i % 64) * 1024, 4096, nullptr, BE1::AsyncIOPriority::Normal, ReleaseInCallback, &numFinished);
+    }
+
+    BE1::fileSystem.GetAsyncIOQueue().WaitIdle();
+
+    BE_LOG("async read release in callback: %i failed\n", numRequests - numFinished.load());
+}
+
+void TestIO() {
+    TestLZ4RoundTrip();
+
+    GenerateTestData(24, 1024 * 1024);
+
+    TestAsyncRead(24);
+
+    TestAsyncReadReleaseInCallback(24);
+
+    BE1::ZipArchiver::Archive("TestIO/test.zip", testDataDir, "*.bin");
+    BE1::PakArchiver::Archive("TestIO/test_lz4.pak", testDataDir, "*.bin", BE1::PakCodec::LZ4);
+    BE1::PakArchiver::Archive("TestIO/test_deflate.pak", testDataDir, "*.bin", BE1::PakCodec::Deflate);
+    BE1::PakArchiver::Archive("TestIO/test_none.pak", testDataDir, "*.bin", BE1::PakCodec::None);
+
+    BE1::ZipReader zipReader;
+    zipReader.Open(BE1::fileSystem.ToAbsolutePath("TestIO/test.zip"));
+
+    BE1::PakReader lz4Reader;
+    lz4Reader.Open(BE1::fileSystem.ToAbsolutePath("TestIO/test_lz4.pak"));
+
+    BE1::PakReader deflateReader;
+    deflateReader.Open(BE1::fileSystem.ToAbsolutePath("TestIO/test_deflate.pak"));
+
+    BE1::PakReader noneReader;
+    noneReader.Open(BE1::fileSystem.ToAbsolutePath("TestIO/test_none.pak"));
+
+    if (!VerifyPackage(zipReader, "zip") || !VerifyPackage(lz4Reader, "pak LZ4") || 
+        !VerifyPackage(deflateReader, "pak Deflate") || !VerifyPackage(noneReader, "pak None")) {
+        return;
+    }
+
+    BenchmarkPackage(zipReader, "zip", BE1::fileSystem.FileSize("TestIO/test.zip"));
+    BenchmarkPackage(lz4Reader, "pak LZ4", BE1::fileSystem.FileSize("TestIO/test_lz4.pak"));
+    BenchmarkPackage(deflateReader, "pak Deflate", BE1::fileSystem.FileSize("TestIO/test_deflate.pak"));
+    BenchmarkPackage(noneReader, "pak None", BE1::fileSystem.FileSize("TestIO/test_none.pak"));
+}
@@ -0,0 +1,456 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "BlueshiftEngine.h"
+#include "TestImage.h"
+
+static void FillConstantCube(BE1::Image &cubeImage, int size, const BE1::Color3 &color) {
+    cubeImage.CreateCube(size, 1, BE1::Image::Format::RGB_32F_32F_32F, BE1::Image::GammaSpace::Linear, nullptr, 0);
+
+    for (int faceIndex = 0; faceIndex < 6; faceIndex++) {
+        float *dst = (float *)cubeImage.GetPixels(0, faceIndex);
+
+        for (int i = 0; i < size * size; i++, dst += 3) {
+            dst[0] = color.r;
+            dst[1] = color.g;
+            dst[2] = color.b;
+        }
+    }
+}
+
+static float MaxDifference(const BE1::Image &image, const BE1::Color3 &color) {
+    float maxDiff = 0;
+
+    for (int level = 0; level < image.NumMipmaps(); level++) {
+        for (int faceIndex = 0; faceIndex < image.NumSlices(); faceIndex++) {
+            const float *src = (const float *)image.GetPixels(level, faceIndex);
+            int numPixels = image.GetWidth(level) * image.GetHeight(level);
+
+            for (int i = 0; i < numPixels; i++, src += 3) {
+                for (int c = 0; c < 3; c++) {
+                    maxDiff = BE1::Max(maxDiff, BE1::Math::Fabs(src[c] - color[c]));
+                }
+            }
+        }
+    }
+    return maxDiff;
+}
+
+// Constant radiance environment must be preserved by both of the diffuse and specular prefilter.
+static void TestPrefilterConstantEnv() {
+    const BE1::Color3 color(0.25f, 0.5f, 1.0f);
+    BE1::Image envCubeImage;
+    FillConstantCube(envCubeImage, 64, color);
+
+    BE1::Image irradianceImage;
+    uint64_t startClocks = BE1::PlatformTime::Cycles();
+    BE1::EnvCubePrefilter::GenerateSHConvolvIrradianceEnvCube(envCubeImage, 32, irradianceImage);
+    uint64_t endClocks = BE1::PlatformTime::Cycles();
+
+    BE_LOG("GenerateSHConvolvIrradianceEnvCube( 64 -> 32 ): %" PRIu64 " clocks, max error %f\n", endClocks - startClocks, MaxDifference(irradianceImage, color));
+
+    BE1::Image ldSumImage;
+    startClocks = BE1::PlatformTime::Cycles();
+    BE1::EnvCubePrefilter::GenerateGGXLDSumCube(envCubeImage, 64, ldSumImage);
+    endClocks = BE1::PlatformTime::Cycles();
+
+    BE_LOG("GenerateGGXLDSumCube( 64 -> 64 ): %" PRIu64 " clocks, max error %f\n", endClocks - startClocks, MaxDifference(ldSumImage, color));
+}
+
+// Radiance L(n) = a + b * n.z is convolved to irradiance / PI = a + 2/3 * b * n.z exactly with the 3rd order SH.
+static void TestSHIrradianceLinearEnv() {
+    const int size = 64;
+    const float a = 1.0f;
+    const float b = 0.5f;
+
+    BE1::Image envCubeImage;
+    envCubeImage.CreateCube(size, 1, BE1::Image::Format::RGB_32F_32F_32F, BE1::Image::GammaSpace::Linear, nullptr, 0);
+
+    for (int faceIndex = 0; faceIndex < 6; faceIndex++) {
+        float *dst = (float *)envCubeImage.GetPixels(0, faceIndex);
+
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++, dst += 3) {
+                BE1::Vec3 dir = BE1::Image::FaceToCubeMapCoords((BE1::Image::CubeMapFace::Enum)faceIndex, (x + 0.5f) / size, (y + 0.5f) / size);
+                dir.Normalize();
+                dst[0] = dst[1] = dst[2] = a + b * dir.z;
+            }
+        }
+    }
+
+    BE1::Image irradianceImage;
+    BE1::EnvCubePrefilter::GenerateSHConvolvIrradianceEnvCube(envCubeImage, 16, irradianceImage);
+
+    float maxDiff = 0;
+
+    for (int faceIndex = 0; faceIndex < 6; faceIndex++) {
+        const float *src = (const float *)irradianceImage.GetPixels(0, faceIndex);
+
+        for (int y = 0; y < 16; y++) {
+            for (int x = 0; x < 16; x++, src += 3) {
+                BE1::Vec3 dir = BE1::Image::FaceToCubeMapCoords((BE1::Image::CubeMapFace::Enum)faceIndex, (x + 0.5f) / 16, (y + 0.5f) / 16);
+                dir.Normalize();
+                maxDiff = BE1::Max(maxDiff, BE1::Math::Fabs(src[0] - (a + b * 2.0f / 3.0f * dir.z)));
+            }
+        }
+    }
+
+    BE_LOG("GenerateSHConvolvIrradianceEnvCube( linear environment ): max error %f\n", maxDiff);
+}
+
+// Compares CPU generated DFG LUT with the one which is generated by GPU.
+static void TestDFGSum() {
+    BE1::Image gpuImage;
+    if (!gpuImage.Load("Data/EngineTextures/DFGSumGGX.dds")) {
+        BE_WARNLOG("TestDFGSum: couldn't load DFGSumGGX.dds\n");
+        return;
+    }
+
+    BE1::Image cpuImage;
+    uint64_t startClocks = BE1::PlatformTime::Cycles();
+    BE1::EnvCubePrefilter::GenerateGGXDFGSumImage(64, cpuImage);
+    uint64_t endClocks = BE1::PlatformTime::Cycles();
+
+    BE1::Image gpuImage32f, cpuImage32f;
+    gpuImage.ConvertFormat(BE1::Image::Format::RG_32F_32F, gpuImage32f);
+    cpuImage.ConvertFormat(BE1::Image::Format::RG_32F_32F, cpuImage32f);
+
+    // Full size LUT takes too long to generate, so compare with bilinear filtered GPU LUT at the CPU texel centers.
+    int scale = gpuImage32f.GetWidth() / cpuImage32f.GetWidth();
+    int gpuWidth = gpuImage32f.GetWidth();
+    const float *src0 = (const float *)gpuImage32f.GetPixels();
+    const float *src1 = (const float *)cpuImage32f.GetPixels();
+    float maxDiff = 0;
+    double sumDiff = 0;
+
+    for (int y = 0; y < cpuImage32f.GetHeight(); y++) {
+        for (int x = 0; x < cpuImage32f.GetWidth(); x++) {
+            int gx = x * scale + scale / 2 - 1;
+            int gy = y * scale + scale / 2 - 1;
+
+            for (int c = 0; c < 2; c++) {
+                float gpuValue = 0.25f * (
+                    src0[(gy * gpuWidth + gx) * 2 + c] + src0[(gy * gpuWidth + gx + 1) * 2 + c] +
+                    src0[((gy + 1) * gpuWidth + gx) * 2 + c] + src0[((gy + 1) * gpuWidth + gx + 1) * 2 + c]);
+
+                float diff = BE1::Math::Fabs(gpuValue - src1[(y * cpuImage32f.GetWidth() + x) * 2 + c]);
+                maxDiff = BE1::Max(maxDiff, diff);
+                sumDiff += diff;
+            }
+        }
+    }
+
+    int numComponents = cpuImage32f.GetWidth() * cpuImage32f.GetHeight() * 2;
+
+    BE_LOG("GenerateGGXDFGSumImage( %i ): %" PRIu64 " clocks, max error %f, avg error %f\n", 
+        cpuImage.GetWidth(), endClocks - startClocks, maxDiff, (float)(sumDiff / numComponents));
+}
+
+// Smooth gradient with a little noise, which is the typical content of the textures.
+static void FillTestImageRGBA8(BE1::Image &image, int width, int height) {
+    image.Create2D(width, height, 1, BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::GammaSpace::sRGB, nullptr, 0);
+
+    BE1::Random random(1234);
+    byte *dst = image.GetPixels();
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++, dst += 4) {
+            int noise = random.RandomInt() % 9 - 4;
+            dst[0] = (byte)BE1::Min(BE1::Max(x * 255 / width + noise, 0), 255);
+            dst[1] = (byte)BE1::Min(BE1::Max(y * 255 / height + noise, 0), 255);
+            dst[2] = (byte)BE1::Min(BE1::Max((x + y) * 127 / width + noise, 0), 255);
+            dst[3] = (byte)BE1::Min(BE1::Max(255 - x * 255 / width, 0), 255);
+        }
+    }
+}
+
+static float PSNR(const BE1::Image &image0, const BE1::Image &image1) {
+    const byte *src0 = image0.GetPixels();
+    const byte *src1 = image1.GetPixels();
+    int numComponents = image0.GetWidth() * image0.GetHeight() * 4;
+    double sumSqrDiff = 0;
+
+    for (int i = 0; i < numComponents; i++) {
+        int diff = (int)src0[i] - (int)src1[i];
+        sumSqrDiff += diff * diff;
+    }
+
+    double mse = sumSqrDiff / numComponents;
+    return mse > 0 ? (float)(10.0 * log10(255.0 * 255.0 / mse)) : 99.0f;
+}
+
+static void TestCompressLDR(const BE1::Image &srcImage, BE1::Image::Format::Enum format, BE1::Image::CompressionQuality::Enum quality) {
+    BE1::Image compressedImage;
+    uint64_t startClocks = BE1::PlatformTime::Cycles();
+    srcImage.ConvertFormat(format, compressedImage, BE1::Image::GammaSpace::DontCare, false, quality);
+    uint64_t endClocks = BE1::PlatformTime::Cycles();
+
+    BE1::Image decompressedImage;
+    compressedImage.ConvertFormat(BE1::Image::Format::RGBA_8_8_8_8, decompressedImage);
+
+    BE_LOG("Compress %s( quality %i ): %" PRIu64 " clocks, PSNR %.2f dB\n", 
+        BE1::Image::FormatName(format), (int)quality, endClocks - startClocks, PSNR(srcImage, decompressedImage));
+}
+
+// BC6H keeps about 10 bits of mantissa, so relative error of the smooth HDR image should be a few percent at most.
+static void TestCompressBC6H(BE1::Image::CompressionQuality::Enum quality) {
+    const int size = 128;
+
+    BE1::Image srcImage;
+    srcImage.Create2D(size, size, 1, BE1::Image::Format::RGBA_32F_32F_32F_32F, BE1::Image::GammaSpace::Linear, nullptr, 0);
+
+    float *dst = (float *)srcImage.GetPixels();
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++, dst += 4) {
+            dst[0] = 1.0f + 15.0f * x / size;
+            dst[1] = 0.5f + 2.0f * y / size;
+            dst[2] = 0.25f;
+            dst[3] = 1.0f;
+        }
+    }
+
+    BE1::Image compressedImage;
+    uint64_t startClocks = BE1::PlatformTime::Cycles();
+    srcImage.ConvertFormat(BE1::Image::Format::RGB_BC6H_UF16, compressedImage, BE1::Image::GammaSpace::DontCare, false, quality);
+    uint64_t endClocks = BE1::PlatformTime::Cycles();
+
+    BE1::Image decompressedImage;
+    compressedImage.ConvertFormat(BE1::Image::Format::RGBA_32F_32F_32F_32F, decompressedImage);
+
+    const float *src0 = (const float *)srcImage.GetPixels();
+    const float *src1 = (const float *)decompressedImage.GetPixels();
+    float maxRelError = 0;
+
+    for (int i = 0; i < size * size * 4; i += 4) {
+        for (int c = 0; c < 3; c++) {
+            maxRelError = BE1::Max(maxRelError, BE1::Math::Fabs(src1[i + c] - src0[i + c]) / src0[i + c]);
+        }
+    }
+
+    BE_LOG("Compress %s( quality %i ): %" PRIu64 " clocks, max relative error %f\n", 
+        BE1::Image::FormatName(BE1::Image::Format::RGB_BC6H_UF16), (int)quality, endClocks - startClocks, maxRelError);
+}
+
+static void TestCompressImage() {
+    BE1::Image srcImage;
+    FillTestImageRGBA8(srcImage, 256, 256);
+
+    for (int quality = BE1::Image::CompressionQuality::Fast; quality <= BE1::Image::CompressionQuality::HighQuality; quality++) {
+        TestCompressLDR(srcImage, BE1::Image::Format::RGBA_BC7, (BE1::Image::CompressionQuality::Enum)quality);
+    }
+
+    TestCompressLDR(srcImage, BE1::Image::Format::RGBA_ASTC_4x4, BE1::Image::CompressionQuality::Normal);
+    TestCompressLDR(srcImage, BE1::Image::Format::RGBA_ASTC_6x6, BE1::Image::CompressionQuality::Normal);
+    TestCompressLDR(srcImage, BE1::Image::Format::RGBA_ASTC_8x8, BE1::Image::CompressionQuality::Normal);
+    TestCompressLDR(srcImage, BE1::Image::Format::RGBA_ASTC_12x12, BE1::Image::CompressionQuality::Normal);
+
+    for (int quality = BE1::Image::CompressionQuality::Fast; quality <= BE1::Image::CompressionQuality::HighQuality; quality++) {
+        TestCompressBC6H((BE1::Image::CompressionQuality::Enum)quality);
+    }
+}
+
+// Known-good blocks encoded by hand from the format specifications, so the decoders are checked
+// independently of the encoders.
+static int CheckReferenceBlockRGBA8(BE1::Image::Format::Enum format, int blockWidth, int blockHeight, const byte *block, const byte (*expected)[4]) {
+    BE1::Image compressedImage;
+    compressedImage.Create2D(blockWidth, blockHeight, 1, format, BE1::Image::GammaSpace::Linear, block, 0);
+
+    BE1::Image decompressedImage;
+    compressedImage.ConvertFormat(BE1::Image::Format::RGBA_8_8_8_8, decompressedImage);
+
+    const byte *src = decompressedImage.GetPixels();
+    int numFailed = 0;
+
+    for (int i = 0; i < blockWidth * blockHeight; i++, src += 4) {
+        if (memcmp(src, expected[i], 4) != 0) {
+            numFailed++;
+        }
+    }
+    return numFailed;
+}
+
+static void TestDecompressReferenceBlocks() {
+    // BC7 mode 6: endpoints (0, 0, 0, 0) and (255, 255, 255, 255) with the p-bits 0 and 1,
+    // and the texel index i for the texel i, which selects the 4 bits interpolation weight.
+    static const byte bc7Block[16] = {
+        0x40, 0xc0, 0x1f, 0xf0, 0x07, 0xfc, 0x01, 0x7f, 0x11, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe
+    };
+    static const byte bc7Values[16] = { 0, 16, 36, 52, 68, 84, 104, 120, 135, 151, 171, 187, 203, 219, 239, 255 };
+
+    byte bc7Expected[16][4];
+    for (int i = 0; i < 16; i++) {
+        memset(bc7Expected[i], bc7Values[i], 4);
+    }
+
+    int numFailed = CheckReferenceBlockRGBA8(BE1::Image::Format::RGBA_BC7, 4, 4, bc7Block, bc7Expected);
+
+    BE_LOG("%s reference block: %i failed\n", BE1::Image::FormatName(BE1::Image::Format::RGBA_BC7), numFailed);
+
+    // BC6H mode 11: unsigned 10 bits endpoints 0 and 1023, and the texel index i for the texel i.
+    // Expected values are the half floats of the unquantized and interpolated endpoints.
+    static const byte bc6hBlock[16] = {
+        0x03, 0x00, 0x00, 0x00, 0xf8, 0xff, 0xff, 0xff, 0x11, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe
+    };
+    static const float bc6hExpected[16] = {
+        0.0f, 0.000118255615234375f, 0.00066375732421875f, 0.002532958984375f, 0.0096435546875f, 0.03662109375f, 0.19921875f, 0.765625f,
+        2.935546875f, 11.2421875f, 58.46875f, 225.875f, 871.5f, 3358.0f, 17392.0f, 65504.0f
+    };
+
+    BE1::Image bc6hImage;
+    bc6hImage.Create2D(4, 4, 1, BE1::Image::Format::RGB_BC6H_UF16, BE1::Image::GammaSpace::Linear, bc6hBlock, 0);
+
+    BE1::Image bc6hDecompressedImage;
+    bc6hImage.ConvertFormat(BE1::Image::Format::RGBA_32F_32F_32F_32F, bc6hDecompressedImage);
+
+    const float *src = (const float *)bc6hDecompressedImage.GetPixels();
+    numFailed = 0;
+
+    for (int i = 0; i < 16; i++, src += 4) {
+        if (src[0] != bc6hExpected[i] || src[1] != bc6hExpected[i] || src[2] != bc6hExpected[i] || src[3] != 1.0f) {
+            numFailed++;
+        }
+    }
+
+    BE_LOG("%s reference block: %i failed\n", BE1::Image::FormatName(BE1::Image::Format::RGB_BC6H_UF16), numFailed);
+
+    // ASTC 4x4 void extent block of the constant LDR color (0x1234, 0x5678, 0x9abc, 0xffff).
+    static const byte astcVoidExtentBlock[16] = {
+        0xfc, 0xfd, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x34, 0x12, 0x78, 0x56, 0xbc, 0x9a, 0xff, 0xff
+    };
+
+    byte astcExpected[16][4];
+    for (int i = 0; i < 16; i++) {
+        astcExpected[i][0] = 0x12;
+        astcExpected[i][1] = 0x56;
+        astcExpected[i][2] = 0x9a;
+        astcExpected[i][3] = 0xff;
+    }
+
+    numFailed = CheckReferenceBlockRGBA8(BE1::Image::Format::RGBA_ASTC_4x4, 4, 4, astcVoidExtentBlock, astcExpected);
+
+    // ASTC 4x4 block with the 4x4 grid of 2 bits weights, one partition of the LDR RGB direct endpoints
+    // (0, 0, 0) and (255, 255, 255), and the weight x % 4 for the texel in the column x.
+    static const byte astcBlock[16] = {
+        0x42, 0x00, 0x01, 0xfe, 0x01, 0xfe, 0x01, 0xfe, 0x01, 0x00, 0x00, 0x00, 0x27, 0x27, 0x27, 0x27
+    };
+    static const byte astcValues[4] = { 0, 84, 171, 255 };
+
+    for (int i = 0; i < 16; i++) {
+        memset(astcExpected[i], astcValues[i % 4], 3);
+        astcExpected[i][3] = 255;
+    }
+
+    numFailed += CheckReferenceBlockRGBA8(BE1::Image::Format::RGBA_ASTC_4x4, 4, 4, astcBlock, astcExpected);
+
+    BE_LOG("%s reference blocks: %i failed\n", BE1::Image::FormatName(BE1::Image::Format::RGBA_ASTC_4x4), numFailed);
+}
+
+// Compressed images must be written and read back bit exactly by each of the container formats.
+static void TestCompressedImageFiles() {
+    static const BE1::Image::Format::Enum formats[] = {
+        BE1::Image::Format::RGBA_BC7, BE1::Image::Format::RGB_BC6H_UF16, BE1::Image::Format::RGBA_ASTC_5x4, BE1::Image::Format::RGBA_ASTC_10x10
+    };
+    static const char *filenames[] = { "TestImage.btex", "TestImage.dds", "TestImage.pvr" };
+
+    BE1::Image srcImage;
+    FillTestImageRGBA8(srcImage, 60, 44);
+
+    for (int i = 0; i < COUNT_OF(formats); i++) {
+        BE1::Image compressedImage;
+        srcImage.ConvertFormat(formats[i], compressedImage, BE1::Image::GammaSpace::DontCare, false, BE1::Image::CompressionQuality::Fast);
+
+        for (int j = 0; j < COUNT_OF(filenames); j++) {
+            BE1::Image loadedImage;
+            bool succeeded = compressedImage.Write(filenames[j]) && loadedImage.Load(filenames[j]) && 
+                loadedImage.GetFormat() == compressedImage.GetFormat() &&
+                loadedImage.GetWidth() == compressedImage.GetWidth() && loadedImage.GetHeight() == compressedImage.GetHeight() &&
+                !memcmp(loadedImage.GetPixels(), compressedImage.GetPixels(), compressedImage.GetSize());
+
+            BE_LOG("%s %s: %s\n", filenames[j], BE1::Image::FormatName(formats[i]), succeeded ? "OK" : "FAILED");
+
+            BE1::fileSystem.RemoveFile(filenames[j], false);
+        }
+    }
+}
+
+// Streamed decoding must give the same pixels with the in-memory decoding, and thumbnails should be close to the resized image.
+static void TestStreamedImageFiles() {
+    static const char *filenames[] = { "TestImageStream.png", "TestImageStream.jpg" };
+
+    BE1::Image srcImage;
+    FillTestImageRGBA8(srcImage, 1024, 768);
+
+    BE1::Image srcImageRGB;
+    srcImage.ConvertFormat(BE1::Image::Format::RGB_8_8_8, srcImageRGB);
+
+    for (int i = 0; i < COUNT_OF(filenames); i++) {
+        srcImageRGB.Write(filenames[i]);
+
+        BE1::Image loadedImage;
+        uint64_t startClocks = BE1::PlatformTime::Cycles();
+        bool succeeded = loadedImage.Load(filenames[i]);
+        uint64_t endClocks = BE1::PlatformTime::Cycles();
+
+        if (succeeded) {
+            BE1::Image loadedImageRGBA;
+            loadedImage.ConvertFormat(BE1::Image::Format::RGBA_8_8_8_8, loadedImageRGBA);
+            BE1::Image srcImageRGBA;
+            srcImageRGB.ConvertFormat(BE1::Image::Format::RGBA_8_8_8_8, srcImageRGBA);
+
+            BE_LOG("Load %s( %ix%i ): %" PRIu64 " clocks, PSNR %.2f dB\n", filenames[i], 
+                loadedImage.GetWidth(), loadedImage.GetHeight(), endClocks - startClocks, PSNR(srcImageRGBA, loadedImageRGBA));
+        } else {
+            BE_LOG("Load %s: FAILED\n", filenames[i]);
+        }
+
+        BE1::Image thumbnailImage;
+        startClocks = BE1::PlatformTime::Cycles();
+        succeeded = thumbnailImage.LoadThumbnail(filenames[i], 128);
+        endClocks = BE1::PlatformTime::Cycles();
+
+        if (succeeded) {
+            BE1::Image resizedImage;
+            srcImageRGB.Resize(thumbnailImage.GetWidth(), thumbnailImage.GetHeight(), BE1::Image::ResampleFilter::Bilinear, resizedImage);
+
+            BE1::Image thumbnailImageRGBA, resizedImageRGBA;
+            thumbnailImage.ConvertFormat(BE1::Image::Format::RGBA_8_8_8_8, thumbnailImageRGBA);
+            resizedImage.ConvertFormat(BE1::Image::Format::RGBA_8_8_8_8, resizedImageRGBA);
+
+            BE_LOG("LoadThumbnail %s( %ix%i ): %" PRIu64 " clocks, PSNR %.2f dB\n", filenames[i], 
+                thumbnailImage.GetWidth(), thumbnailImage.GetHeight(), endClocks - startClocks, PSNR(resizedImageRGBA, thumbnailImageRGBA));
+        } else {
+            BE_LOG("LoadThumbnail %s: FAILED\n", filenames[i]);
+        }
+
+        BE1::fileSystem.RemoveFile(filenames[i], false);
+    }
+}
+
+void TestImage() {
+    TestPrefilterConstantEnv();
+
+    TestSHIrradianceLinearEnv();
+
+    TestDFGSum();
+
+    TestCompressImage();
+
+    TestDecompressReferenceBlocks();
+
+    TestCompressedImageFiles();
+
+    TestStreamedImageFiles();
+}
@@ -0,0 +1,667 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "TestRender.h"
+
+static const BE1::TriIndex quadIndexes[6] = { 0, 1, 2, 0, 2, 3 };
+
+// Render subsystems run the jobs in the job pool shared by the engine.
+static void SetJobThreads(int numThreads) {
+    BE1::cvarSystem.SetCVarInteger("jobPool_threads", numThreads);
+}
+
+static void TestOcclusionCulling(int numThreads) {
+    // Camera at the origin looking down -Z.
+    BE1::Mat4 viewProjMatrix;
+    viewProjMatrix.SetPerspective(60.0f, 2.0f, 0.1f, 1000.0f);
+
+    SetJobThreads(numThreads);
+
+    BE1::OcclusionBuffer occlusionBuffer;
+    occlusionBuffer.Init(256, 128);
+
+    struct Case {
+        const char *        name;
+        BE1::AABB           bounds;
+        bool                expectedVisible;
+    };
+
+    // Wall in front of the camera.
+    const BE1::Vec3 wall[4] = { BE1::Vec3(-10, -10, -10), BE1::Vec3(10, -10, -10), BE1::Vec3(10, 10, -10), BE1::Vec3(-10, 10, -10) };
+
+    const Case wallCases[] = {
+        { "behind wall", BE1::AABB(BE1::Vec3(-1, -1, -21), BE1::Vec3(1, 1, -19)), false },
+        { "in front of wall", BE1::AABB(BE1::Vec3(-1, -1, -6), BE1::Vec3(1, 1, -4)), true },
+        { "beside wall", BE1::AABB(BE1::Vec3(30, -1, -30), BE1::Vec3(32, 1, -28)), true },
+        { "crossing wall", BE1::AABB(BE1::Vec3(-1, -1, -11), BE1::Vec3(1, 1, -9)), true },
+        { "crossing near plane", BE1::AABB(BE1::Vec3(-1, -1, -1), BE1::Vec3(1, 1, 1)), true },
+    };
+
+    occlusionBuffer.Clear(viewProjMatrix);
+    occlusionBuffer.AddOccluder(viewProjMatrix, wall, sizeof(BE1::Vec3), 4, quadIndexes, 6);
+    occlusionBuffer.Rasterize();
+
+    int numFailed = 0;
+    for (int i = 0; i < COUNT_OF(wallCases); i++) {
+        if (occlusionBuffer.IsAABBVisible(wallCases[i].bounds) != wallCases[i].expectedVisible) {
+            BE_LOG("occlusion culling: '%s' failed\n", wallCases[i].name);
+            numFailed++;
+        }
+    }
+
+    // Floor under the camera which is clipped by the near plane.
+    const BE1::Vec3 floor[4] = { BE1::Vec3(-50, -1, 50), BE1::Vec3(50, -1, 50), BE1::Vec3(50, -1, -50), BE1::Vec3(-50, -1, -50) };
+
+    const Case floorCases[] = {
+        { "under floor", BE1::AABB(BE1::Vec3(-1, -5, -20), BE1::Vec3(1, -3, -18)), false },
+        { "above floor", BE1::AABB(BE1::Vec3(-1, 0, -20), BE1::Vec3(1, 2, -18)), true },
+    };
+
+    occlusionBuffer.Clear(viewProjMatrix);
+    occlusionBuffer.AddOccluder(viewProjMatrix, floor, sizeof(BE1::Vec3), 4, quadIndexes, 6);
+    occlusionBuffer.Rasterize();
+
+    for (int i = 0; i < COUNT_OF(floorCases); i++) {
+        if (occlusionBuffer.IsAABBVisible(floorCases[i].bounds) != floorCases[i].expectedVisible) {
+            BE_LOG("occlusion culling: '%s' failed\n", floorCases[i].name);
+            numFailed++;
+        }
+    }
+
+    // Random triangles for the rasterization timing.
+    BE1::Random random(1234);
+    BE1::Array<BE1::Vec3> verts;
+    BE1::Array<BE1::TriIndex> indexes;
+
+    for (int i = 0; i < 3000; i++) {
+        BE1::Vec3 center(random.RandomFloat() * 40.0f - 20.0f, random.RandomFloat() * 20.0f - 10.0f, -5.0f - random.RandomFloat() * 50.0f);
+
+        for (int j = 0; j < 3; j++) {
+            verts.Append(center + BE1::Vec3(random.RandomFloat() * 4.0f - 2.0f, random.RandomFloat() * 4.0f - 2.0f, random.RandomFloat() * 4.0f - 2.0f));
+            indexes.Append((BE1::TriIndex)(verts.Count() - 1));
+        }
+    }
+
+    const int numIterations = 100;
+    double startTime = BE1::PlatformTime::Seconds();
+
+    for (int i = 0; i < numIterations; i++) {
+        occlusionBuffer.Clear(viewProjMatrix);
+        occlusionBuffer.AddOccluder(viewProjMatrix, verts.Ptr(), sizeof(BE1::Vec3), verts.Count(), indexes.Ptr(), indexes.Count());
+        occlusionBuffer.Rasterize();
+    }
+
+    double elapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    BE_LOG("occlusion culling (%i threads): %i failed, %i triangles %.3f ms\n", 
+        numThreads, numFailed, occlusionBuffer.NumTriangles(), elapsed * 1000.0 / numIterations);
+}
+
+static void TestMeshLOD() {
+    BE1::Mesh mesh;
+    mesh.CreateSphere(BE1::Vec3::origin, BE1::Mat3::identity, 1.0f, 64);
+
+    double startTime = BE1::PlatformTime::Seconds();
+
+    if (!mesh.GenerateLODs(BE1::MeshSurf::MaxLODs, 0.5f)) {
+        BE_LOG("mesh LOD: failed to generate LODs\n");
+        return;
+    }
+
+    double elapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    int numFailed = 0;
+    int prevNumTris = 0;
+
+    for (int lod = 0; lod < mesh.NumLODs(); lod++) {
+        int numTris = 0;
+
+        for (int surfaceIndex = 0; surfaceIndex < mesh.NumSurfaces(); surfaceIndex++) {
+            const BE1::SubMesh *subMesh = mesh.GetSurface(surfaceIndex)->GetLODSubMesh(lod);
+
+            for (int i = 0; i < subMesh->NumIndexes(); i++) {
+                if (subMesh->Indexes()[i] >= subMesh->NumVerts()) {
+                    numFailed++;
+                    break;
+                }
+            }
+
+            // Kept vertices are not moved, so they should be on the sphere.
+            for (int i = 0; i < subMesh->NumVerts(); i++) {
+                if (BE1::Math::Fabs(subMesh->Verts()[i].xyz.Length() - 1.0f) > 0.001f) {
+                    numFailed++;
+                    break;
+                }
+            }
+
+            numTris += subMesh->NumIndexes() / 3;
+        }
+
+        // Each LOD should be coarser than the previous LOD.
+        if (lod > 0 && numTris >= prevNumTris) {
+            numFailed++;
+        }
+
+        BE_LOG("mesh LOD %i: %i triangles\n", lod, numTris);
+
+        prevNumTris = numTris;
+    }
+
+    BE_LOG("mesh LOD: %i failed, %i LODs generated in %.3f ms\n", numFailed, mesh.NumLODs(), elapsed * 1000.0);
+}
+
+static void TestMeshOptimize() {
+    BE1::Mesh mesh;
+    mesh.CreateSphere(BE1::Vec3::origin, BE1::Mat3::identity, 1.0f, 128);
+
+    BE1::SubMesh *subMesh = mesh.GetSurface(0)->subMesh;
+    BE1::TriIndex *indexes = subMesh->Indexes();
+    int numTris = subMesh->NumIndexes() / 3;
+
+    // Shuffle triangles to get the worst case input.
+    BE1::Random random(1234);
+    for (int i = numTris - 1; i > 0; i--) {
+        int j = random.RandomInt(i + 1);
+        for (int k = 0; k < 3; k++) {
+            BE1::Swap(indexes[i * 3 + k], indexes[j * 3 + k]);
+        }
+    }
+
+    float acmr16 = subMesh->ComputeACMR(16);
+    float acmr32 = subMesh->ComputeACMR(32);
+    float volume = subMesh->ComputeVolume();
+
+    double startTime = BE1::PlatformTime::Seconds();
+
+    mesh.OptimizeIndexedTriangles();
+
+    double elapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    int numFailed = 0;
+    for (int i = 0; i < subMesh->NumIndexes(); i++) {
+        if (subMesh->Indexes()[i] >= subMesh->NumVerts()) {
+            numFailed++;
+            break;
+        }
+    }
+
+    // Winding of the triangles should be kept after the vertex remap.
+    if (BE1::Math::Fabs(subMesh->ComputeVolume() - volume) > BE1::Math::Fabs(volume) * 0.001f) {
+        numFailed++;
+    }
+
+    BE_LOG("mesh optimize: ACMR(16) %.3f -> %.3f, ACMR(32) %.3f -> %.3f\n", 
+        acmr16, subMesh->ComputeACMR(16), acmr32, subMesh->ComputeACMR(32));
+    BE_LOG("mesh optimize: %i failed, %i triangles in %.3f ms\n", numFailed, numTris, elapsed * 1000.0);
+}
+
+static void TestMeshClusters() {
+    BE1::Mesh mesh;
+    mesh.CreateSphere(BE1::Vec3::origin, BE1::Mat3::identity, 1.0f, 128);
+    mesh.OptimizeIndexedTriangles();
+
+    double startTime = BE1::PlatformTime::Seconds();
+
+    mesh.BuildClusters();
+
+    double elapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    const BE1::SubMesh *subMesh = mesh.GetSurface(0)->subMesh;
+    int numTris = subMesh->NumIndexes() / 3;
+
+    // Camera close to the sphere, looking at the center with 60 degrees FOV.
+    BE1::Vec3 viewOrigin(1.5f, 0.0f, 0.0f);
+    BE1::Mat3 viewAxis(-1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+
+    BE1::Frustum frustum;
+    frustum.SetOrigin(viewOrigin);
+    frustum.SetAxis(viewAxis);
+    frustum.SetSize(0.1f, 100.0f, 100.0f * BE1::Math::Tan(DEG2RAD(30.0f)), 100.0f * BE1::Math::Tan(DEG2RAD(30.0f)));
+
+    int numFailed = 0;
+    int numClusterTris = 0;
+    int numVisibleTris = 0;
+
+    for (int clusterIndex = 0; clusterIndex < subMesh->NumClusters(); clusterIndex++) {
+        const BE1::MeshCluster &cluster = subMesh->Clusters()[clusterIndex];
+
+        numClusterTris += cluster.numIndexes / 3;
+
+        if (cluster.IsBackFacing(viewOrigin)) {
+            // All the triangles of the back facing cluster should be back facing.
+            for (int i = cluster.firstIndex; i < cluster.firstIndex + cluster.numIndexes; i += 3) {
+                const BE1::Vec3 &p0 = subMesh->Verts()[subMesh->Indexes()[i + 0]].xyz;
+                const BE1::Vec3 &p1 = subMesh->Verts()[subMesh->Indexes()[i + 1]].xyz;
+                const BE1::Vec3 &p2 = subMesh->Verts()[subMesh->Indexes()[i + 2]].xyz;
+
+                if ((p1 - p0).Cross(p2 - p0).Dot(viewOrigin - p0) > 1e-6f) {
+                    numFailed++;
+                    break;
+                }
+            }
+            continue;
+        }
+
+        if (frustum.CullSphere(BE1::Sphere(cluster.center, cluster.radius))) {
+            continue;
+        }
+
+        numVisibleTris += cluster.numIndexes / 3;
+    }
+
+    // Clusters should cover all the triangles.
+    if (numClusterTris != numTris) {
+        numFailed++;
+    }
+
+    BE_LOG("mesh clusters: %i failed, %i clusters built in %.3f ms, %i / %i triangles visible\n", 
+        numFailed, subMesh->NumClusters(), elapsed * 1000.0, numVisibleTris, numTris);
+}
+
+static void TestLightGrid(int numThreads) {
+    const float zNear = 0.1f;
+    const float zFar = 500.0f;
+
+    BE1::Mat4 projMatrix;
+    projMatrix.SetPerspective(60.0f, 16.0f / 9.0f, zNear, zFar);
+
+    SetJobThreads(numThreads);
+
+    BE1::LightGrid lightGrid;
+    lightGrid.Init();
+    lightGrid.Setup(projMatrix, zNear, zFar);
+
+    // Random point lights in front of the camera looking down -Z.
+    BE1::Random random(1234);
+    BE1::Array<BE1::Sphere> lights;
+
+    for (int i = 0; i < 256; i++) {
+        BE1::Vec3 center(random.RandomFloat() * 200.0f - 100.0f, random.RandomFloat() * 100.0f - 50.0f, -random.RandomFloat() * 300.0f);
+        lights.Append(BE1::Sphere(center, 1.0f + random.RandomFloat() * 20.0f));
+    }
+
+    const int numIterations = 100;
+    double startTime = BE1::PlatformTime::Seconds();
+
+    for (int i = 0; i < numIterations; i++) {
+        lightGrid.AssignLights(lights.Ptr(), lights.Count());
+    }
+
+    double elapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    int numFailed = 0;
+
+    // Light lists should be same as the brute force assignment.
+    for (int clusterIndex = 0; clusterIndex < BE1::LightGrid::NumClusters; clusterIndex++) {
+        const BE1::AABB &bounds = lightGrid.GetClusterBounds(clusterIndex);
+        const int32_t *clusterLights = lightGrid.ClusterLightIndexes(clusterIndex);
+        int numClusterLights = lightGrid.NumClusterLights(clusterIndex);
+        int count = 0;
+
+        for (int lightIndex = 0; lightIndex < lights.Count(); lightIndex++) {
+            if (!lights[lightIndex].IsIntersectAABB(bounds)) {
+                continue;
+            }
+            if (count >= numClusterLights || clusterLights[count] != lightIndex) {
+                numFailed++;
+                break;
+            }
+            count++;
+        }
+
+        if (count != numClusterLights) {
+            numFailed++;
+        }
+    }
+
+    // Clusters looked up from the light center like the shader should contain the light.
+    for (int lightIndex = 0; lightIndex < lights.Count(); lightIndex++) {
+        BE1::Vec4 clipPos = projMatrix * BE1::Vec4(lights[lightIndex].center, 1.0f);
+        if (clipPos.w <= zNear || clipPos.w >= zFar || 
+            BE1::Math::Fabs(clipPos.x) >= clipPos.w || BE1::Math::Fabs(clipPos.y) >= clipPos.w) {
+            continue;
+        }
+
+        int x = (int)((clipPos.x / clipPos.w * 0.5f + 0.5f) * BE1::LightGrid::GridSizeX);
+        int y = (int)((clipPos.y / clipPos.w * 0.5f + 0.5f) * BE1::LightGrid::GridSizeY);
+        int z = (int)(BE1::Math::Ln(clipPos.w) * lightGrid.GetSliceScale() + lightGrid.GetSliceBias());
+        BE1::Clamp(z, 0, BE1::LightGrid::GridSizeZ - 1);
+
+        int clusterIndex = BE1::LightGrid::ClusterIndex(x, y, z);
+        const int32_t *clusterLights = lightGrid.ClusterLightIndexes(clusterIndex);
+        bool found = false;
+
+        for (int i = 0; i < lightGrid.NumClusterLights(clusterIndex); i++) {
+            if (clusterLights[i] == lightIndex) {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            numFailed++;
+        }
+    }
+
+    BE_LOG("light grid (%i threads): %i failed, %i lights %i light indexes in %.3f ms\n", 
+        numThreads, numFailed, lights.Count(), lightGrid.NumLightIndexes(), elapsed * 1000.0 / numIterations);
+}
+
+static void TestShadowAtlas() {
+    const int atlasSize = 4096;
+    const int minTileSize = 128;
+
+    BE1::ShadowAtlas shadowAtlas;
+    shadowAtlas.Init(atlasSize, minTileSize);
+
+    BE1::Random random(1234);
+    BE1::Array<int> tiles;
+    BE1::Array<int> tileSizes;
+
+    int numFailed = 0;
+    int numAllocFailed = 0;
+
+    // Allocate and free random sized tiles.
+    for (int i = 0; i < 2000; i++) {
+        if (tiles.Count() > 0 && random.RandomInt(3) == 0) {
+            int index = random.RandomInt(tiles.Count());
+
+            shadowAtlas.FreeTile(tiles[index]);
+
+            tiles.RemoveIndexFast(index);
+            tileSizes.RemoveIndexFast(index);
+            continue;
+        }
+
+        int tileSize = shadowAtlas.ClampTileSize(minTileSize << random.RandomInt(5));
+        int tile = shadowAtlas.AllocTile(tileSize);
+        if (tile < 0) {
+            numAllocFailed++;
+            continue;
+        }
+
+        tiles.Append(tile);
+        tileSizes.Append(tileSize);
+    }
+
+    // Tiles should have the requested size in the atlas and should not overlap each other.
+    for (int i = 0; i < tiles.Count(); i++) {
+        const BE1::Rect &rect = shadowAtlas.GetTileRect(tiles[i]);
+
+        if (rect.w != tileSizes[i] || rect.h != tileSizes[i] || rect.x % rect.w || rect.y % rect.h ||
+            rect.x < 0 || rect.y < 0 || rect.x + rect.w > atlasSize || rect.y + rect.h > atlasSize) {
+            numFailed++;
+        }
+
+        for (int j = i + 1; j < tiles.Count(); j++) {
+            const BE1::Rect &other = shadowAtlas.GetTileRect(tiles[j]);
+
+            if (rect.x < other.x + other.w && other.x < rect.x + rect.w && rect.y < other.y + other.h && other.y < rect.y + rect.h) {
+                numFailed++;
+            }
+        }
+    }
+
+    if (shadowAtlas.NumTiles() != tiles.Count()) {
+        numFailed++;
+    }
+
+    int numTiles = tiles.Count();
+
+    // All the free tiles should be merged back into the whole atlas.
+    for (int i = 0; i < tiles.Count(); i++) {
+        shadowAtlas.FreeTile(tiles[i]);
+    }
+
+    int wholeTile = shadowAtlas.AllocTile(atlasSize);
+    if (wholeTile < 0 || shadowAtlas.GetTileRect(wholeTile) != BE1::Rect(0, 0, atlasSize, atlasSize)) {
+        numFailed++;
+    }
+
+    BE_LOG("shadow atlas: %i failed, %i tiles allocated (%i allocations out of space)\n", numFailed, numTiles, numAllocFailed);
+}
+
+static void TestShadowCascades() {
+    // Camera at the height of 10 looking along +X, and the directional light looking down.
+    BE1::Frustum viewFrustum;
+    viewFrustum.SetOrigin(BE1::Vec3(0, 0, 10));
+    viewFrustum.SetAxis(BE1::Mat3::identity);
+    viewFrustum.SetSize(1.0f, 1000.0f, 1000.0f, 500.0f);
+
+    const BE1::Mat3 lightAxis(BE1::Vec3(0, 0, -1), BE1::Vec3(0, 1, 0), BE1::Vec3(1, 0, 0));
+
+    struct Case {
+        const char *        name;
+        BE1::AABB           bounds;
+        int                 expectedMask;
+        int                 expectedBlendMask;
+    };
+
+    const Case cases[] = {
+        { "near", BE1::AABB(BE1::Vec3(5, -1, 0), BE1::Vec3(6, 1, 2)), BIT(0), BIT(0) | BIT(1) },
+        { "far", BE1::AABB(BE1::Vec3(300, -1, 0), BE1::Vec3(302, 1, 2)), BIT(3), BIT(3) },
+        { "high above near", BE1::AABB(BE1::Vec3(5, -1, 1000), BE1::Vec3(6, 1, 1002)), BIT(0), BIT(0) | BIT(1) },
+        { "deep below", BE1::AABB(BE1::Vec3(5, -1, -2000), BE1::Vec3(6, 1, -1998)), 0, 0 },
+        { "aside", BE1::AABB(BE1::Vec3(5, 2000, 0), BE1::Vec3(6, 2002, 2)), 0, 0 },
+        { "long", BE1::AABB(BE1::Vec3(5, -1, 0), BE1::Vec3(350, 1, 2)), BIT(0) | BIT(1) | BIT(2) | BIT(3), BIT(0) | BIT(1) | BIT(2) | BIT(3) },
+    };
+
+    int numFailed = 0;
+
+    for (int blend = 0; blend < 2; blend++) {
+        BE1::ShadowCascades shadowCascades;
+        shadowCascades.Setup(lightAxis, viewFrustum, 400.0f, 0.5f, 4, blend ? true : false);
+
+        // Split distances should be increasing from the near distance to the far distance.
+        if (shadowCascades.GetSplitDistance(0) != viewFrustum.GetNearDistance() || shadowCascades.GetSplitDistance(4) != 400.0f) {
+            numFailed++;
+        }
+        for (int i = 0; i < shadowCascades.NumCascades(); i++) {
+            if (shadowCascades.GetSplitDistance(i) >= shadowCascades.GetSplitDistance(i + 1)) {
+                numFailed++;
+            }
+        }
+
+        for (int i = 0; i < COUNT_OF(cases); i++) {
+            int expectedMask = blend ? cases[i].expectedBlendMask : cases[i].expectedMask;
+            int mask = shadowCascades.CascadeMask(cases[i].bounds);
+
+            if (mask != expectedMask) {
+                BE_LOG("shadow cascades: %s%s caster has cascade mask %i (expected %i)\n", cases[i].name, blend ? " (blend)" : "", mask, expectedMask);
+                numFailed++;
+            }
+        }
+    }
+
+    BE_LOG("shadow cascades: %i failed\n", numFailed);
+}
+
+static void InitTestParticles(const BE1::ParticleSystem::Stage &stage, int particleSize, BE1::Particle *particles, int *aliveParticles, int *particleAges) {
+    BE1::Random random(1234);
+
+    for (int particleIndex = 0; particleIndex < stage.standardModule.count; particleIndex++) {
+        BE1::Particle *particle = (BE1::Particle *)((byte *)particles + particleIndex * particleSize);
+
+        particle->generated = true;
+        particle->alive = true;
+        particle->cycle = 0;
+        particle->direction = BE1::Vec3::FromUniformSampleSphere(random.RandomFloat(), random.RandomFloat());
+        particle->worldMatrix = BE1::Mat3x4(BE1::Mat3::identity, BE1::Vec3(random.RandomFloat(), random.RandomFloat(), random.RandomFloat()) * 10.0f);
+        particle->initialPosition = BE1::Vec3(random.RandomFloat(), random.RandomFloat(), random.RandomFloat());
+        particle->initialSpeed = BE1::MeterToUnit(1.0f + random.RandomFloat());
+        particle->initialSize = BE1::MeterToUnit(0.1f + random.RandomFloat());
+        particle->initialAspectRatio = 0.5f + random.RandomFloat();
+        particle->initialAngle = random.RandomFloat() * 360.0f;
+        particle->initialColor.Set(random.RandomFloat(), random.RandomFloat(), random.RandomFloat(), 1.0f);
+        particle->randomForce.Set(random.RandomFloat(), random.RandomFloat(), random.RandomFloat());
+        particle->randomSpeed = random.RandomFloat();
+        particle->randomSize = random.RandomFloat();
+        particle->randomAspectRatio = random.RandomFloat();
+        particle->randomAngularVelocity = random.RandomFloat();
+
+        aliveParticles[particleIndex] = particleIndex;
+        particleAges[particleIndex] = (int)(random.RandomFloat() * stage.standardModule.lifeTime);
+    }
+}
+
+static void TestParticleSimulation(const char *name, const BE1::ParticleSystem::Stage &stage, int numThreads) {
+    const int numParticles = stage.standardModule.count;
+    const int trailCount = (stage.moduleFlags & BIT(BE1::ParticleSystem::ModuleBit::Trails)) ? stage.trailsModule.count : 0;
+    const int particleSize = sizeof(BE1::Particle) + sizeof(BE1::Particle::Trail) * trailCount;
+
+    BE1::Particle *scalarParticles = (BE1::Particle *)BE1::Mem_Alloc(numParticles * particleSize);
+    BE1::Particle *simdParticles = (BE1::Particle *)BE1::Mem_Alloc(numParticles * particleSize);
+    memset(scalarParticles, 0, numParticles * particleSize);
+
+    BE1::Array<int> aliveParticles;
+    BE1::Array<int> particleAges;
+    aliveParticles.SetCount(numParticles);
+    particleAges.SetCount(numParticles);
+
+    // Same particles with the fixed seed for both paths.
+    InitTestParticles(stage, particleSize, scalarParticles, aliveParticles.Ptr(), particleAges.Ptr());
+    memcpy(simdParticles, scalarParticles, numParticles * particleSize);
+
+    BE1::ParticleSimulator::StageJob scalarJob;
+    scalarJob.stage = &stage;
+    scalarJob.particles = scalarParticles;
+    scalarJob.particleSize = particleSize;
+    scalarJob.aliveParticles = aliveParticles.Ptr();
+    scalarJob.particleAges = particleAges.Ptr();
+    scalarJob.numAliveParticles = numParticles;
+    scalarJob.invWorldMatrix = BE1::Mat3x4(BE1::Mat3::identity, BE1::Vec3(-5.0f, 0.0f, 2.0f));
+
+    // Simulate 4 stages at once to use the task threads.
+    BE1::ParticleSimulator::StageJob simdJobs[4];
+    for (int i = 0; i < COUNT_OF(simdJobs); i++) {
+        simdJobs[i] = scalarJob;
+        simdJobs[i].particles = simdParticles;
+    }
+
+    SetJobThreads(numThreads);
+
+    const int numIterations = 100;
+    double startTime = BE1::PlatformTime::Seconds();
+
+    for (int i = 0; i < numIterations; i++) {
+        BE1::ParticleSimulator::SimulateStageScalar(scalarJob);
+    }
+
+    double scalarElapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    startTime = BE1::PlatformTime::Seconds();
+
+    for (int i = 0; i < numIterations; i++) {
+        BE1::ParticleSimulator::SimulateStageSIMD(simdJobs[0]);
+    }
+
+    double simdElapsed = BE1::PlatformTime::Seconds() - startTime;
+
+    int numFailed = 0;
+
+    // Trails should be bitwise identical to the scalar path.
+    if (memcmp(scalarParticles, simdParticles, numParticles * particleSize) != 0) {
+        numFailed++;
+    }
+    if (memcmp(&scalarJob.bounds, &simdJobs[0].bounds, sizeof(BE1::AABB)) != 0) {
+        numFailed++;
+    }
+
+    // Stages simulated in parallel write the same values.
+    BE1::ParticleSimulator::Simulate(simdJobs, COUNT_OF(simdJobs), true);
+
+    for (int i = 0; i < COUNT_OF(simdJobs); i++) {
+        if (memcmp(&scalarJob.bounds, &simdJobs[i].bounds, sizeof(BE1::AABB)) != 0) {
+            numFailed++;
+        }
+    }
+    if (memcmp(scalarParticles, simdParticles, numParticles * particleSize) != 0) {
+        numFailed++;
+    }
+
+    BE1::Mem_Free(scalarParticles);
+    BE1::Mem_Free(simdParticles);
+
+    BE_LOG("particle simulation %s (%i threads): %i failed, %i pivots scalar %.3f ms SIMD %.3f ms\n",
+        name, numThreads, numFailed, numParticles * (1 + trailCount), scalarElapsed * 1000.0 / numIterations, simdElapsed * 1000.0 / numIterations);
+}
+
+static void TestParticleSimulation() {
+    BE1::ParticleSystem::Stage stage;
+    stage.Reset();
+    stage.standardModule.count = 1000;
+    stage.standardModule.gravity = 9.8f;
+
+    // Lifetime modules with the trails in the global space.
+    stage.moduleFlags |= BIT(BE1::ParticleSystem::ModuleBit::LTColor) | BIT(BE1::ParticleSystem::ModuleBit::LTSpeed) |
+        BIT(BE1::ParticleSystem::ModuleBit::LTForce) | BIT(BE1::ParticleSystem::ModuleBit::LTSize) |
+        BIT(BE1::ParticleSystem::ModuleBit::LTRotation) | BIT(BE1::ParticleSystem::ModuleBit::LTAspectRatio) |
+        BIT(BE1::ParticleSystem::ModuleBit::Trails);
+    stage.standardModule.simulationSpace = BE1::ParticleSystem::StandardModule::SimulationSpace::Global;
+    stage.speedOverLifetimeModule.speed.Reset(BE1::MinMaxCurve::Type::RandomBetweenTwoConstants, 2.0f, -0.5f, 1.0f);
+    stage.sizeOverLifetimeModule.size.Reset(BE1::MinMaxCurve::Type::RandomBetweenTwoConstants, 1.0f, 0.5f, 1.0f);
+    stage.forceOverLifetimeModule.force[0].Reset(BE1::MinMaxCurve::Type::RandomBetweenTwoConstants, 1.0f, -1.0f, 1.0f);
+    stage.forceOverLifetimeModule.force[2].Reset(BE1::MinMaxCurve::Type::RandomBetweenTwoConstants, 3.0f, 0.0f, 1.0f);
+    stage.trailsModule.count = 4;
+    stage.trailsModule.trailScale = 0.5f;
+
+    TestParticleSimulation("lifetime", stage, 4);
+
+    // Speed dependent modules in the local space.
+    stage.Reset();
+    stage.standardModule.count = 1000;
+    stage.moduleFlags |= BIT(BE1::ParticleSystem::ModuleBit::LTColor) | BIT(BE1::ParticleSystem::ModuleBit::LTSpeed) |
+        BIT(BE1::ParticleSystem::ModuleBit::SizeBySpeed) | BIT(BE1::ParticleSystem::ModuleBit::RotationBySpeed);
+    stage.speedOverLifetimeModule.speed.Reset(BE1::MinMaxCurve::Type::RandomBetweenTwoConstants, 1.0f, 0.0f, 1.0f);
+    stage.sizeBySpeedModule.size.Reset(BE1::MinMaxCurve::Type::RandomBetweenTwoConstants, 1.0f, 0.5f, 1.0f);
+    stage.rotationBySpeedModule.rotation.Reset(BE1::MinMaxCurve::Type::RandomBetweenTwoConstants, 180.0f, -1.0f, 1.0f);
+    stage.rotationBySpeedModule.speedRange.Set(0, 3);
+
+    TestParticleSimulation("by speed", stage, 4);
+
+    // Custom path.
+    stage.Reset();
+    stage.standardModule.count = 1000;
+    stage.moduleFlags |= BIT(BE1::ParticleSystem::ModuleBit::CustomPath) | BIT(BE1::ParticleSystem::ModuleBit::RotationBySpeed);
+    stage.customPathModule.customPath = BE1::ParticleSystem::CustomPathModule::CustomPath::Helix;
+
+    TestParticleSimulation("custom path", stage, 4);
+}
+
+void TestRender() {
+    int jobThreads = BE1::cvarSystem.GetCVarInteger("jobPool_threads");
+
+    TestOcclusionCulling(0);
+
+    TestOcclusionCulling(4);
+
+    TestMeshLOD();
+
+    TestMeshOptimize();
+
+    TestMeshClusters();
+
+    TestLightGrid(0);
+
+    TestLightGrid(4);
+
+    TestShadowAtlas();
+
+    TestShadowCascades();
+
+    TestParticleSimulation();
+
+    SetJobThreads(jobThreads);
+}